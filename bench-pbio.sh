@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Shortcut for running the pbio benchmarks.
+#
+# Prints one JSON object per line for each result, so the output can be
+# stored and compared with a baseline, e.g. ./bench-pbio.sh > bench.jsonl
+#
+# Use `--compare bench.jsonl` to compare the new results with a saved
+# baseline. This fails if any result is more than 10% worse.
+#
+
+set -e
+
+SCRIPT_DIR=$(dirname "$0")
+
+if [ "$1" = "--compare" ]; then
+    BASELINE="$2"
+    shift 2
+fi
+
+export PBIO_TEST_RESULTS_DIR="${SCRIPT_DIR}/lib/pbio/test/results"
+make -s -C "${SCRIPT_DIR}/lib/pbio/test" -j$(nproc) >&2
+
+RESULTS="${PBIO_TEST_RESULTS_DIR}/bench.jsonl"
+"${SCRIPT_DIR}/lib/pbio/test/build/test-pbio" --quiet "+src/bench/.." "$@" | grep "^{" > "${RESULTS}"
+
+if [ -n "${BASELINE}" ]; then
+    "${SCRIPT_DIR}/tools/bench_compare.py" "${BASELINE}" "${RESULTS}"
+else
+    cat "${RESULTS}"
+fi
@@ -83,6 +83,13 @@ endif
 # lets micropython make files work with external files
 USER_C_MODULES = $(PBTOP)
 
+# Opt-in variant with native code emitters for @micropython.native and
+# @micropython.viper. Only supported on hubs that leave this option open.
+ifeq ($(NATIVE_EMIT),1)
+BUILD ?= build-native
+CFLAGS += -DPYBRICKS_OPT_NATIVE_EMIT=1
+endif
+
 include $(PBTOP)/micropython/py/mkenv.mk
 
 # Include common frozen modules.
@@ -172,9 +179,14 @@ ifeq ($(PB_MCU_FAMILY),native)
 UNAME_S := $(shell uname -s)
 LD = $(CC)
 ifeq ($(CI_MODE),1)
-COPT = -DPBDRV_CONFIG_RUN_ON_CI
+COPT = -DPBDRV_CONFIG_RUN_ON_CI -DPBDRV_CONFIG_RUN_SIMULATED_CLOCK
+else ifeq ($(SIM_CLOCK),1)
+COPT = -DPBDRV_CONFIG_RUN_SIMULATED_CLOCK
 else
 endif
+ifeq ($(SIM_RADIO),1)
+COPT += -DPBDRV_CONFIG_RUN_SIMULATED_RADIO
+endif
 CFLAGS += $(INC) -Wall -Werror -Wdouble-promotion -Wfloat-conversion -std=gnu99 $(COPT) -D_GNU_SOURCE
 ifeq ($(UNAME_S),Linux)
 LDFLAGS += -Wl,-Map=$@.map,--cref -Wl,--gc-sections
@@ -7,18 +7,23 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <pbdrv/clock.h>
 #include <pbdrv/stack.h>
 
 #include <pbio/button.h>
 #include <pbio/main.h>
 #include <pbio/os.h>
+#include <pbio/tracepoint.h>
 #include <pbio/util.h>
 #include <pbio/protocol.h>
+#include <pbsys/host.h>
 #include <pbsys/main.h>
 #include <pbsys/program_stop.h>
 #include <pbsys/storage.h>
 
 #include <pybricks/common.h>
+#include <pybricks/parameters.h>
+#include <pybricks/tools.h>
 #include <pybricks/util_mp/pb_obj_helper.h>
 
 #include "genhdr/mpversion.h"
@@ -103,6 +108,9 @@ static void run_repl(void) {
 
     readline_init0();
 
+    // Interactive output should not wait for more data to be sent.
+    pbsys_host_stdout_set_line_buffered(true);
+
     nlr_buf_t nlr;
     nlr.ret_val = NULL;
 
@@ -134,6 +142,7 @@ static void run_repl(void) {
         print_final_exception(MP_OBJ_FROM_PTR(nlr.ret_val), ret);
     }
 
+    pbsys_host_stdout_set_line_buffered(false);
     nlr_set_abort(NULL);
 }
 #endif // PBSYS_CONFIG_FEATURE_BUILTIN_USER_PROGRAM_REPL
@@ -148,15 +157,6 @@ typedef struct {
     /** mpy data follows thereafter. */
 } mpy_info_t;
 
-// Program data is a concatenation of multiple mpy files. This sets a reference
-// to the first script and the total size so we can search for modules.
-static mpy_info_t *mpy_first;
-static mpy_info_t *mpy_end;
-static inline void mpy_data_init(pbsys_main_program_t *program) {
-    mpy_first = (mpy_info_t *)program->code_start;
-    mpy_end = (mpy_info_t *)program->code_end;
-}
-
 /**
  * Gets a reference to the mpy data of a script.
  * @param [in]  info    A pointer to an mpy info header.
@@ -167,19 +167,94 @@ static uint8_t *mpy_data_get_buf(mpy_info_t *info) {
     return (uint8_t *)info + sizeof(info->mpy_size) + strlen(info->mpy_name) + 1;
 }
 
+/** Entry in the index of downloaded modules. */
+typedef struct {
+    /** Hash of the module name, computed like qstr hashes. */
+    size_t hash;
+    /** The module info, or NULL if this entry is not used. */
+    mpy_info_t *info;
+} mpy_index_entry_t;
+
+// Program data is a concatenation of multiple mpy files. This sets a reference
+// to the first script and the total size so we can search for modules.
+static mpy_info_t *mpy_first;
+static mpy_info_t *mpy_end;
+
+// Hash table of all downloaded modules, using linear probing. The number of
+// entries is a power of two, with at least one empty entry.
+static mpy_index_entry_t *mpy_index;
+static size_t mpy_index_mask;
+
+static pb_startup_stats_t startup_stats;
+static uint32_t mpy_import_depth;
+
+const pb_startup_stats_t *pb_startup_stats_get(void) {
+    return &startup_stats;
+}
+
+/**
+ * Sets the program data reference and builds the module index at the end of
+ * user RAM. Must be called before the heap is initialized.
+ * @param [in]  program The program to run.
+ * @return              The end of the remaining user RAM for the heap.
+ */
+static void *mpy_data_init(pbsys_main_program_t *program) {
+    uint32_t time_start = pbdrv_clock_get_us();
+
+    mpy_first = (mpy_info_t *)program->code_start;
+    mpy_end = (mpy_info_t *)program->code_end;
+
+    // Count the modules to get the index size, at most half full.
+    size_t num_modules = 0;
+    for (mpy_info_t *info = mpy_first; (uintptr_t)info + sizeof(uint32_t) < (uintptr_t)mpy_end;
+         info = (mpy_info_t *)(mpy_data_get_buf(info) + pbio_get_uint32_le(info->mpy_size))) {
+        num_modules++;
+    }
+    size_t num_entries = 1;
+    while (num_entries < num_modules * 2) {
+        num_entries *= 2;
+    }
+
+    // Take the index from the end of user RAM.
+    uintptr_t index_start = (uintptr_t)program->user_ram_end - num_entries * sizeof(mpy_index_entry_t);
+    mpy_index = (mpy_index_entry_t *)(index_start & ~(sizeof(void *) - 1));
+    mpy_index_mask = num_entries - 1;
+    memset(mpy_index, 0, num_entries * sizeof(mpy_index_entry_t));
+
+    // Insert modules in order, so the first of any duplicates is found first.
+    for (mpy_info_t *info = mpy_first; (uintptr_t)info + sizeof(uint32_t) < (uintptr_t)mpy_end;
+         info = (mpy_info_t *)(mpy_data_get_buf(info) + pbio_get_uint32_le(info->mpy_size))) {
+        size_t hash = qstr_compute_hash((const byte *)info->mpy_name, strlen(info->mpy_name));
+        size_t i = hash & mpy_index_mask;
+        while (mpy_index[i].info) {
+            i = (i + 1) & mpy_index_mask;
+        }
+        mpy_index[i].hash = hash;
+        mpy_index[i].info = info;
+    }
+
+    startup_stats = (pb_startup_stats_t) {
+        .num_modules = num_modules,
+        .index_time_us = pbdrv_clock_get_us() - time_start,
+    };
+    mpy_import_depth = 0;
+
+    return mpy_index;
+}
+
 /**
  * Finds a MicroPython module in the program data.
  * @param [in]  name    The fully qualified name of the module.
- * @return              A pointer to the .mpy file in user RAM or NULL if the
- *                      module was not found.
+ * @return              A pointer to the .mpy file in user RAM or storage, or
+ *                      NULL if the module was not found.
  */
 static mpy_info_t *mpy_data_find(qstr name) {
     const char *name_str = qstr_str(name);
+    size_t hash = qstr_compute_hash((const byte *)name_str, qstr_len(name));
 
-    for (mpy_info_t *info = mpy_first; (uintptr_t)info + sizeof(uint32_t) < (uintptr_t)mpy_end;
-         info = (mpy_info_t *)(mpy_data_get_buf(info) + pbio_get_uint32_le(info->mpy_size))) {
-        if (strcmp(info->mpy_name, name_str) == 0) {
-            return info;
+    for (size_t i = hash & mpy_index_mask; mpy_index[i].info; i = (i + 1) & mpy_index_mask) {
+        if (mpy_index[i].hash == hash && strcmp(mpy_index[i].info->mpy_name, name_str) == 0) {
+            return mpy_index[i].info;
         }
     }
 
@@ -226,8 +301,10 @@ static void execute_rom_mpy_in_context(mp_module_context_t *module_context, mpy_
 
 /**
  * Runs the __main__ module from user RAM.
+ *
+ * @returns @c false if the VM was aborted, otherwise @c true.
  */
-static void run_user_program(void) {
+static bool run_user_program(void) {
     int ret = 0;
 
     nlr_buf_t nlr;
@@ -257,7 +334,7 @@ static void run_user_program(void) {
         // if vm abort
         if (nlr.ret_val == NULL) {
             // we are shutting down, so don't bother with cleanup
-            return;
+            return false;
         }
 
         // Clear any pending exceptions (and run any callbacks).
@@ -286,6 +363,7 @@ static void run_user_program(void) {
     }
 
     nlr_set_abort(NULL);
+    return true;
 }
 
 pbio_error_t pbsys_main_program_validate(pbsys_main_program_t *program) {
@@ -338,6 +416,20 @@ const char *pbsys_main_get_application_version_hash(void) {
     return MICROPY_GIT_HASH;
 }
 
+// Program whose state was kept in user RAM after it ended.
+static struct {
+    pbio_pybricks_user_program_id_t id;
+    void *code_start;
+    void *user_ram_start;
+} warm_state;
+
+// Whether the running program asked to keep its state when it ends.
+static bool warm_restart_requested;
+
+void pb_warm_restart_request(bool enable) {
+    warm_restart_requested = enable;
+}
+
 // Runs MicroPython with the given program data.
 void pbsys_main_run_program(pbsys_main_program_t *program) {
 
@@ -358,15 +450,46 @@ void pbsys_main_run_program(pbsys_main_program_t *program) {
     mp_cstack_init_with_sp_here(1024 * 1024);
     #endif
 
-    // MicroPython heap is the free RAM after program data.
-    gc_init(program->user_ram_start, program->user_ram_end);
+    // If the previous program kept its state, it can only be reused if this is
+    // the same program at the same place. Otherwise, clean it up now, before
+    // user RAM is used for anything else.
+    bool warm = program->keep_state && program->id == warm_state.id &&
+        program->code_start == warm_state.code_start &&
+        program->user_ram_start == warm_state.user_ram_start;
+    if (program->keep_state && !warm) {
+        gc_sweep_all();
+        mp_deinit();
+    }
+    program->keep_state = false;
+    warm_restart_requested = false;
 
     // Set program data reference to first script. This is used to run main,
-    // and to set the starting point for finding downloaded modules.
-    mpy_data_init(program);
+    // and to index the downloaded modules. The index is kept in user RAM.
+    void *heap_end = mpy_data_init(program);
 
-    // Initialize MicroPython.
-    mp_init();
+    uint32_t time_start = pbdrv_clock_get_us();
+
+    #if PYBRICKS_OPT_GC_STATS
+    pb_gc_stats_reset();
+    #if PYBRICKS_PY_PARAMETERS_IMAGE
+    pb_type_Image_reset_heap_used_max();
+    #endif
+    #endif
+
+    if (warm) {
+        // Imported modules are kept, but main runs again in a fresh scope.
+        mp_obj_dict_init(&MP_STATE_VM(dict_main), 1);
+        mp_obj_dict_store(MP_OBJ_FROM_PTR(&MP_STATE_VM(dict_main)), MP_OBJ_NEW_QSTR(MP_QSTR___name__), MP_OBJ_NEW_QSTR(MP_QSTR___main__));
+        MP_STATE_THREAD(mp_pending_exception) = MP_OBJ_NULL;
+        gc_collect();
+    } else {
+        // MicroPython heap is the free RAM after program data. If the program
+        // is executed in place, this includes the RAM copy of the program data.
+        gc_init(program->user_ram_start, heap_end);
+
+        // Initialize MicroPython.
+        mp_init();
+    }
 
     // Runs the requested downloaded or builtin user program.
     switch (program->id) {
@@ -395,8 +518,16 @@ void pbsys_main_run_program(pbsys_main_program_t *program) {
         default:
             // Init Pybricks package without auto-import.
             pb_package_pybricks_init(false);
+            startup_stats.init_time_us = pbdrv_clock_get_us() - time_start;
             // Run loaded user program (just slot 0 for now).
-            run_user_program();
+            if (run_user_program() && warm_restart_requested) {
+                // Keep the heap so the next run of this program can reuse
+                // the imported modules.
+                program->keep_state = true;
+                warm_state.id = program->id;
+                warm_state.code_start = program->code_start;
+                warm_state.user_ram_start = program->user_ram_start;
+            }
             break;
     }
 
@@ -405,15 +536,96 @@ void pbsys_main_run_program(pbsys_main_program_t *program) {
     pb_stdout_flush_to_new_line();
 }
 
-void pbsys_main_run_program_cleanup(void) {
+void pbsys_main_run_program_cleanup(pbsys_main_program_t *program) {
+    // Kept state is cleaned up when the next program starts, if needed.
+    if (program->keep_state) {
+        return;
+    }
     gc_sweep_all();
     mp_deinit();
 }
 
+#if PYBRICKS_OPT_GC_STATS
+
+// Upper bounds of all but the last histogram bucket, in microseconds.
+static const uint32_t gc_stats_bucket_max_us[PB_GC_STATS_NUM_BUCKETS - 1] = {
+    250, 500, 1000, 2000, 5000,
+};
+
+static pb_gc_stats_t gc_stats;
+static bool gc_stats_collecting;
+static uint32_t gc_stats_slice_start;
+static uint32_t gc_stats_slice_max;
+
+const pb_gc_stats_t *pb_gc_stats_get(void) {
+    return &gc_stats;
+}
+
+void pb_gc_stats_reset(void) {
+    memset(&gc_stats, 0, sizeof(gc_stats));
+}
+
+static void pb_gc_stats_slice_end(void) {
+    uint32_t slice_time = pbdrv_clock_get_us() - gc_stats_slice_start;
+    if (slice_time > gc_stats_slice_max) {
+        gc_stats_slice_max = slice_time;
+    }
+}
+
+// Called from the garbage collector loops instead of MICROPY_VM_HOOK_LOOP.
+void pb_gc_stats_hook_loop(void) {
+    // The hook is also called when allocating, which is not measured.
+    if (gc_stats_collecting) {
+        pb_gc_stats_slice_end();
+    }
+    MICROPY_VM_HOOK_LOOP
+    gc_stats_slice_start = pbdrv_clock_get_us();
+}
+
+#endif // PYBRICKS_OPT_GC_STATS
+
 void gc_collect(void) {
+    #if PYBRICKS_OPT_GC_STATS
+    uint32_t time_start = pbdrv_clock_get_us();
+    gc_stats_slice_start = time_start;
+    gc_stats_slice_max = 0;
+    gc_stats_collecting = true;
+    #endif
+
+    pbio_tracepoint_record(PBIO_TRACEPOINT_GC_START, 0, 0);
     gc_collect_start();
     gc_helper_collect_regs_and_stack();
     gc_collect_end();
+    pbio_tracepoint_record(PBIO_TRACEPOINT_GC_END, 0, 0);
+
+    #if PYBRICKS_OPT_GC_STATS
+    pb_gc_stats_slice_end();
+    gc_stats_collecting = false;
+
+    // The total includes the time spent in the event loop.
+    uint32_t collection_time = pbdrv_clock_get_us() - time_start;
+    if (collection_time > gc_stats.collection_time_max_us) {
+        gc_stats.collection_time_max_us = collection_time;
+    }
+    if (gc_stats_slice_max > gc_stats.pause_time_max_us) {
+        gc_stats.pause_time_max_us = gc_stats_slice_max;
+    }
+
+    // Count the longest pause of this collection in the histogram.
+    size_t bucket = 0;
+    while (bucket < MP_ARRAY_SIZE(gc_stats_bucket_max_us) && gc_stats_slice_max >= gc_stats_bucket_max_us[bucket]) {
+        bucket++;
+    }
+    gc_stats.pause_histogram[bucket]++;
+    gc_stats.num_collections++;
+
+    // What is left after collecting is what the program really needs.
+    gc_info_t info;
+    gc_info(&info);
+    if (info.used > gc_stats.heap_used_max) {
+        gc_stats.heap_used_max = info.used;
+    }
+    #endif
 }
 
 mp_obj_t mp_builtin_open(size_t n_args, const mp_obj_t *args, mp_map_t *kwargs) {
@@ -453,11 +665,29 @@ mp_obj_t pb_builtin_import(size_t n_args, const mp_obj_t *args) {
 
     // If a downloaded module was found but not yet loaded, load it.
     if (info) {
+        // Modules imported by this module are timed as part of this one.
+        uint32_t time_start = pbdrv_clock_get_us();
+        startup_stats.num_imports++;
+
         // Create new module.
         mp_module_context_t *module_context = mp_obj_new_module(module_name_qstr);
 
-        // Execute the module in that context.
-        execute_rom_mpy_in_context(module_context, info);
+        // Execute the module in that context, keeping the depth in sync if
+        // the module raises.
+        nlr_buf_t nlr;
+        mpy_import_depth++;
+        if (nlr_push(&nlr) == 0) {
+            execute_rom_mpy_in_context(module_context, info);
+            nlr_pop();
+        } else {
+            mpy_import_depth--;
+            nlr_jump(nlr.ret_val);
+        }
+        mpy_import_depth--;
+
+        if (mpy_import_depth == 0) {
+            startup_stats.import_time_us += pbdrv_clock_get_us() - time_start;
+        }
 
         // Return the newly imported module.
         return MP_OBJ_FROM_PTR(module_context);
@@ -41,10 +41,14 @@
 #else
 #define MICROPY_QSTR_BYTES_IN_HASH              (0)
 #endif
+// Caches where recent attribute lookups were found in their map, so methods
+// called over and over again in a loop do not search the type each time.
+#define MICROPY_OPT_MAP_LOOKUP_CACHE            (PYBRICKS_OPT_EXTRA_LEVEL2)
 #define MICROPY_ALLOC_PATH_MAX                  (256)
 #define MICROPY_ALLOC_PARSE_CHUNK_INIT          (16)
 #define MICROPY_EMIT_X64                        (PYBRICKS_OPT_NATIVE_MOD && __x86_64__)
-#define MICROPY_EMIT_THUMB                      (PYBRICKS_OPT_NATIVE_MOD && __thumb2__)
+#define MICROPY_EMIT_THUMB                      ((PYBRICKS_OPT_NATIVE_MOD || PYBRICKS_OPT_NATIVE_EMIT) && __thumb2__)
+#define MICROPY_EMIT_ARM                        (PYBRICKS_OPT_NATIVE_EMIT && __arm__ && !__thumb__)
 #define MICROPY_EMIT_INLINE_THUMB               (0)
 #define MICROPY_COMP_MODULE_CONST               (0)
 #define MICROPY_COMP_CONST                      (0)
@@ -124,9 +128,20 @@
 
 #define MICROPY_MPHALPORT_H "../_common/mphalport.h"
 
+// Native code is written to the heap, so make sure it can be executed.
+#if PYBRICKS_OPT_NATIVE_MOD || PYBRICKS_OPT_NATIVE_EMIT
+#define MP_PLAT_COMMIT_EXEC(buf, len, reloc) \
+    ({ extern void *pb_native_code_commit(void *, size_t, void *); pb_native_code_commit(buf, len, reloc); })
+#endif
+
 // type definitions for the specific machine
 
+#if MICROPY_EMIT_ARM
+// Native code on EV3 is Arm code, so the pointer must not select Thumb state.
+#define MICROPY_MAKE_POINTER_CALLABLE(p) ((void *)(p))
+#else
 #define MICROPY_MAKE_POINTER_CALLABLE(p) ((void *)((mp_uint_t)(p) | 1))
+#endif
 
 // This port is intended to be 32-bit, but unfortunately, int32_t for
 // different targets may be defined in different ways - either as int
@@ -155,18 +170,56 @@ typedef long mp_off_t;
 #define PYBRICKS_VM_HOOK_LOOP_EXTRA
 #endif
 
+// Sampling profiler for user programs. It needs the frame tracking of
+// sys.settrace, which makes the VM bigger and slower, so it is off by default.
+// Builds can enable it with CFLAGS_EXTRA=-DPYBRICKS_OPT_PROFILER=1.
+#ifndef PYBRICKS_OPT_PROFILER
+#define PYBRICKS_OPT_PROFILER                   (0)
+#endif
+
+#if PYBRICKS_OPT_PROFILER
+// These are the settings that MicroPython requires for sys.settrace.
+#define MICROPY_PY_SYS_SETTRACE                 (1)
+#define MICROPY_PERSISTENT_CODE_SAVE            (1)
+#define MICROPY_COMP_CONST                      (0)
+#define PYBRICKS_VM_HOOK_PROFILER \
+    extern bool pb_profiler_is_active; \
+    if (pb_profiler_is_active) { \
+        extern void pb_profiler_hook_loop(void); \
+        pb_profiler_hook_loop(); \
+    }
+#else
+#define PYBRICKS_VM_HOOK_PROFILER
+#endif
+
+// This runs on every backward jump, so the pending flag is checked here to
+// avoid a function call when there is nothing to do.
 #define MICROPY_VM_HOOK_LOOP \
     do { \
         PYBRICKS_VM_HOOK_LOOP_EXTRA \
-        extern bool pbio_os_run_processes_once(void); \
-        pbio_os_run_processes_once(); \
+        PYBRICKS_VM_HOOK_PROFILER \
+        extern volatile bool pbio_os_poll_request_is_pending; \
+        if (pbio_os_poll_request_is_pending) { \
+            extern bool pbio_os_run_processes_once(void); \
+            pbio_os_run_processes_once(); \
+        } \
     } while (0);
 
+#if PYBRICKS_OPT_GC_STATS
+// Same as below, but also measures the time between event loop passes.
+#define MICROPY_GC_HOOK_LOOP(i) do { \
+        if (((i) & 0xf) == 0) { \
+            extern void pb_gc_stats_hook_loop(void); \
+            pb_gc_stats_hook_loop(); \
+        } \
+} while (0)
+#else
 #define MICROPY_GC_HOOK_LOOP(i) do { \
         if (((i) & 0xf) == 0) { \
             MICROPY_VM_HOOK_LOOP \
         } \
 } while (0)
+#endif
 
 #define MICROPY_INTERNAL_EVENT_HOOK \
     do { \
@@ -182,6 +235,10 @@ typedef long mp_off_t;
         pbio_os_run_processes_and_wait_for_event(); \
     } while (0);
 
+// Run the bytecode dispatch loop from RAM alongside the motor control path.
+#include <pbio/util.h>
+#define MICROPY_WRAP_MP_EXECUTE_BYTECODE(f) PBIO_HOT f
+
 // We need to provide a declaration/definition of alloca()
 #include <alloca.h>
 
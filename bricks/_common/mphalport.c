@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <pbdrv/cache.h>
 #include <pbdrv/clock.h>
 #include <pbdrv/config.h>
 #include <pbio/main.h>
@@ -15,6 +16,7 @@
 #include "py/runtime.h"
 #include "py/mphal.h"
 #include "py/mpconfig.h"
+#include "py/persistentcode.h"
 #include "py/stream.h"
 
 // Core delay function that does an efficient sleep and may switch thread context.
@@ -46,6 +48,9 @@ int mp_hal_stdin_rx_chr(void) {
     uint32_t size;
     uint8_t c;
 
+    // Make sure prompts are visible before waiting for the reply.
+    pbsys_host_stdout_flush();
+
     // wait for rx interrupt
     while (size = 1, pbsys_host_stdin_read(&c, &size) != PBIO_SUCCESS) {
         mp_event_wait_indefinite();
@@ -83,6 +88,8 @@ mp_uint_t mp_hal_stdout_tx_strn(const char *str, size_t len) {
 }
 
 static void pb_stdout_flush(void) {
+    pbsys_host_stdout_flush();
+
     // Don't raise, just wait for data to clear.
     while (!pbsys_host_tx_is_idle()) {
         MICROPY_VM_HOOK_LOOP;
@@ -112,3 +119,32 @@ void pb_stdout_flush_to_new_line(void) {
         pb_stdout_flush();
     }
 }
+
+#if MICROPY_EMIT_MACHINE_CODE
+
+/**
+ * Makes native code that was just written to the heap ready for execution.
+ *
+ * Code is kept on the regular heap, which is executable on all hubs, so it is
+ * not moved. It only has to be relocated in place and written out of the
+ * caches.
+ *
+ * @param [in]  buf     The code.
+ * @param [in]  len     Size of the code.
+ * @param [in]  reloc   Relocation information for viper code, or NULL.
+ * @returns             The code, which can now be executed.
+ */
+void *pb_native_code_commit(void *buf, size_t len, void *reloc) {
+    if (reloc) {
+        mp_native_relocate(reloc, buf, (uintptr_t)buf);
+    }
+    #if PBDRV_CONFIG_CACHE
+    pbdrv_cache_prepare_exec(buf, len);
+    #elif __thumb2__
+    // No caches, but the code must be written before it is fetched.
+    __asm volatile ("dsb\n\tisb" : : : "memory");
+    #endif
+    return buf;
+}
+
+#endif // MICROPY_EMIT_MACHINE_CODE
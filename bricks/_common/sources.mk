@@ -88,11 +88,13 @@ PYBRICKS_PYBRICKS_SRC_C = $(addprefix pybricks/,\
 	robotics/pb_type_drivebase.c \
 	robotics/pb_type_spikebase.c \
 	tools/pb_module_tools.c \
+	tools/pb_profiler.c \
 	tools/pb_type_app_data.c \
 	tools/pb_type_async.c \
 	tools/pb_type_matrix.c \
 	tools/pb_type_stopwatch.c \
 	tools/pb_type_task.c \
+	tools/pb_type_ticker.c \
 	util_mp/pb_obj_helper.c \
 	util_mp/pb_type_enum.c \
 	util_pb/pb_color_map.c \
@@ -103,6 +105,7 @@ PYBRICKS_PYBRICKS_SRC_C = $(addprefix pybricks/,\
 # Pybricks I/O library
 
 PBIO_SRC_C = $(addprefix lib/pbio/,\
+	drv/adc/adc_capture.c \
 	drv/adc/adc_ev3.c \
 	drv/adc/adc_nxt.c \
 	drv/adc/adc_stm32_hal.c \
@@ -113,6 +116,7 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/battery/battery_test.c \
 	drv/block_device/block_device_ev3.c \
 	drv/block_device/block_device_flash_stm32.c \
+	drv/block_device/block_device_journal_ram.c \
 	drv/block_device/block_device_test.c \
 	drv/block_device/block_device_w25qxx_stm32.c \
 	drv/bluetooth/bluetooth.c \
@@ -125,6 +129,7 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/bluetooth/firmware/bluetooth_init_cc2564C_1.4.c \
 	drv/bluetooth/firmware/bluetooth_init_cc2560.c \
 	drv/bluetooth/firmware/bluetooth_init_cc2560a.c \
+	drv/bluetooth/bluetooth_simulation.c \
 	drv/bluetooth/pybricks_service_server.c \
 	drv/button/button_gpio.c \
 	drv/button/button_nxt.c \
@@ -141,11 +146,13 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/clock/clock_stm32.c \
 	drv/clock/clock_test.c \
 	drv/core.c \
+	drv/counter/counter_edge.c \
 	drv/counter/counter_ev3.c \
 	drv/counter/counter_nxt.c \
 	drv/counter/counter_stm32f0_gpio_quad_enc.c \
 	drv/display/display_ev3.c \
 	drv/display/display_nxt.c \
+	drv/display/display_st7586s.c \
 	drv/display/display_virtual.c \
 	drv/gpio/gpio_ev3.c \
 	drv/gpio/gpio_nxt.c \
@@ -201,13 +208,16 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/watchdog/watchdog_ev3.c \
 	drv/watchdog/watchdog_stm32.c \
 	platform/$(PBIO_PLATFORM)/platform.c \
+	src/adpcm.c \
 	src/angle.c \
 	src/battery.c \
 	src/busy_count.c \
+	src/clock_sync.c \
 	src/color/conversion.c \
 	src/color/util.c \
 	src/control_settings.c \
 	src/control.c \
+	src/control_recorder.c \
 	src/debug.c \
 	src/dcmotor.c \
 	src/differentiator.c \
@@ -225,12 +235,15 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	src/light/color_light.c \
 	src/light/light_matrix.c \
 	src/logger.c \
+	src/lz4.c \
+	src/mailbox.c \
 	src/main.c \
 	src/motor_process.c \
 	src/motor/servo_settings.c \
 	src/observer.c \
 	src/os.c \
 	src/parent.c \
+	src/pf_ir.c \
 	src/port_dcm_ev3.c \
 	src/port_dcm_pup.c \
 	src/port_lump.c \
@@ -239,12 +252,15 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	src/protocol/pybricks.c \
 	src/servo.c \
 	src/tacho.c \
+	src/trace.c \
+	src/tracepoint.c \
 	src/trajectory.c \
 	src/util.c \
 	sys/battery_temp.c \
 	sys/battery.c \
 	sys/command.c \
 	sys/core.c \
+	sys/echo.c \
 	sys/hmi_ev3.c \
 	sys/hmi_ev3_ui.c \
 	sys/hmi_none.c \
@@ -254,8 +270,10 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	sys/host.c \
 	sys/light.c \
 	sys/main.c \
+	sys/motion.c \
 	sys/program_stop.c \
 	sys/status.c \
+	sys/storage_kv.c \
 	sys/storage_settings.c \
 	sys/storage.c \
 	sys/telemetry.c \
@@ -70,5 +70,10 @@
 #define PYBRICKS_OPT_EXTRA_LEVEL2               (1)
 #define PYBRICKS_OPT_CUSTOM_IMPORT              (1)
 #define PYBRICKS_OPT_NATIVE_MOD                 (1)
+// Enabled in the opt-in variant built with NATIVE_EMIT=1.
+#ifndef PYBRICKS_OPT_NATIVE_EMIT
+#define PYBRICKS_OPT_NATIVE_EMIT                (0)
+#endif
+#define PYBRICKS_OPT_GC_STATS                   (1)
 
 #include "../_common/mpconfigport.h"
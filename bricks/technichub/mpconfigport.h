@@ -66,5 +66,7 @@
 #define PYBRICKS_OPT_EXTRA_LEVEL2               (0)
 #define PYBRICKS_OPT_CUSTOM_IMPORT              (1)
 #define PYBRICKS_OPT_NATIVE_MOD                 (0)
+#define PYBRICKS_OPT_NATIVE_EMIT                (0)
+#define PYBRICKS_OPT_GC_STATS                   (0)
 
 #include "../_common/mpconfigport.h"
@@ -68,6 +68,8 @@
 #define PYBRICKS_OPT_EXTRA_LEVEL2               (1)
 #define PYBRICKS_OPT_CUSTOM_IMPORT              (0)
 #define PYBRICKS_OPT_NATIVE_MOD                 (0)
+#define PYBRICKS_OPT_NATIVE_EMIT                (0)
+#define PYBRICKS_OPT_GC_STATS                   (1)
 
 // The Virtual Hub has no hardware interrupt that requests polling every 1ms.
 // We solve this by polling manually as appropriate for the simulation, as
@@ -27,6 +27,11 @@ void pbio_os_hook_wait_for_interrupt(pbio_os_irq_flags_t flags) {
     pbio_test_clock_tick(1);
 }
 
+void pbio_os_hook_wait_for_interrupt_tickless(pbio_os_irq_flags_t flags, uint32_t duration) {
+    // Nothing can happen until the next timer expires, so skip ahead to it.
+    pbio_test_clock_tick(duration);
+}
+
 #else
 
 pbio_os_irq_flags_t pbio_os_hook_disable_irq(void) {
@@ -53,6 +53,26 @@ tBleStatus aci_l2cap_connection_parameter_update_request(uint16_t conn_handle, u
   return status;
 }
 
+void aci_l2cap_connection_parameter_update_request_begin(uint16_t conn_handle, uint16_t interval_min,
+                                                         uint16_t interval_max, uint16_t slave_latency,
+                                                         uint16_t timeout_multiplier)
+{
+  struct hci_request rq;
+  l2cap_conn_param_update_req_cp cp;
+
+  cp.conn_handle = htobs(conn_handle);
+  cp.interval_min = htobs(interval_min);
+  cp.interval_max = htobs(interval_max);
+  cp.slave_latency = htobs(slave_latency);
+  cp.timeout_multiplier = htobs(timeout_multiplier);
+
+  rq.opcode = cmd_opcode_pack(OGF_VENDOR_CMD, OCF_L2CAP_CONN_PARAM_UPDATE_REQ);
+  rq.cparam = &cp;
+  rq.clen = L2CAP_CONN_PARAM_UPDATE_REQ_CP_SIZE;
+
+  hci_send_req(&rq);
+}
+
 tBleStatus aci_l2cap_connection_parameter_update_response(uint16_t conn_handle, uint16_t interval_min,
                                                          uint16_t interval_max, uint16_t slave_latency,
                                                          uint16_t timeout_multiplier, uint16_t min_ce_length, uint16_t max_ce_length,
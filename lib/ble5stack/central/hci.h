@@ -7,5 +7,6 @@ HCI_StatusCodes_t HCI_readBdaddr(void);
 HCI_StatusCodes_t HCI_readLocalVersionInfo(void);
 HCI_StatusCodes_t HCI_LE_readAdvertisingChannelTxPower(void);
 HCI_StatusCodes_t HCI_LE_setAdvertisingData(uint8_t len, uint8_t *data);
+HCI_StatusCodes_t HCI_LE_setDataLength(uint16_t connHandle, uint16_t txOctets, uint16_t txTime);
 
 #endif // HCI_H
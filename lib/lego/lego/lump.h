@@ -301,6 +301,26 @@ typedef enum {
     LUMP_CMD_VERSION = 0x7,
 } lump_cmd_t;
 
+/**
+ * Combi mode setup sub-command of ::LUMP_CMD_WRITE (Powered Up devices only).
+ *
+ * The payload is this value or'ed with the index of the mode combination,
+ * followed by one ::LUMP_COMBI_VALUE byte for each dataset to report. The
+ * device then sends ::LUMP_MSG_TYPE_DATA messages with the selected datasets
+ * concatenated in this order.
+ */
+#define LUMP_WRITE_COMBI_SETUP 0x20
+
+/**
+ * Encodes a mode and dataset index for ::LUMP_WRITE_COMBI_SETUP.
+ */
+#define LUMP_COMBI_VALUE(mode, dataset) (((mode) << 4) | ((dataset) & 0x0F))
+
+/**
+ * The maximum number of datasets in a mode combination.
+ */
+#define LUMP_MAX_COMBI_VALUES 8
+
 /**
  * Mode information message type.
  *
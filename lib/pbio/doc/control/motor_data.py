@@ -1,8 +1,15 @@
 #!/usr/bin/env python3
 
 import math
+import sys
 from motor_model import HEADER, make_model
 
+# Control loop time in milliseconds, matching PBIO_CONFIG_CONTROL_LOOP_TIME_MS.
+# The model sample times below are given for the default loop time of 5 ms
+# and scaled accordingly.
+LOOP_TIME_MS = int(sys.argv[1]) if len(sys.argv) > 1 else 5
+LOOP_SCALE = LOOP_TIME_MS / 5
+
 # Portion of the header that goes in <pbio/observer.h>
 print(HEADER)
 
@@ -27,7 +34,7 @@ print(
         w_0=13.3,
         a=math.radians(880 / 0.04),
         Lm=0.0008 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -44,7 +51,7 @@ print(
         w_0=16.6,
         a=math.radians(920 / 0.035),
         Lm=0.0008 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -61,7 +68,7 @@ print(
         w_0=16.6,
         a=math.radians(800 / 0.04),
         Lm=0.0004 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -79,7 +86,7 @@ print(
         w_0=rpm_to_rad_s(255),
         a=math.radians(3000 / 0.1),
         Lm=0.0002 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -96,7 +103,7 @@ print(
         w_0=rpm_to_rad_s(315),
         a=math.radians(3000 / 0.1),
         Lm=0.0003 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -113,7 +120,7 @@ print(
         w_0=rpm_to_rad_s(330),
         a=math.radians(3000 / 0.1),
         Lm=0.0002 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -132,7 +139,7 @@ print(
         w_0=rpm_to_rad_s(350),
         a=math.radians(3000 / 0.1),
         Lm=0.0002 * 30,
-        h=0.005,
+        h=0.005 * LOOP_SCALE,
     )
 )
 
@@ -155,7 +162,7 @@ print(
         w_0=rpm_to_rad_s(170),
         a=math.radians(1000 / 0.1),
         Lm=0.0005 * 30,
-        h=0.01,
+        h=0.01 * LOOP_SCALE,
     )
 )
 
@@ -172,7 +179,7 @@ print(
         w_0=rpm_to_rad_s(175),
         a=math.radians(1000 / 0.1),
         Lm=0.0005 * 30,
-        h=0.01,
+        h=0.01 * LOOP_SCALE,
     )
 )
 
@@ -189,7 +196,7 @@ print(
         w_0=rpm_to_rad_s(260),
         a=math.radians(2000 / 0.1),
         Lm=0.0008 * 30,
-        h=0.01,
+        h=0.01 * LOOP_SCALE,
     )
 )
 print("\n#endif // PBIO_CONFIG_SERVO_EV3_NXT")
@@ -89,13 +89,9 @@ MAX_NUM_CURRENT = math.floor((MAX_SI_CURRENT * c_i))
 MAX_NUM_VOLTAGE = math.floor((MAX_SI_VOLTAGE * c_V))
 MAX_NUM_TORQUE = math.floor((MAX_SI_TORQUE * c_tau))
 
-# Prescalers such that signal * prescale does not exceed INT32_MAX.
-INT32_MAX = 2147483647
-PRESCALE_SPEED = INT32_MAX // MAX_NUM_SPEED
-PRESCALE_ACCELERATION = INT32_MAX // MAX_NUM_ACCELERATION
-PRESCALE_CURRENT = INT32_MAX // MAX_NUM_CURRENT
-PRESCALE_VOLTAGE = INT32_MAX // MAX_NUM_VOLTAGE
-PRESCALE_TORQUE = INT32_MAX // MAX_NUM_TORQUE
+# Model coefficients are stored as fixed point values scaled by 2**MODEL_SHIFT.
+MODEL_SHIFT = 24
+MODEL_SCALE = 2**MODEL_SHIFT
 
 HEADER = textwrap.dedent(
     f"""
@@ -105,11 +101,7 @@ HEADER = textwrap.dedent(
     #define MAX_NUM_CURRENT ({MAX_NUM_CURRENT})
     #define MAX_NUM_VOLTAGE ({MAX_NUM_VOLTAGE})
     #define MAX_NUM_TORQUE ({MAX_NUM_TORQUE})
-    #define PRESCALE_SPEED ({PRESCALE_SPEED})
-    #define PRESCALE_ACCELERATION ({PRESCALE_ACCELERATION})
-    #define PRESCALE_CURRENT ({PRESCALE_CURRENT})
-    #define PRESCALE_VOLTAGE ({PRESCALE_VOLTAGE})
-    #define PRESCALE_TORQUE ({PRESCALE_TORQUE})
+    #define MODEL_SHIFT ({MODEL_SHIFT})
 
     typedef struct _pbio_observer_model_t {{
         int32_t d_angle_d_speed;
@@ -165,33 +157,33 @@ def make_model(name, *, V, tau_0, tau_x, w_0, w_x, i_0, i_x, a, Lm, h):
     # angle_next += a_01 * speed + a_02 * current ....
     #
     # The matrix entries a_ij are floating point values, but we want to
-    # evaluate everything using 32-bit signed integers. So instead of
-    # storing the floating point values, we store their inverse, prescaled
-    # by an appropriate scaling factor:
+    # evaluate everything using integers, without divisions since some hubs
+    # have no hardware divider. So we store them as fixed point values:
     #
-    # angle_next = speed_prescale * speed / (speed_prescale / a_01)
+    # angle_next = (speed * (a_01 * 2**MODEL_SHIFT)) >> MODEL_SHIFT
     #
-    # The term (speed_prescale / a_01) is stored as a single integer.
+    # The term (a_01 * 2**MODEL_SHIFT) is stored as a single integer. The
+    # product is evaluated with 64-bit intermediate precision.
     #
     return textwrap.dedent(
         f"""
         static const pbio_observer_model_t model_{name} = {{
-            .d_angle_d_speed = {round(PRESCALE_SPEED / A[0, 1])},
-            .d_speed_d_speed = {round(PRESCALE_SPEED / A[1, 1])},
-            .d_current_d_speed = {round(PRESCALE_SPEED / A[2, 1])},
-            .d_angle_d_current = {round(PRESCALE_CURRENT / A[0, 2])},
-            .d_speed_d_current = {round(PRESCALE_CURRENT / A[1, 2])},
-            .d_current_d_current = {round(PRESCALE_CURRENT / A[2, 2])},
-            .d_angle_d_voltage = {round(PRESCALE_VOLTAGE / B[0, 0])},
-            .d_speed_d_voltage = {round(PRESCALE_VOLTAGE / B[1, 0])},
-            .d_current_d_voltage = {round(PRESCALE_VOLTAGE / B[2, 0])},
-            .d_angle_d_torque = {round(PRESCALE_TORQUE / B[0, 1])},
-            .d_speed_d_torque = {round(PRESCALE_TORQUE / B[1, 1])},
-            .d_current_d_torque = {round(PRESCALE_TORQUE / B[2, 1])},
-            .d_voltage_d_torque = {round(PRESCALE_TORQUE / dv_dtau.subs(model).evalf())},
-            .d_torque_d_voltage = {round(PRESCALE_VOLTAGE / dtau_dv.subs(model).evalf())},
-            .d_torque_d_speed = {round(PRESCALE_SPEED / dtau_dw.subs(model).evalf())},
-            .d_torque_d_acceleration = {round(PRESCALE_ACCELERATION / dtau_da.subs(model).evalf())},
+            .d_angle_d_speed = {round(MODEL_SCALE * A[0, 1])},
+            .d_speed_d_speed = {round(MODEL_SCALE * A[1, 1])},
+            .d_current_d_speed = {round(MODEL_SCALE * A[2, 1])},
+            .d_angle_d_current = {round(MODEL_SCALE * A[0, 2])},
+            .d_speed_d_current = {round(MODEL_SCALE * A[1, 2])},
+            .d_current_d_current = {round(MODEL_SCALE * A[2, 2])},
+            .d_angle_d_voltage = {round(MODEL_SCALE * B[0, 0])},
+            .d_speed_d_voltage = {round(MODEL_SCALE * B[1, 0])},
+            .d_current_d_voltage = {round(MODEL_SCALE * B[2, 0])},
+            .d_angle_d_torque = {round(MODEL_SCALE * B[0, 1])},
+            .d_speed_d_torque = {round(MODEL_SCALE * B[1, 1])},
+            .d_current_d_torque = {round(MODEL_SCALE * B[2, 1])},
+            .d_voltage_d_torque = {round(MODEL_SCALE * dv_dtau.subs(model).evalf())},
+            .d_torque_d_voltage = {round(MODEL_SCALE * dtau_dv.subs(model).evalf())},
+            .d_torque_d_speed = {round(MODEL_SCALE * dtau_dw.subs(model).evalf())},
+            .d_torque_d_acceleration = {round(MODEL_SCALE * dtau_da.subs(model).evalf())},
             .torque_friction = {round(tau_s * c_tau)},
         }};"""
     )
@@ -18,4 +18,34 @@ void pbdrv_adc_init(void);
 
 #endif // PBDRV_CONFIG_ADC
 
+#if PBDRV_CONFIG_ADC_CAPTURE
+
+#include <stdint.h>
+
+#include <pbio/error.h>
+
+/**
+ * Sets the time between ADC samples. Implemented by the platform driver.
+ *
+ * @param [in]  period_us   Time between samples in microseconds, or 0 to
+ *                          restore the default period.
+ * @return                  ::PBIO_SUCCESS on success or
+ *                          ::PBIO_ERROR_INVALID_ARG if the platform does not
+ *                          support this period.
+ */
+pbio_error_t pbdrv_adc_set_sample_period(uint32_t period_us);
+
+/**
+ * Stores the latest sample of the captured channel, if a capture is active.
+ * Called by the platform driver each time new samples are available. This may
+ * be called from an interrupt handler.
+ */
+void pbdrv_adc_capture_handle_new_samples(void);
+
+#else // PBDRV_CONFIG_ADC_CAPTURE
+
+#define pbdrv_adc_capture_handle_new_samples()
+
+#endif // PBDRV_CONFIG_ADC_CAPTURE
+
 #endif // _INTERNAL_PBDRV_ADC_H_
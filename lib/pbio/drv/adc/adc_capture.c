@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Continuous capture of one ADC channel into a buffer, at a fixed rate set
+// by the platform driver.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_ADC_CAPTURE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbdrv/adc.h>
+
+#include <pbio/error.h>
+#include <pbio/os.h>
+
+#include "adc.h"
+
+static struct {
+    /** Buffer for the captured samples. */
+    uint16_t *buf;
+    /** Size of the buffer, in samples. */
+    uint32_t len;
+    /** Number of samples captured so far. */
+    volatile uint32_t count;
+    /** Number of driver samples that are averaged into one captured sample. */
+    uint32_t decimation;
+    /** Sum of driver samples for the captured sample in progress. */
+    uint32_t sum;
+    /** Number of driver samples in ::sum. */
+    uint32_t num_summed;
+    /** The captured channel. */
+    uint8_t ch;
+    /** Whether a capture is in progress. */
+    volatile bool active;
+} capture;
+
+/**
+ * Starts capturing samples of one ADC channel into a buffer.
+ *
+ * Samples are taken at a fixed rate by the driver, without involving the
+ * caller, so the samples are evenly spaced. Any capture in progress is
+ * stopped. Only one channel can be captured at a time.
+ *
+ * @param [in]  ch          The ADC channel.
+ * @param [in]  buf         Buffer for the raw samples, which must remain
+ *                          valid until the capture completes or is stopped.
+ * @param [in]  len         Number of samples to capture.
+ * @param [in]  period_us   Time between captured samples in microseconds.
+ * @param [in]  decimation  Number of samples taken by the driver per captured
+ *                          sample. These are averaged, which also filters out
+ *                          noise above the capture rate.
+ * @return                  ::PBIO_SUCCESS on success or
+ *                          ::PBIO_ERROR_INVALID_ARG if an argument is invalid
+ *                          or the period is not supported on this platform.
+ */
+pbio_error_t pbdrv_adc_capture_start(uint8_t ch, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+
+    pbdrv_adc_capture_stop();
+
+    uint16_t value;
+    if (!buf || !len || !decimation || period_us % decimation || pbdrv_adc_get_ch(ch, &value) != PBIO_SUCCESS) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbio_error_t err = pbdrv_adc_set_sample_period(period_us / decimation);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    capture.buf = buf;
+    capture.len = len;
+    capture.count = 0;
+    capture.decimation = decimation;
+    capture.sum = 0;
+    capture.num_summed = 0;
+    capture.ch = ch;
+    capture.active = true;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Awaits until the buffer of the capture is full.
+ *
+ * @param [in]  state       Protothread state.
+ * @return                  ::PBIO_SUCCESS when the buffer is full,
+ *                          ::PBIO_ERROR_AGAIN while capturing or
+ *                          ::PBIO_ERROR_CANCELED if the capture was stopped
+ *                          before it completed.
+ */
+pbio_error_t pbdrv_adc_capture_await(pbio_os_state_t *state) {
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT_WHILE(state, capture.active);
+
+    PBIO_OS_ASYNC_END(capture.buf && capture.count == capture.len ? PBIO_SUCCESS : PBIO_ERROR_CANCELED);
+}
+
+/**
+ * Gets the number of samples captured so far.
+ *
+ * @return                  Number of samples.
+ */
+uint32_t pbdrv_adc_capture_get_count(void) {
+    return capture.count;
+}
+
+/**
+ * Stops capturing samples and restores the default sample rate.
+ */
+void pbdrv_adc_capture_stop(void) {
+    if (capture.active) {
+        capture.active = false;
+        pbdrv_adc_set_sample_period(0);
+    }
+}
+
+void pbdrv_adc_capture_handle_new_samples(void) {
+    if (!capture.active) {
+        return;
+    }
+
+    uint16_t value;
+    pbdrv_adc_get_ch(capture.ch, &value);
+    capture.sum += value;
+    if (++capture.num_summed < capture.decimation) {
+        return;
+    }
+
+    capture.buf[capture.count++] = capture.sum / capture.decimation;
+    capture.sum = 0;
+    capture.num_summed = 0;
+
+    if (capture.count == capture.len) {
+        capture.active = false;
+        pbdrv_adc_set_sample_period(0);
+        pbio_os_request_poll();
+    }
+}
+
+#endif // PBDRV_CONFIG_ADC_CAPTURE
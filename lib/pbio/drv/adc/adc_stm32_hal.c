@@ -33,6 +33,8 @@
 
 #include STM32_HAL_H
 
+#include "adc.h"
+
 #define PBDRV_ADC_PERIOD_MS 10  // polling period in milliseconds
 
 static TIM_HandleTypeDef pbdrv_adc_htim;
@@ -62,8 +64,29 @@ void pbdrv_adc_stm32_hal_handle_irq(void) {
 }
 
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) {
-    // not used
+    // Called by the DMA interrupt after each conversion of all channels.
+    pbdrv_adc_capture_handle_new_samples();
+}
+
+#if PBDRV_CONFIG_ADC_CAPTURE
+pbio_error_t pbdrv_adc_set_sample_period(uint32_t period_us) {
+    if (period_us == 0) {
+        period_us = PBDRV_ADC_PERIOD_MS * 1000;
+    }
+
+    // Conversions of all channels must complete within one period.
+    if (period_us < 100) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // The timer counts microseconds.
+    __HAL_TIM_SET_AUTORELOAD(&pbdrv_adc_htim, period_us - 1);
+    if (__HAL_TIM_GET_COUNTER(&pbdrv_adc_htim) >= period_us) {
+        __HAL_TIM_SET_COUNTER(&pbdrv_adc_htim, 0);
+    }
+    return PBIO_SUCCESS;
 }
+#endif // PBDRV_CONFIG_ADC_CAPTURE
 
 void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc) {
     pbdrv_adc_error_count++;
@@ -7,14 +7,32 @@
 
 #if PBDRV_CONFIG_BATTERY_TEST
 
+#include <stdbool.h>
+
 #include <pbdrv/battery.h>
 #include <pbio/error.h>
 
+#include "battery_test.h"
+
+static uint16_t test_voltage = 7200;
+static uint16_t test_current;
+static bool test_current_supported;
+
+void pbio_test_battery_set_voltage(uint16_t voltage) {
+    test_voltage = voltage;
+}
+
+// Current is not supported until a test sets it.
+void pbio_test_battery_set_current(uint16_t current) {
+    test_current = current;
+    test_current_supported = true;
+}
+
 void pbdrv_battery_init(void) {
 }
 
 pbio_error_t pbdrv_battery_get_voltage_now(uint16_t *value) {
-    *value = 7200;
+    *value = test_voltage;
     return PBIO_SUCCESS;
 }
 
@@ -24,8 +42,8 @@ pbio_error_t pbdrv_battery_get_type(pbdrv_battery_type_t *value) {
 }
 
 pbio_error_t pbdrv_battery_get_current_now(uint16_t *value) {
-    *value = 0;
-    return PBIO_ERROR_NOT_SUPPORTED;
+    *value = test_current;
+    return test_current_supported ? PBIO_SUCCESS : PBIO_ERROR_NOT_SUPPORTED;
 }
 
 pbio_error_t pbdrv_battery_get_temperature(uint32_t *value) {
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#ifndef _INTERNAL_PBDRV_BATTERY_TEST_H_
+#define _INTERNAL_PBDRV_BATTERY_TEST_H_
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BATTERY_TEST
+
+#include <stdint.h>
+
+// extra battery functions just for tests
+void pbio_test_battery_set_voltage(uint16_t voltage);
+void pbio_test_battery_set_current(uint16_t current);
+
+#endif // PBDRV_CONFIG_BATTERY_TEST
+
+#endif // _INTERNAL_PBDRV_BATTERY_TEST_H_
@@ -33,6 +33,7 @@
 #include <tiam1808/armv5/am1808/edma_event.h>
 #include <tiam1808/armv5/am1808/interrupt.h>
 
+#include "../drv/adc/adc.h"
 #include "../drv/gpio/gpio_ev3.h"
 #include "../sys/storage_data.h"
 #include "block_device_ev3.h"
@@ -46,6 +47,7 @@
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
 #include <pbio/int_math.h>
+#include <pbio/main.h>
 #include <pbio/util.h>
 
 //
@@ -120,8 +122,6 @@ static struct {
     uint8_t rx_dummy_byte;
 } spi_dev_bufs PBDRV_DMA_BUF;
 
-static uint32_t last_spi_dma_complete_time_us;
-
 static void spi_dma_complete(void) {
     // Only complete once RX and TX complete.
     if (spi_dev.status & SPI_STATUS_WAIT_ANY) {
@@ -133,7 +133,6 @@ static void spi_dma_complete(void) {
     if (spi_dev.rx_user_buf_addr && spi_dev.rx_user_buf_sz) {
         pbdrv_cache_prepare_after_dma((void *)spi_dev.rx_user_buf_addr, spi_dev.rx_user_buf_sz);
     }
-    last_spi_dma_complete_time_us = pbdrv_clock_get_us();
 }
 
 /**
@@ -493,7 +492,9 @@ static pbio_error_t spi_begin_for_flash(
             edma3_set_param(EDMA3_CHA_SPI0_RX, &ps);
 
             if (user_data_rx) {
-                // RX the data
+                // RX the data. The caller's buffer need not be cache line
+                // aligned, so save whatever shares its first and last line.
+                pbdrv_cache_prepare_before_dma_rx(user_data_rx, user_data_len);
                 ps.p.destAddr = (unsigned int)(user_data_rx);
                 ps.p.bCnt = user_data_len;
                 ps.p.linkAddr = 0xffff;
@@ -547,7 +548,8 @@ enum {
  */
 enum {
     FLASH_SIZE_ERASE = 64 * 1024,
-    FLASH_SIZE_READ = SPI_MAX_DATA_SZ,
+    // Kept short so that ADC samples can be taken in between.
+    FLASH_SIZE_READ = 4 * 1024,
     FLASH_SIZE_WRITE = 256,
 };
 
@@ -581,8 +583,37 @@ static uint8_t write_address[4] = {FLASH_CMD_WRITE_DATA};
 // Request sector erase at address. Buffer: erase command + address.
 static uint8_t erase_address[4] = {FLASH_CMD_ERASE_BLOCK};
 
+static pbio_error_t adc_sample_if_due(pbio_os_state_t *state);
+
+/**
+ * Runs one flash transfer to completion. If an ADC sample is due, it is
+ * taken first, so that flash operations don't stall ADC updates.
+ *
+ * Arguments are the same as for ::spi_begin_for_flash.
+ */
+static pbio_error_t spi_flash_transfer(pbio_os_state_t *state,
+    const unsigned char *cmd, unsigned int cmd_len,
+    const unsigned char *user_data_tx, unsigned char *user_data_rx, unsigned int user_data_len) {
+
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT(state, &sub, adc_sample_if_due(&sub));
+
+    err = spi_begin_for_flash(cmd, cmd_len, user_data_tx, user_data_rx, user_data_len);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 static pbio_error_t pbdrv_block_device_read(pbio_os_state_t *state, uint32_t offset, uint8_t *buffer, uint32_t size) {
 
+    static pbio_os_state_t sub;
     static uint32_t size_done;
     static uint32_t size_now;
     pbio_error_t err;
@@ -600,11 +631,10 @@ static pbio_error_t pbdrv_block_device_read(pbio_os_state_t *state, uint32_t off
 
         // Set address for this read request and send it.
         set_address_be(&read_address[1], PBDRV_CONFIG_BLOCK_DEVICE_EV3_START_ADDRESS + offset + size_done);
-        err = spi_begin_for_flash(read_address, sizeof(read_address), 0, buffer + size_done, size_now);
+        PBIO_OS_AWAIT(state, &sub, err = spi_flash_transfer(&sub, read_address, sizeof(read_address), 0, buffer + size_done, size_now));
         if (err != PBIO_SUCCESS) {
             return err;
         }
-        PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
     }
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
@@ -614,17 +644,17 @@ static pbio_error_t pbdrv_block_device_read(pbio_os_state_t *state, uint32_t off
  * Poll the status register waiting for writes to complete.
  */
 static pbio_error_t flash_wait_write(pbio_os_state_t *state) {
+    static pbio_os_state_t sub;
     uint8_t status;
     pbio_error_t err;
 
     PBIO_OS_ASYNC_BEGIN(state);
 
     do {
-        err = spi_begin_for_flash(cmd_status, sizeof(cmd_status), 0, 0, 0);
+        PBIO_OS_AWAIT(state, &sub, err = spi_flash_transfer(&sub, cmd_status, sizeof(cmd_status), 0, 0, 0));
         if (err != PBIO_SUCCESS) {
             return err;
         }
-        PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
 
         status = spi_dev_bufs.spi_cmd_buf_rx[1];
     } while (status & FLASH_STATUS_BUSY);
@@ -632,7 +662,16 @@ static pbio_error_t flash_wait_write(pbio_os_state_t *state) {
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
-static pbio_error_t pbdrv_block_device_write_disk(pbio_os_state_t *state, const uint8_t *buffer, uint32_t size) {
+/**
+ * Writes the disk to flash, skipping sectors that are unchanged.
+ *
+ * @param [in]  state       Protothread state.
+ * @param [in]  buffer      The data to write.
+ * @param [in]  size        Size of @p buffer.
+ * @param [in]  dirty_start Start of the changed data in @p buffer.
+ * @param [in]  dirty_end   End of the changed data in @p buffer.
+ */
+static pbio_error_t pbdrv_block_device_write_disk(pbio_os_state_t *state, const uint8_t *buffer, uint32_t size, uint32_t dirty_start, uint32_t dirty_end) {
 
     static pbio_os_state_t sub;
     static uint32_t offset;
@@ -647,53 +686,55 @@ static pbio_error_t pbdrv_block_device_write_disk(pbio_os_state_t *state, const
         return PBIO_ERROR_INVALID_ARG;
     }
 
-    // Erase sector by sector.
     for (offset = 0; offset < size; offset += FLASH_SIZE_ERASE) {
+
+        // Skip sectors that are unchanged. The first one has the size, so it
+        // is always written.
+        if (offset != 0 && (offset + FLASH_SIZE_ERASE <= dirty_start || offset >= dirty_end)) {
+            continue;
+        }
+
         // Enable writing
-        err = spi_begin_for_flash(cmd_write_enable, sizeof(cmd_write_enable), 0, 0, 0);
+        PBIO_OS_AWAIT(state, &sub, err = spi_flash_transfer(&sub, cmd_write_enable, sizeof(cmd_write_enable), 0, 0, 0));
         if (err != PBIO_SUCCESS) {
             return err;
         }
-        PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
 
         // Erase this block
         set_address_be(&erase_address[1], PBDRV_CONFIG_BLOCK_DEVICE_EV3_START_ADDRESS + offset);
-        err = spi_begin_for_flash(erase_address, sizeof(erase_address), 0, 0, 0);
+        PBIO_OS_AWAIT(state, &sub, err = spi_flash_transfer(&sub, erase_address, sizeof(erase_address), 0, 0, 0));
         if (err != PBIO_SUCCESS) {
             return err;
         }
-        PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
 
         // Wait for completion
         PBIO_OS_AWAIT(state, &sub, err = flash_wait_write(&sub));
         if (err != PBIO_SUCCESS) {
             return err;
         }
-    }
 
-    // Write page by page.
-    for (size_done = 0; size_done < size; size_done += size_now) {
-        size_now = pbio_int_math_min(size - size_done, FLASH_SIZE_WRITE);
+        // Write this sector page by page.
+        for (size_done = offset; size_done < pbio_int_math_min(size, offset + FLASH_SIZE_ERASE); size_done += size_now) {
+            size_now = pbio_int_math_min(size - size_done, FLASH_SIZE_WRITE);
 
-        // Enable writing
-        err = spi_begin_for_flash(cmd_write_enable, sizeof(cmd_write_enable), 0, 0, 0);
-        if (err != PBIO_SUCCESS) {
-            return err;
-        }
-        PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
+            // Enable writing
+            PBIO_OS_AWAIT(state, &sub, err = spi_flash_transfer(&sub, cmd_write_enable, sizeof(cmd_write_enable), 0, 0, 0));
+            if (err != PBIO_SUCCESS) {
+                return err;
+            }
 
-        // Write this block
-        set_address_be(&write_address[1], PBDRV_CONFIG_BLOCK_DEVICE_EV3_START_ADDRESS + size_done);
-        err = spi_begin_for_flash(write_address, sizeof(write_address), buffer + size_done, 0, size_now);
-        if (err != PBIO_SUCCESS) {
-            return err;
-        }
-        PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
+            // Write this block
+            set_address_be(&write_address[1], PBDRV_CONFIG_BLOCK_DEVICE_EV3_START_ADDRESS + size_done);
+            PBIO_OS_AWAIT(state, &sub, err = spi_flash_transfer(&sub, write_address, sizeof(write_address), buffer + size_done, 0, size_now));
+            if (err != PBIO_SUCCESS) {
+                return err;
+            }
 
-        // Wait for completion
-        PBIO_OS_AWAIT(state, &sub, err = flash_wait_write(&sub));
-        if (err != PBIO_SUCCESS) {
-            return err;
+            // Wait for completion
+            PBIO_OS_AWAIT(state, &sub, err = flash_wait_write(&sub));
+            if (err != PBIO_SUCCESS) {
+                return err;
+            }
         }
     }
 
@@ -768,10 +809,15 @@ pbio_error_t pbdrv_adc_get_ch(uint8_t ch, uint16_t *value) {
     return PBIO_SUCCESS;
 }
 
+/**
+ * Time at which the most recent set of ADC samples was received.
+ */
+static uint32_t last_adc_sample_time_us;
+
 pbio_error_t pbdrv_adc_await_new_samples(pbio_os_state_t *state, uint32_t *start_time_us, uint32_t future_us) {
     PBIO_OS_ASYNC_BEGIN(state);
     *start_time_us = pbdrv_clock_get_us();
-    PBIO_OS_AWAIT_UNTIL(state, pbio_util_time_has_passed(last_spi_dma_complete_time_us, *start_time_us + future_us));
+    PBIO_OS_AWAIT_UNTIL(state, pbio_util_time_has_passed(last_adc_sample_time_us, *start_time_us + future_us));
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
@@ -847,6 +893,76 @@ static pbio_error_t pbdrv_block_device_ev3_spi_begin_for_adc(const uint32_t *cmd
     return PBIO_SUCCESS;
 }
 
+/**
+ * Takes one sample of all ADC channels.
+ */
+static pbio_error_t adc_sample(pbio_os_state_t *state) {
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    err = pbdrv_block_device_ev3_spi_begin_for_adc(
+        channel_cmd,
+        channel_data,
+        PBDRV_CONFIG_ADC_EV3_ADC_NUM_CHANNELS + PBDRV_ADC_EV3_NUM_DELAY_SAMPLES);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    PBIO_OS_AWAIT_WHILE(state, spi_dev.status & SPI_STATUS_WAIT_ANY);
+
+    last_adc_sample_time_us = pbdrv_clock_get_us();
+    pbdrv_adc_capture_handle_new_samples();
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Whether ADC samples are taken periodically.
+ */
+static bool adc_sampling;
+
+/**
+ * Schedule for ADC samples.
+ */
+static pbio_os_timer_t adc_timer;
+
+#if PBDRV_CONFIG_ADC_CAPTURE
+pbio_error_t pbdrv_adc_set_sample_period(uint32_t period_us) {
+    if (period_us == 0) {
+        adc_timer.duration = ADC_SAMPLE_PERIOD;
+        return PBIO_SUCCESS;
+    }
+
+    // Samples are scheduled in whole milliseconds, and a sample of all
+    // channels takes longer than one millisecond.
+    if (period_us % 1000 || period_us < ADC_SAMPLE_PERIOD * 1000) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    adc_timer.duration = period_us / 1000;
+    return PBIO_SUCCESS;
+}
+#endif // PBDRV_CONFIG_ADC_CAPTURE
+
+/**
+ * Takes one ADC sample if it is due according to the schedule. Does nothing
+ * otherwise. This is used in between flash transfers.
+ */
+static pbio_error_t adc_sample_if_due(pbio_os_state_t *state) {
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    if (!adc_sampling || !pbio_os_timer_is_expired(&adc_timer)) {
+        return PBIO_SUCCESS;
+    }
+
+    PBIO_OS_AWAIT(state, &sub, err = adc_sample(&sub));
+    pbio_os_timer_extend(&adc_timer);
+
+    PBIO_OS_ASYNC_END(err);
+}
+
 //
 // Part 4: Block device and ADC coordination process.
 //
@@ -869,12 +985,29 @@ static struct {
     };
 } ramdisk __attribute__((aligned(PBDRV_CACHE_LINE_SZ), section(".noinit"), used));
 
+/**
+ * Range of ramdisk bytes that changed, to be written on shutdown.
+ */
+static uint32_t ramdisk_dirty_start;
+static uint32_t ramdisk_dirty_end;
+
 uint32_t pbdrv_block_device_get_writable_size(void) {
     return PBDRV_CONFIG_BLOCK_DEVICE_EV3_SIZE - sizeof(ramdisk.saved_size);
 }
 
 static pbio_error_t pbdrv_block_device_load_err = PBIO_ERROR_FAILED;
 
+/**
+ * Number of ramdisk bytes loaded so far, including the size field. Only the
+ * settings and slot info are loaded before boot continues. The program data
+ * follows in the background.
+ */
+static uint32_t ramdisk_loaded_size;
+
+bool pbdrv_block_device_is_loading(void) {
+    return pbdrv_block_device_load_err == PBIO_SUCCESS && ramdisk_loaded_size < ramdisk.saved_size;
+}
+
 pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data) {
     *data = &ramdisk.data_map;
 
@@ -883,13 +1016,17 @@ pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data) {
     return pbdrv_block_device_load_err;
 }
 
+pbio_error_t pbdrv_block_device_get_mapped_data(const pbsys_storage_data_map_t **data) {
+    // External storage is not memory mapped.
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static pbio_os_process_t ev3_spi_process;
 
 pbio_error_t ev3_spi_process_thread(pbio_os_state_t *state, void *context) {
 
     pbio_error_t err;
 
-    static pbio_os_timer_t timer;
     static pbio_os_state_t sub;
 
     PBIO_OS_ASYNC_BEGIN(state);
@@ -909,7 +1046,15 @@ pbio_error_t ev3_spi_process_thread(pbio_os_state_t *state, void *context) {
     if (err != PBIO_SUCCESS) {
         return err;
     }
-    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_read(&sub, 0, (uint8_t *)&ramdisk, ramdisk.saved_size));
+
+    // Only load the settings and slot info now, so boot can go on to the UI
+    // without waiting for all programs. The rest is loaded below.
+    ramdisk_loaded_size = pbio_int_math_min(ramdisk.saved_size, sizeof(ramdisk.saved_size) + sizeof(pbsys_storage_data_map_t));
+    if (ramdisk.saved_size > PBDRV_CONFIG_BLOCK_DEVICE_EV3_SIZE) {
+        err = PBIO_ERROR_INVALID_ARG;
+    } else {
+        PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_read(&sub, 0, (uint8_t *)&ramdisk, ramdisk_loaded_size));
+    }
 
     // Reading may fail with PBIO_ERROR_INVALID_ARG if the size is too big.
     // This happens when the size value was uninitialized or another firmware
@@ -918,38 +1063,43 @@ pbio_error_t ev3_spi_process_thread(pbio_os_state_t *state, void *context) {
     // failure, it can reset the user data to factory defaults, and save it
     // properly on shutdown.
     pbdrv_block_device_load_err = err;
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_STORAGE);
 
     // Read one set of ADC samples before continuing boot.
     // This ensures that e.g. the low-battery warning doesn't falsely trigger.
-    pbdrv_block_device_ev3_spi_begin_for_adc(
-        channel_cmd,
-        channel_data,
-        PBDRV_CONFIG_ADC_EV3_ADC_NUM_CHANNELS + PBDRV_ADC_EV3_NUM_DELAY_SAMPLES);
-    PBIO_OS_AWAIT_WHILE(state, (spi_dev.status & SPI_STATUS_WAIT_ANY));
+    PBIO_OS_AWAIT(state, &sub, adc_sample(&sub));
 
     pbio_busy_count_down();
 
-    pbio_os_timer_set(&timer, ADC_SAMPLE_PERIOD);
+    // From now on, ADC samples are taken on a fixed schedule, also in between
+    // flash transfers.
+    adc_sampling = true;
+    pbio_os_timer_set(&adc_timer, ADC_SAMPLE_PERIOD);
+
+    // Load the program data. This keeps sampling the ADC in between reads.
+    if (pbdrv_block_device_is_loading()) {
+        PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_read(&sub, ramdisk_loaded_size,
+            (uint8_t *)&ramdisk + ramdisk_loaded_size, ramdisk.saved_size - ramdisk_loaded_size));
+        if (err != PBIO_SUCCESS) {
+            // Discard the programs but keep the settings.
+            ramdisk.saved_size = ramdisk_loaded_size;
+            memset(ramdisk.data_map.slot_info, 0, sizeof(ramdisk.data_map.slot_info));
+        }
+        ramdisk_loaded_size = ramdisk.saved_size;
+        pbio_os_request_poll();
+    }
 
     // Poll ADC continuously until cancellation is requested.
     while (!(ev3_spi_process.request & PBIO_OS_PROCESS_REQUEST_TYPE_CANCEL)) {
-
-        // Start a sample of all channels
-        pbdrv_block_device_ev3_spi_begin_for_adc(
-            channel_cmd,
-            channel_data,
-            PBDRV_CONFIG_ADC_EV3_ADC_NUM_CHANNELS + PBDRV_ADC_EV3_NUM_DELAY_SAMPLES);
-
-        // Await for transfer to complete.
-        PBIO_OS_AWAIT_WHILE(state, (spi_dev.status & SPI_STATUS_WAIT_ANY));
-
-        PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
-        pbio_os_timer_extend(&timer);
+        PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&adc_timer) ||
+            (ev3_spi_process.request & PBIO_OS_PROCESS_REQUEST_TYPE_CANCEL));
+        PBIO_OS_AWAIT(state, &sub, adc_sample_if_due(&sub));
     }
 
-    // Now that the ADC loop has ended, we can use the SPI bus to save user
-    // data to persistent storage.
-    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_write_disk(&sub, (uint8_t *)&ramdisk, ramdisk.saved_size));
+    // Save user data to persistent storage. ADC sampling continues in
+    // between flash transfers.
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_write_disk(&sub, (uint8_t *)&ramdisk, ramdisk.saved_size,
+        ramdisk_dirty_start, ramdisk_dirty_end));
 
     // Poll the process that awaits on us to complete.
     pbio_os_request_poll();
@@ -957,12 +1107,16 @@ pbio_error_t ev3_spi_process_thread(pbio_os_state_t *state, void *context) {
     PBIO_OS_ASYNC_END(err);
 }
 
-pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size) {
+pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end) {
     PBIO_OS_ASYNC_BEGIN(state);
 
     // Store the new size so we know how much to load on next boot.
     ramdisk.saved_size = used_data_size + sizeof(ramdisk.saved_size);
 
+    // The dirty range is given relative to the data map, after the size.
+    ramdisk_dirty_start = dirty_start + sizeof(ramdisk.saved_size);
+    ramdisk_dirty_end = dirty_end + sizeof(ramdisk.saved_size);
+
     // Rather than write here, we ask the common SPI process to start writing
     // when it is ready for it, and wait for the whole process to complete.
     pbio_os_process_make_request(&ev3_spi_process, PBIO_OS_PROCESS_REQUEST_TYPE_CANCEL);
@@ -20,6 +20,7 @@
 
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
+#include <pbio/main.h>
 #include <pbio/util.h>
 
 #include STM32_HAL_H
@@ -70,11 +71,13 @@ void pbdrv_block_device_init(void) {
         // This error will be retrieved when higher level code requests the
         // ramdisk, so that it can reset data to firmware defaults.
         init_err = PBIO_ERROR_INVALID_ARG;
+        pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_STORAGE);
         return;
     }
 
     // Load requested amount of data to RAM. Also re-reads the size value.
     memcpy(&ramdisk, _pbdrv_block_device_storage_start, size);
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_STORAGE);
 }
 
 pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data) {
@@ -82,6 +85,12 @@ pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data) {
     return init_err;
 }
 
+pbio_error_t pbdrv_block_device_get_mapped_data(const pbsys_storage_data_map_t **data) {
+    // Internal flash is memory mapped, with the same layout as the ramdisk.
+    *data = (const pbsys_storage_data_map_t *)(_pbdrv_block_device_storage_start + header_size);
+    return init_err;
+}
+
 // Updates checksum in data map to satisfy bootloader requirements.
 static void pbdrv_block_device_update_ramdisk_size_and_checksum(uint32_t used_data_size) {
 
@@ -116,12 +125,15 @@ static void pbdrv_block_device_update_ramdisk_size_and_checksum(uint32_t used_da
     ramdisk.checksum_complement = 0xFFFFFFFF - checksum + 1;
 }
 
-pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size) {
+pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end) {
 
     // NB: This function is called as an awaitable for compatibility with other
     // external storage mediums. This implementation is blocking, but we only
     // use it during shutdown so this is acceptable.
 
+    // The dirty range is not used. The storage area is small, and the
+    // checksum in the header changes whenever any data changes.
+
     // Account for header size and make valid checksum.
     pbdrv_block_device_update_ramdisk_size_and_checksum(used_data_size);
     uint32_t size = ramdisk.saved_size;
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Journal area in RAM that behaves like NOR flash, for simulation and tests.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM
+
+#include <stdint.h>
+#include <string.h>
+
+#include <pbdrv/block_device_journal.h>
+
+#include <pbio/error.h>
+#include <pbio/os.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SIZE % PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SECTOR_SIZE
+#error "Journal size must be a multiple of the sector size."
+#endif
+
+static uint8_t journal[PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SIZE];
+
+uint32_t pbdrv_block_device_journal_get_size(void) {
+    return sizeof(journal);
+}
+
+uint32_t pbdrv_block_device_journal_get_sector_size(void) {
+    return PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SECTOR_SIZE;
+}
+
+pbio_error_t pbdrv_block_device_journal_read(pbio_os_state_t *state, uint32_t offset, uint8_t *buffer, uint32_t size) {
+    if (size == 0 || offset + size > sizeof(journal)) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    memcpy(buffer, journal + offset, size);
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_block_device_journal_write(pbio_os_state_t *state, uint32_t offset, const uint8_t *buffer, uint32_t size) {
+    if (size == 0 || offset + size > sizeof(journal)) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    // Like flash, writing can only clear bits.
+    for (uint32_t i = 0; i < size; i++) {
+        journal[offset + i] &= buffer[i];
+    }
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_block_device_journal_erase(pbio_os_state_t *state, uint32_t offset) {
+    if (offset % PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SECTOR_SIZE || offset >= sizeof(journal)) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    memset(journal + offset, 0xFF, PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SECTOR_SIZE);
+    return PBIO_SUCCESS;
+}
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM
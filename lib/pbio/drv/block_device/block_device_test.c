@@ -80,6 +80,11 @@ pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data) {
     return PBIO_SUCCESS;
 }
 
+pbio_error_t pbdrv_block_device_get_mapped_data(const pbsys_storage_data_map_t **data) {
+    // The test program is only available as a copy in RAM.
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 void pbdrv_block_device_init(void) {
     ramdisk.data_map.slot_info[0].size = sizeof(_program_data);
     memcpy(ramdisk.data_map.stored_firmware_hash, MICROPY_GIT_HASH, sizeof(ramdisk.data_map.stored_firmware_hash));
@@ -87,7 +92,7 @@ void pbdrv_block_device_init(void) {
 }
 
 // Don't store any data in this implementation.
-pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size) {
+pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end) {
     return PBIO_ERROR_NOT_IMPLEMENTED;
 }
 
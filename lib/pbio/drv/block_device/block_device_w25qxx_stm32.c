@@ -21,10 +21,12 @@
 #include "block_device_w25qxx_stm32.h"
 
 #include <pbdrv/block_device.h>
+#include <pbdrv/block_device_journal.h>
 
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
 #include <pbio/int_math.h>
+#include <pbio/main.h>
 
 static pbio_os_process_t pbdrv_block_device_w25qxx_stm32_init_process;
 
@@ -58,6 +60,11 @@ pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data) {
     return pbdrv_block_device_w25qxx_stm32_init_process.err;
 }
 
+pbio_error_t pbdrv_block_device_get_mapped_data(const pbsys_storage_data_map_t **data) {
+    // External storage is not memory mapped.
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 /**
  * SPI bus state.
  */
@@ -78,7 +85,7 @@ typedef enum {
     SPI_RECV = 0x00,
     /** Send data to SPI device. */
     SPI_SEND = 0x01,
-    /** Bitflag to keep NCS low after the operation. Only used with SPI_SEND. */
+    /** Bitflag to keep NCS low after the operation. */
     SPI_CS_KEEP_ENABLED = 0x02,
 } spi_operation_t;
 
@@ -108,6 +115,8 @@ static struct {
     DMA_HandleTypeDef tx_dma;
     /** DMA for receiving SPI data */
     DMA_HandleTypeDef rx_dma;
+    /** Whether a flash operation is in progress. Others must wait. */
+    bool flash_in_use;
 } bdev;
 
 /**
@@ -194,7 +203,7 @@ static pbio_error_t spi_begin(const spi_command_t *cmd) {
 
     // Start SPI operation.
     HAL_StatusTypeDef err;
-    if (cmd->operation == SPI_RECV) {
+    if (!(cmd->operation & SPI_SEND)) {
         err = HAL_SPI_Receive_DMA(&bdev.hspi, cmd->buffer, cmd->size);
     } else {
         err = HAL_SPI_Transmit_DMA(&bdev.hspi, cmd->buffer, cmd->size);
@@ -371,7 +380,21 @@ static spi_command_t cmd_data_read = {
     .operation = SPI_RECV,
 };
 
-static pbio_error_t pbdrv_block_device_read(pbio_os_state_t *state, uint32_t offset, uint8_t *buffer, uint32_t size) {
+/**
+ * Receives data that follows a read request that was already sent.
+ *
+ * The flash keeps streaming data from consecutive addresses for as long as
+ * chip select stays enabled, so reads can be continued without sending the
+ * address again. This also applies across DMA chunks and page boundaries.
+ *
+ * @param [in] state       Protothread state.
+ * @param [in] buffer      Buffer to read into.
+ * @param [in] size        Number of bytes to read.
+ * @param [in] keep_going  Whether to keep chip select enabled when done, so
+ *                         that the read can be continued.
+ * @return                 ::PBIO_SUCCESS on success, or an SPI error.
+ */
+static pbio_error_t flash_read_continue(pbio_os_state_t *state, uint8_t *buffer, uint32_t size, bool keep_going) {
 
     static pbio_os_state_t sub;
     static uint32_t size_done;
@@ -380,27 +403,18 @@ static pbio_error_t pbdrv_block_device_read(pbio_os_state_t *state, uint32_t off
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    // Exit on invalid size.
-    if (size == 0 || offset + size > PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_SIZE) {
-        return PBIO_ERROR_INVALID_ARG;
-    }
-
-    // Split up reads to maximum chunk size.
+    // Split up reads to maximum DMA chunk size, without releasing the flash.
     for (size_done = 0; size_done < size; size_done += size_now) {
         size_now = pbio_int_math_min(size - size_done, FLASH_SIZE_READ);
-
-        // Set address for this read request and send it.
-        set_address_be(&cmd_request_read.buffer[1], PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS + offset + size_done);
-        PBIO_OS_AWAIT(state, &sub, err = spi_command_thread(&sub, &cmd_request_read));
-        if (err != PBIO_SUCCESS) {
-            return err;
+        cmd_data_read.operation = SPI_RECV;
+        if (keep_going || size_done + size_now < size) {
+            cmd_data_read.operation |= SPI_CS_KEEP_ENABLED;
         }
-
-        // Receive the data.
         cmd_data_read.buffer = buffer + size_done;
         cmd_data_read.size = size_now;
         PBIO_OS_AWAIT(state, &sub, err = spi_command_thread(&sub, &cmd_data_read));
         if (err != PBIO_SUCCESS) {
+            spi_chip_select(false);
             return err;
         }
     }
@@ -408,6 +422,36 @@ static pbio_error_t pbdrv_block_device_read(pbio_os_state_t *state, uint32_t off
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+/**
+ * Sends a read request for the given address, to be followed by one or more
+ * calls to flash_read_continue().
+ */
+static pbio_error_t flash_read_begin(pbio_os_state_t *state, uint32_t address) {
+    set_address_be(&cmd_request_read.buffer[1], address);
+    return spi_command_thread(state, &cmd_request_read);
+}
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL
+
+static pbio_error_t flash_read(pbio_os_state_t *state, uint32_t address, uint8_t *buffer, uint32_t size) {
+
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT(state, &sub, err = flash_read_begin(&sub, address));
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    PBIO_OS_AWAIT(state, &sub, err = flash_read_continue(&sub, buffer, size, false));
+
+    PBIO_OS_ASYNC_END(err);
+}
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL
+
 /**
  * Write or erase one chunk of data from flash.
  *
@@ -468,7 +512,7 @@ static pbio_error_t flash_erase_or_write(pbio_os_state_t *state, uint32_t addres
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
-pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size) {
+static pbio_error_t write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end) {
 
     static pbio_os_state_t sub;
     static uint32_t offset;
@@ -491,29 +535,146 @@ pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_
     // Store the new size so we know how much to load on next boot.
     ramdisk.saved_size = size;
 
-    // Erase sector by sector.
     for (offset = 0; offset < size; offset += FLASH_SIZE_ERASE) {
+
+        // Skip sectors that are unchanged. The first one has the size, so it
+        // is always written.
+        if (offset != 0 &&
+            (offset + FLASH_SIZE_ERASE <= dirty_start + sizeof(ramdisk.saved_size) ||
+             offset >= dirty_end + sizeof(ramdisk.saved_size))) {
+            continue;
+        }
+
         // Writing size 0 means erase.
         PBIO_OS_AWAIT(state, &sub, err = flash_erase_or_write(&sub,
             PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS + offset, NULL, 0));
         if (err != PBIO_SUCCESS) {
             return err;
         }
+
+        // Write this sector page by page.
+        for (size_done = offset; size_done < pbio_int_math_min(size, offset + FLASH_SIZE_ERASE); size_done += size_now) {
+            size_now = pbio_int_math_min(size - size_done, FLASH_SIZE_WRITE);
+            PBIO_OS_AWAIT(state, &sub, err = flash_erase_or_write(&sub,
+                PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS + size_done, buffer + size_done, size_now));
+            if (err != PBIO_SUCCESS) {
+                return err;
+            }
+        }
     }
 
-    // Write page by page.
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end) {
+
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Wait for journal operations to finish.
+    PBIO_OS_AWAIT_WHILE(state, bdev.flash_in_use);
+    bdev.flash_in_use = true;
+
+    PBIO_OS_AWAIT(state, &sub, err = write_all(&sub, used_data_size, dirty_start, dirty_end));
+
+    bdev.flash_in_use = false;
+
+    PBIO_OS_ASYNC_END(err);
+}
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_START_ADDRESS < PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS + PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_SIZE
+#error "Journal must be placed after the main storage area."
+#endif
+
+uint32_t pbdrv_block_device_journal_get_size(void) {
+    return PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_SIZE;
+}
+
+uint32_t pbdrv_block_device_journal_get_sector_size(void) {
+    return FLASH_SIZE_ERASE;
+}
+
+pbio_error_t pbdrv_block_device_journal_read(pbio_os_state_t *state, uint32_t offset, uint8_t *buffer, uint32_t size) {
+
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    if (size == 0 || offset + size > PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    PBIO_OS_AWAIT_WHILE(state, bdev.flash_in_use);
+    bdev.flash_in_use = true;
+
+    PBIO_OS_AWAIT(state, &sub, err = flash_read(&sub, PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_START_ADDRESS + offset, buffer, size));
+
+    bdev.flash_in_use = false;
+
+    PBIO_OS_ASYNC_END(err);
+}
+
+pbio_error_t pbdrv_block_device_journal_write(pbio_os_state_t *state, uint32_t offset, const uint8_t *buffer, uint32_t size) {
+
+    static pbio_os_state_t sub;
+    static uint32_t size_done;
+    static uint32_t size_now;
+    pbio_error_t err = PBIO_SUCCESS;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    if (size == 0 || offset + size > PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    PBIO_OS_AWAIT_WHILE(state, bdev.flash_in_use);
+    bdev.flash_in_use = true;
+
+    // Writes must not cross a page boundary, so split them up accordingly.
     for (size_done = 0; size_done < size; size_done += size_now) {
-        size_now = pbio_int_math_min(size - size_done, FLASH_SIZE_WRITE);
+        size_now = pbio_int_math_min(size - size_done, FLASH_SIZE_WRITE - (offset + size_done) % FLASH_SIZE_WRITE);
         PBIO_OS_AWAIT(state, &sub, err = flash_erase_or_write(&sub,
-            PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS + size_done, buffer + size_done, size_now));
+            PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_START_ADDRESS + offset + size_done, (uint8_t *)buffer + size_done, size_now));
         if (err != PBIO_SUCCESS) {
-            return err;
+            break;
         }
     }
 
-    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+    bdev.flash_in_use = false;
+
+    PBIO_OS_ASYNC_END(err);
+}
+
+pbio_error_t pbdrv_block_device_journal_erase(pbio_os_state_t *state, uint32_t offset) {
+
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    if (offset % FLASH_SIZE_ERASE || offset >= PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    PBIO_OS_AWAIT_WHILE(state, bdev.flash_in_use);
+    bdev.flash_in_use = true;
+
+    // Writing size 0 means erase.
+    PBIO_OS_AWAIT(state, &sub, err = flash_erase_or_write(&sub,
+        PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_START_ADDRESS + offset, NULL, 0));
+
+    bdev.flash_in_use = false;
+
+    PBIO_OS_ASYNC_END(err);
 }
 
+#endif // PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL
+
 pbio_error_t pbdrv_block_device_w25qxx_stm32_init_process_thread(pbio_os_state_t *state, void *context) {
 
     pbio_error_t err;
@@ -538,14 +699,27 @@ pbio_error_t pbdrv_block_device_w25qxx_stm32_init_process_thread(pbio_os_state_t
         return PBIO_ERROR_FAILED;
     }
 
-    // Read size of stored data.
-    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_read(&sub, 0, (uint8_t *)&ramdisk.saved_size, sizeof(ramdisk.saved_size)));
+    // Read size of stored data, and keep the flash streaming so that the data
+    // that follows can be read without sending another read request.
+    PBIO_OS_AWAIT(state, &sub, err = flash_read_begin(&sub, PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS));
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    PBIO_OS_AWAIT(state, &sub, err = flash_read_continue(&sub, (uint8_t *)&ramdisk.saved_size, sizeof(ramdisk.saved_size), true));
     if (err != PBIO_SUCCESS) {
         return err;
     }
 
     // Read the available data into RAM.
-    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_read(&sub, 0, (uint8_t *)&ramdisk, ramdisk.saved_size));
+    if (ramdisk.saved_size < sizeof(ramdisk.saved_size) || ramdisk.saved_size > PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_SIZE) {
+        spi_chip_select(false);
+        err = PBIO_ERROR_INVALID_ARG;
+    } else if (ramdisk.saved_size == sizeof(ramdisk.saved_size)) {
+        spi_chip_select(false);
+    } else {
+        PBIO_OS_AWAIT(state, &sub, err = flash_read_continue(&sub, (uint8_t *)&ramdisk + sizeof(ramdisk.saved_size),
+            ramdisk.saved_size - sizeof(ramdisk.saved_size), false));
+    }
 
     // Reading may fail with PBIO_ERROR_INVALID_ARG if the size is too big.
     // This happens when the size value was uninitialized or another firmware
@@ -553,6 +727,8 @@ pbio_error_t pbdrv_block_device_w25qxx_stm32_init_process_thread(pbio_os_state_t
     // higher level code sees this error when requesting the RAM disk. On
     // failure, it can reset the user data to factory defaults, and save it
     // properly on shutdown.
+    bdev.flash_in_use = false;
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_STORAGE);
     pbio_busy_count_down();
 
     PBIO_OS_ASYNC_END(err);
@@ -563,6 +739,9 @@ void pbdrv_block_device_init(void) {
     bdev.pdata = &pbdrv_block_device_w25qxx_stm32_platform_data;
     bdev.spi_status = SPI_STATUS_COMPLETE;
 
+    // Taken until the stored data is loaded.
+    bdev.flash_in_use = true;
+
     bdev.tx_dma.Instance = bdev.pdata->tx_dma;
     bdev.tx_dma.Init.Channel = bdev.pdata->tx_dma_ch;
     bdev.tx_dma.Init.Direction = DMA_MEMORY_TO_PERIPH;
@@ -8,14 +8,18 @@
 #if PBDRV_CONFIG_BLUETOOTH
 
 #include <stdint.h>
+#include <string.h>
 
 #include <pbdrv/bluetooth.h>
 
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
 #include <pbio/int_math.h>
+#include <pbio/lz4.h>
+#include <pbio/main.h>
 #include <pbio/os.h>
 #include <pbio/protocol.h>
+#include <pbio/tracepoint.h>
 
 #include <lwrb/lwrb.h>
 
@@ -53,6 +57,17 @@ static uint8_t pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_NUM_EVENTS][PBDRV_BL
 static uint8_t status_data[PBIO_PYBRICKS_EVENT_STATUS_REPORT_SIZE];
 static bool status_data_pending;
 
+// Time in ms that a status change may wait for more changes, so that flags
+// that change several times in a row are sent only once, in the final state.
+#ifndef PBDRV_CONFIG_BLUETOOTH_STATUS_FLUSH_DELAY
+#define PBDRV_CONFIG_BLUETOOTH_STATUS_FLUSH_DELAY (5)
+#endif
+
+/**
+ * Expires when the first pending status change has waited long enough.
+ */
+static pbio_os_timer_t status_flush_timer;
+
 void pbdrv_bluetooth_schedule_status_update(const uint8_t *status_msg) {
     // Ignore if message identical to last.
     if (!memcmp(status_data, status_msg, sizeof(status_data))) {
@@ -60,6 +75,9 @@ void pbdrv_bluetooth_schedule_status_update(const uint8_t *status_msg) {
     }
 
     // Schedule to send whenever the Bluetooth process gets round to it.
+    if (!status_data_pending) {
+        pbio_os_timer_set(&status_flush_timer, PBDRV_CONFIG_BLUETOOTH_STATUS_FLUSH_DELAY);
+    }
     memcpy(status_data, status_msg, sizeof(status_data));
     status_data_pending = true;
     pbio_os_request_poll();
@@ -70,10 +88,98 @@ void pbdrv_bluetooth_schedule_status_update(const uint8_t *status_msg) {
  */
 static lwrb_t stdout_ring_buf;
 
+// Time in ms that stdout data may wait for more data, so that bursts of small
+// writes are sent as fewer, fuller notifications. Zero sends on the next pass.
+#ifndef PBDRV_CONFIG_BLUETOOTH_STDOUT_FLUSH_DELAY
+#define PBDRV_CONFIG_BLUETOOTH_STDOUT_FLUSH_DELAY (3)
+#endif
+
+/**
+ * Expires when the oldest buffered stdout byte has waited long enough.
+ */
+static pbio_os_timer_t stdout_flush_timer;
+
+/**
+ * Buffered stdout should be sent without waiting for more data.
+ */
+static bool stdout_flush_requested;
+
+/**
+ * Each line of stdout should be sent without waiting for more data.
+ */
+static bool stdout_line_buffered;
+
+#if PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION
+/**
+ * Whether the host asked to receive stdout compressed.
+ */
+static bool stdout_compressed;
+
+/**
+ * Encoder for compressed stdout. Its history is what the host has decoded.
+ */
+static pbio_lz4_encoder_t stdout_encoder;
+static uint8_t stdout_history[PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION_HISTORY_SIZE];
+
+/**
+ * Number of notifications of raw stdout to buffer. Compressed data is
+ * smaller, so more raw data is needed to fill a notification.
+ */
+#define PBDRV_BLUETOOTH_STDOUT_NUM_CHARS (8)
+#else
+#define stdout_compressed (false)
+#define PBDRV_BLUETOOTH_STDOUT_NUM_CHARS (2)
+#endif
+
+/**
+ * Time after the last sent event at which the host link is considered idle.
+ */
+#define PBDRV_BLUETOOTH_LINK_IDLE_TIME (1000)
+
+/**
+ * Whether the fast connection parameters were requested for the host link.
+ */
+static bool link_fast;
+
+/**
+ * Restarts whenever an event other than status is sent.
+ */
+static pbio_os_timer_t link_idle_timer;
+
+/**
+ * Interval over which the transmit rate is measured.
+ */
+#define PBDRV_BLUETOOTH_TX_RATE_INTERVAL (1000)
+
+static pbio_os_timer_t tx_rate_timer;
+static uint32_t tx_rate_bytes;
+static uint32_t tx_rate;
+static uint32_t tx_rate_max;
+
+void pbdrv_bluetooth_get_tx_rate(uint32_t *rate, uint32_t *rate_max) {
+    *rate = tx_rate;
+    *rate_max = tx_rate_max;
+}
+
+/**
+ * Updates the transmit rate once per interval.
+ */
+static void pbdrv_bluetooth_update_tx_rate(void) {
+    if (!pbio_os_timer_is_expired(&tx_rate_timer)) {
+        return;
+    }
+    pbio_os_timer_extend(&tx_rate_timer);
+    tx_rate = tx_rate_bytes;
+    tx_rate_bytes = 0;
+    if (tx_rate > tx_rate_max) {
+        tx_rate_max = tx_rate;
+    }
+}
+
 void pbdrv_bluetooth_init(void) {
     // enough for two packets, one currently being sent and one to be ready
     // as soon as the previous one completes + 1 byte for ring buf pointer
-    static uint8_t stdout_buf[PBDRV_BLUETOOTH_MAX_CHAR_SIZE * 2 + 1];
+    static uint8_t stdout_buf[PBDRV_BLUETOOTH_MAX_CHAR_SIZE * PBDRV_BLUETOOTH_STDOUT_NUM_CHARS + 1];
     lwrb_init(&stdout_ring_buf, stdout_buf, PBIO_ARRAY_SIZE(stdout_buf));
 
     pbdrv_bluetooth_init_hci();
@@ -86,6 +192,10 @@ void pbdrv_bluetooth_set_host_connection_changed_callback(pbio_util_void_callbac
 }
 
 void pbdrv_bluetooth_host_connection_changed(void) {
+    #if PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION
+    // Each host has to ask for compression again.
+    stdout_compressed = false;
+    #endif
     if (pbdrv_bluetooth_host_connection_changed_callback) {
         pbdrv_bluetooth_host_connection_changed_callback();
     }
@@ -100,10 +210,20 @@ pbio_error_t pbdrv_bluetooth_tx(const uint8_t *data, uint32_t *size) {
 
     // Buffer data to send it more efficiently even if the caller is only
     // writing one byte at a time.
+    bool was_empty = lwrb_get_full(&stdout_ring_buf) == 0;
     if ((*size = lwrb_write(&stdout_ring_buf, data, *size)) == 0) {
         return PBIO_ERROR_AGAIN;
     }
 
+    // Start waiting for more data if this is the first byte in the buffer.
+    if (was_empty) {
+        pbio_os_timer_set(&stdout_flush_timer, PBDRV_CONFIG_BLUETOOTH_STDOUT_FLUSH_DELAY);
+    }
+
+    if (stdout_line_buffered && memchr(data, '\n', *size)) {
+        stdout_flush_requested = true;
+    }
+
     // poke the process to start tx soon-ish. This way, we can accumulate up to
     // PBDRV_BLUETOOTH_MAX_CHAR_SIZE bytes before actually transmitting
     pbio_os_request_poll();
@@ -111,6 +231,29 @@ pbio_error_t pbdrv_bluetooth_tx(const uint8_t *data, uint32_t *size) {
     return PBIO_SUCCESS;
 }
 
+void pbdrv_bluetooth_tx_flush(void) {
+    if (lwrb_get_full(&stdout_ring_buf) != 0) {
+        stdout_flush_requested = true;
+        pbio_os_request_poll();
+    }
+}
+
+void pbdrv_bluetooth_tx_set_line_buffered(bool line_buffered) {
+    stdout_line_buffered = line_buffered;
+}
+
+pbio_error_t pbdrv_bluetooth_tx_set_compression(bool compressed) {
+    #if PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION
+    // The host starts decoding from scratch, so matches may not refer to
+    // anything sent before.
+    pbio_lz4_encoder_init(&stdout_encoder, stdout_history, sizeof(stdout_history));
+    stdout_compressed = compressed;
+    return PBIO_SUCCESS;
+    #else
+    return compressed ? PBIO_ERROR_NOT_SUPPORTED : PBIO_SUCCESS;
+    #endif
+}
+
 uint32_t pbdrv_bluetooth_tx_available(void) {
     if (!pbdrv_bluetooth_host_is_connected()) {
         return UINT32_MAX;
@@ -127,6 +270,10 @@ bool pbdrv_bluetooth_tx_is_idle(void) {
     return lwrb_get_full(&stdout_ring_buf) == 0 && !pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
 }
 
+void pbdrv_bluetooth_tx_discard(uint32_t size) {
+    lwrb_skip(&stdout_ring_buf, size);
+}
+
 pbio_error_t pbdrv_bluetooth_send_event_notification(pbio_os_state_t *state, pbio_pybricks_event_t event_type, const uint8_t *data, size_t size) {
     PBIO_OS_ASYNC_BEGIN(state);
 
@@ -242,6 +389,11 @@ pbio_error_t pbdrv_bluetooth_peripheral_scan_and_connect(pbdrv_bluetooth_periphe
     // Used to compare subsequent advertisements, so we should reset it.
     memset(peri->bdaddr, 0, sizeof(peri->bdaddr));
 
+    #if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+    // Writes for a previous connection are no longer relevant.
+    peri->write_queue_size = 0;
+    #endif
+
     // Initialize operation for handling on the main thread.
     peri->config = *config;
     peri->func = pbdrv_bluetooth_peripheral_scan_and_connect_func;
@@ -336,6 +488,43 @@ pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic(pbdrv_bluetooth_per
     return PBIO_SUCCESS;
 }
 
+pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic_queued(pbdrv_bluetooth_peripheral_t *peri, uint16_t handle, uint8_t key, const uint8_t *data, size_t size) {
+
+    #if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+    if (!pbdrv_bluetooth_peripheral_is_connected(peri)) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    if (size > PBDRV_BLUETOOTH_MAX_CHAR_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // Replace a write of the same thing that was not sent yet, or else add
+    // a new one at the end.
+    pbdrv_bluetooth_peripheral_write_t *write = NULL;
+    for (uint8_t i = 0; i < peri->write_queue_size; i++) {
+        if (peri->write_queue[i].handle == handle && peri->write_queue[i].key == key) {
+            write = &peri->write_queue[i];
+            break;
+        }
+    }
+    if (!write) {
+        if (peri->write_queue_size == PBDRV_BLUETOOTH_PERIPHERAL_WRITE_QUEUE_SIZE) {
+            return PBIO_ERROR_BUSY;
+        }
+        write = &peri->write_queue[peri->write_queue_size++];
+    }
+
+    write->handle = handle;
+    write->key = key;
+    write->size = size;
+    memcpy(write->data, data, size);
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+    #else
+    return PBIO_ERROR_NOT_SUPPORTED;
+    #endif
+}
+
 pbio_error_t pbdrv_bluetooth_await_peripheral_command(pbio_os_state_t *state, void *context) {
 
     pbdrv_bluetooth_peripheral_t *peri = context;
@@ -393,21 +582,38 @@ pbio_error_t pbdrv_bluetooth_start_advertising(bool start) {
     return PBIO_SUCCESS;
 }
 
-uint8_t pbdrv_bluetooth_broadcast_data[PBDRV_BLUETOOTH_MAX_ADV_SIZE];
+uint8_t pbdrv_bluetooth_broadcast_data[PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE];
 uint8_t pbdrv_bluetooth_broadcast_data_size;
 
+/**
+ * Latest broadcast data given while the broadcast task was already pending
+ * or running. The task runs once more to send it.
+ */
+static uint8_t broadcast_data_next[PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE];
+static uint8_t broadcast_data_next_size;
+static bool broadcast_update_pending;
+
 pbio_error_t pbdrv_bluetooth_start_broadcasting(const uint8_t *data, size_t size) {
 
     if (!pbdrv_bluetooth_hci_is_enabled()) {
         return PBIO_ERROR_INVALID_OP;
     }
 
-    if (advertising_or_scan_func) {
-        return PBIO_ERROR_BUSY;
+    if (size > pbdrv_bluetooth_get_max_broadcast_size()) {
+        return PBIO_ERROR_INVALID_ARG;
     }
 
-    if (size > PBDRV_BLUETOOTH_MAX_ADV_SIZE) {
-        return PBIO_ERROR_INVALID_ARG;
+    // If a broadcast is already on its way, queue the new data to be sent
+    // right after it instead of failing. Only the latest data is kept.
+    if (advertising_or_scan_func == pbdrv_bluetooth_start_broadcasting_func && data && size) {
+        broadcast_data_next_size = size;
+        memcpy(broadcast_data_next, data, size);
+        broadcast_update_pending = true;
+        return PBIO_SUCCESS;
+    }
+
+    if (advertising_or_scan_func) {
+        return PBIO_ERROR_BUSY;
     }
 
     bool is_broadcasting = pbdrv_bluetooth_advertising_state == PBDRV_BLUETOOTH_ADVERTISING_STATE_BROADCASTING;
@@ -443,6 +649,15 @@ pbio_error_t pbdrv_bluetooth_start_broadcasting(const uint8_t *data, size_t size
     return PBIO_SUCCESS;
 }
 
+size_t pbdrv_bluetooth_get_max_broadcast_size(void) {
+    #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+    if (pbdrv_bluetooth_extended_advertising_is_supported()) {
+        return PBDRV_BLUETOOTH_MAX_EXT_ADV_SIZE;
+    }
+    #endif
+    return PBDRV_BLUETOOTH_MAX_ADV_SIZE;
+}
+
 bool pbdrv_bluetooth_is_observing;
 pbdrv_bluetooth_start_observing_callback_t pbdrv_bluetooth_observe_callback;
 
@@ -493,6 +708,49 @@ pbio_error_t pbdrv_bluetooth_await_advertise_or_scan_command(pbio_os_state_t *st
     return advertising_or_scan_err;
 }
 
+/**
+ * Drains stdout into the stdout notification, appending to data that is
+ * already waiting to be sent.
+ */
+static void drain_stdout(void) {
+    uint8_t *buf = pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
+    uint32_t *size = &pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
+
+    // Message always starts with event byte.
+    if (!*size) {
+        buf[0] = PBIO_PYBRICKS_EVENT_WRITE_STDOUT;
+        *size = 1;
+    }
+    // Drain ring buffer to send buffer as much as we can.
+    *size += lwrb_read(&stdout_ring_buf, &buf[*size], PBDRV_BLUETOOTH_MAX_CHAR_SIZE - *size);
+}
+
+/**
+ * Drains stdout into the stdout notification as one compressed block. Each
+ * block is complete, so nothing can be appended to it.
+ */
+static void drain_stdout_compressed(void) {
+    #if PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION
+    uint8_t *buf = pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
+    uint32_t *size = &pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
+
+    if (*size) {
+        return;
+    }
+
+    // Whatever does not fit stays in the ring buffer for the next block.
+    uint8_t raw[PBDRV_BLUETOOTH_MAX_CHAR_SIZE * PBDRV_BLUETOOTH_STDOUT_NUM_CHARS];
+    uint32_t raw_size = lwrb_peek(&stdout_ring_buf, 0, raw, sizeof(raw));
+    uint32_t block_size = pbio_lz4_encode(&stdout_encoder, raw, &raw_size, &buf[1], PBDRV_BLUETOOTH_MAX_CHAR_SIZE - 1);
+    if (!block_size) {
+        return;
+    }
+    lwrb_skip(&stdout_ring_buf, raw_size);
+    buf[0] = PBIO_PYBRICKS_EVENT_WRITE_STDOUT_COMPRESSED;
+    *size = block_size + 1;
+    #endif
+}
+
 /**
  * Updates send buffers by draining relevant data buffers and find which event
  * has the highest priority to send.
@@ -501,8 +759,15 @@ static bool update_and_get_event_buffer(uint8_t **buf, uint32_t **len) {
 
     static pbio_os_timer_t status_timer;
 
+    // Changes that were undone while waiting don't need to be sent.
+    uint8_t *status_sent = pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_STATUS_REPORT];
+    if (status_data_pending && !pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_STATUS_REPORT] &&
+        !memcmp(status_sent, status_data, PBIO_PYBRICKS_EVENT_STATUS_REPORT_SIZE)) {
+        status_data_pending = false;
+    }
+
     // Prepare status.
-    if (status_data_pending || pbio_os_timer_is_expired(&status_timer)) {
+    if ((status_data_pending && pbio_os_timer_is_expired(&status_flush_timer)) || pbio_os_timer_is_expired(&status_timer)) {
         // When a status is pending, drain it here while we write it out,
         // so a new status can be set in the mean time without losing it.
         memcpy(pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_STATUS_REPORT], status_data, PBIO_PYBRICKS_EVENT_STATUS_REPORT_SIZE);
@@ -511,18 +776,22 @@ static bool update_and_get_event_buffer(uint8_t **buf, uint32_t **len) {
         pbio_os_timer_set(&status_timer, PBDRV_BLUETOOTH_STATUS_UPDATE_INTERVAL);
     }
 
-    // Prepare stdout, drain into chunk of maximum send size.
-    if (lwrb_get_full(&stdout_ring_buf) != 0) {
-        // Message always starts with event byte.
-        if (!pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT]) {
-            pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_WRITE_STDOUT][0] = PBIO_PYBRICKS_EVENT_WRITE_STDOUT;
-            pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT] = 1;
+    // Prepare stdout, drain into chunk of maximum send size. Wait for more
+    // data until there is enough for a full notification, unless a flush was
+    // requested or the oldest data has waited long enough.
+    uint32_t stdout_size = lwrb_get_full(&stdout_ring_buf);
+    uint32_t stdout_full_size = stdout_compressed ?
+        PBDRV_BLUETOOTH_MAX_CHAR_SIZE * (PBDRV_BLUETOOTH_STDOUT_NUM_CHARS - 1) : PBDRV_BLUETOOTH_MAX_CHAR_SIZE - 1;
+    if (stdout_size != 0 && (stdout_flush_requested ||
+                             stdout_size >= stdout_full_size ||
+                             pbio_os_timer_is_expired(&stdout_flush_timer))) {
+        if (stdout_compressed) {
+            drain_stdout_compressed();
+        } else {
+            drain_stdout();
         }
-        // Drain ring buffer to send buffer as much as we can.
-        uint32_t stdout_free = sizeof(pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_WRITE_STDOUT]) - pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
-        if (stdout_free) {
-            uint8_t *dest = &pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_WRITE_STDOUT][sizeof(pbdrv_bluetooth_noti_buf[PBIO_PYBRICKS_EVENT_WRITE_STDOUT]) - stdout_free];
-            pbdrv_bluetooth_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT] += lwrb_read(&stdout_ring_buf, dest, stdout_free);
+        if (lwrb_get_full(&stdout_ring_buf) == 0) {
+            stdout_flush_requested = false;
         }
     }
 
@@ -584,6 +853,54 @@ pbio_error_t pbdrv_bluetooth_await_classic_task(pbio_os_state_t *state, void *co
 static bool pbdrv_bluetooth_shutting_down;
 static pbio_os_timer_t pbdrv_bluetooth_shutting_down_watchdog;
 
+/**
+ * Whether the controller is initialized. Initialization can take a while due
+ * to loading firmware patches, so the system does not wait for it on boot.
+ */
+static bool pbdrv_bluetooth_ready;
+
+bool pbdrv_bluetooth_is_ready(void) {
+    return pbdrv_bluetooth_ready;
+}
+
+#if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+/**
+ * Advances the pending tasks of all peripherals, except for scanning.
+ *
+ * Operations on different connections do not interfere with each other, so
+ * they run side by side instead of waiting for each other. This runs each
+ * time the Bluetooth process runs, so every task sees every event regardless
+ * of what the main thread is doing.
+ *
+ * Scanning and connecting is left to the main thread, one peripheral at a
+ * time, because it competes with observing and advertising for the radio.
+ */
+static void pbdrv_bluetooth_peripheral_run_tasks(void) {
+
+    for (uint8_t i = 0; i < PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS; i++) {
+        pbdrv_bluetooth_peripheral_t *peri = pbdrv_bluetooth_peripheral_get_by_index(i);
+
+        if (peri->func && peri->func != pbdrv_bluetooth_peripheral_scan_and_connect_func) {
+            pbio_error_t err = peri->func(&peri->func_state, peri);
+            if (err != PBIO_ERROR_AGAIN) {
+                peri->err = err;
+                peri->func = NULL;
+                peri->cancel = false;
+                peri->func_state = 0;
+            }
+        }
+
+        // Send queued writes without response. Nobody awaits these, so
+        // errors are not reported.
+        if (peri->write_queue_size && peri->func != pbdrv_bluetooth_peripheral_scan_and_connect_func) {
+            if (pbdrv_bluetooth_peripheral_write_queue_func(&peri->write_queue_state, peri) != PBIO_ERROR_AGAIN) {
+                peri->write_queue_state = 0;
+            }
+        }
+    }
+}
+#endif // PBDRV_CONFIG_BLUETOOTH_BTSTACK
+
 /**
  * This is the main high level pbdrv/bluetooth thread. It is driven forward by
  * the platform-specific HCI process whenever there is new data to process or
@@ -612,10 +929,18 @@ pbio_error_t pbdrv_bluetooth_process_thread(pbio_os_state_t *state, void *contex
         goto shutdown;
     }
 
+    #if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+    if (pbdrv_bluetooth_ready) {
+        pbdrv_bluetooth_peripheral_run_tasks();
+    }
+    #endif
+
     PBIO_OS_ASYNC_BEGIN(state);
 
 init:
 
+    pbdrv_bluetooth_ready = false;
+
     DEBUG_PRINT("Bluetooth reset.\n");
 
     PBIO_OS_AWAIT(state, &sub, pbdrv_bluetooth_controller_reset(&sub, &timer));
@@ -630,6 +955,13 @@ init:
 
     DEBUG_PRINT("Bluetooth is now on and initialized.\n");
 
+    pbio_os_timer_set(&tx_rate_timer, PBDRV_BLUETOOTH_TX_RATE_INTERVAL);
+
+    // Let the system know that it can start advertising.
+    pbdrv_bluetooth_ready = true;
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_BLUETOOTH);
+    pbio_os_request_poll();
+
     // Service scheduled tasks as long as Bluetooth is enabled.
     while (!pbdrv_bluetooth_shutting_down) {
 
@@ -642,20 +974,53 @@ init:
         static uint32_t *noti_size;
         static uint8_t *noti_buf;
         if (can_send && update_and_get_event_buffer(&noti_buf, &noti_size)) {
+            pbio_tracepoint_record(PBIO_TRACEPOINT_BLE_TX_START, noti_buf[0], *noti_size);
             PBIO_OS_AWAIT(state, &sub, pbdrv_bluetooth_send_pybricks_value_notification(&sub, noti_buf, *noti_size));
+            pbio_tracepoint_record(PBIO_TRACEPOINT_BLE_TX_END, noti_buf[0], 0);
+            tx_rate_bytes += *noti_size;
+            if (noti_buf[0] != PBIO_PYBRICKS_EVENT_STATUS_REPORT) {
+                pbio_os_timer_set(&link_idle_timer, PBDRV_BLUETOOTH_LINK_IDLE_TIME);
+            }
             *noti_size = 0;
         }
+        pbdrv_bluetooth_update_tx_rate();
+
+        // Request a short connection interval while streaming events such as
+        // stdout and app data, and relax it again when idle. A new connection
+        // starts with the idle parameters.
+        static bool link_fast_wanted;
+        link_fast_wanted = !pbio_os_timer_is_expired(&link_idle_timer);
+        if (!can_send) {
+            link_fast = false;
+        } else if (link_fast != link_fast_wanted) {
+            PBIO_OS_AWAIT(state, &sub, pbdrv_bluetooth_host_request_link_params(&sub, link_fast_wanted));
+            link_fast = link_fast_wanted;
+        }
 
         // Handle pending advertising/scan enable/disable task, if any.
         if (advertising_or_scan_func) {
             PBIO_OS_AWAIT(state, &sub, advertising_or_scan_err = advertising_or_scan_func(&sub, NULL));
+
+            // Send broadcast data that was updated in the mean time.
+            while (broadcast_update_pending && advertising_or_scan_err == PBIO_SUCCESS) {
+                broadcast_update_pending = false;
+                pbdrv_bluetooth_broadcast_data_size = broadcast_data_next_size;
+                memcpy(pbdrv_bluetooth_broadcast_data, broadcast_data_next, broadcast_data_next_size);
+                PBIO_OS_AWAIT(state, &sub, advertising_or_scan_err = advertising_or_scan_func(&sub, NULL));
+            }
+            broadcast_update_pending = false;
             advertising_or_scan_func = NULL;
         }
 
-        // Handle pending peripheral tasks, one at a time.
+        // Handle pending peripheral tasks, one at a time. With btstack, only
+        // scanning is done here and the rest runs side by side, above.
         for (peri_index = 0; peri_index < PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS; peri_index++) {
             peri = pbdrv_bluetooth_peripheral_get_by_index(peri_index);
+            #if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+            if (peri->func == pbdrv_bluetooth_peripheral_scan_and_connect_func) {
+            #else
             if (peri->func) {
+            #endif
 
                 // If currently observing, stop if we need to scan for a peripheral.
                 if (pbdrv_bluetooth_is_observing && peri->func == pbdrv_bluetooth_peripheral_scan_and_connect_func) {
@@ -699,6 +1064,8 @@ init:
 
 shutdown:
 
+    pbdrv_bluetooth_ready = false;
+
     PBIO_OS_AWAIT(state, &sub, pbdrv_bluetooth_controller_reset(&sub, &timer));
 
     pbdrv_bluetooth_shutting_down = false;
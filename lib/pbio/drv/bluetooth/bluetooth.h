@@ -28,20 +28,59 @@ pbio_error_t pbdrv_bluetooth_stop_advertising_func(pbio_os_state_t *state, void
 pbio_error_t pbdrv_bluetooth_start_observing_func(pbio_os_state_t *state, void *context);
 pbio_error_t pbdrv_bluetooth_stop_observing_func(pbio_os_state_t *state, void *context);
 
+#if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+bool pbdrv_bluetooth_extended_advertising_is_supported(void);
+#endif
+
 pbdrv_bluetooth_peripheral_t *pbdrv_bluetooth_peripheral_get_by_index(uint8_t index);
 pbio_error_t pbdrv_bluetooth_peripheral_disconnect_func(pbio_os_state_t *state, void *context);
 pbio_error_t pbdrv_bluetooth_peripheral_discover_characteristic_func(pbio_os_state_t *state, void *context);
 pbio_error_t pbdrv_bluetooth_peripheral_read_characteristic_func(pbio_os_state_t *state, void *context);
 pbio_error_t pbdrv_bluetooth_peripheral_scan_and_connect_func(pbio_os_state_t *state, void *context);
 pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic_func(pbio_os_state_t *state, void *context);
+#if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+pbio_error_t pbdrv_bluetooth_peripheral_write_queue_func(pbio_os_state_t *state, void *context);
+#endif
 
 pbio_error_t pbdrv_bluetooth_send_pybricks_value_notification(pbio_os_state_t *state, const uint8_t *data, uint16_t size);
 
+/**
+ * Connection interval requested while events are streaming to the host, in
+ * units of 1.25 ms. This is within Apple's accessory guidelines.
+ */
+#define PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MIN (12) // 15 ms
+#define PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MAX (24) // 30 ms
+
+/**
+ * Connection interval requested when the host link is idle, in units of
+ * 1.25 ms. This leaves more air time for scanning and peripherals.
+ */
+#define PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MIN (24) // 30 ms
+#define PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MAX (48) // 60 ms
+
+/**
+ * Supervision timeout of the host link in units of 10 ms.
+ */
+#define PBDRV_BLUETOOTH_LINK_TIMEOUT (500) // 5 s
+
+/**
+ * Asks the host to change the connection parameters, and enables faster data
+ * transfer options where the controller supports them.
+ *
+ * The host may reject or adjust the request, so this does not wait for the
+ * new parameters to take effect.
+ *
+ * @param [in]  state   Protothread state.
+ * @param [in]  fast    Choose @c true for streaming, @c false for idle.
+ * @return              ::PBIO_SUCCESS when the request was sent.
+ */
+pbio_error_t pbdrv_bluetooth_host_request_link_params(pbio_os_state_t *state, bool fast);
+
 void pbdrv_bluetooth_host_connection_changed(void);
 
 extern pbdrv_bluetooth_receive_handler_t pbdrv_bluetooth_receive_handler;
 
-extern uint8_t pbdrv_bluetooth_broadcast_data[PBDRV_BLUETOOTH_MAX_ADV_SIZE];
+extern uint8_t pbdrv_bluetooth_broadcast_data[PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE];
 extern uint8_t pbdrv_bluetooth_broadcast_data_size;
 
 typedef enum {
@@ -336,6 +336,45 @@ static bool pbdrv_bluetooth_btstack_ble_supported(void) {
     return chipset_info && chipset_info->supports_ble;
 }
 
+#if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+
+/** Whether the controller reported the LE Extended Advertising feature. */
+static bool extended_advertising_supported;
+
+/** Advertising set used for broadcasts that don't fit in legacy advertising. */
+static le_advertising_set_t broadcast_set;
+static uint8_t broadcast_set_handle;
+static bool broadcast_set_ready;
+static bool broadcast_set_enabled;
+
+bool pbdrv_bluetooth_extended_advertising_is_supported(void) {
+    return pbdrv_bluetooth_btstack_ble_supported() && extended_advertising_supported;
+}
+
+#endif // PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+
+/**
+ * Tests if the current event completes an advertising command.
+ *
+ * If the controller supports it, BTstack implements the legacy advertising
+ * API with the extended advertising commands, so accept either one.
+ *
+ * @param [in]  legacy      The legacy command.
+ * @param [in]  extended    The equivalent extended advertising command.
+ * @return                  True if either command just completed.
+ */
+static bool advertising_command_complete(const hci_cmd_t *legacy, const hci_cmd_t *extended) {
+    if (!event_packet) {
+        return false;
+    }
+    #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+    if (HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, *extended)) {
+        return true;
+    }
+    #endif
+    return HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, *legacy);
+}
+
 // currently, this function just handles the Powered Up handset control.
 static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size) {
 
@@ -352,6 +391,12 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                     chipset_info = pbdrv_bluetooth_btstack_set_chipset(&info);
                     break;
                 }
+                #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+                case HCI_OPCODE_HCI_LE_READ_SUPPORTED_FEATURES:
+                    // LE Extended Advertising is bit 12 of the feature mask.
+                    extended_advertising_supported = rp[0] == ERROR_CODE_SUCCESS && (rp[2] & (1 << 4));
+                    break;
+                #endif
                 default:
                     break;
             }
@@ -429,6 +474,26 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
             }
             break;
         }
+        #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+        case GAP_EVENT_EXTENDED_ADVERTISING_REPORT: {
+            uint16_t event_type = gap_event_extended_advertising_report_get_advertising_event_type(packet);
+
+            // Skip incomplete or truncated data, given by the data status in
+            // bits 5 and 6. Legacy PDUs are reported here too and are always
+            // complete.
+            if (event_type & 0x60) {
+                break;
+            }
+
+            if (pbdrv_bluetooth_observe_callback) {
+                uint8_t data_length = gap_event_extended_advertising_report_get_data_length(packet);
+                const uint8_t *data = gap_event_extended_advertising_report_get_data(packet);
+                int8_t rssi = gap_event_extended_advertising_report_get_rssi(packet);
+                pbdrv_bluetooth_observe_callback(PBDRV_BLUETOOTH_AD_TYPE_ADV_NONCONN_IND, data, data_length, rssi);
+            }
+            break;
+        }
+        #endif
         case GAP_EVENT_ADVERTISING_REPORT: {
             uint8_t event_type = gap_event_advertising_report_get_advertising_event_type(packet);
             uint8_t data_length = gap_event_advertising_report_get_data_length(packet);
@@ -593,7 +658,7 @@ pbio_error_t pbdrv_bluetooth_start_advertising_func(pbio_os_state_t *state, void
     init_advertising_data();
     gap_advertisements_enable(true);
 
-    PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_advertise_enable));
+    PBIO_OS_AWAIT_UNTIL(state, advertising_command_complete(&hci_le_set_advertise_enable, &hci_le_set_extended_advertising_enable));
 
     pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_ADVERTISING_PYBRICKS;
 
@@ -607,6 +672,16 @@ pbio_error_t pbdrv_bluetooth_stop_advertising_func(pbio_os_state_t *state, void
 
     PBIO_OS_ASYNC_BEGIN(state);
 
+    #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+    if (broadcast_set_enabled) {
+        gap_extended_advertising_stop(broadcast_set_handle);
+        broadcast_set_enabled = false;
+        PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_extended_advertising_enable));
+        pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_NONE;
+        return PBIO_SUCCESS;
+    }
+    #endif
+
     gap_advertisements_enable(false);
 
     // REVISIT: use callback to await operation
@@ -616,6 +691,26 @@ pbio_error_t pbdrv_bluetooth_stop_advertising_func(pbio_os_state_t *state, void
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+pbio_error_t pbdrv_bluetooth_host_request_link_params(pbio_os_state_t *state, bool fast) {
+    #if PBDRV_CONFIG_BLUETOOTH_BTSTACK_NUM_LE_HOSTS
+    // BTstack sends the L2CAP request in the background. The supported
+    // controllers don't have LE Data Length Extension or the 2M PHY.
+    for (size_t i = 0; i < PBDRV_CONFIG_BLUETOOTH_BTSTACK_NUM_LE_HOSTS; i++) {
+        pbdrv_bluetooth_btstack_host_connection_t *host = &host_connections[i];
+        if (host->con_handle == HCI_CON_HANDLE_INVALID) {
+            continue;
+        }
+        gap_request_connection_parameter_update(host->con_handle,
+            fast ? PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MIN : PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MIN,
+            fast ? PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MAX : PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MAX,
+            0, PBDRV_BLUETOOTH_LINK_TIMEOUT);
+    }
+    return PBIO_SUCCESS;
+    #else
+    return PBIO_ERROR_NOT_SUPPORTED;
+    #endif
+}
+
 #if PBDRV_CONFIG_BLUETOOTH_BTSTACK_NUM_LE_HOSTS
 static void pybricks_on_ready_to_send(void *context) {
     pbdrv_bluetooth_btstack_host_connection_t *host = context;
@@ -777,6 +872,13 @@ start_scan:
     // The user timeout applies only to finding the device. We still want to
     // have a reasonable timeout for connecting and pairing.
     pbio_os_timer_set(&peri->timer, PERIPHERAL_TIMEOUT_MS_CONNECT);
+    if (peri->config.options & PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY) {
+        // Connection interval: 6 * 1.25 ms = 7.5 ms, no peripheral latency.
+        gap_set_connection_parameters(0x0060, 0x0030, 6, 6, 0, 72, 2, 6);
+    } else {
+        // BTstack defaults.
+        gap_set_connection_parameters(0x0060, 0x0030, 0x0008, 0x0018, 4, 72, 2, 0x0030);
+    }
     btstack_error = gap_connect(peri->bdaddr, peri->bdaddr_type);
     if (btstack_error != ERROR_CODE_SUCCESS) {
         return att_error_to_pbio_error(btstack_error);
@@ -1093,6 +1195,49 @@ pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic_func(pbio_os_state_
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+pbio_error_t pbdrv_bluetooth_peripheral_write_queue_func(pbio_os_state_t *state, void *context) {
+    pbdrv_bluetooth_peripheral_t *peri = context;
+
+    if (!pbdrv_bluetooth_btstack_ble_supported()) {
+        peri->write_queue_size = 0;
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+
+    uint8_t btstack_error;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    while (peri->write_queue_size) {
+
+        // Retry the oldest write until there is room to send it. If it gets
+        // replaced by a newer value meanwhile, that is sent instead.
+        PBIO_OS_AWAIT_UNTIL(state, ({
+            if (!pbdrv_bluetooth_peripheral_is_connected(peri)) {
+                peri->write_queue_size = 0;
+                return PBIO_ERROR_NO_DEV;
+            }
+
+            pbdrv_bluetooth_peripheral_write_t *write = &peri->write_queue[0];
+            btstack_error = gatt_client_write_value_of_characteristic_without_response(
+                peri->con_handle, write->handle, write->size, write->data);
+
+            // The wait until condition: sent, or failed for a reason other
+            // than full buffers.
+            btstack_error != GATT_CLIENT_BUSY && btstack_error != BTSTACK_ACL_BUFFERS_FULL;
+        }));
+
+        if (btstack_error != ERROR_CODE_SUCCESS) {
+            DEBUG_PRINT("Write without response failed: %d\n", btstack_error);
+        }
+
+        // Sent or dropped, so remove it.
+        peri->write_queue_size--;
+        memmove(&peri->write_queue[0], &peri->write_queue[1], peri->write_queue_size * sizeof(peri->write_queue[0]));
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 pbio_error_t pbdrv_bluetooth_peripheral_disconnect_func(pbio_os_state_t *state, void *context) {
     if (!pbdrv_bluetooth_btstack_ble_supported()) {
         return PBIO_ERROR_NOT_SUPPORTED;
@@ -1116,11 +1261,63 @@ pbio_error_t pbdrv_bluetooth_start_broadcasting_func(pbio_os_state_t *state, voi
 
     PBIO_OS_ASYNC_BEGIN(state);
 
+    #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+    if (pbdrv_bluetooth_broadcast_data_size > PBDRV_BLUETOOTH_MAX_ADV_SIZE) {
+        // Switching from a legacy broadcast, so stop that one first.
+        if (pbdrv_bluetooth_advertising_state == PBDRV_BLUETOOTH_ADVERTISING_STATE_BROADCASTING && !broadcast_set_enabled) {
+            gap_advertisements_enable(false);
+            PBIO_OS_AWAIT_UNTIL(state, advertising_command_complete(&hci_le_set_advertise_enable, &hci_le_set_extended_advertising_enable));
+            pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_NONE;
+        }
+
+        // The set is made once and reused for all extended broadcasts. This
+        // uses a shorter interval than legacy broadcasting since the data is
+        // only sent on the primary channels once per event.
+        if (!broadcast_set_ready) {
+            static const le_extended_advertising_parameters_t params = {
+                .advertising_event_properties = 0, // non-connectable, non-scannable
+                .primary_advertising_interval_min = 0x30,
+                .primary_advertising_interval_max = 0x30,
+                .primary_advertising_channel_map = 0x07,
+                .own_address_type = BD_ADDR_TYPE_LE_PUBLIC,
+                .advertising_tx_power = 127, // no preference
+                .primary_advertising_phy = 1, // LE 1M
+                .secondary_advertising_phy = 1, // LE 1M
+            };
+            if (gap_extended_advertising_setup(&broadcast_set, &params, &broadcast_set_handle) != ERROR_CODE_SUCCESS) {
+                return PBIO_ERROR_FAILED;
+            }
+            PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_extended_advertising_parameters));
+            broadcast_set_ready = true;
+        }
+
+        gap_extended_advertising_set_adv_data(broadcast_set_handle, pbdrv_bluetooth_broadcast_data_size, pbdrv_bluetooth_broadcast_data);
+        PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_extended_advertising_data));
+
+        if (!broadcast_set_enabled) {
+            gap_extended_advertising_start(broadcast_set_handle, 0, 0);
+            broadcast_set_enabled = true;
+            PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_extended_advertising_enable));
+        }
+
+        pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_BROADCASTING;
+        return PBIO_SUCCESS;
+    }
+
+    // Switching from an extended broadcast, so stop that one first.
+    if (broadcast_set_enabled) {
+        gap_extended_advertising_stop(broadcast_set_handle);
+        broadcast_set_enabled = false;
+        PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_extended_advertising_enable));
+        pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_NONE;
+    }
+    #endif // PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+
     gap_advertisements_set_data(pbdrv_bluetooth_broadcast_data_size, pbdrv_bluetooth_broadcast_data);
 
     // If already broadcasting, await set data and return.
     if (pbdrv_bluetooth_advertising_state == PBDRV_BLUETOOTH_ADVERTISING_STATE_BROADCASTING) {
-        PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_advertising_data));
+        PBIO_OS_AWAIT_UNTIL(state, advertising_command_complete(&hci_le_set_advertising_data, &hci_le_set_extended_advertising_data));
         return PBIO_SUCCESS;
     }
 
@@ -1128,7 +1325,7 @@ pbio_error_t pbdrv_bluetooth_start_broadcasting_func(pbio_os_state_t *state, voi
     gap_advertisements_set_params(0xA0, 0xA0, PBDRV_BLUETOOTH_AD_TYPE_ADV_NONCONN_IND, 0, null_addr, 0x7, 0);
     gap_advertisements_enable(true);
 
-    PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_set_advertise_enable));
+    PBIO_OS_AWAIT_UNTIL(state, advertising_command_complete(&hci_le_set_advertise_enable, &hci_le_set_extended_advertising_enable));
 
     pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_BROADCASTING;
 
@@ -1221,6 +1418,12 @@ pbio_error_t pbdrv_bluetooth_inquiry_scan_func(pbio_os_state_t *state, void *con
         hci_event_is_type(event_packet, GAP_EVENT_INQUIRY_COMPLETE);
     }));
 
+    // If we stopped because we have enough results, the controller is still
+    // scanning, so stop it. This is harmless if it just completed.
+    if (*task->inq_count == *task->inq_count_max) {
+        gap_inquiry_stop();
+    }
+
     DEBUG_PRINT("Inquiry scan ended with %d results.\n", *task->inq_count);
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
@@ -1290,6 +1493,16 @@ pbio_error_t pbdrv_bluetooth_controller_initialize(pbio_os_state_t *state, pbio_
     // Wait for power on.
     PBIO_OS_AWAIT(state, &sub, bluetooth_btstack_handle_power_control(&sub, HCI_POWER_ON, HCI_STATE_WORKING));
 
+    #if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+    // Find out if larger broadcasts are possible. The response is parsed in
+    // the packet handler.
+    if (pbdrv_bluetooth_btstack_ble_supported()) {
+        PBIO_OS_AWAIT_UNTIL(state, hci_can_send_command_packet_now());
+        hci_send_cmd(&hci_le_read_supported_features);
+        PBIO_OS_AWAIT_UNTIL(state, event_packet && HCI_EVENT_IS_COMMAND_COMPLETE(event_packet, hci_le_read_supported_features));
+    }
+    #endif
+
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
@@ -156,7 +156,8 @@ static int btstack_stm32_hal_init(const btstack_uart_config_t *config) {
     btstack_huart.Init.Parity = UART_PARITY_NONE;
     btstack_huart.Init.Mode = UART_MODE_TX_RX;
     btstack_huart.Init.HwFlowCtl = config->flowcontrol ? UART_HWCONTROL_RTS_CTS : UART_HWCONTROL_NONE;
-    btstack_huart.Init.OverSampling = UART_OVERSAMPLING_16;
+    // Oversampling by 8 is needed to reach the maximum baud rate below.
+    btstack_huart.Init.OverSampling = UART_OVERSAMPLING_8;
     HAL_UART_Init(&btstack_huart);
 
     __HAL_LINKDMA(&btstack_huart, hdmatx, btstack_tx_hdma);
@@ -216,7 +217,7 @@ static int btstack_stm32_hal_set_baudrate(uint32_t baud) {
         periphclk = rcc_clocks.PCLK1_Frequency;
     }
 
-    LL_USART_SetBaudRate(usart, periphclk, LL_USART_OVERSAMPLING_16, baud);
+    LL_USART_SetBaudRate(usart, periphclk, LL_USART_OVERSAMPLING_8, baud);
 
     return 0;
 }
@@ -282,12 +283,14 @@ const hci_transport_t *pbdrv_bluetooth_btstack_stm32_hal_transport_instance(void
 
 const void *pbdrv_bluetooth_btstack_stm32_hal_transport_config(void) {
     // Note on baud rate: with a 48MHz clock, 3000000 baud is the highest we can
-    // go with LL_USART_OVERSAMPLING_16. With LL_USART_OVERSAMPLING_8 we could
-    // go to 4000000, which is the max rating of the CC2564C.
+    // go with LL_USART_OVERSAMPLING_16. With LL_USART_OVERSAMPLING_8 we can
+    // go to 4000000, which is the max rating of the CC2564C. This is exact
+    // (divider 1.5). btstack switches to it with the CC256x vendor command
+    // during init.
     static const hci_transport_config_uart_t config = {
         .type = HCI_TRANSPORT_CONFIG_UART,
         .baudrate_init = 115200,
-        .baudrate_main = 3000000,
+        .baudrate_main = 4000000,
         .flowcontrol = 1,
         .device_name = NULL,
     };
@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Bluetooth driver for the virtual hub that simulates the radio in memory.
+//
+// Only broadcasting and observing are simulated. Each virtual hub process
+// maps the same file, which holds one slot of advertising data per
+// broadcasting hub. Observers read all other slots on every advertising
+// interval, much like a real radio would receive them. This requires no
+// Bluetooth hardware, so multi-hub tests can run anywhere.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BLUETOOTH_SIMULATION
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <pbdrv/bluetooth.h>
+#include <pbio/os.h>
+
+#include "bluetooth.h"
+
+/**
+ * Number of hubs that can broadcast at the same time.
+ */
+#define RADIO_NUM_SLOTS (16)
+
+/**
+ * Interval at which observers receive the advertising data (ms).
+ */
+#define RADIO_ADVERTISING_INTERVAL (50)
+
+/**
+ * Signal strength reported for all simulated advertisements (dBm).
+ */
+#define RADIO_RSSI (-40)
+
+/**
+ * Advertising data of one broadcasting hub.
+ */
+typedef struct {
+    /** Process ID of the hub that owns this slot, or 0 if free. */
+    int32_t pid;
+    /** Incremented before and after each update, so it is odd while writing. */
+    uint32_t seq;
+    /** Size of the data, or 0 if not broadcasting. */
+    uint8_t size;
+    /** The advertising data. */
+    uint8_t data[PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE];
+} radio_slot_t;
+
+/**
+ * The simulated radio, shared between all virtual hub processes.
+ */
+static radio_slot_t *radio;
+
+/**
+ * Slot used by this hub, or NULL if not broadcasting.
+ */
+static radio_slot_t *own_slot;
+
+static pbdrv_bluetooth_peripheral_t peripherals[PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS];
+
+static pbio_error_t bluetooth_thread_err = PBIO_ERROR_NO_DEV;
+
+static char pbdrv_bluetooth_hub_name[16] = "Pybricks Hub";
+
+/**
+ * Maps the file that holds the simulated radio.
+ *
+ * @return ::PBIO_SUCCESS on success, or ::PBIO_ERROR_NO_DEV if the file could
+ *         not be mapped, so it can continue without Bluetooth.
+ */
+static pbio_error_t radio_open(void) {
+    const char *path = getenv("PYBRICKS_RADIO");
+    if (!path) {
+        path = "/tmp/pybricks_radio";
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    size_t size = sizeof(radio_slot_t) * RADIO_NUM_SLOTS;
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    radio = map;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Tests whether the hub that owns a slot is still running.
+ */
+static bool radio_slot_is_alive(radio_slot_t *slot) {
+    int32_t pid = __atomic_load_n(&slot->pid, __ATOMIC_ACQUIRE);
+    return pid && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+/**
+ * Claims a slot for this hub. Slots left behind by hubs that are no longer
+ * running are reused.
+ */
+static radio_slot_t *radio_claim_slot(void) {
+    int32_t pid = getpid();
+    for (uint32_t i = 0; i < RADIO_NUM_SLOTS; i++) {
+        radio_slot_t *slot = &radio[i];
+        int32_t owner = __atomic_load_n(&slot->pid, __ATOMIC_ACQUIRE);
+        if (owner == pid) {
+            return slot;
+        }
+        if (radio_slot_is_alive(slot)) {
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&slot->pid, &owner, pid, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static void radio_write(radio_slot_t *slot, const uint8_t *data, uint8_t size) {
+    __atomic_add_fetch(&slot->seq, 1, __ATOMIC_ACQ_REL);
+    memcpy(slot->data, data, size);
+    slot->size = size;
+    __atomic_add_fetch(&slot->seq, 1, __ATOMIC_ACQ_REL);
+}
+
+static void radio_release_slot(void) {
+    if (!own_slot) {
+        return;
+    }
+    radio_write(own_slot, NULL, 0);
+    __atomic_store_n(&own_slot->pid, 0, __ATOMIC_RELEASE);
+    own_slot = NULL;
+}
+
+/**
+ * Delivers the data of all other broadcasting hubs to the observer.
+ */
+static void radio_receive(void) {
+    for (uint32_t i = 0; i < RADIO_NUM_SLOTS; i++) {
+        radio_slot_t *slot = &radio[i];
+        if (slot == own_slot || !radio_slot_is_alive(slot)) {
+            continue;
+        }
+
+        // Copy the data, trying again if it was written meanwhile.
+        uint8_t data[PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE];
+        uint8_t size;
+        uint32_t seq;
+        do {
+            seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            size = slot->size;
+            if (size > sizeof(data)) {
+                size = 0;
+            }
+            memcpy(data, slot->data, size);
+        } while (seq % 2 || seq != __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE));
+
+        if (size && pbdrv_bluetooth_observe_callback) {
+            pbdrv_bluetooth_observe_callback(PBDRV_BLUETOOTH_AD_TYPE_ADV_NONCONN_IND, data, size, RADIO_RSSI);
+        }
+    }
+}
+
+pbdrv_bluetooth_peripheral_t *pbdrv_bluetooth_peripheral_get_by_index(uint8_t index) {
+    if (index >= PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS) {
+        return NULL;
+    }
+    return &peripherals[index];
+}
+
+bool pbdrv_bluetooth_peripheral_is_connected(pbdrv_bluetooth_peripheral_t *peri) {
+    return false;
+}
+
+bool pbdrv_bluetooth_host_is_connected(void) {
+    return false;
+}
+
+bool pbdrv_bluetooth_hci_is_enabled(void) {
+    return bluetooth_thread_err == PBIO_ERROR_AGAIN;
+}
+
+#if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+bool pbdrv_bluetooth_extended_advertising_is_supported(void) {
+    return true;
+}
+#endif
+
+const char *pbdrv_bluetooth_get_hub_name(void) {
+    return pbdrv_bluetooth_hub_name;
+}
+
+const char *pbdrv_bluetooth_get_fw_version(void) {
+    return "sim";
+}
+
+pbio_error_t pbdrv_bluetooth_start_advertising_func(pbio_os_state_t *state, void *context) {
+    // There are no hosts to connect, so just keep track of the state.
+    radio_release_slot();
+    pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_ADVERTISING_PYBRICKS;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_stop_advertising_func(pbio_os_state_t *state, void *context) {
+    radio_release_slot();
+    pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_NONE;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_start_broadcasting_func(pbio_os_state_t *state, void *context) {
+    if (!own_slot) {
+        own_slot = radio_claim_slot();
+        if (!own_slot) {
+            return PBIO_ERROR_BUSY;
+        }
+    }
+    radio_write(own_slot, pbdrv_bluetooth_broadcast_data, pbdrv_bluetooth_broadcast_data_size);
+    pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_BROADCASTING;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_start_observing_func(pbio_os_state_t *state, void *context) {
+    pbdrv_bluetooth_is_observing = true;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_stop_observing_func(pbio_os_state_t *state, void *context) {
+    pbdrv_bluetooth_is_observing = false;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_host_request_link_params(pbio_os_state_t *state, bool fast) {
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_send_pybricks_value_notification(pbio_os_state_t *state, const uint8_t *data, uint16_t size) {
+    return PBIO_ERROR_INVALID_OP;
+}
+
+pbio_error_t pbdrv_bluetooth_peripheral_scan_and_connect_func(pbio_os_state_t *state, void *context) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+pbio_error_t pbdrv_bluetooth_peripheral_discover_characteristic_func(pbio_os_state_t *state, void *context) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+pbio_error_t pbdrv_bluetooth_peripheral_read_characteristic_func(pbio_os_state_t *state, void *context) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic_func(pbio_os_state_t *state, void *context) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+pbio_error_t pbdrv_bluetooth_peripheral_disconnect_func(pbio_os_state_t *state, void *context) {
+    return PBIO_SUCCESS;
+}
+
+#if PBDRV_CONFIG_BLUETOOTH_NUM_CLASSIC_CONNECTIONS
+pbio_error_t pbdrv_bluetooth_inquiry_scan_func(pbio_os_state_t *state, void *context) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+#endif
+
+void pbdrv_bluetooth_controller_reset_hard(void) {
+    radio_release_slot();
+}
+
+pbio_error_t pbdrv_bluetooth_controller_reset(pbio_os_state_t *state, pbio_os_timer_t *timer) {
+    radio_release_slot();
+    pbdrv_bluetooth_advertising_state = PBDRV_BLUETOOTH_ADVERTISING_STATE_NONE;
+    pbdrv_bluetooth_is_observing = false;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_controller_initialize(pbio_os_state_t *state, pbio_os_timer_t *timer) {
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_bluetooth_disconnect_all(pbio_os_state_t *state) {
+    return PBIO_SUCCESS;
+}
+
+static pbio_os_process_t pbdrv_bluetooth_simulation_process;
+
+static pbio_error_t pbdrv_bluetooth_simulation_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_state_t main_thread_state;
+    static pbio_os_timer_t timer;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_ASYNC_RESET(&main_thread_state);
+    pbio_os_timer_set(&timer, RADIO_ADVERTISING_INTERVAL);
+
+    for (;;) {
+        // Iterate the main Bluetooth thread once. It completes on shutdown.
+        bluetooth_thread_err = pbdrv_bluetooth_process_thread(&main_thread_state, NULL);
+        if (bluetooth_thread_err != PBIO_ERROR_AGAIN) {
+            return bluetooth_thread_err;
+        }
+
+        // Receive broadcasts once per advertising interval.
+        if (pbio_os_timer_is_expired(&timer)) {
+            pbio_os_timer_extend(&timer);
+            if (pbdrv_bluetooth_is_observing) {
+                radio_receive();
+            }
+        }
+
+        PBIO_OS_AWAIT_ONCE(state);
+    }
+
+    // Unreachable.
+    PBIO_OS_ASYNC_END(PBIO_ERROR_FAILED);
+}
+
+void pbdrv_bluetooth_init_hci(void) {
+    // Continue without Bluetooth if the radio is not available.
+    if (radio_open() != PBIO_SUCCESS) {
+        return;
+    }
+
+    bluetooth_thread_err = PBIO_ERROR_AGAIN;
+    pbio_os_process_start(&pbdrv_bluetooth_simulation_process, pbdrv_bluetooth_simulation_process_thread, NULL);
+}
+
+#endif // PBDRV_CONFIG_BLUETOOTH_SIMULATION
@@ -309,6 +309,21 @@ pbio_error_t pbdrv_bluetooth_stop_advertising_func(pbio_os_state_t *state, void
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+pbio_error_t pbdrv_bluetooth_host_request_link_params(pbio_os_state_t *state, bool fast) {
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // The BlueNRG-MS does not have LE Data Length Extension or the 2M PHY.
+    PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
+    aci_l2cap_connection_parameter_update_request_begin(conn_handle,
+        fast ? PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MIN : PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MIN,
+        fast ? PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MAX : PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MAX,
+        0, PBDRV_BLUETOOTH_LINK_TIMEOUT);
+    PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
+    // aci_l2cap_connection_parameter_update_request_end();
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 pbio_error_t pbdrv_bluetooth_send_pybricks_value_notification(pbio_os_state_t *state, const uint8_t *data, uint16_t size) {
 
     PBIO_OS_ASYNC_BEGIN(state);
@@ -432,8 +447,14 @@ try_again:
     assert(!peri->con_handle);
 
     PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
-    aci_gap_create_connection_begin(0x0060, 0x0030, peri->bdaddr_type, peri->bdaddr,
-        STATIC_RANDOM_ADDR, 0x0010 >> 1, 0x0030 >> 1, 4, 720 / 10, 0x0010, 0x0030);
+    if (peri->config.options & PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY) {
+        // Connection interval: 6 * 1.25 ms = 7.5 ms, no peripheral latency.
+        aci_gap_create_connection_begin(0x0060, 0x0030, peri->bdaddr_type, peri->bdaddr,
+            STATIC_RANDOM_ADDR, 6, 6, 0, 720 / 10, 0x0010, 0x0030);
+    } else {
+        aci_gap_create_connection_begin(0x0060, 0x0030, peri->bdaddr_type, peri->bdaddr,
+            STATIC_RANDOM_ADDR, 0x0010 >> 1, 0x0030 >> 1, 4, 720 / 10, 0x0010, 0x0030);
+    }
     PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
     peri->status = aci_gap_create_connection_end();
 
@@ -985,6 +1006,12 @@ static void handle_event(hci_event_pckt *event) {
     pbio_os_request_poll();
 }
 
+// The chip is not ready when its buffers are full, which happens a lot while
+// streaming stdout. Retrying right away would keep the CPU and SPI bus busy
+// with header transfers until it is, so wait a bit before trying again.
+#define SPI_RETRY_MS 1
+static pbio_os_timer_t spi_retry_timer;
+
 // read message from BlueNRG chip
 static pbio_error_t spi_read(pbio_os_state_t *state) {
     hci_uart_pckt *pckt = (hci_uart_pckt *)read_buf;
@@ -1008,6 +1035,7 @@ retry:
     if (!get_bluenrg_buf_size(&wbuf, &rbuf) || rbuf == 0) {
         // TODO: should probably have a timeout (and reset the chip after that?)
         spi_disable_cs();
+        PBIO_OS_AWAIT_MS(state, &spi_retry_timer, SPI_RETRY_MS);
         goto retry;
     }
 
@@ -1043,6 +1071,7 @@ retry:
     if (!get_bluenrg_buf_size(&wbuf, &rbuf) || wbuf < write_xfer_size) {
         // TODO: should probably have a timeout (and reset the chip after that?)
         spi_disable_cs();
+        PBIO_OS_AWAIT_MS(state, &spi_retry_timer, SPI_RETRY_MS);
         goto retry;
     }
 
@@ -351,6 +351,34 @@ pbio_error_t pbdrv_bluetooth_stop_advertising_func(pbio_os_state_t *state, void
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+pbio_error_t pbdrv_bluetooth_host_request_link_params(pbio_os_state_t *state, bool fast) {
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
+    {
+        gapUpdateLinkParamReq_t req = {
+            .connectionHandle = conn_handle,
+            .intervalMin = fast ? PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MIN : PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MIN,
+            .intervalMax = fast ? PBDRV_BLUETOOTH_LINK_FAST_INTERVAL_MAX : PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MAX,
+            .connLatency = 0,
+            .connTimeout = PBDRV_BLUETOOTH_LINK_TIMEOUT,
+        };
+        GAP_UpdateLinkParamReq(&req);
+    }
+    PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
+
+    // Also ask for the longest link layer packets so that a full notification
+    // fits in one packet. This stays in effect for the rest of the connection.
+    // If the host or firmware doesn't support it, the command just fails.
+    if (fast) {
+        PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
+        HCI_LE_setDataLength(conn_handle, 251, 2120);
+        PBIO_OS_AWAIT_UNTIL(state, hci_command_complete);
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 pbio_error_t pbdrv_bluetooth_send_pybricks_value_notification(pbio_os_state_t *state, const uint8_t *data, uint16_t size) {
 
     static attHandleValueNoti_t notification;
@@ -529,6 +557,15 @@ try_again:
     GAP_BondMgrSetParameter(GAPBOND_PAIRING_MODE, sizeof(bond_auth_mode_last), &bond_auth_mode_last);
     PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
 
+    // Connection interval: 6 * 1.25 ms = 7.5 ms for low latency, otherwise
+    // the default of 40 * 1.25 ms = 50 ms. Peripheral latency is always 0.
+    PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
+    GAP_SetParamValue(TGAP_CONN_EST_INT_MIN, peri->config.options & PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY ? 6 : 40);
+    PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
+    PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
+    GAP_SetParamValue(TGAP_CONN_EST_INT_MAX, peri->config.options & PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY ? 6 : 40);
+    PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
+
     PBIO_OS_AWAIT_WHILE(state, write_xfer_size);
     GAP_EstablishLinkReq(0, 0, peri->bdaddr_type, peri->bdaddr);
     PBIO_OS_AWAIT_UNTIL(state, hci_command_status);
@@ -1340,10 +1377,10 @@ static void handle_event(uint8_t *packet) {
                         // [1]: https://developer.apple.com/accessories/Accessory-Design-Guidelines.pdf
                         gapUpdateLinkParamReq_t req = {
                             .connectionHandle = conn_handle,
-                            .intervalMin = 24, // 24 * 1.25 ms = 30 ms
-                            .intervalMax = 48, // 48 * 1.25 ms = 60 ms
+                            .intervalMin = PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MIN,
+                            .intervalMax = PBDRV_BLUETOOTH_LINK_IDLE_INTERVAL_MAX,
                             .connLatency = 0,
-                            .connTimeout = 500, // 500 * 10 ms = 5 s
+                            .connTimeout = PBDRV_BLUETOOTH_LINK_TIMEOUT,
                         };
                         GAP_UpdateLinkParamReq(&req);
                     } else if (data[12] == GAP_PROFILE_CENTRAL) {
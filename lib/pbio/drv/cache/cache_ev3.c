@@ -10,6 +10,7 @@
 
 #include <tiam1808/armv5/cp15.h>
 
+#include <pbdrv/cache.h>
 #include <pbdrv/compiler.h>
 
 void pbdrv_cache_prepare_before_dma(const void *buf, size_t sz) {
@@ -28,4 +29,23 @@ void pbdrv_cache_prepare_after_dma(const void *buf, size_t sz) {
     pbdrv_compiler_memory_barrier();
 }
 
+void pbdrv_cache_prepare_before_dma_rx(void *buf, size_t sz) {
+    // Make sure all data around the buffer is written by the compiler...
+    pbdrv_compiler_memory_barrier();
+    // and then write back and invalidate each line that holds the buffer...
+    uintptr_t end = (uintptr_t)buf + sz;
+    for (uintptr_t line = (uintptr_t)buf & ~(PBDRV_CACHE_LINE_SZ - 1); line < end; line += PBDRV_CACHE_LINE_SZ) {
+        __asm__ volatile ("mcr p15, 0, %0, c7, c14, 1" : : "r" (line) : "memory");
+    }
+    // and also the write buffer.
+    CP15DrainWriteBuffer();
+}
+
+void pbdrv_cache_prepare_exec(const void *buf, size_t sz) {
+    // Write the new code out of the data cache...
+    pbdrv_cache_prepare_before_dma(buf, sz);
+    // and then make sure that no stale instructions are fetched.
+    CP15ICacheFlush();
+}
+
 #endif // PBDRV_CONFIG_CACHE_EV3
@@ -83,6 +83,16 @@ uint32_t pbdrv_clock_get_us(void) {
     return pbdrv_clock_get_ms() * 1000 + t_us;
 }
 
+// The ARM9 core has no cycle counter, so this counts timer ticks at 24 MHz.
+uint32_t pbdrv_clock_get_cycles(void) {
+    uint32_t tim_val = TimerCounterGet(SOC_TMR_0_REGS, TMR_TIMER12);
+    return pbdrv_clock_get_ms() * (timer_ms_period + 1) + tim_val;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return timer_us_division;
+}
+
 uint32_t pbdrv_clock_get_ms(void) {
     return pbdrv_clock_ticks;
 }
@@ -103,6 +103,17 @@ uint32_t pbdrv_clock_get_100us(void) {
     return time_val.tv_sec * 10000 + time_val.tv_nsec / 100000;
 }
 
+// There is no portable cycle counter, so this counts nanoseconds.
+uint32_t pbdrv_clock_get_cycles(void) {
+    struct timespec time_val;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time_val);
+    return time_val.tv_sec * 1000000000 + time_val.tv_nsec;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1000;
+}
+
 uint32_t pbdrv_clock_get_us(void) {
     struct timespec time_val;
     clock_gettime(CLOCK_MONOTONIC_RAW, &time_val);
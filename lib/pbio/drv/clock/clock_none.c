@@ -14,6 +14,14 @@ uint32_t pbdrv_clock_get_us(void) {
     return 0;
 }
 
+uint32_t pbdrv_clock_get_cycles(void) {
+    return 0;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1;
+}
+
 uint32_t pbdrv_clock_get_ms(void) {
     return 0;
 }
@@ -61,14 +61,39 @@ uint32_t pbdrv_clock_get_ms(void) {
     return pbdrv_clock_ticks;
 }
 
+uint32_t pbdrv_clock_get_us(void) {
+    uint32_t state = nx_interrupts_disable();
+    uint32_t ms = pbdrv_clock_ticks;
+    // Reading PIIR does not acknowledge the interrupt.
+    uint32_t piir = *AT91C_PITC_PIIR;
+    nx_interrupts_enable(state);
+
+    // Account for a period that elapsed but was not yet handled.
+    ms += (piir & AT91C_PITC_PICNT) >> 20;
+    return ms * 1000 + (piir & AT91C_PITC_CPIV) / (PIT_BASE_FREQUENCY / 1000000);
+}
+
 uint32_t pbdrv_clock_get_100us(void) {
     // Revisit: derive from ns counter properly.
     return pbdrv_clock_ticks * 10;
 }
 
-uint32_t pbdrv_clock_get_us(void) {
-    // TODO
-    return pbdrv_clock_ticks * 1000;
+// The ARM7 core has no cycle counter. The PIT counts at 1/16 of the master
+// clock, so this counts master clock cycles in steps of 16.
+uint32_t pbdrv_clock_get_cycles(void) {
+    uint32_t state = nx_interrupts_disable();
+    uint32_t ms = pbdrv_clock_ticks;
+    // Reading PIIR does not acknowledge the interrupt.
+    uint32_t piir = *AT91C_PITC_PIIR;
+    nx_interrupts_enable(state);
+
+    // Account for a period that elapsed but was not yet handled.
+    ms += (piir & AT91C_PITC_PICNT) >> 20;
+    return (ms * (PIT_BASE_FREQUENCY / SYSIRQ_FREQ) + (piir & AT91C_PITC_CPIV)) * 16;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return NXT_CLOCK_FREQ / 1000000;
 }
 
 // TODO: we really should get rid of blocking waits if possible
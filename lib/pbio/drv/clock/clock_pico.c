@@ -29,6 +29,14 @@ uint32_t pbdrv_clock_get_us(void) {
     return time_us_32();
 }
 
+uint32_t pbdrv_clock_get_cycles(void) {
+    return time_us_32();
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1;
+}
+
 uint32_t pbdrv_clock_get_ms(void) {
     return us_to_ms(time_us_64());
 }
@@ -65,12 +65,96 @@ uint32_t pbdrv_clock_get_us(void) {
     return pbdrv_clock_get_time(1000);
 }
 
+#if __CORTEX_M >= 3
+
+uint32_t pbdrv_clock_get_cycles(void) {
+    // The cycle counter is only enabled on first use.
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+}
+
+#else // __CORTEX_M >= 3
+
+uint32_t pbdrv_clock_get_cycles(void) {
+    // Cortex-M0 has no cycle counter, but SysTick counts CPU cycles too.
+    return pbdrv_clock_get_time(SysTick->LOAD + 1);
+}
+
+#endif // __CORTEX_M >= 3
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return SystemCoreClock / 1000000;
+}
+
 void pbdrv_clock_busy_delay_us(uint32_t us) {
     uint32_t start = pbdrv_clock_get_us();
     while (pbdrv_clock_get_us() - start < us) {
     }
 }
 
+#if PBIO_CONFIG_OS_TICKLESS
+
+void pbdrv_clock_wait_for_interrupt_tickless(uint32_t duration) {
+
+    // Counts per tick.
+    uint32_t period = SysTick->LOAD + 1;
+
+    // Limit to what fits in the 24-bit counter.
+    uint32_t max_duration = (SysTick_LOAD_RELOAD_Msk + 1) / period;
+    if (duration > max_duration) {
+        duration = max_duration;
+    }
+
+    // Nothing to gain if the next tick is already due.
+    if (duration < 2 || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+        __WFI();
+        return;
+    }
+
+    // Stop the counter. It may have reached zero just before stopping.
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        __WFI();
+        return;
+    }
+
+    // Run one long tick made of the rest of the current tick plus the skipped
+    // ticks. The normal reload value takes effect when it expires.
+    SysTick->LOAD = SysTick->VAL + (duration - 1) * period;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = period - 1;
+
+    __WFI();
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t remaining = SysTick->VAL;
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || remaining == 0) {
+        // The long tick completed. The pending interrupt counts the last
+        // millisecond, so add the skipped ones before it.
+        pbdrv_clock_ticks += duration - 1;
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        return;
+    }
+
+    // Woken up early by another interrupt. Add the ticks that have passed and
+    // finish the current tick with a short one.
+    uint32_t ticks_ahead = (remaining - 1) / period;
+    pbdrv_clock_ticks += duration - 1 - ticks_ahead;
+    SysTick->LOAD = remaining - ticks_ahead * period - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = period - 1;
+}
+
+#endif // PBIO_CONFIG_OS_TICKLESS
+
 void SysTick_Handler(void) {
     pbdrv_clock_ticks++;
 
@@ -56,5 +56,13 @@ uint32_t pbdrv_clock_get_us(void) {
     return clock_ticks * 1000;
 }
 
+uint32_t pbdrv_clock_get_cycles(void) {
+    return pbdrv_clock_get_us();
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1;
+}
+
 
 #endif // PBDRV_CONFIG_CLOCK_TEST
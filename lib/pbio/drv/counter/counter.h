@@ -1,15 +1,39 @@
 // SPDX-License-Identifier: MIT
-// Copyright (c) 2019-2020 The Pybricks Authors
+// Copyright (c) 2019-2026 The Pybricks Authors
 
 #ifndef _INTERNAL_PBDRV_COUNTER_H_
 #define _INTERNAL_PBDRV_COUNTER_H_
 
+#include <stdint.h>
+
 #include <pbdrv/config.h>
+#include <pbio/error.h>
+
+/**
+ * Timing of the latest encoder edges, for estimating slow speeds. Each edge
+ * is one degree. This is updated from interrupt handlers.
+ */
+typedef struct {
+    /** Time of the newest edge in microseconds. */
+    uint32_t time;
+    /** Time of the edge before the newest edge in microseconds. */
+    uint32_t time_prev;
+    /** Time between the newest edge and two edges before it in microseconds. */
+    uint32_t interval;
+    /** Direction of the newest edge, 1 or -1. */
+    int8_t direction;
+    /** Number of consecutive edges in the same direction, up to 3. */
+    uint8_t count;
+} pbdrv_counter_edge_t;
 
 #if PBDRV_CONFIG_COUNTER
 
 void pbdrv_counter_init(void);
 
+void pbdrv_counter_edge_update(volatile pbdrv_counter_edge_t *edge, int8_t direction);
+
+pbio_error_t pbdrv_counter_edge_get_speed(const volatile pbdrv_counter_edge_t *edge, int32_t *speed);
+
 #else // PBDRV_CONFIG_COUNTER
 
 #define pbdrv_counter_init()
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Speed estimates from the time between encoder edges.
+//
+// At low speeds, only a few edges fall in the window of the angle
+// differentiator, so its speed estimate is coarse and lags behind. Timing the
+// edges gives a smooth estimate in that range instead.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_COUNTER
+
+#include <stdint.h>
+
+#include <pbdrv/clock.h>
+
+#include "counter.h"
+
+// Speed of one degree per microsecond, in millidegrees per second.
+#define MDEG_PER_S_AT_ONE_EDGE_PER_US (1000000000)
+
+// Without edges for this long, the motor is considered stopped. This matches
+// the window of the angle differentiator.
+#define PBDRV_COUNTER_EDGE_TIMEOUT_US (100000)
+
+/**
+ * Records an encoder edge. This is called from interrupt handlers.
+ *
+ * @param [in]  edge        The edge timing.
+ * @param [in]  direction   Direction of the edge, 1 or -1.
+ */
+void pbdrv_counter_edge_update(volatile pbdrv_counter_edge_t *edge, int8_t direction) {
+    uint32_t now = pbdrv_clock_get_us();
+
+    // Intervals across a change of direction don't give a speed.
+    if (direction != edge->direction) {
+        edge->direction = direction;
+        edge->count = 0;
+    }
+
+    edge->interval = now - edge->time_prev;
+    edge->time_prev = edge->time;
+    edge->time = now;
+    if (edge->count < 3) {
+        edge->count++;
+    }
+}
+
+/**
+ * Gets the speed from the time between the latest encoder edges.
+ *
+ * @param [in]  edge        The edge timing.
+ * @param [out] speed       Speed in millidegrees per second.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_AGAIN if the motor just started
+ *                          moving or changed direction, so there is no
+ *                          estimate yet.
+ */
+pbio_error_t pbdrv_counter_edge_get_speed(const volatile pbdrv_counter_edge_t *edge, int32_t *speed) {
+
+    // Copy the timing, starting over if an edge comes in while copying.
+    pbdrv_counter_edge_t copy;
+    uint32_t time;
+    do {
+        time = edge->time;
+        copy = *edge;
+    } while (time != edge->time);
+
+    // No recent edges, so the motor is stopped.
+    uint32_t elapsed = pbdrv_clock_get_us() - copy.time;
+    if (copy.count == 0 || elapsed > PBDRV_COUNTER_EDGE_TIMEOUT_US) {
+        *speed = 0;
+        return PBIO_SUCCESS;
+    }
+
+    if (copy.count < 3 || copy.interval == 0) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    // The interval spans two edges, which is one full period of the encoder
+    // signal. This cancels out its duty cycle, which isn't exactly 50%.
+    uint32_t speed_abs = 2 * (uint32_t)MDEG_PER_S_AT_ONE_EDGE_PER_US / copy.interval;
+
+    // If the next edge is overdue, the motor has slowed down since then.
+    if (elapsed > 0 && MDEG_PER_S_AT_ONE_EDGE_PER_US / elapsed < speed_abs) {
+        speed_abs = MDEG_PER_S_AT_ONE_EDGE_PER_US / elapsed;
+    }
+
+    *speed = copy.direction * (int32_t)speed_abs;
+    return PBIO_SUCCESS;
+}
+
+#endif // PBDRV_CONFIG_COUNTER
@@ -13,6 +13,7 @@
 #include <stdint.h>
 
 #include "../gpio/gpio_ev3.h"
+#include "counter.h"
 
 #include <lego/device.h>
 
@@ -44,6 +45,10 @@ struct _pbdrv_counter_dev_t {
      * Position of the motor in degrees.
      */
     int32_t position;
+    /**
+     * Timing of the latest encoder edges.
+     */
+    volatile pbdrv_counter_edge_t edge;
     /**
      * Quadrature int pin.
      */
@@ -245,6 +250,23 @@ pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *mill
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+pbio_error_t pbdrv_counter_get_edge_speed(pbdrv_counter_dev_t *dev, int32_t *speed) {
+    return pbdrv_counter_edge_get_speed(&dev->edge, speed);
+}
+
+/**
+ * Reads a pin that was already configured as input on init.
+ *
+ * Unlike pbdrv_gpio_input, this doesn't set the pin mux and direction each
+ * time, which matters since this runs on every encoder edge. For pins on
+ * banks 0 and 1, setting the direction may even wait for the PRU.
+ */
+static inline bool pbdrv_counter_ev3_read_pin(const pbdrv_gpio_t *gpio) {
+    pbdrv_gpio_ev3_mux_t *mux = gpio->bank;
+    uint32_t shift = (mux->gpio_bank_id * 16 + gpio->pin) % 32;
+    return (HWREG(SOC_GPIO_0_REGS + GPIO_IN_DATA(mux->gpio_bank_id / 2)) >> shift) & 1;
+}
+
 static void pbdrv_counter_ev3_irq_handler(uint32_t bank_id, uint32_t bank_int_id) {
     GPIOBankIntDisable(SOC_GPIO_0_REGS, bank_id);
     uint32_t status = HWREG(SOC_GPIO_0_REGS + GPIO_INTSTAT((bank_id / 2)));
@@ -262,10 +284,12 @@ static void pbdrv_counter_ev3_irq_handler(uint32_t bank_id, uint32_t bank_int_id
 
         // Clear the interrupt and update the position.
         HWREG(SOC_GPIO_0_REGS + GPIO_INTSTAT((bank_id / 2))) = mask;
-        if (pbdrv_gpio_input(&dev->gpio_int) ^ pbdrv_gpio_input(&dev->gpio_dir)) {
+        if (pbdrv_counter_ev3_read_pin(&dev->gpio_int) ^ pbdrv_counter_ev3_read_pin(&dev->gpio_dir)) {
             dev->position++;
+            pbdrv_counter_edge_update(&dev->edge, 1);
         } else {
             dev->position--;
+            pbdrv_counter_edge_update(&dev->edge, -1);
         }
     }
 
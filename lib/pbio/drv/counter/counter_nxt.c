@@ -25,8 +25,11 @@
 
 #include <nxos/drivers/motors.h>
 
+#include "counter.h"
+
 struct _pbdrv_counter_dev_t {
     uint8_t index;
+    volatile pbdrv_counter_edge_t edge;
 };
 
 static pbdrv_counter_dev_t counters[PBDRV_CONFIG_COUNTER_NUM_DEV];
@@ -64,6 +67,16 @@ pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *mill
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+pbio_error_t pbdrv_counter_get_edge_speed(pbdrv_counter_dev_t *dev, int32_t *speed) {
+    return pbdrv_counter_edge_get_speed(&dev->edge, speed);
+}
+
+void nx_motors_tach_edge_hook(uint8_t motor, int8_t direction) {
+    if (motor < PBIO_ARRAY_SIZE(counters)) {
+        pbdrv_counter_edge_update(&counters[motor].edge, direction);
+    }
+}
+
 void pbdrv_counter_init(void) {
     for (size_t i = 0; i < PBIO_ARRAY_SIZE(counters); i++) {
         pbdrv_counter_dev_t *dev = &counters[i];
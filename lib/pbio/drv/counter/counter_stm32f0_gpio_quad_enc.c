@@ -28,6 +28,7 @@
 
 struct _pbdrv_counter_dev_t {
     int32_t count;
+    volatile pbdrv_counter_edge_t edge;
     const pbdrv_counter_stm32f0_gpio_quad_enc_platform_data_t *pdata;
 };
 
@@ -59,11 +60,25 @@ pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *mill
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+pbio_error_t pbdrv_counter_get_edge_speed(pbdrv_counter_dev_t *dev, int32_t *speed) {
+    return pbdrv_counter_edge_get_speed(&dev->edge, speed);
+}
+
+// Reads a pin that was already configured as input. Unlike pbdrv_gpio_input,
+// this doesn't write the mode register, which matters since this runs on
+// every encoder edge. It also can't race with code that changes the mode of
+// other pins on the same bank.
+static inline bool pbdrv_counter_read_pin(const pbdrv_gpio_t *gpio) {
+    return (((GPIO_TypeDef *)gpio->bank)->IDR >> gpio->pin) & 1;
+}
+
 static void pbdrv_counter_update_count(pbdrv_counter_dev_t *dev, bool int_pin_state, bool dir_pin_state) {
     if (int_pin_state ^ dir_pin_state) {
         dev->count--;
+        pbdrv_counter_edge_update(&dev->edge, -1);
     } else {
         dev->count++;
+        pbdrv_counter_edge_update(&dev->edge, 1);
     }
 }
 
@@ -77,13 +92,13 @@ void EXTI0_1_IRQHandler(void) {
     // Port A - inverted.
     if (exti_pr & EXTI_PR_PR1) {
         pbdrv_counter_dev_t *dev = &counters[0];
-        pbdrv_counter_update_count(dev, pbdrv_gpio_input(&dev->pdata->gpio_int), !pbdrv_gpio_input(&dev->pdata->gpio_dir));
+        pbdrv_counter_update_count(dev, pbdrv_counter_read_pin(&dev->pdata->gpio_int), !pbdrv_counter_read_pin(&dev->pdata->gpio_dir));
     }
 
     // Port B
     if (exti_pr & EXTI_PR_PR0) {
         pbdrv_counter_dev_t *dev = &counters[1];
-        pbdrv_counter_update_count(dev, pbdrv_gpio_input(&dev->pdata->gpio_int), pbdrv_gpio_input(&dev->pdata->gpio_dir));
+        pbdrv_counter_update_count(dev, pbdrv_counter_read_pin(&dev->pdata->gpio_int), pbdrv_counter_read_pin(&dev->pdata->gpio_dir));
     }
 }
 
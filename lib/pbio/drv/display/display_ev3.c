@@ -33,6 +33,7 @@
 #include <tiam1808/armv5/am1808/interrupt.h>
 
 #include "../drv/gpio/gpio_ev3.h"
+#include "display_st7586s.h"
 #include <tiam1808/hw/hw_syscfg0_AM1808.h>
 
 /* ST7586 Commands */
@@ -123,13 +124,13 @@ static volatile spi_status_t spi_status = SPI_STATUS_ERROR;
  */
 #define ST7586S_NUM_ROWS (PBDRV_CONFIG_DISPLAY_NUM_ROWS)
 
-/**
- * Maximum pixel value.
- */
-#define ST7586S_VALUE_MAX 3
+#if ST7586S_NUM_COL_TRIPLETS % 4
+#error "Packed user frame rows must be a whole number of triplet groups."
+#endif
 
 /**
- * User frame buffer. Each value is one pixel with value:
+ * User frame buffer. Each pixel uses two bits, four pixels per byte with the
+ * first pixel in the most significant bits, with value:
  *
  *  0: Empty / White
  *  1: Light Grey
@@ -138,7 +139,21 @@ static volatile spi_status_t spi_status = SPI_STATUS_ERROR;
  *
  * Non-atomic updated by the application are allowed.
  */
-static uint8_t pbdrv_display_user_frame[PBDRV_CONFIG_DISPLAY_NUM_ROWS][ST7586S_NUM_COL_TRIPLETS * 3] __attribute__((section(".noinit"), used));
+static uint8_t pbdrv_display_user_frame[PBDRV_CONFIG_DISPLAY_NUM_ROWS][ST7586S_NUM_COL_TRIPLETS * 3 / 4] __attribute__((section(".noinit"), used));
+
+#if PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+/**
+ * Copy of the user frame buffer made by pbdrv_display_swap(). While double
+ * buffering, this is what is shown, so the application can keep drawing in
+ * the user frame without showing partial frames.
+ */
+static uint8_t pbdrv_display_front_frame[PBDRV_CONFIG_DISPLAY_NUM_ROWS][ST7586S_NUM_COL_TRIPLETS * 3 / 4] __attribute__((section(".noinit"), used));
+
+/**
+ * Whether double buffering is enabled.
+ */
+static bool pbdrv_display_double_buffered;
+#endif // PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
 
 /**
  * Flag to indicate that the user frame has been updated and needs to be
@@ -171,40 +186,35 @@ static bool pbdrv_display_user_frame_update_requested;
 static uint8_t st7586s_send_buf[ST7586S_NUM_COL_TRIPLETS * ST7586S_NUM_ROWS] __attribute__((section(".noinit"), used));
 
 /**
- * Encode a triplet of pixels into a single byte in the format descrived above.
- *
- * @param p0 First pixel.
- * @param p1 Second pixel.
- * @param p2 Third pixel.
- *
- * @return Encoded triplet.
+ * Changed part of the display buffer packed contiguously, for sending windows
+ * that are narrower than the display.
  */
-static uint8_t encode_triplet(uint8_t p0, uint8_t p1, uint8_t p2) {
-    // As described above, the first two pixels are the normal binary
-    // representation shifted left by one, with an extra bit set for black.
-    // The third pixel is not shifted, so contains just two bits.
-    p0 = p0 >= ST7586S_VALUE_MAX ? 0b111 : (p0 << 1);
-    p1 = p1 >= ST7586S_VALUE_MAX ? 0b111 : (p1 << 1);
-    p2 = p2 >= ST7586S_VALUE_MAX ? 0b11 : p2;
-
-    // Three pixels are then concatenated to one byte.
-    return p0 << 5 | p1 << 2 | p2;
-}
+static uint8_t st7586s_window_buf[ST7586S_NUM_COL_TRIPLETS * ST7586S_NUM_ROWS] __attribute__((section(".noinit"), used));
 
 /**
- * Encode the user frame buffer into the display buffer.
+ * The display shows something other than the display buffer, such as after
+ * boot, so the next update must send the whole frame.
  */
-void pbdrv_display_st7586s_encode_user_frame(void) {
-    // Iterating over display rows (and ST7586S rows are the same).
-    for (size_t row = 0; row < PBDRV_CONFIG_DISPLAY_NUM_ROWS; row++) {
-        // Iterating ST7586S column-triplets, which are 3 columns each.
-        for (size_t triplet = 0; triplet < ST7586S_NUM_COL_TRIPLETS; triplet++) {
-            uint8_t p0 = pbdrv_display_user_frame[row][triplet * 3];
-            uint8_t p1 = pbdrv_display_user_frame[row][triplet * 3 + 1];
-            uint8_t p2 = pbdrv_display_user_frame[row][triplet * 3 + 2];
-            st7586s_send_buf[row * ST7586S_NUM_COL_TRIPLETS + triplet] = encode_triplet(p0, p1, p2);
-        }
+static bool st7586s_full_update_required;
+
+/**
+ * Encode the user frame buffer into the display buffer and find the window
+ * that changed since the previous frame.
+ *
+ * @param [out] window  The window that changed.
+ * @return              Whether anything changed.
+ */
+static bool pbdrv_display_ev3_encode_user_frame(pbdrv_display_st7586s_window_t *window) {
+    const uint8_t *frame = &pbdrv_display_user_frame[0][0];
+    #if PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+    if (pbdrv_display_double_buffered) {
+        frame = &pbdrv_display_front_frame[0][0];
     }
+    #endif
+    bool changed = pbdrv_display_st7586s_encode(frame, sizeof(pbdrv_display_user_frame[0]),
+        st7586s_send_buf, ST7586S_NUM_ROWS, ST7586S_NUM_COL_TRIPLETS, st7586s_full_update_required, window);
+    st7586s_full_update_required = false;
+    return changed;
 }
 
 /**
@@ -261,25 +271,8 @@ static const pbdrv_display_st7586s_action_t init_script[] = {
     { ST7586S_ACTION_WRITE_COMMAND, ST7586_DISPON},
     { ST7586S_ACTION_DELAY, 100},
     #endif // ST7586S_DO_RESET_AND_INIT
-    { ST7586S_ACTION_WRITE_COMMAND, ST7586_CASET},
-    { ST7586S_ACTION_WRITE_DATA, 0x00},
-    { ST7586S_ACTION_WRITE_DATA, 0x00},
-    { ST7586S_ACTION_WRITE_DATA, 0x00},
-    // This differs from the official firmware and ev3dev, which use 0x7f and
-    // reset it to the value below on every new frame.
-    { ST7586S_ACTION_WRITE_DATA, ST7586S_NUM_COL_TRIPLETS - 1},
-    { ST7586S_ACTION_WRITE_COMMAND, ST7586_RASET},
-    { ST7586S_ACTION_WRITE_DATA, 0x00},
-    { ST7586S_ACTION_WRITE_DATA, 0x00},
-    { ST7586S_ACTION_WRITE_DATA, 0x00},
-    // This differs from the official firmware and ev3dev, which use 0x9f and
-    // reset it to the value below on every new frame.
-    { ST7586S_ACTION_WRITE_DATA, ST7586S_NUM_ROWS - 1},
+    // The address window is set for each frame, to send only what changed.
     { ST7586S_ACTION_WRITE_COMMAND, ST7586_DSPGRAY},
-    // This differs from the official firmware and ev3dev, which write this on
-    // every frame. By enteringthis mode right away we can keep sending new
-    // frame data without switching back to command mode.
-    { ST7586S_ACTION_WRITE_COMMAND, ST7586_RAMWR},
 };
 
 /**
@@ -349,6 +342,79 @@ void pbdrv_display_st7586s_write_data_begin(uint8_t *data, uint32_t size) {
     SPIIntEnable(SOC_SPI_1_REGS, SPI_DMA_REQUEST_ENA_INT);
 }
 
+/**
+ * Sends a command or data to the display and waits for completion.
+ *
+ * @param [in] state    Protothread state.
+ * @param [in] command  Whether to send a command instead of data.
+ * @param [in] data     Data to write.
+ * @param [in] size     Size of the data.
+ * @return              ::PBIO_ERROR_AGAIN while sending, then ::PBIO_SUCCESS.
+ */
+static pbio_error_t pbdrv_display_st7586s_write(pbio_os_state_t *state, bool command, uint8_t *data, uint32_t size) {
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    if (command) {
+        pbdrv_gpio_out_low(&pin_lcd_a0);
+    } else {
+        pbdrv_gpio_out_high(&pin_lcd_a0);
+    }
+    pbdrv_display_st7586s_write_data_begin(data, size);
+    PBIO_OS_AWAIT_UNTIL(state, spi_status == SPI_STATUS_COMPLETE);
+    pbdrv_gpio_out_high(&pin_lcd_cs);
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Sends the changed window of the display buffer to the display.
+ *
+ * @param [in] state    Protothread state.
+ * @param [in] window   The window to send.
+ * @return              ::PBIO_ERROR_AGAIN while sending, then ::PBIO_SUCCESS.
+ */
+static pbio_error_t pbdrv_display_st7586s_send_window(pbio_os_state_t *state, const pbdrv_display_st7586s_window_t *window) {
+
+    static pbio_os_state_t sub;
+    static uint8_t command;
+    static uint8_t address[4];
+    static uint8_t *data;
+    static uint32_t size;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Set the column and row address window. This also ends the previous
+    // memory write, which is started again below.
+    command = ST7586_CASET;
+    PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, true, &command, 1));
+    address[1] = window->triplet_start;
+    address[3] = window->triplet_end;
+    PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, false, address, sizeof(address)));
+    command = ST7586_RASET;
+    PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, true, &command, 1));
+    address[1] = window->row_start;
+    address[3] = window->row_end;
+    PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, false, address, sizeof(address)));
+    command = ST7586_RAMWR;
+    PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, true, &command, 1));
+
+    // Full rows are already contiguous in the display buffer. Otherwise, pack
+    // the window rows together.
+    uint32_t width = window->triplet_end - window->triplet_start + 1;
+    uint32_t height = window->row_end - window->row_start + 1;
+    data = &st7586s_send_buf[window->row_start * ST7586S_NUM_COL_TRIPLETS];
+    if (width != ST7586S_NUM_COL_TRIPLETS) {
+        for (uint32_t i = 0; i < height; i++) {
+            memcpy(&st7586s_window_buf[i * width], &data[i * ST7586S_NUM_COL_TRIPLETS + window->triplet_start], width);
+        }
+        data = st7586s_window_buf;
+    }
+    size = width * height;
+    PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, false, data, size));
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 /**
  * Initialize the display SPI driver.
  *
@@ -397,8 +463,10 @@ static pbio_os_process_t pbdrv_display_ev3_process;
 static pbio_error_t pbdrv_display_ev3_process_thread(pbio_os_state_t *state, void *context) {
 
     static pbio_os_timer_t timer;
+    static pbio_os_state_t sub;
     static uint32_t script_index;
     static uint8_t payload;
+    static pbdrv_display_st7586s_window_t window;
 
     PBIO_OS_ASYNC_BEGIN(state);
 
@@ -420,35 +488,25 @@ static pbio_error_t pbdrv_display_ev3_process_thread(pbio_os_state_t *state, voi
         } else {
             // Send command or data.
             payload = action->payload;
-            if (action->type == ST7586S_ACTION_WRITE_DATA) {
-                pbdrv_gpio_out_high(&pin_lcd_a0);
-            } else {
-                pbdrv_gpio_out_low(&pin_lcd_a0);
-            }
-            pbdrv_display_st7586s_write_data_begin(&payload, sizeof(payload));
-            PBIO_OS_AWAIT_UNTIL(state, spi_status == SPI_STATUS_COMPLETE);
-            pbdrv_gpio_out_high(&pin_lcd_cs);
+            PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_write(&sub, action->type == ST7586S_ACTION_WRITE_COMMAND, &payload, sizeof(payload)));
         }
     }
 
-    // Staying in data mode from here.
-    pbdrv_gpio_out_high(&pin_lcd_a0);
-
     // Clear display to start with.
     memset(&pbdrv_display_user_frame, 0, sizeof(pbdrv_display_user_frame));
     pbdrv_display_user_frame_update_requested = true;
+    st7586s_full_update_required = true;
 
     // Done initializing.
     pbio_busy_count_down();
 
-    // Update the display with the user frame buffer, if changed.
+    // Update the display with the part of the user frame buffer that changed.
     for (;;) {
         PBIO_OS_AWAIT_UNTIL(state, pbdrv_display_user_frame_update_requested);
         pbdrv_display_user_frame_update_requested = false;
-        pbdrv_display_st7586s_encode_user_frame();
-        pbdrv_display_st7586s_write_data_begin(st7586s_send_buf, sizeof(st7586s_send_buf));
-        PBIO_OS_AWAIT_UNTIL(state, spi_status == SPI_STATUS_COMPLETE);
-        pbdrv_gpio_out_high(&pin_lcd_cs);
+        if (pbdrv_display_ev3_encode_user_frame(&window)) {
+            PBIO_OS_AWAIT(state, &sub, pbdrv_display_st7586s_send_window(&sub, &window));
+        }
     }
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
@@ -467,11 +525,11 @@ void pbdrv_display_init(void) {
     pbdrv_display_ev3_spi_init();
 
     // Initialize image.
-    pbio_image_init(&display_image, (uint8_t *)pbdrv_display_user_frame,
+    pbio_image_init_format(&display_image, (uint8_t *)pbdrv_display_user_frame,
         PBDRV_CONFIG_DISPLAY_NUM_COLS, PBDRV_CONFIG_DISPLAY_NUM_ROWS,
-        ST7586S_NUM_COL_TRIPLETS * 3);
+        sizeof(pbdrv_display_user_frame[0]), PBIO_IMAGE_FORMAT_2BPP);
     display_image.print_font = &pbio_font_terminus_normal_16;
-    display_image.print_value = ST7586S_VALUE_MAX;
+    display_image.print_value = PBDRV_DISPLAY_ST7586S_VALUE_MAX;
 
     // Start display process and ask pbdrv to wait until it is initialized.
     pbio_busy_count_up();
@@ -483,7 +541,7 @@ pbio_image_t *pbdrv_display_get_image(void) {
 }
 
 uint8_t pbdrv_display_get_max_value(void) {
-    return ST7586S_VALUE_MAX;
+    return PBDRV_DISPLAY_ST7586S_VALUE_MAX;
 }
 
 uint8_t pbdrv_display_get_value_from_hsv(uint16_t h, uint8_t s, uint8_t v) {
@@ -515,10 +573,38 @@ uint8_t pbdrv_display_get_value_from_hsv(uint16_t h, uint8_t s, uint8_t v) {
 }
 
 void pbdrv_display_update(void) {
+    #if PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+    // Only swapping shows new frames.
+    if (pbdrv_display_double_buffered) {
+        return;
+    }
+    #endif
     pbdrv_display_user_frame_update_requested = true;
     pbio_os_request_poll();
 }
 
+#if PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+
+void pbdrv_display_set_double_buffered(bool enable) {
+    if (pbdrv_display_double_buffered == enable) {
+        return;
+    }
+    pbdrv_display_double_buffered = enable;
+
+    // Show what is in the user frame now, unless this should wait for a swap.
+    if (!enable) {
+        pbdrv_display_update();
+    }
+}
+
+void pbdrv_display_swap(void) {
+    memcpy(pbdrv_display_front_frame, pbdrv_display_user_frame, sizeof(pbdrv_display_front_frame));
+    pbdrv_display_user_frame_update_requested = true;
+    pbio_os_request_poll();
+}
+
+#endif // PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+
 void pbdrv_display_deinit(void) {
 }
 
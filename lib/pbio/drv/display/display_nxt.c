@@ -91,12 +91,13 @@ static spi_mode_t spi_mode;
 static volatile spi_state_t spi_state;
 
 /*
- * User frame buffer. Each value is one pixel with value:
+ * User frame buffer. Each pixel uses one bit, eight pixels per byte with the
+ * first pixel in the most significant bit, with value:
  *
  *  0: Empty / White
  *  1: Black
  */
-static uint8_t pbdrv_display_user_frame[PBDRV_CONFIG_DISPLAY_NUM_ROWS][PBDRV_CONFIG_DISPLAY_NUM_COLS]
+static uint8_t pbdrv_display_user_frame[PBDRV_CONFIG_DISPLAY_NUM_ROWS][(PBDRV_CONFIG_DISPLAY_NUM_COLS + 7) / 8]
 __attribute__((section(".noinit")));
 
 /*
@@ -106,13 +107,28 @@ __attribute__((section(".noinit")));
 static bool pbdrv_display_user_frame_update_requested;
 
 /*
- * Buffer to send one page of pixels to the display, using its internal
- * format. Every byte describes a column of 8 pixels, where the least
- * significant bit is used for the top pixel and the most significant bit is
- * used for the bottom pixel. If 1, the pixel is lit, or black. If 0, the
- * pixel is not lit, or white.
+ * Pages of pixels as last sent to the display, using its internal format.
+ * Every byte describes a column of 8 pixels, where the least significant bit
+ * is used for the top pixel and the most significant bit is used for the
+ * bottom pixel. If 1, the pixel is lit, or black. If 0, the pixel is not lit,
+ * or white.
+ *
+ * A page is only sent again if it changed, and it stays unchanged while the
+ * transfer is in progress.
  */
-static uint8_t pbdrv_display_send_buffer[PBDRV_CONFIG_DISPLAY_NUM_COLS];
+static uint8_t pbdrv_display_send_buffer[PBDRV_CONFIG_DISPLAY_NUM_ROWS / 8][PBDRV_CONFIG_DISPLAY_NUM_COLS];
+
+/*
+ * Buffer to convert one page of the user frame into, to compare it against
+ * the page that was last sent.
+ */
+static uint8_t pbdrv_display_page_buffer[PBDRV_CONFIG_DISPLAY_NUM_COLS];
+
+/*
+ * Flag to indicate that all pages must be sent, because the display contents
+ * are not known.
+ */
+static bool pbdrv_display_send_all_pages;
 
 /*
  * Switch to command transmission mode and send a command byte to the LCD controller.
@@ -223,16 +239,36 @@ static void spi_init(void) {
     nx_interrupts_enable(state);
 }
 
-void pbdrv_display_nxt_convert_page(int page) {
-    int x, y;
-    for (x = 0; x < PBDRV_CONFIG_DISPLAY_NUM_COLS; x++) {
-        uint8_t b = 0;
-        for (y = 0; y < 8; y++) {
-            if (pbdrv_display_user_frame[page * 8 + y][x]) {
-                b |= 1 << y;
-            }
-        }
-        pbdrv_display_send_buffer[x] = b;
+/*
+ * Converts one page of the user frame to the display format, eight columns at
+ * a time by transposing a block of 8x8 pixels.
+ */
+static void pbdrv_display_nxt_convert_page(int page, uint8_t *buffer) {
+    const uint8_t (*rows)[sizeof(pbdrv_display_user_frame[0])] = &pbdrv_display_user_frame[page * 8];
+
+    for (size_t i = 0; i < sizeof(pbdrv_display_user_frame[0]); i++) {
+        // Bottom rows in the first word, so the top row ends up in the least
+        // significant bit of each column.
+        uint32_t x = rows[7][i] << 24 | rows[6][i] << 16 | rows[5][i] << 8 | rows[4][i];
+        uint32_t y = rows[3][i] << 24 | rows[2][i] << 16 | rows[1][i] << 8 | rows[0][i];
+        uint32_t t;
+
+        // Swap bits in 2x2, then 4x4 blocks, then 8x8 blocks.
+        t = (x ^ (x >> 7)) & 0x00AA00AA;
+        x = x ^ t ^ (t << 7);
+        t = (y ^ (y >> 7)) & 0x00AA00AA;
+        y = y ^ t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC;
+        x = x ^ t ^ (t << 14);
+        t = (y ^ (y >> 14)) & 0x0000CCCC;
+        y = y ^ t ^ (t << 14);
+        t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+        y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+        x = t;
+
+        uint8_t columns[8] = { x >> 24, x >> 16, x >> 8, x, y >> 24, y >> 16, y >> 8, y };
+        size_t count = PBDRV_CONFIG_DISPLAY_NUM_COLS - i * 8;
+        memcpy(&buffer[i * 8], columns, count < 8 ? count : 8);
     }
 }
 
@@ -315,9 +351,7 @@ static pbio_error_t pbdrv_display_nxt_process_thread(pbio_os_state_t *state, voi
     // Clear display to start with.
     memset(&pbdrv_display_user_frame, 0, sizeof(pbdrv_display_user_frame));
     pbdrv_display_user_frame_update_requested = true;
-
-    // Make sure that we are in data TX mode.
-    PBIO_OS_AWAIT(state, &sub, spi_set_data_mode(&sub));
+    pbdrv_display_send_all_pages = true;
 
     // Done initializing.
     pbio_busy_count_down();
@@ -327,27 +361,30 @@ static pbio_error_t pbdrv_display_nxt_process_thread(pbio_os_state_t *state, voi
         PBIO_OS_AWAIT_UNTIL(state, pbdrv_display_user_frame_update_requested);
         pbdrv_display_user_frame_update_requested = false;
         for (page = 0; page < PBDRV_CONFIG_DISPLAY_NUM_ROWS / 8; page++) {
-            // Convert pixel format.
-            pbdrv_display_nxt_convert_page(page);
-            // We are at the start of a page, so we need to send 100 bytes of
-            // pixel data to display.
+            // Convert pixel format and skip pages that did not change.
+            pbdrv_display_nxt_convert_page(page, pbdrv_display_page_buffer);
+            if (!pbdrv_display_send_all_pages &&
+                !memcmp(pbdrv_display_send_buffer[page], pbdrv_display_page_buffer, sizeof(pbdrv_display_page_buffer))) {
+                continue;
+            }
+            memcpy(pbdrv_display_send_buffer[page], pbdrv_display_page_buffer, sizeof(pbdrv_display_page_buffer));
+
+            // Move the cursor to the start of the page. This way we only
+            // send the 100 bytes of displayable data, and not the 32
+            // off-screen bytes needed to wrap around to the next page.
+            PBIO_OS_AWAIT(state, &sub, spi_write_command_byte(&sub, SET_PAGE_ADDR(page)));
+            PBIO_OS_AWAIT(state, &sub, spi_write_command_byte(&sub, SET_COLUMN_ADDR0(0)));
+            PBIO_OS_AWAIT(state, &sub, spi_write_command_byte(&sub, SET_COLUMN_ADDR1(0)));
+            PBIO_OS_AWAIT(state, &sub, spi_set_data_mode(&sub));
+
+            // Send the page, which is done in the background by the PDC.
             spi_state = SPI_STATE_WAIT;
-            *AT91C_SPI_TNPR = (uint32_t)pbdrv_display_send_buffer;
+            *AT91C_SPI_TNPR = (uint32_t)pbdrv_display_send_buffer[page];
             *AT91C_SPI_TNCR = PBDRV_CONFIG_DISPLAY_NUM_COLS;
             *AT91C_SPI_IER = AT91C_SPI_ENDTX;
             PBIO_OS_AWAIT_UNTIL(state, spi_state == SPI_STATE_COMPLETE);
-            // 100 bytes of displayable data have been transferred. We now
-            // have to send 32 more bytes to get to the end of the page and
-            // wrap around.
-            //
-            // Given that this data is off-screen, we just resend the first 32
-            // bytes of the 100 we just transferred.
-            spi_state = SPI_STATE_WAIT;
-            *AT91C_SPI_TNPR = (uint32_t)pbdrv_display_send_buffer;
-            *AT91C_SPI_TNCR = 132 - PBDRV_CONFIG_DISPLAY_NUM_COLS;
-            *AT91C_SPI_IER = AT91C_SPI_ENDTX;
-            PBIO_OS_AWAIT_UNTIL(state, spi_state == SPI_STATE_COMPLETE);
         }
+        pbdrv_display_send_all_pages = false;
     }
 
     // When power to the controller goes out, there is the risk that
@@ -371,9 +408,9 @@ static pbio_image_t pbdrv_display_image;
 
 void pbdrv_display_init(void) {
     // Initialize image.
-    pbio_image_init(&pbdrv_display_image, (uint8_t *)pbdrv_display_user_frame,
+    pbio_image_init_format(&pbdrv_display_image, (uint8_t *)pbdrv_display_user_frame,
         PBDRV_CONFIG_DISPLAY_NUM_COLS, PBDRV_CONFIG_DISPLAY_NUM_ROWS,
-        PBDRV_CONFIG_DISPLAY_NUM_COLS);
+        sizeof(pbdrv_display_user_frame[0]), PBIO_IMAGE_FORMAT_1BPP);
     pbdrv_display_image.print_font = &pbio_font_mono_8x5_8;
     pbdrv_display_image.print_value = 1;
 
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+//
+// Pixel encoding for the ST7586S display controller, kept separate from the
+// EV3 SPI driver so it can be tested and benchmarked on the host.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_DISPLAY_ST7586S
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "display_st7586s.h"
+
+/**
+ * Encodes one pixel as the first or second pixel of a triplet. This is the
+ * normal binary representation shifted left by one, with an extra bit set
+ * for black.
+ */
+#define ENCODE_PIXEL(p) ((p) >= PBDRV_DISPLAY_ST7586S_VALUE_MAX ? 0b111 : (p) << 1)
+
+/**
+ * Encodes a triplet of pixels into one byte:
+ *
+ *     (MSB) | A B C | A B C | A B | (LSB)
+ *
+ * The third pixel is not shifted, so contains just two bits.
+ */
+#define ENCODE_TRIPLET(p0, p1, p2) (ENCODE_PIXEL(p0) << 5 | ENCODE_PIXEL(p1) << 2 | ((p2) >= PBDRV_DISPLAY_ST7586S_VALUE_MAX ? 0b11 : (p2)))
+
+#define ENCODE_ROW(p0, p1) \
+    ENCODE_TRIPLET(p0, p1, 0), ENCODE_TRIPLET(p0, p1, 1), ENCODE_TRIPLET(p0, p1, 2), ENCODE_TRIPLET(p0, p1, 3)
+#define ENCODE_BLOCK(p0) \
+    ENCODE_ROW(p0, 0), ENCODE_ROW(p0, 1), ENCODE_ROW(p0, 2), ENCODE_ROW(p0, 3)
+
+/**
+ * Encoded triplets for all valid pixel values, indexed by p0 << 4 | p1 << 2 | p2.
+ */
+static const uint8_t triplet_table[64] = {
+    ENCODE_BLOCK(0), ENCODE_BLOCK(1), ENCODE_BLOCK(2), ENCODE_BLOCK(3),
+};
+
+/**
+ * Encodes a frame of pixels into the display format, and finds the window
+ * that changed compared to the previously encoded frame.
+ *
+ * @param [in]    frame         Pixels packed four per byte, first pixel in
+ *                              the most significant bits, with values 0
+ *                              (white) to ::PBDRV_DISPLAY_ST7586S_VALUE_MAX
+ *                              (black).
+ * @param [in]    frame_stride  Number of bytes per row in @p frame.
+ * @param [inout] encoded       Previously encoded frame, which is updated.
+ * @param [in]    num_rows      Number of rows.
+ * @param [in]    num_triplets  Number of column triplets per row. Must be a
+ *                              multiple of 4, so that each row is a whole
+ *                              number of 3-byte groups in @p frame.
+ * @param [in]    full          Whether to treat everything as changed.
+ * @param [out]   window        The window that changed.
+ * @return                      Whether anything changed.
+ */
+bool pbdrv_display_st7586s_encode(const uint8_t *frame, uint32_t frame_stride,
+    uint8_t *encoded, uint32_t num_rows, uint32_t num_triplets,
+    bool full, pbdrv_display_st7586s_window_t *window) {
+
+    uint32_t row_start = UINT32_MAX;
+    uint32_t row_end = 0;
+    uint32_t triplet_start = UINT32_MAX;
+    uint32_t triplet_end = 0;
+
+    for (uint32_t row = 0; row < num_rows; row++) {
+        const uint8_t *src = &frame[row * frame_stride];
+        uint8_t *dest = &encoded[row * num_triplets];
+
+        // Find the first and last triplet that changed in this row.
+        uint32_t first = UINT32_MAX;
+        uint32_t last = 0;
+
+        // Three bytes hold 12 pixels, which is 4 triplets.
+        for (uint32_t triplet = 0; triplet < num_triplets; src += 3) {
+            uint32_t pixels = src[0] << 16 | src[1] << 8 | src[2];
+            for (int32_t shift = 18; shift >= 0; shift -= 6, triplet++) {
+                // Track changes without branching, which is costly on the EV3.
+                uint8_t value = triplet_table[(pixels >> shift) & 0x3f];
+                bool changed = full || value != dest[triplet];
+                dest[triplet] = value;
+                first = changed && first == UINT32_MAX ? triplet : first;
+                last = changed ? triplet : last;
+            }
+        }
+
+        if (first == UINT32_MAX) {
+            continue;
+        }
+        if (row_start == UINT32_MAX) {
+            row_start = row;
+        }
+        row_end = row;
+        if (first < triplet_start) {
+            triplet_start = first;
+        }
+        if (last > triplet_end) {
+            triplet_end = last;
+        }
+    }
+
+    *window = (pbdrv_display_st7586s_window_t) {
+        .row_start = row_start,
+        .row_end = row_end,
+        .triplet_start = triplet_start,
+        .triplet_end = triplet_end,
+    };
+    return row_start != UINT32_MAX;
+}
+
+#endif // PBDRV_CONFIG_DISPLAY_ST7586S
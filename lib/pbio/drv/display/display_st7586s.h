@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#ifndef _INTERNAL_PBDRV_DISPLAY_ST7586S_H_
+#define _INTERNAL_PBDRV_DISPLAY_ST7586S_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Maximum pixel value.
+ */
+#define PBDRV_DISPLAY_ST7586S_VALUE_MAX (3)
+
+/**
+ * Window of the display that changed, in rows and column triplets. The end
+ * values are inclusive, as used by the CASET and RASET commands.
+ */
+typedef struct {
+    uint8_t row_start;
+    uint8_t row_end;
+    uint8_t triplet_start;
+    uint8_t triplet_end;
+} pbdrv_display_st7586s_window_t;
+
+bool pbdrv_display_st7586s_encode(const uint8_t *frame, uint32_t frame_stride,
+    uint8_t *encoded, uint32_t num_rows, uint32_t num_triplets,
+    bool full, pbdrv_display_st7586s_window_t *window);
+
+#endif // _INTERNAL_PBDRV_DISPLAY_ST7586S_H_
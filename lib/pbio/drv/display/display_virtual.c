@@ -7,8 +7,12 @@
 
 #if PBDRV_CONFIG_DISPLAY_VIRTUAL
 
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <pbdrv/display.h>
 
@@ -42,6 +46,77 @@ static pbio_image_t display_image;
  */
 static bool pbdrv_display_user_frame_update_requested;
 
+/**
+ * Header of the shared frame buffer file, followed by the pixels in the same
+ * format as the user frame.
+ *
+ * The frame counter is odd while a frame is being written. Readers copy the
+ * frame if the counter is even and unchanged before and after the copy.
+ */
+typedef struct {
+    /** Number of frame writes started, odd while one is in progress. */
+    uint32_t frame;
+    /** Width of the frame in pixels. */
+    uint16_t width;
+    /** Height of the frame in pixels. */
+    uint16_t height;
+    /** Pixels, one byte each, row by row. */
+    uint8_t pixels[];
+} pbdrv_display_virtual_shared_t;
+
+/**
+ * Frame buffer shared with external viewers, or NULL if not enabled.
+ */
+static pbdrv_display_virtual_shared_t *shared;
+
+/**
+ * Maps the file given by the PBIO_TEST_DISPLAY_FILE environment variable
+ * for sharing frames with external viewers.
+ */
+static void pbdrv_display_virtual_shared_init(void) {
+    const char *path = getenv("PBIO_TEST_DISPLAY_FILE");
+    if (!path || shared) {
+        return;
+    }
+
+    size_t size = sizeof(pbdrv_display_virtual_shared_t) + sizeof(pbdrv_display_user_frame);
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        printf("open() failed\n");
+        return;
+    }
+    if (ftruncate(fd, size) < 0) {
+        printf("ftruncate() failed\n");
+        close(fd);
+        return;
+    }
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("mmap() failed\n");
+        return;
+    }
+
+    shared = map;
+    shared->width = PBDRV_CONFIG_DISPLAY_NUM_COLS;
+    shared->height = PBDRV_CONFIG_DISPLAY_NUM_ROWS;
+    __atomic_store_n(&shared->frame, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Writes the user frame to the shared frame buffer, if enabled.
+ */
+static void pbdrv_display_virtual_shared_write(void) {
+    if (!shared) {
+        return;
+    }
+    uint32_t frame = shared->frame;
+    __atomic_store_n(&shared->frame, frame + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(shared->pixels, pbdrv_display_user_frame, sizeof(pbdrv_display_user_frame));
+    __atomic_store_n(&shared->frame, frame + 2, __ATOMIC_RELEASE);
+}
+
 static pbio_os_process_t pbdrv_display_virtual_process;
 
 /**
@@ -62,6 +137,7 @@ static pbio_error_t pbdrv_display_virtual_process_thread(pbio_os_state_t *state,
         PBIO_OS_AWAIT_UNTIL(state, pbdrv_display_user_frame_update_requested);
         pbdrv_display_user_frame_update_requested = false;
         pbdrv_rproc_virtual_socket_send(display_image.pixels, sizeof(pbdrv_display_user_frame));
+        pbdrv_display_virtual_shared_write();
     }
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
@@ -79,6 +155,8 @@ void pbdrv_display_init(void) {
     display_image.print_font = &pbio_font_terminus_normal_16;
     display_image.print_value = 3;
 
+    pbdrv_display_virtual_shared_init();
+
     pbio_busy_count_up();
     pbio_os_process_start(&pbdrv_display_virtual_process, pbdrv_display_virtual_process_thread, NULL);
 }
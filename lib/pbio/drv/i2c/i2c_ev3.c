@@ -55,6 +55,10 @@ struct _pbdrv_i2c_dev_t {
     uint8_t pru_i2c_idx;
     pbio_os_timer_t timer;
     size_t try_count;
+    /** Protothread state of the current operation in a list. */
+    pbio_os_state_t child;
+    /** Index of the current operation in a list. */
+    size_t op_index;
 };
 
 static pbdrv_i2c_dev_t i2c_devs[PBDRV_RPROC_EV3_PRU1_NUM_I2C_BUSES];
@@ -189,6 +193,41 @@ pbio_error_t pbdrv_i2c_write_then_read(
     PBIO_OS_ASYNC_END(PBIO_ERROR_IO);
 }
 
+pbio_error_t pbdrv_i2c_write_then_read_list(
+    pbio_os_state_t *state,
+    pbdrv_i2c_dev_t *i2c_dev,
+    uint8_t dev_addr,
+    const pbdrv_i2c_op_t *ops,
+    size_t num_ops,
+    bool nxt_quirk) {
+
+    pbio_error_t err;
+    uint8_t *rdata = NULL;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    if (num_ops && !ops) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    for (i2c_dev->op_index = 0; i2c_dev->op_index < num_ops; i2c_dev->op_index++) {
+        PBIO_OS_AWAIT(state, &i2c_dev->child, err = pbdrv_i2c_write_then_read(
+            &i2c_dev->child, i2c_dev, dev_addr,
+            ops[i2c_dev->op_index].wdata, ops[i2c_dev->op_index].wlen,
+            &rdata, ops[i2c_dev->op_index].rlen, nxt_quirk));
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        // The driver buffer is reused by the next operation, so copy now.
+        if (rdata) {
+            memcpy(ops[i2c_dev->op_index].rdata, rdata, ops[i2c_dev->op_index].rlen);
+        }
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 static pbio_os_process_t ev3_i2c_init_process;
 
 pbio_error_t ev3_i2c_init_process_thread(pbio_os_state_t *state, void *context) {
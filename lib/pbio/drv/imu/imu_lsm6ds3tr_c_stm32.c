@@ -27,6 +27,30 @@
 
 #include "./imu_lsm6ds3tr_c_stm32.h"
 
+// Number of frames the sensor collects in its FIFO before they are read in a
+// single I2C transaction. Zero reads every frame as soon as it is ready.
+#ifndef PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_FIFO_NUM_FRAMES
+#define PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_FIFO_NUM_FRAMES (0)
+#endif
+
+#define USE_FIFO (PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_FIFO_NUM_FRAMES > 0)
+
+/** Number of raw values in one frame: gyro (xyz) and accelerometer (xyz). */
+#define NUM_FRAME_VALUES (6)
+
+/** Number of bytes in one frame. */
+#define NUM_FRAME_BYTES (NUM_FRAME_VALUES * sizeof(int16_t))
+
+#if USE_FIFO
+/**
+ * Maximum number of frames read at once. This is more than the watermark so
+ * that a late read can catch up without waiting for another interrupt.
+ */
+#define MAX_FRAMES (PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_FIFO_NUM_FRAMES * 2)
+#else
+#define MAX_FRAMES (1)
+#endif
+
 struct _pbdrv_imu_dev_t {
     /** Driver context for external library. */
     stmdev_ctx_t ctx;
@@ -38,8 +62,8 @@ struct _pbdrv_imu_dev_t {
     pbdrv_imu_handle_frame_data_func_t handle_frame_data;
     /* Callback to process unfiltered gyro and accelerometer data recorded while stationary. */
     pbdrv_imu_handle_stationary_data_func_t handle_stationary_data;
-    /** Latest raw data. */
-    int16_t data[6];
+    /** Latest raw data, one or more frames. */
+    int16_t data[NUM_FRAME_VALUES * MAX_FRAMES];
     /** Most recent slow moving average of raw data. */
     int16_t data_slow[6];
     /** Sum of raw data for slow moving average. */
@@ -58,18 +82,40 @@ struct _pbdrv_imu_dev_t {
     uint32_t stationary_sample_count;
     /** Whether it is currently stationary, to be polled by higher level APIs. */
     bool stationary_now;
+    /** Output data rate that the sensor is configured for, in Hz. */
+    uint32_t data_rate;
+    /** Output data rate requested by higher level APIs, in Hz. */
+    volatile uint32_t data_rate_requested;
     /** INT1 oneshot. */
     volatile bool int1;
 };
 
-/** The size of the data field in pbdrv_imu_dev_t in bytes. */
-#define NUM_DATA_BYTES sizeof(((struct _pbdrv_imu_dev_t *)0)->data)
-
-/** All data rate dependent values should be defined here so it is clear
- *  what needs to be changed when the data rate is changed. */
+/** Output data rate after boot, in Hz. */
 #define LSM6DS3TR_INITIAL_DATA_RATE (833)
-#define LSM6DS3TR_GYRO_DATA_RATE (LSM6DS3TR_C_GY_ODR_833Hz)
-#define LSM6DS3TR_ACCL_DATA_RATE (LSM6DS3TR_C_XL_ODR_833Hz)
+
+/**
+ * Gets the register value for an output data rate. The accelerometer, gyro,
+ * and FIFO use the same values, so this can be used for all of them.
+ *
+ * @param [in]  rate    The data rate in Hz.
+ * @return              The register value, or 0 if the rate is not supported.
+ */
+static uint8_t pbdrv_imu_lsm6ds3tr_c_stm32_odr(uint32_t rate) {
+    switch (rate) {
+        case 104:
+            return LSM6DS3TR_C_XL_ODR_104Hz;
+        case 208:
+            return LSM6DS3TR_C_XL_ODR_208Hz;
+        case 416:
+            return LSM6DS3TR_C_XL_ODR_416Hz;
+        case 833:
+            return LSM6DS3TR_C_XL_ODR_833Hz;
+        case 1666:
+            return LSM6DS3TR_C_XL_ODR_1k66Hz;
+        default:
+            return 0;
+    }
+}
 
 static pbdrv_imu_dev_t global_imu_dev;
 
@@ -204,12 +250,13 @@ static pbio_error_t pbdrv_imu_lsm6ds3tr_c_stm32_init(pbio_os_state_t *state) {
     /*
      * Set Output Data Rate
      */
-    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_xl_data_rate_set(&sub, ctx, LSM6DS3TR_ACCL_DATA_RATE));
-    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_gy_data_rate_set(&sub, ctx, LSM6DS3TR_GYRO_DATA_RATE));
+    imu_dev->data_rate = imu_dev->data_rate_requested = LSM6DS3TR_INITIAL_DATA_RATE;
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_xl_data_rate_set(&sub, ctx, pbdrv_imu_lsm6ds3tr_c_stm32_odr(imu_dev->data_rate)));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_gy_data_rate_set(&sub, ctx, pbdrv_imu_lsm6ds3tr_c_stm32_odr(imu_dev->data_rate)));
 
     // This value varies per device and is updated during runtime. This sets
     // an initial value in case the calibration never completes.
-    imu_dev->config.sample_time = (1.0f / LSM6DS3TR_INITIAL_DATA_RATE);
+    imu_dev->config.sample_time = (1.0f / imu_dev->data_rate);
 
     /*
      * Set scale
@@ -226,10 +273,25 @@ static pbio_error_t pbdrv_imu_lsm6ds3tr_c_stm32_init(pbio_os_state_t *state) {
     imu_dev->config.gyro_stationary_threshold = 0;
     imu_dev->config.accel_stationary_threshold = 0;
 
+    #if USE_FIFO
+    // Store gyro and accel frames in the FIFO at the full data rate. The
+    // watermark is given in 16-bit words.
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_watermark_set(&sub, ctx, PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_FIFO_NUM_FRAMES * NUM_FRAME_VALUES));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_gy_batch_set(&sub, ctx, LSM6DS3TR_C_FIFO_GY_NO_DEC));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_xl_batch_set(&sub, ctx, LSM6DS3TR_C_FIFO_XL_NO_DEC));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_data_rate_set(&sub, ctx, pbdrv_imu_lsm6ds3tr_c_stm32_odr(imu_dev->data_rate)));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_mode_set(&sub, ctx, LSM6DS3TR_C_STREAM_MODE));
+
+    // Configure INT1 to trigger when the FIFO watermark is reached.
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_pin_int1_route_set(&sub, ctx, (lsm6ds3tr_c_int1_route_t) {
+        .int1_fth = 1,
+    }));
+    #else
     // Configure INT1 to trigger when new gyro data is ready.
     PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_pin_int1_route_set(&sub, ctx, (lsm6ds3tr_c_int1_route_t) {
         .int1_drdy_g = 1,
     }));
+    #endif
 
     // If we leave the default latched mode, sometimes we don't get the INT1 interrupt.
     PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_data_ready_mode_set(&sub, ctx, LSM6DS3TR_C_DRDY_PULSED));
@@ -255,12 +317,13 @@ static void pbdrv_imu_lsm6ds3tr_c_stm32_reset_stationary_buffer(pbdrv_imu_dev_t
     memset(&imu_dev->stationary_gyro_data_sum, 0, sizeof(imu_dev->stationary_gyro_data_sum));
 }
 
-static void pbdrv_imu_lsm6ds3tr_c_stm32_update_slow_moving_average(pbdrv_imu_dev_t *imu_dev) {
+static void pbdrv_imu_lsm6ds3tr_c_stm32_update_slow_moving_average(pbdrv_imu_dev_t *imu_dev, const int16_t *data) {
     for (uint32_t i = 0; i < 6; i++) {
-        imu_dev->data_slow_sum[i] += imu_dev->data[i];
+        imu_dev->data_slow_sum[i] += data[i];
     }
+    // Average over about 150 ms.
     imu_dev->data_slow_count++;
-    if (imu_dev->data_slow_count == 125) {
+    if (imu_dev->data_slow_count >= (imu_dev->data_rate * 150 + 500) / 1000) {
         for (uint32_t i = 0; i < 6; i++) {
             imu_dev->data_slow[i] = imu_dev->data_slow_sum[i] / imu_dev->data_slow_count;
             imu_dev->data_slow_sum[i] = 0;
@@ -269,18 +332,18 @@ static void pbdrv_imu_lsm6ds3tr_c_stm32_update_slow_moving_average(pbdrv_imu_dev
     }
 }
 
-static void pbdrv_imu_lsm6ds3tr_c_stm32_update_stationary_status(pbdrv_imu_dev_t *imu_dev) {
+static void pbdrv_imu_lsm6ds3tr_c_stm32_update_stationary_status(pbdrv_imu_dev_t *imu_dev, const int16_t *data) {
 
     // Update slow moving average of raw data, used as starting point for stationary detection.
-    pbdrv_imu_lsm6ds3tr_c_stm32_update_slow_moving_average(imu_dev);
+    pbdrv_imu_lsm6ds3tr_c_stm32_update_slow_moving_average(imu_dev, data);
 
     // Check whether still stationary compared to constant start sample.
-    if (!is_bounded(imu_dev->data[0] - imu_dev->stationary_data_start[0], imu_dev->config.gyro_stationary_threshold) ||
-        !is_bounded(imu_dev->data[1] - imu_dev->stationary_data_start[1], imu_dev->config.gyro_stationary_threshold) ||
-        !is_bounded(imu_dev->data[2] - imu_dev->stationary_data_start[2], imu_dev->config.gyro_stationary_threshold) ||
-        !is_bounded(imu_dev->data[3] - imu_dev->stationary_data_start[3], imu_dev->config.accel_stationary_threshold) ||
-        !is_bounded(imu_dev->data[4] - imu_dev->stationary_data_start[4], imu_dev->config.accel_stationary_threshold) ||
-        !is_bounded(imu_dev->data[5] - imu_dev->stationary_data_start[5], imu_dev->config.accel_stationary_threshold)
+    if (!is_bounded(data[0] - imu_dev->stationary_data_start[0], imu_dev->config.gyro_stationary_threshold) ||
+        !is_bounded(data[1] - imu_dev->stationary_data_start[1], imu_dev->config.gyro_stationary_threshold) ||
+        !is_bounded(data[2] - imu_dev->stationary_data_start[2], imu_dev->config.gyro_stationary_threshold) ||
+        !is_bounded(data[3] - imu_dev->stationary_data_start[3], imu_dev->config.accel_stationary_threshold) ||
+        !is_bounded(data[4] - imu_dev->stationary_data_start[4], imu_dev->config.accel_stationary_threshold) ||
+        !is_bounded(data[5] - imu_dev->stationary_data_start[5], imu_dev->config.accel_stationary_threshold)
         ) {
         // Not stationary anymore, so reset counter and gyro sum data so we can start over.
         imu_dev->stationary_now = false;
@@ -294,15 +357,15 @@ static void pbdrv_imu_lsm6ds3tr_c_stm32_update_stationary_status(pbdrv_imu_dev_t
 
     // Updating running sum of stationary data.
     imu_dev->stationary_sample_count++;
-    imu_dev->stationary_gyro_data_sum[0] += imu_dev->data[0];
-    imu_dev->stationary_gyro_data_sum[1] += imu_dev->data[1];
-    imu_dev->stationary_gyro_data_sum[2] += imu_dev->data[2];
-    imu_dev->stationary_accel_data_sum[0] += imu_dev->data[3];
-    imu_dev->stationary_accel_data_sum[1] += imu_dev->data[4];
-    imu_dev->stationary_accel_data_sum[2] += imu_dev->data[5];
-
-    // Exit if we don't have enough samples yet.
-    if (imu_dev->stationary_sample_count < LSM6DS3TR_INITIAL_DATA_RATE) {
+    imu_dev->stationary_gyro_data_sum[0] += data[0];
+    imu_dev->stationary_gyro_data_sum[1] += data[1];
+    imu_dev->stationary_gyro_data_sum[2] += data[2];
+    imu_dev->stationary_accel_data_sum[0] += data[3];
+    imu_dev->stationary_accel_data_sum[1] += data[4];
+    imu_dev->stationary_accel_data_sum[2] += data[5];
+
+    // Exit if we don't have about one second of samples yet.
+    if (imu_dev->stationary_sample_count < imu_dev->data_rate) {
         return;
     }
 
@@ -321,14 +384,187 @@ static void pbdrv_imu_lsm6ds3tr_c_stm32_update_stationary_status(pbdrv_imu_dev_t
     pbdrv_imu_lsm6ds3tr_c_stm32_reset_stationary_buffer(imu_dev);
 }
 
+/**
+ * Processes the raw frames in the data buffer and passes them on to pbio.
+ *
+ * @param [in]  imu_dev     The IMU device instance.
+ * @param [in]  num_frames  Number of frames in the data buffer.
+ */
+static void pbdrv_imu_lsm6ds3tr_c_stm32_handle_frames(pbdrv_imu_dev_t *imu_dev, uint32_t num_frames) {
+    for (uint32_t f = 0; f < num_frames; f++) {
+        int16_t *data = &imu_dev->data[f * NUM_FRAME_VALUES];
+
+        // Account for mounting orientation in hub. Any other tranformations
+        // are applied at the higher level in pbio.
+        data[0] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_X;
+        data[1] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Y;
+        data[2] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Z;
+        data[3] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_X;
+        data[4] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Y;
+        data[5] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Z;
+
+        pbdrv_imu_lsm6ds3tr_c_stm32_update_stationary_status(imu_dev, data);
+    }
+
+    if (imu_dev->handle_frame_data) {
+        imu_dev->handle_frame_data(imu_dev->data, num_frames);
+    }
+}
+
+/**
+ * Applies the requested output data rate.
+ *
+ * Stationary detection starts over, since it counts samples. The measured
+ * sample time is reset to the nominal value until it is measured again.
+ *
+ * @param [in]  state       Protothread state.
+ * @param [in]  imu_dev     The IMU device instance.
+ * @return                  ::PBIO_SUCCESS on completion.
+ *                          ::PBIO_ERROR_FAILED if the sensor could not be
+ *                          configured. The requested rate is not tried again.
+ */
+static pbio_error_t pbdrv_imu_lsm6ds3tr_c_stm32_apply_data_rate(pbio_os_state_t *state, pbdrv_imu_dev_t *imu_dev) {
+    I2C_HandleTypeDef *hi2c = &imu_dev->hi2c;
+    stmdev_ctx_t *ctx = &imu_dev->ctx;
+
+    static pbio_os_state_t sub;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    imu_dev->data_rate = imu_dev->data_rate_requested;
+
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_xl_data_rate_set(&sub, ctx, pbdrv_imu_lsm6ds3tr_c_stm32_odr(imu_dev->data_rate)));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_gy_data_rate_set(&sub, ctx, pbdrv_imu_lsm6ds3tr_c_stm32_odr(imu_dev->data_rate)));
+
+    #if USE_FIFO
+    // Bypass mode empties the FIFO, so frames recorded at the old rate are
+    // not processed with the new sample time.
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_mode_set(&sub, ctx, LSM6DS3TR_C_BYPASS_MODE));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_data_rate_set(&sub, ctx, pbdrv_imu_lsm6ds3tr_c_stm32_odr(imu_dev->data_rate)));
+    PBIO_OS_AWAIT(state, &sub, lsm6ds3tr_c_fifo_mode_set(&sub, ctx, LSM6DS3TR_C_STREAM_MODE));
+    #endif
+
+    imu_dev->config.sample_time = (1.0f / imu_dev->data_rate);
+    imu_dev->stationary_now = false;
+    imu_dev->data_slow_count = 0;
+    memset(&imu_dev->data_slow_sum, 0, sizeof(imu_dev->data_slow_sum));
+    pbdrv_imu_lsm6ds3tr_c_stm32_reset_stationary_buffer(imu_dev);
+
+    if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_NONE) {
+        pbdrv_imu_lsm6ds3tr_c_stm32_i2c_reset(hi2c);
+        return PBIO_ERROR_FAILED;
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Tests if a new output data rate was requested.
+ *
+ * @param [in]  imu_dev     The IMU device instance.
+ * @return                  True if the rate must be changed.
+ */
+static bool pbdrv_imu_lsm6ds3tr_c_stm32_data_rate_changed(pbdrv_imu_dev_t *imu_dev) {
+    return imu_dev->data_rate_requested != imu_dev->data_rate;
+}
+
 static pbio_os_process_t pbdrv_imu_lsm6ds3tr_c_stm32_process;
 
+#if USE_FIFO
+
 static pbio_error_t pbdrv_imu_lsm6ds3tr_c_stm32_process_thread(pbio_os_state_t *state, void *context) {
     pbdrv_imu_dev_t *imu_dev = &global_imu_dev;
     I2C_HandleTypeDef *hi2c = &imu_dev->hi2c;
+    stmdev_ctx_t *ctx = &imu_dev->ctx;
 
     static pbio_os_state_t sub;
-    static uint8_t buf[NUM_DATA_BYTES];
+    static uint8_t status[2];
+    static uint32_t num_words;
+    static uint32_t num_frames;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_imu_lsm6ds3tr_c_stm32_init(&sub));
+
+    pbio_busy_count_down();
+
+    if (err != PBIO_SUCCESS) {
+        // The IMU is not essential. It just won't be available if init fails.
+        return err;
+    }
+
+    // Instead of one transaction per sample, the sensor collects frames in its
+    // FIFO and raises INT1 when the watermark is reached. Then all complete
+    // frames are read in one burst.
+
+    while (!(pbdrv_imu_lsm6ds3tr_c_stm32_process.request & PBIO_OS_PROCESS_REQUEST_TYPE_CANCEL)) {
+
+        PBIO_OS_AWAIT_UNTIL(state, pbdrv_imu_lsm6ds3tr_c_stm32_data_rate_changed(imu_dev) || atomic_exchange(&imu_dev->int1, false));
+
+        if (pbdrv_imu_lsm6ds3tr_c_stm32_data_rate_changed(imu_dev)) {
+            PBIO_OS_AWAIT(state, &sub, pbdrv_imu_lsm6ds3tr_c_stm32_apply_data_rate(&sub, imu_dev));
+            // The FIFO was emptied, so wait for the next watermark.
+            imu_dev->int1 = false;
+            continue;
+        }
+
+        do {
+            // Get number of unread words in the FIFO from FIFO_STATUS1 and FIFO_STATUS2.
+            lsm6ds3tr_c_read_reg(ctx, LSM6DS3TR_C_FIFO_STATUS1, status, sizeof(status));
+            PBIO_OS_AWAIT_UNTIL(state, ctx->read_write_done);
+
+            if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_NONE) {
+                // The FIFO may still be above the watermark, so INT1 might
+                // not be raised again. Try again on the next pass.
+                pbdrv_imu_lsm6ds3tr_c_stm32_i2c_reset(hi2c);
+                imu_dev->int1 = true;
+                break;
+            }
+
+            num_words = ((status[1] & 0x07) << 8) | status[0];
+            num_frames = num_words / NUM_FRAME_VALUES;
+            if (num_frames > MAX_FRAMES) {
+                num_frames = MAX_FRAMES;
+            }
+            if (num_frames == 0) {
+                break;
+            }
+
+            // Reading FIFO_DATA_OUT_H rolls the address back to FIFO_DATA_OUT_L,
+            // so all frames come out in one read. Gyro comes before accel,
+            // just like the output registers.
+            lsm6ds3tr_c_read_reg(ctx, LSM6DS3TR_C_FIFO_DATA_OUT_L, (uint8_t *)imu_dev->data, num_frames * NUM_FRAME_BYTES);
+            PBIO_OS_AWAIT_UNTIL(state, ctx->read_write_done);
+
+            if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_NONE) {
+                // Try again on the next pass, as above.
+                pbdrv_imu_lsm6ds3tr_c_stm32_i2c_reset(hi2c);
+                imu_dev->int1 = true;
+                break;
+            }
+
+            pbdrv_imu_lsm6ds3tr_c_stm32_handle_frames(imu_dev, num_frames);
+
+            // INT1 is only raised again when the level crosses the watermark,
+            // so keep reading if we could not catch up in one go.
+        } while (num_words - num_frames * NUM_FRAME_VALUES >= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_FIFO_NUM_FRAMES * NUM_FRAME_VALUES);
+    }
+
+    // Cancellation complete.
+    pbdrv_imu_lsm6ds3tr_c_stm32_i2c_reset(hi2c);
+    pbio_busy_count_down();
+    PBIO_OS_ASYNC_END(PBIO_ERROR_CANCELED);
+}
+
+#else // USE_FIFO
+
+static pbio_error_t pbdrv_imu_lsm6ds3tr_c_stm32_process_thread(pbio_os_state_t *state, void *context) {
+    pbdrv_imu_dev_t *imu_dev = &global_imu_dev;
+    I2C_HandleTypeDef *hi2c = &imu_dev->hi2c;
+
+    static pbio_os_state_t sub;
+    static uint8_t buf[NUM_FRAME_BYTES];
     pbio_error_t err;
 
     PBIO_OS_ASYNC_BEGIN(state);
@@ -369,11 +605,19 @@ retry:
 
     while (!(pbdrv_imu_lsm6ds3tr_c_stm32_process.request & PBIO_OS_PROCESS_REQUEST_TYPE_CANCEL)) {
 
-        PBIO_OS_AWAIT_UNTIL(state, atomic_exchange(&imu_dev->int1, false));
+        PBIO_OS_AWAIT_UNTIL(state, pbdrv_imu_lsm6ds3tr_c_stm32_data_rate_changed(imu_dev) || atomic_exchange(&imu_dev->int1, false));
+
+        if (pbdrv_imu_lsm6ds3tr_c_stm32_data_rate_changed(imu_dev)) {
+            // End the continuous read so the registers can be written, then
+            // start a new one.
+            pbdrv_imu_lsm6ds3tr_c_stm32_i2c_reset(hi2c);
+            PBIO_OS_AWAIT(state, &sub, pbdrv_imu_lsm6ds3tr_c_stm32_apply_data_rate(&sub, imu_dev));
+            goto retry;
+        }
 
         imu_dev->ctx.read_write_done = false;
         ret = HAL_I2C_Master_Seq_Receive_IT(
-            &imu_dev->hi2c, LSM6DS3TR_C_I2C_ADD_L, buf, NUM_DATA_BYTES, I2C_NEXT_FRAME);
+            &imu_dev->hi2c, LSM6DS3TR_C_I2C_ADD_L, buf, NUM_FRAME_BYTES, I2C_NEXT_FRAME);
 
         if (ret != HAL_OK) {
             pbdrv_imu_lsm6ds3tr_c_stm32_i2c_reset(hi2c);
@@ -387,21 +631,8 @@ retry:
             goto retry;
         }
 
-        memcpy(&imu_dev->data[0], buf, NUM_DATA_BYTES);
-
-        // Account for mounting orientation in hub. Any other tranformations
-        // are applied at the higher level in pbio.
-        imu_dev->data[0] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_X;
-        imu_dev->data[1] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Y;
-        imu_dev->data[2] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Z;
-        imu_dev->data[3] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_X;
-        imu_dev->data[4] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Y;
-        imu_dev->data[5] *= PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32_SIGN_Z;
-
-        pbdrv_imu_lsm6ds3tr_c_stm32_update_stationary_status(imu_dev);
-        if (imu_dev->handle_frame_data) {
-            imu_dev->handle_frame_data(imu_dev->data);
-        }
+        memcpy(&imu_dev->data[0], buf, NUM_FRAME_BYTES);
+        pbdrv_imu_lsm6ds3tr_c_stm32_handle_frames(imu_dev, 1);
     }
 
     // Cancellation complete.
@@ -410,6 +641,8 @@ retry:
     PBIO_OS_ASYNC_END(PBIO_ERROR_CANCELED);
 }
 
+#endif // USE_FIFO
+
 // internal driver interface implementation
 
 void pbdrv_imu_init(void) {
@@ -447,4 +680,13 @@ bool pbdrv_imu_is_stationary(pbdrv_imu_dev_t *imu_dev) {
     return imu_dev->stationary_now;
 }
 
+pbio_error_t pbdrv_imu_set_data_rate(pbdrv_imu_dev_t *imu_dev, uint32_t rate) {
+    if (!pbdrv_imu_lsm6ds3tr_c_stm32_odr(rate)) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    imu_dev->data_rate_requested = rate;
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+}
+
 #endif // PBDRV_CONFIG_IMU_LSM6S3TR_C_STM32
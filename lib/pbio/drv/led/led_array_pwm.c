@@ -21,6 +21,26 @@
 #error "Must define PBDRV_CONFIG_LED_ARRAY_PWM_NUM_DEV"
 #endif
 
+/**
+ * Duty cycle for each brightness from 0 to 100 percent.
+ *
+ * This is UINT16_MAX * brightness * brightness / 10000. The brightness is
+ * squared for gamma correction.
+ */
+static const uint16_t pbdrv_led_array_pwm_gamma[] = {
+    0, 6, 26, 58, 104, 163, 235, 321, 419, 530,
+    655, 792, 943, 1107, 1284, 1474, 1677, 1893, 2123, 2365,
+    2621, 2890, 3171, 3466, 3774, 4095, 4430, 4777, 5137, 5511,
+    5898, 6297, 6710, 7136, 7575, 8028, 8493, 8971, 9463, 9967,
+    10485, 11016, 11560, 12117, 12687, 13270, 13867, 14476, 15099, 15734,
+    16383, 17045, 17720, 18408, 19110, 19824, 20551, 21292, 22045, 22812,
+    23592, 24385, 25191, 26010, 26843, 27688, 28547, 29418, 30303, 31201,
+    32112, 33036, 33973, 34923, 35886, 36863, 37853, 38855, 39871, 40900,
+    41942, 42997, 44065, 45147, 46241, 47349, 48469, 49603, 50750, 51910,
+    53083, 54269, 55468, 56681, 57906, 59145, 60397, 61661, 62939, 64230,
+    65535,
+};
+
 static pbio_error_t pbdrv_led_array_pwm_set_brightness(pbdrv_led_array_dev_t *dev, uint8_t index, uint8_t brightness) {
     const pbdrv_led_array_pwm_platform_data_t *pdata = dev->pdata;
 
@@ -31,8 +51,10 @@ static pbio_error_t pbdrv_led_array_pwm_set_brightness(pbdrv_led_array_dev_t *de
     // REVISIT: currently all known devices have PWM period of UINT16_MAX, so
     // we scale accordingly. Scaling can be added to the platform data in the
     // future if needed.
-    // Brightness is squared for gamma correction.
-    uint32_t duty = UINT16_MAX * brightness * brightness / 10000;
+    if (brightness > 100) {
+        brightness = 100;
+    }
+    uint32_t duty = pbdrv_led_array_pwm_gamma[brightness];
 
     pbdrv_pwm_dev_t *pwm;
     if (pbdrv_pwm_get_dev(pdata->pwm_id, &pwm) == PBIO_SUCCESS) {
@@ -26,17 +26,21 @@
 static pbio_error_t pbdrv_led_dual_set_hsv(pbdrv_led_dev_t *dev, const pbio_color_hsv_t *hsv) {
     const pbdrv_led_dual_platform_data_t *pdata = dev->pdata;
     pbdrv_led_dev_t *led;
+    pbio_error_t err = PBIO_SUCCESS;
 
-    // REVISIT: may want to propagate error
+    // Both LEDs are set even if one of them fails. The first error is returned.
 
     if (pbdrv_led_get_dev(pdata->id1, &led) == PBIO_SUCCESS) {
-        pbdrv_led_set_hsv(led, hsv);
+        err = pbdrv_led_set_hsv(led, hsv);
     }
     if (pbdrv_led_get_dev(pdata->id2, &led) == PBIO_SUCCESS) {
-        pbdrv_led_set_hsv(led, hsv);
+        pbio_error_t err2 = pbdrv_led_set_hsv(led, hsv);
+        if (err == PBIO_SUCCESS) {
+            err = err2;
+        }
     }
 
-    return PBIO_SUCCESS;
+    return err;
 }
 
 static const pbdrv_led_funcs_t pbdrv_led_dual_funcs = {
@@ -54,18 +54,30 @@ static pbio_error_t pbdrv_led_pwm_set_hsv(pbdrv_led_dev_t *dev, const pbio_color
     g = g * scale_factor / Y;
     b = b * scale_factor / Y;
 
+    // Update all three channels at once.
+    pbdrv_pwm_batch_begin();
+    // PWM devices may not be ready yet during boot, so this returns
+    // ::PBIO_ERROR_AGAIN if any channel could not be set.
+    pbio_error_t err = PBIO_SUCCESS;
     pbdrv_pwm_dev_t *pwm;
     if (pbdrv_pwm_get_dev(pdata->r_id, &pwm) == PBIO_SUCCESS) {
         pbdrv_pwm_set_duty(pwm, pdata->r_ch, r);
+    } else {
+        err = PBIO_ERROR_AGAIN;
     }
     if (pbdrv_pwm_get_dev(pdata->g_id, &pwm) == PBIO_SUCCESS) {
         pbdrv_pwm_set_duty(pwm, pdata->g_ch, g);
+    } else {
+        err = PBIO_ERROR_AGAIN;
     }
     if (pbdrv_pwm_get_dev(pdata->b_id, &pwm) == PBIO_SUCCESS) {
         pbdrv_pwm_set_duty(pwm, pdata->b_ch, b);
+    } else {
+        err = PBIO_ERROR_AGAIN;
     }
+    pbdrv_pwm_batch_end();
 
-    return PBIO_SUCCESS;
+    return err;
 }
 
 static const pbdrv_led_funcs_t pbdrv_led_pwm_funcs = {
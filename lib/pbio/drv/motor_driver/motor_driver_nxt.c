@@ -91,6 +91,10 @@ pbio_error_t pbdrv_motor_driver_set_duty_cycle(pbdrv_motor_driver_dev_t *driver,
     return pbdrv_rproc_nxt_set_sensor_power(driver->index, power_type);
 }
 
+void pbdrv_motor_driver_nxt_get_latency(uint32_t *latency_us, uint32_t *latency_max_us) {
+    pbdrv_rproc_nxt_get_latency(latency_us, latency_max_us);
+}
+
 void pbdrv_motor_driver_init(void) {
 }
 
@@ -39,16 +39,15 @@ struct _pbdrv_counter_dev_t {
 };
 
 struct _pbdrv_motor_driver_dev_t {
-    double angle;
-    double current;
-    double speed;
-    double voltage;
-    double torque;
-    const pbio_simulation_model_t *model;
+    /** Index of this motor in the simulation state. */
+    uint32_t index;
     const pbdrv_motor_driver_virtual_simulation_platform_data_t *pdata;
     pbdrv_counter_dev_t counter;
 };
 
+// Discrete models for a time step of 1 ms. Models other than the Technic M
+// Angular motor are the 1 ms observer models in servo_settings.c, generated
+// by pbio/doc/control/motor_data.py.
 static const pbio_simulation_model_t model_technic_m_angular = {
     .d_angle_d_speed = 0.0009981527613056019,
     .d_speed_d_speed = 0.994653578576391,
@@ -65,7 +64,208 @@ static const pbio_simulation_model_t model_technic_m_angular = {
     .torque_friction = 21413.268,
 };
 
-static pbdrv_motor_driver_dev_t motor_driver_devs[PBDRV_CONFIG_MOTOR_DRIVER_NUM_DEV];
+static const pbio_simulation_model_t model_technic_s_angular = {
+    .d_angle_d_speed = 0.0009970069,
+    .d_speed_d_speed = 0.9915835,
+    .d_current_d_speed = -0.001974046,
+    .d_angle_d_current = 0.003008008,
+    .d_speed_d_current = 5.354415,
+    .d_current_d_current = 0.4726398,
+    .d_angle_d_voltage = 0.0004423857,
+    .d_speed_d_voltage = 1.253334,
+    .d_current_d_voltage = 0.2939572,
+    .d_angle_d_torque = -0.0002062917,
+    .d_speed_d_torque = -0.4120499,
+    .d_current_d_torque = 0.0004583001,
+    .torque_friction = 9182,
+};
+
+static const pbio_simulation_model_t model_technic_l_angular = {
+    .d_angle_d_speed = 0.0009989738,
+    .d_speed_d_speed = 0.9970472,
+    .d_current_d_speed = -0.005135655,
+    .d_angle_d_current = 0.0004936457,
+    .d_speed_d_current = 0.9381983,
+    .d_current_d_current = 0.7301692,
+    .d_angle_d_voltage = 0.0001406074,
+    .d_speed_d_voltage = 0.4113636,
+    .d_current_d_voltage = 0.7154765,
+    .d_angle_d_torque = -2.348423e-05,
+    .d_speed_d_torque = -0.04697406,
+    .d_current_d_torque = 0.0001270771,
+    .torque_friction = 23239,
+};
+
+static const pbio_simulation_model_t model_interactive = {
+    .d_angle_d_speed = 0.0009946227,
+    .d_speed_d_speed = 0.9865845,
+    .d_current_d_speed = -0.00279063,
+    .d_angle_d_current = 0.001492441,
+    .d_speed_d_current = 2.059033,
+    .d_current_d_current = 0.04263139,
+    .d_angle_d_voltage = 0.0009942651,
+    .d_speed_d_voltage = 2.487356,
+    .d_current_d_voltage = 0.5174137,
+    .d_angle_d_torque = -0.000120759,
+    .d_speed_d_torque = -0.2409157,
+    .d_current_d_torque = 0.0004899502,
+    .torque_friction = 11227,
+};
+
+static const pbio_simulation_model_t model_technic_l = {
+    .d_angle_d_speed = 0.000998199,
+    .d_speed_d_speed = 0.9948919,
+    .d_current_d_speed = -0.003219903,
+    .d_angle_d_current = 0.001073003,
+    .d_speed_d_current = 1.884189,
+    .d_current_d_current = 0.4297967,
+    .d_angle_d_voltage = 0.0004236102,
+    .d_speed_d_voltage = 1.192227,
+    .d_current_d_voltage = 0.7515283,
+    .d_angle_d_torque = -6.318092e-05,
+    .d_speed_d_torque = -0.1262501,
+    .d_current_d_torque = 0.0002319217,
+    .torque_friction = 26430,
+};
+
+static const pbio_simulation_model_t model_technic_xl = {
+    .d_angle_d_speed = 0.0009974241,
+    .d_speed_d_speed = 0.9930686,
+    .d_current_d_speed = -0.003864527,
+    .d_angle_d_current = 0.0009685159,
+    .d_speed_d_current = 1.580425,
+    .d_current_d_current = 0.2465547,
+    .d_angle_d_voltage = 0.0005942583,
+    .d_speed_d_voltage = 1.614161,
+    .d_current_d_voltage = 0.8999641,
+    .d_angle_d_torque = -6.80089e-05,
+    .d_speed_d_torque = -0.1358613,
+    .d_current_d_torque = 0.0003225803,
+    .torque_friction = 12893,
+};
+
+static const pbio_simulation_model_t model_movehub = {
+    .d_angle_d_speed = 0.0009976029,
+    .d_speed_d_speed = 0.9934298,
+    .d_current_d_speed = -0.003340781,
+    .d_angle_d_current = 0.001057386,
+    .d_speed_d_current = 1.723201,
+    .d_current_d_current = 0.2439288,
+    .d_angle_d_voltage = 0.0006492138,
+    .d_speed_d_voltage = 1.762338,
+    .d_current_d_voltage = 0.8961088,
+    .d_angle_d_torque = -9.024143e-05,
+    .d_speed_d_torque = -0.180235,
+    .d_current_d_torque = 0.0003703833,
+    .torque_friction = 24835,
+};
+
+static const pbio_simulation_model_t model_nxt = {
+    .d_angle_d_speed = 0.001995981,
+    .d_speed_d_speed = 0.9942815,
+    .d_current_d_speed = -0.008004308,
+    .d_angle_d_current = 0.001009285,
+    .d_speed_d_current = 0.8988199,
+    .d_current_d_current = 0.4748201,
+    .d_angle_d_voltage = 0.0004748702,
+    .d_speed_d_voltage = 0.6728421,
+    .d_current_d_voltage = 0.9417824,
+    .d_angle_d_torque = -3.731251e-05,
+    .d_speed_d_torque = -0.03726172,
+    .d_current_d_torque = 0.0001677871,
+    .torque_friction = 20449,
+};
+
+static const pbio_simulation_model_t model_ev3_l = {
+    .d_angle_d_speed = 0.0019961,
+    .d_speed_d_speed = 0.9944534,
+    .d_current_d_speed = -0.007781804,
+    .d_angle_d_current = 0.001007617,
+    .d_speed_d_current = 0.8975862,
+    .d_current_d_current = 0.4756651,
+    .d_angle_d_voltage = 0.0004740357,
+    .d_speed_d_voltage = 0.6717488,
+    .d_current_d_voltage = 0.9424655,
+    .d_angle_d_torque = -4.61936e-05,
+    .d_speed_d_torque = -0.04615229,
+    .d_current_d_torque = 0.0002020001,
+    .torque_friction = 16476,
+};
+
+static const pbio_simulation_model_t model_ev3_m = {
+    .d_angle_d_speed = 0.001993835,
+    .d_speed_d_speed = 0.9913248,
+    .d_current_d_speed = -0.002788782,
+    .d_angle_d_current = 0.004097283,
+    .d_speed_d_current = 3.56492,
+    .d_current_d_current = 0.4025762,
+    .d_angle_d_voltage = 0.001218438,
+    .d_speed_d_voltage = 1.70719,
+    .d_current_d_voltage = 0.5488101,
+    .d_angle_d_torque = -0.0002197623,
+    .d_speed_d_torque = -0.2194298,
+    .d_current_d_torque = 0.0003527403,
+    .torque_friction = 24593,
+};
+
+#define NUM_DEV (PBDRV_CONFIG_MOTOR_DRIVER_NUM_DEV)
+
+// State, inputs and model coefficients of all motors. Each quantity is
+// stored as one array over all motors, so all motors are updated in a single
+// pass that the compiler can vectorize. Ports without a motor have zero model
+// coefficients, so they need no special case.
+static struct {
+    double angle[NUM_DEV];
+    double speed[NUM_DEV];
+    double current[NUM_DEV];
+    double voltage[NUM_DEV];
+    double endstop_angle_negative[NUM_DEV];
+    double endstop_angle_positive[NUM_DEV];
+    double d_angle_d_speed[NUM_DEV];
+    double d_speed_d_speed[NUM_DEV];
+    double d_current_d_speed[NUM_DEV];
+    double d_angle_d_current[NUM_DEV];
+    double d_speed_d_current[NUM_DEV];
+    double d_current_d_current[NUM_DEV];
+    double d_angle_d_voltage[NUM_DEV];
+    double d_speed_d_voltage[NUM_DEV];
+    double d_current_d_voltage[NUM_DEV];
+    double d_angle_d_torque[NUM_DEV];
+    double d_speed_d_torque[NUM_DEV];
+    double d_current_d_torque[NUM_DEV];
+    double torque_friction[NUM_DEV];
+} sim;
+
+static pbdrv_motor_driver_dev_t motor_driver_devs[NUM_DEV];
+
+static const pbio_simulation_model_t *simulation_get_model(lego_device_type_id_t type_id) {
+    switch (type_id) {
+        case LEGO_DEVICE_TYPE_ID_SPIKE_S_MOTOR:
+            return &model_technic_s_angular;
+        case LEGO_DEVICE_TYPE_ID_SPIKE_M_MOTOR:
+        case LEGO_DEVICE_TYPE_ID_TECHNIC_M_ANGULAR_MOTOR:
+            return &model_technic_m_angular;
+        case LEGO_DEVICE_TYPE_ID_SPIKE_L_MOTOR:
+        case LEGO_DEVICE_TYPE_ID_TECHNIC_L_ANGULAR_MOTOR:
+            return &model_technic_l_angular;
+        case LEGO_DEVICE_TYPE_ID_INTERACTIVE_MOTOR:
+            return &model_interactive;
+        case LEGO_DEVICE_TYPE_ID_TECHNIC_L_MOTOR:
+            return &model_technic_l;
+        case LEGO_DEVICE_TYPE_ID_TECHNIC_XL_MOTOR:
+            return &model_technic_xl;
+        case LEGO_DEVICE_TYPE_ID_MOVE_HUB_MOTOR:
+            return &model_movehub;
+        case LEGO_DEVICE_TYPE_ID_NXT_MOTOR:
+            return &model_nxt;
+        case LEGO_DEVICE_TYPE_ID_EV3_LARGE_MOTOR:
+            return &model_ev3_l;
+        case LEGO_DEVICE_TYPE_ID_EV3_MEDIUM_MOTOR:
+            return &model_ev3_m;
+        default:
+            return NULL;
+    }
+}
 
 static void simulation_init(void) {
 
@@ -79,32 +279,36 @@ static void simulation_init(void) {
     has_initialized = true;
 
     // Initialize driver from platform data.
-    for (uint32_t dev_index = 0; dev_index < PBDRV_CONFIG_MOTOR_DRIVER_NUM_DEV; dev_index++) {
+    for (uint32_t dev_index = 0; dev_index < NUM_DEV; dev_index++) {
         // Get driver and platform data.
         pbdrv_motor_driver_dev_t *driver = &motor_driver_devs[dev_index];
         driver->pdata = &pbdrv_motor_driver_virtual_simulation_platform_data[dev_index];
-        driver->angle = driver->pdata->initial_angle;
-        driver->speed = driver->pdata->initial_speed;
-        driver->current = 0;
-        driver->torque = 0;
-        driver->voltage = 0;
-
-        // Select model corresponding to device ID.
-        switch (driver->pdata->type_id) {
-            case LEGO_DEVICE_TYPE_ID_SPIKE_S_MOTOR:
-                driver->model = &model_technic_m_angular; // TODO
-                break;
-            case LEGO_DEVICE_TYPE_ID_SPIKE_M_MOTOR:
-                driver->model = &model_technic_m_angular;
-                break;
-            case LEGO_DEVICE_TYPE_ID_SPIKE_L_MOTOR:
-                driver->model = &model_technic_m_angular; // TODO
-                break;
-            default:
-            case LEGO_DEVICE_TYPE_ID_NONE:
-                driver->model = NULL;
-                break;
+        driver->index = dev_index;
+        sim.angle[dev_index] = driver->pdata->initial_angle;
+        sim.speed[dev_index] = driver->pdata->initial_speed;
+        sim.current[dev_index] = 0;
+        sim.voltage[dev_index] = 0;
+        sim.endstop_angle_negative[dev_index] = driver->pdata->endstop_angle_negative;
+        sim.endstop_angle_positive[dev_index] = driver->pdata->endstop_angle_positive;
+
+        // Leave all coefficients at zero if there is no model.
+        const pbio_simulation_model_t *m = simulation_get_model(driver->pdata->type_id);
+        if (!m) {
+            continue;
         }
+        sim.d_angle_d_speed[dev_index] = m->d_angle_d_speed;
+        sim.d_speed_d_speed[dev_index] = m->d_speed_d_speed;
+        sim.d_current_d_speed[dev_index] = m->d_current_d_speed;
+        sim.d_angle_d_current[dev_index] = m->d_angle_d_current;
+        sim.d_speed_d_current[dev_index] = m->d_speed_d_current;
+        sim.d_current_d_current[dev_index] = m->d_current_d_current;
+        sim.d_angle_d_voltage[dev_index] = m->d_angle_d_voltage;
+        sim.d_speed_d_voltage[dev_index] = m->d_speed_d_voltage;
+        sim.d_current_d_voltage[dev_index] = m->d_current_d_voltage;
+        sim.d_angle_d_torque[dev_index] = m->d_angle_d_torque;
+        sim.d_speed_d_torque[dev_index] = m->d_speed_d_torque;
+        sim.d_current_d_torque[dev_index] = m->d_current_d_torque;
+        sim.torque_friction[dev_index] = m->torque_friction;
     }
 }
 
@@ -139,13 +343,14 @@ pbio_error_t pbdrv_counter_assert_type(pbdrv_counter_dev_t *dev, lego_device_typ
 }
 
 pbio_error_t pbdrv_counter_get_angle(pbdrv_counter_dev_t *dev, int32_t *rotations, int32_t *millidegrees) {
-    *rotations = (int32_t)(dev->motor_driver->angle / 360000);
-    *millidegrees = (int32_t)(dev->motor_driver->angle) % 360000;
+    double angle = sim.angle[dev->motor_driver->index];
+    *rotations = (int32_t)(angle / 360000);
+    *millidegrees = (int32_t)(angle) % 360000;
     return PBIO_SUCCESS;
 }
 
 pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *millidegrees) {
-    *millidegrees = ((int32_t)dev->motor_driver->angle) % 360000;
+    *millidegrees = ((int32_t)sim.angle[dev->motor_driver->index]) % 360000;
     if (*millidegrees > 180000) {
         *millidegrees -= 360000;
     } else if (*millidegrees < -180000) {
@@ -154,6 +359,11 @@ pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *mill
     return PBIO_SUCCESS;
 }
 
+pbio_error_t pbdrv_counter_get_edge_speed(pbdrv_counter_dev_t *dev, int32_t *speed) {
+    // The simulated angle is continuous, so there are no edges to time.
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 pbio_error_t pbdrv_motor_driver_get_dev(uint8_t id, pbdrv_motor_driver_dev_t **driver) {
     if (id >= PBDRV_CONFIG_MOTOR_DRIVER_NUM_DEV) {
         return PBIO_ERROR_INVALID_ARG;
@@ -165,21 +375,63 @@ pbio_error_t pbdrv_motor_driver_get_dev(uint8_t id, pbdrv_motor_driver_dev_t **d
 }
 
 pbio_error_t pbdrv_motor_driver_coast(pbdrv_motor_driver_dev_t *driver) {
-    driver->voltage = 0.0;
+    sim.voltage[driver->index] = 0.0;
     return PBIO_SUCCESS;
 }
 
 pbio_error_t pbdrv_motor_driver_set_duty_cycle(pbdrv_motor_driver_dev_t *driver, int16_t duty_cycle) {
-    driver->voltage = pbio_battery_get_voltage_from_duty(duty_cycle);
+    sim.voltage[driver->index] = pbio_battery_get_voltage_from_duty(duty_cycle);
     return PBIO_SUCCESS;
 }
 
+/**
+ * Advances all motors by one time step.
+ */
+static void simulation_step(void) {
+    // Modified coulomb friction with transition linear in speed through origin.
+    const double friction_speed_limit = 2000;
+
+    for (uint32_t i = 0; i < NUM_DEV; i++) {
+        double speed = sim.speed[i];
+        double angle = sim.angle[i];
+        double current = sim.current[i];
+        double voltage = sim.voltage[i];
+
+        double friction_ratio = speed * (1 / friction_speed_limit);
+        friction_ratio = friction_ratio > 1 ? 1 : friction_ratio;
+        friction_ratio = friction_ratio < -1 ? -1 : friction_ratio;
+        double friction = sim.torque_friction[i] * friction_ratio;
+
+        // Stall obstacle torque.
+        double endstop_error =
+            angle > sim.endstop_angle_positive[i] ? angle - sim.endstop_angle_positive[i] :
+            angle < sim.endstop_angle_negative[i] ? angle - sim.endstop_angle_negative[i] : 0;
+        double external_torque = endstop_error != 0 ? endstop_error * 500 + speed * 5 : 0;
+
+        double torque = friction + external_torque;
+
+        // Get next state based on current state and input: x(k+1) = Ax(k) + Bu(k)
+        sim.angle[i] = angle +
+            speed * sim.d_angle_d_speed[i] +
+            current * sim.d_angle_d_current[i] +
+            voltage * sim.d_angle_d_voltage[i] +
+            torque * sim.d_angle_d_torque[i];
+        sim.speed[i] =
+            speed * sim.d_speed_d_speed[i] +
+            current * sim.d_speed_d_current[i] +
+            voltage * sim.d_speed_d_voltage[i] +
+            torque * sim.d_speed_d_torque[i];
+        sim.current[i] =
+            speed * sim.d_current_d_speed[i] +
+            current * sim.d_current_d_current[i] +
+            voltage * sim.d_current_d_voltage[i] +
+            torque * sim.d_current_d_torque[i];
+    }
+}
+
 pbio_error_t pbdrv_motor_driver_virtual_simulation_process_thread(pbio_os_state_t *state, void *context) {
     static pbio_os_timer_t timer;
 
-    static uint32_t dev_index;
-    static pbdrv_motor_driver_dev_t *driver;
-
     PBIO_OS_ASYNC_BEGIN(state);
 
     // Matches LTI model discretization time step.
@@ -188,62 +440,7 @@ pbio_error_t pbdrv_motor_driver_virtual_simulation_process_thread(pbio_os_state_
     for (;;) {
         PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
         pbio_os_timer_extend(&timer);
-
-        for (dev_index = 0; dev_index < PBDRV_CONFIG_MOTOR_DRIVER_NUM_DEV; dev_index++) {
-            driver = &motor_driver_devs[dev_index];
-
-            // Skip simulating if there is no model.
-            if (!driver->model) {
-                continue;
-            }
-
-            // Shorthand notation for frequent local references to model.
-            const pbio_simulation_model_t *m = driver->model;
-
-            // Modified coulomb friction with transition linear in speed through origin.
-            const double limit = 2000;
-            double friction;
-            if (driver->speed > limit) {
-                friction = m->torque_friction;
-            } else if (driver->speed < -limit) {
-                friction = -m->torque_friction;
-            } else {
-                friction = m->torque_friction * driver->speed / limit;
-            }
-
-            // Stall obstacle torque
-            double external_torque = 0;
-            if (driver->angle > driver->pdata->endstop_angle_positive) {
-                external_torque = (driver->angle - driver->pdata->endstop_angle_positive) * 500 + driver->speed * 5;
-            } else if (driver->angle < driver->pdata->endstop_angle_negative) {
-                external_torque = (driver->angle - driver->pdata->endstop_angle_negative) * 500 + driver->speed * 5;
-            }
-
-            double voltage = driver->voltage;
-            double torque = friction + external_torque;
-
-            // Get next state based on current state and input: x(k+1) = Ax(k) + Bu(k)
-            double angle_next = driver->angle +
-                driver->speed * m->d_angle_d_speed +
-                driver->current * m->d_angle_d_current +
-                voltage * m->d_angle_d_voltage +
-                torque * m->d_angle_d_torque;
-            double speed_next = 0 +
-                driver->speed * m->d_speed_d_speed +
-                driver->current * m->d_speed_d_current +
-                voltage * m->d_speed_d_voltage +
-                torque * m->d_speed_d_torque;
-            double current_next = 0 +
-                driver->speed * m->d_current_d_speed +
-                driver->current * m->d_current_d_current +
-                voltage * m->d_current_d_voltage +
-                torque * m->d_current_d_torque;
-
-            // Save new state.
-            driver->angle = angle_next;
-            driver->speed = speed_next;
-            driver->current = current_next;
-        }
+        simulation_step();
     }
 
     PBIO_OS_ASYNC_END(PBIO_ERROR_FAILED);
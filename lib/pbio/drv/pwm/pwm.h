@@ -6,6 +6,7 @@
 #ifndef _INTERNAL_PBDRV_PWM_H_
 #define _INTERNAL_PBDRV_PWM_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbdrv/config.h>
@@ -32,10 +33,12 @@ struct _pbdrv_pwm_dev_t {
 #if PBDRV_CONFIG_PWM
 
 void pbdrv_pwm_init(void);
+bool pbdrv_pwm_batch_is_active(void);
 
 #else // PBDRV_CONFIG_PWM
 
 #define pbdrv_pwm_init()
+#define pbdrv_pwm_batch_is_active() false
 
 #endif // PBDRV_CONFIG_PWM
 
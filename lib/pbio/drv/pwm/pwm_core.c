@@ -10,6 +10,7 @@
 
 #include <pbdrv/pwm.h>
 #include <pbio/error.h>
+#include <pbio/os.h>
 
 #include "pwm_stm32_tim.h"
 #include "pwm_test.h"
@@ -21,6 +22,11 @@
 
 static pbdrv_pwm_dev_t pbdrv_pwm_dev[PBDRV_CONFIG_PWM_NUM_DEV];
 
+/**
+ * Number of nested calls to pbdrv_pwm_batch_begin() that have not ended yet.
+ */
+static uint8_t pbdrv_pwm_batch_depth;
+
 /**
  * Initializes all PWM drivers.
  */
@@ -69,4 +75,35 @@ pbio_error_t pbdrv_pwm_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch, uint32_t valu
     return dev->funcs->set_duty(dev, ch, value);
 }
 
+/**
+ * Starts a batch of duty cycle changes.
+ *
+ * Drivers that send duty cycles to an external chip hold back changes until
+ * the batch ends, and then send all of them in one transfer. Batches may be
+ * nested. Each call must be followed by a call to pbdrv_pwm_batch_end().
+ */
+void pbdrv_pwm_batch_begin(void) {
+    pbdrv_pwm_batch_depth++;
+}
+
+/**
+ * Ends a batch of duty cycle changes started with pbdrv_pwm_batch_begin().
+ *
+ * When the outermost batch ends, drivers are polled to send the changes.
+ */
+void pbdrv_pwm_batch_end(void) {
+    if (pbdrv_pwm_batch_depth && --pbdrv_pwm_batch_depth == 0) {
+        pbio_os_request_poll();
+    }
+}
+
+/**
+ * Tests if duty cycle changes should be held back.
+ *
+ * @return              *true* if a batch is active, otherwise *false*.
+ */
+bool pbdrv_pwm_batch_is_active(void) {
+    return pbdrv_pwm_batch_depth > 0;
+}
+
 #endif // PBDRV_CONFIG_PWM
@@ -107,7 +107,9 @@ static pbio_error_t pbdrv_pwm_lp50xx_stm32_set_duty(pbdrv_pwm_dev_t *dev, uint32
     // (the data sheet says 12-bit PWM but the I2C registers are only 8-bit).
     priv->values[ch] = value >> 8;
     priv->changed = true;
-    pbio_os_request_poll();
+    if (!pbdrv_pwm_batch_is_active()) {
+        pbio_os_request_poll();
+    }
 
     return PBIO_SUCCESS;
 }
@@ -158,7 +160,7 @@ static pbio_error_t pbdrv_pwm_lp50xx_stm32_process_thread(pbio_os_state_t *state
     pbio_busy_count_down();
 
     for (;;) {
-        PBIO_OS_AWAIT_UNTIL(state, priv->changed);
+        PBIO_OS_AWAIT_UNTIL(state, priv->changed && !pbdrv_pwm_batch_is_active());
 
         static struct {
             uint8_t reg;
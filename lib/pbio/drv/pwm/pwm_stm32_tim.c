@@ -108,6 +108,17 @@ void pbdrv_pwm_stm32_tim_init(pbdrv_pwm_dev_t *devs) {
         TIMx->CCMR2 = ccmr2;
         TIMx->CCER = ccer;
 
+        // Like the duty cycle (OCxPE above), the period is buffered and only
+        // takes effect on the update event, so changes never truncate or
+        // stretch the pulse that is currently being generated.
+        TIMx->CR1 |= TIM_CR1_ARPE;
+
+        #if PBDRV_CONFIG_PWM_STM32_TIM_EXTRA_FLAGS
+        if (pdata->channels & PBDRV_PWM_STM32_TIM_CENTER_ALIGNED) {
+            TIMx->CR1 |= TIM_CR1_CMS_0;
+        }
+        #endif // PBDRV_CONFIG_PWM_STM32_TIM_EXTRA_FLAGS
+
         pdata->platform_init();
 
         TIMx->CR1 |= TIM_CR1_CEN;
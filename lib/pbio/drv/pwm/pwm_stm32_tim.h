@@ -31,6 +31,13 @@ typedef enum {
     PBDRV_PWM_STM32_TIM_CHANNEL_1_COMPLEMENT = 1 << 8,
     PBDRV_PWM_STM32_TIM_CHANNEL_2_COMPLEMENT = 1 << 9,
     PBDRV_PWM_STM32_TIM_CHANNEL_3_COMPLEMENT = 1 << 10,
+    /**
+     * Count up and down (center-aligned mode 1) instead of up only. Pulses of
+     * all channels are centered in the period, which lowers current ripple.
+     * The counter runs at twice the rate, so the prescalar must be halved to
+     * keep the same carrier frequency.
+     */
+    PBDRV_PWM_STM32_TIM_CENTER_ALIGNED = 1 << 11,
     #endif // PBDRV_CONFIG_PWM_STM32_TIM_EXTRA_FLAGS
 } pbdrv_pwm_stm32_tim_channel_t;
 
@@ -40,7 +47,7 @@ typedef struct {
     void (*platform_init)(void);
     /** The timer peripheral to use */
     TIM_TypeDef *TIMx;
-    /** Clock prescalar value. */
+    /** Clock prescalar value. Together with the period, this sets the carrier frequency. */
     uint16_t prescalar;
     /** Period in terms of counts. */
     uint16_t period;
@@ -155,7 +155,9 @@ static pbio_error_t pbdrv_pwm_tlc5955_stm32_set_duty(pbdrv_pwm_dev_t *dev, uint3
     priv->grayscale_latch[ch * 2 + 1] = value >> 8;
     priv->grayscale_latch[ch * 2 + 2] = value;
     priv->changed = true;
-    pbio_os_request_poll();
+    if (!pbdrv_pwm_batch_is_active()) {
+        pbio_os_request_poll();
+    }
 
     return PBIO_SUCCESS;
 }
@@ -194,7 +196,7 @@ static pbio_error_t pbdrv_pwm_tlc5955_stm32_process_thread(pbio_os_state_t *stat
     pbio_busy_count_down();
 
     for (;;) {
-        PBIO_OS_AWAIT_UNTIL(state, priv->changed);
+        PBIO_OS_AWAIT_UNTIL(state, priv->changed && !pbdrv_pwm_batch_is_active());
         HAL_SPI_Transmit_DMA(&priv->hspi, priv->grayscale_latch, TLC5955_DATA_SIZE);
         priv->changed = false;
         PBIO_OS_AWAIT_UNTIL(state, priv->hspi.State == HAL_SPI_STATE_READY);
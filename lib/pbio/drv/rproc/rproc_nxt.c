@@ -16,6 +16,7 @@
 
 #include <at91sam7s256.h>
 
+#include <pbdrv/clock.h>
 #include <pbdrv/compiler.h>
 #include <pbdrv/reset.h>
 
@@ -34,6 +35,18 @@
 #define AVR_ADDRESS 1
 #define AVR_MAX_FAILED_CHECKSUMS 3
 
+/**
+ * Time between messages, which the AVR needs to run its own code. The AVR
+ * firmware handles at most one message per millisecond.
+ */
+#define AVR_GRACE_TIME_MS 1
+
+/**
+ * Unchanged commands are sent only once every this many cycles, so the AVR
+ * still knows that we are alive.
+ */
+#define AVR_KEEPALIVE_CYCLES 10
+
 /**
  * Commands that are periodically sent to the AVR.
  */
@@ -79,6 +92,35 @@ static struct PBDRV_PACKED {
  *
  * All data including the checksum should add up to 0xFF.
  */
+/**
+ * Time at which the oldest command that was not yet sent was changed, in us.
+ */
+static uint32_t pbdrv_rproc_nxt_changed_time;
+
+/**
+ * Time from changing a command until it was sent to the AVR, in us.
+ */
+static uint32_t pbdrv_rproc_nxt_latency;
+
+/**
+ * Highest value of ::pbdrv_rproc_nxt_latency since boot, in us.
+ */
+static uint32_t pbdrv_rproc_nxt_latency_max;
+
+static pbio_os_process_t pbdrv_rproc_nxt_link_process;
+
+/**
+ * Marks the commands as changed, so they are sent to the AVR in the next
+ * cycle of the link.
+ */
+static void pbdrv_rproc_nxt_set_changed(void) {
+    if (!pbdrv_rproc_nxt_send_data.changed) {
+        pbdrv_rproc_nxt_send_data.changed = true;
+        pbdrv_rproc_nxt_changed_time = pbdrv_clock_get_us();
+    }
+    pbio_os_process_request_poll(&pbdrv_rproc_nxt_link_process);
+}
+
 static uint8_t pbdrv_rproc_nxt_get_checksum(uint8_t *data, size_t len) {
     uint8_t checksum = 0;
     for (size_t i = 0; i < len; i++) {
@@ -87,14 +129,14 @@ static uint8_t pbdrv_rproc_nxt_get_checksum(uint8_t *data, size_t len) {
     return ~checksum;
 }
 
-static pbio_os_process_t pbdrv_rproc_nxt_link_process;
-
 static pbio_error_t pbdrv_rproc_nxt_link_process_thread(pbio_os_state_t *state, void *context) {
 
     static pbio_os_timer_t timer;
 
     static uint32_t failed_checksums = 0;
 
+    static uint32_t keepalive;
+
     PBIO_OS_ASYNC_BEGIN(state)
 
     for (;;) {
@@ -112,28 +154,45 @@ static pbio_error_t pbdrv_rproc_nxt_link_process_thread(pbio_os_state_t *state,
         // Note that the TWI driver is not polling the event loop, so we are in
         // effect only checking nx__twi_ready once per millisecond
         // This is fine because of the grace period we add in anyway.
-        pbio_os_timer_set(&timer, 2);
+        pbio_os_timer_set(&timer, AVR_GRACE_TIME_MS);
+        keepalive = 0;
 
         while (failed_checksums < AVR_MAX_FAILED_CHECKSUMS) {
 
-            // Allow processing on AVR.
-            PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
-            pbio_os_timer_extend(&timer);
-
             // Double buffer command to send to AVR.
             static uint8_t send_buf[sizeof(pbdrv_rproc_nxt_send_data)];
 
-            // Copy data and set checksum if changed.
-            if (pbdrv_rproc_nxt_send_data.changed) {
-                pbdrv_rproc_nxt_send_data.changed = false;
-
-                memcpy(send_buf, &pbdrv_rproc_nxt_send_data, sizeof(send_buf) - 1);
-                send_buf[sizeof(send_buf) - 1] = pbdrv_rproc_nxt_get_checksum(send_buf, sizeof(send_buf) - 1);
+            // Send commands only if they changed, apart from a keepalive
+            // message now and then. Reading the AVR state is done every cycle.
+            if (pbdrv_rproc_nxt_send_data.changed || ++keepalive >= AVR_KEEPALIVE_CYCLES) {
+                keepalive = 0;
+
+                // Allow processing on AVR.
+                PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
+                pbio_os_timer_extend(&timer);
+
+                // Copy data and set checksum if changed.
+                static bool sending_change;
+                sending_change = pbdrv_rproc_nxt_send_data.changed;
+                if (sending_change) {
+                    pbdrv_rproc_nxt_send_data.changed = false;
+
+                    memcpy(send_buf, &pbdrv_rproc_nxt_send_data, sizeof(send_buf) - 1);
+                    send_buf[sizeof(send_buf) - 1] = pbdrv_rproc_nxt_get_checksum(send_buf, sizeof(send_buf) - 1);
+                }
+
+                nx__twi_write_async(AVR_ADDRESS, send_buf, sizeof(send_buf));
+                PBIO_OS_AWAIT_UNTIL(state, nx__twi_ready());
+
+                // Keep track of how long it took for the change to be sent.
+                if (sending_change) {
+                    pbdrv_rproc_nxt_latency = pbdrv_clock_get_us() - pbdrv_rproc_nxt_changed_time;
+                    if (pbdrv_rproc_nxt_latency > pbdrv_rproc_nxt_latency_max) {
+                        pbdrv_rproc_nxt_latency_max = pbdrv_rproc_nxt_latency;
+                    }
+                }
             }
 
-            nx__twi_write_async(AVR_ADDRESS, send_buf, sizeof(send_buf));
-            PBIO_OS_AWAIT_UNTIL(state, nx__twi_ready());
-
             // Allow processing on AVR.
             PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
             pbio_os_timer_extend(&timer);
@@ -170,15 +229,24 @@ pbio_error_t pbdrv_rproc_nxt_set_duty_cycle(uint8_t index, int32_t duty_cycle_pe
         return PBIO_ERROR_INVALID_ARG;
     }
 
-    pbdrv_rproc_nxt_send_data.motor_duty_cycle[index] = pbio_int_math_clamp(duty_cycle_percent, 100);
-
+    int8_t duty_cycle = pbio_int_math_clamp(duty_cycle_percent, 100);
+    uint8_t decay_mode = pbdrv_rproc_nxt_send_data.motor_decay_mode;
     if (slow_decay) {
-        pbdrv_rproc_nxt_send_data.motor_decay_mode |= (1 << index);
+        decay_mode |= (1 << index);
     } else {
-        pbdrv_rproc_nxt_send_data.motor_decay_mode &= ~(1 << index);
+        decay_mode &= ~(1 << index);
     }
 
-    pbdrv_rproc_nxt_send_data.changed = true;
+    // The motor control loop sets the same value most of the time, so only
+    // send it if it changed.
+    if (duty_cycle == pbdrv_rproc_nxt_send_data.motor_duty_cycle[index] &&
+        decay_mode == pbdrv_rproc_nxt_send_data.motor_decay_mode) {
+        return PBIO_SUCCESS;
+    }
+
+    pbdrv_rproc_nxt_send_data.motor_duty_cycle[index] = duty_cycle;
+    pbdrv_rproc_nxt_send_data.motor_decay_mode = decay_mode;
+    pbdrv_rproc_nxt_set_changed();
     return PBIO_SUCCESS;
 }
 
@@ -197,12 +265,17 @@ pbio_error_t pbdrv_rproc_nxt_set_sensor_power(uint8_t index, pbdrv_rproc_nxt_sen
     }
 
     // Clear the two bits for this input (first port has bits 0 and 4).
-    pbdrv_rproc_nxt_send_data.sensor_power &= ~((0x11) << index);
+    uint8_t sensor_power = pbdrv_rproc_nxt_send_data.sensor_power & ~((0x11) << index);
 
     // Set the new value.
-    pbdrv_rproc_nxt_send_data.sensor_power |= (power_type << index);
+    sensor_power |= (power_type << index);
 
-    pbdrv_rproc_nxt_send_data.changed = true;
+    if (sensor_power == pbdrv_rproc_nxt_send_data.sensor_power) {
+        return PBIO_SUCCESS;
+    }
+
+    pbdrv_rproc_nxt_send_data.sensor_power = sensor_power;
+    pbdrv_rproc_nxt_set_changed();
     return PBIO_SUCCESS;
 }
 
@@ -247,6 +320,18 @@ pbio_error_t pbdrv_rproc_nxt_get_sensor_adc(uint8_t index, uint16_t *value) {
     return PBIO_SUCCESS;
 }
 
+/**
+ * Gets the time from changing a motor duty cycle or sensor power setting until
+ * it was sent to the AVR.
+ *
+ * @param [out] latency     Latency of the most recent change, in microseconds.
+ * @param [out] latency_max Highest latency since boot, in microseconds.
+ */
+void pbdrv_rproc_nxt_get_latency(uint32_t *latency, uint32_t *latency_max) {
+    *latency = pbdrv_rproc_nxt_latency;
+    *latency_max = pbdrv_rproc_nxt_latency_max;
+}
+
 /**
  * Gets battery information from the AVR.
  *
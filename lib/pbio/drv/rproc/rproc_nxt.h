@@ -30,4 +30,6 @@ bool pbdrv_rproc_nxt_get_battery_info(uint16_t *voltage);
 
 pbio_error_t pbdrv_rproc_nxt_get_sensor_adc(uint8_t index, uint16_t *value);
 
+void pbdrv_rproc_nxt_get_latency(uint32_t *latency, uint32_t *latency_max);
+
 #endif // _INTERNAL_PBDRV_RPROC_NXT_H_
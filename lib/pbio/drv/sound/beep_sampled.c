@@ -7,39 +7,91 @@
 
 #if PBDRV_CONFIG_SOUND_BEEP_SAMPLED
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include <pbdrv/sound.h>
 #include <pbio/util.h>
 
-static uint16_t waveform_data[128];
+#define NUM_SAMPLES (128)
 
-static void pbdrv_sound_generate_square_wave(uint16_t sample_attenuator) {
-    uint16_t lo_amplitude_value = INT16_MAX - sample_attenuator;
-    uint16_t hi_amplitude_value = sample_attenuator + INT16_MAX;
+// Number of waveforms kept. A new waveform is generated in a buffer that is
+// not playing, so the sound that is playing is not disturbed.
+#define NUM_WAVEFORMS (2)
 
-    size_t i = 0;
-    for (; i < PBIO_ARRAY_SIZE(waveform_data) / 2; i++) {
-        waveform_data[i] = lo_amplitude_value;
+static struct {
+    uint16_t data[NUM_SAMPLES];
+    pbdrv_beep_waveform_t waveform;
+    uint16_t sample_attenuator;
+    bool valid;
+} waveforms[NUM_WAVEFORMS];
+
+// Index of the waveform that was started last.
+static uint8_t waveform_playing;
+
+// First quarter of a sine wave, including the peak.
+static const uint16_t sine_quarter[NUM_SAMPLES / 4 + 1] = {
+    0, 1608, 3212, 4808, 6393, 7962, 9512, 11039,
+    12539, 14010, 15446, 16846, 18204, 19519, 20787, 22005,
+    23170, 24279, 25329, 26319, 27245, 28105, 28898, 29621,
+    30273, 30852, 31356, 31785, 32137, 32412, 32609, 32728,
+    32767,
+};
+
+// Gets one sample of a full scale wave, from -INT16_MAX to INT16_MAX.
+static int32_t pbdrv_sound_get_wave_sample(pbdrv_beep_waveform_t waveform, size_t i) {
+    const size_t half = NUM_SAMPLES / 2;
+    const size_t quarter = NUM_SAMPLES / 4;
+
+    switch (waveform) {
+        case PBDRV_BEEP_WAVEFORM_SINE: {
+            size_t k = i % quarter;
+            int32_t value = (i / quarter) % 2 ? sine_quarter[quarter - k] : sine_quarter[k];
+            return i < half ? value : -value;
+        }
+        case PBDRV_BEEP_WAVEFORM_TRIANGLE:
+            if (i < half) {
+                return -INT16_MAX + (int32_t)(2 * INT16_MAX * i / half);
+            }
+            return INT16_MAX - (int32_t)(2 * INT16_MAX * (i - half) / half);
+        default:
+            return i < half ? -INT16_MAX : INT16_MAX;
     }
-    for (; i < PBIO_ARRAY_SIZE(waveform_data); i++) {
-        waveform_data[i] = hi_amplitude_value;
+}
+
+static void pbdrv_sound_generate_wave(uint16_t *data, pbdrv_beep_waveform_t waveform, uint16_t sample_attenuator) {
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        data[i] = INT16_MAX + pbdrv_sound_get_wave_sample(waveform, i) * sample_attenuator / INT16_MAX;
     }
 }
 
-// For 0 frequencies that are just flat lines.
-static void pbdrv_sound_generate_line_wave(void) {
-    for (size_t i = 0; i < PBIO_ARRAY_SIZE(waveform_data); i++) {
-        waveform_data[i] = INT16_MAX;
+// Gets samples for the waveform, generating them only if they are not kept.
+static const uint16_t *pbdrv_sound_get_waveform(pbdrv_beep_waveform_t waveform, uint16_t sample_attenuator) {
+    for (uint8_t i = 0; i < NUM_WAVEFORMS; i++) {
+        if (waveforms[i].valid && waveforms[i].waveform == waveform && waveforms[i].sample_attenuator == sample_attenuator) {
+            waveform_playing = i;
+            return waveforms[i].data;
+        }
     }
+
+    waveform_playing = (waveform_playing + 1) % NUM_WAVEFORMS;
+    pbdrv_sound_generate_wave(waveforms[waveform_playing].data, waveform, sample_attenuator);
+    waveforms[waveform_playing].waveform = waveform;
+    waveforms[waveform_playing].sample_attenuator = sample_attenuator;
+    waveforms[waveform_playing].valid = true;
+    return waveforms[waveform_playing].data;
 }
 
-void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator) {
+void pbdrv_beep_start_waveform(uint32_t frequency, uint16_t sample_attenuator, pbdrv_beep_waveform_t waveform) {
+    if (sample_attenuator > INT16_MAX) {
+        sample_attenuator = INT16_MAX;
+    }
+
+    // For 0 frequencies that are just flat lines.
     if (frequency == 0) {
-        pbdrv_sound_generate_line_wave();
-    } else {
-        pbdrv_sound_generate_square_wave(sample_attenuator);
+        waveform = PBDRV_BEEP_WAVEFORM_SQUARE;
+        sample_attenuator = 0;
     }
 
     if (frequency < 64) {
@@ -49,7 +101,11 @@ void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator) {
         frequency = 24000;
     }
 
-    pbdrv_sound_start(&waveform_data[0], PBIO_ARRAY_SIZE(waveform_data), frequency * PBIO_ARRAY_SIZE(waveform_data));
+    pbdrv_sound_start(pbdrv_sound_get_waveform(waveform, sample_attenuator), NUM_SAMPLES, frequency * NUM_SAMPLES);
+}
+
+void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator) {
+    pbdrv_beep_start_waveform(frequency, sample_attenuator, PBDRV_BEEP_WAVEFORM_SQUARE);
 }
 
 #endif
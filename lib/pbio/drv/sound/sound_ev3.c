@@ -6,15 +6,24 @@
 #if PBDRV_CONFIG_SOUND_EV3
 
 #include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <pbdrv/cache.h>
 #include <pbdrv/gpio.h>
+#include <pbdrv/sound.h>
 
 #include <tiam1808/ehrpwm.h>
+#include <tiam1808/edma.h>
 #include <tiam1808/hw/soc_AM1808.h>
+#include <tiam1808/hw/hw_edma3cc.h>
+#include <tiam1808/hw/hw_ehrpwm.h>
 #include <tiam1808/hw/hw_syscfg0_AM1808.h>
 #include <tiam1808/hw/hw_types.h>
+#include <tiam1808/armv5/am1808/edma_event.h>
+#include <tiam1808/armv5/am1808/interrupt.h>
 #include <tiam1808/psc.h>
+#include <tiam1808/timer.h>
 
 #include "../drv/gpio/gpio_ev3.h"
 
@@ -34,7 +43,174 @@ static const pbdrv_gpio_t pin_sound_en = PBDRV_GPIO_EV3_PIN(13, 3, 0, 6, 15);
 #define SYSCFG_PINMUX3_PINMUX3_7_4_GPIO0_0 0
 static const pbdrv_gpio_t pin_audio = PBDRV_GPIO_EV3_PIN(3, 7, 4, 0, 0);
 
+#if PBDRV_CONFIG_SOUND_STREAM
+
+// Sampled sound reuses the same PWM output with a fixed carrier of about
+// 73 kHz, well above the audible range. The EHRPWM cannot request DMA, so
+// Timer64P2 (TIMER34) raises an EDMA3_1 event at the sample rate, and each
+// event copies one sample into the CMPB shadow register. The PWM loads it
+// at the start of the next carrier period.
+
+// Carrier period in timebase counts, giving 11 bits of resolution.
+#define PCM_PWM_PERIOD (2048)
+
+// Number of bits to drop from 16-bit samples to fit the carrier period.
+#define PCM_SAMPLE_SHIFT (5)
+
+// Number of samples in each half of the stream buffer.
+#define PCM_HALF_LENGTH (256)
+
+// Timer64P2 event on EDMA3_1. Channel and completion code are the same.
+#define PCM_DMA_CHANNEL EDMA3_CHA_TIMER64P2_EVT34
+
+// PaRAM sets that the channel links to, one for each half of the buffer.
+#define PCM_DMA_PARAM_HALF_0 (64)
+#define PCM_DMA_PARAM_HALF_1 (65)
+
+// EDMA3_1 channel controller completion interrupt, which is missing from the
+// interrupt.h header.
+#define SYS_INT_EDMA3_1_CC0_INT0 (93)
+
+// Stream buffer played in a loop by the DMA. Each half is refilled while the
+// other half is being played.
+static uint16_t pcm_buffer[2][PCM_HALF_LENGTH] PBDRV_DMA_BUF;
+
+static struct {
+    // Function that fills the next samples, or NULL if not streaming.
+    pbdrv_sound_stream_fill_t fill;
+    // Context passed to the fill function.
+    void *context;
+    // Number of halves filled with silence since the stream ended.
+    volatile uint8_t silent_halves;
+    // Whether the fill function reached the end of the stream.
+    bool ending;
+    // Half that is played next, and refilled when that completes.
+    uint8_t half;
+} pcm_stream;
+
+static void pcm_stream_refill(uint32_t half) {
+    uint16_t *samples = pcm_buffer[half];
+    uint32_t count = 0;
+
+    if (!pcm_stream.fill) {
+        return;
+    }
+
+    if (!pcm_stream.ending) {
+        count = pcm_stream.fill(pcm_stream.context, samples, PCM_HALF_LENGTH);
+        pcm_stream.ending = count < PCM_HALF_LENGTH;
+    } else if (pcm_stream.silent_halves < 2) {
+        // The last samples are played once both halves have been refilled
+        // with silence after the end.
+        pcm_stream.silent_halves++;
+    }
+
+    for (; count < PCM_HALF_LENGTH; count++) {
+        samples[count] = INT16_MAX;
+    }
+
+    // Scale to the duty cycle in place, so the DMA copies values as is.
+    for (uint32_t i = 0; i < PCM_HALF_LENGTH; i++) {
+        samples[i] >>= PCM_SAMPLE_SHIFT;
+    }
+
+    pbdrv_cache_prepare_before_dma(samples, sizeof(pcm_buffer[half]));
+}
+
+static void pcm_set_param(uint32_t param, uint32_t half, uint32_t link) {
+    // Parameter object must be volatile since it is copied byte-by-byte in the
+    // TI API, causing it to be optimized out.
+    volatile EDMA3CCPaRAMEntry paramSet = {
+        // Samples in this half of the buffer.
+        .srcAddr = (uint32_t)pcm_buffer[half],
+        // Every sample goes to the same compare register.
+        .destAddr = SOC_EHRPWM_0_REGS + EHRPWM_CMPB,
+        // One sample per event.
+        .aCnt = sizeof(uint16_t),
+        .bCnt = PCM_HALF_LENGTH,
+        .cCnt = 1,
+        .srcBIdx = sizeof(uint16_t),
+        .destBIdx = 0,
+        .srcCIdx = 0,
+        .destCIdx = 0,
+        // Continue with the other half when done.
+        .linkAddr = EDMA3CC_OPT(link) & 0xFFFF,
+        .bCntReload = PCM_HALF_LENGTH,
+        .opt = (
+            // Transfer completion code.
+            ((PCM_DMA_CHANNEL << EDMA3CC_OPT_TCC_SHIFT) & EDMA3CC_OPT_TCC) |
+            // Interrupt when the whole half has been played.
+            (1 << EDMA3CC_OPT_TCINTEN_SHIFT)
+            ),
+    };
+    EDMA3SetPaRAM(SOC_EDMA31CC_0_REGS, param, (EDMA3CCPaRAMEntry *)&paramSet);
+}
+
+static void pcm_dma_complete_isr(void) {
+    IntSystemStatusClear(SYS_INT_EDMA3_1_CC0_INT0);
+    if (EDMA3GetIntrStatus(SOC_EDMA31CC_0_REGS) & (1 << PCM_DMA_CHANNEL)) {
+        EDMA3ClrIntr(SOC_EDMA31CC_0_REGS, PCM_DMA_CHANNEL);
+        // The DMA has moved on to the other half, so this one can be refilled.
+        pcm_stream_refill(pcm_stream.half);
+        pcm_stream.half ^= 1;
+    }
+}
+
+static void pcm_stream_stop(void) {
+    TimerDisable(SOC_TMR_2_REGS, TMR_TIMER34);
+    EDMA3DisableTransfer(SOC_EDMA31CC_0_REGS, PCM_DMA_CHANNEL, EDMA3_TRIG_MODE_EVENT);
+    EDMA3ClrEvt(SOC_EDMA31CC_0_REGS, PCM_DMA_CHANNEL);
+    pcm_stream.fill = NULL;
+}
+
+void pbdrv_sound_stream_start(pbdrv_sound_stream_fill_t fill, void *context, uint32_t sample_rate) {
+    pbdrv_sound_stop();
+
+    if (sample_rate == 0) {
+        return;
+    }
+
+    pbdrv_gpio_out_high(&pin_sound_en);
+
+    pcm_stream.fill = fill;
+    pcm_stream.context = context;
+    pcm_stream.silent_halves = 0;
+    pcm_stream.ending = false;
+    pcm_stream.half = 0;
+    pcm_stream_refill(0);
+    pcm_stream_refill(1);
+
+    // The channel plays half 0 first, then the linked sets alternate.
+    pcm_set_param(PCM_DMA_CHANNEL, 0, PCM_DMA_PARAM_HALF_1);
+    pcm_set_param(PCM_DMA_PARAM_HALF_0, 0, PCM_DMA_PARAM_HALF_1);
+    pcm_set_param(PCM_DMA_PARAM_HALF_1, 1, PCM_DMA_PARAM_HALF_0);
+    EDMA3EnableTransfer(SOC_EDMA31CC_0_REGS, PCM_DMA_CHANNEL, EDMA3_TRIG_MODE_EVENT);
+
+    // Carrier at full timebase speed, starting at silence.
+    HWREGH(SOC_EHRPWM_0_REGS + EHRPWM_TBCTL) = (HWREGH(SOC_EHRPWM_0_REGS + EHRPWM_TBCTL) &
+        ~(EHRPWM_TBCTL_CLKDIV | EHRPWM_TBCTL_HSPCLKDIV)) |
+        (EHRPWM_TBCTL_CLKDIV_DIVBY1 << EHRPWM_TBCTL_CLKDIV_SHIFT) |
+        (EHRPWM_TBCTL_HSPCLKDIV_DIVBY1 << EHRPWM_TBCTL_HSPCLKDIV_SHIFT);
+    EHRPWMLoadCMPB(SOC_EHRPWM_0_REGS, INT16_MAX >> PCM_SAMPLE_SHIFT, true, 0, true);
+    EHRPWMPWMOpPeriodSet(SOC_EHRPWM_0_REGS, PCM_PWM_PERIOD - 1, EHRPWM_COUNT_UP, true);
+    EHRPWMAQContSWForceOnB(SOC_EHRPWM_0_REGS, 0, EHRPWM_AQSFRC_RLDCSF_IMMEDIATE);
+
+    // Start pacing the DMA at the sample rate.
+    TimerCounterSet(SOC_TMR_2_REGS, TMR_TIMER34, 0);
+    TimerPeriodSet(SOC_TMR_2_REGS, TMR_TIMER34, SOC_SYSCLK_2_FREQ / sample_rate - 1);
+    TimerEnable(SOC_TMR_2_REGS, TMR_TIMER34, TMR_ENABLE_CONT);
+}
+
+bool pbdrv_sound_stream_is_done(void) {
+    return !pcm_stream.fill || pcm_stream.silent_halves >= 2;
+}
+
+#endif // PBDRV_CONFIG_SOUND_STREAM
+
 void pbdrv_sound_stop() {
+    #if PBDRV_CONFIG_SOUND_STREAM
+    pcm_stream_stop();
+    #endif
     // Force the output low
     EHRPWMAQContSWForceOnB(SOC_EHRPWM_0_REGS, EHRPWM_AQCSFRC_CSFB_LOW, EHRPWM_AQSFRC_RLDCSF_IMMEDIATE);
     // Clean up counter
@@ -49,6 +225,10 @@ void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator) {
         return;
     }
 
+    #if PBDRV_CONFIG_SOUND_STREAM
+    pcm_stream_stop();
+    #endif
+
     // Turn speaker amplifier on
     // We turn the amplifier on and leave it turned on, because otherwise
     // it will generate a popping sound each time it is enabled.
@@ -137,6 +317,21 @@ void pbdrv_sound_init() {
 
     // Configure IO pin mode
     pbdrv_gpio_alt(&pin_audio, SYSCFG_PINMUX3_PINMUX3_7_4_EPWM0B);
+
+    #if PBDRV_CONFIG_SOUND_STREAM
+    // Timer34 of Timer64P2 paces the samples. Timer12 is used by the PRU,
+    // which configures the timer as two unchained halves.
+    TimerIntEnable(SOC_TMR_2_REGS, TMR_INT_TMR34_NON_CAPT_MODE);
+
+    // The second channel controller is only used for sound.
+    PSCModuleControl(SOC_PSC_1_REGS, HW_PSC_CC1, PSC_POWERDOMAIN_ALWAYS_ON, PSC_MDCTL_NEXT_ENABLE);
+    PSCModuleControl(SOC_PSC_1_REGS, HW_PSC_TC2, PSC_POWERDOMAIN_ALWAYS_ON, PSC_MDCTL_NEXT_ENABLE);
+    EDMA3Init(SOC_EDMA31CC_0_REGS, 0);
+    EDMA3RequestChannel(SOC_EDMA31CC_0_REGS, EDMA3_CHANNEL_TYPE_DMA, PCM_DMA_CHANNEL, PCM_DMA_CHANNEL, 0);
+    IntRegister(SYS_INT_EDMA3_1_CC0_INT0, pcm_dma_complete_isr);
+    IntChannelSet(SYS_INT_EDMA3_1_CC0_INT0, 2);
+    IntSystemEnable(SYS_INT_EDMA3_1_CC0_INT0);
+    #endif
 }
 
 #endif // PBDRV_CONFIG_SOUND_EV3
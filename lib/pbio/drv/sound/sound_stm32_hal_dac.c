@@ -7,8 +7,11 @@
 
 #if PBDRV_CONFIG_SOUND_STM32_HAL_DAC
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <pbdrv/sound.h>
+
 #include "sound_stm32_hal_dac.h"
 
 #include STM32_HAL_H
@@ -17,6 +20,75 @@ static DMA_HandleTypeDef pbdrv_sound_hdma;
 static DAC_HandleTypeDef pbdrv_sound_hdac;
 static TIM_HandleTypeDef pbdrv_sound_htim;
 
+#if PBDRV_CONFIG_SOUND_STREAM
+
+/**
+ * Number of samples in each half of the stream buffer.
+ */
+#define PBDRV_SOUND_STREAM_HALF_LENGTH (256)
+
+/**
+ * Stream buffer played in a loop by the DMA. Each half is refilled while the
+ * other half is being played.
+ */
+static uint16_t pbdrv_sound_stream_buffer[2][PBDRV_SOUND_STREAM_HALF_LENGTH];
+
+static struct {
+    /** Function that fills the next samples, or NULL if not streaming. */
+    pbdrv_sound_stream_fill_t fill;
+    /** Context passed to the fill function. */
+    void *context;
+    /** Number of halves filled with silence since the stream ended. */
+    volatile uint8_t silent_halves;
+    /** Whether the fill function reached the end of the stream. */
+    bool ending;
+} pbdrv_sound_stream;
+
+/**
+ * Refills half of the stream buffer after it has been played.
+ *
+ * @param [in]  half    Index of the half to refill.
+ */
+static void pbdrv_sound_stream_refill(uint32_t half) {
+    uint16_t *samples = pbdrv_sound_stream_buffer[half];
+    uint32_t count = 0;
+
+    if (!pbdrv_sound_stream.fill) {
+        return;
+    }
+
+    if (!pbdrv_sound_stream.ending) {
+        count = pbdrv_sound_stream.fill(pbdrv_sound_stream.context, samples, PBDRV_SOUND_STREAM_HALF_LENGTH);
+        pbdrv_sound_stream.ending = count < PBDRV_SOUND_STREAM_HALF_LENGTH;
+    } else if (pbdrv_sound_stream.silent_halves < 2) {
+        // The last samples are played once both halves have been refilled
+        // with silence after the end.
+        pbdrv_sound_stream.silent_halves++;
+    }
+
+    for (; count < PBDRV_SOUND_STREAM_HALF_LENGTH; count++) {
+        samples[count] = INT16_MAX;
+    }
+}
+
+void HAL_DAC_ConvHalfCpltCallbackCh1(DAC_HandleTypeDef *hdac) {
+    pbdrv_sound_stream_refill(0);
+}
+
+void HAL_DAC_ConvCpltCallbackCh1(DAC_HandleTypeDef *hdac) {
+    pbdrv_sound_stream_refill(1);
+}
+
+void HAL_DACEx_ConvHalfCpltCallbackCh2(DAC_HandleTypeDef *hdac) {
+    pbdrv_sound_stream_refill(0);
+}
+
+void HAL_DACEx_ConvCpltCallbackCh2(DAC_HandleTypeDef *hdac) {
+    pbdrv_sound_stream_refill(1);
+}
+
+#endif // PBDRV_CONFIG_SOUND_STREAM
+
 void pbdrv_sound_init(void) {
     const pbdrv_sound_stm32_hal_dac_platform_data_t *pdata = &pbdrv_sound_stm32_hal_dac_platform_data;
 
@@ -74,6 +146,10 @@ void pbdrv_sound_init(void) {
 void pbdrv_sound_start(const uint16_t *data, uint32_t length, uint32_t sample_rate) {
     const pbdrv_sound_stm32_hal_dac_platform_data_t *pdata = &pbdrv_sound_stm32_hal_dac_platform_data;
 
+    #if PBDRV_CONFIG_SOUND_STREAM
+    pbdrv_sound_stream.fill = NULL;
+    #endif
+
     HAL_GPIO_WritePin(pdata->enable_gpio_bank, pdata->enable_gpio_pin, GPIO_PIN_SET);
     pbdrv_sound_htim.Init.Period = pdata->tim_clock_rate / sample_rate - 1;
     HAL_TIM_Base_Init(&pbdrv_sound_htim);
@@ -85,8 +161,40 @@ void pbdrv_sound_stop(void) {
 
     HAL_GPIO_WritePin(pdata->enable_gpio_bank, pdata->enable_gpio_pin, GPIO_PIN_RESET);
     HAL_DAC_Stop_DMA(&pbdrv_sound_hdac, pdata->dac_ch);
+
+    #if PBDRV_CONFIG_SOUND_STREAM
+    pbdrv_sound_stream.fill = NULL;
+    #endif
+}
+
+#if PBDRV_CONFIG_SOUND_STREAM
+
+void pbdrv_sound_stream_start(pbdrv_sound_stream_fill_t fill, void *context, uint32_t sample_rate) {
+    const pbdrv_sound_stm32_hal_dac_platform_data_t *pdata = &pbdrv_sound_stm32_hal_dac_platform_data;
+
+    // Stop the DMA first, so the callbacks don't run while starting.
+    HAL_DAC_Stop_DMA(&pbdrv_sound_hdac, pdata->dac_ch);
+
+    pbdrv_sound_stream.fill = fill;
+    pbdrv_sound_stream.context = context;
+    pbdrv_sound_stream.silent_halves = 0;
+    pbdrv_sound_stream.ending = false;
+    pbdrv_sound_stream_refill(0);
+    pbdrv_sound_stream_refill(1);
+
+    HAL_GPIO_WritePin(pdata->enable_gpio_bank, pdata->enable_gpio_pin, GPIO_PIN_SET);
+    pbdrv_sound_htim.Init.Period = pdata->tim_clock_rate / sample_rate - 1;
+    HAL_TIM_Base_Init(&pbdrv_sound_htim);
+    HAL_DAC_Start_DMA(&pbdrv_sound_hdac, pdata->dac_ch, (uint32_t *)pbdrv_sound_stream_buffer,
+        sizeof(pbdrv_sound_stream_buffer) / sizeof(uint16_t), DAC_ALIGN_12B_L);
 }
 
+bool pbdrv_sound_stream_is_done(void) {
+    return !pbdrv_sound_stream.fill || pbdrv_sound_stream.silent_halves >= 2;
+}
+
+#endif // PBDRV_CONFIG_SOUND_STREAM
+
 void pbdrv_sound_stm32_hal_dac_handle_dma_irq(void) {
     HAL_DMA_IRQHandler(&pbdrv_sound_hdma);
 }
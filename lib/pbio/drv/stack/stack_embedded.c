@@ -5,8 +5,19 @@
 
 #if PBDRV_CONFIG_STACK_EMBEDDED
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <pbdrv/stack.h>
+
+// Value written to unused stack words. Unlikely to be a valid pointer or a
+// common small integer, so it is rarely written by accident.
+#define PAINT_PATTERN (0xDEADBEEF)
+
+// Space left unpainted below the current frame, for the painting loop itself
+// and anything the compiler turns it into.
+#define PAINT_MARGIN (256)
+
 void pbdrv_stack_get_info(char **stack_start, char **stack_end) {
     // Defined in linker script.
     extern uint32_t pbdrv_stack_end;
@@ -15,4 +26,29 @@ void pbdrv_stack_get_info(char **stack_start, char **stack_end) {
     *stack_end = (char *)&pbdrv_stack_end;
 }
 
+void pbdrv_stack_paint(void) {
+    char *stack_start;
+    char *stack_end;
+    pbdrv_stack_get_info(&stack_start, &stack_end);
+
+    // The stack grows down, so everything below the current frame is unused.
+    volatile uint32_t *word = (uint32_t *)stack_start;
+    uint32_t *end = (uint32_t *)((char *)__builtin_frame_address(0) - PAINT_MARGIN);
+    while (word < end) {
+        *word++ = PAINT_PATTERN;
+    }
+}
+
+size_t pbdrv_stack_get_max_usage(void) {
+    char *stack_start;
+    char *stack_end;
+    pbdrv_stack_get_info(&stack_start, &stack_end);
+
+    const uint32_t *word = (const uint32_t *)stack_start;
+    while ((char *)word < stack_end && *word == PAINT_PATTERN) {
+        word++;
+    }
+    return stack_end - (char *)word;
+}
+
 #endif // PBDRV_CONFIG_STACK_EMBEDDED
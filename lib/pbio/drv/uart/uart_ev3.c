@@ -19,6 +19,7 @@
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
 #include <pbio/os.h>
+#include <pbio/tracepoint.h>
 #include <pbio/util.h>
 
 #include "./uart_ev3.h"
@@ -43,7 +44,7 @@
  * functions to use.
  */
 
-#define RX_DATA_SIZE 256
+#define RX_DATA_SIZE PBDRV_CONFIG_UART_EV3_RX_BUF_SIZE
 
 struct _pbdrv_uart_dev_t {
     /** Platform-specific data */
@@ -321,6 +322,7 @@ void pbdrv_uart_ev3_handle_irq(uint8_t id) {
     } else {
         pbdrv_uart_ev3_pru_handle_irq(uart);
     }
+    pbio_tracepoint_record(PBIO_TRACEPOINT_UART_RX, id, lwrb_get_full(&uart->rx_buf));
 }
 
 void pbdrv_uart_ev3_handle_tx_complete(uint8_t id) {
@@ -201,6 +201,17 @@ static void omapl_pru_rx_chars(omapl_pru_suart_t *suart, lwrb_t *rx_dest) {
     }
     /* read the status */
     rx_status = pru_softuart_getRxStatus(&suart->suart_hdl);
+
+    // If a whole FIFO half fits in the ring buffer without wrapping, read
+    // straight into it instead of copying it via the local buffer.
+    if (!(rx_status & CHN_TXRX_STATUS_ERR) && lwrb_get_linear_block_write_length(rx_dest) >= sizeof(suart_data)) {
+        pru_softuart_read_data(&suart->suart_hdl, lwrb_get_linear_block_write_address(rx_dest),
+            data_len + 1, &data_len_read);
+        lwrb_advance(rx_dest, data_len_read);
+        pru_softuart_clrRxStatus(&suart->suart_hdl);
+        return;
+    }
+
     pru_softuart_read_data(&suart->suart_hdl, suart_data,
         data_len + 1, &data_len_read);
 
@@ -231,8 +242,6 @@ static void omapl_pru_rx_chars(omapl_pru_suart_t *suart, lwrb_t *rx_dest) {
             pru_suart_stop_rx(suart);
         }
 
-        // TODO: we could just have pru_softuart_read_data read directly
-        // into the lwrb buffer via lwrb_get_linear_block_write_address.
         lwrb_write(rx_dest, suart_data, data_len_read);
     }
 
@@ -333,10 +342,12 @@ int32_t pru_suart_startup(omapl_pru_suart_t *suart) {
     /* Seed RX if port is half-rx or full-duplex */
     if ((suart_get_duplex(suart) & ePRU_SUART_HALF_RX) == ePRU_SUART_HALF_RX) {
         suart_pru_to_host_intr_enable(suart->suart_hdl.uartNum, PRU_RX_INTR, true);
-        // Note: the final argument is effectively the trigger threshold of the UART RX FIFO.
-        // We chose 8 to give ourselves some breathing room in case we are slow to process the
-        // FIFO interrupt.
-        pru_softuart_read(&suart->suart_hdl, (uint32_t *)&suart->suart_dma_addr.dma_phys_addr_rx, 8);
+        // Note: the final argument is the size of each half of the double
+        // buffered RX FIFO, minus one. The PRU interrupts when a half is full
+        // or when the line has been idle, and then fills the other half. A
+        // full size half means that bursts of data cause half as many
+        // interrupts, and gives the ARM more time to read each half.
+        pru_softuart_read(&suart->suart_hdl, (uint32_t *)&suart->suart_dma_addr.dma_phys_addr_rx, SUART_FIFO_LEN);
     }
     return retval;
 }
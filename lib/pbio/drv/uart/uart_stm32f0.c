@@ -20,6 +20,7 @@
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
 #include <pbio/os.h>
+#include <pbio/tracepoint.h>
 #include <pbio/util.h>
 
 #include "stm32f0xx.h"
@@ -40,6 +41,8 @@ struct _pbdrv_uart_dev_t {
     uint32_t tx_buf_index;
     pbio_os_timer_t rx_timer;
     pbio_os_timer_t tx_timer;
+    pbio_os_process_t *rx_process;
+    pbio_os_process_t *tx_process;
     uint8_t irq;
     bool initialized;
 };
@@ -78,6 +81,7 @@ pbio_error_t pbdrv_uart_read(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, uin
     uart->rx_buf = msg;
     uart->rx_buf_size = length;
     uart->rx_buf_index = 0;
+    uart->rx_process = pbio_os_get_current_process();
 
     if (timeout) {
         pbio_os_timer_set(&uart->rx_timer, timeout);
@@ -118,6 +122,7 @@ pbio_error_t pbdrv_uart_write(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, co
     uart->tx_buf = msg;
     uart->tx_buf_size = length;
     uart->tx_buf_index = 0;
+    uart->tx_process = pbio_os_get_current_process();
 
     if (timeout) {
         pbio_os_timer_set(&uart->tx_timer, timeout);
@@ -158,7 +163,9 @@ void pbdrv_uart_stm32f0_handle_irq(uint8_t id) {
     if (isr & USART_ISR_RXNE) {
         uint8_t c = uart->USART->RDR;
         lwrb_write(&uart->rx_ring_buf, &c, 1);
-        pbio_os_request_poll();
+        pbio_tracepoint_record(PBIO_TRACEPOINT_UART_RX, id, lwrb_get_full(&uart->rx_ring_buf));
+        // Only poll the process that is reading from this UART.
+        pbio_os_process_request_poll(uart->rx_process);
     }
 
     // transmit next byte
@@ -177,7 +184,7 @@ void pbdrv_uart_stm32f0_handle_irq(uint8_t id) {
     // transmission complete
     if (uart->USART->CR1 & USART_CR1_TCIE && isr & USART_ISR_TC) {
         uart->USART->CR1 &= ~USART_CR1_TCIE;
-        pbio_os_request_poll();
+        pbio_os_process_request_poll(uart->tx_process);
     }
 }
 
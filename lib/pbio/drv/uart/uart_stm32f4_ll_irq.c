@@ -1,7 +1,7 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2018-2025 The Pybricks Authors
 
-// UART driver for STM32F4x using IRQ.
+// UART driver for STM32F4x using IRQ, with optional DMA for Tx.
 
 #include <pbdrv/config.h>
 
@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <stm32f4xx_ll_dma.h>
 #include <stm32f4xx_ll_rcc.h>
 #include <stm32f4xx_ll_usart.h>
 
@@ -19,13 +20,14 @@
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
 #include <pbio/os.h>
+#include <pbio/tracepoint.h>
 #include <pbio/util.h>
 
 #include <lwrb/lwrb.h>
 
 #include "./uart_stm32f4_ll_irq.h"
 
-#define RX_DATA_SIZE 64 // must be power of 2 for ring buffer!
+#define RX_DATA_SIZE PBDRV_CONFIG_UART_STM32F4_LL_IRQ_RX_BUF_SIZE // must be power of 2 for ring buffer!
 
 struct _pbdrv_uart_dev_t {
     /** Platform-specific data */
@@ -48,6 +50,10 @@ struct _pbdrv_uart_dev_t {
     uint32_t write_length;
     /** The current position in write_buf. */
     volatile uint32_t write_pos;
+    /** The process awaiting the most recent read operation. */
+    pbio_os_process_t *read_process;
+    /** The process awaiting the most recent write operation. */
+    pbio_os_process_t *write_process;
 };
 
 static pbdrv_uart_dev_t uart_devs[PBDRV_CONFIG_UART_STM32F4_LL_IRQ_NUM_UART];
@@ -81,6 +87,7 @@ pbio_error_t pbdrv_uart_read(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, uin
     uart->read_buf = msg;
     uart->read_length = length;
     uart->read_pos = 0;
+    uart->read_process = pbio_os_get_current_process();
 
     if (timeout) {
         pbio_os_timer_set(&uart->read_timer, timeout);
@@ -106,6 +113,60 @@ pbio_error_t pbdrv_uart_read(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, uin
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+/**
+ * Clears all event flags of a DMA stream, as required before enabling it.
+ *
+ * @param [in]  dma     The DMA controller.
+ * @param [in]  stream  The stream (LL_DMA_STREAM_x).
+ */
+static void pbdrv_uart_dma_clear_flags(DMA_TypeDef *dma, uint32_t stream) {
+    // Flags of streams 0-3 are in LIFCR, 4-7 in HIFCR, at these offsets.
+    static const uint8_t offset[] = { 0, 6, 16, 22 };
+    uint32_t flags = (DMA_LIFCR_CFEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTCIF0) << offset[stream % 4];
+    if (stream < 4) {
+        dma->LIFCR = flags;
+    } else {
+        dma->HIFCR = flags;
+    }
+}
+
+/**
+ * Starts writing the buffer with DMA, without copying it.
+ *
+ * Completion is signaled by the UART transmit complete interrupt.
+ *
+ * @param [in]  uart    The UART device.
+ */
+static void pbdrv_uart_write_dma_start(pbdrv_uart_dev_t *uart) {
+    const pbdrv_uart_stm32f4_ll_irq_platform_data_t *pdata = uart->pdata;
+
+    LL_DMA_DisableStream(pdata->tx_dma, pdata->tx_dma_stream);
+    while (LL_DMA_IsEnabledStream(pdata->tx_dma, pdata->tx_dma_stream)) {
+    }
+    pbdrv_uart_dma_clear_flags(pdata->tx_dma, pdata->tx_dma_stream);
+    LL_DMA_SetMemoryAddress(pdata->tx_dma, pdata->tx_dma_stream, (uint32_t)uart->write_buf);
+    LL_DMA_SetDataLength(pdata->tx_dma, pdata->tx_dma_stream, uart->write_length);
+    LL_DMA_EnableStream(pdata->tx_dma, pdata->tx_dma_stream);
+
+    LL_USART_ClearFlag_TC(pdata->uart);
+    LL_USART_EnableDMAReq_TX(pdata->uart);
+    LL_USART_EnableIT_TC(pdata->uart);
+}
+
+/**
+ * Stops an ongoing DMA write, if any.
+ *
+ * @param [in]  uart    The UART device.
+ */
+static void pbdrv_uart_write_dma_stop(pbdrv_uart_dev_t *uart) {
+    const pbdrv_uart_stm32f4_ll_irq_platform_data_t *pdata = uart->pdata;
+    if (!pdata->tx_dma) {
+        return;
+    }
+    LL_USART_DisableDMAReq_TX(pdata->uart);
+    LL_DMA_DisableStream(pdata->tx_dma, pdata->tx_dma_stream);
+}
+
 pbio_error_t pbdrv_uart_write(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, const uint8_t *msg, uint32_t length, uint32_t timeout) {
 
     PBIO_OS_ASYNC_BEGIN(state);
@@ -117,12 +178,17 @@ pbio_error_t pbdrv_uart_write(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, co
     uart->write_buf = msg;
     uart->write_length = length;
     uart->write_pos = 0;
+    uart->write_process = pbio_os_get_current_process();
 
     if (timeout) {
         pbio_os_timer_set(&uart->write_timer, timeout);
     }
 
-    LL_USART_EnableIT_TXE(uart->pdata->uart);
+    if (uart->pdata->tx_dma) {
+        pbdrv_uart_write_dma_start(uart);
+    } else {
+        LL_USART_EnableIT_TXE(uart->pdata->uart);
+    }
 
     // Await completion or timeout.
     PBIO_OS_AWAIT_UNTIL(state, uart->write_pos == uart->write_length || (timeout && pbio_os_timer_is_expired(&uart->write_timer)));
@@ -131,6 +197,7 @@ pbio_error_t pbdrv_uart_write(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, co
 
     // Set exit status based on completion condition.
     if ((timeout && pbio_os_timer_is_expired(&uart->write_timer))) {
+        pbdrv_uart_write_dma_stop(uart);
         LL_USART_DisableIT_TXE(uart->pdata->uart);
         LL_USART_DisableIT_TC(uart->pdata->uart);
         return PBIO_ERROR_TIMEDOUT;
@@ -169,6 +236,7 @@ void pbdrv_uart_flush(pbdrv_uart_dev_t *uart) {
     // If a process was exited while an operation was in progress this is
     // normally an error, and the process may call flush when it is restarted
     // to clear the state.
+    pbdrv_uart_write_dma_stop(uart);
     uart->write_buf = NULL;
     uart->write_length = 0;
     uart->write_pos = 0;
@@ -187,9 +255,11 @@ void pbdrv_uart_stm32f4_ll_irq_handle_irq(uint8_t id) {
     if (sr & USART_SR_RXNE) {
         uint8_t c = LL_USART_ReceiveData8(USARTx);
         lwrb_write(&uart->rx_buf, &c, 1);
+        pbio_tracepoint_record(PBIO_TRACEPOINT_UART_RX, id, lwrb_get_full(&uart->rx_buf));
         // Poll parent process for each received byte, since the IRQ handler
         // has no awareness of the expected length of the read operation.
-        pbio_os_request_poll();
+        // Only the reading process is polled, not every other process.
+        pbio_os_process_request_poll(uart->read_process);
 
     }
 
@@ -212,8 +282,13 @@ void pbdrv_uart_stm32f4_ll_irq_handle_irq(uint8_t id) {
 
     if (USARTx->CR1 & USART_CR1_TCIE && sr & USART_SR_TC) {
         LL_USART_DisableIT_TC(USARTx);
+        if (uart->pdata->tx_dma && LL_USART_IsEnabledDMAReq_TX(USARTx)) {
+            // DMA has written all bytes and the last one has been sent.
+            LL_USART_DisableDMAReq_TX(USARTx);
+            uart->write_pos = uart->write_length;
+        }
         // Poll parent process to indicate the write operation is complete.
-        pbio_os_request_poll();
+        pbio_os_process_request_poll(uart->write_process);
     }
 }
 
@@ -245,6 +320,19 @@ void pbdrv_uart_init(void) {
         LL_USART_ConfigAsyncMode(pdata->uart);
         LL_USART_EnableIT_RXNE(pdata->uart);
 
+        // Configure Tx DMA, if used. The stream is started for each write.
+        if (pdata->tx_dma) {
+            LL_DMA_SetChannelSelection(pdata->tx_dma, pdata->tx_dma_stream, pdata->tx_dma_ch);
+            LL_DMA_SetDataTransferDirection(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+            LL_DMA_SetStreamPriorityLevel(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_PRIORITY_LOW);
+            LL_DMA_SetMode(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_MODE_NORMAL);
+            LL_DMA_SetPeriphIncMode(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_PERIPH_NOINCREMENT);
+            LL_DMA_SetMemoryIncMode(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_MEMORY_INCREMENT);
+            LL_DMA_SetPeriphSize(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_PDATAALIGN_BYTE);
+            LL_DMA_SetMemorySize(pdata->tx_dma, pdata->tx_dma_stream, LL_DMA_MDATAALIGN_BYTE);
+            LL_DMA_SetPeriphAddress(pdata->tx_dma, pdata->tx_dma_stream, (uint32_t)&pdata->uart->DR);
+        }
+
         NVIC_SetPriority(pdata->irq, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
         NVIC_EnableIRQ(pdata->irq);
 
@@ -1,7 +1,7 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2018-2020 The Pybricks Authors
 
-// UART driver for STM32F4x using IRQ.
+// UART driver for STM32F4x using IRQ, with optional DMA for Tx.
 
 #ifndef _INTERNAL_PBDRV_UART_STM32F4_LL_IRQ_H_
 #define _INTERNAL_PBDRV_UART_STM32F4_LL_IRQ_H_
@@ -18,6 +18,12 @@ typedef struct {
     USART_TypeDef *uart;
     /** The UART interrupt number. */
     IRQn_Type irq;
+    /** The Tx DMA controller, or NULL to write each byte from the UART interrupt. */
+    DMA_TypeDef *tx_dma;
+    /** The Tx DMA stream (LL_DMA_STREAM_x). */
+    uint32_t tx_dma_stream;
+    /** The Tx DMA channel (LL_DMA_CHANNEL_x). */
+    uint32_t tx_dma_ch;
 } pbdrv_uart_stm32f4_ll_irq_platform_data_t;
 
 /**
@@ -17,6 +17,7 @@
 
 #include <pbio/busy_count.h>
 #include <pbio/error.h>
+#include <pbio/int_math.h>
 #include <pbio/os.h>
 #include <pbio/util.h>
 
@@ -187,6 +188,24 @@ uint32_t pbdrv_uart_in_waiting(pbdrv_uart_dev_t *uart) {
     return (rx_head - uart->rx_tail) & (RX_DATA_SIZE - 1);
 }
 
+uint32_t pbdrv_uart_peek(pbdrv_uart_dev_t *uart, uint32_t offset, const uint8_t **data) {
+    uint32_t available = pbdrv_uart_in_waiting(uart);
+    uint32_t start = (uart->rx_tail + offset) & (RX_DATA_SIZE - 1);
+
+    // DMA has completed writing this data, so it is safe to read it as if it
+    // were not volatile.
+    *data = (const uint8_t *)&uart->rx_data[start];
+
+    if (offset >= available) {
+        return 0;
+    }
+    return pbio_int_math_min(available - offset, RX_DATA_SIZE - start);
+}
+
+void pbdrv_uart_discard(pbdrv_uart_dev_t *uart, uint32_t length) {
+    uart->rx_tail = (uart->rx_tail + length) & (RX_DATA_SIZE - 1);
+}
+
 pbio_error_t pbdrv_uart_read(pbio_os_state_t *state, pbdrv_uart_dev_t *uart, uint8_t *msg, uint32_t length, uint32_t timeout) {
 
     PBIO_OS_ASYNC_BEGIN(state);
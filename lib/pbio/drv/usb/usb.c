@@ -70,6 +70,17 @@ static uint32_t pbdrv_usb_noti_size[PBIO_PYBRICKS_EVENT_NUM_EVENTS];
 static uint8_t pbdrv_usb_status_data[PBIO_PYBRICKS_EVENT_STATUS_REPORT_SIZE];
 static bool pbdrv_usb_status_data_pending;
 
+// Time in ms that a status change may wait for more changes, so that flags
+// that change several times in a row are sent only once, in the final state.
+#ifndef PBDRV_CONFIG_USB_STATUS_FLUSH_DELAY
+#define PBDRV_CONFIG_USB_STATUS_FLUSH_DELAY (5)
+#endif
+
+/**
+ * Expires when the first pending status change has waited long enough.
+ */
+static pbio_os_timer_t pbdrv_usb_status_flush_timer;
+
 void pbdrv_usb_schedule_status_update(const uint8_t *status_msg) {
     // Ignore if message identical to last.
     if (!memcmp(pbdrv_usb_status_data, status_msg, sizeof(pbdrv_usb_status_data))) {
@@ -77,6 +88,9 @@ void pbdrv_usb_schedule_status_update(const uint8_t *status_msg) {
     }
 
     // Schedule to send whenever the USB process gets round to it.
+    if (!pbdrv_usb_status_data_pending) {
+        pbio_os_timer_set(&pbdrv_usb_status_flush_timer, PBDRV_CONFIG_USB_STATUS_FLUSH_DELAY);
+    }
     memcpy(pbdrv_usb_status_data, status_msg, sizeof(pbdrv_usb_status_data));
     pbdrv_usb_status_data_pending = true;
     pbio_os_request_poll();
@@ -117,7 +131,11 @@ bool pbdrv_usb_stdout_tx_is_idle(void) {
     if (!pbdrv_usb_connection_is_active()) {
         return true;
     }
-    return lwrb_get_full(&pbdrv_usb_stdout_ring_buf) == 0 && !pbdrv_usb_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT];
+    return lwrb_get_full(&pbdrv_usb_stdout_ring_buf) == 0 && !pbdrv_usb_noti_size[PBIO_PYBRICKS_EVENT_WRITE_STDOUT] && pbdrv_usb_tx_is_idle();
+}
+
+void pbdrv_usb_stdout_tx_discard(uint32_t size) {
+    lwrb_skip(&pbdrv_usb_stdout_ring_buf, size);
 }
 
 void pbdrv_usb_debug_print(const char *data, size_t len) {
@@ -173,7 +191,7 @@ pbio_error_t pbdrv_usb_send_event_notification(pbio_os_state_t *state, pbio_pybr
 static bool update_and_get_event_buffer(uint8_t **buf, uint32_t **len) {
 
     // Prepare status.
-    if (pbdrv_usb_status_data_pending) {
+    if (pbdrv_usb_status_data_pending && pbio_os_timer_is_expired(&pbdrv_usb_status_flush_timer)) {
         // When a status is pending, drain it here while we write it out,
         // so a new status can be set in the mean time without losing it.
         // This is offset by one for the endpoint message type. The status
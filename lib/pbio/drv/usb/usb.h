@@ -49,10 +49,14 @@ void pbdrv_usb_deinit_device(void);
 uint32_t pbdrv_usb_get_data_and_start_receive(uint8_t *data);
 
 /**
- * Sends and awaits event message from hub to host via the Pybricks USB interface OUT endpoint.
+ * Sends event message from hub to host via the Pybricks USB interface OUT endpoint.
  *
  * Driver-specific implementation. Must return within ::PBDRV_USB_TRANSMIT_TIMEOUT.
  *
+ * Drivers may return as soon as the data is copied and queued for sending,
+ * so that the next event can be prepared in the mean time. Such drivers must
+ * report pending data with pbdrv_usb_tx_is_idle().
+ *
  * The USB process ensures that only one call is made at once.
  *
  * Data must include the endpoint type and event code, so size is at least 2.
@@ -69,6 +73,14 @@ uint32_t pbdrv_usb_get_data_and_start_receive(uint8_t *data);
  */
 pbio_error_t pbdrv_usb_tx_event(pbio_os_state_t *state, const uint8_t *data, uint32_t size);
 
+/**
+ * Tests if all events passed to pbdrv_usb_tx_event() have been sent.
+ *
+ * Driver-specific implementation. Drivers that await completion in
+ * pbdrv_usb_tx_event() can always return true.
+ */
+bool pbdrv_usb_tx_is_idle(void);
+
 /**
  * Sends and awaits response to an earlier incoming message.
  *
@@ -136,6 +148,10 @@ static inline pbio_error_t pbdrv_usb_tx_reset(pbio_os_state_t *state) {
     return PBIO_ERROR_NOT_IMPLEMENTED;
 }
 
+static inline bool pbdrv_usb_tx_is_idle(void) {
+    return true;
+}
+
 static inline pbio_error_t pbdrv_usb_wait_until_configured(pbio_os_state_t *state) {
     return PBIO_ERROR_NOT_IMPLEMENTED;
 }
@@ -226,12 +226,16 @@ static uint32_t pbdrv_usb_setup_misc_tx_byte;
 // Whether the device is using USB high-speed mode or not
 static bool pbdrv_usb_is_usb_hs;
 
+// Number of event packets that can be queued for sending at once. While one
+// is being sent, the USB process can already prepare the next one.
+#define EP1_TX_EVENT_BUF_COUNT  2
+
 // Buffers, used for different logical flows on the data endpoint
 static uint8_t ep1_rx_buf[PYBRICKS_EP_PKT_SZ_HS] PBDRV_DMA_BUF;
+static uint8_t ep1_tx_event_buf[EP1_TX_EVENT_BUF_COUNT][PYBRICKS_EP_PKT_SZ_HS] PBDRV_DMA_BUF;
 
 // Buffer status flags
 static volatile bool usb_rx_is_ready;
-static volatile bool transmitting;
 
 // CPPI DMA support code
 
@@ -263,6 +267,7 @@ enum {
     CPPI_DESC_RX,
     CPPI_DESC_TX_RESPONSE,
     CPPI_DESC_TX_PYBRICKS_EVENT,
+    CPPI_DESC_TX_PYBRICKS_EVENT_END = CPPI_DESC_TX_PYBRICKS_EVENT + EP1_TX_EVENT_BUF_COUNT,
     // the minimum number of descriptors we can allocate is 32,
     // even though we do not use nearly all of them
     CPPI_DESC_COUNT = 32,
@@ -276,6 +281,8 @@ enum {
 
 // CPPI memory
 static usb_cppi_hpd_t cppi_descriptors[CPPI_DESC_COUNT];
+// Whether each TX descriptor has been submitted but not completed
+static volatile bool tx_pending[CPPI_DESC_TX_PYBRICKS_EVENT_END];
 static uint32_t cppi_linking_ram[CPPI_DESC_COUNT];
 // Tags a Host Packet Descriptor (i.e. the first descriptor
 // which contains full information about a packet, rather than
@@ -859,11 +866,9 @@ static void usb_device_intr(void) {
         // Pop the descriptor from the queue
         uint32_t qctrld = HWREG(USB_0_OTGBASE + CPDMA_QUEUE_REGISTER_D + TX_COMPQ1 * 16) & ~CPDMA_QUEUE_REGISTER_DESC_SIZE_MASK;
 
-        if (qctrld == (uint32_t)(&cppi_descriptors[CPPI_DESC_TX_RESPONSE])) {
-            transmitting = false;
-            pbio_os_request_poll();
-        } else if (qctrld == (uint32_t)(&cppi_descriptors[CPPI_DESC_TX_PYBRICKS_EVENT])) {
-            transmitting = false;
+        uint32_t index = (qctrld - (uint32_t)cppi_descriptors) / sizeof(usb_cppi_hpd_t);
+        if (index < CPPI_DESC_TX_PYBRICKS_EVENT_END) {
+            tx_pending[index] = false;
             pbio_os_request_poll();
         }
 
@@ -1007,7 +1012,7 @@ pbio_error_t pbdrv_usb_tx_reset(pbio_os_state_t *state) {
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    transmitting = false;
+    memset((void *)tx_pending, 0, sizeof(tx_pending));
 
     // Flush _all_ TX packets
     while (HWREGB(USB0_BASE + USB_O_TXCSRL1) & USB_TXCSRL1_TXRDY) {
@@ -1022,33 +1027,59 @@ pbio_error_t pbdrv_usb_tx_reset(pbio_os_state_t *state) {
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+// Gets the index of an event descriptor that is not in use, or -1 if all are.
+static int32_t usb_get_free_tx_event_desc(void) {
+    for (int32_t i = CPPI_DESC_TX_PYBRICKS_EVENT; i < CPPI_DESC_TX_PYBRICKS_EVENT_END; i++) {
+        if (!tx_pending[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool pbdrv_usb_tx_is_idle(void) {
+    for (uint32_t i = 0; i < PBIO_ARRAY_SIZE(tx_pending); i++) {
+        if (tx_pending[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 pbio_error_t pbdrv_usb_tx_event(pbio_os_state_t *state, const uint8_t *data, uint32_t size) {
 
     static pbio_os_timer_t timer;
+    static int32_t desc;
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    if (transmitting) {
-        return PBIO_ERROR_BUSY;
+    if (size > PYBRICKS_EP_PKT_SZ_HS) {
+        return PBIO_ERROR_INVALID_ARG;
     }
 
-    transmitting = true;
+    // Wait for a free buffer. Usually one is available right away, since the
+    // previous event only needs to be queued, not sent.
     pbio_os_timer_set(&timer, PBDRV_USB_TRANSMIT_TIMEOUT);
+    PBIO_OS_AWAIT_UNTIL(state, (desc = usb_get_free_tx_event_desc()) >= 0 || pbio_os_timer_is_expired(&timer));
 
-    // Transmit event.
-    pbdrv_cache_prepare_before_dma(data, size);
-    usb_setup_tx_dma_desc(CPPI_DESC_TX_PYBRICKS_EVENT, (uint8_t *)data, size);
-
-    PBIO_OS_AWAIT_UNTIL(state, !transmitting || pbio_os_timer_is_expired(&timer));
-
-    if (pbio_os_timer_is_expired(&timer)) {
-        // Transmission has taken too long, so reset the state to allow
-        // new transmissions. This can happen if the host stops reading
+    if (desc < 0) {
+        // Previous transmissions have taken too long, so reset the state to
+        // allow new transmissions. This can happen if the host stops reading
         // data for some reason. This need some time to complete, so delegate
         // the reset back to the process.
         return PBIO_ERROR_TIMEDOUT;
     }
 
+    // Copy the event so the caller can reuse its buffer while this is sent.
+    uint8_t *buf = ep1_tx_event_buf[desc - CPPI_DESC_TX_PYBRICKS_EVENT];
+    memcpy(buf, data, size);
+    tx_pending[desc] = true;
+
+    // Transmit event. Completion is not awaited here, so the next event can
+    // be queued while this one is still being sent.
+    pbdrv_cache_prepare_before_dma(buf, size);
+    usb_setup_tx_dma_desc(desc, buf, size);
+
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
@@ -1060,11 +1091,11 @@ pbio_error_t pbdrv_usb_tx_response(pbio_os_state_t *state, pbio_pybricks_error_t
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    if (transmitting) {
+    if (tx_pending[CPPI_DESC_TX_RESPONSE]) {
         return PBIO_ERROR_BUSY;
     }
 
-    transmitting = true;
+    tx_pending[CPPI_DESC_TX_RESPONSE] = true;
     pbio_os_timer_set(&timer, PBDRV_USB_TRANSMIT_TIMEOUT);
 
     // Response is just the error code.
@@ -1075,8 +1106,8 @@ pbio_error_t pbdrv_usb_tx_response(pbio_os_state_t *state, pbio_pybricks_error_t
     usb_setup_tx_dma_desc(CPPI_DESC_TX_RESPONSE, ep1_tx_response_buf, sizeof(ep1_tx_response_buf));
 
     // Wait until complete or trigger reset on timeout.
-    PBIO_OS_AWAIT_UNTIL(state, !transmitting || pbio_os_timer_is_expired(&timer));
-    if (pbio_os_timer_is_expired(&timer)) {
+    PBIO_OS_AWAIT_UNTIL(state, !tx_pending[CPPI_DESC_TX_RESPONSE] || pbio_os_timer_is_expired(&timer));
+    if (tx_pending[CPPI_DESC_TX_RESPONSE]) {
         return PBIO_ERROR_TIMEDOUT;
     }
 
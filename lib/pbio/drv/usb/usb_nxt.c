@@ -754,9 +754,10 @@ static void pbdrv_usb_nxt_isr(void) {
             }
 
             /* and we will send the following data */
-            if (pbdrv_usb_nxt_state.tx_data[endpoint] != NULL) {
-                pbdrv_usb_nxt_write_data(endpoint, pbdrv_usb_nxt_state.tx_data[endpoint],
-                    pbdrv_usb_nxt_state.tx_len[endpoint]);
+            /* State is stored per endpoint as documented in pbdrv_usb_nxt_state */
+            if (pbdrv_usb_nxt_state.tx_data[endpoint / 2] != NULL) {
+                pbdrv_usb_nxt_write_data(endpoint, pbdrv_usb_nxt_state.tx_data[endpoint / 2],
+                    pbdrv_usb_nxt_state.tx_len[endpoint / 2]);
             } else {
                 /* then it means that we sent all the data and the host has acknowledged it */
                 pbdrv_usb_nxt_state.status = USB_READY;
@@ -900,6 +901,11 @@ pbio_error_t pbdrv_usb_tx_response(pbio_os_state_t *state, pbio_pybricks_error_t
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+bool pbdrv_usb_tx_is_idle(void) {
+    // Events are fully sent when pbdrv_usb_tx_event() completes.
+    return true;
+}
+
 pbio_error_t pbdrv_usb_tx_reset(pbio_os_state_t *state) {
     // REVISIT: Make async.
     pbdrv_usb_init_device();
@@ -72,6 +72,11 @@ pbio_error_t pbdrv_usb_tx_response(pbio_os_state_t *state, pbio_pybricks_error_t
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+bool pbdrv_usb_tx_is_idle(void) {
+    // Events are fully sent when pbdrv_usb_tx_event() completes.
+    return true;
+}
+
 pbio_error_t pbdrv_usb_tx_reset(pbio_os_state_t *state) {
     return PBIO_SUCCESS;
 }
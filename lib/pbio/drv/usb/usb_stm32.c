@@ -39,9 +39,19 @@
 // These buffers need to be 32-bit aligned because the USB driver moves data
 // to/from FIFOs in 32-bit chunks.
 static uint8_t usb_in_buf[USBD_PYBRICKS_MAX_PACKET_SIZE] __aligned(4);
-static uint8_t usb_response_buf[PBIO_PYBRICKS_USB_MESSAGE_SIZE(sizeof(uint32_t))] __aligned(4) = { PBIO_PYBRICKS_IN_EP_MSG_RESPONSE };
 static volatile uint32_t usb_in_sz;
-static volatile bool transmitting;
+
+// Number of outgoing packets that can be queued at once. While one is being
+// sent, the next one can already be prepared.
+#define USB_TX_QUEUE_SIZE (2)
+
+// Queue of outgoing packets. The packet at usb_tx_head is being sent if
+// usb_tx_count is nonzero. Modified from the transfer complete interrupt, so
+// other changes must be made with interrupts disabled.
+static uint8_t usb_tx_buf[USB_TX_QUEUE_SIZE][USBD_PYBRICKS_MAX_PACKET_SIZE] __aligned(4);
+static uint32_t usb_tx_size[USB_TX_QUEUE_SIZE];
+static volatile uint32_t usb_tx_head;
+static volatile uint32_t usb_tx_count;
 
 static USBD_HandleTypeDef husbd;
 static PCD_HandleTypeDef hpcd;
@@ -156,7 +166,38 @@ void pbdrv_usb_stm32_handle_vbus_irq(bool active) {
 }
 
 static void pbdrv_usb_stm32_reset_tx_state(void) {
-    transmitting = false;
+    usb_tx_count = 0;
+}
+
+/**
+ * Copies a packet into the transmit queue and starts sending it if nothing
+ * else is being sent.
+ *
+ * @param [in]  data    Data to send.
+ * @param [in]  size    Data size. Must not exceed the maximum packet size.
+ * @return              True if the packet was queued, false if the queue is full.
+ */
+static bool pbdrv_usb_stm32_tx_queue_push(const uint8_t *data, uint32_t size) {
+
+    if (usb_tx_count == USB_TX_QUEUE_SIZE) {
+        return false;
+    }
+
+    uint32_t irq_state = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t index = (usb_tx_head + usb_tx_count) % USB_TX_QUEUE_SIZE;
+    memcpy(usb_tx_buf[index], data, size);
+    usb_tx_size[index] = size;
+
+    // Start right away if idle, otherwise the completion interrupt does it.
+    if (usb_tx_count++ == 0) {
+        USBD_Pybricks_TransmitPacket(&husbd, usb_tx_buf[index], size);
+    }
+
+    __set_PRIMASK(irq_state);
+
+    return true;
 }
 
 /**
@@ -212,7 +253,16 @@ static USBD_StatusTypeDef Pybricks_Itf_Receive(uint8_t *Buf, uint32_t Len) {
   * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
   */
 static USBD_StatusTypeDef Pybricks_Itf_TransmitCplt(uint8_t *Buf, uint32_t Len, uint8_t epnum) {
-    transmitting = false;
+    if (usb_tx_count) {
+        usb_tx_head = (usb_tx_head + 1) % USB_TX_QUEUE_SIZE;
+        usb_tx_count--;
+    }
+
+    // Start the next packet without waiting for the USB process, so packets
+    // go out back to back.
+    if (usb_tx_count) {
+        USBD_Pybricks_TransmitPacket(&husbd, usb_tx_buf[usb_tx_head], usb_tx_size[usb_tx_head]);
+    }
     pbio_os_request_poll();
     return USBD_OK;
 }
@@ -287,6 +337,10 @@ USBD_Pybricks_ItfTypeDef USBD_Pybricks_fops = {
     .ReadCharacteristic = Pybricks_Itf_ReadCharacteristic,
 };
 
+bool pbdrv_usb_tx_is_idle(void) {
+    return usb_tx_count == 0;
+}
+
 pbio_error_t pbdrv_usb_tx_reset(pbio_os_state_t *state) {
     pbdrv_usb_stm32_reset_tx_state();
     return PBIO_SUCCESS;
@@ -298,14 +352,14 @@ pbio_error_t pbdrv_usb_tx_event(pbio_os_state_t *state, const uint8_t *data, uin
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    if (transmitting) {
-        return PBIO_ERROR_BUSY;
+    if (size > USBD_PYBRICKS_MAX_PACKET_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
     }
 
-    transmitting = true;
+    // Only wait if the queue is full. Completion is not awaited, so the next
+    // event can be prepared while this one is sent.
     pbio_os_timer_set(&timer, PBDRV_USB_TRANSMIT_TIMEOUT);
-    USBD_Pybricks_TransmitPacket(&husbd, (uint8_t *)data, size);
-    PBIO_OS_AWAIT_UNTIL(state, !transmitting || pbio_os_timer_is_expired(&timer));
+    PBIO_OS_AWAIT_UNTIL(state, pbdrv_usb_stm32_tx_queue_push(data, size) || pbio_os_timer_is_expired(&timer));
 
     if (pbio_os_timer_is_expired(&timer)) {
         return PBIO_ERROR_TIMEDOUT;
@@ -317,21 +371,17 @@ pbio_error_t pbdrv_usb_tx_event(pbio_os_state_t *state, const uint8_t *data, uin
 pbio_error_t pbdrv_usb_tx_response(pbio_os_state_t *state, pbio_pybricks_error_t code) {
 
     static pbio_os_timer_t timer;
+    static uint8_t usb_response_buf[PBIO_PYBRICKS_USB_MESSAGE_SIZE(sizeof(uint32_t))] = { PBIO_PYBRICKS_IN_EP_MSG_RESPONSE };
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    if (transmitting) {
-        return PBIO_ERROR_BUSY;
-    }
-
-    transmitting = true;
-    pbio_os_timer_set(&timer, PBDRV_USB_TRANSMIT_TIMEOUT);
-
     pbio_set_uint32_le(&usb_response_buf[1], code);
 
-    USBD_Pybricks_TransmitPacket(&husbd, usb_response_buf, sizeof(usb_response_buf));
+    // Queue the response after any pending events and wait until all is sent.
+    pbio_os_timer_set(&timer, PBDRV_USB_TRANSMIT_TIMEOUT);
+    PBIO_OS_AWAIT_UNTIL(state, pbdrv_usb_stm32_tx_queue_push(usb_response_buf, sizeof(usb_response_buf)) || pbio_os_timer_is_expired(&timer));
+    PBIO_OS_AWAIT_UNTIL(state, usb_tx_count == 0 || pbio_os_timer_is_expired(&timer));
 
-    PBIO_OS_AWAIT_UNTIL(state, !transmitting || pbio_os_timer_is_expired(&timer));
     if (pbio_os_timer_is_expired(&timer)) {
         return PBIO_ERROR_TIMEDOUT;
     }
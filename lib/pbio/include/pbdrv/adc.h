@@ -53,6 +53,35 @@ static inline pbio_error_t pbdrv_adc_await_new_samples(pbio_os_state_t *state, u
 
 #endif
 
+#if PBDRV_CONFIG_ADC_CAPTURE
+
+pbio_error_t pbdrv_adc_capture_start(uint8_t ch, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation);
+
+pbio_error_t pbdrv_adc_capture_await(pbio_os_state_t *state);
+
+uint32_t pbdrv_adc_capture_get_count(void);
+
+void pbdrv_adc_capture_stop(void);
+
+#else // PBDRV_CONFIG_ADC_CAPTURE
+
+static inline pbio_error_t pbdrv_adc_capture_start(uint8_t ch, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_adc_capture_await(pbio_os_state_t *state) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline uint32_t pbdrv_adc_capture_get_count(void) {
+    return 0;
+}
+
+static inline void pbdrv_adc_capture_stop(void) {
+}
+
+#endif // PBDRV_CONFIG_ADC_CAPTURE
+
 #endif /* _PBDRV_ADC_H_ */
 
 /** @} */
@@ -9,6 +9,7 @@
 #ifndef _PBDRV_BLOCK_DEVICE_H_
 #define _PBDRV_BLOCK_DEVICE_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "../sys/storage_data.h"
@@ -31,6 +32,36 @@
  */
 pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data);
 
+/**
+ * Tests if the program data is still being loaded into RAM.
+ *
+ * Drivers for slow external storage may load only the settings and slot info
+ * during boot, and the program data in the background afterwards. Until this
+ * returns false, the program data in ::pbdrv_block_device_get_data must not be
+ * used.
+ *
+ * @return              True if still loading, false otherwise.
+ */
+#if PBDRV_CONFIG_BLOCK_DEVICE_EV3
+bool pbdrv_block_device_is_loading(void);
+#else
+static inline bool pbdrv_block_device_is_loading(void) {
+    return false;
+}
+#endif
+
+/**
+ * Gets the block device data as it is stored, if the storage medium is
+ * memory mapped. Unlike ::pbdrv_block_device_get_data, this is not a copy in
+ * RAM, so it reflects the data as loaded on boot until the next write.
+ *
+ * @param [out] data    Pointer to the stored data.
+ * @return              ::PBIO_SUCCESS on success.
+ *                      ::PBIO_ERROR_NOT_SUPPORTED if the medium is not mapped.
+ *                      ::PBIO_ERROR_INVALID_ARG if the stored size was invalid.
+ */
+pbio_error_t pbdrv_block_device_get_mapped_data(const pbsys_storage_data_map_t **data);
+
 /**
  * Writes the "RAM Disk" to storage. May erase entire disk prior to writing.
  *
@@ -39,15 +70,21 @@ pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t **data);
  * flash, this may be partially implemented with blocking operations, so this
  * function should only be used when this is permissible.
  *
- * @param [in] state    Protothread state.
- * @param [in] size     How many bytes to write.
+ * Drivers for external flash may skip erase sectors that don't overlap the
+ * dirty range, since these already hold the same data. The sector that holds
+ * the size of the data is always written.
+ *
+ * @param [in] state        Protothread state.
+ * @param [in] size         How many bytes to write.
+ * @param [in] dirty_start  Start of the changed data, relative to the data map.
+ * @param [in] dirty_end    End of the changed data, relative to the data map.
  * @return              ::PBIO_SUCCESS on success.
  *                      ::PBIO_INVALID_ARGUMENT if size is too big.
  *                      ::PBIO_ERROR_BUSY (driver-specific error)
  *                      ::PBIO_ERROR_TIMEDOUT (driver-specific error)
  *                      ::PBIO_ERROR_IO (driver-specific error)
  */
-pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size);
+pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end);
 
 /**
  * Gets the maximum writable size for user data that can be saved to the device.
@@ -62,7 +99,15 @@ static inline pbio_error_t pbdrv_block_device_get_data(pbsys_storage_data_map_t
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
-static inline pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size) {
+static inline bool pbdrv_block_device_is_loading(void) {
+    return false;
+}
+
+static inline pbio_error_t pbdrv_block_device_get_mapped_data(const pbsys_storage_data_map_t **data) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_block_device_write_all(pbio_os_state_t *state, uint32_t used_data_size, uint32_t dirty_start, uint32_t dirty_end) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup BlockDeviceJournalDriver Driver: Block device journal area.
+ *
+ * Area of the storage medium that is written in place, instead of being
+ * loaded to RAM and saved on shutdown like the rest of the block device.
+ * @{
+ */
+
+#ifndef _PBDRV_BLOCK_DEVICE_JOURNAL_H_
+#define _PBDRV_BLOCK_DEVICE_JOURNAL_H_
+
+#include <stdint.h>
+
+#include <pbdrv/config.h>
+#include <pbio/error.h>
+#include <pbio/os.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL
+
+/**
+ * Gets the size of the journal area.
+ *
+ * @return   Size in bytes. This is a multiple of the sector size.
+ */
+uint32_t pbdrv_block_device_journal_get_size(void);
+
+/**
+ * Gets the size of one erase sector of the journal area.
+ *
+ * @return   Size in bytes.
+ */
+uint32_t pbdrv_block_device_journal_get_sector_size(void);
+
+/**
+ * Reads data from the journal area.
+ *
+ * @param [in] state    Protothread state.
+ * @param [in] offset   Offset from the start of the journal area.
+ * @param [in] buffer   Buffer to read into.
+ * @param [in] size     How many bytes to read.
+ * @return              ::PBIO_SUCCESS on success.
+ *                      ::PBIO_ERROR_INVALID_ARG if out of range.
+ *                      ::PBIO_ERROR_IO (driver-specific error)
+ */
+pbio_error_t pbdrv_block_device_journal_read(pbio_os_state_t *state, uint32_t offset, uint8_t *buffer, uint32_t size);
+
+/**
+ * Writes data to the journal area. Like on NOR flash, writing can only clear
+ * bits, so the data must be erased first. The buffer must remain valid until
+ * the operation completes.
+ *
+ * @param [in] state    Protothread state.
+ * @param [in] offset   Offset from the start of the journal area.
+ * @param [in] buffer   Data to write.
+ * @param [in] size     How many bytes to write.
+ * @return              ::PBIO_SUCCESS on success.
+ *                      ::PBIO_ERROR_INVALID_ARG if out of range.
+ *                      ::PBIO_ERROR_IO (driver-specific error)
+ */
+pbio_error_t pbdrv_block_device_journal_write(pbio_os_state_t *state, uint32_t offset, const uint8_t *buffer, uint32_t size);
+
+/**
+ * Erases one sector of the journal area, setting all bytes to 0xFF.
+ *
+ * @param [in] state    Protothread state.
+ * @param [in] offset   Offset of the sector from the start of the journal area.
+ * @return              ::PBIO_SUCCESS on success.
+ *                      ::PBIO_ERROR_INVALID_ARG if not a sector boundary.
+ *                      ::PBIO_ERROR_IO (driver-specific error)
+ */
+pbio_error_t pbdrv_block_device_journal_erase(pbio_os_state_t *state, uint32_t offset);
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL
+
+#endif // _PBDRV_BLOCK_DEVICE_JOURNAL_H_
+
+/** @} */
@@ -22,6 +22,20 @@
 #define PBDRV_BLUETOOTH_MAX_CHAR_SIZE 20
 #define PBDRV_BLUETOOTH_MAX_ADV_SIZE 31
 
+/**
+ * Maximum extended advertising data size. This is the most that fits in a
+ * single extended advertising report, so observers never have to reassemble
+ * fragments.
+ */
+#define PBDRV_BLUETOOTH_MAX_EXT_ADV_SIZE 229
+
+/** Size of the largest broadcast this build can send. */
+#if PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+#define PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE PBDRV_BLUETOOTH_MAX_EXT_ADV_SIZE
+#else
+#define PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE PBDRV_BLUETOOTH_MAX_ADV_SIZE
+#endif
+
 /** Data structure that holds context needed for sending BLE notifications. */
 typedef struct _pbdrv_bluetooth_send_context_t pbdrv_bluetooth_send_context_t;
 
@@ -98,6 +112,8 @@ typedef enum {
     PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_PAIR = 1 << 0,
     /** Whether to disconnect from the host before connecting to peripheral. */
     PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_DISCONNECT_HOST = 1 << 1,
+    /** Whether to request the shortest connection interval and no peripheral latency. */
+    PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY = 1 << 2,
 } pbdrv_bluetooth_peripheral_options_t;
 
 typedef struct _pbdrv_bluetooth_peripheral_t pbdrv_bluetooth_peripheral_t;
@@ -133,6 +149,25 @@ typedef struct {
     uint8_t match_adv_rsp_data_len;
 } pbdrv_bluetooth_peripheral_connect_config_t;
 
+/**
+ * Number of writes without response that can wait to be sent to a peripheral.
+ */
+#define PBDRV_BLUETOOTH_PERIPHERAL_WRITE_QUEUE_SIZE (4)
+
+/**
+ * Write without response that is waiting to be sent.
+ */
+typedef struct {
+    /** Handle of the characteristic value to write. */
+    uint16_t handle;
+    /** Writes with the same handle and key replace each other. */
+    uint8_t key;
+    /** Size of the data. */
+    uint8_t size;
+    /** The data to write. */
+    uint8_t data[PBDRV_BLUETOOTH_MAX_CHAR_SIZE];
+} pbdrv_bluetooth_peripheral_write_t;
+
 /** Platform-specific state needed to operate the peripheral. */
 typedef struct _pbdrv_bluetooth_peripheral_platform_state_t pbdrv_bluetooth_peripheral_platform_state_t;
 
@@ -177,6 +212,25 @@ struct _pbdrv_bluetooth_peripheral_t {
      * Size of the data to write or data read (used by write_func and read_func).
      */
     size_t char_size;
+    #if PBDRV_CONFIG_BLUETOOTH_BTSTACK
+    /**
+     * State of the ongoing peripheral function. Functions of different
+     * peripherals run side by side, so each needs its own.
+     */
+    pbio_os_state_t func_state;
+    /**
+     * State of sending the queued writes.
+     */
+    pbio_os_state_t write_queue_state;
+    /**
+     * Writes without response waiting to be sent, oldest first.
+     */
+    pbdrv_bluetooth_peripheral_write_t write_queue[PBDRV_BLUETOOTH_PERIPHERAL_WRITE_QUEUE_SIZE];
+    /**
+     * Number of writes in the queue.
+     */
+    uint8_t write_queue_size;
+    #endif
 };
 
 /** Advertisement types. */
@@ -293,6 +347,14 @@ bool pbdrv_bluetooth_host_is_connected(void);
  */
 bool pbdrv_bluetooth_hci_is_enabled(void);
 
+/**
+ * Tests if the Bluetooth controller has completed its initialization and is
+ * ready to handle commands such as advertising.
+ *
+ * @return                  True if ready, otherwise false.
+ */
+bool pbdrv_bluetooth_is_ready(void);
+
 /**
  * Sets a callback to be called when a Bluetooth host is connected or disconnected.
  *
@@ -356,6 +418,51 @@ uint32_t pbdrv_bluetooth_tx_available(void);
  */
 bool pbdrv_bluetooth_tx_is_idle(void);
 
+/**
+ * Sends buffered stdout data as soon as possible, without waiting for more
+ * data to fill a notification.
+ */
+void pbdrv_bluetooth_tx_flush(void);
+
+/**
+ * Chooses whether stdout is sent at the end of each line instead of waiting
+ * for more data to fill a notification. This is useful for interactive use.
+ *
+ * @param line_buffered [in]    Whether to send at the end of each line.
+ */
+void pbdrv_bluetooth_tx_set_line_buffered(bool line_buffered);
+
+/**
+ * Chooses whether stdout is sent compressed, as requested by the host. This
+ * starts a new compressed stream, so the host must reset its decoder too.
+ *
+ * Each new host connection starts without compression.
+ *
+ * @param compressed [in]       Whether to send stdout compressed.
+ * @return                      ::PBIO_SUCCESS or ::PBIO_ERROR_NOT_SUPPORTED if
+ *                              compression is not enabled on this hub.
+ */
+pbio_error_t pbdrv_bluetooth_tx_set_compression(bool compressed);
+
+/**
+ * Gets the rate at which event notifications such as stdout and app data are
+ * sent to the host, measured over one second intervals.
+ *
+ * @param rate      [out]   Bytes sent in the last full interval.
+ * @param rate_max  [out]   Highest number of bytes sent in one interval since
+ *                          boot.
+ */
+void pbdrv_bluetooth_get_tx_rate(uint32_t *rate, uint32_t *rate_max);
+
+/**
+ * Discards the oldest data that is queued for transmission via Bluetooth.
+ *
+ * This does not affect data that is already being sent.
+ *
+ * @param size  [in]    The maximum number of bytes to discard.
+ */
+void pbdrv_bluetooth_tx_discard(uint32_t size);
+
 /**
  * Sends a value notification and await it.
  *
@@ -492,6 +599,29 @@ pbio_error_t pbdrv_bluetooth_peripheral_read_characteristic(pbdrv_bluetooth_peri
  */
 pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic(pbdrv_bluetooth_peripheral_t *peripheral, uint16_t handle, const uint8_t *data, size_t size);
 
+/**
+ * Queues a write without response to a peripheral characteristic.
+ *
+ * Unlike pbdrv_bluetooth_peripheral_write_characteristic(), this does not
+ * occupy the peripheral, so there is nothing to await. Several writes can be
+ * sent in one connection event. A queued write that was not sent yet is
+ * replaced by a new write with the same @p handle and @p key, so only the
+ * latest value of each is sent.
+ *
+ * @param [in]  peripheral The peripheral to write to.
+ * @param [in]  handle     The handle of the characteristic value to write.
+ * @param [in]  key        Identifies what is written, such as a port.
+ * @param [in]  data       The data to write.
+ * @param [in]  size       The size of @p data in bytes.
+ * @return                 ::PBIO_SUCCESS if the write was queued.
+ *                         ::PBIO_ERROR_NO_DEV if not connected to a peripheral.
+ *                         ::PBIO_ERROR_BUSY if the queue is full.
+ *                         ::PBIO_ERROR_INVALID_ARG if @p size is too big.
+ *                         ::PBIO_ERROR_NOT_SUPPORTED if the driver does not
+ *                         support writes without response.
+ */
+pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic_queued(pbdrv_bluetooth_peripheral_t *peripheral, uint16_t handle, uint8_t key, const uint8_t *data, size_t size);
+
 /**
  * Awaits for a task associated with a peripheral to complete. Used to await
  * characteristic discover/read/write, scan-and-connect, or disconnect.
@@ -524,11 +654,18 @@ pbio_error_t pbdrv_bluetooth_start_advertising(bool start);
  * Starts broadcasting undirected, non-connectable, non-scannable advertisement
  * data.
  *
- * Call again to update the advertising data if needed.
+ * Call again to update the advertising data if needed. While broadcasting,
+ * this replaces the data without stopping and restarting the advertisements.
+ * Updates that arrive while the previous one is still being sent replace the
+ * pending data instead of failing, so only the latest data is sent.
  *
  * The advertising data must follow the Bluetooth specification. The length
  * is validated, but the data itself is not.
  *
+ * Data up to ::PBDRV_BLUETOOTH_MAX_ADV_SIZE is sent as legacy advertising so
+ * that all hubs can receive it. Larger data is sent as extended advertising
+ * if the controller supports it.
+ *
  * Setting @p data to NULL or @p size to 0 stops broadcasting.
  *
  * @param [in]  data    The advertising data.
@@ -539,6 +676,16 @@ pbio_error_t pbdrv_bluetooth_start_advertising(bool start);
  */
 pbio_error_t pbdrv_bluetooth_start_broadcasting(const uint8_t *data, size_t size);
 
+/**
+ * Gets the maximum data size that can be passed to
+ * pbdrv_bluetooth_start_broadcasting().
+ *
+ * This is only known once the Bluetooth controller has been initialized.
+ *
+ * @return              The maximum size in bytes.
+ */
+size_t pbdrv_bluetooth_get_max_broadcast_size(void);
+
 /**
  * Starts observing, non-connectable, non-scannable advertisements.
  *
@@ -591,7 +738,10 @@ pbio_error_t pbdrv_bluetooth_close_user_tasks(pbio_os_state_t *state, pbio_os_ti
  * @param [in] results                Array to store results.
  * @param [in] results_count          Number of results found.
  * @param [in] results_count_max      Maximum number of results to find. Will
- *                                    stop if externally reset to 0.
+ *                                    stop if externally reset to 0. May be
+ *                                    externally lowered to the current count
+ *                                    to end the scan early with the results
+ *                                    found so far.
  * @param [in] duration_ms            Duration of the inquiry scan in milliseconds.
  *                                    It will be internally rounded to the nearest
  *                                    supported nonzero value.
@@ -633,6 +783,10 @@ static inline bool pbdrv_bluetooth_hci_is_enabled(void) {
     return false;
 }
 
+static inline bool pbdrv_bluetooth_is_ready(void) {
+    return false;
+}
+
 static inline void pbdrv_bluetooth_set_host_connection_changed_callback(pbio_util_void_callback_t callback) {
 }
 
@@ -657,6 +811,24 @@ static inline bool pbdrv_bluetooth_tx_is_idle(void) {
     return true;
 }
 
+static inline void pbdrv_bluetooth_tx_flush(void) {
+}
+
+static inline void pbdrv_bluetooth_tx_set_line_buffered(bool line_buffered) {
+}
+
+static inline pbio_error_t pbdrv_bluetooth_tx_set_compression(bool compressed) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline void pbdrv_bluetooth_get_tx_rate(uint32_t *rate, uint32_t *rate_max) {
+    *rate = 0;
+    *rate_max = 0;
+}
+
+static inline void pbdrv_bluetooth_tx_discard(uint32_t size) {
+}
+
 static inline pbio_error_t pbdrv_bluetooth_send_event_notification(
     pbio_os_state_t *state, pbio_pybricks_event_t event, const uint8_t *data, size_t size) {
     return PBIO_ERROR_NOT_SUPPORTED;
@@ -705,6 +877,10 @@ static inline pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic(pbdrv
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbdrv_bluetooth_peripheral_write_characteristic_queued(pbdrv_bluetooth_peripheral_t *peripheral, uint16_t handle, uint8_t key, const uint8_t *data, size_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline pbio_error_t pbdrv_bluetooth_await_peripheral_command(pbio_os_state_t *state, void *context) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
@@ -717,6 +893,10 @@ static inline pbio_error_t pbdrv_bluetooth_start_broadcasting(const uint8_t *dat
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline size_t pbdrv_bluetooth_get_max_broadcast_size(void) {
+    return PBDRV_BLUETOOTH_MAX_ADV_SIZE;
+}
+
 static inline pbio_error_t pbdrv_bluetooth_start_observing(
     pbdrv_bluetooth_start_observing_callback_t callback) {
     return PBIO_ERROR_NOT_SUPPORTED;
@@ -18,6 +18,19 @@ void pbdrv_cache_prepare_before_dma(const void *buf, size_t sz);
 // by DMA peripherals. This invalidates the relevant cache lines.
 void pbdrv_cache_prepare_after_dma(const void *buf, size_t sz);
 
+// Gets a buffer ready to be written by DMA peripherals if it may share cache
+// lines with other data, such as a buffer passed in by a caller. This cleans
+// and invalidates the relevant cache lines, so that no dirty line can be
+// written back over the received data and the data around the buffer is
+// saved before pbdrv_cache_prepare_after_dma() discards the lines. The
+// shared data must not be written until the DMA is complete. Buffers declared
+// with PBDRV_DMA_BUF do not need this.
+void pbdrv_cache_prepare_before_dma_rx(void *buf, size_t sz);
+
+// Makes sure that code that we (the CPU) have written can be executed. This
+// cleans the relevant data cache lines and invalidates the instruction cache.
+void pbdrv_cache_prepare_exec(const void *buf, size_t sz);
+
 // Accesses a variable via the uncached memory alias
 #define PBDRV_UNCACHED(x)           (*(volatile __typeof__(x) *)((uintptr_t)(&(x)) + PBDRV_CONFIG_CACHE_UNCACHED_OFFSET))
 
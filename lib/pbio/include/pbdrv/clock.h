@@ -27,6 +27,21 @@ uint32_t pbdrv_clock_get_100us(void);
  */
 uint32_t pbdrv_clock_get_us(void);
 
+/**
+ * Gets a free running count for measuring short durations in code.
+ *
+ * This counts CPU cycles where the CPU has a cycle counter. Otherwise it is
+ * the finest hardware timer available. Only the difference between two
+ * readings is meaningful. Use pbdrv_clock_get_cycles_per_us() to convert it
+ * to time.
+ */
+uint32_t pbdrv_clock_get_cycles(void);
+
+/**
+ * Gets the number of counts per microsecond of pbdrv_clock_get_cycles().
+ */
+uint32_t pbdrv_clock_get_cycles_per_us(void);
+
 /**
  * Busy wait delay for a very short amount of time.
  *
@@ -37,6 +52,18 @@ uint32_t pbdrv_clock_get_us(void);
  */
 void pbdrv_clock_busy_delay_us(uint32_t us);
 
+/**
+ * Waits for an interrupt with the 1 ms clock tick stopped for up to the given
+ * duration.
+ *
+ * Must be called with interrupts disabled. The clock is corrected for the
+ * skipped ticks before returning, regardless of which interrupt woke the CPU.
+ * Only available on platforms that support tickless idle.
+ *
+ * @param [in]  duration    Maximum sleep time in milliseconds.
+ */
+void pbdrv_clock_wait_for_interrupt_tickless(uint32_t duration);
+
 #endif /* _PBDRV_CLOCK_H_ */
 
 /** @} */
@@ -57,4 +57,24 @@
 #define PBDRV_CONFIG_HAS_PORT_4 (0)
 #endif
 
+// set to (1) if the Bluetooth driver can broadcast with extended advertising
+#ifndef PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING
+#define PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING (0)
+#endif
+
+// set to (1) if the host may ask for stdout to be sent compressed over Bluetooth
+#ifndef PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION
+#define PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION (0)
+#endif
+
+// amount of recently sent stdout that compressed stdout may refer to
+#ifndef PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION_HISTORY_SIZE
+#define PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION_HISTORY_SIZE (512)
+#endif
+
+// set to (1) if the block device driver has a journal area that is written in place
+#ifndef PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL (PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL || PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM)
+#endif
+
 #endif // _PBDRV_CONFIG_H_
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: MIT
-// Copyright (c) 2019-2020 The Pybricks Authors
+// Copyright (c) 2019-2026 The Pybricks Authors
 
 /**
  * @addtogroup CounterDriver Driver: Counter
@@ -24,6 +24,7 @@ typedef struct _pbdrv_counter_dev_t pbdrv_counter_dev_t;
 pbio_error_t pbdrv_counter_get_dev(uint8_t id, pbdrv_counter_dev_t **dev);
 pbio_error_t pbdrv_counter_get_angle(pbdrv_counter_dev_t *dev, int32_t *rotations, int32_t *millidegrees);
 pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *millidegrees);
+pbio_error_t pbdrv_counter_get_edge_speed(pbdrv_counter_dev_t *dev, int32_t *speed);
 pbio_error_t pbdrv_counter_assert_type(pbdrv_counter_dev_t *dev, lego_device_type_id_t *expected_type_id);
 
 #else // PBDRV_CONFIG_COUNTER
@@ -38,6 +39,9 @@ static inline pbio_error_t pbdrv_counter_get_angle(pbdrv_counter_dev_t *dev, int
 static inline pbio_error_t pbdrv_counter_get_abs_angle(pbdrv_counter_dev_t *dev, int32_t *millidegrees) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
+static inline pbio_error_t pbdrv_counter_get_edge_speed(pbdrv_counter_dev_t *dev, int32_t *speed) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
 static inline pbio_error_t pbdrv_counter_assert_type(pbdrv_counter_dev_t *dev, lego_device_type_id_t *expected_type_id) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
@@ -9,6 +9,8 @@
 #ifndef _PBDRV_DISPLAY_H_
 #define _PBDRV_DISPLAY_H_
 
+#include <stdbool.h>
+
 #include <pbdrv/config.h>
 #include <pbio/image.h>
 
@@ -59,6 +61,38 @@ static inline void pbdrv_display_update(void) {
 
 #endif // PBDRV_CONFIG_DISPLAY
 
+#if PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+
+/**
+ * Enable or disable double buffering.
+ *
+ * While enabled, pbdrv_display_update() does nothing. Only
+ * pbdrv_display_swap() changes what is shown, so drawing can continue
+ * without partial frames appearing on the display.
+ *
+ * @param [in] enable  Whether to enable double buffering.
+ */
+void pbdrv_display_set_double_buffered(bool enable);
+
+/**
+ * Show the current content of the image container as one complete frame.
+ *
+ * The content is copied, so drawing may continue right away while the frame
+ * is sent to the display.
+ */
+void pbdrv_display_swap(void);
+
+#else // PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+
+static inline void pbdrv_display_set_double_buffered(bool enable) {
+}
+
+static inline void pbdrv_display_swap(void) {
+    pbdrv_display_update();
+}
+
+#endif // PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER
+
 #endif // _PBDRV_DISPLAY_H_
 
 /** @} */
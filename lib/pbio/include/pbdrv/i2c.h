@@ -9,6 +9,7 @@
 #ifndef _PBDRV_I2C_H_
 #define _PBDRV_I2C_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <pbdrv/config.h>
@@ -18,6 +19,20 @@
 
 typedef struct _pbdrv_i2c_dev_t pbdrv_i2c_dev_t;
 
+/**
+ * One write-then-read operation in a list of I2C operations.
+ */
+typedef struct {
+    /** Data to be sent to the device. Can be null if wlen is 0. */
+    const uint8_t *wdata;
+    /** Length of wdata. */
+    size_t wlen;
+    /** Buffer for data read from the device. Can be null if rlen is 0. */
+    uint8_t *rdata;
+    /** Length of rdata. */
+    size_t rlen;
+} pbdrv_i2c_op_t;
+
 #if PBDRV_CONFIG_I2C
 
 /**
@@ -63,6 +78,33 @@ pbio_error_t pbdrv_i2c_write_then_read(
     size_t rlen,
     bool nxt_quirk);
 
+/**
+ * Does a list of I2C operations on the same device, one after the other.
+ *
+ * This is the same as calling ::pbdrv_i2c_write_then_read for each operation,
+ * but without returning to the caller in between. The read data of each
+ * operation is copied to its own buffer, so all results remain valid after
+ * completion. Buses on different ports are independent, so lists on several
+ * ports run at the same time.
+ *
+ * @param [in]  state       Protothread state for async operation.
+ * @param [in]  i2c_dev     The I2C device.
+ * @param [in]  dev_addr    I2C device address (unshifted).
+ * @param [in]  ops         The operations. Must remain valid until completion.
+ * @param [in]  num_ops     Number of operations.
+ * @param [in]  nxt_quirk   Whether to use NXT I2C transaction quirk.
+ * @return                  ::PBIO_SUCCESS on success, or the error of the
+ *                          first operation that failed. Operations after
+ *                          that one are not done.
+ */
+pbio_error_t pbdrv_i2c_write_then_read_list(
+    pbio_os_state_t *state,
+    pbdrv_i2c_dev_t *i2c_dev,
+    uint8_t dev_addr,
+    const pbdrv_i2c_op_t *ops,
+    size_t num_ops,
+    bool nxt_quirk);
+
 #else // PBDRV_CONFIG_I2C
 
 static inline pbio_error_t pbdrv_i2c_get_instance(uint8_t id, pbdrv_i2c_dev_t **i2c_dev) {
@@ -82,6 +124,16 @@ static inline pbio_error_t pbdrv_i2c_write_then_read(
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbdrv_i2c_write_then_read_list(
+    pbio_os_state_t *state,
+    pbdrv_i2c_dev_t *i2c_dev,
+    uint8_t dev_addr,
+    const pbdrv_i2c_op_t *ops,
+    size_t num_ops,
+    bool nxt_quirk) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 #endif // PBDRV_CONFIG_I2C
 
 #endif // _PBDRV_I2C_H_
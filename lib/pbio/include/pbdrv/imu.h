@@ -58,11 +58,23 @@ pbio_error_t pbdrv_imu_get_imu(pbdrv_imu_dev_t **imu_dev, pbdrv_imu_config_t **c
 bool pbdrv_imu_is_stationary(pbdrv_imu_dev_t *imu_dev);
 
 /**
- * Callback to process one frame of unfiltered gyro and accelerometer data.
+ * Requests a new output data rate. It is applied in the background, after
+ * which stationary detection starts over.
  *
- * @param [in]  data        Array with unscaled gyro (xyz) and acceleration (xyz) samples to process.
+ * @param [in]  imu_dev     The IMU device instance.
+ * @param [in]  rate        The data rate in Hz: 104, 208, 416, 833, or 1666.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_INVALID_ARG if the rate is not supported.
+ */
+pbio_error_t pbdrv_imu_set_data_rate(pbdrv_imu_dev_t *imu_dev, uint32_t rate);
+
+/**
+ * Callback to process one or more frames of unfiltered gyro and accelerometer data.
+ *
+ * @param [in]  data        Array with @p num_frames frames of unscaled gyro (xyz) and acceleration (xyz) samples to process, oldest first.
+ * @param [in]  num_frames  Number of frames in @p data.
  */
-typedef void (*pbdrv_imu_handle_frame_data_func_t)(int16_t *data);
+typedef void (*pbdrv_imu_handle_frame_data_func_t)(int16_t *data, uint32_t num_frames);
 
 /**
  * Callback to process @p num_samples unfiltered gyro and accelerometer data
@@ -78,7 +90,7 @@ typedef void (*pbdrv_imu_handle_stationary_data_func_t)(const int32_t *gyro_data
  * Sets the data handlers for processing new data.
  *
  * @param [in]  imu_dev                The IMU device instance.
- * @param [in]  frame_data_func        Callback that handles one data frame.
+ * @param [in]  frame_data_func        Callback that handles a batch of data frames.
  * @param [in]  stationary_data_func   Callback that handles multiple stationary data frames.
  */
 void pbdrv_imu_set_data_handlers(pbdrv_imu_dev_t *imu_dev, pbdrv_imu_handle_frame_data_func_t frame_data_func, pbdrv_imu_handle_stationary_data_func_t stationary_data_func);
@@ -93,6 +105,10 @@ static inline bool pbdrv_imu_is_stationary(pbdrv_imu_dev_t *imu_dev) {
     return false;
 }
 
+static inline pbio_error_t pbdrv_imu_set_data_rate(pbdrv_imu_dev_t *imu_dev, uint32_t rate) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 #endif // PBDRV_CONFIG_IMU
 
 #endif // PBDRV_IMU_H
@@ -81,6 +81,19 @@ static inline pbio_error_t pbdrv_motor_driver_set_duty_cycle(pbdrv_motor_driver_
 
 #endif
 
+#if PBDRV_CONFIG_MOTOR_DRIVER_NXT
+
+/**
+ * Gets the time from setting a new duty cycle until it was sent to the
+ * coprocessor that drives the motors.
+ *
+ * @param [out] latency_us      Latency of the most recent change.
+ * @param [out] latency_max_us  Highest latency since boot.
+ */
+void pbdrv_motor_driver_nxt_get_latency(uint32_t *latency_us, uint32_t *latency_max_us);
+
+#endif // PBDRV_CONFIG_MOTOR_DRIVER_NXT
+
 #endif // _PBDRV_MOTOR_DRIVER_H_
 
 /** @} */
@@ -24,6 +24,8 @@ typedef struct _pbdrv_pwm_dev_t pbdrv_pwm_dev_t;
 
 pbio_error_t pbdrv_pwm_get_dev(uint8_t id, pbdrv_pwm_dev_t **dev);
 pbio_error_t pbdrv_pwm_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch, uint32_t value);
+void pbdrv_pwm_batch_begin(void);
+void pbdrv_pwm_batch_end(void);
 
 #else
 
@@ -36,6 +38,12 @@ static inline pbio_error_t pbdrv_pwm_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch,
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline void pbdrv_pwm_batch_begin(void) {
+}
+
+static inline void pbdrv_pwm_batch_end(void) {
+}
+
 #endif
 
 #endif /* _PBDRV_PWM_H_ */
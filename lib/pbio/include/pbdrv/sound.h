@@ -9,12 +9,25 @@
 #ifndef _PBDRV_SOUND_H_
 #define _PBDRV_SOUND_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbdrv/config.h>
 #include <pbio/error.h>
 
 
+/**
+ * Wave shapes for beeps.
+ */
+typedef enum {
+    /** Square wave. */
+    PBDRV_BEEP_WAVEFORM_SQUARE,
+    /** Sine wave. */
+    PBDRV_BEEP_WAVEFORM_SINE,
+    /** Triangle wave. */
+    PBDRV_BEEP_WAVEFORM_TRIANGLE,
+} pbdrv_beep_waveform_t;
+
 #if PBDRV_CONFIG_SOUND
 
 /**
@@ -25,6 +38,25 @@
  */
 void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator);
 
+#if PBDRV_CONFIG_SOUND_BEEP_SAMPLED
+/**
+ * Starts playing a wave of the given shape until pbdrv_sound_stop() is called.
+ *
+ * Samples for the last few combinations of shape and volume are kept, so
+ * repeating a beep does not need to generate them again.
+ *
+ * @param [in]  frequency           The frequency of the wave in Hz.
+ * @param [in]  sample_attenuator   The normalized attenuation to apply to get the requested volume.
+ * @param [in]  waveform            The shape of the wave.
+ */
+void pbdrv_beep_start_waveform(uint32_t frequency, uint16_t sample_attenuator, pbdrv_beep_waveform_t waveform);
+#else
+static inline void pbdrv_beep_start_waveform(uint32_t frequency, uint16_t sample_attenuator, pbdrv_beep_waveform_t waveform) {
+    // Only square waves are supported.
+    pbdrv_beep_start(frequency, sample_attenuator);
+}
+#endif
+
 #if PBDRV_CONFIG_SOUND_SAMPLED
 /**
  * Starts playing a sound repeatedly until pbdrv_sound_stop() is called.
@@ -36,6 +68,37 @@ void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator);
 void pbdrv_sound_start(const uint16_t *data, uint32_t length, uint32_t sample_rate);
 #endif
 
+#if PBDRV_CONFIG_SOUND_STREAM
+/**
+ * Fills the next samples of a sound stream. This is called from interrupt
+ * context, so it must be quick and must not block.
+ *
+ * @param [in]  context     The context given to pbdrv_sound_stream_start().
+ * @param [out] samples     Buffer for the next samples.
+ * @param [in]  length      The number of samples to fill.
+ * @return                  The number of samples filled. If this is less
+ *                          than @p length, the stream ends after these.
+ */
+typedef uint32_t (*pbdrv_sound_stream_fill_t)(void *context, uint16_t *samples, uint32_t length);
+
+/**
+ * Starts playing samples that are filled as needed until the stream ends or
+ * pbdrv_sound_stop() is called.
+ *
+ * @param [in]  fill        Function that fills the next samples.
+ * @param [in]  context     Context passed to @p fill.
+ * @param [in]  sample_rate The sample rate in Hz.
+ */
+void pbdrv_sound_stream_start(pbdrv_sound_stream_fill_t fill, void *context, uint32_t sample_rate);
+
+/**
+ * Checks whether all samples of the stream have been played.
+ *
+ * @return                  True if the stream ended or was stopped.
+ */
+bool pbdrv_sound_stream_is_done(void);
+#endif
+
 /**
  * Stops any currently playing sound.
  */
@@ -47,6 +110,9 @@ void pbdrv_sound_stop(void);
 static inline void pbdrv_beep_start(uint32_t frequency, uint16_t sample_attenuator) {
 }
 
+static inline void pbdrv_beep_start_waveform(uint32_t frequency, uint16_t sample_attenuator, pbdrv_beep_waveform_t waveform) {
+}
+
 static inline void pbdrv_sound_start(const uint16_t *data, uint32_t length, uint32_t sample_rate) {
 }
 
@@ -16,4 +16,35 @@
  */
 void pbdrv_stack_get_info(char **stack_start, char **stack_end);
 
+#if PBDRV_CONFIG_STACK_EMBEDDED
+
+/**
+ * Fills the unused part of the stack with a known pattern.
+ *
+ * This should be called once at boot, before the stack gets deep, so that
+ * ::pbdrv_stack_get_max_usage can find how far the stack has grown since.
+ */
+void pbdrv_stack_paint(void);
+
+/**
+ * Gets the most stack used since it was painted.
+ *
+ * This scans the stack for the first overwritten word, so it takes time
+ * proportional to the unused part of the stack.
+ *
+ * @return                    Peak stack use in bytes.
+ */
+size_t pbdrv_stack_get_max_usage(void);
+
+#else
+
+static inline void pbdrv_stack_paint(void) {
+}
+
+static inline size_t pbdrv_stack_get_max_usage(void) {
+    return 0;
+}
+
+#endif // PBDRV_CONFIG_STACK_EMBEDDED
+
 #endif // _PBDRV_STACK_H_
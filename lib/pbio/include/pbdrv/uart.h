@@ -53,6 +53,30 @@ uint32_t pbdrv_uart_in_waiting(pbdrv_uart_dev_t *uart_dev);
  */
 pbio_error_t pbdrv_uart_read(pbio_os_state_t *state, pbdrv_uart_dev_t *uart_dev, uint8_t *msg, uint32_t length, uint32_t timeout);
 
+/**
+ * Gets direct access to received data in the incoming buffer, without copying
+ * or consuming it. Only available if PBDRV_CONFIG_UART_PEEK is enabled.
+ *
+ * The data remains valid until it is discarded or overwritten by new data.
+ * This should only be used for data that is processed right away.
+ *
+ * @param [in]  uart_dev  The UART device.
+ * @param [in]  offset    Number of unread bytes to skip.
+ * @param [out] data      Pointer to the data in the incoming buffer.
+ * @return The number of bytes that can be read contiguously from @p data.
+ *         This may be less than what is available if the buffer wraps around.
+ */
+uint32_t pbdrv_uart_peek(pbdrv_uart_dev_t *uart_dev, uint32_t offset, const uint8_t **data);
+
+/**
+ * Removes data from the incoming buffer after processing it in place.
+ *
+ * @param [in]  uart_dev  The UART device.
+ * @param [in]  length    The number of bytes to remove. Must not be more than
+ *                        ::pbdrv_uart_in_waiting.
+ */
+void pbdrv_uart_discard(pbdrv_uart_dev_t *uart_dev, uint32_t length);
+
 /**
  * Asynchronously write to the UART.
  *
@@ -95,6 +95,13 @@ uint32_t pbdrv_usb_stdout_tx_available(void);
 */
 bool pbdrv_usb_stdout_tx_is_idle(void);
 
+/**
+ * Discards the oldest stdout data that is queued for sending via USB.
+ *
+ * @param size  [in]    The maximum number of bytes to discard.
+ */
+void pbdrv_usb_stdout_tx_discard(uint32_t size);
+
 /**
  * Indicates if a Pybricks app is connected and configured.
  *
@@ -156,6 +163,9 @@ static inline bool pbdrv_usb_stdout_tx_is_idle(void) {
     return true;
 }
 
+static inline void pbdrv_usb_stdout_tx_discard(uint32_t size) {
+}
+
 static inline bool pbdrv_usb_connection_is_active(void) {
     return false;
 }
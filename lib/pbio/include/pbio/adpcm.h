@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup ADPCM pbio/adpcm: IMA ADPCM decoder
+ *
+ * Decodes mono IMA ADPCM audio into samples for the sound driver, a few
+ * samples at a time, so a long clip only needs a small sample buffer.
+ *
+ * Data is either a raw stream of 4-bit codes, or a series of blocks as used
+ * in WAV files. Each block then starts with a 4-byte header containing the
+ * first sample and step index.
+ * @{
+ */
+
+#ifndef _PBIO_ADPCM_H_
+#define _PBIO_ADPCM_H_
+
+#include <stdint.h>
+
+/**
+ * Streaming IMA ADPCM decoder.
+ */
+typedef struct {
+    /** Encoded data. */
+    const uint8_t *data;
+    /** Size of the encoded data in bytes. */
+    uint32_t size;
+    /** Size of each block in bytes, or 0 for a raw stream without headers. */
+    uint32_t block_size;
+    /** Position in the encoded data, in 4-bit codes. */
+    uint32_t position;
+    /** Last decoded sample. */
+    int16_t predictor;
+    /** Index into the step size table. */
+    uint8_t step_index;
+    /** Number to multiply samples by to set the volume, up to INT16_MAX. */
+    uint16_t attenuator;
+} pbio_adpcm_decoder_t;
+
+void pbio_adpcm_decoder_init(pbio_adpcm_decoder_t *decoder, const uint8_t *data, uint32_t size, uint32_t block_size, uint16_t attenuator);
+uint32_t pbio_adpcm_decode(pbio_adpcm_decoder_t *decoder, uint16_t *samples, uint32_t length);
+
+#endif // _PBIO_ADPCM_H_
+
+/** @} */
@@ -14,6 +14,7 @@
 #ifndef _PBIO_BATTERY_H_
 #define _PBIO_BATTERY_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbio/config.h>
@@ -30,6 +31,11 @@
 void pbio_battery_init(void);
 /** @endcond */
 int32_t pbio_battery_get_average_voltage(void);
+int32_t pbio_battery_get_supply_voltage(void);
+int32_t pbio_battery_get_internal_resistance(void);
+void pbio_battery_set_program_running(bool running);
+pbio_error_t pbio_battery_get_program_charge(int32_t *charge);
+pbio_error_t pbio_battery_get_remaining_runtime(int32_t voltage_min, uint32_t *time);
 int32_t pbio_battery_get_duty_from_voltage(int32_t voltage);
 int32_t pbio_battery_get_voltage_from_duty(int32_t duty);
 int32_t pbio_battery_get_voltage_from_duty_pct(int32_t duty);
@@ -43,6 +49,25 @@ static inline int32_t pbio_battery_get_average_voltage(void) {
     return 0;
 }
 
+static inline int32_t pbio_battery_get_supply_voltage(void) {
+    return 0;
+}
+
+static inline int32_t pbio_battery_get_internal_resistance(void) {
+    return 0;
+}
+
+static inline void pbio_battery_set_program_running(bool running) {
+}
+
+static inline pbio_error_t pbio_battery_get_program_charge(int32_t *charge) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbio_battery_get_remaining_runtime(int32_t voltage_min, uint32_t *time) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline int32_t pbio_battery_get_duty_from_voltage(int32_t voltage) {
     return 0;
 }
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup ClockSync pbio/clock_sync: Clock synchronization
+ *
+ * Estimates the clock of another hub from timestamps it sends, such as in
+ * Bluetooth broadcasts, so that several hubs can share one clock.
+ *
+ * Each timestamp arrives some time after it was taken, so it is always behind
+ * the remote clock. The timestamp that arrives fastest in each time window is
+ * kept, and a line through the most recent of these gives both the offset and
+ * the drift between the clocks. The estimate is behind by the shortest delay
+ * seen, which is typically a few milliseconds.
+ * @{
+ */
+
+#ifndef _PBIO_CLOCK_SYNC_H_
+#define _PBIO_CLOCK_SYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Duration of the window in which the fastest timestamp is kept, in ms.
+ */
+#define PBIO_CLOCK_SYNC_WINDOW_MS (5000)
+
+/**
+ * Number of windows used to estimate offset and drift.
+ */
+#define PBIO_CLOCK_SYNC_NUM_POINTS (16)
+
+/**
+ * Estimates further from the prediction than this are taken to mean that the
+ * remote clock restarted, so the estimate starts over.
+ */
+#define PBIO_CLOCK_SYNC_MAX_JUMP_MS (1000)
+
+/**
+ * Offset between the clocks at a given local time.
+ */
+typedef struct {
+    /** Local time in ms. */
+    uint32_t time;
+    /** Remote time minus local time in ms. */
+    int32_t offset;
+} pbio_clock_sync_point_t;
+
+/**
+ * Estimator of a remote clock.
+ */
+typedef struct {
+    /** Fastest timestamps of past windows, oldest first once full. */
+    pbio_clock_sync_point_t points[PBIO_CLOCK_SYNC_NUM_POINTS];
+    /** Number of valid points. */
+    uint8_t num_points;
+    /** Index where the next point is stored. */
+    uint8_t next_point;
+    /** Whether a window has started. */
+    bool window_active;
+    /** Local time at which the current window started. */
+    uint32_t window_start;
+    /** Fastest timestamp of the current window. */
+    pbio_clock_sync_point_t window_best;
+    /** Offset of the fitted line at the time of the newest point. */
+    pbio_clock_sync_point_t fit;
+    /** Drift of the remote clock with respect to the local clock in ppm. */
+    int32_t drift;
+} pbio_clock_sync_t;
+
+void pbio_clock_sync_reset(pbio_clock_sync_t *sync);
+void pbio_clock_sync_add_sample(pbio_clock_sync_t *sync, uint32_t local_time, uint32_t remote_time);
+bool pbio_clock_sync_is_synced(const pbio_clock_sync_t *sync);
+uint32_t pbio_clock_sync_get_remote_time(const pbio_clock_sync_t *sync, uint32_t local_time);
+
+#endif // _PBIO_CLOCK_SYNC_H_
+
+/** @} */
@@ -119,6 +119,19 @@ void pbio_color_to_rgb(pbio_color_t color, pbio_color_rgb_t *rgb);
 void pbio_color_hsv_compress(const pbio_color_hsv_t *hsv, pbio_color_compressed_hsv_t *compressed);
 void pbio_color_hsv_expand(const pbio_color_compressed_hsv_t *compressed, pbio_color_hsv_t *hsv);
 
+/** Coordinates of an HSV color in the chroma-lightness-bicone. */
+typedef struct {
+    /** The x coordinate, scaled by 10000. */
+    int32_t x;
+    /** The y coordinate, scaled by 10000. */
+    int32_t y;
+    /** The z coordinate (lightness). */
+    int32_t z;
+} pbio_color_bicone_t;
+
+void pbio_color_hsv_to_bicone(const pbio_color_hsv_t *hsv, pbio_color_bicone_t *bicone);
+int32_t pbio_color_bicone_get_distance_squared(const pbio_color_bicone_t *a, const pbio_color_bicone_t *b);
+
 typedef int32_t (*pbio_color_distance_func_t)(const pbio_color_hsv_t *hsv_a, const pbio_color_hsv_t *hsv_b);
 
 int32_t pbio_color_get_distance_bicone_squared(const pbio_color_hsv_t *hsv_a, const pbio_color_hsv_t *hsv_b);
@@ -11,11 +11,25 @@
 #define PBIO_CONFIG_ENABLE_SYS (0)
 #endif
 
-// Control loop time
+// Control loop time. Builds may select a faster loop of 2 or 1 ms, for which
+// dedicated observer models are available in servo_settings.c, for example
+// with CFLAGS_EXTRA=-DPBIO_CONFIG_CONTROL_LOOP_TIME_MS=2. It must be a divisor
+// of 100 so the differentiator window spans exactly 100 ms.
 #ifndef PBIO_CONFIG_CONTROL_LOOP_TIME_MS
 #define PBIO_CONFIG_CONTROL_LOOP_TIME_MS (5)
 #endif
 
+#if PBIO_CONFIG_CONTROL_LOOP_TIME_MS < 1 || 100 % PBIO_CONFIG_CONTROL_LOOP_TIME_MS != 0
+#error "PBIO_CONFIG_CONTROL_LOOP_TIME_MS must be a divisor of 100."
+#endif
+
+// Coast the motors when the control loop did not run for this many
+// milliseconds, such as when a user program blocks the event loop, instead of
+// resuming control from a stale state. Zero disables it.
+#ifndef PBIO_CONFIG_CONTROL_LOOP_STARVED_MS
+#define PBIO_CONFIG_CONTROL_LOOP_STARVED_MS (0)
+#endif
+
 // Angle differentiation time window, defined as a multiple of the loop time.
 // This is the time window used for calculating the average speed, so 100ms.
 #define PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE (100 / PBIO_CONFIG_CONTROL_LOOP_TIME_MS)
@@ -24,10 +38,150 @@
 // Must be > PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE. This allows a user
 // program to get speed with additional control over the trade off between a
 // smooth but delayed value (long window) or noisy and fast value (short window).
+// Must be a power of two so the ring buffer index can be wrapped with a mask.
+// The default is the first power of two that holds three default windows.
 #ifndef PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE
-#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE * 3 + 1)
+#if PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE * 3 < 64
+#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (64)
+#elif PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE * 3 < 128
+#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (128)
+#elif PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE * 3 < 256
+#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (256)
+#else
+#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (512)
+#endif
+#endif
+
+#if PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE <= PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE
+#error "PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE is too small for this control loop time."
+#endif
+
+#if PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE & (PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE - 1)
+#error "PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE must be a power of two."
+#endif
+
+// Number of position control commands that can wait to start after the
+// current one, per controller.
+#ifndef PBIO_CONFIG_CONTROL_QUEUE_SIZE
+#define PBIO_CONFIG_CONTROL_QUEUE_SIZE (4)
+#endif
+
+// Number of error bands in each precomputed proportional gain schedule.
+#ifndef PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE
+#define PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE (8)
+#endif
+
+// Per-process execution time statistics in the event loop. This adds a few
+// clock reads to each process iteration, so it is off by default. Builds can
+// enable it with CFLAGS_EXTRA=-DPBIO_CONFIG_OS_PROFILE=1.
+#ifndef PBIO_CONFIG_OS_PROFILE
+#define PBIO_CONFIG_OS_PROFILE (0)
+#endif
+
+// Stop the 1 ms clock tick while the hub is idle and all processes are
+// waiting for timers. Platforms that enable this must provide the
+// pbio_os_hook_wait_for_interrupt_tickless() hook.
+#ifndef PBIO_CONFIG_OS_TICKLESS
+#define PBIO_CONFIG_OS_TICKLESS (0)
+#endif
+
+// Track the longest stall of the event loop, and whether a process or code
+// outside the event loop caused it. The control loop uses this to report what
+// made it miss a deadline. This adds a clock read to each process iteration.
+#ifndef PBIO_CONFIG_OS_STALL_MONITOR
+#define PBIO_CONFIG_OS_STALL_MONITOR (1)
+#endif
+
+// Integrate the IMU attitude with the second order midpoint method instead of
+// forward Euler. This evaluates the quaternion rate of change twice for each
+// sample, which reduces integration drift during fast rotations.
+#ifndef PBIO_CONFIG_IMU_INTEGRATION_RK2
+#define PBIO_CONFIG_IMU_INTEGRATION_RK2 (0)
+#endif
+
+// Extrapolate the IMU heading used by drive bases from the most recent sample
+// to the time of the control step, using the latest angular rate. This
+// compensates for the IMU and control loop running at unrelated rates.
+#ifndef PBIO_CONFIG_IMU_HEADING_EXTRAPOLATION
+#define PBIO_CONFIG_IMU_HEADING_EXTRAPOLATION (1)
+#endif
+
+// Record time-stamped sensor and motor input with pbio_trace_record() so that
+// sessions can be replayed. Each event costs a clock read and a copy while
+// recording, so it is off by default.
+#ifndef PBIO_CONFIG_TRACE
+#define PBIO_CONFIG_TRACE (0)
+#endif
+
+// Number of events kept by pbio_tracepoint_record() to find the cause of
+// stalls in the event loop. Must be a power of two. Zero disables it.
+#ifndef PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+#define PBIO_CONFIG_TRACEPOINT_NUM_EVENTS (0)
+#endif
+
+// Number of samples kept by the control recorder, shared by all controllers.
+// Each sample takes 36 bytes. Zero disables it.
+#ifndef PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+#define PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES (0)
+#endif
+
+// Number of recently computed angle trajectories to keep. Programs that repeat
+// the same relative move can then reuse the result instead of solving for
+// the trajectory again. Each entry takes 92 bytes. Zero disables it.
+#ifndef PBIO_CONFIG_TRAJECTORY_CACHE_SIZE
+#define PBIO_CONFIG_TRAJECTORY_CACHE_SIZE (0)
+#endif
+
+// Place functions marked with PBIO_HOT in RAM instead of flash. This avoids
+// flash wait states on the control path at the cost of RAM. Platforms that
+// enable this must link the .ramfunc section into initialized data.
+#ifndef PBIO_CONFIG_HOT_CODE_IN_RAM
+#define PBIO_CONFIG_HOT_CODE_IN_RAM (0)
 #endif
 
 #define PBIO_CONFIG_NUM_DRIVEBASES (PBIO_CONFIG_SERVO_NUM_DEV / 2)
 
+// Number of servos that can have queued commands at the same time. The queues
+// are shared, since few programs queue commands on every motor at once. The
+// default is one for each servo.
+#ifndef PBIO_CONFIG_CONTROL_QUEUE_NUM
+#define PBIO_CONFIG_CONTROL_QUEUE_NUM (PBIO_CONFIG_SERVO_NUM_DEV)
+#endif
+
+// Maximum number of motors on each side of a drive base, such as the front
+// and rear wheels of a skid-steer vehicle.
+#ifndef PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE
+#define PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE (2)
+#endif
+
+// Allow servos to identify their own feedforward model with a step
+// response. This uses floating point math.
+#ifndef PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+#define PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION (1)
+#endif
+
+// Integrate the (x, y, heading) pose of drive bases in the control loop.
+// This uses floating point math.
+#ifndef PBIO_CONFIG_DRIVEBASE_ODOMETRY
+#define PBIO_CONFIG_DRIVEBASE_ODOMETRY (1)
+#endif
+
+// Maximum number of segments in a drive base path.
+#ifndef PBIO_CONFIG_DRIVEBASE_PATH_SIZE
+#define PBIO_CONFIG_DRIVEBASE_PATH_SIZE (16)
+#endif
+
+// Number of LEGO UART device types for which the device info is remembered
+// after synchronizing. When a device of a known type is connected again, its
+// info messages are skipped instead of parsed.
+#ifndef PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+#define PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE (4)
+#endif
+
+// Send Power Functions commands of the Color and Distance Sensor from a
+// queue in the background.
+#ifndef PBIO_CONFIG_PF_IR
+#define PBIO_CONFIG_PF_IR (0)
+#endif
+
 #endif // _PBIO_CONFIG_H_
@@ -17,6 +17,7 @@
 #include <stdint.h>
 
 #include <pbio/angle.h>
+#include <pbio/config.h>
 #include <pbio/control_settings.h>
 #include <pbio/error.h>
 #include <pbio/port.h>
@@ -128,6 +129,24 @@ typedef enum {
 /**
  * Controller status and state.
  */
+/**
+ * Position control command that waits to start after the current one.
+ */
+typedef struct _pbio_control_queued_command_t {
+    /**
+     * Target position (control units).
+     */
+    pbio_angle_t target;
+    /**
+     * Top speed on the way to the target (control units).
+     */
+    int32_t speed;
+    /**
+     * What to do when reaching the target position.
+     */
+    pbio_control_on_completion_t on_completion;
+} pbio_control_queued_command_t;
+
 typedef struct _pbio_control_t {
     /**
      * The type of controller that is currently active.
@@ -167,6 +186,24 @@ typedef struct _pbio_control_t {
      * Control state flags such as being on target and/or being stalled.
      */
     pbio_control_status_flag_t status;
+    /**
+     * Position control commands to start after the current one, oldest first.
+     * This is taken from a shared pool while commands are queued, and is
+     * NULL otherwise.
+     */
+    pbio_control_queued_command_t *queue;
+    /**
+     * Number of commands in the queue.
+     */
+    uint8_t queue_size;
+    /**
+     * Whether the active command is tracking a stream of setpoints.
+     */
+    bool track_active;
+    /**
+     * Time of the most recent tracking setpoint (ticks).
+     */
+    uint32_t track_time;
 } pbio_control_t;
 
 // Time and reference functions:
@@ -201,8 +238,11 @@ pbio_dcmotor_actuation_t pbio_control_passive_completion_to_actuation_type(pbio_
 
 pbio_error_t pbio_control_start_position_control(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t position, int32_t speed, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_control_start_position_control_relative(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t distance, int32_t speed, pbio_control_on_completion_t on_completion, bool allow_trajectory_shift);
+pbio_error_t pbio_control_start_position_control_chained(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t distance, int32_t speed, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_control_start_position_control_hold(pbio_control_t *ctl, uint32_t time_now, int32_t position);
+pbio_error_t pbio_control_start_position_control_track(pbio_control_t *ctl, uint32_t time_now, int32_t position);
 pbio_error_t pbio_control_start_timed_control(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, uint32_t duration, int32_t speed, pbio_control_on_completion_t on_completion);
+pbio_error_t pbio_control_queue_position_control(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t position, int32_t speed, pbio_control_on_completion_t on_completion);
 
 #endif // _PBIO_CONTROL_H_
 
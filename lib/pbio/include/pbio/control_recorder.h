@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup ControlRecorder pbio/control_recorder: Recording all controllers
+ *
+ * Records the state of every active controller on every control loop update
+ * into one shared ring buffer. Unlike @ref Logger, this needs no buffer per
+ * motor and is not downsampled. Recording can be stopped automatically a
+ * given number of samples after an event such as a stall, so the moments
+ * leading up to a rare glitch are kept.
+ * @{
+ */
+
+#ifndef _PBIO_CONTROL_RECORDER_H_
+#define _PBIO_CONTROL_RECORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/config.h>
+#include <pbio/control.h>
+
+/**
+ * Events that stop recording after the configured number of samples.
+ */
+typedef enum {
+    /** A controller is stalled. */
+    PBIO_CONTROL_RECORDER_TRIGGER_STALL = 1 << 0,
+    /**
+     * The position error of a controller exceeds the threshold, such as on
+     * overshoot or when it falls behind.
+     */
+    PBIO_CONTROL_RECORDER_TRIGGER_ERROR = 1 << 1,
+} pbio_control_recorder_trigger_t;
+
+/**
+ * State of the recorder.
+ */
+typedef enum {
+    /** Not recording. */
+    PBIO_CONTROL_RECORDER_STATE_IDLE,
+    /** Recording and waiting for a trigger, overwriting the oldest samples. */
+    PBIO_CONTROL_RECORDER_STATE_ARMED,
+    /** Triggered, recording the remaining samples. */
+    PBIO_CONTROL_RECORDER_STATE_TRIGGERED,
+    /** Recording completed after a trigger. */
+    PBIO_CONTROL_RECORDER_STATE_DONE,
+} pbio_control_recorder_state_t;
+
+/**
+ * State of one controller during one control loop update.
+ *
+ * Positions are in application units, such as degrees or millimeters, and
+ * speeds in application units per second.
+ */
+typedef struct {
+    /** The controller. */
+    const pbio_control_t *ctl;
+    /** Time of the update (control ticks). */
+    uint32_t time;
+    /** Reference position. */
+    int32_t position_ref;
+    /** Estimated position. */
+    int32_t position_estimate;
+    /** Position error used by the controller, including integration pauses. */
+    int32_t position_error;
+    /** Reference speed. */
+    int32_t speed_ref;
+    /** Estimated speed. */
+    int32_t speed_estimate;
+    /** Actuation payload, such as torque (uNm). */
+    int32_t actuation_value;
+    /** Actuation type, a ::pbio_dcmotor_actuation_t. */
+    uint8_t actuation;
+    /** Control status, as ::pbio_control_status_flag_t bits. */
+    uint8_t status;
+} pbio_control_recorder_sample_t;
+
+#if PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+
+void pbio_control_recorder_start(uint32_t triggers, int32_t error_threshold, uint32_t num_samples_after_trigger);
+void pbio_control_recorder_trigger(void);
+void pbio_control_recorder_stop(void);
+pbio_control_recorder_state_t pbio_control_recorder_get_state(void);
+uint32_t pbio_control_recorder_get_samples(pbio_control_recorder_sample_t *samples, uint32_t max_samples);
+void pbio_control_recorder_add(const pbio_control_recorder_sample_t *sample);
+
+static inline bool pbio_control_recorder_is_recording(void) {
+    pbio_control_recorder_state_t state = pbio_control_recorder_get_state();
+    return state == PBIO_CONTROL_RECORDER_STATE_ARMED || state == PBIO_CONTROL_RECORDER_STATE_TRIGGERED;
+}
+
+#else
+
+static inline void pbio_control_recorder_start(uint32_t triggers, int32_t error_threshold, uint32_t num_samples_after_trigger) {
+}
+static inline void pbio_control_recorder_trigger(void) {
+}
+static inline void pbio_control_recorder_stop(void) {
+}
+static inline pbio_control_recorder_state_t pbio_control_recorder_get_state(void) {
+    return PBIO_CONTROL_RECORDER_STATE_IDLE;
+}
+static inline uint32_t pbio_control_recorder_get_samples(pbio_control_recorder_sample_t *samples, uint32_t max_samples) {
+    return 0;
+}
+static inline void pbio_control_recorder_add(const pbio_control_recorder_sample_t *sample) {
+}
+static inline bool pbio_control_recorder_is_recording(void) {
+    return false;
+}
+
+#endif // PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+
+#endif // _PBIO_CONTROL_RECORDER_H_
+
+/** @} */
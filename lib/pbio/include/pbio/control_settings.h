@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include <pbio/angle.h>
+#include <pbio/config.h>
 #include <pbio/error.h>
 #include <pbio/trajectory.h>
 
@@ -20,6 +21,24 @@
  * @{
  */
 
+/**
+ * Proportional gain as a function of an absolute error, in bands of equal width.
+ */
+typedef struct _pbio_control_kp_schedule_t {
+    /**
+     * Error where the first band starts. Smaller errors use the first band.
+     */
+    int32_t start;
+    /**
+     * Width of each band. Errors beyond the last band use the last band.
+     */
+    int32_t band;
+    /**
+     * Proportional gain for each band.
+     */
+    int32_t kp[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE];
+} pbio_control_kp_schedule_t;
+
 /**
  * Control settings.
  */
@@ -101,6 +120,16 @@ typedef struct _pbio_control_settings_t {
      * Threshold speed below which to use the lower kp constant.
      */
     int32_t pid_kp_low_speed_threshold;
+    /**
+     * Gain at low speeds by position error. Generated from the values above,
+     * but it may be changed to shape the response.
+     */
+    pbio_control_kp_schedule_t kp_schedule_error;
+    /**
+     * Gain at low speeds by distance to the final target. Generated from the
+     * values above so that maximum actuation is used close to the target.
+     */
+    pbio_control_kp_schedule_t kp_schedule_target;
     /**
      * Accumulated position error feedback constant.
      */
@@ -154,6 +183,9 @@ void pbio_control_settings_get_target_tolerances(const pbio_control_settings_t *
 pbio_error_t pbio_control_settings_set_target_tolerances(pbio_control_settings_t *s, int32_t speed, int32_t position);
 void pbio_control_settings_get_stall_tolerances(const pbio_control_settings_t *s, int32_t *speed, uint32_t *time);
 pbio_error_t pbio_control_settings_set_stall_tolerances(pbio_control_settings_t *s, int32_t speed, uint32_t time);
+void pbio_control_settings_update_kp_schedule(pbio_control_settings_t *s);
+void pbio_control_settings_get_kp_schedule(const pbio_control_settings_t *s, int32_t *band, int32_t *kp);
+pbio_error_t pbio_control_settings_set_kp_schedule(pbio_control_settings_t *s, int32_t band, const int32_t *kp);
 
 #endif // _PBIO_CONTROL_SETTINGS_H_
 
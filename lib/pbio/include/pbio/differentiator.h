@@ -25,7 +25,8 @@
  *
  * This works by keeping a ring buffer of position increments between each
  * loop iteration. The speed is the average position difference across a given
- * time window.
+ * time window. The sum across the default window is kept up to date as
+ * samples are added, so the speed for the control loop takes constant time.
  */
 typedef struct _pbio_differentiator_t {
     /**
@@ -36,10 +37,14 @@ typedef struct _pbio_differentiator_t {
      * Ring buffer of increments.
      */
     int16_t history[PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE];
+    /**
+     * Sum of the newest ::PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE increments.
+     */
+    int32_t window_sum;
     /**
      * Ring buffer index of the newest sampe.
      */
-    uint8_t index;
+    uint16_t index;
 } pbio_differentiator_t;
 
 int32_t pbio_differentiator_update_and_get_speed(pbio_differentiator_t *dif, const pbio_angle_t *angle);
@@ -20,6 +20,43 @@
 
 #if PBIO_CONFIG_NUM_DRIVEBASES > 0
 
+/**
+ * Segment of a drive base path, given by the user.
+ */
+typedef struct _pbio_drivebase_path_segment_t {
+    /**
+     * Radius of the arc in mm, positive to the right and negative to the
+     * left. Zero means driving straight.
+     */
+    int32_t radius;
+    /**
+     * Distance to drive along the segment in mm, negative for reverse.
+     */
+    int32_t distance;
+} pbio_drivebase_path_segment_t;
+
+/**
+ * Segment of a drive base path, converted to controller commands.
+ */
+typedef struct _pbio_drivebase_path_step_t {
+    /**
+     * Distance to drive beyond the previous target in mm.
+     */
+    int32_t distance;
+    /**
+     * Angle to turn beyond the previous target in degrees.
+     */
+    int32_t angle;
+    /**
+     * What to do when the distance controller reaches its target.
+     */
+    pbio_control_on_completion_t on_completion_distance;
+    /**
+     * What to do when the heading controller reaches its target.
+     */
+    pbio_control_on_completion_t on_completion_heading;
+} pbio_drivebase_path_step_t;
+
 typedef struct _pbio_drivebase_t {
     /**
      * Whether to use the gyro for heading control, and if so which type.
@@ -29,8 +66,18 @@ typedef struct _pbio_drivebase_t {
      * Synchronization state to indicate that one or more controllers are paused.
      */
     bool control_paused;
-    pbio_servo_t *left;
-    pbio_servo_t *right;
+    /**
+     * Servos on the left side. The first one is used for the settings.
+     */
+    pbio_servo_t *left[PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE];
+    /**
+     * Servos on the right side. The first one is used for the settings.
+     */
+    pbio_servo_t *right[PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE];
+    /**
+     * Number of servos on each side.
+     */
+    uint8_t motors_per_side;
     /**
      * Offset of the reported heading angle with respect to the measured value.
      *
@@ -49,9 +96,46 @@ typedef struct _pbio_drivebase_t {
      * Distance controller.
      */
     pbio_control_t control_distance;
+    /**
+     * Steps of the ongoing path, if any.
+     */
+    pbio_drivebase_path_step_t path[PBIO_CONFIG_DRIVEBASE_PATH_SIZE];
+    /**
+     * Number of steps in the ongoing path, or 0 if there is none.
+     */
+    uint8_t path_size;
+    /**
+     * Index of the next path step to start.
+     */
+    uint8_t path_index;
+    #if PBIO_CONFIG_DRIVEBASE_ODOMETRY
+    /**
+     * Position in mm along the heading at the last reset.
+     */
+    float odometry_x;
+    /**
+     * Position in mm to the right of the heading at the last reset.
+     */
+    float odometry_y;
+    /**
+     * Heading in degrees at the previous odometry update.
+     */
+    float odometry_heading;
+    /**
+     * Distance (control units) at the previous odometry update.
+     */
+    pbio_angle_t odometry_distance;
+    /**
+     * Whether the previous values are valid, so the next update can
+     * integrate from there.
+     */
+    bool odometry_valid;
+    #endif // PBIO_CONFIG_DRIVEBASE_ODOMETRY
 } pbio_drivebase_t;
 
 pbio_error_t pbio_drivebase_get_drivebase(pbio_drivebase_t **db_address, pbio_servo_t *left, pbio_servo_t *right, int32_t wheel_diameter, int32_t axle_track);
+pbio_error_t pbio_drivebase_get_drivebase_multi(pbio_drivebase_t **db_address, pbio_servo_t **left, pbio_servo_t **right, uint8_t motors_per_side, int32_t wheel_diameter, int32_t axle_track);
+pbio_drivebase_t *pbio_drivebase_by_index(uint8_t index);
 
 // Drive base status:
 
@@ -68,6 +152,7 @@ pbio_error_t pbio_drivebase_drive_curve(pbio_drivebase_t *db, int32_t radius, in
 pbio_error_t pbio_drivebase_drive_turn(pbio_drivebase_t *db, int32_t angle, bool absolute, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_drivebase_drive_arc_angle(pbio_drivebase_t *db, int32_t radius, int32_t angle, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_drivebase_drive_arc_distance(pbio_drivebase_t *db, int32_t radius, int32_t distance, pbio_control_on_completion_t on_completion);
+pbio_error_t pbio_drivebase_drive_path(pbio_drivebase_t *db, const pbio_drivebase_path_segment_t *segments, uint8_t num_segments, pbio_control_on_completion_t on_completion);
 
 // Infinite driving:
 
@@ -79,6 +164,9 @@ pbio_error_t pbio_drivebase_stop(pbio_drivebase_t *db, pbio_control_on_completio
 
 pbio_error_t pbio_drivebase_get_state_user(pbio_drivebase_t *db, int32_t *distance, int32_t *drive_speed, int32_t *angle, int32_t *turn_rate);
 pbio_error_t pbio_drivebase_get_state_user_angle(pbio_drivebase_t *db, float *angle);
+#if PBIO_CONFIG_DRIVEBASE_ODOMETRY
+pbio_error_t pbio_drivebase_get_pose(pbio_drivebase_t *db, float *x, float *y, float *heading);
+#endif
 pbio_error_t pbio_drivebase_reset(pbio_drivebase_t *db, int32_t distance, int32_t angle);
 pbio_error_t pbio_drivebase_get_drive_settings(const pbio_drivebase_t *db, int32_t *drive_speed, int32_t *drive_acceleration, int32_t *drive_deceleration, int32_t *turn_rate, int32_t *turn_acceleration, int32_t *turn_deceleration);
 pbio_error_t pbio_drivebase_set_drive_settings(pbio_drivebase_t *db, int32_t drive_speed, int32_t drive_acceleration, int32_t drive_deceleration, int32_t turn_rate, int32_t turn_acceleration, int32_t turn_deceleration);
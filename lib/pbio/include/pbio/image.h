@@ -15,6 +15,28 @@
 #include <stdint.h>
 #include <stddef.h>
 
+/**
+ * Pixel storage format.
+ *
+ * The value is the base 2 logarithm of the number of bits per pixel.
+ */
+typedef enum _pbio_image_format_t {
+    /**
+     * One bit per pixel, eight pixels per byte. The first pixel is in the
+     * most significant bit.
+     */
+    PBIO_IMAGE_FORMAT_1BPP = 0,
+    /**
+     * Two bits per pixel, four pixels per byte. The first pixel is in the
+     * most significant bits.
+     */
+    PBIO_IMAGE_FORMAT_2BPP = 1,
+    /**
+     * One byte per pixel.
+     */
+    PBIO_IMAGE_FORMAT_8BPP = 3,
+} pbio_image_format_t;
+
 /**
  * Image container.
  *
@@ -25,9 +47,10 @@ typedef struct _pbio_image_t {
     /**
      * Start of pixel buffer storing the pixels values.
      *
-     * Each pixel is stored using one byte and is expected to be a value
-     * between 0 and some number fitting in one byte. This code has no opinion
-     * on the maximum value as long as it fits.
+     * With ::PBIO_IMAGE_FORMAT_8BPP, each pixel is stored using one byte and
+     * is expected to be a value between 0 and some number fitting in one
+     * byte. This code has no opinion on the maximum value as long as it fits.
+     * Packed formats store smaller values, larger ones are clamped.
      *
      * Rows are continuous in memory.
      *
@@ -51,6 +74,16 @@ typedef struct _pbio_image_t {
      * using negative value.
      */
     int stride;
+    /**
+     * How pixels are stored in the pixel buffer.
+     */
+    pbio_image_format_t format;
+    /**
+     * For packed formats, index of the first pixel of each row within the
+     * first byte. This is used by sub-images that do not start on a byte
+     * boundary. Always 0 for ::PBIO_IMAGE_FORMAT_8BPP.
+     */
+    int pixel_offset;
     /**
      * Font for text printing (pbio_image_print* functions).
      */
@@ -84,8 +117,18 @@ typedef struct _pbio_image_monochrome_t {
     /**
      * One byte is 8 pixels. High is black, low is transparent. Most
      * significant bit is first pixel.
+     *
+     * If rle_size is nonzero, this is run-length encoded instead. Each byte
+     * is the number of pixels in a run, going through the rows from top to
+     * bottom. Runs alternate between transparent and black, starting with
+     * transparent. Runs longer than 255 pixels are split with a zero length
+     * run in between.
      */
     const uint8_t *data;
+    /**
+     * Number of bytes in run-length encoded data, or zero if not encoded.
+     */
+    int rle_size;
 } pbio_image_monochrome_t;
 
 /**
@@ -115,6 +158,11 @@ typedef struct _pbio_image_rect_t {
 void pbio_image_init(pbio_image_t *image, uint8_t *pixels, int width,
     int height, int stride);
 
+void pbio_image_init_format(pbio_image_t *image, uint8_t *pixels, int width,
+    int height, int stride, pbio_image_format_t format);
+
+int pbio_image_get_min_stride(pbio_image_format_t format, int width);
+
 void pbio_image_init_sub(pbio_image_t *image, const pbio_image_t *source,
     int x, int y, int width, int height);
 
@@ -131,6 +179,8 @@ void pbio_image_draw_image_transparent_from_monochrome(pbio_image_t *image,
 
 void pbio_image_draw_pixel(pbio_image_t *image, int x, int y, uint8_t value);
 
+uint8_t pbio_image_get_pixel(const pbio_image_t *image, int x, int y);
+
 void pbio_image_draw_hline(pbio_image_t *image, int x, int y, int l,
     uint8_t value);
 
@@ -183,6 +233,11 @@ int pbio_image_printf(pbio_image_t *image, const char *fmt, ...);
 
 static inline void pbio_image_init(pbio_image_t *image, uint8_t *pixels, int width, int height, int stride) {
 }
+static inline void pbio_image_init_format(pbio_image_t *image, uint8_t *pixels, int width, int height, int stride, pbio_image_format_t format) {
+}
+static inline int pbio_image_get_min_stride(pbio_image_format_t format, int width) {
+    return 0;
+}
 static inline void pbio_image_init_sub(pbio_image_t *image, const pbio_image_t *source, int x, int y, int width, int height) {
 }
 static inline void pbio_image_fill(pbio_image_t *image, uint8_t value) {
@@ -193,6 +248,9 @@ static inline void pbio_image_draw_image_transparent(pbio_image_t *image, const
 }
 static inline void pbio_image_draw_pixel(pbio_image_t *image, int x, int y, uint8_t value) {
 }
+static inline uint8_t pbio_image_get_pixel(const pbio_image_t *image, int x, int y) {
+    return 0;
+}
 static inline void pbio_image_draw_hline(pbio_image_t *image, int x, int y, int l, uint8_t value) {
 }
 static inline void pbio_image_draw_vline(pbio_image_t *image, int x, int y, int l, uint8_t value) {
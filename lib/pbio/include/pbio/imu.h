@@ -37,6 +37,11 @@ typedef enum {
     PBIO_IMU_HEADING_TYPE_3D,
 } pbio_imu_heading_type_t;
 
+/**
+ * Default output data rate of the IMU in Hz.
+ */
+#define PBIO_IMU_DATA_RATE_DEFAULT (833)
+
 /**
  * IMU settings flags.
  *
@@ -136,6 +141,14 @@ void pbio_imu_get_heading_scaled(pbio_imu_heading_type_t type, pbio_angle_t *hea
 
 void pbio_orientation_imu_get_orientation(pbio_geometry_matrix_3x3_t *rotation);
 
+uint32_t pbio_imu_get_data_time(void);
+
+pbio_error_t pbio_imu_set_mode(uint32_t rate, pbio_imu_heading_type_t fusion);
+
+void pbio_imu_get_mode(uint32_t *rate, pbio_imu_heading_type_t *fusion);
+
+void pbio_imu_reset_mode(void);
+
 #else // PBIO_CONFIG_IMU
 
 static inline void pbio_imu_init(void) {
@@ -197,6 +210,22 @@ static inline void pbio_imu_get_heading_scaled(pbio_imu_heading_type_t type, pbi
 static inline void pbio_orientation_imu_get_orientation(pbio_geometry_matrix_3x3_t *rotation) {
 }
 
+static inline uint32_t pbio_imu_get_data_time(void) {
+    return 0;
+}
+
+static inline pbio_error_t pbio_imu_set_mode(uint32_t rate, pbio_imu_heading_type_t fusion) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline void pbio_imu_get_mode(uint32_t *rate, pbio_imu_heading_type_t *fusion) {
+    *rate = 0;
+    *fusion = PBIO_IMU_HEADING_TYPE_NONE;
+}
+
+static inline void pbio_imu_reset_mode(void) {
+}
+
 
 #endif // PBIO_CONFIG_IMU
 
@@ -40,6 +40,21 @@ int32_t pbio_int_math_sqrt(int32_t n);
 int32_t pbio_int_math_sin_deg(int32_t x);
 int32_t pbio_int_math_cos_deg(int32_t x);
 
+// Division by multiplication with a precomputed reciprocal.
+
+/**
+ * Reciprocal of a divisor that is used many times.
+ */
+typedef struct {
+    /** The divisor. */
+    int32_t divisor;
+    /** 2^37 divided by the absolute divisor, rounded up. */
+    uint32_t multiplier;
+} pbio_int_math_reciprocal_t;
+
+void pbio_int_math_reciprocal_init(pbio_int_math_reciprocal_t *reciprocal, int32_t divisor);
+int32_t pbio_int_math_reciprocal_div(const pbio_int_math_reciprocal_t *reciprocal, int32_t n);
+
 // Interpolation
 
 /**
@@ -28,6 +28,14 @@ typedef struct {
     uint8_t num_animation_cells;
     /** The index of the currently displayed animation cell. */
     uint8_t current_cell;
+    /** The last displayed animation cell, or NULL if all pixels must be updated. */
+    const uint8_t *previous_cell;
+    /** Scrolling column data. Bit r of each byte is row r, starting at the top. */
+    const uint8_t *scroll_columns;
+    /** The number of columns in @p scroll_columns */
+    uint16_t num_scroll_columns;
+    /** The index of the column currently shown at the left edge of the matrix. */
+    uint16_t scroll_offset;
     /** Animation update rate in milliseconds. */
     uint16_t interval;
     /** Size of the matrix (assumes matrix is square). */
@@ -48,6 +56,7 @@ pbio_error_t pbio_light_matrix_set_rows(pbio_light_matrix_t *light_matrix, const
 pbio_error_t pbio_light_matrix_set_pixel(pbio_light_matrix_t *light_matrix, uint8_t row, uint8_t col, uint8_t brightness, bool clear_animation);
 pbio_error_t pbio_light_matrix_set_image(pbio_light_matrix_t *light_matrix, const uint8_t *image);
 void pbio_light_matrix_start_animation(pbio_light_matrix_t *light_matrix, const uint8_t *cells, uint8_t num_cells, uint16_t interval);
+void pbio_light_matrix_start_scroll(pbio_light_matrix_t *light_matrix, const uint8_t *columns, uint16_t num_columns, uint16_t interval);
 void pbio_light_matrix_stop_animation(pbio_light_matrix_t *light_matrix);
 
 #else // PBIO_CONFIG_LIGHT_MATRIX
@@ -82,6 +91,9 @@ static inline pbio_error_t pbio_light_matrix_set_image(pbio_light_matrix_t *ligh
 static inline void pbio_light_matrix_start_animation(pbio_light_matrix_t *light_matrix, const uint8_t *cells, uint8_t num_cells, uint16_t interval) {
 }
 
+static inline void pbio_light_matrix_start_scroll(pbio_light_matrix_t *light_matrix, const uint8_t *columns, uint16_t num_columns, uint16_t interval) {
+}
+
 static inline void pbio_light_matrix_stop_animation(pbio_light_matrix_t *light_matrix) {
 }
 
@@ -18,6 +18,21 @@
 #include <pbio/error.h>
 
 
+/**
+ * What the logger does when it runs out of rows.
+ */
+typedef enum {
+    /**
+     * Stop logging when the buffer is full.
+     */
+    PBIO_LOGGER_MODE_LINEAR,
+    /**
+     * Keep logging, overwriting the oldest rows. Rows may also be consumed
+     * while logging, so data can be streamed out using a small buffer.
+     */
+    PBIO_LOGGER_MODE_CIRCULAR,
+} pbio_logger_mode_t;
+
 /**
  * Logger object for storing data from background control loops.
  */
@@ -27,6 +42,10 @@ typedef struct _pbio_log_t {
      * Whether data should be logged.
      */
     bool active;
+    /**
+     * What to do when the buffer is full.
+     */
+    pbio_logger_mode_t mode;
     /**
      * Number of columns.
      */
@@ -39,6 +58,14 @@ typedef struct _pbio_log_t {
      * How many rows have been used (filled) so far.
      */
     uint32_t num_rows_used;
+    /**
+     * Index of the oldest row in the buffer.
+     */
+    uint32_t first_row;
+    /**
+     * Number of rows that were overwritten before they were consumed.
+     */
+    uint32_t num_rows_lost;
     /**
      * Data buffer allocated by external application.
      */
@@ -64,17 +91,19 @@ typedef struct _pbio_log_t {
 // Number of values logged by the logger itself, such as time of call to logger
 #define PBIO_LOGGER_NUM_DEFAULT_COLS (1)
 
-void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t num_rows, uint8_t num_cols, int32_t down_sample);
+void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t num_rows, uint8_t num_cols, int32_t down_sample, pbio_logger_mode_t mode);
 void pbio_logger_stop(pbio_log_t *log);
 bool pbio_logger_is_active(const pbio_log_t *log);
 void pbio_logger_add_row(pbio_log_t *log, const int32_t *row_data);
 
 uint32_t pbio_logger_get_num_rows_used(const pbio_log_t *log);
 int32_t *pbio_logger_get_row_data(const pbio_log_t *log, uint32_t index);
+void pbio_logger_discard_rows(pbio_log_t *log, uint32_t num_rows);
+uint32_t pbio_logger_get_num_rows_lost(const pbio_log_t *log);
 
 #else
 
-static inline void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t num_rows, uint8_t num_cols, int32_t down_sample) {
+static inline void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t num_rows, uint8_t num_cols, int32_t down_sample, pbio_logger_mode_t mode) {
 }
 static inline void pbio_logger_stop(pbio_log_t *log) {
 }
@@ -89,6 +118,11 @@ static inline uint32_t pbio_logger_get_num_rows_used(const pbio_log_t *log) {
 static inline int32_t *pbio_logger_get_row_data(pbio_log_t *log, uint32_t index) {
     return NULL;
 }
+static inline void pbio_logger_discard_rows(pbio_log_t *log, uint32_t num_rows) {
+}
+static inline uint32_t pbio_logger_get_num_rows_lost(const pbio_log_t *log) {
+    return 0;
+}
 
 #endif // PBIO_CONFIG_LOGGER
 
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup LZ4 pbio/lz4: Streaming LZ4 decoder and encoder
+ *
+ * Decodes data in the LZ4 block format as it arrives in arbitrary chunks.
+ *
+ * Matches are copied from the data decoded so far, so the whole output
+ * buffer acts as the dictionary. No other buffer is needed.
+ *
+ * The encoder produces a series of linked LZ4 blocks. Matches in each block
+ * may refer to data of earlier blocks, so the receiver decodes each block
+ * with all previously decoded data as the dictionary.
+ * @{
+ */
+
+#ifndef _PBIO_LZ4_H_
+#define _PBIO_LZ4_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/error.h>
+
+/**
+ * Decoder state, used to continue where the previous chunk ended.
+ */
+typedef enum {
+    /** Expecting a token with the literal and match lengths. */
+    PBIO_LZ4_STATE_TOKEN,
+    /** Expecting more bytes of the literal length. */
+    PBIO_LZ4_STATE_LITERAL_LENGTH,
+    /** Copying literals. */
+    PBIO_LZ4_STATE_LITERALS,
+    /** Expecting the low byte of the match offset. */
+    PBIO_LZ4_STATE_OFFSET_LOW,
+    /** Expecting the high byte of the match offset. */
+    PBIO_LZ4_STATE_OFFSET_HIGH,
+    /** Expecting more bytes of the match length. */
+    PBIO_LZ4_STATE_MATCH_LENGTH,
+} pbio_lz4_state_t;
+
+/**
+ * Streaming LZ4 decoder.
+ */
+typedef struct {
+    /** Output buffer. */
+    uint8_t *out;
+    /** Size of the output buffer. */
+    uint32_t out_size;
+    /** Number of bytes decoded so far. */
+    uint32_t out_pos;
+    /** Number of compressed bytes consumed so far. */
+    uint32_t in_pos;
+    /** Remaining literal length or match length being parsed. */
+    uint32_t length;
+    /** Offset of the match being parsed. */
+    uint16_t offset;
+    /** Current sequence token. */
+    uint8_t token;
+    /** Parser state. */
+    pbio_lz4_state_t state;
+} pbio_lz4_decoder_t;
+
+/**
+ * Number of bits of the encoder hash, which sets the size of its table.
+ */
+#define PBIO_LZ4_ENCODER_HASH_BITS (8)
+
+/**
+ * Streaming LZ4 encoder.
+ */
+typedef struct {
+    /** Recently encoded data, used to find matches. */
+    uint8_t *history;
+    /** Size of the history buffer. */
+    uint32_t history_size;
+    /** Number of bytes in the history buffer. */
+    uint32_t history_len;
+    /** Most recent position in the history for each hash of four bytes. */
+    uint16_t table[1 << PBIO_LZ4_ENCODER_HASH_BITS];
+} pbio_lz4_encoder_t;
+
+void pbio_lz4_decoder_init(pbio_lz4_decoder_t *decoder, uint8_t *out, uint32_t out_size);
+pbio_error_t pbio_lz4_decode(pbio_lz4_decoder_t *decoder, const uint8_t *data, uint32_t size);
+
+void pbio_lz4_encoder_init(pbio_lz4_encoder_t *encoder, uint8_t *history, uint32_t history_size);
+uint32_t pbio_lz4_encode(pbio_lz4_encoder_t *encoder, const uint8_t *data, uint32_t *size, uint8_t *out, uint32_t out_size);
+
+#endif // _PBIO_LZ4_H_
+
+/** @} */
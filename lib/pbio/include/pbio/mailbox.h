@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup Mailbox pbio/mailbox: EV3 mailbox messages
+ *
+ * Encodes and decodes messages in the format of the EV3 "write mailbox"
+ * system command, as used for brick-to-brick messaging.
+ *
+ * Small messages are batched by writing several of them into one buffer, so
+ * they can be sent as one frame. The buffer is given by the caller, so it can
+ * be allocated up front. Received messages are parsed in place, without
+ * copying their names or values.
+ * @{
+ */
+
+#ifndef _PBIO_MAILBOX_H_
+#define _PBIO_MAILBOX_H_
+
+#include <stdint.h>
+
+#include <pbio/error.h>
+
+/**
+ * Number of bytes of a message in addition to its name and value.
+ */
+#define PBIO_MAILBOX_MESSAGE_OVERHEAD (10)
+
+/**
+ * Maximum length of a mailbox name, excluding the terminating zero.
+ */
+#define PBIO_MAILBOX_NAME_LEN_MAX (254)
+
+/**
+ * Writes mailbox messages into a buffer.
+ */
+typedef struct {
+    /** Buffer for the encoded messages. */
+    uint8_t *buf;
+    /** Size of the buffer. */
+    uint32_t size;
+    /** Number of bytes written so far. */
+    uint32_t len;
+    /** Number of messages written so far. */
+    uint16_t num_messages;
+    /** Counter of the next message. */
+    uint16_t counter;
+} pbio_mailbox_writer_t;
+
+/**
+ * A decoded mailbox message. The name and value point into the received data.
+ */
+typedef struct {
+    /** Zero terminated name of the mailbox. */
+    const char *name;
+    /** Value of the message. */
+    const uint8_t *value;
+    /** Size of the value. */
+    uint16_t value_size;
+    /** Counter given by the sender. */
+    uint16_t counter;
+} pbio_mailbox_message_t;
+
+void pbio_mailbox_writer_init(pbio_mailbox_writer_t *writer, uint8_t *buf, uint32_t size);
+void pbio_mailbox_writer_reset(pbio_mailbox_writer_t *writer);
+pbio_error_t pbio_mailbox_write(pbio_mailbox_writer_t *writer, const char *name, const uint8_t *value, uint16_t value_size);
+pbio_error_t pbio_mailbox_read(const uint8_t *data, uint32_t size, uint32_t *offset, pbio_mailbox_message_t *message);
+
+#endif // _PBIO_MAILBOX_H_
+
+/** @} */
@@ -5,6 +5,7 @@
 #define _PBIO_MAIN_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "pbio/config.h"
 
@@ -12,8 +13,31 @@
 
 void pbio_init(void);
 void pbio_deinit(void);
-pbio_error_t pbio_main_start_application_resources(void);
+void pbio_main_start_application_resources(void);
 pbio_error_t pbio_main_stop_application_resources(void);
 void pbio_main_soft_stop(void);
 
+/**
+ * Phases of the boot process, in the order that they normally complete.
+ */
+typedef enum {
+    /** User data was loaded from storage. */
+    PBIO_MAIN_BOOT_PHASE_STORAGE,
+    /** All drivers were initialized. */
+    PBIO_MAIN_BOOT_PHASE_DRIVERS,
+    /** The pbio library, including the IMU and ports, was initialized. */
+    PBIO_MAIN_BOOT_PHASE_PBIO,
+    /** The system was initialized and is ready to start a program. */
+    PBIO_MAIN_BOOT_PHASE_SYSTEM,
+    /** The Bluetooth controller was initialized. */
+    PBIO_MAIN_BOOT_PHASE_BLUETOOTH,
+    /** The first program was started. */
+    PBIO_MAIN_BOOT_PHASE_PROGRAM,
+    /** Number of boot phases. */
+    PBIO_MAIN_BOOT_PHASE_NUM,
+} pbio_main_boot_phase_t;
+
+void pbio_main_boot_phase_done(pbio_main_boot_phase_t phase);
+uint32_t pbio_main_get_boot_phase_time(pbio_main_boot_phase_t phase);
+
 #endif // _PBIO_MAIN_H_
@@ -11,17 +11,53 @@
 #ifndef _PBIO_MOTOR_PROCESS_H_
 #define _PBIO_MOTOR_PROCESS_H_
 
+#include <stdint.h>
+
 #include <pbio/config.h>
+#include <pbio/os.h>
+
+/**
+ * Timing statistics of the motor control loop.
+ */
+typedef struct _pbio_motor_process_stats_t {
+    /** Number of measured loop periods. */
+    uint32_t count;
+    /** Shortest loop period in microseconds. */
+    uint32_t period_min_us;
+    /** Longest loop period in microseconds. */
+    uint32_t period_max_us;
+    /** Average loop period in microseconds. */
+    uint32_t period_mean_us;
+    /** Number of times the loop was delayed by a full period or more. */
+    uint32_t missed_deadlines;
+    /** Longest stall of the event loop that made the loop miss a deadline, in microseconds. */
+    uint32_t stall_max_us;
+    /** Process that caused this stall, or NULL if it was code outside of the event loop, such as a user program. */
+    pbio_os_process_t *stall_process;
+    /** Number of times the motors were coasted because the loop did not run for too long. */
+    uint32_t starved;
+} pbio_motor_process_stats_t;
 
 #if PBIO_CONFIG_MOTOR_PROCESS
 
 void pbio_motor_process_start(void);
 
+void pbio_motor_process_reset_stats(void);
+
+void pbio_motor_process_get_stats(pbio_motor_process_stats_t *result);
+
 #else
 
 static inline void pbio_motor_process_start(void) {
 }
 
+static inline void pbio_motor_process_reset_stats(void) {
+}
+
+static inline void pbio_motor_process_get_stats(pbio_motor_process_stats_t *result) {
+    *result = (pbio_motor_process_stats_t) { 0 };
+}
+
 #endif // PBIO_CONFIG_MOTOR_PROCESS
 
 #endif // _PBIO_MOTOR_PROCESS_H_
@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 
+#include <pbio/config.h>
 #include <pbio/control_settings.h>
 #include <pbio/dcmotor.h>
 #include <pbio/differentiator.h>
@@ -23,6 +24,9 @@
 
 /**
  * Device-type specific constants that describe the motor model.
+ *
+ * The d_*_d_* coefficients are fixed point values scaled by 2^24, so the
+ * model can be evaluated without divisions.
  */
 typedef struct _pbio_observer_model_t {
     int32_t d_angle_d_speed;
@@ -87,6 +91,30 @@ typedef struct _pbio_observer_settings_t {
     int32_t coulomb_friction_speed_cutoff;
 } pbio_observer_settings_t;
 
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+/**
+ * Running sums for identifying the feedforward part of a motor model.
+ *
+ * The steady state torque is fitted as a linear function of speed plus
+ * a constant friction torque. The time constant is fitted from the area
+ * between each step response and its final speed, which only needs the
+ * measured angle, so it is not affected by the delay of the speed estimate.
+ *
+ * Speeds are in deg/s and torques are in mNm to keep the sums in range.
+ */
+typedef struct _pbio_observer_identification_t {
+    float speed_speed;      /**< Sum of speed squared. */
+    float speed_sign;       /**< Sum of speed times its sign. */
+    float sign_sign;        /**< Number of nonzero speed samples. */
+    float speed_torque;     /**< Sum of speed times torque. */
+    float sign_torque;      /**< Sum of speed sign times torque. */
+    float lag_change;       /**< Sum of step response lag times speed change. */
+    float change_change;    /**< Sum of speed change squared. */
+} pbio_observer_identification_t;
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
 /**
  * Motor state observer object.
  */
@@ -108,7 +136,8 @@ typedef struct _pbio_observer_t {
      */
     pbio_differentiator_t differentiator;
     /**
-     * Latest speed value from angle differentiator.
+     * Latest speed value from angle differentiator, or from encoder edge
+     * timing at low speeds if available.
      */
     int32_t speed_numeric;
     /**
@@ -133,7 +162,7 @@ typedef struct _pbio_observer_t {
 
 void pbio_observer_reset(pbio_observer_t *obs, const pbio_angle_t *angle);
 void pbio_observer_get_estimated_state(const pbio_observer_t *obs, int32_t *speed_num, pbio_angle_t *angle_est, int32_t *speed_est);
-void pbio_observer_update(pbio_observer_t *obs, uint32_t time, const pbio_angle_t *angle, pbio_dcmotor_actuation_t actuation, int32_t voltage);
+void pbio_observer_update(pbio_observer_t *obs, uint32_t time, const pbio_angle_t *angle, pbio_dcmotor_actuation_t actuation, int32_t voltage, const int32_t *edge_speed);
 bool pbio_observer_is_stalled(const pbio_observer_t *obs, uint32_t time, uint32_t *stall_duration);
 int32_t pbio_observer_get_feedback_voltage(const pbio_observer_t *obs, const pbio_angle_t *angle);
 
@@ -144,6 +173,17 @@ int32_t pbio_observer_get_feedforward_torque(const pbio_observer_model_t *model,
 int32_t pbio_observer_torque_to_voltage(const pbio_observer_model_t *model, int32_t desired_torque);
 int32_t pbio_observer_voltage_to_torque(const pbio_observer_model_t *model, int32_t voltage);
 
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+// Model identification functions:
+
+void pbio_observer_identification_reset(pbio_observer_identification_t *fit);
+void pbio_observer_identification_add_steady(pbio_observer_identification_t *fit, int32_t speed, int32_t torque);
+void pbio_observer_identification_add_step(pbio_observer_identification_t *fit, int32_t speed_start, int32_t speed_end, int32_t angle_change, uint32_t duration);
+pbio_error_t pbio_observer_identification_solve(const pbio_observer_identification_t *fit, const pbio_observer_model_t *base, pbio_observer_model_t *model);
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
 #endif // _PBIO_OBSERVER_H_
 
 /** @} */
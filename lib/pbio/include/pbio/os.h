@@ -105,6 +105,65 @@ typedef enum {
     PBIO_OS_PROCESS_REQUEST_TYPE_CANCEL = 1 << 0,
 } pbio_os_process_request_type_t;
 
+/**
+ * Scheduling priority of a process.
+ *
+ * Processes with a higher priority are run first on each pass of the event
+ * loop. Processes with equal priority run in the order in which they were
+ * started.
+ */
+typedef enum {
+    /**
+     * Default priority for background processes.
+     */
+    PBIO_OS_PROCESS_PRIORITY_NORMAL = 0,
+    /**
+     * Priority for device processes such as the port processes.
+     */
+    PBIO_OS_PROCESS_PRIORITY_HIGH = 1,
+    /**
+     * Priority for time critical processes such as the motor control loop.
+     */
+    PBIO_OS_PROCESS_PRIORITY_CRITICAL = 2,
+} pbio_os_process_priority_t;
+
+#if PBIO_CONFIG_OS_PROFILE
+
+/**
+ * Execution time statistics of a process.
+ */
+typedef struct {
+    /**
+     * Number of times the protothread was called.
+     */
+    uint32_t num_calls;
+    /**
+     * Total time spent in the protothread in microseconds.
+     */
+    uint32_t time_total_us;
+    /**
+     * Longest time spent in one call to the protothread in microseconds.
+     */
+    uint32_t time_max_us;
+} pbio_os_process_stats_t;
+
+#endif // PBIO_CONFIG_OS_PROFILE
+
+/**
+ * Longest time that the event loop did not get to run processes.
+ */
+typedef struct {
+    /**
+     * Duration of the stall in microseconds.
+     */
+    uint32_t time_us;
+    /**
+     * Process that ran for this long, or NULL if the event loop was not
+     * called for this long, such as when a user program blocks it.
+     */
+    pbio_os_process_t *process;
+} pbio_os_stall_t;
+
 /**
  * A process.
  */
@@ -134,6 +193,33 @@ struct _pbio_os_process_t {
      * thread function to implement how to respond, if at all.
      */
     pbio_os_process_request_type_t request;
+    /**
+     * Scheduling priority. Determines the position in the process list.
+     */
+    pbio_os_process_priority_t priority;
+    /**
+     * Whether this process was signaled to run on the next pass of the event
+     * loop. This is only used when there is no request to poll all processes.
+     */
+    volatile bool poll_pending;
+    #if PBIO_CONFIG_OS_PROFILE
+    /**
+     * Execution time statistics.
+     */
+    pbio_os_process_stats_t stats;
+    #endif
+    #if PBIO_CONFIG_OS_TICKLESS
+    /**
+     * Earliest deadline of the timers checked in the last iteration of the
+     * protothread that had not yet expired.
+     */
+    uint32_t wake_time;
+    /**
+     * Whether the last iteration of the protothread checked any timer that
+     * had not yet expired, making ::wake_time valid.
+     */
+    bool wake_time_valid;
+    #endif
 };
 
 /**
@@ -320,12 +406,70 @@ void pbio_os_process_make_request(pbio_os_process_t *process, pbio_os_process_re
 
 bool pbio_os_run_processes_once(void);
 
+extern volatile bool pbio_os_poll_request_is_pending;
+
+/**
+ * Runs the processes once if any poll request is pending.
+ *
+ * This is the same as ::pbio_os_run_processes_once, but the common case
+ * without pending events costs only a load and a branch instead of a call.
+ */
+static inline void pbio_os_run_processes_if_pending(void) {
+    if (pbio_os_poll_request_is_pending) {
+        pbio_os_run_processes_once();
+    }
+}
+
 void pbio_os_run_processes_and_wait_for_event(void);
 
 void pbio_os_request_poll(void);
 
+void pbio_os_process_request_poll(pbio_os_process_t *process);
+
+pbio_os_process_t *pbio_os_get_current_process(void);
+
+void pbio_os_process_set_priority(pbio_os_process_t *process, pbio_os_process_priority_t priority);
+
 pbio_error_t pbio_port_process_none_thread(pbio_os_state_t *state, void *context);
 
 void pbio_os_process_start(pbio_os_process_t *process, pbio_os_process_func_t func, void *context);
 
+pbio_os_process_t *pbio_os_process_get_next(pbio_os_process_t *process);
+
+#if PBIO_CONFIG_OS_TICKLESS
+
+void pbio_os_set_tickless_idle(bool enable);
+
+#else
+
+static inline void pbio_os_set_tickless_idle(bool enable) {
+}
+
+#endif // PBIO_CONFIG_OS_TICKLESS
+
+#if PBIO_CONFIG_OS_STALL_MONITOR
+
+void pbio_os_get_stall(pbio_os_stall_t *result);
+
+void pbio_os_reset_stall(void);
+
+#else
+
+static inline void pbio_os_get_stall(pbio_os_stall_t *result) {
+    *result = (pbio_os_stall_t) { 0 };
+}
+
+static inline void pbio_os_reset_stall(void) {
+}
+
+#endif // PBIO_CONFIG_OS_STALL_MONITOR
+
+#if PBIO_CONFIG_OS_PROFILE
+
+uint32_t pbio_os_get_idle_time_us(void);
+
+void pbio_os_reset_stats(void);
+
+#endif // PBIO_CONFIG_OS_PROFILE
+
 #endif // _PBIO_OS_H_
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup PfIr pbio/pf_ir: Power Functions infrared transmit queue
+ *
+ * Sends Power Functions motor commands with the infrared transmitter of the
+ * Color and Distance Sensor.
+ *
+ * The sensor can only send one message about every 250 ms, so commands are
+ * queued and sent in the background. Each sensor has a queue that holds the
+ * most recent value of each output. Values that the receiver already has are
+ * not sent again, and channels take turns so that no channel waits for more
+ * than one message of each of the others.
+ *
+ * When both outputs of a channel change, they are sent as one combo PWM
+ * message. Receivers stop combo PWM outputs if they do not hear from the
+ * remote for a while, so channels that are driven this way are sent again
+ * periodically until both outputs are off.
+ * @{
+ */
+
+#ifndef _PBIO_PF_IR_H_
+#define _PBIO_PF_IR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/config.h>
+#include <pbio/error.h>
+#include <pbio/port_lump.h>
+
+/**
+ * Number of Power Functions channels.
+ */
+#define PBIO_PF_IR_NUM_CHANNELS (4)
+
+/**
+ * Time after which channels that are driven with combo PWM messages are sent
+ * again, in ms. The receiver times out after about 1.2 seconds.
+ */
+#define PBIO_PF_IR_REFRESH_MS (500)
+
+/**
+ * Value of an output that is not set or not known to the receiver.
+ */
+#define PBIO_PF_IR_VALUE_UNKNOWN (0xFF)
+
+/**
+ * Power Functions output, as marked on the receiver.
+ */
+typedef enum {
+    /** Red output, also known as output A. */
+    PBIO_PF_IR_OUTPUT_RED = 0,
+    /** Blue output, also known as output B. */
+    PBIO_PF_IR_OUTPUT_BLUE = 1,
+} pbio_pf_ir_output_t;
+
+/**
+ * State of one Power Functions channel.
+ */
+typedef struct {
+    /** Most recently requested PWM value of each output. */
+    uint8_t desired[2];
+    /** Value of each output that was last sent to the receiver. */
+    uint8_t sent[2];
+    /** Whether the channel is driven with combo PWM messages. */
+    bool combo;
+    /** Time at which the channel was last sent, in ms. */
+    uint32_t sent_time;
+} pbio_pf_ir_channel_t;
+
+/**
+ * Transmit queue of one sensor.
+ */
+typedef struct {
+    /** The sensor, or NULL if the queue is not in use. */
+    pbio_port_lump_dev_t *lump_dev;
+    /** State of each channel. */
+    pbio_pf_ir_channel_t channels[PBIO_PF_IR_NUM_CHANNELS];
+    /** Channel that gets the next turn. */
+    uint8_t next_channel;
+} pbio_pf_ir_queue_t;
+
+void pbio_pf_ir_queue_reset(pbio_pf_ir_queue_t *queue);
+void pbio_pf_ir_queue_set(pbio_pf_ir_queue_t *queue, uint8_t channel, pbio_pf_ir_output_t output, uint8_t value);
+bool pbio_pf_ir_queue_pop(pbio_pf_ir_queue_t *queue, uint32_t now, uint16_t *message);
+
+#if PBIO_CONFIG_PF_IR
+
+pbio_error_t pbio_pf_ir_set(pbio_port_lump_dev_t *lump_dev, uint8_t channel, pbio_pf_ir_output_t output, uint8_t value);
+void pbio_pf_ir_reset(void);
+
+#else // PBIO_CONFIG_PF_IR
+
+static inline pbio_error_t pbio_pf_ir_set(pbio_port_lump_dev_t *lump_dev, uint8_t channel, pbio_pf_ir_output_t output, uint8_t value) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline void pbio_pf_ir_reset(void) {
+}
+
+#endif // PBIO_CONFIG_PF_IR
+
+#endif // _PBIO_PF_IR_H_
+
+/** @} */
@@ -80,6 +80,29 @@ uint32_t pbio_port_dcm_get_analog_value(pbio_port_dcm_t *dcm, const pbdrv_ioport
  */
 pbio_error_t pbio_port_dcm_get_analog_rgba(pbio_port_dcm_t *dcm, pbio_port_dcm_analog_rgba_t *rgba);
 
+/**
+ * Starts capturing the analog value of the device connected to the port.
+ *
+ * Uses the same pin as ::pbio_port_dcm_get_analog_value. See
+ * ::pbdrv_adc_capture_start for the remaining arguments.
+ *
+ * @param [in]  dcm         The device connection manager.
+ * @param [in]  pins        The ioport pins.
+ * @param [in]  active      Whether to get activate active mode.
+ * @return                  ::PBIO_SUCCESS if the capture started or
+ *                          ::PBIO_ERROR_NOT_SUPPORTED if there is no analog
+ *                          capture on this platform.
+ */
+pbio_error_t pbio_port_dcm_start_analog_capture(pbio_port_dcm_t *dcm, const pbdrv_ioport_pins_t *pins, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation);
+
+/**
+ * Converts captured samples to millivolts, in place.
+ *
+ * @param [in]  buf         The captured samples.
+ * @param [in]  len         Number of samples.
+ */
+void pbio_port_dcm_analog_capture_to_mv(uint16_t *buf, uint32_t len);
+
 #else // PBIO_CONFIG_PORT_DCM
 
 static inline pbio_port_dcm_t *pbio_port_dcm_init_instance(uint8_t index) {
@@ -106,6 +129,13 @@ static inline pbio_error_t pbio_port_dcm_get_analog_rgba(pbio_port_dcm_t *dcm, p
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbio_port_dcm_start_analog_capture(pbio_port_dcm_t *dcm, const pbdrv_ioport_pins_t *pins, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline void pbio_port_dcm_analog_capture_to_mv(uint16_t *buf, uint32_t len) {
+}
+
 static inline pbio_error_t pbio_port_dcm_thread(pbio_os_state_t *state, pbio_os_timer_t *timer, pbio_port_dcm_t *dcm, const pbdrv_ioport_pins_t *pins) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
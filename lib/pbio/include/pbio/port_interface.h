@@ -13,6 +13,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <pbdrv/config.h>
 #include <pbdrv/uart.h>
@@ -65,6 +66,42 @@ typedef enum {
     PBIO_PORT_MODE_GPIO_ADC = 1 << 4,
 } pbio_port_mode_t;
 
+/**
+ * Maximum number of sensor data bytes in a port snapshot.
+ */
+#define PBIO_PORT_SNAPSHOT_DATA_SIZE (16)
+
+/**
+ * Size of a port snapshot in bytes.
+ *
+ * The layout is:
+ * - type: Device type identifier (u8).
+ * - flags: Valid fields, as ::pbio_port_snapshot_flag_t bits (u8).
+ * - mode: Current mode of a LEGO UART sensor (u8).
+ * - size: Number of valid data bytes (u8).
+ * - angle: Angle in degrees (i32).
+ * - speed: Speed in deg/s (i32).
+ * - data: Current mode data of a LEGO UART sensor, truncated to
+ *   ::PBIO_PORT_SNAPSHOT_DATA_SIZE bytes, or the analog value (u32).
+ *
+ * All values are little-endian. Fields that are not valid are zero.
+ */
+#define PBIO_PORT_SNAPSHOT_SIZE (12 + PBIO_PORT_SNAPSHOT_DATA_SIZE)
+
+/**
+ * Valid fields of a port snapshot.
+ */
+typedef enum {
+    /** The angle is valid. */
+    PBIO_PORT_SNAPSHOT_FLAG_ANGLE = 1 << 0,
+    /** The speed is valid, and the angle is that of the motor object. */
+    PBIO_PORT_SNAPSHOT_FLAG_SERVO = 1 << 1,
+    /** The data is mode data of a LEGO UART sensor. */
+    PBIO_PORT_SNAPSHOT_FLAG_LUMP_DATA = 1 << 2,
+    /** The data is the analog value of a passive device. */
+    PBIO_PORT_SNAPSHOT_FLAG_ANALOG = 1 << 3,
+} pbio_port_snapshot_flag_t;
+
 #if PBIO_CONFIG_PORT
 
 void pbio_port_init(void);
@@ -77,6 +114,8 @@ pbio_error_t pbio_port_get_port(pbio_port_id_t id, pbio_port_t **port);
 
 pbio_port_t *pbio_port_by_index(uint8_t index);
 
+void pbio_port_get_snapshot(pbio_port_t *port, uint8_t *buf);
+
 pbio_error_t pbio_port_get_dcmotor(pbio_port_t *port, lego_device_type_id_t *expected_type_id, pbio_dcmotor_t **dcmotor);
 
 pbio_error_t pbio_port_get_servo(pbio_port_t *port, lego_device_type_id_t *expected_type_id, pbio_servo_t **servo);
@@ -87,10 +126,16 @@ pbio_error_t pbio_port_get_angle(pbio_port_t *port, pbio_angle_t *angle);
 
 pbio_error_t pbio_port_get_abs_angle(pbio_port_t *port, pbio_angle_t *angle);
 
+pbio_error_t pbio_port_get_edge_speed(pbio_port_t *port, int32_t *speed);
+
 pbio_error_t pbio_port_get_analog_value(pbio_port_t *port, lego_device_type_id_t type_id, bool active, uint32_t *value);
 
 pbio_error_t pbio_port_get_analog_rgba(pbio_port_t *port, lego_device_type_id_t type_id, pbio_port_dcm_analog_rgba_t *rgba);
 
+pbio_error_t pbio_port_start_analog_capture(pbio_port_t *port, lego_device_type_id_t type_id, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation);
+
+pbio_error_t pbio_port_await_analog_capture(pbio_os_state_t *state, uint16_t *buf, uint32_t len);
+
 pbio_error_t pbio_port_p1p2_set_power(pbio_port_t *port, pbio_port_power_requirements_t power_requirement);
 
 pbio_error_t pbio_port_set_mode(pbio_port_t *port, pbio_port_mode_t mode);
@@ -101,6 +146,14 @@ pbio_error_t pbio_port_get_uart_dev(pbio_port_t *port, pbdrv_uart_dev_t **uart_d
 
 pbio_error_t pbio_port_get_i2c_dev(pbio_port_t *port, pbdrv_i2c_dev_t **i2c_dev);
 
+#if PBDRV_CONFIG_I2C
+
+pbio_error_t pbio_port_i2c_poll_start(pbio_port_t *port, uint8_t address, uint8_t reg, uint8_t len, uint32_t interval, bool nxt_quirk);
+
+pbio_error_t pbio_port_i2c_poll_get(pbio_port_t *port, uint8_t address, uint8_t reg, uint8_t len, uint8_t **data, uint32_t *time);
+
+#endif // PBDRV_CONFIG_I2C
+
 #else // PBIO_CONFIG_PORT
 
 static inline void pbio_port_init(void) {
@@ -120,6 +173,10 @@ static inline pbio_port_t *pbio_port_by_index(uint8_t index) {
     return NULL;
 }
 
+static inline void pbio_port_get_snapshot(pbio_port_t *port, uint8_t *buf) {
+    memset(buf, 0, PBIO_PORT_SNAPSHOT_SIZE);
+}
+
 static inline pbio_error_t pbio_port_get_dcmotor(pbio_port_t *port, lego_device_type_id_t *expected_type_id, pbio_dcmotor_t **dcmotor) {
     return PBIO_ERROR_NO_DEV;
 }
@@ -140,6 +197,10 @@ static inline pbio_error_t pbio_port_get_abs_angle(pbio_port_t *port, pbio_angle
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbio_port_get_edge_speed(pbio_port_t *port, int32_t *speed) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline pbio_error_t pbio_port_get_analog_value(pbio_port_t *port, lego_device_type_id_t type_id, bool active, uint32_t *value) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
@@ -148,6 +209,14 @@ static inline pbio_error_t pbio_port_get_analog_rgba(pbio_port_t *port, lego_dev
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbio_port_start_analog_capture(pbio_port_t *port, lego_device_type_id_t type_id, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbio_port_await_analog_capture(pbio_os_state_t *state, uint16_t *buf, uint32_t len) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline pbio_error_t pbio_port_p1p2_set_power(pbio_port_t *port, pbio_port_power_requirements_t power_requirement) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
@@ -168,9 +237,20 @@ static inline pbio_error_t pbio_port_get_i2c_dev(pbio_port_t *port, pbdrv_i2c_de
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
-
 #endif // PBIO_CONFIG_PORT
 
+#if !PBIO_CONFIG_PORT || !PBDRV_CONFIG_I2C
+
+static inline pbio_error_t pbio_port_i2c_poll_start(pbio_port_t *port, uint8_t address, uint8_t reg, uint8_t len, uint32_t interval, bool nxt_quirk) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbio_port_i2c_poll_get(pbio_port_t *port, uint8_t address, uint8_t reg, uint8_t len, uint8_t **data, uint32_t *time) {
+    return PBIO_ERROR_INVALID_OP;
+}
+
+#endif // !PBIO_CONFIG_PORT || !PBDRV_CONFIG_I2C
+
 #endif // _PBIO_PORT_INTERFACE_H_
 
 /** @} */
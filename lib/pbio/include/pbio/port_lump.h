@@ -15,6 +15,11 @@
 
 typedef struct _pbio_port_lump_dev_t pbio_port_lump_dev_t;
 
+/**
+ * Mode value used to get data set up with ::pbio_port_lump_set_mode_combi.
+ */
+#define PBIO_PORT_LUMP_MODE_COMBI (0xFF)
+
 /**
  * Structure containing information about a legodev device mode.
  */
@@ -45,12 +50,22 @@ pbio_error_t pbio_port_lump_set_mode(pbio_port_lump_dev_t *lump_dev, uint8_t mod
 
 pbio_error_t pbio_port_lump_get_data(pbio_port_lump_dev_t *lump_dev, uint8_t mode, void **data);
 
+uint32_t pbio_port_lump_get_generation(pbio_port_lump_dev_t *lump_dev);
+
+pbio_error_t pbio_port_lump_get_data_count(pbio_port_lump_dev_t *lump_dev, uint8_t mode, bool changed, uint32_t *count);
+
+pbio_error_t pbio_port_lump_get_data_time(pbio_port_lump_dev_t *lump_dev, uint8_t mode, uint32_t *time);
+
 pbio_error_t pbio_port_lump_set_mode_with_data(pbio_port_lump_dev_t *lump_dev, uint8_t mode, const void *data, uint8_t size);
 
+pbio_error_t pbio_port_lump_set_mode_combi(pbio_port_lump_dev_t *lump_dev, const uint8_t *values, uint8_t num_values);
+
 pbio_error_t pbio_port_lump_assert_type_id(pbio_port_lump_dev_t *lump_dev, lego_device_type_id_t *type_id);
 
 pbio_error_t pbio_port_lump_get_info(pbio_port_lump_dev_t *lump_dev, uint8_t *num_modes, uint8_t *current_mode, pbio_port_lump_mode_info_t **mode_info);
 
+size_t pbio_port_lump_data_size(lump_data_type_t type);
+
 pbio_error_t pbio_port_lump_request_reset(pbio_port_lump_dev_t *lump_dev);
 
 pbio_error_t pbio_port_lump_get_angle(pbio_port_lump_dev_t *lump_dev, pbio_angle_t *angle, bool get_abs_angle);
@@ -75,10 +90,26 @@ static inline pbio_error_t pbio_port_lump_get_data(pbio_port_lump_dev_t *lump_de
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline uint32_t pbio_port_lump_get_generation(pbio_port_lump_dev_t *lump_dev) {
+    return 0;
+}
+
+static inline pbio_error_t pbio_port_lump_get_data_count(pbio_port_lump_dev_t *lump_dev, uint8_t mode, bool changed, uint32_t *count) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbio_port_lump_get_data_time(pbio_port_lump_dev_t *lump_dev, uint8_t mode, uint32_t *time) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline pbio_error_t pbio_port_lump_set_mode_with_data(pbio_port_lump_dev_t *lump_dev, uint8_t mode, const void *data, uint8_t size) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbio_port_lump_set_mode_combi(pbio_port_lump_dev_t *lump_dev, const uint8_t *values, uint8_t num_values) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline pbio_error_t pbio_port_lump_assert_type_id(pbio_port_lump_dev_t *lump_dev, lego_device_type_id_t *type_id) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
@@ -90,6 +121,10 @@ static inline pbio_error_t pbio_port_lump_get_info(pbio_port_lump_dev_t *lump_de
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline size_t pbio_port_lump_data_size(lump_data_type_t type) {
+    return 0;
+}
+
 static inline pbio_error_t pbio_port_lump_request_reset(pbio_port_lump_dev_t *lump_dev) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
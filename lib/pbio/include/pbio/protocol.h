@@ -123,11 +123,17 @@ typedef enum {
      *
      * Parameters:
      * - size: The size of the user program in bytes (32-bit little-endian unsigned integer).
+     * - crc: Optional CRC-32 of the whole user program, as computed by
+     *        zlib.crc32() (32-bit little-endian unsigned integer). Only used
+     *        when completing a download with nonzero size.
      *
      * Errors:
      * - ::PBIO_PYBRICKS_ERROR_BUSY if the user program is running.
+     * - ::PBIO_PYBRICKS_ERROR_UNLIKELY_ERROR if the received data does not
+     *   match the given CRC. The download remains in progress, so missing
+     *   data can be sent again before retrying this command.
      *
-     * @since Pybricks Profile v1.2.0
+     * @since Pybricks Profile v1.2.0. CRC added in Unreleased.
      */
     PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META = 3,
 
@@ -165,6 +171,10 @@ typedef enum {
      * Parameters:
      * - payload: The data to write (0 to 512 bytes).
      *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if the data does not fit. The data is
+     *   dropped and reported with ::PBIO_PYBRICKS_EVENT_WRITE_STDIN_ACK.
+     *
      * @since Pybricks Profile v1.3.0
      */
     PBIO_PYBRICKS_COMMAND_WRITE_STDIN = 6,
@@ -193,7 +203,257 @@ typedef enum {
      * @since Pybricks Profile v1.4.0
      */
     PBIO_PYBRICKS_COMMAND_WRITE_APP_DATA = 7,
+
+    /**
+     * Configures the telemetry stream sent with ::PBIO_PYBRICKS_EVENT_WRITE_TELEMETRY.
+     *
+     * All subscribed records are sent again on the next update.
+     *
+     * Parameters:
+     * - period: Time between updates in ms (16-bit little-endian unsigned integer).
+     * - mask: Bit mask of record tags to send (32-bit little-endian unsigned integer).
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_CONFIGURE_TELEMETRY = 8,
+
+    /**
+     * Requests to write a numbered chunk of the user program to user RAM.
+     *
+     * This is like ::PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM, but meant to be
+     * sent without waiting for a response to each chunk (e.g. BLE write
+     * without response), so that several chunks can be in flight at once.
+     *
+     * Chunks are numbered from 0 after starting a download with
+     * ::PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META. Chunks that do not
+     * have the next expected sequence number are ignored. The hub reports
+     * progress with ::PBIO_PYBRICKS_EVENT_WRITE_USER_RAM_ACK, so the host
+     * should send again from the acknowledged sequence number if it does not
+     * make progress. The download is completed as usual with
+     * ::PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META, optionally with a CRC.
+     *
+     * Parameters:
+     * - sequence: The chunk number (16-bit little-endian unsigned integer).
+     * - offset: The offset from the user RAM base address (32-bit little-endian unsigned integer).
+     * - payload: The data to write.
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if the user program is running.
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if the data does not fit.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_WINDOWED = 9,
+
+    /**
+     * Requests to write compressed user program data to user RAM.
+     *
+     * This can be used instead of ::PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM to
+     * send less data. The whole program is compressed as one stream in the
+     * LZ4 block format (e.g. lz4.block.compress(data, store_size=False) in
+     * Python) and sent in chunks in order. Chunks are decoded as they arrive.
+     * The download is completed as usual with
+     * ::PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META, using the size of the
+     * decompressed program.
+     *
+     * Parameters:
+     * - offset: The offset from the start of the compressed stream (32-bit little-endian unsigned integer).
+     * - payload: The compressed data to write.
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if the user program is running.
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if data before the offset is
+     *   missing, if the data is invalid, or if the decompressed program does
+     *   not fit.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_COMPRESSED = 10,
+
+    /**
+     * Requests to start a download that patches the program in the selected
+     * slot instead of replacing it.
+     *
+     * The current program is kept in place. The host then changes it into the
+     * new program with ::PBIO_PYBRICKS_COMMAND_COPY_USER_RAM and
+     * ::PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM (or the windowed variant), which
+     * are applied in the order they are received. The download is completed
+     * as usual with ::PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META, which
+     * should include the CRC of the new program.
+     *
+     * Parameters:
+     * - size: The size of the program the patch is based on (32-bit little-endian unsigned integer).
+     * - crc: The CRC-32 of the program the patch is based on, as computed by
+     *        zlib.crc32() (32-bit little-endian unsigned integer).
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if the user program is running.
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if the stored program is not
+     *   the one the patch is based on. The host should send the whole
+     *   program instead.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_BEGIN_USER_PROGRAM_PATCH = 11,
+
+    /**
+     * Requests to copy data within user RAM, such as to move unchanged parts
+     * of a program that is being patched. Source and destination may overlap.
+     *
+     * Parameters:
+     * - destination: The offset to copy to, from the user RAM base address (32-bit little-endian unsigned integer).
+     * - source: The offset to copy from, from the user RAM base address (32-bit little-endian unsigned integer).
+     * - size: The number of bytes to copy (32-bit little-endian unsigned integer).
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if the user program is running.
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if the data does not fit.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_COPY_USER_RAM = 12,
+
+    /**
+     * Configures how stdout is sent to the host on this connection.
+     *
+     * Parameters:
+     * - flags: ::pbio_pybricks_stdout_flags_t (8-bit unsigned integer).
+     *
+     * When ::PBIO_PYBRICKS_STDOUT_FLAG_COMPRESSED is set, stdout is sent with
+     * ::PBIO_PYBRICKS_EVENT_WRITE_STDOUT_COMPRESSED instead of
+     * ::PBIO_PYBRICKS_EVENT_WRITE_STDOUT. Each time this command is sent,
+     * a new compressed stream starts. Every new connection starts without
+     * compression.
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_INVALID_COMMAND if the hub does not support
+     *   compressed stdout on this connection.
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if unknown flags are set.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_CONFIGURE_STDOUT = 13,
+
+    /**
+     * Requests to run motors and drive bases directly, without going through
+     * the user program.
+     *
+     * The payload is one or more actions, which are applied in the order
+     * given, so several motors can be started in the same control loop. Each
+     * action is a ::pbio_pybricks_motion_action_t (8-bit unsigned integer),
+     * a port or drive base index (8-bit unsigned integer), and the parameters
+     * of the action. Only motors and drive bases that are set up by the
+     * running program can be used. State requested by the actions is sent
+     * with ::PBIO_PYBRICKS_EVENT_WRITE_MOTION_STATE.
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if an action is unknown or
+     *   incomplete. No actions are applied in this case.
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if the replies to previous actions have not
+     *   been sent yet. No actions are applied in this case.
+     * - ::PBIO_PYBRICKS_ERROR_INVALID_COMMAND if the hub does not support it.
+     * - Other errors if an action fails. The actions before it are applied.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_WRITE_MOTION = 14,
+
+    /**
+     * Sends data straight back to the host, to measure the latency and
+     * throughput of the connection without running a program.
+     *
+     * The payload is ::pbio_pybricks_echo_flags_t (8-bit unsigned integer)
+     * followed by zero or more bytes of data. The data is sent back right
+     * away with ::PBIO_PYBRICKS_EVENT_ECHO. The flags stay in effect until
+     * the next echo command.
+     *
+     * Errors:
+     * - ::PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED if the flags are not valid.
+     * - ::PBIO_PYBRICKS_ERROR_BUSY if previous data has not been sent back yet.
+     * - ::PBIO_PYBRICKS_ERROR_INVALID_COMMAND if the hub does not support it.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_COMMAND_ECHO = 15,
 } pbio_pybricks_command_t;
+
+/**
+ * Actions for ::PBIO_PYBRICKS_COMMAND_WRITE_MOTION.
+ *
+ * Speeds are in deg/s or mm/s, angles in degrees, and distances in mm, all as
+ * 32-bit little-endian signed integers. Completion types are
+ * ::pbio_control_on_completion_t values (8-bit unsigned integer).
+ */
+typedef enum {
+    /**
+     * Stops a motor. Parameters: completion type.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_SERVO_STOP = 0,
+    /**
+     * Runs a motor at a constant speed. Parameters: speed.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN = 1,
+    /**
+     * Runs a motor to a target angle. Parameters: speed, target angle and
+     * completion type.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN_TARGET = 2,
+    /**
+     * Tracks a target angle that is updated frequently. Parameters: target
+     * angle.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_SERVO_TRACK_TARGET = 3,
+    /**
+     * Requests the state of a motor. No parameters. The reply is the action,
+     * the port index, the angle and the speed.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_SERVO_GET_STATE = 4,
+    /**
+     * Stops a drive base. Parameters: completion type.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP = 5,
+    /**
+     * Drives a drive base at a constant speed and turn rate. Parameters: speed
+     * and turn rate.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_DRIVE = 6,
+    /**
+     * Requests the state of a drive base. No parameters. The reply is the
+     * action, the drive base index, the distance, the speed, the angle and the
+     * turn rate.
+     */
+    PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_GET_STATE = 7,
+} pbio_pybricks_motion_action_t;
+
+/**
+ * Flags for ::PBIO_PYBRICKS_COMMAND_ECHO.
+ *
+ * @since Unreleased. Should not be considered final.
+ */
+typedef enum {
+    /**
+     * Data written with ::PBIO_PYBRICKS_COMMAND_WRITE_STDIN is sent back as
+     * stdout instead of going to the program.
+     */
+    PBIO_PYBRICKS_ECHO_FLAG_STDIN = 1 << 0,
+    /**
+     * Data written with ::PBIO_PYBRICKS_COMMAND_WRITE_APP_DATA is sent back
+     * with ::PBIO_PYBRICKS_EVENT_WRITE_APP_DATA instead of going to the
+     * program. The offset is not included.
+     */
+    PBIO_PYBRICKS_ECHO_FLAG_APP_DATA = 1 << 1,
+} pbio_pybricks_echo_flags_t;
+
+/**
+ * Flags for ::PBIO_PYBRICKS_COMMAND_CONFIGURE_STDOUT.
+ *
+ * @since Unreleased. Should not be considered final.
+ */
+typedef enum {
+    /** Send stdout compressed. */
+    PBIO_PYBRICKS_STDOUT_FLAG_COMPRESSED = 1 << 0,
+} pbio_pybricks_stdout_flags_t;
+
 /**
  * Application-specific error codes that are used in ATT_ERROR_RSP.
  */
@@ -265,14 +525,76 @@ typedef enum {
     /**
      * Telemetry data sent from the hub to the host.
      *
-     * The payload is a variable number of bytes that was written to app data.
-     *
-     * Pybricks profile version defines exact encoding of this data.
+     * The payload is one or more records, each consisting of a tag (u8), the
+     * value size (u8) and the value. Records are only sent when they change.
+     * See ::pbsys_telemetry_tag_t for the record tags.
      *
      * @since Unreleased. Should not be considered final.
      */
     PBIO_PYBRICKS_EVENT_WRITE_TELEMETRY = 3,
 
+    /**
+     * Cumulative acknowledgement of chunks written with
+     * ::PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_WINDOWED.
+     *
+     * The payload is the next expected sequence number (16-bit little-endian
+     * unsigned integer), so all chunks before it have been received. It is
+     * sent after a few chunks, shortly after the last chunk, and right away
+     * when a chunk arrives out of order.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_EVENT_WRITE_USER_RAM_ACK = 4,
+
+    /**
+     * Data written to stdout, compressed.
+     *
+     * The payload is one complete LZ4 block. Matches may refer to stdout
+     * decoded from earlier events of the same stream, up to the last 512
+     * bytes or more, depending on the hub. The stream starts with
+     * ::PBIO_PYBRICKS_COMMAND_CONFIGURE_STDOUT.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_EVENT_WRITE_STDOUT_COMPRESSED = 5,
+
+    /**
+     * Flow control for ::PBIO_PYBRICKS_COMMAND_WRITE_STDIN.
+     *
+     * The payload is:
+     * - free: Free space in the stdin buffer (16-bit little-endian unsigned integer).
+     * - received: Number of bytes written to stdin (32-bit little-endian unsigned integer).
+     * - dropped: Number of bytes dropped because they did not fit (32-bit little-endian unsigned integer).
+     *
+     * Counts start at zero when a program starts. The host may send another
+     * free - (sent - received - dropped) bytes, where sent is the number of
+     * bytes it sent since the program started. It is sent shortly after the
+     * program reads from stdin, and right away when data is dropped.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_EVENT_WRITE_STDIN_ACK = 6,
+
+    /**
+     * State requested with ::PBIO_PYBRICKS_COMMAND_WRITE_MOTION.
+     *
+     * The payload is one or more replies as described for each
+     * ::pbio_pybricks_motion_action_t, in the order they were requested.
+     * Replies are not split across events.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_EVENT_WRITE_MOTION_STATE = 7,
+
+    /**
+     * Data sent with ::PBIO_PYBRICKS_COMMAND_ECHO.
+     *
+     * The payload is the data, unchanged.
+     *
+     * @since Unreleased. Should not be considered final.
+     */
+    PBIO_PYBRICKS_EVENT_ECHO = 8,
+
     /**
      * The total number of events that can be queued and sent.
      */
@@ -433,6 +755,50 @@ typedef enum {
      * @since Pybricks Profile v1.5.0.
      */
     PBIO_PYBRICKS_FEATURE_FLAG_USER_PROG_FORMAT_MULTI_MPY_V6_3_NATIVE = 1 << 5,
+    /**
+     * Hub supports ::PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_WINDOWED.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_WINDOWED_PROGRAM_DOWNLOAD = 1 << 6,
+    /**
+     * Hub supports ::PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_COMPRESSED.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_COMPRESSED_PROGRAM_DOWNLOAD = 1 << 7,
+    /**
+     * Hub supports ::PBIO_PYBRICKS_COMMAND_BEGIN_USER_PROGRAM_PATCH and
+     * ::PBIO_PYBRICKS_COMMAND_COPY_USER_RAM.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_PROGRAM_PATCH = 1 << 8,
+    /**
+     * Hub supports ::PBIO_PYBRICKS_COMMAND_CONFIGURE_STDOUT with
+     * ::PBIO_PYBRICKS_STDOUT_FLAG_COMPRESSED over Bluetooth.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_COMPRESSED_STDOUT = 1 << 9,
+    /**
+     * Hub sends ::PBIO_PYBRICKS_EVENT_WRITE_STDIN_ACK.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_STDIN_ACK = 1 << 10,
+    /**
+     * Hub supports ::PBIO_PYBRICKS_COMMAND_WRITE_MOTION.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_MOTION_COMMANDS = 1 << 11,
+    /**
+     * Hub supports ::PBIO_PYBRICKS_COMMAND_ECHO.
+     *
+     * @since Unreleased.
+     */
+    PBIO_PYBRICKS_FEATURE_FLAG_ECHO = 1 << 12,
 } pbio_pybricks_feature_flags_t;
 
 void pbio_pybricks_hub_capabilities(uint8_t *buf,
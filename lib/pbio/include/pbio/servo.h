@@ -40,6 +40,44 @@
 /** Number of values per row when servo data logger is active. */
 #define PBIO_SERVO_LOGGER_NUM_COLS (10)
 
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+/**
+ * State of the feedforward model identification of a servo.
+ */
+typedef struct _pbio_servo_identification_t {
+    /**
+     * Data collected so far.
+     */
+    pbio_observer_identification_t fit;
+    /**
+     * The identified model, used by the observer once identification succeeds.
+     */
+    pbio_observer_model_t model;
+    /**
+     * Angle at the start of the current voltage step.
+     */
+    pbio_angle_t angle_start;
+    /**
+     * Speed at the start of the current voltage step.
+     */
+    int32_t speed_start;
+    /**
+     * Time at the start of the current voltage step.
+     */
+    uint32_t time_start;
+    /**
+     * Index of the current voltage step.
+     */
+    uint8_t step;
+    /**
+     * Outcome of the identification, ::PBIO_ERROR_AGAIN while it runs.
+     */
+    pbio_error_t result;
+} pbio_servo_identification_t;
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
 /**
  * The servo system combines a dcmotor and rotation sensor with a controller
  * to provide speed and position control.
@@ -77,6 +115,12 @@ typedef struct _pbio_servo_t {
      * Link to parent object that uses this servo, like a drive base.
      */
     pbio_parent_t parent;
+    #if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+    /**
+     * Feedforward model identification state.
+     */
+    pbio_servo_identification_t identification;
+    #endif
     /**
      * Internal flag used to set whether the servo state update loop should
      * keep running. This is false when the servo is unplugged or other errors
@@ -143,6 +187,7 @@ pbio_error_t pbio_servo_actuate(pbio_servo_t *srv, pbio_dcmotor_actuation_t actu
 int32_t pbio_servo_get_max_voltage(lego_device_type_id_t id);
 const pbio_servo_settings_reduced_t *pbio_servo_get_reduced_settings(lego_device_type_id_t id);
 void pbio_servo_override_settings(pbio_control_settings_t *settings, lego_device_type_id_t id);
+void pbio_servo_sample_all(void);
 void pbio_servo_update_all(void);
 /** @endcond */
 
@@ -165,7 +210,13 @@ pbio_error_t pbio_servo_run_time(pbio_servo_t *srv, int32_t speed, uint32_t dura
 pbio_error_t pbio_servo_run_until_stalled(pbio_servo_t *srv, int32_t speed, int32_t torque_limit, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_servo_run_angle(pbio_servo_t *srv, int32_t speed, int32_t angle, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_servo_run_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_control_on_completion_t on_completion);
+pbio_error_t pbio_servo_queue_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_control_on_completion_t on_completion);
+pbio_error_t pbio_servo_run_targets_synced(pbio_servo_t **srvs, const int32_t *targets, uint8_t num_servos, int32_t speed, pbio_control_on_completion_t on_completion);
 pbio_error_t pbio_servo_track_target(pbio_servo_t *srv, int32_t target);
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+pbio_error_t pbio_servo_identify_model_start(pbio_servo_t *srv);
+pbio_error_t pbio_servo_identify_model_result(pbio_servo_t *srv);
+#endif
 /**@}*/
 
 #endif // PBIO_CONFIG_SERVO
@@ -52,6 +52,7 @@ pbio_error_t pbio_tacho_setup(pbio_tacho_t *tacho, pbio_direction_t direction, b
 /** @name Status Functions */
 /**@{*/
 pbio_error_t pbio_tacho_get_angle(pbio_tacho_t *tacho, pbio_angle_t *angle);
+pbio_error_t pbio_tacho_get_edge_speed(pbio_tacho_t *tacho, int32_t *speed);
 /**@}*/
 
 /** @name Operation Functions */
@@ -69,6 +70,10 @@ static inline pbio_error_t pbio_tacho_get_angle(pbio_tacho_t *tacho, pbio_angle_
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline pbio_error_t pbio_tacho_get_edge_speed(pbio_tacho_t *tacho, int32_t *speed) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 static inline pbio_error_t pbio_tacho_reset_angle(pbio_tacho_t *tacho, pbio_angle_t *reset_angle, bool reset_to_abs) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
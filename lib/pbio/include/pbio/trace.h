@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup Trace pbio/trace: Recording of sensor and motor input
+ *
+ * Records time-stamped input from sensors and motors into a buffer, so that
+ * a session on a real hub can be replayed and compared against new builds.
+ *
+ * Each event is stored as a 7-byte header followed by its data. The header
+ * holds the time in microseconds (32-bit little endian), the event type, an
+ * identifier such as the device index, and the size of the data.
+ * @{
+ */
+
+#ifndef _PBIO_TRACE_H_
+#define _PBIO_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/config.h>
+
+/**
+ * Size of the header of each recorded event, in bytes.
+ */
+#define PBIO_TRACE_EVENT_HEADER_SIZE (7)
+
+/**
+ * Types of recorded events.
+ */
+typedef enum {
+    /**
+     * Raw LUMP message received from a sensor while synchronizing or in data
+     * mode, including its header and checksum. The identifier is the LUMP
+     * device index.
+     */
+    PBIO_TRACE_EVENT_LUMP_MSG = 0,
+    /**
+     * Unfiltered IMU frame of three gyro and three accelerometer values, as
+     * int16_t. The identifier is always 0.
+     */
+    PBIO_TRACE_EVENT_IMU_FRAME = 1,
+    /**
+     * Motor angle as ::pbio_angle_t, sampled by the control loop. The
+     * identifier is the servo index.
+     */
+    PBIO_TRACE_EVENT_MOTOR_ANGLE = 2,
+} pbio_trace_event_type_t;
+
+/**
+ * One recorded event, as read back for replay.
+ */
+typedef struct {
+    /** Time at which the event was recorded (us). */
+    uint32_t time;
+    /** Type of event. */
+    pbio_trace_event_type_t type;
+    /** Device identifier. */
+    uint8_t id;
+    /** Size of the event data in bytes. */
+    uint8_t size;
+    /** Event data, pointing into the recording. */
+    const uint8_t *data;
+} pbio_trace_event_t;
+
+bool pbio_trace_read_event(const uint8_t *buf, uint32_t size, uint32_t *offset, pbio_trace_event_t *event);
+
+#if PBIO_CONFIG_TRACE
+
+void pbio_trace_start(uint8_t *buf, uint32_t size);
+uint32_t pbio_trace_stop(void);
+bool pbio_trace_is_active(void);
+bool pbio_trace_is_truncated(void);
+void pbio_trace_record(pbio_trace_event_type_t type, uint8_t id, const void *data, uint8_t size);
+
+#else
+
+static inline void pbio_trace_start(uint8_t *buf, uint32_t size) {
+}
+static inline uint32_t pbio_trace_stop(void) {
+    return 0;
+}
+static inline bool pbio_trace_is_active(void) {
+    return false;
+}
+static inline bool pbio_trace_is_truncated(void) {
+    return false;
+}
+static inline void pbio_trace_record(pbio_trace_event_type_t type, uint8_t id, const void *data, uint8_t size) {
+}
+
+#endif // PBIO_CONFIG_TRACE
+
+#endif // _PBIO_TRACE_H_
+
+/** @} */
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup Tracepoint pbio/tracepoint: Event tracing of hot paths
+ *
+ * Keeps the most recent time-stamped events from the event loop, control
+ * loop, interrupts, Bluetooth and garbage collector in a ring buffer in RAM,
+ * so that stalls can be matched to their cause.
+ *
+ * Unlike @ref Trace, which records input data for replay, events here hold
+ * only an identifier and two small arguments, so they are cheap enough to
+ * record in interrupts.
+ * @{
+ */
+
+#ifndef _PBIO_TRACEPOINT_H_
+#define _PBIO_TRACEPOINT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/config.h>
+
+/**
+ * Traced events.
+ */
+typedef enum {
+    /** Event loop starts a pass over all processes. */
+    PBIO_TRACEPOINT_OS_RUN_START = 0,
+    /** Event loop pass done. arg0 is the number of processes that ran. */
+    PBIO_TRACEPOINT_OS_RUN_END = 1,
+    /** Control loop update starts. */
+    PBIO_TRACEPOINT_MOTOR_TICK_START = 2,
+    /** Control loop update done. */
+    PBIO_TRACEPOINT_MOTOR_TICK_END = 3,
+    /**
+     * UART data received in interrupt. arg0 is the UART index, arg1 the number
+     * of bytes waiting to be read.
+     */
+    PBIO_TRACEPOINT_UART_RX = 4,
+    /**
+     * Bluetooth notification to host starts. arg0 is the event type, arg1 the
+     * size in bytes.
+     */
+    PBIO_TRACEPOINT_BLE_TX_START = 5,
+    /** Bluetooth notification to host done. */
+    PBIO_TRACEPOINT_BLE_TX_END = 6,
+    /** Garbage collection starts. */
+    PBIO_TRACEPOINT_GC_START = 7,
+    /** Garbage collection done. */
+    PBIO_TRACEPOINT_GC_END = 8,
+} pbio_tracepoint_id_t;
+
+/**
+ * One traced event.
+ */
+typedef struct {
+    /** Time at which the event happened (us). */
+    uint32_t time;
+    /** Event identifier, a ::pbio_tracepoint_id_t. */
+    uint16_t id;
+    /** First event argument. */
+    uint16_t arg0;
+    /** Second event argument. */
+    uint32_t arg1;
+} pbio_tracepoint_event_t;
+
+#if PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+
+void pbio_tracepoint_set_enabled(bool enable);
+void pbio_tracepoint_record(pbio_tracepoint_id_t id, uint16_t arg0, uint32_t arg1);
+uint32_t pbio_tracepoint_get_events(pbio_tracepoint_event_t *events, uint32_t max_events);
+
+#else
+
+static inline void pbio_tracepoint_set_enabled(bool enable) {
+}
+static inline void pbio_tracepoint_record(pbio_tracepoint_id_t id, uint16_t arg0, uint32_t arg1) {
+}
+static inline uint32_t pbio_tracepoint_get_events(pbio_tracepoint_event_t *events, uint32_t max_events) {
+    return 0;
+}
+
+#endif // PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+
+#endif // _PBIO_TRACEPOINT_H_
+
+/** @} */
@@ -84,6 +84,7 @@ pbio_error_t pbio_trajectory_validate_acceleration_limit(int32_t ctl_steps_per_a
 pbio_error_t pbio_trajectory_new_angle_command(pbio_trajectory_t *trj, const pbio_trajectory_command_t *command);
 pbio_error_t pbio_trajectory_new_time_command(pbio_trajectory_t *trj, const pbio_trajectory_command_t *command);
 void pbio_trajectory_make_constant(pbio_trajectory_t *trj, const pbio_trajectory_command_t *command);
+pbio_error_t pbio_trajectory_make_linear(pbio_trajectory_t *trj, const pbio_trajectory_command_t *command);
 void pbio_trajectory_stretch(pbio_trajectory_t *trj, const pbio_trajectory_t *leader);
 
 // Reference getter functions:
@@ -15,6 +15,8 @@
 #include <stdint.h>
 #include <sys/cdefs.h>
 
+#include <pbio/config.h>
+
 /**
  * Converts @p str to a quoted string.
  * @param [in]  str     The text to be quoted.
@@ -46,6 +48,16 @@
 #define PBIO_CONTAINER_OF(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
 #endif
 
+/**
+ * Marks a function that runs on every control loop iteration. It is copied
+ * to RAM at boot if ::PBIO_CONFIG_HOT_CODE_IN_RAM is enabled.
+ */
+#if PBIO_CONFIG_HOT_CODE_IN_RAM
+#define PBIO_HOT __attribute__((section(".ramfunc"), noinline))
+#else
+#define PBIO_HOT
+#endif
+
 #ifndef DOXYGEN
 static inline
 #endif
@@ -134,6 +146,8 @@ bool pbio_oneshot(bool value, bool *state);
 
 bool pbio_util_time_has_passed(uint32_t sample, uint32_t base);
 
+uint32_t pbio_util_crc32(uint32_t crc, const uint8_t *data, uint32_t size);
+
 #endif // _PBIO_UTIL_H_
 
 /** @} */
@@ -10,7 +10,9 @@
 #define _PBSYS_BATTERY_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
+#include <pbio/error.h>
 #include <pbsys/config.h>
 
 #if PBSYS_CONFIG_BATTERY
@@ -18,6 +20,7 @@
 void pbsys_battery_init(void);
 void pbsys_battery_poll(void);
 bool pbsys_battery_is_full(void);
+pbio_error_t pbsys_battery_get_remaining_runtime(uint32_t *time);
 
 #else // PBSYS_CONFIG_BATTERY
 
@@ -31,6 +34,10 @@ static inline bool pbsys_battery_is_full(void) {
     return false;
 }
 
+static inline pbio_error_t pbsys_battery_get_remaining_runtime(uint32_t *time) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
 #endif // PBSYS_CONFIG_BATTERY
 
 #endif // _PBSYS_BATTERY_H_
@@ -8,6 +8,7 @@
 
 #include "pbsysconfig.h"
 
+#include <pbdrv/config.h>
 #include <pbio/protocol.h>
 
 #define PBSYS_CONFIG_APP_FEATURE_FLAGS (0 \
@@ -16,8 +17,95 @@
     + PBSYS_CONFIG_FEATURE_BUILTIN_USER_PROGRAM_IMU_CALIBRATION * PBIO_PYBRICKS_FEATURE_FLAG_BUILTIN_USER_PROGRAM_IMU_CALIBRATION \
     + PBSYS_CONFIG_FEATURE_PROGRAM_FORMAT_MULTI_MPY_V6 * PBIO_PYBRICKS_FEATURE_FLAG_USER_PROG_FORMAT_MULTI_MPY_V6 \
     + PBSYS_CONFIG_FEATURE_PROGRAM_FORMAT_MULTI_MPY_V6_3_NATIVE * PBIO_PYBRICKS_FEATURE_FLAG_USER_PROG_FORMAT_MULTI_MPY_V6_3_NATIVE \
+    + PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD * PBIO_PYBRICKS_FEATURE_FLAG_WINDOWED_PROGRAM_DOWNLOAD \
+    + PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD * PBIO_PYBRICKS_FEATURE_FLAG_COMPRESSED_PROGRAM_DOWNLOAD \
+    + PBSYS_CONFIG_STORAGE_PROGRAM_PATCH * PBIO_PYBRICKS_FEATURE_FLAG_PROGRAM_PATCH \
+    + PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION * PBIO_PYBRICKS_FEATURE_FLAG_COMPRESSED_STDOUT \
+    + PBSYS_CONFIG_HOST * PBIO_PYBRICKS_FEATURE_FLAG_STDIN_ACK \
+    + PBSYS_CONFIG_HOST_MOTION * PBIO_PYBRICKS_FEATURE_FLAG_MOTION_COMMANDS \
+    + PBSYS_CONFIG_HOST_ECHO * PBIO_PYBRICKS_FEATURE_FLAG_ECHO \
     )
 
+// When set to (1), programs can also be downloaded in numbered chunks that
+// are acknowledged cumulatively, so the host does not have to wait for a
+// response to each chunk.
+#ifndef PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+#define PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD (PBSYS_CONFIG_STORAGE && PBSYS_CONFIG_HOST)
+#endif
+
+// When set to (1), programs can also be downloaded as an LZ4 compressed
+// stream that is decoded as it arrives.
+#ifndef PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+#define PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD (PBSYS_CONFIG_STORAGE)
+#endif
+
+// When set to (1), a download can patch the stored program in place, so that
+// only the changes have to be sent.
+#ifndef PBSYS_CONFIG_STORAGE_PROGRAM_PATCH
+#define PBSYS_CONFIG_STORAGE_PROGRAM_PATCH (PBSYS_CONFIG_STORAGE)
+#endif
+
+// When set to (1), a journaled key-value store is kept in the journal area of
+// the block device. Values are written as they change, so they survive a
+// sudden power loss.
+#ifndef PBSYS_CONFIG_STORAGE_KV
+#define PBSYS_CONFIG_STORAGE_KV (PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL)
+#endif
+
+// Maximum number of keys in the key-value store.
+#ifndef PBSYS_CONFIG_STORAGE_KV_NUM_KEYS
+#define PBSYS_CONFIG_STORAGE_KV_NUM_KEYS (16)
+#endif
+
+// Maximum size of a key in the key-value store.
+#ifndef PBSYS_CONFIG_STORAGE_KV_KEY_SIZE
+#define PBSYS_CONFIG_STORAGE_KV_KEY_SIZE (16)
+#endif
+
+// Maximum size of a value in the key-value store.
+#ifndef PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE
+#define PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE (64)
+#endif
+
+// Policies for sending stdout when one host transport can't keep up with the
+// others. With BLOCK, writes wait for the slowest transport. With DROP, writes
+// wait only for the fastest transport and slower ones drop the newest data
+// that does not fit. DROP_OLDEST is the same, but discards the oldest
+// buffered data instead.
+#define PBSYS_CONFIG_HOST_STDOUT_POLICY_BLOCK (0)
+#define PBSYS_CONFIG_HOST_STDOUT_POLICY_DROP (1)
+#define PBSYS_CONFIG_HOST_STDOUT_POLICY_DROP_OLDEST (2)
+
+#ifndef PBSYS_CONFIG_HOST_STDOUT_POLICY
+#define PBSYS_CONFIG_HOST_STDOUT_POLICY PBSYS_CONFIG_HOST_STDOUT_POLICY_BLOCK
+#endif
+
+// Size of a stdout buffer in front of the host transports, which is sent in
+// the background so that print() does not wait for a slow connection. Use (0)
+// to write to the transports directly.
+#ifndef PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+#define PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE (0)
+#endif
+
+// What to do when the stdout buffer is full, using the policies above. With
+// BLOCK, writes wait for space. With DROP, the newest data is dropped. With
+// DROP_OLDEST, the oldest buffered data is dropped to make room.
+#ifndef PBSYS_CONFIG_HOST_STDOUT_BUF_POLICY
+#define PBSYS_CONFIG_HOST_STDOUT_BUF_POLICY PBSYS_CONFIG_HOST_STDOUT_POLICY_BLOCK
+#endif
+
+// When set to (1), the host can run motors and drive bases of the running
+// program directly with PBIO_PYBRICKS_COMMAND_WRITE_MOTION.
+#ifndef PBSYS_CONFIG_HOST_MOTION
+#define PBSYS_CONFIG_HOST_MOTION (0)
+#endif
+
+// When set to (1), the host can measure the connection with
+// PBIO_PYBRICKS_COMMAND_ECHO, which sends data back without a program.
+#ifndef PBSYS_CONFIG_HOST_ECHO
+#define PBSYS_CONFIG_HOST_ECHO (0)
+#endif
+
 // When set to (1) PBSYS_CONFIG_STATUS_LIGHT indicates that a hub has a hub status light
 #ifndef PBSYS_CONFIG_STATUS_LIGHT
 #error "Must define PBSYS_CONFIG_STATUS_LIGHT in pbsysconfig.h"
@@ -30,12 +30,16 @@ void pbsys_host_init(void);
 bool pbsys_host_is_connected(void);
 void pbsys_host_schedule_status_update(const uint8_t *buf);
 uint32_t pbsys_host_stdin_get_free(void);
-void pbsys_host_stdin_write(const uint8_t *data, uint32_t size);
+pbio_error_t pbsys_host_stdin_write(const uint8_t *data, uint32_t size);
 void pbsys_host_stdin_set_callback(pbsys_host_stdin_event_callback_t callback);
 void pbsys_host_stdin_flush(void);
 uint32_t pbsys_host_stdin_get_available(void);
+uint32_t pbsys_host_stdin_get_line_size(void);
 pbio_error_t pbsys_host_stdin_read(uint8_t *data, uint32_t *size);
 pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size);
+uint32_t pbsys_host_stdout_get_dropped(void);
+void pbsys_host_stdout_flush(void);
+void pbsys_host_stdout_set_line_buffered(bool line_buffered);
 bool pbsys_host_tx_is_idle(void);
 pbio_error_t pbsys_host_send_event(pbio_os_state_t *state, pbio_pybricks_event_t event_type, const uint8_t *data, size_t size);
 
@@ -45,12 +49,16 @@ pbio_error_t pbsys_host_send_event(pbio_os_state_t *state, pbio_pybricks_event_t
 #define pbsys_host_is_connected() false
 #define pbsys_host_schedule_status_update(buf)
 #define pbsys_host_stdin_get_free() 0
-#define pbsys_host_stdin_write(data, size) { (void)(data); (void)(size); }
+#define pbsys_host_stdin_write(data, size) ({ (void)(data); (void)(size); PBIO_ERROR_NOT_SUPPORTED; })
 #define pbsys_host_stdin_set_callback(callback) { (void)(callback); }
 #define pbsys_host_stdin_flush()
 #define pbsys_host_stdin_get_available() 0
+#define pbsys_host_stdin_get_line_size() 0
 #define pbsys_host_stdin_read(data, size) ({ *(data) = 0; *(size) = 0; PBIO_ERROR_NOT_SUPPORTED; })
 #define pbsys_host_stdout_write(data, size) ({ *(size) = 0; PBIO_ERROR_NOT_SUPPORTED; })
+#define pbsys_host_stdout_get_dropped() 0
+#define pbsys_host_stdout_flush()
+#define pbsys_host_stdout_set_line_buffered(line_buffered) { (void)(line_buffered); }
 #define pbsys_host_tx_is_idle() false
 
 static inline pbio_error_t pbsys_host_send_event(pbio_os_state_t *state, pbio_pybricks_event_t event_type, const uint8_t *data, size_t size) {
@@ -72,6 +72,13 @@ typedef struct _pbsys_main_program_t {
      * Whether a request was made to start the program, and how.
      */
     pbsys_main_program_start_request_type_t start_request_type;
+    /**
+     * Whether the application kept its state in user RAM after the program
+     * ended, so it can be reused when the same program runs again. This is
+     * set by the application. The system clears it when program data or user
+     * RAM changes, in which case the state is discarded without cleanup.
+     */
+    bool keep_state;
 } pbsys_main_program_t;
 
 #if PBSYS_CONFIG_MAIN
@@ -96,6 +103,8 @@ pbio_error_t pbsys_main_program_request_start(pbio_pybricks_user_program_id_t id
  */
 bool pbsys_main_program_start_is_requested();
 
+void pbsys_main_program_discard_state(void);
+
 /**
  * Validates the program that is being requested to start.
  *
@@ -120,8 +129,14 @@ void pbsys_main_run_program(pbsys_main_program_t *program);
  *
  * This is separate from ::pbsys_main_run_program so that the system can
  * safely close resources and unset callbacks before this cleanup runs.
+ *
+ * If the application keeps its state for the next run, it should set
+ * pbsys_main_program_t::keep_state and skip the cleanup. The system then
+ * leaves user RAM untouched until the next program starts.
+ *
+ * @param [in]  program   The program that just ended.
  */
-void pbsys_main_run_program_cleanup(void);
+void pbsys_main_run_program_cleanup(pbsys_main_program_t *program);
 
 /**
  * Stops (cancels) the main application program.
@@ -165,6 +180,9 @@ static inline bool pbsys_main_program_start_is_requested() {
     return false;
 }
 
+static inline void pbsys_main_program_discard_state(void) {
+}
+
 static inline pbio_error_t pbsys_main_program_validate(pbsys_main_program_t *program) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
@@ -27,6 +27,8 @@ pbio_error_t pbsys_storage_set_user_data(uint32_t offset, const uint8_t *data, u
 
 pbio_error_t pbsys_storage_get_user_data(uint32_t offset, uint8_t **data, uint32_t size);
 
+pbio_error_t pbsys_storage_read_user_data(uint32_t offset, uint8_t *buffer, uint32_t size);
+
 void pbsys_storage_request_write(void);
 
 #else
@@ -45,6 +47,9 @@ static inline pbio_error_t pbsys_storage_get_user_data(uint32_t offset, uint8_t
     *data = NULL;
     return PBIO_ERROR_NOT_SUPPORTED;
 }
+static inline pbio_error_t pbsys_storage_read_user_data(uint32_t offset, uint8_t *buffer, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
 
 static inline void pbsys_storage_request_write(void) {
 }
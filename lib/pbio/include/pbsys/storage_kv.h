@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+/**
+ * @addtogroup SysStorageKV System: Journaled key-value store.
+ *
+ * Small values that are saved as soon as they change, so they are kept even
+ * if the power is cut. Keys and values are kept in RAM as well, so reading
+ * them does not access the storage.
+ *
+ * @{
+ */
+
+#ifndef _PBSYS_STORAGE_KV_H_
+#define _PBSYS_STORAGE_KV_H_
+
+#include <stdint.h>
+
+#include <pbio/error.h>
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_STORAGE_KV
+
+pbio_error_t pbsys_storage_kv_get(const char *key, uint32_t key_size, const uint8_t **value, uint32_t *value_size);
+
+pbio_error_t pbsys_storage_kv_set(const char *key, uint32_t key_size, const uint8_t *value, uint32_t value_size);
+
+pbio_error_t pbsys_storage_kv_delete(const char *key, uint32_t key_size);
+
+#else
+
+static inline pbio_error_t pbsys_storage_kv_get(const char *key, uint32_t key_size, const uint8_t **value, uint32_t *value_size) {
+    *value = NULL;
+    *value_size = 0;
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbsys_storage_kv_set(const char *key, uint32_t key_size, const uint8_t *value, uint32_t value_size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbsys_storage_kv_delete(const char *key, uint32_t key_size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+#endif // PBSYS_CONFIG_STORAGE_KV
+
+#endif // _PBSYS_STORAGE_KV_H_
+
+/** @} */
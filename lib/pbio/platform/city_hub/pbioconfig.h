@@ -9,6 +9,7 @@
 #define PBIO_CONFIG_LIGHT                   (1)
 #define PBIO_CONFIG_LOGGER                  (1)
 #define PBIO_CONFIG_MOTOR_PROCESS           (1)
+#define PBIO_CONFIG_PF_IR                   (1)
 #define PBIO_CONFIG_PORT                    (1)
 #define PBIO_CONFIG_PORT_NUM_DEV            (2)
 #define PBIO_CONFIG_PORT_DCM                (1)
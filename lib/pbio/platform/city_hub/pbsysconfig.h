@@ -21,6 +21,7 @@
 #define PBSYS_CONFIG_STORAGE                        (1)
 #define PBSYS_CONFIG_STORAGE_NUM_SLOTS              (1)
 #define PBSYS_CONFIG_STORAGE_USER_DATA_SIZE         (128)
+#define PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE       (1)
 #define PBSYS_CONFIG_STATUS_LIGHT                   (1)
 #define PBSYS_CONFIG_STATUS_LIGHT_BATTERY           (0)
 #define PBSYS_CONFIG_STATUS_LIGHT_BLUETOOTH         (0)
@@ -10,6 +10,7 @@
 #define PBIO_CONFIG_LOGGER                  (1)
 #define PBIO_CONFIG_LIGHT_MATRIX            (0)
 #define PBIO_CONFIG_MOTOR_PROCESS           (1)
+#define PBIO_CONFIG_PF_IR                   (1)
 #define PBIO_CONFIG_PORT                    (1)
 #define PBIO_CONFIG_PORT_NUM_DEV            (2)
 #define PBIO_CONFIG_PORT_DCM                (1)
@@ -25,5 +26,8 @@
 #define PBIO_CONFIG_SERVO_PUP               (1)
 #define PBIO_CONFIG_SERVO_PUP_MOVE_HUB      (0)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_TRAJECTORY_CACHE_SIZE   (4)
+
+#define PBIO_CONFIG_HOT_CODE_IN_RAM         (1)
 
 #define PBIO_CONFIG_ENABLE_SYS              (1)
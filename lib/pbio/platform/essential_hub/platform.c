@@ -368,22 +368,24 @@ const pbdrv_pwm_stm32_tim_platform_data_t
     {
         .platform_init = pwm_dev_1_platform_init,
         .TIMx = TIM3,
-        .prescalar = 8, // results in 12 MHz clock
-        .period = 1000, // 12MHz divided by 1k makes 12 kHz PWM
+        .prescalar = 4, // results in 24 MHz clock
+        .period = 1000, // 24MHz divided by 2k (count up and down) makes 12 kHz PWM
         .id = PWM_DEV_1_TIM3,
         // channel 1/2: Port B motor driver
         .channels = PBDRV_PWM_STM32_TIM_CHANNEL_1_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_2_ENABLE
-            | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT,
+            | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT
+            | PBDRV_PWM_STM32_TIM_CENTER_ALIGNED,
     },
     {
         .platform_init = pwm_dev_2_platform_init,
         .TIMx = TIM4,
-        .prescalar = 8, // results in 12 MHz clock
-        .period = 1000, // 12MHz divided by 1k makes 12 kHz PWM
+        .prescalar = 4, // results in 24 MHz clock
+        .period = 1000, // 24MHz divided by 2k (count up and down) makes 12 kHz PWM
         .id = PWM_DEV_2_TIM4,
         // channel 1/2: Port A
         .channels = PBDRV_PWM_STM32_TIM_CHANNEL_1_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_2_ENABLE
-            | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT,
+            | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT
+            | PBDRV_PWM_STM32_TIM_CENTER_ALIGNED,
     },
 };
 
@@ -720,6 +722,11 @@ void SystemInit(void) {
 
     HAL_RCC_OscConfig(&osc_init);
 
+    // These clocks are fixed at runtime. The UART baud rates, timer
+    // prescalers, ADC trigger timer and SPI dividers are set once from them
+    // during driver init, and PCLK2 and the timer clocks cannot be kept
+    // constant when HCLK is divided. Idle power is saved by sleeping in
+    // pbio_os_run_processes_and_wait_for_event() instead.
     RCC_ClkInitTypeDef clk_init;
     clk_init.ClockType = RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
     clk_init.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
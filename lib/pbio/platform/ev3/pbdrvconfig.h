@@ -6,6 +6,7 @@
 #define PBDRV_CONFIG_ADC                            (1)
 #define PBDRV_CONFIG_ADC_EV3                        (1)
 #define PBDRV_CONFIG_ADC_EV3_ADC_NUM_CHANNELS       (16)
+#define PBDRV_CONFIG_ADC_CAPTURE                    (1)
 
 #define PBDRV_CONFIG_CACHE                          (1)
 #define PBDRV_CONFIG_CACHE_EV3                      (1)
@@ -64,6 +65,8 @@
 
 #define PBDRV_CONFIG_DISPLAY                        (1)
 #define PBDRV_CONFIG_DISPLAY_EV3                    (1)
+#define PBDRV_CONFIG_DISPLAY_ST7586S                (1)
+#define PBDRV_CONFIG_DISPLAY_DOUBLE_BUFFER          (1)
 #define PBDRV_CONFIG_DISPLAY_NUM_COLS               (178)
 #define PBDRV_CONFIG_DISPLAY_NUM_ROWS               (128)
 
@@ -102,6 +105,7 @@
 
 #define PBDRV_CONFIG_SOUND                          (1)
 #define PBDRV_CONFIG_SOUND_EV3                      (1)
+#define PBDRV_CONFIG_SOUND_STREAM                   (1)
 #define PBDRV_CONFIG_SOUND_DEFAULT_VOLUME           75
 
 #define PBDRV_CONFIG_UART                           (1)
@@ -109,10 +113,11 @@
 #define PBDRV_CONFIG_UART_EV3                       (1)
 #define PBDRV_CONFIG_UART_EV3_PRU                   (1)
 #define PBDRV_CONFIG_UART_EV3_NUM_UART              (4)
+#define PBDRV_CONFIG_UART_EV3_RX_BUF_SIZE           (4096)
 
 #define PBDRV_CONFIG_USB                            (1)
 #define PBDRV_CONFIG_USB_MAX_PACKET_SIZE            (512)
-#define PBDRV_CONFIG_USB_NUM_BUFFERED_PACKETS       (2)
+#define PBDRV_CONFIG_USB_NUM_BUFFERED_PACKETS       (8)
 #define PBDRV_CONFIG_USB_EV3                        (1)
 #define PBDRV_CONFIG_USB_VID                        LEGO_USB_VID
 #define PBDRV_CONFIG_USB_PID                        LEGO_USB_PID_EV3
@@ -25,5 +25,6 @@
 #define PBIO_CONFIG_SERVO_PUP               (0)
 #define PBIO_CONFIG_SERVO_PUP_MOVE_HUB      (0)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_TRAJECTORY_CACHE_SIZE   (4)
 
 #define PBIO_CONFIG_ENABLE_SYS              (1)
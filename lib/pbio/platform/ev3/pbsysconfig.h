@@ -17,11 +17,16 @@
 #define PBSYS_CONFIG_HMI_EV3_UI                     (1)
 #define PBSYS_CONFIG_HMI_NUM_SLOTS                  (4)
 #define PBSYS_CONFIG_HOST                           (1)
+#define PBSYS_CONFIG_HOST_MOTION                    (1)
+#define PBSYS_CONFIG_HOST_ECHO                      (1)
+#define PBSYS_CONFIG_HOST_STDOUT_POLICY             PBSYS_CONFIG_HOST_STDOUT_POLICY_DROP_OLDEST
 #define PBSYS_CONFIG_HOST_STDIN_BUF_SIZE            (21)
+#define PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE           (4096)
 #define PBSYS_CONFIG_MAIN                           (1)
 #define PBSYS_CONFIG_STORAGE                        (1)
 #define PBSYS_CONFIG_STORAGE_NUM_SLOTS              (PBSYS_CONFIG_HMI_NUM_SLOTS)
 #define PBSYS_CONFIG_STORAGE_USER_DATA_SIZE         (512)
+#define PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE       (0)
 #define PBSYS_CONFIG_STATUS_LIGHT                   (1)
 #define PBSYS_CONFIG_STATUS_LIGHT_BATTERY           (0)
 #define PBSYS_CONFIG_STATUS_LIGHT_BLUETOOTH         (0)
@@ -718,7 +718,10 @@ static void mmu_init(void) {
     // On-chip RAM, which is used to share control structures with the PRUs
     l1_page_table[0x80000000 >> MMU_SECTION_SHIFT] = MMU_L1_SECTION(0x80000000, 0, 1, 0, 0);
 
-    // Off-chip main DDR RAM
+    // Off-chip main DDR RAM. This holds all code, data, the stack and the
+    // MicroPython heap, so it is cached. DMA buffers in DDR stay cached too,
+    // using PBDRV_DMA_BUF and the pbdrv_cache functions, or are accessed via
+    // the uncached mirror below.
     for (unsigned int i = 0; i < SYSTEM_RAM_SZ_MB; i++) {
         uint32_t addr = 0xC0000000 + i * MMU_SECTION_SZ;
         // Enable write-back caching
@@ -2,9 +2,11 @@
 // Copyright (c) 2019-2023 The Pybricks Authors
 
 #define PBIO_CONFIG_BATTERY                 (1)
+#define PBIO_CONFIG_CONTROL_QUEUE_NUM       (2)
 #define PBIO_CONFIG_DCMOTOR                 (1)
 #define PBIO_CONFIG_DCMOTOR_NUM_DEV         (4)
-#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (21) // Must be > PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE
+#define PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE (32) // Must be a power of two > PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE
+#define PBIO_CONFIG_DRIVEBASE_ODOMETRY      (0)
 #define PBIO_CONFIG_DRIVEBASE_SPIKE         (0)
 #define PBIO_CONFIG_IMU                     (0)
 #define PBIO_CONFIG_LIGHT                   (1)
@@ -19,11 +21,14 @@
 #define PBIO_CONFIG_PORT_LUMP               (1)
 #define PBIO_CONFIG_PORT_LUMP_MODE_INFO     (0)
 #define PBIO_CONFIG_PORT_LUMP_NUM_DEV       (2)
+#define PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE (0)
 #define PBIO_CONFIG_SERVO                   (1)
 #define PBIO_CONFIG_SERVO_NUM_DEV           (4)
 #define PBIO_CONFIG_SERVO_EV3_NXT           (0)
 #define PBIO_CONFIG_SERVO_PUP               (1)
 #define PBIO_CONFIG_SERVO_PUP_MOVE_HUB      (1)
+#define PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION (0)
+#define PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE (1)
 #define PBIO_CONFIG_TACHO                   (1)
 #define PBIO_CONFIG_CONTROL_MINIMAL         (1)
 
@@ -21,6 +21,10 @@
 #define PBSYS_CONFIG_STORAGE                        (1)
 #define PBSYS_CONFIG_STORAGE_NUM_SLOTS              (1)
 #define PBSYS_CONFIG_STORAGE_USER_DATA_SIZE         (128)
+#define PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE       (1)
+#define PBSYS_CONFIG_STORAGE_PROGRAM_PATCH          (0)
+#define PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD    (0)
+#define PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD      (0)
 #define PBSYS_CONFIG_STATUS_LIGHT                   (1)
 #define PBSYS_CONFIG_STATUS_LIGHT_BATTERY           (0)
 #define PBSYS_CONFIG_STATUS_LIGHT_BLUETOOTH         (0)
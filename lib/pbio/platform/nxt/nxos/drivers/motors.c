@@ -104,10 +104,13 @@ static void motors_isr(void) {
        * 'backwards', and we should decrement the tachymeter count
        * instead of incrementing it.
        */
-      if ((tach && !dir) || (!tach && dir))
+      if ((tach && !dir) || (!tach && dir)) {
         motors_state[i].current_count++;
-      else
+        nx_motors_tach_edge_hook(i, 1);
+      } else {
         motors_state[i].current_count--;
+        nx_motors_tach_edge_hook(i, -1);
+      }
     }
   }
 }
@@ -45,6 +45,16 @@
  */
 uint32_t nx_motors_get_tach_count(uint8_t motor);
 
+/** Called from the tachometer interrupt on each change of the count.
+ *
+ * This must be implemented by the user of this driver, which can use it
+ * to measure the time between edges.
+ *
+ * @param motor The motor port.
+ * @param direction 1 if the count went up, -1 if it went down.
+ */
+void nx_motors_tach_edge_hook(uint8_t motor, int8_t direction);
+
 /*@}*/
 /*@}*/
 
@@ -22,8 +22,8 @@
 #define HCI_ACL_PAYLOAD_SIZE (1691 + 4)
 #define MAX_ATT_DB_SIZE 512
 #define MAX_NR_BTSTACK_LINK_KEY_DB_MEMORY_ENTRIES  0
-#define MAX_NR_GATT_CLIENTS 2
-#define MAX_NR_HCI_CONNECTIONS 3 // CC2564C can have up to 10 connections
+#define MAX_NR_GATT_CLIENTS 3
+#define MAX_NR_HCI_CONNECTIONS 5 // CC2564C can have up to 10 connections
 #define MAX_NR_HFP_CONNECTIONS 0
 #define MAX_NR_L2CAP_CHANNELS  0
 #define MAX_NR_L2CAP_SERVICES  0
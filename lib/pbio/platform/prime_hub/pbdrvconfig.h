@@ -27,8 +27,9 @@
 
 #define PBDRV_CONFIG_BLUETOOTH                      (1)
 #define PBDRV_CONFIG_BLUETOOTH_NUM_CLASSIC_CONNECTIONS (0)
-#define PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS      (2)
+#define PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS      (3)
 #define PBDRV_CONFIG_BLUETOOTH_MAX_MTU_SIZE         515
+#define PBDRV_CONFIG_BLUETOOTH_STDOUT_COMPRESSION   (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK              (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_NUM_LE_HOSTS (2)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_STM32        (1)
@@ -46,6 +47,11 @@
 // just needs to be big enough to back up the user program on shutdown.
 #define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_START_ADDRESS (512 * 1024)
 #define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_SIZE (256 * 1024)
+// The journal for the key-value store follows the area above. It is written
+// in place, so it is not loaded into RAM.
+#define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL (1)
+#define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_START_ADDRESS (768 * 1024)
+#define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_JOURNAL_SIZE (64 * 1024)
 
 #define PBDRV_CONFIG_BUTTON                         (1)
 #define PBDRV_CONFIG_BUTTON_RESISTOR_LADDER         (1)
@@ -111,11 +117,13 @@
 #define PBDRV_CONFIG_SOUND_SAMPLED                  (1)
 #define PBDRV_CONFIG_SOUND_BEEP_SAMPLED             (1)
 #define PBDRV_CONFIG_SOUND_STM32_HAL_DAC            (1)
+#define PBDRV_CONFIG_SOUND_STREAM                   (1)
 
 #define PBDRV_CONFIG_UART                           (1)
 #define PBDRV_CONFIG_UART_DEBUG_FIRST_PORT          (0)
 #define PBDRV_CONFIG_UART_STM32F4_LL_IRQ            (1)
 #define PBDRV_CONFIG_UART_STM32F4_LL_IRQ_NUM_UART   (6)
+#define PBDRV_CONFIG_UART_STM32F4_LL_IRQ_RX_BUF_SIZE (512)
 
 #define PBDRV_CONFIG_USB                            (1)
 #define PBDRV_CONFIG_USB_MAX_PACKET_SIZE            (64)
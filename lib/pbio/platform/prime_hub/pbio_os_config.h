@@ -17,3 +17,8 @@ static inline void pbio_os_hook_enable_irq(pbio_os_irq_flags_t flags) {
 static inline void pbio_os_hook_wait_for_interrupt(pbio_os_irq_flags_t flags) {
     __WFI();
 }
+
+static inline void pbio_os_hook_wait_for_interrupt_tickless(pbio_os_irq_flags_t flags, uint32_t duration) {
+    extern void pbdrv_clock_wait_for_interrupt_tickless(uint32_t duration);
+    pbdrv_clock_wait_for_interrupt_tickless(duration);
+}
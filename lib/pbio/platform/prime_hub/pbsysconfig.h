@@ -18,11 +18,16 @@
 #define PBSYS_CONFIG_HUB_LIGHT_MATRIX               (1)
 #define PBSYS_CONFIG_HUB_LIGHT_MATRIX_LED_ARRAY     (1)
 #define PBSYS_CONFIG_HOST                           (1)
+#define PBSYS_CONFIG_HOST_MOTION                    (1)
+#define PBSYS_CONFIG_HOST_ECHO                      (1)
+#define PBSYS_CONFIG_HOST_STDOUT_POLICY             PBSYS_CONFIG_HOST_STDOUT_POLICY_DROP_OLDEST
 #define PBSYS_CONFIG_HOST_STDIN_BUF_SIZE            (64)
+#define PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE           (2048)
 #define PBSYS_CONFIG_MAIN                           (1)
 #define PBSYS_CONFIG_STORAGE                        (1)
 #define PBSYS_CONFIG_STORAGE_NUM_SLOTS              (5)
 #define PBSYS_CONFIG_STORAGE_USER_DATA_SIZE         (512)
+#define PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE       (0)
 #define PBSYS_CONFIG_STATUS_LIGHT                   (1)
 #define PBSYS_CONFIG_STATUS_LIGHT_BATTERY           (1)
 #define PBSYS_CONFIG_STATUS_LIGHT_BLUETOOTH         (1)
@@ -6,6 +6,7 @@
 #include <btstack_chipset_cc256x.h>
 #undef UNUSED
 #include <stm32f4xx_hal.h>
+#include <stm32f4xx_ll_dma.h>
 
 #include <pbdrv/clock.h>
 #include <pbdrv/ioport.h>
@@ -548,38 +549,41 @@ const pbdrv_pwm_stm32_tim_platform_data_t
     {
         .platform_init = pwm_dev_0_platform_init,
         .TIMx = TIM1,
-        .prescalar = 8, // results in 12 MHz clock
-        .period = 1000, // 12MHz divided by 1k makes 12 kHz PWM
+        .prescalar = 4, // results in 24 MHz clock
+        .period = 1000, // 24MHz divided by 2k (count up and down) makes 12 kHz PWM
         .id = PWM_DEV_0_TIM1,
         // channel 1/2: Port A motor driver; channel 3/4: Port B motor driver
         .channels = PBDRV_PWM_STM32_TIM_CHANNEL_1_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_2_ENABLE
             | PBDRV_PWM_STM32_TIM_CHANNEL_3_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_4_ENABLE
             | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT
-            | PBDRV_PWM_STM32_TIM_CHANNEL_3_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_4_INVERT,
+            | PBDRV_PWM_STM32_TIM_CHANNEL_3_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_4_INVERT
+            | PBDRV_PWM_STM32_TIM_CENTER_ALIGNED,
     },
     {
         .platform_init = pwm_dev_1_platform_init,
         .TIMx = TIM3,
-        .prescalar = 8, // results in 12 MHz clock
-        .period = 1000, // 12MHz divided by 1k makes 12 kHz PWM
+        .prescalar = 4, // results in 24 MHz clock
+        .period = 1000, // 24MHz divided by 2k (count up and down) makes 12 kHz PWM
         .id = PWM_DEV_1_TIM3,
         // channel 1/2: Port E motor driver; channel 3/4: Port F motor driver
         .channels = PBDRV_PWM_STM32_TIM_CHANNEL_1_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_2_ENABLE
             | PBDRV_PWM_STM32_TIM_CHANNEL_3_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_4_ENABLE
             | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT
-            | PBDRV_PWM_STM32_TIM_CHANNEL_3_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_4_INVERT,
+            | PBDRV_PWM_STM32_TIM_CHANNEL_3_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_4_INVERT
+            | PBDRV_PWM_STM32_TIM_CENTER_ALIGNED,
     },
     {
         .platform_init = pwm_dev_2_platform_init,
         .TIMx = TIM4,
-        .prescalar = 8, // results in 12 MHz clock
-        .period = 1000, // 12MHz divided by 1k makes 12 kHz PWM
+        .prescalar = 4, // results in 24 MHz clock
+        .period = 1000, // 24MHz divided by 2k (count up and down) makes 12 kHz PWM
         .id = PWM_DEV_2_TIM4,
         // channel 1/2: Port C motor driver; channel 3/4: Port D motor driver
         .channels = PBDRV_PWM_STM32_TIM_CHANNEL_1_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_2_ENABLE
             | PBDRV_PWM_STM32_TIM_CHANNEL_3_ENABLE | PBDRV_PWM_STM32_TIM_CHANNEL_4_ENABLE
             | PBDRV_PWM_STM32_TIM_CHANNEL_1_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_2_INVERT
-            | PBDRV_PWM_STM32_TIM_CHANNEL_3_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_4_INVERT,
+            | PBDRV_PWM_STM32_TIM_CHANNEL_3_INVERT | PBDRV_PWM_STM32_TIM_CHANNEL_4_INVERT
+            | PBDRV_PWM_STM32_TIM_CENTER_ALIGNED,
     },
     {
         .platform_init = pwm_dev_3_platform_init,
@@ -684,6 +688,9 @@ const pbdrv_uart_stm32f4_ll_irq_platform_data_t
     [UART_PORT_A] = {
         .uart = UART7,
         .irq = UART7_IRQn,
+        .tx_dma = DMA1,
+        .tx_dma_stream = LL_DMA_STREAM_1,
+        .tx_dma_ch = LL_DMA_CHANNEL_5,
     },
     [UART_PORT_B] = {
         .uart = UART4,
@@ -692,6 +699,9 @@ const pbdrv_uart_stm32f4_ll_irq_platform_data_t
     [UART_PORT_C] = {
         .uart = UART8,
         .irq = UART8_IRQn,
+        .tx_dma = DMA1,
+        .tx_dma_stream = LL_DMA_STREAM_0,
+        .tx_dma_ch = LL_DMA_CHANNEL_5,
     },
     [UART_PORT_D] = {
         .uart = UART5,
@@ -1020,6 +1030,11 @@ void SystemInit(void) {
 
     HAL_RCC_OscConfig(&osc_init);
 
+    // These clocks are fixed at runtime. The UART baud rates, timer
+    // prescalers, ADC trigger timer and SPI dividers are set once from them
+    // during driver init, and PCLK2 and the timer clocks cannot be kept
+    // constant when HCLK is divided. Idle power is saved by sleeping in
+    // pbio_os_run_processes_and_wait_for_event() instead.
     RCC_ClkInitTypeDef clk_init;
     clk_init.ClockType = RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
     clk_init.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
@@ -84,6 +84,7 @@
 #define PBDRV_CONFIG_UART_DEBUG_FIRST_PORT          (0)
 #define PBDRV_CONFIG_UART_STM32L4_LL_DMA            (1)
 #define PBDRV_CONFIG_UART_STM32L4_LL_DMA_NUM_UART   (4)
+#define PBDRV_CONFIG_UART_PEEK                      (1)
 
 #define PBDRV_CONFIG_STACK                          (1)
 #define PBDRV_CONFIG_STACK_EMBEDDED                 (1)
@@ -9,6 +9,7 @@
 #define PBIO_CONFIG_LIGHT                   (1)
 #define PBIO_CONFIG_LOGGER                  (1)
 #define PBIO_CONFIG_MOTOR_PROCESS           (1)
+#define PBIO_CONFIG_PF_IR                   (1)
 #define PBIO_CONFIG_PORT                    (1)
 #define PBIO_CONFIG_PORT_NUM_DEV            (4)
 #define PBIO_CONFIG_PORT_DCM                (1)
@@ -24,5 +25,6 @@
 #define PBIO_CONFIG_SERVO_PUP               (1)
 #define PBIO_CONFIG_SERVO_PUP_MOVE_HUB      (0)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_TRAJECTORY_CACHE_SIZE   (4)
 
 #define PBIO_CONFIG_ENABLE_SYS              (1)
@@ -4,6 +4,10 @@
 #define PBDRV_CONFIG_BATTERY                                (1)
 #define PBDRV_CONFIG_BATTERY_TEST                           (1)
 
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM               (1)
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SIZE          (16 * 1024)
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SECTOR_SIZE   (4 * 1024)
+
 #define PBDRV_CONFIG_BUTTON                                 (1)
 #define PBDRV_CONFIG_BUTTON_TEST                            (1)
 
@@ -19,6 +23,8 @@
 
 #define PBDRV_CONFIG_COUNTER                                (1)
 
+#define PBDRV_CONFIG_DISPLAY_ST7586S                        (1)
+
 #define PBDRV_CONFIG_GPIO                                   (1)
 #define PBDRV_CONFIG_GPIO_VIRTUAL                           (1)
 
@@ -15,3 +15,9 @@ static inline void pbio_os_hook_wait_for_interrupt(pbio_os_irq_flags_t flags) {
     extern void pbio_test_clock_tick(uint32_t ticks);
     pbio_test_clock_tick(1);
 }
+
+static inline void pbio_os_hook_wait_for_interrupt_tickless(pbio_os_irq_flags_t flags, uint32_t duration) {
+    // Skip ahead to the next timer deadline.
+    extern void pbio_test_clock_tick(uint32_t ticks);
+    pbio_test_clock_tick(duration);
+}
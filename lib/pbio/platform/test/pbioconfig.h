@@ -1,5 +1,6 @@
 
 #define PBIO_CONFIG_BATTERY                 (1)
+#define PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES (64)
 #define PBIO_CONFIG_DCMOTOR                 (1)
 #define PBIO_CONFIG_DCMOTOR_NUM_DEV         (6)
 #define PBIO_CONFIG_DRIVEBASE_SPIKE         (0)
@@ -10,6 +11,9 @@
 #define PBIO_CONFIG_LIGHT_MATRIX            (1)
 #define PBIO_CONFIG_LIGHT_MATRIX_NUM_DEV    (1)
 #define PBIO_CONFIG_MOTOR_PROCESS           (1)
+#define PBIO_CONFIG_OS_PROFILE              (1)
+#define PBIO_CONFIG_OS_TICKLESS             (1)
+#define PBIO_CONFIG_PF_IR                   (1)
 #define PBIO_CONFIG_PORT                    (1)
 #define PBIO_CONFIG_PORT_NUM_DEV            (6)
 #define PBIO_CONFIG_PORT_DCM                (0)
@@ -25,3 +29,6 @@
 #define PBIO_CONFIG_SERVO_PUP               (1)
 #define PBIO_CONFIG_SERVO_PUP_MOVE_HUB      (1)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_TRACE                   (1)
+#define PBIO_CONFIG_TRACEPOINT_NUM_EVENTS (256)
+#define PBIO_CONFIG_TRAJECTORY_CACHE_SIZE   (4)
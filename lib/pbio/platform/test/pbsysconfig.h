@@ -9,7 +9,10 @@
 #define PBSYS_CONFIG_BATTERY                        (0)
 #define PBSYS_CONFIG_BATTERY_CHARGER                (0)
 #define PBSYS_CONFIG_HOST                           (1)
+#define PBSYS_CONFIG_HOST_MOTION                    (1)
+#define PBSYS_CONFIG_HOST_ECHO                      (1)
 #define PBSYS_CONFIG_HOST_STDIN_BUF_SIZE            (64)
+#define PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE           (256)
 #define PBSYS_CONFIG_HMI_NUM_SLOTS                  (0)
 #define PBSYS_CONFIG_HUB_LIGHT_MATRIX               (0)
 #define PBSYS_CONFIG_MAIN                           (0)
@@ -59,11 +59,20 @@ def update_display(data):
                 virtual_display.set_at((x, y), color)
 
 
+PBSYS_TELEMETRY_TAG_PORT_ANGLE = 2
+
+
 def process_telemetry(payload):
-    # Only supports motors for now.
-    if len(payload) == 6:
-        type_id, index, angle = struct.unpack("<bbi", payload[0:6])
-        if type_id == 94:  # REVISIT: Align with firmware
+    # Payload is a sequence of (tag, size, value) records.
+    pos = 0
+    while pos + 2 <= len(payload):
+        tag, size = payload[pos], payload[pos + 1]
+        value = payload[pos + 2 : pos + 2 + size]
+        pos += 2 + size
+
+        # Only supports motor angles for now.
+        if tag == PBSYS_TELEMETRY_TAG_PORT_ANGLE and size == 5:
+            index, angle = struct.unpack("<bi", value)
             angles[index] = angle
 
 
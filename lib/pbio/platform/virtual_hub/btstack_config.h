@@ -29,6 +29,7 @@
 #define ENABLE_LE_CENTRAL
 #define ENABLE_L2CAP_LE_CREDIT_BASED_FLOW_CONTROL_MODE
 #define ENABLE_LE_DATA_LENGTH_EXTENSION
+#define ENABLE_LE_EXTENDED_ADVERTISING
 #define ENABLE_LE_PERIPHERAL
 #define ENABLE_LE_PRIVACY_ADDRESS_RESOLUTION
 #define ENABLE_LE_SECURE_CONNECTIONS
@@ -7,9 +7,18 @@
 #define PBDRV_CONFIG_BLOCK_DEVICE                           (1)
 #define PBDRV_CONFIG_BLOCK_DEVICE_RAM_SIZE                  (50 * 1024)
 #define PBDRV_CONFIG_BLOCK_DEVICE_TEST                      (1)
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM               (1)
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SIZE          (16 * 1024)
+#define PBDRV_CONFIG_BLOCK_DEVICE_JOURNAL_RAM_SECTOR_SIZE   (4 * 1024)
 
-// Use Bluetooth simulation locally.
-#ifndef PBDRV_CONFIG_RUN_ON_CI
+// Use an in-memory radio shared by all virtual hubs if requested, or a real
+// Bluetooth adapter otherwise when running locally.
+#ifdef PBDRV_CONFIG_RUN_SIMULATED_RADIO
+#define PBDRV_CONFIG_BLUETOOTH                              (1)
+#define PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS              (2)
+#define PBDRV_CONFIG_BLUETOOTH_SIMULATION                   (1)
+#define PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING         (1)
+#elif !defined(PBDRV_CONFIG_RUN_ON_CI)
 #define PBDRV_CONFIG_BLUETOOTH                              (1)
 #define PBDRV_CONFIG_BLUETOOTH_NUM_CLASSIC_CONNECTIONS      (2)
 #define PBDRV_CONFIG_BLUETOOTH_NUM_PERIPHERALS              (2)
@@ -17,13 +26,16 @@
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_NUM_LE_HOSTS         (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_POSIX                (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_HUB_KIND             (LWP3_HUB_KIND_TECHNIC_LARGE)
-#endif // PBDRV_CONFIG_RUN_ON_CI
+#define PBDRV_CONFIG_BLUETOOTH_EXTENDED_ADVERTISING         (1)
+#endif // PBDRV_CONFIG_RUN_SIMULATED_RADIO
 
 #define PBDRV_CONFIG_BUTTON                                 (1)
 #define PBDRV_CONFIG_BUTTON_VIRTUAL                         (1)
 
 #define PBDRV_CONFIG_CLOCK                                  (1)
-#ifdef PBDRV_CONFIG_RUN_ON_CI
+// The simulated clock only advances when all events have been handled, so
+// programs run as fast as possible instead of in real time.
+#ifdef PBDRV_CONFIG_RUN_SIMULATED_CLOCK
 #define PBDRV_CONFIG_CLOCK_TEST                             (1)
 #else
 #define PBDRV_CONFIG_CLOCK_LINUX                            (1)
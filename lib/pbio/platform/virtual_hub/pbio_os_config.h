@@ -1,4 +1,5 @@
 #include <signal.h>
+#include <stdint.h>
 
 typedef sigset_t pbio_os_irq_flags_t;
 
@@ -7,3 +8,5 @@ pbio_os_irq_flags_t pbio_os_hook_disable_irq(void);
 void pbio_os_hook_enable_irq(pbio_os_irq_flags_t flags);
 
 void pbio_os_hook_wait_for_interrupt(pbio_os_irq_flags_t flags);
+
+void pbio_os_hook_wait_for_interrupt_tickless(pbio_os_irq_flags_t flags, uint32_t duration);
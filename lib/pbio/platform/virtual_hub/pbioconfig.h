@@ -2,6 +2,7 @@
 // Copyright (c) 2022-2025 The Pybricks Authors
 
 #define PBIO_CONFIG_BATTERY                 (1)
+#define PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES (1024)
 #define PBIO_CONFIG_DCMOTOR                 (6)
 #define PBIO_CONFIG_DCMOTOR_NUM_DEV         (6)
 #define PBIO_CONFIG_DRIVEBASE_SPIKE         (1)
@@ -10,6 +11,10 @@
 #define PBIO_CONFIG_LOGGER                  (1)
 #define PBIO_CONFIG_LIGHT_MATRIX            (0)
 #define PBIO_CONFIG_MOTOR_PROCESS           (1)
+#define PBIO_CONFIG_OS_PROFILE              (1)
+#ifdef PBDRV_CONFIG_RUN_SIMULATED_CLOCK
+#define PBIO_CONFIG_OS_TICKLESS             (1)
+#endif
 #define PBIO_CONFIG_IMU                     (0)
 #define PBIO_CONFIG_PORT                    (1)
 #define PBIO_CONFIG_PORT_NUM_DEV            (6)
@@ -26,5 +31,8 @@
 #define PBIO_CONFIG_SERVO_PUP               (1)
 #define PBIO_CONFIG_SERVO_PUP_MOVE_HUB      (1)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_TRACE                   (1)
+#define PBIO_CONFIG_TRACEPOINT_NUM_EVENTS (256)
+#define PBIO_CONFIG_TRAJECTORY_CACHE_SIZE   (4)
 
 #define PBIO_CONFIG_ENABLE_SYS              (1)
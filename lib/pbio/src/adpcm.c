@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <string.h>
+
+#include <pbio/adpcm.h>
+#include <pbio/util.h>
+
+/**
+ * Size of the header at the start of each block, in bytes.
+ */
+#define PBIO_ADPCM_BLOCK_HEADER_SIZE (4)
+
+/**
+ * Step sizes for each step index.
+ */
+static const uint16_t pbio_adpcm_step_table[] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+    963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+    3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+    9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623,
+    27086, 29794, 32767,
+};
+
+/**
+ * Change of the step index for each code, without the sign bit.
+ */
+static const int8_t pbio_adpcm_index_table[] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+/**
+ * Initializes a decoder for a new clip.
+ *
+ * @param [in]  decoder     The decoder.
+ * @param [in]  data        Encoded data, which must remain valid while decoding.
+ * @param [in]  size        Size of @p data in bytes.
+ * @param [in]  block_size  Size of each block in bytes, or 0 for a raw stream.
+ * @param [in]  attenuator  Number to multiply samples by to set the volume,
+ *                          up to INT16_MAX for full volume.
+ */
+void pbio_adpcm_decoder_init(pbio_adpcm_decoder_t *decoder, const uint8_t *data, uint32_t size, uint32_t block_size, uint16_t attenuator) {
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->data = data;
+    decoder->size = size;
+    decoder->block_size = block_size > PBIO_ADPCM_BLOCK_HEADER_SIZE ? block_size : 0;
+    decoder->attenuator = attenuator > INT16_MAX ? INT16_MAX : attenuator;
+}
+
+/**
+ * Updates the decoder state with one 4-bit code.
+ *
+ * @param [in]  decoder     The decoder.
+ * @param [in]  code        The code.
+ */
+static void pbio_adpcm_decode_code(pbio_adpcm_decoder_t *decoder, uint8_t code) {
+    int32_t step = pbio_adpcm_step_table[decoder->step_index];
+
+    int32_t diff = step >> 3;
+    if (code & 4) {
+        diff += step;
+    }
+    if (code & 2) {
+        diff += step >> 1;
+    }
+    if (code & 1) {
+        diff += step >> 2;
+    }
+
+    int32_t predictor = decoder->predictor + ((code & 8) ? -diff : diff);
+    if (predictor > INT16_MAX) {
+        predictor = INT16_MAX;
+    } else if (predictor < INT16_MIN) {
+        predictor = INT16_MIN;
+    }
+    decoder->predictor = predictor;
+
+    int32_t index = decoder->step_index + pbio_adpcm_index_table[code & 7];
+    if (index < 0) {
+        index = 0;
+    } else if (index >= (int32_t)PBIO_ARRAY_SIZE(pbio_adpcm_step_table)) {
+        index = PBIO_ARRAY_SIZE(pbio_adpcm_step_table) - 1;
+    }
+    decoder->step_index = index;
+}
+
+/**
+ * Decodes the next samples.
+ *
+ * Samples are unsigned with silence at INT16_MAX, as used by the sound driver.
+ *
+ * @param [in]  decoder     The decoder.
+ * @param [out] samples     Buffer for the decoded samples.
+ * @param [in]  length      Maximum number of samples to decode.
+ * @returns                 Number of samples decoded, which is less than
+ *                          @p length only at the end of the data.
+ */
+uint32_t pbio_adpcm_decode(pbio_adpcm_decoder_t *decoder, uint16_t *samples, uint32_t length) {
+    // Positions are counted in 4-bit codes, two per byte.
+    uint32_t end = decoder->size * 2;
+    uint32_t count;
+
+    for (count = 0; count < length && decoder->position < end; count++) {
+        if (decoder->block_size && decoder->position % (decoder->block_size * 2) == 0) {
+            // Each block starts with the first sample and step index.
+            if (end - decoder->position < PBIO_ADPCM_BLOCK_HEADER_SIZE * 2) {
+                decoder->position = end;
+                break;
+            }
+            const uint8_t *header = &decoder->data[decoder->position / 2];
+            decoder->predictor = pbio_get_uint16_le(header);
+            decoder->step_index = header[2] < PBIO_ARRAY_SIZE(pbio_adpcm_step_table) ?
+                header[2] : PBIO_ARRAY_SIZE(pbio_adpcm_step_table) - 1;
+            decoder->position += PBIO_ADPCM_BLOCK_HEADER_SIZE * 2;
+        } else {
+            // Low nibble comes first.
+            uint8_t code = decoder->data[decoder->position / 2] >> (decoder->position % 2 * 4);
+            pbio_adpcm_decode_code(decoder, code & 0x0F);
+            decoder->position++;
+        }
+        samples[count] = INT16_MAX + (decoder->predictor * decoder->attenuator >> 15);
+    }
+    return count;
+}
@@ -15,6 +15,22 @@
 // Maximum number of rotations that still fit in a 30 bit millidegree value.
 #define SMALL_ROT_MAX (INT32_MAX / 2 / MDEG_PER_ROT - 1)
 
+// Number of scales for which the output units per rotation are cached.
+#define LOW_RES_CACHE_SIZE (4)
+
+/**
+ * Cached number of output units per rotation for a given scale.
+ */
+typedef struct {
+    /** Ratio between high resolution angle and output, or 0 if unused. */
+    int32_t scale;
+    /** Output units per rotation, or 0 if a rotation is not a whole number of output units. */
+    int32_t steps_per_rotation;
+} low_res_cache_t;
+
+static low_res_cache_t low_res_cache[LOW_RES_CACHE_SIZE];
+static uint8_t low_res_cache_next;
+
 void pbio_angle_flush(pbio_angle_t *a) {
     while (a->millidegrees > MDEG_PER_ROT) {
         a->millidegrees -= MDEG_PER_ROT;
@@ -116,6 +132,42 @@ void pbio_angle_neg(pbio_angle_t *a) {
     a->rotations *= -1;
 }
 
+/**
+ * Scales down whole rotations to output units, truncating the result.
+ *
+ * This is called for every motor on every control loop iteration, so the
+ * number of output units per rotation is cached for the last few scales. When
+ * one rotation is a whole number of output units, as for motors without
+ * gears, this avoids the long division on hubs without a hardware divider.
+ *
+ * @param [in]   rotations  Number of rotations.
+ * @param [in]   scale      Ratio between high resolution angle and output.
+ * @return                  Rotations in output units.
+ */
+static int32_t pbio_angle_rotations_to_low_res(int32_t rotations, int32_t scale) {
+
+    low_res_cache_t *entry = NULL;
+    for (uint8_t i = 0; i < LOW_RES_CACHE_SIZE; i++) {
+        if (low_res_cache[i].scale == scale) {
+            entry = &low_res_cache[i];
+            break;
+        }
+    }
+
+    // On a miss, replace the oldest entry.
+    if (!entry) {
+        entry = &low_res_cache[low_res_cache_next];
+        low_res_cache_next = (low_res_cache_next + 1) % LOW_RES_CACHE_SIZE;
+        entry->scale = scale;
+        entry->steps_per_rotation = MDEG_PER_ROT % scale == 0 ? MDEG_PER_ROT / scale : 0;
+    }
+
+    if (entry->steps_per_rotation) {
+        return rotations * entry->steps_per_rotation;
+    }
+    return pbio_int_math_mult_then_div(rotations, MDEG_PER_ROT, scale);
+}
+
 /**
  * Scales down high resolution angle to single integer.
  *
@@ -133,7 +185,7 @@ int32_t pbio_angle_to_low_res(const pbio_angle_t *a, int32_t scale) {
     }
 
     // Scale down rotations component. NB: Truncates, does not round.
-    int32_t rotations_component = pbio_int_math_mult_then_div(a->rotations, MDEG_PER_ROT, scale);
+    int32_t rotations_component = a->rotations == 0 ? 0 : pbio_angle_rotations_to_low_res(a->rotations, scale);
 
     // Scale down millidegree component, rounded to nearest ouput unit.
     int32_t millidegree_component = (a->millidegrees + pbio_int_math_sign(a->millidegrees) * scale / 2) / scale;
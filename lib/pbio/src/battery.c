@@ -9,26 +9,316 @@
 #if PBIO_CONFIG_BATTERY
 
 #include <inttypes.h>
+#include <stdbool.h>
 
 #include <pbdrv/battery.h>
+#include <pbdrv/charger.h>
 #include <pbio/battery.h>
 #include <pbio/int_math.h>
 #include <pbio/os.h>
 
-// Slow moving average battery voltage.
+// Slow moving average battery voltage, scaled by SCALE.
 static int32_t battery_voltage_avg_scaled;
 
 // The average battery value is scaled up numerically
 // to reduce rounding errors in the moving average.
 #define SCALE (1024)
 
+// Slow moving average battery voltage in mV.
+static int32_t battery_voltage_avg;
+
+// Estimated voltage available to the motors right now in mV. Without a
+// current measurement, this is the moving average.
+static int32_t battery_voltage_supply;
+
+// Duty cycle per mV at the supply voltage, scaled up by 2^DUTY_SHIFT. This
+// is updated along with the supply voltage, so converting voltages for each
+// motor on each control loop takes only a multiplication.
+static int32_t battery_duty_per_mv_scaled;
+
+// Voltage in mV per duty cycle at the supply voltage, scaled up by
+// 2^DUTY_SHIFT, so that the inverse conversion needs no division either.
+static int32_t battery_mv_per_duty_scaled;
+
+#define DUTY_SHIFT (16)
+
+// Load-aware battery model, used if the hub measures the battery current.
+// The battery is an open circuit voltage in series with an internal
+// resistance, so the supply voltage drops by the resistance times the
+// current. The open circuit voltage changes slowly, so it can be averaged
+// like the plain voltage without lagging behind the load.
+static struct {
+    /** Moving average of the voltage, scaled by 2^MODEL_SHIFT. */
+    int64_t v;
+    /** Moving average of the current, scaled by 2^MODEL_SHIFT. */
+    int64_t i;
+    /** Moving average of the current squared, scaled by 2^MODEL_SHIFT. */
+    int64_t ii;
+    /** Moving average of the voltage times the current, scaled by 2^MODEL_SHIFT. */
+    int64_t vi;
+    /** Short moving average of the current in mA, to reduce noise. */
+    int32_t current;
+    /** Estimated internal resistance in mOhm. */
+    int32_t resistance;
+    /** Estimated open circuit voltage in mV. */
+    int32_t voltage_open_circuit;
+    /** Whether the averages have been initialized. */
+    bool valid;
+} model;
+
+#define MODEL_SHIFT (8)
+
+// The resistance is only estimated when the current varies by at least this
+// much (mA), since the estimate is too noisy otherwise.
+#define MODEL_CURRENT_DEVIATION_MIN (100)
+
+// Upper bound of the resistance estimate in mOhm.
+#define MODEL_RESISTANCE_MAX (2000)
+
+// Charge accounting, used if the hub measures the battery current. Charge is
+// counted in mA * ms, which is 1/3600 uAh.
+static struct {
+    /** Net charge drawn from the battery since boot. */
+    int64_t charge;
+    /** Charge at the start of the most recent program. */
+    int64_t program_start;
+    /** Charge at the end of the most recent program. */
+    int64_t program_end;
+    /** Open circuit voltage in mV at the start of the current discharge. */
+    int32_t reference_voltage;
+    /** Charge at the start of the current discharge. */
+    int64_t reference_charge;
+    /** Slow moving average of the net current in mA, scaled by 2^ENERGY_SHIFT. */
+    int32_t current_avg_scaled;
+    /** Whether a program is running. */
+    bool program_running;
+    /** Whether the battery current is measured. */
+    bool valid;
+} energy;
+
+// The average current used for runtime estimates settles in about
+// 2^ENERGY_SHIFT battery updates, or about 20 seconds.
+#define ENERGY_SHIFT (12)
+
+// The remaining runtime is extrapolated only after the open circuit voltage
+// has dropped by at least this much (mV) ...
+#define ENERGY_VOLTAGE_DROP_MIN (50)
+
+// ... while drawing at least this much charge (10 mAh).
+#define ENERGY_CHARGE_MIN (10 * 3600 * 1000)
+
+/**
+ * Sets the supply voltage and the values derived from it.
+ *
+ * @param [in]  voltage     The supply voltage in mV.
+ */
+static void pbio_battery_set_supply(int32_t voltage) {
+    battery_voltage_supply = voltage > 0 ? voltage : 0;
+
+    // Rounded up, so that exact fractions of the battery voltage give exact
+    // duty cycles after the result is truncated.
+    battery_duty_per_mv_scaled = battery_voltage_supply > 0 ?
+        ((PBIO_BATTERY_MAX_DUTY << DUTY_SHIFT) + battery_voltage_supply - 1) / battery_voltage_supply : 0;
+    battery_mv_per_duty_scaled =
+        ((battery_voltage_supply << DUTY_SHIFT) + PBIO_BATTERY_MAX_DUTY - 1) / PBIO_BATTERY_MAX_DUTY;
+}
+
+/**
+ * Resets the battery model to a steady state.
+ *
+ * @param [in]  voltage     The voltage in mV.
+ * @param [in]  current     The current in mA.
+ */
+static void pbio_battery_model_reset(int32_t voltage, int32_t current) {
+    model.v = (int64_t)voltage << MODEL_SHIFT;
+    model.i = (int64_t)current << MODEL_SHIFT;
+    model.ii = ((int64_t)current * current) << MODEL_SHIFT;
+    model.vi = ((int64_t)voltage * current) << MODEL_SHIFT;
+    model.current = current;
+    model.voltage_open_circuit = voltage;
+    model.valid = true;
+}
+
+/**
+ * Updates the battery model with a new measurement.
+ *
+ * @param [in]  voltage     The voltage in mV.
+ * @param [in]  current     The current in mA.
+ * @return                  The estimated supply voltage in mV.
+ */
+static int32_t pbio_battery_model_update(int32_t voltage, int32_t current) {
+
+    // Same time constant as the plain average.
+    model.v += (((int64_t)voltage << MODEL_SHIFT) - model.v) / 128;
+    model.i += (((int64_t)current << MODEL_SHIFT) - model.i) / 128;
+    model.ii += ((((int64_t)current * current) << MODEL_SHIFT) - model.ii) / 128;
+    model.vi += ((((int64_t)voltage * current) << MODEL_SHIFT) - model.vi) / 128;
+    model.current = (model.current + current) / 2;
+
+    // The resistance is the slope of the voltage versus the current, which is
+    // their covariance divided by the variance of the current. Both are
+    // scaled by 2^(2 * MODEL_SHIFT) here.
+    int64_t covariance = model.vi * (1 << MODEL_SHIFT) - model.v * model.i;
+    int64_t variance = model.ii * (1 << MODEL_SHIFT) - model.i * model.i;
+    if (variance > ((int64_t)MODEL_CURRENT_DEVIATION_MIN * MODEL_CURRENT_DEVIATION_MIN) << (2 * MODEL_SHIFT)) {
+        int64_t resistance = -covariance * 1000 / variance;
+        model.resistance = resistance < 0 ? 0 : (resistance > MODEL_RESISTANCE_MAX ? MODEL_RESISTANCE_MAX : resistance);
+    }
+
+    model.voltage_open_circuit = (model.v + model.i * model.resistance / 1000) >> MODEL_SHIFT;
+    return model.voltage_open_circuit - model.current * model.resistance / 1000;
+}
+
+/**
+ * Counts the charge drawn from the battery since the previous update.
+ *
+ * @param [in]  current     The battery current in mA.
+ */
+static void pbio_battery_energy_update(int32_t current) {
+
+    // The charger current goes into the battery, so it is subtracted.
+    uint16_t charger_current;
+    if (pbdrv_charger_get_current_now(&charger_current) == PBIO_SUCCESS) {
+        current -= charger_current;
+    }
+
+    if (!energy.valid) {
+        energy.current_avg_scaled = current * (1 << ENERGY_SHIFT);
+        energy.valid = true;
+    }
+
+    energy.charge += current * PBIO_CONFIG_CONTROL_LOOP_TIME_MS;
+    energy.current_avg_scaled += (current * (1 << ENERGY_SHIFT) - energy.current_avg_scaled) / (1 << ENERGY_SHIFT);
+
+    // Runtime is extrapolated from the voltage drop since the battery was
+    // last charged, so start over when it charges.
+    if (current <= 0 || energy.reference_voltage == 0) {
+        energy.reference_voltage = model.voltage_open_circuit;
+        energy.reference_charge = energy.charge;
+    }
+}
+
+/**
+ * Updates the battery state with a new measurement.
+ */
+static void pbio_battery_update(void) {
+
+    uint16_t voltage_mv;
+    pbdrv_battery_get_voltage_now(&voltage_mv);
+    // Returned error is ignored.
+
+    // Update moving average.
+    battery_voltage_avg_scaled = (battery_voltage_avg_scaled * 127 + ((int32_t)voltage_mv) * SCALE) / 128;
+    battery_voltage_avg = battery_voltage_avg_scaled / SCALE;
+
+    uint16_t current_ma;
+    if (pbdrv_battery_get_current_now(&current_ma) != PBIO_SUCCESS) {
+        pbio_battery_set_supply(battery_voltage_avg);
+        return;
+    }
+    if (!model.valid) {
+        pbio_battery_model_reset(voltage_mv, current_ma);
+    }
+    pbio_battery_set_supply(pbio_battery_model_update(voltage_mv, current_ma));
+    pbio_battery_energy_update(current_ma);
+}
+
 /**
  * Gets the moving average battery voltage.
  *
  * @return                  The voltage in mV.
  */
 int32_t pbio_battery_get_average_voltage(void) {
-    return battery_voltage_avg_scaled / SCALE;
+    return battery_voltage_avg;
+}
+
+/**
+ * Gets the estimated voltage available to the motors right now.
+ *
+ * On hubs that measure the battery current, this accounts for the voltage
+ * drop over the internal resistance of the battery at the present load.
+ * Otherwise it is the same as ::pbio_battery_get_average_voltage.
+ *
+ * @return                  The voltage in mV.
+ */
+int32_t pbio_battery_get_supply_voltage(void) {
+    return battery_voltage_supply;
+}
+
+/**
+ * Gets the estimated internal resistance of the battery.
+ *
+ * @return                  The resistance in mOhm, or 0 if not known.
+ */
+int32_t pbio_battery_get_internal_resistance(void) {
+    return model.resistance;
+}
+
+/**
+ * Marks the start or end of a program, for counting its charge use.
+ *
+ * @param [in]  running     Whether the program is starting.
+ */
+void pbio_battery_set_program_running(bool running) {
+    if (running) {
+        energy.program_start = energy.charge;
+    } else {
+        energy.program_end = energy.charge;
+    }
+    energy.program_running = running;
+}
+
+/**
+ * Gets the net charge drawn from the battery by the running program, or by
+ * the most recent program if none is running.
+ *
+ * @param [out] charge      The charge in uAh.
+ * @return                  ::PBIO_SUCCESS or ::PBIO_ERROR_NOT_SUPPORTED if
+ *                          the hub does not measure the battery current.
+ */
+pbio_error_t pbio_battery_get_program_charge(int32_t *charge) {
+    if (!energy.valid) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+    int64_t end = energy.program_running ? energy.charge : energy.program_end;
+    *charge = (end - energy.program_start) / 3600;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Estimates how long the battery lasts at the present load.
+ *
+ * The charge left is extrapolated from the charge drawn per mV of open
+ * circuit voltage drop since the battery was last charged. Dividing it by the
+ * recent average current gives the runtime.
+ *
+ * @param [in]  voltage_min The voltage in mV at which the battery is empty.
+ * @param [out] time        The remaining runtime in s.
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_AGAIN if there is
+ *                          not enough data yet or the battery is charging, or
+ *                          ::PBIO_ERROR_NOT_SUPPORTED if the hub does not
+ *                          measure the battery current.
+ */
+pbio_error_t pbio_battery_get_remaining_runtime(int32_t voltage_min, uint32_t *time) {
+    if (!energy.valid) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+
+    int32_t drop = energy.reference_voltage - model.voltage_open_circuit;
+    int64_t used = energy.charge - energy.reference_charge;
+    int32_t current = energy.current_avg_scaled >> ENERGY_SHIFT;
+    if (drop < ENERGY_VOLTAGE_DROP_MIN || used < ENERGY_CHARGE_MIN || current <= 0) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    int32_t left = model.voltage_open_circuit - voltage_min;
+    if (left <= 0) {
+        *time = 0;
+        return PBIO_SUCCESS;
+    }
+
+    *time = used * left / drop / current / 1000;
+    return PBIO_SUCCESS;
 }
 
 /**
@@ -40,10 +330,13 @@ int32_t pbio_battery_get_average_voltage(void) {
  *                          to positive ::PBIO_BATTERY_MAX_DUTY.
  */
 int32_t pbio_battery_get_duty_from_voltage(int32_t voltage) {
-    // Calculate unbounded duty cycle value.
-    int32_t duty_cycle = voltage * PBIO_BATTERY_MAX_DUTY / (battery_voltage_avg_scaled / SCALE);
+    // Anything at or above the battery voltage is full duty. This also keeps
+    // the product below within range.
+    if (pbio_int_math_abs(voltage) >= battery_voltage_supply) {
+        return pbio_int_math_sign(voltage) * PBIO_BATTERY_MAX_DUTY;
+    }
 
-    return pbio_int_math_clamp(duty_cycle, PBIO_BATTERY_MAX_DUTY);
+    return voltage * battery_duty_per_mv_scaled / (1 << DUTY_SHIFT);
 }
 
 /**
@@ -57,7 +350,7 @@ int32_t pbio_battery_get_duty_from_voltage(int32_t voltage) {
  */
 int32_t pbio_battery_get_voltage_from_duty(int32_t duty) {
     duty = pbio_int_math_clamp(duty, PBIO_BATTERY_MAX_DUTY);
-    return duty * (battery_voltage_avg_scaled / SCALE) / PBIO_BATTERY_MAX_DUTY;
+    return duty * battery_mv_per_duty_scaled / (1 << DUTY_SHIFT);
 }
 
 /**
@@ -70,7 +363,7 @@ int32_t pbio_battery_get_voltage_from_duty(int32_t duty) {
  */
 int32_t pbio_battery_get_voltage_from_duty_pct(int32_t duty) {
     duty = pbio_int_math_clamp(duty, 100);
-    return duty * (battery_voltage_avg_scaled / SCALE) / 100;
+    return pbio_battery_get_voltage_from_duty(duty * (PBIO_BATTERY_MAX_DUTY / 100));
 }
 
 static pbio_os_process_t pbio_battery_process;
@@ -85,14 +378,7 @@ static pbio_error_t pbio_battery_process_thread(pbio_os_state_t *state, void *co
 
     for (;;) {
         PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
-
-        uint16_t battery_voltage_now_mv;
-        pbdrv_battery_get_voltage_now(&battery_voltage_now_mv);
-        // Returned error is ignored.
-
-        // Update moving average.
-        battery_voltage_avg_scaled = (battery_voltage_avg_scaled * 127 + ((int32_t)battery_voltage_now_mv) * SCALE) / 128;
-
+        pbio_battery_update();
         pbio_os_timer_extend(&timer);
     }
 
@@ -112,6 +398,15 @@ void pbio_battery_init(void) {
 
     // Initialize average upscaled voltage.
     battery_voltage_avg_scaled = (int32_t)battery_voltage_now_mv * SCALE;
+    battery_voltage_avg = battery_voltage_now_mv;
+    pbio_battery_set_supply(battery_voltage_avg);
+
+    // The model starts from the first measurement with current.
+    model.valid = false;
+    model.resistance = 0;
+    model.voltage_open_circuit = battery_voltage_avg;
+    energy.valid = false;
+    energy.reference_voltage = 0;
 
     pbio_os_process_start(&pbio_battery_process, pbio_battery_process_thread, NULL);
 }
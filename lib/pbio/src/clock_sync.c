@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pbio/clock_sync.h>
+#include <pbio/int_math.h>
+
+/**
+ * Forgets everything about the remote clock.
+ *
+ * @param [in]  sync    The estimator.
+ */
+void pbio_clock_sync_reset(pbio_clock_sync_t *sync) {
+    memset(sync, 0, sizeof(*sync));
+}
+
+/**
+ * Tests if there is an estimate of the remote clock.
+ *
+ * @param [in]  sync    The estimator.
+ * @return              True if at least one timestamp was received.
+ */
+bool pbio_clock_sync_is_synced(const pbio_clock_sync_t *sync) {
+    return sync->num_points || sync->window_active;
+}
+
+/**
+ * Gets the estimated remote time minus local time.
+ *
+ * @param [in]  sync        The estimator.
+ * @param [in]  local_time  Local time in ms.
+ * @return                  Offset in ms, or 0 if there is no estimate yet.
+ */
+static int32_t pbio_clock_sync_get_offset(const pbio_clock_sync_t *sync, uint32_t local_time) {
+    if (!sync->num_points) {
+        return sync->window_active ? sync->window_best.offset : 0;
+    }
+    int32_t elapsed = local_time - sync->fit.time;
+    return sync->fit.offset + (int64_t)elapsed * sync->drift / 1000000;
+}
+
+/**
+ * Fits a line through the points with least squares to get the offset at the
+ * newest point and the drift.
+ *
+ * Times and offsets are taken relative to the newest point, so the sums
+ * stay small.
+ *
+ * @param [in]  sync    The estimator.
+ */
+static void pbio_clock_sync_update_fit(pbio_clock_sync_t *sync) {
+    const pbio_clock_sync_point_t *newest = &sync->points[(sync->next_point + PBIO_CLOCK_SYNC_NUM_POINTS - 1) % PBIO_CLOCK_SYNC_NUM_POINTS];
+
+    int64_t n = sync->num_points;
+    int64_t sum_x = 0;
+    int64_t sum_y = 0;
+    int64_t sum_xx = 0;
+    int64_t sum_xy = 0;
+    for (uint8_t i = 0; i < sync->num_points; i++) {
+        int32_t x = sync->points[i].time - newest->time;
+        int32_t y = sync->points[i].offset - newest->offset;
+        sum_x += x;
+        sum_y += y;
+        sum_xx += (int64_t)x * x;
+        sum_xy += (int64_t)x * y;
+    }
+
+    int64_t den = n * sum_xx - sum_x * sum_x;
+    sync->drift = den ? (n * sum_xy - sum_x * sum_y) * 1000000 / den : 0;
+    sync->fit.time = newest->time;
+    sync->fit.offset = newest->offset + (sum_y - sum_x * sync->drift / 1000000) / n;
+}
+
+/**
+ * Adds a timestamp received from the remote clock.
+ *
+ * Call this only for timestamps that were just taken by the remote, not
+ * for repeated copies of older ones.
+ *
+ * @param [in]  sync        The estimator.
+ * @param [in]  local_time  Local time at which the timestamp was received in ms.
+ * @param [in]  remote_time The received timestamp in ms.
+ */
+void pbio_clock_sync_add_sample(pbio_clock_sync_t *sync, uint32_t local_time, uint32_t remote_time) {
+
+    pbio_clock_sync_point_t sample = {
+        .time = local_time,
+        .offset = remote_time - local_time,
+    };
+
+    // Start over if the remote clock restarted or another hub took over.
+    if (pbio_clock_sync_is_synced(sync) &&
+        pbio_int_math_abs(sample.offset - pbio_clock_sync_get_offset(sync, local_time)) > PBIO_CLOCK_SYNC_MAX_JUMP_MS) {
+        pbio_clock_sync_reset(sync);
+    }
+
+    // Keep the timestamp with the shortest delay, which has the largest offset.
+    if (!sync->window_active) {
+        sync->window_active = true;
+        sync->window_start = local_time;
+        sync->window_best = sample;
+    } else if (sample.offset > sync->window_best.offset) {
+        sync->window_best = sample;
+    }
+
+    if (local_time - sync->window_start < PBIO_CLOCK_SYNC_WINDOW_MS) {
+        return;
+    }
+
+    // Window done, so add its fastest timestamp to the fit.
+    sync->points[sync->next_point] = sync->window_best;
+    sync->next_point = (sync->next_point + 1) % PBIO_CLOCK_SYNC_NUM_POINTS;
+    if (sync->num_points < PBIO_CLOCK_SYNC_NUM_POINTS) {
+        sync->num_points++;
+    }
+    sync->window_active = false;
+    pbio_clock_sync_update_fit(sync);
+}
+
+/**
+ * Gets the estimated remote time.
+ *
+ * @param [in]  sync        The estimator.
+ * @param [in]  local_time  Local time in ms.
+ * @return                  Estimated remote time in ms, or @p local_time if
+ *                          no timestamps were received yet.
+ */
+uint32_t pbio_clock_sync_get_remote_time(const pbio_clock_sync_t *sync, uint32_t local_time) {
+    return local_time + pbio_clock_sync_get_offset(sync, local_time);
+}
@@ -6,38 +6,65 @@
 #include <pbio/int_math.h>
 
 /**
- * Gets squared Euclidean distance between HSV colors mapped into a
- * chroma-lightness-bicone. The bicone is 20000 units tall and 20000 units in
- * diameter.
+ * Maps an HSV color into a chroma-lightness-bicone. The bicone is 20000 units
+ * tall and 20000 units in diameter.
  *
- * @param [in]  hsv_a    The first HSV color.
- * @param [in]  hsv_b    The second HSV color.
- * @returns              Squared distance (0 to 400000000).
+ * When comparing one color to many others, this can be used to compute the
+ * coordinates of each color only once.
+ *
+ * @param [in]  hsv      The HSV color.
+ * @param [out] bicone   The coordinates in the bicone.
  */
-int32_t pbio_color_get_distance_bicone_squared(const pbio_color_hsv_t *hsv_a, const pbio_color_hsv_t *hsv_b) {
+void pbio_color_hsv_to_bicone(const pbio_color_hsv_t *hsv, pbio_color_bicone_t *bicone) {
+
+    // Chroma (= radial coordinate in bicone) (0-10000).
+    int32_t radius = pbio_color_hsv_get_v(hsv) * hsv->s;
 
-    // Chroma (= radial coordinate in bicone) of a and b (0-10000).
-    int32_t radius_a = pbio_color_hsv_get_v(hsv_a) * hsv_a->s;
-    int32_t radius_b = pbio_color_hsv_get_v(hsv_b) * hsv_b->s;
+    // x and y coordinates, scaled by 10000 (-100000000, 100000000).
+    bicone->x = radius * pbio_int_math_cos_deg(hsv->h);
+    bicone->y = radius * pbio_int_math_sin_deg(hsv->h);
 
-    // Lightness (= z-coordinate in bicone) of a and b (0-20000).
+    // Lightness (= z-coordinate in bicone) (0-20000).
     // v is allowed to be negative, resulting in negative lightness.
     // This can be used to create a higher contrast between "none-color" and
     // normal colors.
-    int32_t lightness_a = (200 - hsv_a->s) * hsv_a->v;
-    int32_t lightness_b = (200 - hsv_b->s) * hsv_b->v;
+    bicone->z = (200 - hsv->s) * hsv->v;
+}
 
-    // z delta of a and b in HSV bicone (-20000, 20000).
-    int32_t delta_z = (lightness_b - lightness_a);
+/**
+ * Gets squared Euclidean distance between colors in the bicone.
+ *
+ * @param [in]  a        The first color.
+ * @param [in]  b        The second color.
+ * @returns              Squared distance (0 to 400000000).
+ */
+int32_t pbio_color_bicone_get_distance_squared(const pbio_color_bicone_t *a, const pbio_color_bicone_t *b) {
 
-    // x and y deltas of a and b in HSV bicone (-20000, 20000)
-    int32_t delta_x = (radius_b * pbio_int_math_cos_deg(hsv_b->h) - radius_a * pbio_int_math_cos_deg(hsv_a->h)) / 10000;
-    int32_t delta_y = (radius_b * pbio_int_math_sin_deg(hsv_b->h) - radius_a * pbio_int_math_sin_deg(hsv_a->h)) / 10000;
+    // x, y and z deltas of a and b in HSV bicone (-20000, 20000)
+    int32_t delta_x = (b->x - a->x) / 10000;
+    int32_t delta_y = (b->y - a->y) / 10000;
+    int32_t delta_z = b->z - a->z;
 
     // Squared Euclidean distance (0, 400000000)
     return delta_x * delta_x + delta_y * delta_y + delta_z * delta_z;
 }
 
+/**
+ * Gets squared Euclidean distance between HSV colors mapped into a
+ * chroma-lightness-bicone. The bicone is 20000 units tall and 20000 units in
+ * diameter.
+ *
+ * @param [in]  hsv_a    The first HSV color.
+ * @param [in]  hsv_b    The second HSV color.
+ * @returns              Squared distance (0 to 400000000).
+ */
+int32_t pbio_color_get_distance_bicone_squared(const pbio_color_hsv_t *hsv_a, const pbio_color_hsv_t *hsv_b) {
+    pbio_color_bicone_t a, b;
+    pbio_color_hsv_to_bicone(hsv_a, &a);
+    pbio_color_hsv_to_bicone(hsv_b, &b);
+    return pbio_color_bicone_get_distance_squared(&a, &b);
+}
+
 /**
  * Gets distance measure between a HSV color (a) and a fully or zero saturated
  * candidate color.
@@ -11,6 +11,7 @@
 
 #include <pbio/config.h>
 #include <pbio/control.h>
+#include <pbio/control_recorder.h>
 #include <pbio/int_math.h>
 #include <pbio/trajectory.h>
 #include <pbio/integrator.h>
@@ -173,6 +174,21 @@ void pbio_control_get_reference(pbio_control_t *ctl, uint32_t time_now, const pb
     }
 }
 
+/**
+ * Looks up the proportional gain for an error in a gain schedule.
+ *
+ * @param [in]  schedule      The gain schedule.
+ * @param [in]  error         The absolute error.
+ * @return                    The proportional gain.
+ */
+static int32_t pbio_control_kp_schedule_lookup(const pbio_control_kp_schedule_t *schedule, int32_t error) {
+    if (error <= schedule->start || schedule->band < 1) {
+        return schedule->kp[0];
+    }
+    uint32_t index = (uint32_t)(error - schedule->start) / schedule->band;
+    return schedule->kp[index < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE ? index : PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE - 1];
+}
+
 static int32_t pbio_control_get_pid_kp(const pbio_control_settings_t *settings, int32_t position_error, int32_t target_error, int32_t abs_command_speed) {
 
     // Reduced kp values are only needed for some motors under slow speed
@@ -181,49 +197,18 @@ static int32_t pbio_control_get_pid_kp(const pbio_control_settings_t *settings,
         return settings->pid_kp;
     }
 
-    // We only need a positive kp value, so work with absolute values
-    // throughout this function to make things easy to follow.
-    position_error = pbio_int_math_abs(position_error);
-    target_error = pbio_int_math_abs(target_error);
-
-    // Lowest kp value, used when steadily turning at slow speed.
-    const int32_t kp_low = settings->pid_kp * settings->pid_kp_low_pct / 100;
-
-    // Get equivalent kp value to produce a piece-wise affine (pwa) feedback in the
-    // position error. It grows slower at first, and then at the configured rate.
-    const int32_t kp_pwa = position_error <= settings->pid_kp_low_error_threshold ?
-        // For small errors, feedback is linear in low kp value.
-        kp_low :
-        // Above the threshold, feedback grows with the default gain.
-        settings->pid_kp - settings->pid_kp_low_error_threshold * (settings->pid_kp - kp_low) / position_error;
-
-    // Proportional control saturates where the error leads to maximum actuation.
-    // For errors any smaller than that,
-    const int32_t saturation_lower = pbio_control_settings_div_by_gain(settings->actuation_max, settings->pid_kp);
-
-    // Further away from the target, we can use the reduced value and still
-    // guarantee maximum actuation, to avoid getting stuck.
-    const int32_t saturation_upper = saturation_lower * 100 / settings->pid_kp_low_pct;
-
-    // Get the kp value as constrained by the condition to use maxium actuation
-    // close to the target to guarantee that we can always get there.
-    int32_t kp_target;
-    if (target_error < saturation_lower) {
-        kp_target = settings->pid_kp;
-    } else if (target_error > saturation_upper) {
-        kp_target = kp_low;
-    } else {
-        // In between, we gradually shift towards the higher value as we get
-        // closer to the final target to avoid a sudden transition.
-        kp_target = kp_low + settings->pid_kp *
-            (100 - settings->pid_kp_low_pct) * (saturation_upper - target_error) /
-            (saturation_upper - saturation_lower) / 100;
-    }
-
-    // The most constrained objective is obtained by taking the highest value.
-    return pbio_int_math_max(kp_pwa, kp_target);
+    // The gain is reduced for small position errors, but not so much that it
+    // can't reach maximum actuation close to the target. The schedules are
+    // generated when the settings change, so the most constrained objective
+    // is obtained by taking the highest value.
+    return pbio_int_math_max(
+        pbio_control_kp_schedule_lookup(&settings->kp_schedule_error, pbio_int_math_abs(position_error)),
+        pbio_control_kp_schedule_lookup(&settings->kp_schedule_target, pbio_int_math_abs(target_error)));
 }
 
+static void pbio_control_queue_start_next(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state);
+static void pbio_control_queue_clear(pbio_control_t *ctl);
+
 /**
  * Updates the PID controller state to calculate the next actuation step.
  *
@@ -236,7 +221,7 @@ static int32_t pbio_control_get_pid_kp(const pbio_control_settings_t *settings,
  * @param [inout] external_pause  Whether to force the controller to pause using external information (in), and
  *                                whether the controller still needs pausing according to its own state (out).
  */
-void pbio_control_update(
+PBIO_HOT void pbio_control_update(
     pbio_control_t *ctl,
     uint32_t time_now,
     const pbio_control_state_t *state,
@@ -245,6 +230,16 @@ void pbio_control_update(
     int32_t *control,
     bool *external_pause) {
 
+    // Once the current position trajectory reaches its end, continue with the
+    // next queued command, if any.
+    if (ctl->queue_size > 0 && pbio_control_type_is_position(ctl)) {
+        pbio_trajectory_reference_t ref_end;
+        pbio_trajectory_get_endpoint(&ctl->trajectory, &ref_end);
+        if (pbio_util_time_has_passed(pbio_control_get_ref_time(ctl, time_now), ref_end.time)) {
+            pbio_control_queue_start_next(ctl, time_now, state);
+        }
+    }
+
     // Get reference signals at the reference time point in the trajectory.
     // This compensates for any time we may have spent pausing when the motor was stalled.
     pbio_trajectory_get_reference(&ctl->trajectory, pbio_control_get_ref_time(ctl, time_now), ref);
@@ -345,6 +340,10 @@ void pbio_control_update(
     // Save (low-pass filtered) load for diagnostics
     ctl->pid_average = (ctl->pid_average * (100 - PBIO_CONFIG_CONTROL_LOOP_TIME_MS) + torque * PBIO_CONFIG_CONTROL_LOOP_TIME_MS) / 100;
 
+    // Status as determined in this update, for recording below. Stopping
+    // control may clear it.
+    pbio_control_status_flag_t status = ctl->status;
+
     // Decide actuation based on control status.
     if (// Not on target yet, so keep actuating.
         !pbio_control_status_test(ctl, PBIO_CONTROL_STATUS_COMPLETE) ||
@@ -376,6 +375,25 @@ void pbio_control_update(
         pbio_control_start_position_control_hold(ctl, time_now, target);
     }
 
+    // Optionally record control data of all controllers.
+    if (pbio_control_recorder_is_recording()) {
+        pbio_angle_t ref_position = ref->position;
+        pbio_angle_add_mdeg(&ref_position, position_error_used - position_error);
+        pbio_control_recorder_sample_t sample = {
+            .ctl = ctl,
+            .time = time_now,
+            .position_ref = pbio_control_settings_ctl_to_app_long(&ctl->settings, &ref_position),
+            .position_estimate = pbio_control_settings_ctl_to_app_long(&ctl->settings, &state->position_estimate),
+            .position_error = pbio_control_settings_ctl_to_app(&ctl->settings, position_error_used),
+            .speed_ref = pbio_control_settings_ctl_to_app(&ctl->settings, ref->speed),
+            .speed_estimate = pbio_control_settings_ctl_to_app(&ctl->settings, state->speed_estimate),
+            .actuation_value = *control,
+            .actuation = *actuation,
+            .status = status,
+        };
+        pbio_control_recorder_add(&sample);
+    }
+
     // Optionally log control data.
     if (pbio_logger_is_active(&ctl->log)) {
 
@@ -423,6 +441,8 @@ void pbio_control_update(
  */
 void pbio_control_stop(pbio_control_t *ctl) {
     ctl->type = PBIO_CONTROL_TYPE_NONE;
+    pbio_control_queue_clear(ctl);
+    ctl->track_active = false;
     pbio_control_status_set(ctl, PBIO_CONTROL_STATUS_COMPLETE, true);
     pbio_control_status_set(ctl, PBIO_CONTROL_STATUS_STALLED, false);
     ctl->pid_average = 0;
@@ -445,6 +465,9 @@ static void pbio_control_set_control_type(pbio_control_t *ctl, uint32_t time_now
         return;
     }
 
+    // Any new command ends tracking. The tracking command sets it again.
+    ctl->track_active = false;
+
     // Set on completion action for this maneuver.
     ctl->on_completion = on_completion;
 
@@ -584,6 +607,150 @@ static pbio_error_t _pbio_control_start_position_control(pbio_control_t *ctl, ui
     return PBIO_SUCCESS;
 }
 
+/**
+ * Checks whether a motion from @p start to @p middle continues in the same
+ * direction from @p middle to @p end.
+ */
+static bool pbio_control_continues_in_same_direction(const pbio_angle_t *start, const pbio_angle_t *middle, const pbio_angle_t *end) {
+    int32_t first = pbio_int_math_sign(pbio_angle_diff_mdeg(middle, start));
+    return first != 0 && first == pbio_int_math_sign(pbio_angle_diff_mdeg(end, middle));
+}
+
+/**
+ * Command queues shared by all controllers.
+ */
+static pbio_control_queued_command_t queue_pool[PBIO_CONFIG_CONTROL_QUEUE_NUM][PBIO_CONFIG_CONTROL_QUEUE_SIZE];
+
+/**
+ * Controller that last took each queue. The queue is free again once that
+ * controller no longer points to it.
+ */
+static pbio_control_t *queue_pool_owner[PBIO_CONFIG_CONTROL_QUEUE_NUM];
+
+/**
+ * Takes a free queue from the shared pool.
+ *
+ * @param [in]  ctl            The control instance that will use the queue.
+ * @return                     The queue, or NULL if all are in use.
+ */
+static pbio_control_queued_command_t *pbio_control_queue_alloc(pbio_control_t *ctl) {
+    for (uint8_t i = 0; i < PBIO_CONFIG_CONTROL_QUEUE_NUM; i++) {
+        if (!queue_pool_owner[i] || queue_pool_owner[i]->queue != queue_pool[i]) {
+            queue_pool_owner[i] = ctl;
+            return queue_pool[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Discards all queued commands and returns the queue to the shared pool.
+ *
+ * @param [in]  ctl            The control instance.
+ */
+static void pbio_control_queue_clear(pbio_control_t *ctl) {
+    ctl->queue_size = 0;
+    ctl->queue = NULL;
+}
+
+/**
+ * Starts the oldest queued command, continuing from the current reference.
+ *
+ * If it can't be started, the current trajectory just completes as usual.
+ *
+ * @param [in]  ctl            The control instance.
+ * @param [in]  time_now       The wall time (ticks).
+ * @param [in]  state          The current state of the system being controlled (control units).
+ */
+static void pbio_control_queue_start_next(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state) {
+    pbio_control_queued_command_t next = ctl->queue[0];
+    ctl->queue_size--;
+    for (uint8_t i = 0; i < ctl->queue_size; i++) {
+        ctl->queue[i] = ctl->queue[i + 1];
+    }
+    if (ctl->queue_size == 0) {
+        pbio_control_queue_clear(ctl);
+    }
+
+    // Control is active, so this branches off from the current reference
+    // without a pause. It must not be time-shifted, or it would jump back.
+    _pbio_control_start_position_control(ctl, time_now, state, &next.target, next.speed, next.on_completion, false);
+}
+
+/**
+ * Queues a position command to start as soon as the current one ends.
+ *
+ * If the queued command continues in the same direction as the command
+ * before it, that command is changed to keep going at its target speed
+ * instead of slowing down at its target. This way, multi-segment motions
+ * run continuously. Otherwise, the next command starts as soon as the
+ * previous one is at its target.
+ *
+ * If no position control is active, the command starts right away.
+ *
+ * @param [in]  ctl            The control instance.
+ * @param [in]  time_now       The wall time (ticks).
+ * @param [in]  state          The current state of the system being controlled (control units).
+ * @param [in]  position       The target position to run to (application units).
+ * @param [in]  speed          The top speed on the way to the target (application units). The sign is ignored. If zero, default speed is used.
+ * @param [in]  on_completion  What to do when reaching the target position.
+ * @return                     ::PBIO_ERROR_BUSY if the queue is full or no shared
+ *                             queue is free, otherwise the result of starting
+ *                             or planning the command.
+ */
+pbio_error_t pbio_control_queue_position_control(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t position, int32_t speed, pbio_control_on_completion_t on_completion) {
+
+    // Nothing to queue behind, so start now.
+    if (!pbio_control_type_is_position(ctl)) {
+        return pbio_control_start_position_control(ctl, time_now, state, position, speed, on_completion);
+    }
+
+    if (ctl->queue_size == PBIO_CONFIG_CONTROL_QUEUE_SIZE) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    if (!ctl->queue) {
+        ctl->queue = pbio_control_queue_alloc(ctl);
+        if (!ctl->queue) {
+            return PBIO_ERROR_BUSY;
+        }
+    }
+
+    pbio_control_queued_command_t *command = &ctl->queue[ctl->queue_size];
+    pbio_control_settings_app_to_ctl_long(&ctl->settings, position, &command->target);
+    command->speed = pbio_control_settings_app_to_ctl(&ctl->settings, speed);
+    command->on_completion = on_completion;
+
+    if (ctl->queue_size == 0) {
+        // The previous command is the current trajectory. If this command
+        // continues in the same direction, replan the current trajectory to
+        // keep going at speed when it reaches its target.
+        pbio_trajectory_reference_t ref_end;
+        pbio_trajectory_get_endpoint(&ctl->trajectory, &ref_end);
+        if (pbio_control_continues_in_same_direction(&ctl->trajectory.start.position, &ref_end.position, &command->target) &&
+            ctl->on_completion != PBIO_CONTROL_ON_COMPLETION_CONTINUE) {
+            pbio_error_t err = _pbio_control_start_position_control(ctl, time_now, state, &ref_end.position,
+                pbio_trajectory_get_abs_command_speed(&ctl->trajectory), PBIO_CONTROL_ON_COMPLETION_CONTINUE, false);
+            if (err != PBIO_SUCCESS) {
+                pbio_control_queue_clear(ctl);
+                return err;
+            }
+        }
+    } else {
+        // The previous command is still queued, so it can just be changed.
+        pbio_control_queued_command_t *previous = &ctl->queue[ctl->queue_size - 1];
+        pbio_trajectory_reference_t ref_end;
+        pbio_trajectory_get_endpoint(&ctl->trajectory, &ref_end);
+        const pbio_angle_t *previous_start = ctl->queue_size > 1 ? &ctl->queue[ctl->queue_size - 2].target : &ref_end.position;
+        if (pbio_control_continues_in_same_direction(previous_start, &previous->target, &command->target)) {
+            previous->on_completion = PBIO_CONTROL_ON_COMPLETION_CONTINUE;
+        }
+    }
+
+    ctl->queue_size++;
+    return PBIO_SUCCESS;
+}
+
 /**
  * Starts the controller to run to a given target position.
  *
@@ -599,6 +766,9 @@ static pbio_error_t _pbio_control_start_position_control(pbio_control_t *ctl, ui
  */
 pbio_error_t pbio_control_start_position_control(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t position, int32_t speed, pbio_control_on_completion_t on_completion) {
 
+    // A new command replaces any queued commands.
+    pbio_control_queue_clear(ctl);
+
     // Convert target position to control units.
     pbio_angle_t target;
     pbio_control_settings_app_to_ctl_long(&ctl->settings, position, &target);
@@ -626,6 +796,9 @@ pbio_error_t pbio_control_start_position_control(pbio_control_t *ctl, uint32_t t
  */
 pbio_error_t pbio_control_start_position_control_relative(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t distance, int32_t speed, pbio_control_on_completion_t on_completion, bool allow_trajectory_shift) {
 
+    // A new command replaces any queued commands.
+    pbio_control_queue_clear(ctl);
+
     // Convert distance to control units.
     pbio_angle_t increment;
     pbio_control_settings_app_to_ctl_long(&ctl->settings, (speed < 0 ? -distance : distance), &increment);
@@ -662,6 +835,46 @@ pbio_error_t pbio_control_start_position_control_relative(pbio_control_t *ctl, u
     return _pbio_control_start_position_control(ctl, time_now, state, &target, pbio_control_settings_app_to_ctl(&ctl->settings, speed), on_completion, allow_trajectory_shift);
 }
 
+/**
+ * Starts the controller to run by a given distance beyond the target of the
+ * ongoing position command.
+ *
+ * Unlike pbio_control_start_position_control_relative, this starts from the
+ * previous target instead of the current reference, so rounding errors don't
+ * accumulate when a motion is split into several commands. The new trajectory
+ * still branches off from the current reference, and it is never time-shifted
+ * so that it can be synchronized with other trajectories.
+ *
+ * If no position control is active, this is the same as a relative command.
+ *
+ * @param [in]  ctl            The control instance.
+ * @param [in]  time_now       The wall time (ticks).
+ * @param [in]  state          The current state of the system being controlled (control units).
+ * @param [in]  distance       The distance to run beyond the previous target (application units).
+ * @param [in]  speed          The top speed on the way to the target (application units). Negative speed flips the distance sign.
+ * @param [in]  on_completion  What to do when reaching the target position.
+ * @return                     Error code.
+ */
+pbio_error_t pbio_control_start_position_control_chained(pbio_control_t *ctl, uint32_t time_now, const pbio_control_state_t *state, int32_t distance, int32_t speed, pbio_control_on_completion_t on_completion) {
+
+    if (!pbio_control_type_is_position(ctl)) {
+        return pbio_control_start_position_control_relative(ctl, time_now, state, distance, speed, on_completion, false);
+    }
+
+    // A new command replaces any queued commands.
+    pbio_control_queue_clear(ctl);
+
+    pbio_angle_t increment;
+    pbio_control_settings_app_to_ctl_long(&ctl->settings, (speed < 0 ? -distance : distance), &increment);
+
+    pbio_trajectory_reference_t prev_end;
+    pbio_trajectory_get_endpoint(&ctl->trajectory, &prev_end);
+    pbio_angle_t target;
+    pbio_angle_sum(&prev_end.position, &increment, &target);
+
+    return _pbio_control_start_position_control(ctl, time_now, state, &target, pbio_control_settings_app_to_ctl(&ctl->settings, speed), on_completion, false);
+}
+
 /**
  * Starts the controller and holds at the given position.
  *
@@ -675,6 +888,9 @@ pbio_error_t pbio_control_start_position_control_relative(pbio_control_t *ctl, u
  */
 pbio_error_t pbio_control_start_position_control_hold(pbio_control_t *ctl, uint32_t time_now, int32_t position) {
 
+    // A new command replaces any queued commands.
+    pbio_control_queue_clear(ctl);
+
     // Compute new maneuver based on user argument, starting from the initial state
     pbio_trajectory_command_t command = {
         .time_start = pbio_control_get_ref_time(ctl, time_now),
@@ -693,6 +909,73 @@ pbio_error_t pbio_control_start_position_control_hold(pbio_control_t *ctl, uint3
     return PBIO_SUCCESS;
 }
 
+/**
+ * Longest time between tracking setpoints that are interpolated (ms).
+ */
+#define TRACK_INTERVAL_MAX_MS (100)
+
+/**
+ * Starts the controller to follow a stream of target positions.
+ *
+ * If the previous command was also tracking, the reference moves at constant
+ * speed from where it is now to the new target, arriving when the next
+ * target is expected, based on the time since the previous one. Targets given
+ * at a lower rate than the control loop are thus smoothly interpolated, and
+ * the speed of each segment serves as feed-forward. The integrators are not
+ * reset between targets.
+ *
+ * Otherwise, or if the targets are far apart in time or space, this holds the
+ * target right away, like pbio_control_start_position_control_hold().
+ *
+ * @param [in]  ctl             The control instance.
+ * @param [in]  time_now        The wall time (ticks).
+ * @param [in]  position        The target position (application units).
+ * @return                      Error code.
+ */
+pbio_error_t pbio_control_start_position_control_track(pbio_control_t *ctl, uint32_t time_now, int32_t position) {
+
+    uint32_t interval = time_now - ctl->track_time;
+    bool interpolate = ctl->track_active && interval > 0 && interval <= pbio_control_time_ms_to_ticks(TRACK_INTERVAL_MAX_MS);
+
+    ctl->track_time = time_now;
+
+    if (interpolate) {
+        // Start from the current reference so that it does not jump.
+        uint32_t time_ref = pbio_control_get_ref_time(ctl, time_now);
+        pbio_trajectory_reference_t ref;
+        pbio_trajectory_get_reference(&ctl->trajectory, time_ref, &ref);
+
+        pbio_trajectory_command_t command = {
+            .time_start = time_ref,
+            .position_start = ref.position,
+            .speed_start = ref.speed,
+            .duration = interval,
+        };
+        pbio_control_settings_app_to_ctl_long(&ctl->settings, position, &command.position_end);
+
+        // Take longer if needed to stay within the speed limit.
+        if (pbio_angle_diff_is_small(&command.position_end, &command.position_start)) {
+            int64_t distance = pbio_int_math_abs(pbio_angle_diff_mdeg(&command.position_end, &command.position_start));
+            uint32_t duration_min = distance * pbio_control_time_ms_to_ticks(1000) / ctl->settings.speed_max;
+            if (duration_min > command.duration) {
+                command.duration = duration_min;
+            }
+        }
+
+        if (pbio_trajectory_make_linear(&ctl->trajectory, &command) == PBIO_SUCCESS) {
+            pbio_control_queue_clear(ctl);
+            pbio_control_set_control_type(ctl, time_now, PBIO_CONTROL_TYPE_POSITION, PBIO_CONTROL_ON_COMPLETION_HOLD);
+            ctl->track_active = true;
+            return PBIO_SUCCESS;
+        }
+    }
+
+    // Start tracking by holding the first target.
+    pbio_error_t err = pbio_control_start_position_control_hold(ctl, time_now, position);
+    ctl->track_active = err == PBIO_SUCCESS;
+    return err;
+}
+
 /**
  * Starts the controller to run for a given amount of time.
  *
@@ -708,6 +991,9 @@ pbio_error_t pbio_control_start_timed_control(pbio_control_t *ctl, uint32_t time
 
     pbio_error_t err;
 
+    // A new command replaces any queued commands.
+    pbio_control_queue_clear(ctl);
+
     // For timed maneuvers, being "smart" by remembering the position endpoint
     // does nothing useful, so discard it to keep only the passive actuation type.
     on_completion = pbio_control_on_completion_discard_smart(on_completion);
@@ -872,5 +1158,5 @@ bool pbio_control_is_stalled(const pbio_control_t *ctl, uint32_t *stall_duration
  * @return                      True if the controller is done, false if not.
  */
 bool pbio_control_is_done(const pbio_control_t *ctl) {
-    return !pbio_control_is_active(ctl) || pbio_control_status_test(ctl, PBIO_CONTROL_STATUS_COMPLETE);
+    return !pbio_control_is_active(ctl) || (pbio_control_status_test(ctl, PBIO_CONTROL_STATUS_COMPLETE) && ctl->queue_size == 0);
 }
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <pbio/config.h>
+
+#if PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/control_recorder.h>
+#include <pbio/int_math.h>
+
+static struct {
+    /** Recent samples, oldest overwritten first. */
+    pbio_control_recorder_sample_t samples[PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES];
+    /** Number of samples recorded since starting. */
+    uint32_t count;
+    /** Events that trigger, as ::pbio_control_recorder_trigger_t bits. */
+    uint32_t triggers;
+    /** Position error that triggers, in application units. */
+    int32_t error_threshold;
+    /** Number of samples to record after the trigger. */
+    uint32_t num_samples_after_trigger;
+    /** Number of samples still to be recorded after the trigger. */
+    uint32_t num_samples_remaining;
+    /** Recorder state. */
+    pbio_control_recorder_state_t state;
+} recorder;
+
+/**
+ * Starts recording, discarding any previous recording.
+ *
+ * @param [in]  triggers                    Events that trigger, as
+ *                                          ::pbio_control_recorder_trigger_t
+ *                                          bits. Use 0 to trigger only with
+ *                                          ::pbio_control_recorder_trigger.
+ * @param [in]  error_threshold             Position error that triggers, in
+ *                                          application units.
+ * @param [in]  num_samples_after_trigger   Number of samples to record after
+ *                                          the trigger before stopping.
+ */
+void pbio_control_recorder_start(uint32_t triggers, int32_t error_threshold, uint32_t num_samples_after_trigger) {
+    recorder.count = 0;
+    recorder.triggers = triggers;
+    recorder.error_threshold = error_threshold;
+    recorder.num_samples_after_trigger = num_samples_after_trigger;
+    recorder.state = PBIO_CONTROL_RECORDER_STATE_ARMED;
+}
+
+static void pbio_control_recorder_set_triggered(void) {
+    recorder.num_samples_remaining = recorder.num_samples_after_trigger;
+    recorder.state = recorder.num_samples_remaining ?
+        PBIO_CONTROL_RECORDER_STATE_TRIGGERED : PBIO_CONTROL_RECORDER_STATE_DONE;
+}
+
+/**
+ * Triggers the recorder now, if it is armed.
+ */
+void pbio_control_recorder_trigger(void) {
+    if (recorder.state == PBIO_CONTROL_RECORDER_STATE_ARMED) {
+        pbio_control_recorder_set_triggered();
+    }
+}
+
+/**
+ * Stops recording without a trigger. Recorded samples are kept.
+ */
+void pbio_control_recorder_stop(void) {
+    recorder.state = PBIO_CONTROL_RECORDER_STATE_IDLE;
+}
+
+/**
+ * Gets the recorder state.
+ *
+ * @return                  The state.
+ */
+pbio_control_recorder_state_t pbio_control_recorder_get_state(void) {
+    return recorder.state;
+}
+
+/**
+ * Copies the most recent samples, oldest first.
+ *
+ * @param [out] samples     Buffer for the samples.
+ * @param [in]  max_samples Number of samples that fit in the buffer.
+ * @return                  Number of samples copied.
+ */
+uint32_t pbio_control_recorder_get_samples(pbio_control_recorder_sample_t *samples, uint32_t max_samples) {
+    uint32_t available = recorder.count < PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES ? recorder.count : PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES;
+    uint32_t num_samples = available < max_samples ? available : max_samples;
+
+    for (uint32_t i = 0; i < num_samples; i++) {
+        samples[i] = recorder.samples[(recorder.count - num_samples + i) % PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES];
+    }
+    return num_samples;
+}
+
+/**
+ * Adds the state of one controller, if recording.
+ *
+ * This is called by each controller on every update.
+ *
+ * @param [in]  sample      The controller state.
+ */
+void pbio_control_recorder_add(const pbio_control_recorder_sample_t *sample) {
+    if (!pbio_control_recorder_is_recording()) {
+        return;
+    }
+
+    recorder.samples[recorder.count++ % PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES] = *sample;
+
+    if (recorder.state == PBIO_CONTROL_RECORDER_STATE_TRIGGERED) {
+        if (--recorder.num_samples_remaining == 0) {
+            recorder.state = PBIO_CONTROL_RECORDER_STATE_DONE;
+        }
+        return;
+    }
+
+    if (((recorder.triggers & PBIO_CONTROL_RECORDER_TRIGGER_STALL) && (sample->status & PBIO_CONTROL_STATUS_STALLED)) ||
+        ((recorder.triggers & PBIO_CONTROL_RECORDER_TRIGGER_ERROR) && pbio_int_math_abs(sample->position_error) > recorder.error_threshold)) {
+        pbio_control_recorder_set_triggered();
+    }
+}
+
+#endif // PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
@@ -232,6 +232,7 @@ pbio_error_t pbio_control_settings_set_actuation_limit(pbio_control_settings_t *
         return PBIO_ERROR_INVALID_ARG;
     }
     s->actuation_max = pbio_control_settings_actuation_app_to_ctl(limit);
+    pbio_control_settings_update_kp_schedule(s);
     return PBIO_SUCCESS;
 }
 
@@ -302,6 +303,7 @@ pbio_error_t pbio_control_settings_set_pid(pbio_control_settings_t *s, int32_t p
     s->pid_kd = pid_kd;
     s->integral_deadzone = pbio_control_settings_app_to_ctl(s, integral_deadzone);
     s->integral_change_max = pbio_control_settings_app_to_ctl(s, integral_change_max);
+    pbio_control_settings_update_kp_schedule(s);
     return PBIO_SUCCESS;
 }
 
@@ -374,3 +376,113 @@ pbio_error_t pbio_control_settings_set_stall_tolerances(pbio_control_settings_t
     s->stall_time = pbio_control_time_ms_to_ticks(time);
     return PBIO_SUCCESS;
 }
+
+/**
+ * Fills a gain schedule with the same gain everywhere.
+ *
+ * @param [out] schedule      The schedule.
+ * @param [in]  kp            Proportional gain.
+ */
+static void pbio_control_settings_fill_kp_schedule(pbio_control_kp_schedule_t *schedule, int32_t kp) {
+    schedule->start = 0;
+    schedule->band = 0;
+    for (uint32_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        schedule->kp[i] = kp;
+    }
+}
+
+/**
+ * Generates the proportional gain schedules used at low speeds.
+ *
+ * This must be called whenever the gains, thresholds or actuation limit
+ * change, so that the controller needs only a table lookup on each update.
+ * Each band uses the gain at the start of the band.
+ *
+ * @param [in] s              Control settings structure to update.
+ */
+void pbio_control_settings_update_kp_schedule(pbio_control_settings_t *s) {
+
+    // Without reduction, use the default gain everywhere.
+    if (s->pid_kp_low_pct < 1 || s->pid_kp < 1) {
+        pbio_control_settings_fill_kp_schedule(&s->kp_schedule_error, s->pid_kp);
+        pbio_control_settings_fill_kp_schedule(&s->kp_schedule_target, s->pid_kp);
+        return;
+    }
+
+    // Lowest kp value, used when steadily turning at slow speed.
+    const int32_t kp_low = s->pid_kp * s->pid_kp_low_pct / 100;
+
+    // Equivalent kp value to produce a piece-wise affine feedback in the
+    // position error. It grows slower at first, and then at the configured
+    // rate. The bands span four times the threshold.
+    pbio_control_kp_schedule_t *schedule = &s->kp_schedule_error;
+    schedule->start = 0;
+    schedule->band = pbio_int_math_max(s->pid_kp_low_error_threshold * 4 / PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE, 1);
+    for (uint32_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        int32_t error = schedule->band * i;
+        schedule->kp[i] = error <= s->pid_kp_low_error_threshold ? kp_low :
+            s->pid_kp - pbio_int_math_mult_then_div(s->pid_kp_low_error_threshold, s->pid_kp - kp_low, error);
+    }
+
+    // Proportional control saturates where the error leads to maximum
+    // actuation. Further away from the target, we can use the reduced value
+    // and still guarantee maximum actuation, to avoid getting stuck. In
+    // between, we gradually shift towards the higher value as we get closer
+    // to the final target to avoid a sudden transition.
+    const int32_t saturation_lower = pbio_control_settings_div_by_gain(s->actuation_max, s->pid_kp);
+    const int32_t saturation_upper = saturation_lower * 100 / s->pid_kp_low_pct;
+    schedule = &s->kp_schedule_target;
+    const int32_t transition = pbio_int_math_max(saturation_upper - saturation_lower, 1);
+    schedule->start = saturation_lower;
+    schedule->band = pbio_int_math_max(transition / (PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE - 1), 1);
+    for (int32_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        int32_t remaining = transition - pbio_int_math_mult_then_div(transition, i, PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE - 1);
+        schedule->kp[i] = kp_low + pbio_int_math_mult_then_div(s->pid_kp - kp_low, remaining, transition);
+    }
+}
+
+/**
+ * Gets the proportional gain schedule by position error.
+ *
+ * @param [in]  s             Control settings structure from which to read.
+ * @param [out] band          Width of each error band in application units.
+ * @param [out] kp            ::PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE gains, one for each band.
+ */
+void pbio_control_settings_get_kp_schedule(const pbio_control_settings_t *s, int32_t *band, int32_t *kp) {
+    *band = pbio_control_settings_ctl_to_app(s, s->kp_schedule_error.band);
+    for (uint32_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        kp[i] = s->kp_schedule_error.kp[i];
+    }
+}
+
+/**
+ * Sets the proportional gain schedule by position error, used at low speeds.
+ *
+ * This replaces the generated schedule until the gains are changed again.
+ *
+ * @param [in] s              Control settings structure to write to.
+ * @param [in] band           Width of each error band in application units.
+ * @param [in] kp             ::PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE gains, one for each band.
+ * @return                    ::PBIO_SUCCESS on success
+ *                            ::PBIO_ERROR_INVALID_ARG if any argument is out of range.
+ */
+pbio_error_t pbio_control_settings_set_kp_schedule(pbio_control_settings_t *s, int32_t band, const int32_t *kp) {
+    pbio_error_t err = pbio_control_settings_validate_position_setting(s, band);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    if (band < 1) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    for (uint32_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        if (kp[i] < 0) {
+            return PBIO_ERROR_INVALID_ARG;
+        }
+    }
+    s->kp_schedule_error.start = 0;
+    s->kp_schedule_error.band = pbio_control_settings_app_to_ctl(s, band);
+    for (uint32_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        s->kp_schedule_error.kp[i] = kp[i];
+    }
+    return PBIO_SUCCESS;
+}
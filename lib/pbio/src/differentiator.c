@@ -14,6 +14,19 @@
 #include <pbio/int_math.h>
 #include <pbio/util.h>
 
+/**
+ * Wraps an index into the ring buffer.
+ */
+#define PBIO_DIFFERENTIATOR_WRAP(index) ((index) & (PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE - 1))
+
+/**
+ * Converts a sum of increments across a window to speed in mdeg/s.
+ */
+static int32_t pbio_differentiator_sum_to_speed(int32_t total, uint16_t window_size) {
+    // Each sample has units of mdeg, so take average and convert to mdeg/s.
+    return total * (1000 / PBIO_CONFIG_CONTROL_LOOP_TIME_MS) / window_size;
+}
+
 /**
  * Internal function to get the speed with a variable window size. Window
  * size must be validated externally for this function to be used safely.
@@ -22,17 +35,20 @@
  * @param [in]  window_size    Window size in number of samples (Must be > 0 and <= buffer size!).
  * @param [out] speed          Average speed across given time window in mdeg/s.
  */
-static int32_t pbio_differentiator_calc_speed(pbio_differentiator_t *dif, uint8_t window_size) {
+static int32_t pbio_differentiator_calc_speed(pbio_differentiator_t *dif, uint16_t window_size) {
+
+    // The default window is kept up to date on each update.
+    if (window_size == PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE) {
+        return pbio_differentiator_sum_to_speed(dif->window_sum, window_size);
+    }
 
     // Sum differences including start and endpoint.
-    uint8_t start_index = (dif->index - (window_size - 1) + PBIO_ARRAY_SIZE(dif->history)) % PBIO_ARRAY_SIZE(dif->history);
+    uint16_t start_index = PBIO_DIFFERENTIATOR_WRAP(dif->index - (window_size - 1));
     int32_t total = dif->history[dif->index];
-    for (uint8_t i = start_index; i != dif->index; i = (i + 1) % PBIO_ARRAY_SIZE(dif->history)) {
+    for (uint16_t i = start_index; i != dif->index; i = PBIO_DIFFERENTIATOR_WRAP(i + 1)) {
         total += dif->history[i];
     }
-
-    // Each sample has units of mdeg, so take average and convert to mdeg/s.
-    return total * (1000 / PBIO_CONFIG_CONTROL_LOOP_TIME_MS) / window_size;
+    return pbio_differentiator_sum_to_speed(total, window_size);
 }
 
 /**
@@ -45,16 +61,23 @@ static int32_t pbio_differentiator_calc_speed(pbio_differentiator_t *dif, uint8_
 int32_t pbio_differentiator_update_and_get_speed(pbio_differentiator_t *dif, const pbio_angle_t *angle) {
 
     // Increment index where latest difference will be stored.
-    dif->index = (dif->index + 1) % PBIO_ARRAY_SIZE(dif->history);
+    dif->index = PBIO_DIFFERENTIATOR_WRAP(dif->index + 1);
 
     // The difference is stored in millidegrees. Even at 6000 deg/s (well
     // above the physical limits of the motors we use), this at most
-    // 6000 * 1000 * 0.005 = 30000, which fits in a 16-bit signed integer.
+    // 6000 * 1000 * 0.005 = 30000 with the default loop time, which fits in
+    // a 16-bit signed integer. It is less for faster control loops.
     dif->history[dif->index] = pbio_int_math_clamp(pbio_angle_diff_mdeg(angle, &dif->prev_angle), INT16_MAX);
     dif->prev_angle = *angle;
 
+    // Add the new difference to the window sum and drop the one that just
+    // left the window. The buffer is bigger than the window, so that one
+    // has not been overwritten yet.
+    dif->window_sum += dif->history[dif->index] -
+        dif->history[PBIO_DIFFERENTIATOR_WRAP(dif->index - PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE)];
+
     // Calculate the speed.
-    return pbio_differentiator_calc_speed(dif, PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE);
+    return pbio_differentiator_sum_to_speed(dif->window_sum, PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE);
 }
 
 /**
@@ -69,7 +92,7 @@ int32_t pbio_differentiator_update_and_get_speed(pbio_differentiator_t *dif, con
 pbio_error_t pbio_differentiator_get_speed(pbio_differentiator_t *dif, uint32_t window, int32_t *speed) {
 
     // Round window to nearest sample size.
-    uint8_t window_size = (window + PBIO_CONFIG_CONTROL_LOOP_TIME_MS / 2) / PBIO_CONFIG_CONTROL_LOOP_TIME_MS;
+    uint32_t window_size = (window + PBIO_CONFIG_CONTROL_LOOP_TIME_MS / 2) / PBIO_CONFIG_CONTROL_LOOP_TIME_MS;
     if (window_size == 0 || window_size > PBIO_ARRAY_SIZE(dif->history) - 1) {
         return PBIO_ERROR_INVALID_ARG;
     }
@@ -87,7 +110,8 @@ pbio_error_t pbio_differentiator_get_speed(pbio_differentiator_t *dif, uint32_t
  */
 void pbio_differentiator_reset(pbio_differentiator_t *dif, const pbio_angle_t *angle) {
     dif->prev_angle = *angle;
-    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(dif->history); i++) {
+    dif->window_sum = 0;
+    for (uint16_t i = 0; i < PBIO_ARRAY_SIZE(dif->history); i++) {
         dif->history[i] = 0;
     }
 }
@@ -4,20 +4,47 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // Copyright (c) 2020-2023 LEGO System A/S
 
+#include <math.h>
 #include <stdlib.h>
 
 #include <pbdrv/clock.h>
 #include <pbio/error.h>
 #include <pbio/drivebase.h>
+#include <pbio/geometry.h>
 #include <pbio/int_math.h>
 #include <pbio/imu.h>
 #include <pbio/servo.h>
+#include <pbio/util.h>
 
 #if PBIO_CONFIG_NUM_DRIVEBASES > 0
 
 // Drivebase objects
 static pbio_drivebase_t drivebases[PBIO_CONFIG_NUM_DRIVEBASES];
 
+/**
+ * Gets a drivebase instance by index.
+ *
+ * @param [in]  index       The index of the drivebase.
+ * @return                  The drivebase instance or NULL if index is out of range.
+ */
+pbio_drivebase_t *pbio_drivebase_by_index(uint8_t index) {
+    if (index >= PBIO_CONFIG_NUM_DRIVEBASES) {
+        return NULL;
+    }
+    return &drivebases[index];
+}
+
+/**
+ * Gets one of the servos of a drivebase.
+ *
+ * @param [in]  db          The drivebase instance
+ * @param [in]  index       Index of the servo, first all on the left, then all on the right.
+ * @return                  The servo.
+ */
+static pbio_servo_t *pbio_drivebase_get_servo(const pbio_drivebase_t *db, uint8_t index) {
+    return index < db->motors_per_side ? db->left[index] : db->right[index - db->motors_per_side];
+}
+
 /**
  * Gets the state of the drivebase update loop.
  *
@@ -30,17 +57,24 @@ static pbio_drivebase_t drivebases[PBIO_CONFIG_NUM_DRIVEBASES];
 bool pbio_drivebase_update_loop_is_running(pbio_drivebase_t *db) {
 
     // Drivebase must have servos.
-    if (!db->left || !db->right) {
+    if (db->motors_per_side == 0) {
         return false;
     }
 
-    // Drivebase must be the parent of its two servos.
-    if (!pbio_parent_equals(&db->left->parent, db) || !pbio_parent_equals(&db->right->parent, db)) {
-        return false;
-    }
+    for (uint8_t i = 0; i < db->motors_per_side * 2; i++) {
+        pbio_servo_t *srv = pbio_drivebase_get_servo(db, i);
 
-    // Both servo update loops must be running, since we want to read the servo observer state.
-    return pbio_servo_update_loop_is_running(db->left) && pbio_servo_update_loop_is_running(db->right);
+        // Drivebase must be the parent of all its servos.
+        if (!pbio_parent_equals(&srv->parent, db)) {
+            return false;
+        }
+
+        // All servo update loops must be running, since we want to read the servo observer state.
+        if (!pbio_servo_update_loop_is_running(srv)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 /**
@@ -98,6 +132,7 @@ static void drivebase_adopt_settings(pbio_control_settings_t *s_distance, pbio_c
         .integral_change_max = pbio_int_math_min(s_left->integral_change_max, s_right->integral_change_max),
         .smart_passive_hold_time = pbio_int_math_max(s_left->smart_passive_hold_time, s_right->smart_passive_hold_time),
     };
+    pbio_control_settings_update_kp_schedule(s_distance);
 
     // By default, heading control is the nearly same as distance control.
     *s_heading = *s_distance;
@@ -113,6 +148,47 @@ static void drivebase_adopt_settings(pbio_control_settings_t *s_distance, pbio_c
     s_heading->actuation_max = s_distance->actuation_max * 2;
 }
 
+/**
+ * Gets the average physical and estimated state of the servos on one side.
+ *
+ * The servos on one side turn together, so the differences between them
+ * are small. They are averaged relative to the first servo.
+ *
+ * @param [in]  servos          The servos on this side.
+ * @param [in]  num_servos      Number of servos on this side.
+ * @param [out] state           Average state of the servos.
+ * @return                      Error code.
+ */
+static pbio_error_t pbio_drivebase_get_state_side(pbio_servo_t *const *servos, uint8_t num_servos, pbio_control_state_t *state) {
+
+    pbio_error_t err = pbio_servo_get_state_control(servos[0], state);
+    if (err != PBIO_SUCCESS || num_servos == 1) {
+        return err;
+    }
+
+    int32_t position_diff = 0;
+    int32_t position_estimate_diff = 0;
+    int32_t speed_sum = state->speed;
+    int32_t speed_estimate_sum = state->speed_estimate;
+    for (uint8_t i = 1; i < num_servos; i++) {
+        pbio_control_state_t state_other;
+        err = pbio_servo_get_state_control(servos[i], &state_other);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+        position_diff += pbio_angle_diff_mdeg(&state_other.position, &state->position);
+        position_estimate_diff += pbio_angle_diff_mdeg(&state_other.position_estimate, &state->position_estimate);
+        speed_sum += state_other.speed;
+        speed_estimate_sum += state_other.speed_estimate;
+    }
+
+    pbio_angle_add_mdeg(&state->position, position_diff / num_servos);
+    pbio_angle_add_mdeg(&state->position_estimate, position_estimate_diff / num_servos);
+    state->speed = speed_sum / num_servos;
+    state->speed_estimate = speed_estimate_sum / num_servos;
+    return PBIO_SUCCESS;
+}
+
 /**
  * Get the physical and estimated state of a drivebase in units of control.
  *
@@ -123,16 +199,16 @@ static void drivebase_adopt_settings(pbio_control_settings_t *s_distance, pbio_c
  */
 static pbio_error_t pbio_drivebase_get_state_via_motors(pbio_drivebase_t *db, pbio_control_state_t *state_distance, pbio_control_state_t *state_heading) {
 
-    // Get left servo state
+    // Get left side state
     pbio_control_state_t state_left;
-    pbio_error_t err = pbio_servo_get_state_control(db->left, &state_left);
+    pbio_error_t err = pbio_drivebase_get_state_side(db->left, db->motors_per_side, &state_left);
     if (err != PBIO_SUCCESS) {
         return err;
     }
 
-    // Get right servo state
+    // Get right side state
     pbio_control_state_t state_right;
-    err = pbio_servo_get_state_control(db->right, &state_right);
+    err = pbio_drivebase_get_state_side(db->right, db->motors_per_side, &state_right);
     if (err != PBIO_SUCCESS) {
         return err;
     }
@@ -202,6 +278,7 @@ static void pbio_drivebase_stop_drivebase_control(pbio_drivebase_t *db) {
     pbio_control_stop(&db->control_distance);
     pbio_control_stop(&db->control_heading);
     db->control_paused = false;
+    db->path_size = 0;
 }
 
 /**
@@ -213,8 +290,9 @@ static void pbio_drivebase_stop_drivebase_control(pbio_drivebase_t *db) {
  */
 static void pbio_drivebase_stop_servo_control(pbio_drivebase_t *db) {
     // Stop servo control so polling will stop
-    pbio_control_stop(&db->left->control);
-    pbio_control_stop(&db->right->control);
+    for (uint8_t i = 0; i < db->motors_per_side * 2; i++) {
+        pbio_control_stop(&pbio_drivebase_get_servo(db, i)->control);
+    }
 }
 
 /**
@@ -254,14 +332,16 @@ static pbio_error_t pbio_drivebase_stop_from_servo(void *drivebase, bool clear_p
     // Stop the drive base controller so the motors don't start moving again.
     pbio_drivebase_stop_drivebase_control(db);
 
-    // Since we don't know which child called the parent to stop, we stop both
+    // Since we don't know which child called the parent to stop, we stop all
     // motors. We don't stop their parents to avoid escalating the stop calls
     // up the chain (and back here) once again.
-    pbio_error_t err = pbio_dcmotor_coast(db->left->dcmotor);
-    if (err != PBIO_SUCCESS) {
-        return err;
+    for (uint8_t i = 0; i < db->motors_per_side * 2; i++) {
+        pbio_error_t err = pbio_dcmotor_coast(pbio_drivebase_get_servo(db, i)->dcmotor);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
     }
-    return pbio_dcmotor_coast(db->right->dcmotor);
+    return PBIO_SUCCESS;
 }
 
 #define ROT_MDEG_OVER_PI (114592) // 360 000 / pi
@@ -277,22 +357,53 @@ static pbio_error_t pbio_drivebase_stop_from_servo(void *drivebase, bool clear_p
  * @return                       Error code.
  */
 pbio_error_t pbio_drivebase_get_drivebase(pbio_drivebase_t **db_address, pbio_servo_t *left, pbio_servo_t *right, int32_t wheel_diameter, int32_t axle_track) {
+    return pbio_drivebase_get_drivebase_multi(db_address, &left, &right, 1, wheel_diameter, axle_track);
+}
 
-    // Can't build a drive base with just one motor.
-    if (left == right) {
+/**
+ * Gets and sets up drivebase instance from one or more servos on each side.
+ *
+ * All servos on one side get the same feedback torque. The settings are
+ * adopted from the first servo on each side.
+ *
+ * @param [out] db_address       Drivebase instance if available.
+ * @param [in]  left             Left servo instances.
+ * @param [in]  right            Right servo instances.
+ * @param [in]  motors_per_side  Number of servos on each side.
+ * @param [in]  wheel_diameter   Wheel diameter in um.
+ * @param [in]  axle_track       Distance between wheel-ground contact points in um.
+ * @return                       Error code.
+ */
+pbio_error_t pbio_drivebase_get_drivebase_multi(pbio_drivebase_t **db_address, pbio_servo_t **left, pbio_servo_t **right, uint8_t motors_per_side, int32_t wheel_diameter, int32_t axle_track) {
+
+    if (motors_per_side < 1 || motors_per_side > PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE) {
         return PBIO_ERROR_INVALID_ARG;
     }
 
-    // Assert that both motors have the same gearing
-    if (left->control.settings.ctl_steps_per_app_step != right->control.settings.ctl_steps_per_app_step) {
-        return PBIO_ERROR_INVALID_ARG;
+    for (uint8_t i = 0; i < motors_per_side * 2; i++) {
+        pbio_servo_t *srv = i < motors_per_side ? left[i] : right[i - motors_per_side];
+
+        // Can't use the same motor twice.
+        for (uint8_t j = 0; j < i; j++) {
+            if (srv == (j < motors_per_side ? left[j] : right[j - motors_per_side])) {
+                return PBIO_ERROR_INVALID_ARG;
+            }
+        }
+
+        // Assert that all motors have the same gearing
+        if (srv->control.settings.ctl_steps_per_app_step != left[0]->control.settings.ctl_steps_per_app_step) {
+            return PBIO_ERROR_INVALID_ARG;
+        }
     }
 
     // Check if the servos already have parents.
-    if (pbio_parent_exists(&left->parent) || pbio_parent_exists(&right->parent)) {
-        // If a servo is already in use by a higher level
-        // abstraction like a drivebase, we can't re-use it.
-        return PBIO_ERROR_BUSY;
+    for (uint8_t i = 0; i < motors_per_side * 2; i++) {
+        pbio_servo_t *srv = i < motors_per_side ? left[i] : right[i - motors_per_side];
+        if (pbio_parent_exists(&srv->parent)) {
+            // If a servo is already in use by a higher level
+            // abstraction like a drivebase, we can't re-use it.
+            return PBIO_ERROR_BUSY;
+        }
     }
 
     // Now we know that the servos are free, there must be an available
@@ -315,12 +426,16 @@ pbio_error_t pbio_drivebase_get_drivebase(pbio_drivebase_t **db_address, pbio_se
     *db_address = db;
 
     // Attach servos
-    db->left = left;
-    db->right = right;
+    db->motors_per_side = motors_per_side;
+    for (uint8_t i = 0; i < motors_per_side; i++) {
+        db->left[i] = left[i];
+        db->right[i] = right[i];
+    }
 
-    // Set parents of both servos, so they can stop this drivebase.
-    pbio_parent_set(&left->parent, db, pbio_drivebase_stop_from_servo);
-    pbio_parent_set(&right->parent, db, pbio_drivebase_stop_from_servo);
+    // Set parents of all servos, so they can stop this drivebase.
+    for (uint8_t i = 0; i < motors_per_side * 2; i++) {
+        pbio_parent_set(&pbio_drivebase_get_servo(db, i)->parent, db, pbio_drivebase_stop_from_servo);
+    }
 
     // Stop any existing drivebase controls
     pbio_control_reset(&db->control_distance);
@@ -335,24 +450,24 @@ pbio_error_t pbio_drivebase_get_drivebase(pbio_drivebase_t **db_address, pbio_se
     }
 
     // Adopt settings as the average or sum of both servos, except scaling
-    drivebase_adopt_settings(&db->control_distance.settings, &db->control_heading.settings, &left->control.settings, &right->control.settings);
+    drivebase_adopt_settings(&db->control_distance.settings, &db->control_heading.settings, &left[0]->control.settings, &right[0]->control.settings);
 
     // Verify that the given dimensions are not too small or large to compute
     // a correct result for heading and distance control scale below.
     if (wheel_diameter < 1000 || axle_track < 1000 ||
-        left->control.settings.ctl_steps_per_app_step > INT32_MAX / ROT_MDEG_OVER_PI ||
-        left->control.settings.ctl_steps_per_app_step > INT32_MAX / axle_track
+        left[0]->control.settings.ctl_steps_per_app_step > INT32_MAX / ROT_MDEG_OVER_PI ||
+        left[0]->control.settings.ctl_steps_per_app_step > INT32_MAX / axle_track
         ) {
         return PBIO_ERROR_INVALID_ARG;
     }
 
     // Average rotation of the motors for every 1 degree drivebase rotation.
     db->control_heading.settings.ctl_steps_per_app_step =
-        left->control.settings.ctl_steps_per_app_step * axle_track / wheel_diameter;
+        left[0]->control.settings.ctl_steps_per_app_step * axle_track / wheel_diameter;
 
     // Average rotation of the motors for every 1 mm forward.
     db->control_distance.settings.ctl_steps_per_app_step =
-        left->control.settings.ctl_steps_per_app_step * ROT_MDEG_OVER_PI / wheel_diameter;
+        left[0]->control.settings.ctl_steps_per_app_step * ROT_MDEG_OVER_PI / wheel_diameter;
 
 
     // Verify that wheel diameter was not so large that scale is now zero.
@@ -395,6 +510,12 @@ pbio_error_t pbio_drivebase_set_use_gyro(pbio_drivebase_t *db, pbio_imu_heading_
     }
 
     db->gyro_heading_type = heading_type;
+
+    #if PBIO_CONFIG_DRIVEBASE_ODOMETRY
+    // Don't integrate the jump in heading source.
+    db->odometry_valid = false;
+    #endif
+
     return PBIO_SUCCESS;
 }
 
@@ -426,11 +547,13 @@ pbio_error_t pbio_drivebase_stop(pbio_drivebase_t *db, pbio_control_on_completio
     pbio_drivebase_stop_drivebase_control(db);
 
     // Stop the servos and pass on requested stop type.
-    pbio_error_t err = pbio_servo_stop(db->left, on_completion);
-    if (err != PBIO_SUCCESS) {
-        return err;
+    for (uint8_t i = 0; i < db->motors_per_side * 2; i++) {
+        pbio_error_t err = pbio_servo_stop(pbio_drivebase_get_servo(db, i), on_completion);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
     }
-    return pbio_servo_stop(db->right, on_completion);
+    return PBIO_SUCCESS;
 }
 
 /**
@@ -440,9 +563,132 @@ pbio_error_t pbio_drivebase_stop(pbio_drivebase_t *db, pbio_control_on_completio
  * @return                  True if still moving to target, false if not.
  */
 bool pbio_drivebase_is_done(const pbio_drivebase_t *db) {
-    return pbio_control_is_done(&db->control_distance) && pbio_control_is_done(&db->control_heading);
+    return pbio_control_is_done(&db->control_distance) && pbio_control_is_done(&db->control_heading) && db->path_index >= db->path_size;
+}
+
+/**
+ * Stretches the shortest of the two drive base trajectories to take as long
+ * as the longest, so that both end at the same time.
+ *
+ * @param [in]  db          The drivebase instance
+ */
+static void pbio_drivebase_synchronize_trajectories(pbio_drivebase_t *db) {
+
+    // First, find out which controller takes the lead
+    const pbio_control_t *control_leader;
+    pbio_control_t *control_follower;
+
+    if (pbio_trajectory_get_duration(&db->control_distance.trajectory) >
+        pbio_trajectory_get_duration(&db->control_heading.trajectory)) {
+        // Distance control takes the longest, so it will take the lead
+        control_leader = &db->control_distance;
+        control_follower = &db->control_heading;
+    } else {
+        // Heading control takes the longest, so it will take the lead
+        control_leader = &db->control_heading;
+        control_follower = &db->control_distance;
+    }
+
+    // Revise follower trajectory so it takes as long as the leader, achieved
+    // by picking a lower speed and accelerations that makes the times match.
+    pbio_trajectory_stretch(&control_follower->trajectory, &control_leader->trajectory);
+}
+
+/**
+ * Starts the next step of the ongoing path.
+ *
+ * The first step starts relative to the current reference or state, like any
+ * other relative command. Each next step starts from the targets of the
+ * previous step, so rounding errors don't accumulate along the path.
+ *
+ * @param [in]  db              The drivebase instance.
+ * @param [in]  time_now        The wall time (ticks).
+ * @param [in]  state_distance  The current distance state (control units).
+ * @param [in]  state_heading   The current heading state (control units).
+ * @return                      Error code.
+ */
+static pbio_error_t pbio_drivebase_path_start_step(pbio_drivebase_t *db, uint32_t time_now, const pbio_control_state_t *state_distance, const pbio_control_state_t *state_heading) {
+
+    const pbio_drivebase_path_step_t *step = &db->path[db->path_index];
+
+    pbio_error_t err;
+    if (db->path_index == 0) {
+        err = pbio_control_start_position_control_relative(&db->control_distance, time_now, state_distance, step->distance, 0, step->on_completion_distance, false);
+    } else {
+        err = pbio_control_start_position_control_chained(&db->control_distance, time_now, state_distance, step->distance, 0, step->on_completion_distance);
+    }
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    if (db->path_index == 0) {
+        err = pbio_control_start_position_control_relative(&db->control_heading, time_now, state_heading, step->angle, 0, step->on_completion_heading, false);
+    } else {
+        err = pbio_control_start_position_control_chained(&db->control_heading, time_now, state_heading, step->angle, 0, step->on_completion_heading);
+    }
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    pbio_drivebase_synchronize_trajectories(db);
+    db->path_index++;
+    return PBIO_SUCCESS;
+}
+
+#if PBIO_CONFIG_DRIVEBASE_ODOMETRY
+/**
+ * Integrates the pose of the drivebase since the previous update.
+ *
+ * The distance driven in one step is assumed to be along the heading halfway
+ * the step. If the gyro is used for heading control, it is used here too.
+ *
+ * @param [in]  db              The drivebase instance.
+ * @param [in]  state_distance  The current distance state (control units).
+ * @param [in]  state_heading   The current heading state (control units).
+ */
+static void pbio_drivebase_update_odometry(pbio_drivebase_t *db, const pbio_control_state_t *state_distance, const pbio_control_state_t *state_heading) {
+
+    float heading = pbio_control_settings_ctl_to_app_long_float(&db->control_heading.settings, &state_heading->position);
+
+    if (db->odometry_valid) {
+        float distance = (float)pbio_angle_diff_mdeg(&state_distance->position, &db->odometry_distance) /
+            db->control_distance.settings.ctl_steps_per_app_step;
+        float heading_mid = pbio_geometry_degrees_to_radians((heading + db->odometry_heading) / 2);
+        db->odometry_x += distance * cosf(heading_mid);
+        db->odometry_y += distance * sinf(heading_mid);
+    }
+
+    db->odometry_distance = state_distance->position;
+    db->odometry_heading = heading;
+    db->odometry_valid = true;
 }
 
+/**
+ * Gets the pose of the drivebase, integrated in the control loop since the
+ * drivebase was created or reset.
+ *
+ * Positive x is along the heading at the last reset and positive y is to the
+ * right of it. The heading is the same as the drivebase angle.
+ *
+ * @param [in]  db          The drivebase instance.
+ * @param [out] x           Position along the initial heading in mm.
+ * @param [out] y           Position to the right of the initial heading in mm.
+ * @param [out] heading     Heading in degrees, positive clockwise.
+ * @return                  Error code.
+ */
+pbio_error_t pbio_drivebase_get_pose(pbio_drivebase_t *db, float *x, float *y, float *heading) {
+
+    // Pose is only updated if the update loop is running.
+    if (!pbio_drivebase_update_loop_is_running(db)) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    *x = db->odometry_x;
+    *y = db->odometry_y;
+    return pbio_drivebase_get_state_user_angle(db, heading);
+}
+#endif // PBIO_CONFIG_DRIVEBASE_ODOMETRY
+
 /**
  * Updates one drivebase in the control loop.
  *
@@ -454,11 +700,6 @@ bool pbio_drivebase_is_done(const pbio_drivebase_t *db) {
  */
 static pbio_error_t pbio_drivebase_update(pbio_drivebase_t *db) {
 
-    // If passive, no need to update.
-    if (!pbio_drivebase_control_is_active(db)) {
-        return PBIO_SUCCESS;
-    }
-
     // Get current time
     uint32_t time_now = pbio_control_get_time_ticks();
 
@@ -470,6 +711,30 @@ static pbio_error_t pbio_drivebase_update(pbio_drivebase_t *db) {
         return err;
     }
 
+    #if PBIO_CONFIG_DRIVEBASE_ODOMETRY
+    // The pose is tracked even if the robot is pushed around while passive.
+    pbio_drivebase_update_odometry(db, &state_distance, &state_heading);
+    #endif
+
+    // If passive, no need to update.
+    if (!pbio_drivebase_control_is_active(db)) {
+        return PBIO_SUCCESS;
+    }
+
+    // Start the next step of a path once both trajectories of the ongoing
+    // step have ended. They end together, so checking one is enough.
+    if (db->path_index < db->path_size) {
+        pbio_trajectory_reference_t ref_end;
+        pbio_trajectory_get_endpoint(&db->control_distance.trajectory, &ref_end);
+        if (pbio_util_time_has_passed(pbio_control_get_ref_time(&db->control_distance, time_now), ref_end.time)) {
+            err = pbio_drivebase_path_start_step(db, time_now, &state_distance, &state_heading);
+            if (err != PBIO_SUCCESS) {
+                // Don't keep going if the path can't be completed.
+                return pbio_drivebase_stop(db, PBIO_CONTROL_ON_COMPLETION_COAST);
+            }
+        }
+    }
+
     // Get reference and torque signals for distance control.
     pbio_trajectory_reference_t ref_distance;
     int32_t distance_torque;
@@ -504,24 +769,33 @@ static pbio_error_t pbio_drivebase_update(pbio_drivebase_t *db) {
         return PBIO_ERROR_FAILED;
     }
 
-    // The left servo drives at a torque and speed of (average) + (difference).
-    int32_t feed_forward_left = pbio_observer_get_feedforward_torque(
-        db->left->observer.model,
-        ref_distance.speed + ref_heading.speed, // left speed
-        ref_distance.acceleration + ref_heading.acceleration); // left acceleration
-    err = pbio_servo_actuate(db->left, PBIO_DCMOTOR_ACTUATION_TORQUE,
-        distance_torque + heading_torque + feed_forward_left);
-    if (err != PBIO_SUCCESS) {
-        return err;
-    }
+    // All servos on one side get the same feedback torque, and each adds
+    // the feedforward torque for its own model.
+    for (uint8_t i = 0; i < db->motors_per_side; i++) {
 
-    // The right servo drives at a torque and speed of (average) - (difference).
-    int32_t feed_forward_right = pbio_observer_get_feedforward_torque(
-        db->right->observer.model,
-        ref_distance.speed - ref_heading.speed, // right speed
-        ref_distance.acceleration - ref_heading.acceleration); // right acceleration
-    return pbio_servo_actuate(db->right, PBIO_DCMOTOR_ACTUATION_TORQUE,
-        distance_torque - heading_torque + feed_forward_right);
+        // The left servos drive at a torque and speed of (average) + (difference).
+        int32_t feed_forward_left = pbio_observer_get_feedforward_torque(
+            db->left[i]->observer.model,
+            ref_distance.speed + ref_heading.speed, // left speed
+            ref_distance.acceleration + ref_heading.acceleration); // left acceleration
+        err = pbio_servo_actuate(db->left[i], PBIO_DCMOTOR_ACTUATION_TORQUE,
+            distance_torque + heading_torque + feed_forward_left);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        // The right servos drive at a torque and speed of (average) - (difference).
+        int32_t feed_forward_right = pbio_observer_get_feedforward_torque(
+            db->right[i]->observer.model,
+            ref_distance.speed - ref_heading.speed, // right speed
+            ref_distance.acceleration - ref_heading.acceleration); // right acceleration
+        err = pbio_servo_actuate(db->right[i], PBIO_DCMOTOR_ACTUATION_TORQUE,
+            distance_torque - heading_torque + feed_forward_right);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+    }
+    return PBIO_SUCCESS;
 }
 
 /**
@@ -561,6 +835,9 @@ static pbio_error_t pbio_drivebase_drive_relative(pbio_drivebase_t *db, int32_t
     // Stop servo control in case it was running.
     pbio_drivebase_stop_servo_control(db);
 
+    // A new command replaces the ongoing path, if any.
+    db->path_size = 0;
+
     // Get current time
     uint32_t time_now = pbio_control_get_time_ticks();
 
@@ -586,25 +863,7 @@ static pbio_error_t pbio_drivebase_drive_relative(pbio_drivebase_t *db, int32_t
 
     // At this point, the two trajectories may have different durations, so they won't complete at the same time
     // To account for this, we re-compute the shortest trajectory to have the same duration as the longest.
-
-    // First, find out which controller takes the lead
-    const pbio_control_t *control_leader;
-    pbio_control_t *control_follower;
-
-    if (pbio_trajectory_get_duration(&db->control_distance.trajectory) >
-        pbio_trajectory_get_duration(&db->control_heading.trajectory)) {
-        // Distance control takes the longest, so it will take the lead
-        control_leader = &db->control_distance;
-        control_follower = &db->control_heading;
-    } else {
-        // Heading control takes the longest, so it will take the lead
-        control_leader = &db->control_heading;
-        control_follower = &db->control_distance;
-    }
-
-    // Revise follower trajectory so it takes as long as the leader, achieved
-    // by picking a lower speed and accelerations that makes the times match.
-    pbio_trajectory_stretch(&control_follower->trajectory, &control_leader->trajectory);
+    pbio_drivebase_synchronize_trajectories(db);
 
     return PBIO_SUCCESS;
 }
@@ -672,6 +931,9 @@ pbio_error_t pbio_drivebase_drive_turn(pbio_drivebase_t *db, int32_t angle, bool
     // Stop servo control in case it was running.
     pbio_drivebase_stop_servo_control(db);
 
+    // A new command replaces the ongoing path, if any.
+    db->path_size = 0;
+
     // Get current time
     uint32_t time_now = pbio_control_get_time_ticks();
 
@@ -785,6 +1047,100 @@ pbio_error_t pbio_drivebase_drive_arc_distance(pbio_drivebase_t *db, int32_t rad
     return pbio_drivebase_drive_relative(db, distance, 0, angle, 0, on_completion);
 }
 
+/**
+ * Starts the drivebase controllers to drive along a path of straight lines
+ * and arcs.
+ *
+ * The path is converted to distance and heading commands up front. Each
+ * command starts from the targets of the previous one as soon as it ends,
+ * all in the motor control loop. Where the drive or turn direction is the
+ * same in the next segment, the drive base keeps going instead of slowing
+ * down at the end of the segment. The turn rate then changes gradually
+ * from one segment to the next, so curvature is continuous.
+ *
+ * This will use the default speed.
+ *
+ * @param [in]  db              The drivebase instance.
+ * @param [in]  segments        Segments of the path.
+ * @param [in]  num_segments    Number of segments.
+ * @param [in]  on_completion   What to do when reaching the end of the path.
+ * @return                      ::PBIO_ERROR_INVALID_ARG if there are too many
+ *                              segments or if an arc radius is too small,
+ *                              otherwise other error code.
+ */
+pbio_error_t pbio_drivebase_drive_path(pbio_drivebase_t *db, const pbio_drivebase_path_segment_t *segments, uint8_t num_segments, pbio_control_on_completion_t on_completion) {
+
+    // Don't allow new user command if update loop not registered.
+    if (!pbio_drivebase_update_loop_is_running(db)) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    if (num_segments == 0 || num_segments > PBIO_CONFIG_DRIVEBASE_PATH_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    for (uint8_t i = 0; i < num_segments; i++) {
+        if (segments[i].radius != 0 && pbio_int_math_abs(segments[i].radius) < 10) {
+            return PBIO_ERROR_INVALID_ARG;
+        }
+    }
+
+    // Stop servo control in case it was running.
+    pbio_drivebase_stop_servo_control(db);
+
+    // Convert each segment to relative distance and heading commands, as in
+    // pbio_drivebase_drive_arc_distance.
+    for (uint8_t i = 0; i < num_segments; i++) {
+        pbio_drivebase_path_step_t *step = &db->path[i];
+        step->distance = segments[i].distance;
+        step->angle = 0;
+        if (segments[i].radius != 0) {
+            step->angle = pbio_int_math_abs(segments[i].distance) * 573 / pbio_int_math_abs(segments[i].radius) / 10;
+            if ((segments[i].radius < 0) != (segments[i].distance < 0)) {
+                step->angle *= -1;
+            }
+        }
+    }
+
+    // Each controller keeps going at speed into the next step if that step
+    // continues in the same direction. Otherwise it stops at the target, so
+    // that it can reverse or stay put. The last step stops as requested.
+    for (uint8_t i = 0; i < num_segments; i++) {
+        pbio_drivebase_path_step_t *step = &db->path[i];
+        if (i == num_segments - 1) {
+            step->on_completion_distance = on_completion;
+            step->on_completion_heading = on_completion;
+            continue;
+        }
+        const pbio_drivebase_path_step_t *next = &db->path[i + 1];
+        step->on_completion_distance = step->distance != 0 && pbio_int_math_sign(step->distance) == pbio_int_math_sign(next->distance) ?
+            PBIO_CONTROL_ON_COMPLETION_CONTINUE : PBIO_CONTROL_ON_COMPLETION_HOLD;
+        step->on_completion_heading = step->angle != 0 && pbio_int_math_sign(step->angle) == pbio_int_math_sign(next->angle) ?
+            PBIO_CONTROL_ON_COMPLETION_CONTINUE : PBIO_CONTROL_ON_COMPLETION_HOLD;
+    }
+
+    // Get current time
+    uint32_t time_now = pbio_control_get_time_ticks();
+
+    // Get drive base state
+    pbio_control_state_t state_distance;
+    pbio_control_state_t state_heading;
+    pbio_error_t err = pbio_drivebase_get_state_control(db, &state_distance, &state_heading);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Start the first step now. The rest is started by the control loop.
+    db->path_size = num_segments;
+    db->path_index = 0;
+    err = pbio_drivebase_path_start_step(db, time_now, &state_distance, &state_heading);
+    if (err != PBIO_SUCCESS) {
+        db->path_size = 0;
+        return err;
+    }
+    return PBIO_SUCCESS;
+}
+
 /**
  * Starts the drivebase controllers to run for a given duration.
  *
@@ -805,6 +1161,9 @@ static pbio_error_t pbio_drivebase_drive_time_common(pbio_drivebase_t *db, int32
     // Stop servo control in case it was running.
     pbio_drivebase_stop_servo_control(db);
 
+    // A new command replaces the ongoing path, if any.
+    db->path_size = 0;
+
     // Get current time
     uint32_t time_now = pbio_control_get_time_ticks();
 
@@ -932,6 +1291,13 @@ pbio_error_t pbio_drivebase_reset(pbio_drivebase_t *db, int32_t distance, int32_
         pbio_imu_set_heading(angle);
     }
 
+    #if PBIO_CONFIG_DRIVEBASE_ODOMETRY
+    // Start a new pose from here, without integrating the jump in state.
+    db->odometry_x = 0;
+    db->odometry_y = 0;
+    db->odometry_valid = false;
+    #endif
+
     return PBIO_SUCCESS;
 }
 
@@ -1070,22 +1436,20 @@ pbio_error_t pbio_drivebase_is_stalled(pbio_drivebase_t *db, bool *stalled, uint
         return PBIO_SUCCESS;
     }
 
-    // Otherwise look at individual servos.
-    bool stalled_left;
-    bool stalled_right;
-    uint32_t stall_duration_left; // ms, 0 on false.
-    uint32_t stall_duration_right; // ms, 0 on false.
-    err = pbio_servo_is_stalled(db->left, &stalled_left, &stall_duration_left);
-    if (err != PBIO_SUCCESS) {
-        return err;
-    }
-    err = pbio_servo_is_stalled(db->right, &stalled_right, &stall_duration_right);
-    if (err != PBIO_SUCCESS) {
-        return err;
+    // Otherwise look at individual servos. We are stalled if at least one
+    // motor is stalled.
+    *stalled = false;
+    *stall_duration = 0;
+    for (uint8_t i = 0; i < db->motors_per_side * 2; i++) {
+        bool stalled_servo;
+        uint32_t stall_duration_servo; // ms, 0 on false.
+        err = pbio_servo_is_stalled(pbio_drivebase_get_servo(db, i), &stalled_servo, &stall_duration_servo);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+        *stalled |= stalled_servo;
+        *stall_duration = pbio_int_math_max(*stall_duration, stall_duration_servo);
     }
-    // We are stalled if at least one motor is stalled.
-    *stalled = stalled_left || stalled_right;
-    *stall_duration = pbio_int_math_max(stall_duration_left, stall_duration_right);
     return PBIO_SUCCESS;
 }
 
@@ -183,9 +183,36 @@ pbio_error_t pbio_geometry_vector_project(pbio_geometry_xyz_t *axis, pbio_geomet
  * @param [out] output  The resulting output vector.
  */
 void pbio_geometry_vector_map(pbio_geometry_matrix_3x3_t *map, pbio_geometry_xyz_t *input, pbio_geometry_xyz_t *output) {
-    output->x = input->x * map->m11 + input->y * map->m12 + input->z * map->m13;
-    output->y = input->x * map->m21 + input->y * map->m22 + input->z * map->m23;
-    output->z = input->x * map->m31 + input->y * map->m32 + input->z * map->m33;
+    pbio_geometry_vector_map_array(map, input, output, 1);
+}
+
+/**
+ * Maps an array of vectors using the same 3x3 map.
+ *
+ * The map is read once and kept in local variables, and each input vector is
+ * read before its output is written. This lets the compiler keep everything
+ * in FPU registers instead of reloading values after each store in case
+ * the output overlaps with the inputs. For the same reason, @p input and
+ * @p output may be the same array.
+ *
+ * @param [in]  map     The 3x3 map, such as a rotation matrix.
+ * @param [in]  input   The input vectors.
+ * @param [out] output  The resulting output vectors.
+ * @param [in]  count   The number of vectors.
+ */
+void pbio_geometry_vector_map_array(pbio_geometry_matrix_3x3_t *map, pbio_geometry_xyz_t *input, pbio_geometry_xyz_t *output, size_t count) {
+    const float m11 = map->m11, m12 = map->m12, m13 = map->m13;
+    const float m21 = map->m21, m22 = map->m22, m23 = map->m23;
+    const float m31 = map->m31, m32 = map->m32, m33 = map->m33;
+
+    for (size_t i = 0; i < count; i++) {
+        const float x = input[i].x;
+        const float y = input[i].y;
+        const float z = input[i].z;
+        output[i].x = x * m11 + y * m12 + z * m13;
+        output[i].y = x * m21 + y * m22 + z * m23;
+        output[i].z = x * m31 + y * m32 + z * m33;
+    }
 }
 
 /**
@@ -196,15 +223,21 @@ void pbio_geometry_vector_map(pbio_geometry_matrix_3x3_t *map, pbio_geometry_xyz
  * @param [out] output  The resulting 3x3 matrix after multiplication.
  */
 void pbio_geometry_matrix_multiply(pbio_geometry_matrix_3x3_t *a, pbio_geometry_matrix_3x3_t *b, pbio_geometry_matrix_3x3_t *output) {
-    output->m11 = a->m11 * b->m11 + a->m12 * b->m21 + a->m13 * b->m31;
-    output->m12 = a->m11 * b->m12 + a->m12 * b->m22 + a->m13 * b->m32;
-    output->m13 = a->m11 * b->m13 + a->m12 * b->m23 + a->m13 * b->m33;
-    output->m21 = a->m21 * b->m11 + a->m22 * b->m21 + a->m23 * b->m31;
-    output->m22 = a->m21 * b->m12 + a->m22 * b->m22 + a->m23 * b->m32;
-    output->m23 = a->m21 * b->m13 + a->m22 * b->m23 + a->m23 * b->m33;
-    output->m31 = a->m31 * b->m11 + a->m32 * b->m21 + a->m33 * b->m31;
-    output->m32 = a->m31 * b->m12 + a->m32 * b->m22 + a->m33 * b->m32;
-    output->m33 = a->m31 * b->m13 + a->m32 * b->m23 + a->m33 * b->m33;
+
+    // Each row of the output is the row of a, mapped by b transposed. Read
+    // b once so the stores below need not reload it.
+    const float b11 = b->m11, b12 = b->m12, b13 = b->m13;
+    const float b21 = b->m21, b22 = b->m22, b23 = b->m23;
+    const float b31 = b->m31, b32 = b->m32, b33 = b->m33;
+
+    for (size_t r = 0; r < 3; r++) {
+        const float x = a->values[r * 3 + 0];
+        const float y = a->values[r * 3 + 1];
+        const float z = a->values[r * 3 + 2];
+        output->values[r * 3 + 0] = x * b11 + y * b21 + z * b31;
+        output->values[r * 3 + 1] = x * b12 + y * b22 + z * b32;
+        output->values[r * 3 + 2] = x * b13 + y * b23 + z * b33;
+    }
 }
 
 /**
@@ -255,15 +288,22 @@ pbio_error_t pbio_geometry_map_from_base_axes(pbio_geometry_xyz_t *x_axis, pbio_
  * @param [out] R       The rotation matrix.
  */
 void pbio_geometry_quaternion_to_rotation_matrix(pbio_geometry_quaternion_t *q, pbio_geometry_matrix_3x3_t *R) {
-    R->m11 = 1 - 2 * (q->q2 * q->q2 + q->q3 * q->q3);
-    R->m21 = 2 * (q->q1 * q->q2 + q->q3 * q->q4);
-    R->m31 = 2 * (q->q1 * q->q3 - q->q2 * q->q4);
-    R->m12 = 2 * (q->q1 * q->q2 - q->q3 * q->q4);
-    R->m22 = 1 - 2 * (q->q1 * q->q1 + q->q3 * q->q3);
-    R->m32 = 2 * (q->q2 * q->q3 + q->q1 * q->q4);
-    R->m13 = 2 * (q->q1 * q->q3 + q->q2 * q->q4);
-    R->m23 = 2 * (q->q2 * q->q3 - q->q1 * q->q4);
-    R->m33 = 1 - 2 * (q->q1 * q->q1 + q->q2 * q->q2);
+
+    // Each product is used twice, so compute them once.
+    const float q1 = q->q1, q2 = q->q2, q3 = q->q3, q4 = q->q4;
+    const float q11 = q1 * q1, q22 = q2 * q2, q33 = q3 * q3;
+    const float q12 = q1 * q2, q13 = q1 * q3, q14 = q1 * q4;
+    const float q23 = q2 * q3, q24 = q2 * q4, q34 = q3 * q4;
+
+    R->m11 = 1 - 2 * (q22 + q33);
+    R->m21 = 2 * (q12 + q34);
+    R->m31 = 2 * (q13 - q24);
+    R->m12 = 2 * (q12 - q34);
+    R->m22 = 1 - 2 * (q11 + q33);
+    R->m32 = 2 * (q23 + q14);
+    R->m13 = 2 * (q13 + q24);
+    R->m23 = 2 * (q23 - q14);
+    R->m33 = 1 - 2 * (q11 + q22);
 }
 
 /**
@@ -301,10 +341,14 @@ void pbio_geometry_quaternion_get_rate_of_change(pbio_geometry_quaternion_t *q,
         .z = pbio_geometry_degrees_to_radians(angular_velocity->z),
     };
 
-    dq->q1 = 0.5f * (w.z * q->q2 - w.y * q->q3 + w.x * q->q4);
-    dq->q2 = 0.5f * (-w.z * q->q1 + w.x * q->q3 + w.y * q->q4);
-    dq->q3 = 0.5f * (w.y * q->q1 - w.x * q->q2 + w.z * q->q4);
-    dq->q4 = 0.5f * (-w.x * q->q1 - w.y * q->q2 - w.z * q->q3);
+    // Read q before writing dq, so this works in place and the compiler
+    // need not reload q after each store.
+    const float q1 = q->q1, q2 = q->q2, q3 = q->q3, q4 = q->q4;
+
+    dq->q1 = 0.5f * (w.z * q2 - w.y * q3 + w.x * q4);
+    dq->q2 = 0.5f * (-w.z * q1 + w.x * q3 + w.y * q4);
+    dq->q3 = 0.5f * (w.y * q1 - w.x * q2 + w.z * q4);
+    dq->q4 = 0.5f * (-w.x * q1 - w.y * q2 - w.z * q3);
 }
 
 /**
@@ -319,10 +363,12 @@ void pbio_geometry_quaternion_normalize(pbio_geometry_quaternion_t *q) {
         return;
     }
 
-    q->q1 /= norm;
-    q->q2 /= norm;
-    q->q3 /= norm;
-    q->q4 /= norm;
+    // Multiply by the reciprocal since division is much slower on the FPU.
+    const float scale = 1.0f / norm;
+    q->q1 *= scale;
+    q->q2 *= scale;
+    q->q3 *= scale;
+    q->q4 *= scale;
 }
 
 /**
@@ -7,6 +7,7 @@
 
 #include <pbio/image.h>
 
+#include <stdbool.h>
 #include <string.h>
 #include <limits.h>
 #include <stdio.h>
@@ -33,6 +34,301 @@
         } \
     } while (0)
 
+/**
+ * Get pointer to the first byte of a row.
+ * @param [in] image  Image.
+ * @param [in] y      Y coordinate of the row.
+ * @return            Pointer to the row.
+ */
+static inline uint8_t *pbio_image_row(const pbio_image_t *image, int y) {
+    return image->pixels + y * image->stride;
+}
+
+/**
+ * Replicate a pixel value to all pixels of a byte in a packed format.
+ * @param [in] format  Packed image format.
+ * @param [in] value   Pixel value, clamped to the maximum for the format.
+ * @return             Byte with all pixels set to value.
+ */
+static inline uint8_t pbio_image_packed_byte(pbio_image_format_t format,
+    uint8_t value) {
+    uint8_t max = (1 << (1 << format)) - 1;
+    return (value > max ? max : value) * (0xff / max);
+}
+
+/**
+ * Replace some bits of a byte.
+ * @param [in] p     Byte to change.
+ * @param [in] mask  Bits to replace.
+ * @param [in] bits  New bits, only the ones in mask are used.
+ */
+static inline void pbio_image_write_bits(uint8_t *p, uint8_t mask,
+    uint8_t bits) {
+    *p = (*p & ~mask) | (bits & mask);
+}
+
+/**
+ * Get a pixel value, without clipping.
+ * @param [in] image  Image to read from.
+ * @param [in] row    Pointer to the row.
+ * @param [in] x      X coordinate of the pixel.
+ * @return            Pixel value.
+ */
+static inline uint8_t pbio_image_get(const pbio_image_t *image,
+    const uint8_t *row, int x) {
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP) {
+        return row[x];
+    }
+    int bits = 1 << image->format;
+    int bit = (x + image->pixel_offset) << image->format;
+    return (row[bit >> 3] >> (8 - bits - (bit & 7))) & ((1 << bits) - 1);
+}
+
+/**
+ * Locate a pixel in a row of a packed image.
+ * @param [in]  image  Packed image.
+ * @param [in]  x      X coordinate of the pixel.
+ * @param [out] index  Index of the byte containing the pixel.
+ * @return             Mask of the pixel bits in this byte.
+ */
+static inline uint8_t pbio_image_packed_mask(const pbio_image_t *image, int x,
+    int *index) {
+    int bit = (x + image->pixel_offset) << image->format;
+    *index = bit >> 3;
+    return (0xff >> (bit & 7)) & ~(0xff >> ((bit & 7) + (1 << image->format)));
+}
+
+/**
+ * Set a pixel value, without clipping.
+ * @param [in] image  Image to draw into.
+ * @param [in] row    Pointer to the row.
+ * @param [in] x      X coordinate of the pixel.
+ * @param [in] value  Pixel value.
+ */
+static inline void pbio_image_set(const pbio_image_t *image, uint8_t *row,
+    int x, uint8_t value) {
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP) {
+        row[x] = value;
+        return;
+    }
+    int index;
+    uint8_t mask = pbio_image_packed_mask(image, x, &index);
+    pbio_image_write_bits(&row[index], mask,
+        pbio_image_packed_byte(image->format, value));
+}
+
+/**
+ * Fill a horizontal span of pixels, without clipping.
+ * @param [in] image  Image to draw into.
+ * @param [in] row    Pointer to the row.
+ * @param [in] x      X coordinate of the leftmost pixel.
+ * @param [in] l      Number of pixels, must be positive.
+ * @param [in] value  Pixel value.
+ *
+ * For packed formats, whole bytes are filled at once and only the partial
+ * bytes at both ends are masked.
+ */
+static void pbio_image_fill_span(const pbio_image_t *image, uint8_t *row,
+    int x, int l, uint8_t value) {
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP) {
+        memset(row + x, value, l);
+        return;
+    }
+    uint8_t packed = pbio_image_packed_byte(image->format, value);
+    int start = (x + image->pixel_offset) << image->format;
+    int end = start + (l << image->format);
+    uint8_t *first = row + (start >> 3);
+    uint8_t *last = row + ((end - 1) >> 3);
+    uint8_t first_mask = 0xff >> (start & 7);
+    uint8_t last_mask = ~(0xff >> (((end - 1) & 7) + 1));
+    if (first == last) {
+        pbio_image_write_bits(first, first_mask & last_mask, packed);
+        return;
+    }
+    if (first_mask != 0xff) {
+        pbio_image_write_bits(first++, first_mask, packed);
+    }
+    if (last_mask != 0xff) {
+        pbio_image_write_bits(last--, last_mask, packed);
+    }
+    if (last >= first) {
+        memset(first, packed, last - first + 1);
+    }
+}
+
+/**
+ * Copy a horizontal span of pixels, without clipping.
+ * @param [in] image   Image to draw into.
+ * @param [in] row     Pointer to the destination row.
+ * @param [in] x       X coordinate of the leftmost destination pixel.
+ * @param [in] source  Source image.
+ * @param [in] src     Pointer to the source row.
+ * @param [in] sx      X coordinate of the leftmost source pixel.
+ * @param [in] l       Number of pixels, must be positive.
+ *
+ * When both images have the same format and pixel alignment inside bytes,
+ * whole bytes are copied at once. Otherwise, pixels are converted one by one.
+ */
+static void pbio_image_copy_span(const pbio_image_t *image, uint8_t *row,
+    int x, const pbio_image_t *source, const uint8_t *src, int sx, int l) {
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP
+        && source->format == PBIO_IMAGE_FORMAT_8BPP) {
+        memcpy(row + x, src + sx, l);
+        return;
+    }
+    int start = (x + image->pixel_offset) << image->format;
+    int src_start = (sx + source->pixel_offset) << source->format;
+    if (image->format != source->format || (start & 7) != (src_start & 7)) {
+        for (int i = 0; i < l; i++) {
+            pbio_image_set(image, row, x + i, pbio_image_get(source, src, sx + i));
+        }
+        return;
+    }
+    int end = start + (l << image->format);
+    uint8_t *first = row + (start >> 3);
+    uint8_t *last = row + ((end - 1) >> 3);
+    const uint8_t *src_first = src + (src_start >> 3);
+    uint8_t first_mask = 0xff >> (start & 7);
+    uint8_t last_mask = ~(0xff >> (((end - 1) & 7) + 1));
+    if (first == last) {
+        pbio_image_write_bits(first, first_mask & last_mask, *src_first);
+        return;
+    }
+    if (first_mask != 0xff) {
+        pbio_image_write_bits(first++, first_mask, *src_first++);
+    }
+    if (last_mask != 0xff) {
+        pbio_image_write_bits(last, last_mask, src_first[last - first]);
+        last--;
+    }
+    if (last >= first) {
+        memcpy(first, src_first, last - first + 1);
+    }
+}
+
+/**
+ * Copy a horizontal span of pixels, skipping transparent pixels, without
+ * clipping.
+ * @param [in] image   Image to draw into.
+ * @param [in] row     Pointer to the destination row.
+ * @param [in] x       X coordinate of the leftmost destination pixel.
+ * @param [in] source  Source image.
+ * @param [in] src     Pointer to the source row.
+ * @param [in] sx      X coordinate of the leftmost source pixel.
+ * @param [in] l       Number of pixels, must be positive.
+ * @param [in] value   Pixel value in source image considered transparent.
+ *
+ * When both images have the same packed format and pixel alignment inside
+ * bytes, a whole byte of pixels is handled at once by masking the
+ * transparent pixels.
+ */
+static void pbio_image_copy_span_transparent(const pbio_image_t *image,
+    uint8_t *row, int x, const pbio_image_t *source, const uint8_t *src,
+    int sx, int l, uint8_t value) {
+    int start = (x + image->pixel_offset) << image->format;
+    int src_start = (sx + source->pixel_offset) << source->format;
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP
+        || image->format != source->format || (start & 7) != (src_start & 7)) {
+        for (int i = 0; i < l; i++) {
+            uint8_t c = pbio_image_get(source, src, sx + i);
+            if (c != value) {
+                pbio_image_set(image, row, x + i, c);
+            }
+        }
+        return;
+    }
+    // No pixel can match a value that does not fit.
+    if (value > (1 << (1 << image->format)) - 1) {
+        pbio_image_copy_span(image, row, x, source, src, sx, l);
+        return;
+    }
+    uint8_t transparent = pbio_image_packed_byte(image->format, value);
+    int end = start + (l << image->format);
+    uint8_t *p = row + (start >> 3);
+    uint8_t *last = row + ((end - 1) >> 3);
+    const uint8_t *s = src + (src_start >> 3);
+    uint8_t mask = 0xff >> (start & 7);
+    for (; p <= last; p++, s++) {
+        if (p == last) {
+            mask &= ~(0xff >> (((end - 1) & 7) + 1));
+        }
+        // Set all bits of pixels that differ from the transparent value.
+        uint8_t opaque = *s ^ transparent;
+        if (image->format == PBIO_IMAGE_FORMAT_2BPP) {
+            opaque = (opaque | opaque >> 1) & 0x55;
+            opaque |= opaque << 1;
+        }
+        pbio_image_write_bits(p, mask & opaque, *s);
+        mask = 0xff;
+    }
+}
+
+/**
+ * Masks of four 2-bit pixels, indexed by four 1-bit pixels.
+ */
+static const uint8_t pbio_image_expand_2bpp[16] = {
+    0x00, 0x03, 0x0c, 0x0f, 0x30, 0x33, 0x3c, 0x3f,
+    0xc0, 0xc3, 0xcc, 0xcf, 0xf0, 0xf3, 0xfc, 0xff,
+};
+
+/**
+ * Fill the pixels of a horizontal span that are set in a bitmap, without
+ * clipping.
+ * @param [in] image  Image to draw into.
+ * @param [in] row    Pointer to the row.
+ * @param [in] x      X coordinate of the leftmost pixel.
+ * @param [in] l      Number of pixels.
+ * @param [in] bits   Bitmap, most significant bit first.
+ * @param [in] index  Index of the bit for the leftmost pixel.
+ * @param [in] value  Pixel value.
+ *
+ * For packed formats, the bitmap is turned into a mask for each destination
+ * byte, so each byte is written once.
+ */
+static void pbio_image_fill_bitmap_span(const pbio_image_t *image, uint8_t *row,
+    int x, int l, const uint8_t *bits, size_t index, uint8_t value) {
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP) {
+        for (uint8_t *p = row + x; l; l--, p++, index++) {
+            if (bits[index / 8] & (0x80 >> (index % 8))) {
+                *p = value;
+            }
+        }
+        return;
+    }
+    uint8_t packed = pbio_image_packed_byte(image->format, value);
+    int per_byte = 8 >> image->format;
+    int start = (x + image->pixel_offset) << image->format;
+    uint8_t *p = row + (start >> 3);
+    int first = (start & 7) >> image->format;
+    while (l > 0) {
+        // Pixels of the bitmap that go into this byte.
+        int n = per_byte - first < l ? per_byte - first : l;
+        uint32_t b = bits[index / 8] << 8;
+        if (index % 8 + n > 8) {
+            b |= bits[index / 8 + 1];
+        }
+        b = (b << (index % 8) & 0xffff) >> (16 - n);
+        uint8_t mask = b << (per_byte - first - n);
+        if (image->format == PBIO_IMAGE_FORMAT_2BPP) {
+            mask = pbio_image_expand_2bpp[mask];
+        }
+        pbio_image_write_bits(p++, mask, packed);
+        index += n;
+        l -= n;
+        first = 0;
+    }
+}
+
+/**
+ * Get the minimum number of bytes per row for a given format.
+ * @param [in] format  Image format.
+ * @param [in] width   Number of columns.
+ * @return             Number of bytes needed to store one row.
+ */
+int pbio_image_get_min_stride(pbio_image_format_t format, int width) {
+    return ((width << format) + 7) >> 3;
+}
+
 /**
  * Initialize an image, using external storage.
  * @param [out] image   Uninitialized image to initialize.
@@ -48,10 +344,31 @@
  */
 void pbio_image_init(pbio_image_t *image, uint8_t *pixels, int width,
     int height, int stride) {
+    pbio_image_init_format(image, pixels, width, height, stride,
+        PBIO_IMAGE_FORMAT_8BPP);
+}
+
+/**
+ * Initialize an image with a given pixel format, using external storage.
+ * @param [out] image   Uninitialized image to initialize.
+ * @param [in]  pixels  Buffer storing the pixels values, not changed.
+ * @param [in]  width   Number of columns.
+ * @param [in]  height  Number of rows.
+ * @param [in]  stride  Distance in bytes inside the pixel buffer to go from
+ *                      one row to the next one.
+ * @param [in]  format  How pixels are stored in the buffer.
+ *
+ * Packed formats use less memory and drawing touches fewer bytes, but pixel
+ * values are limited to what fits in the available bits.
+ */
+void pbio_image_init_format(pbio_image_t *image, uint8_t *pixels, int width,
+    int height, int stride, pbio_image_format_t format) {
     image->pixels = pixels;
     image->width = width;
     image->height = height;
     image->stride = stride;
+    image->format = format;
+    image->pixel_offset = 0;
     image->print_font = NULL;
     image->print_x_left = 0;
     image->print_y_top = 0;
@@ -79,7 +396,7 @@ void pbio_image_init(pbio_image_t *image, uint8_t *pixels, int width,
 void pbio_image_init_sub(pbio_image_t *image, const pbio_image_t *source,
     int x, int y, int width, int height) {
     // Start with an empty image in case of early return.
-    pbio_image_init(image, source->pixels, 0, 0, 0);
+    pbio_image_init_format(image, source->pixels, 0, 0, 0, source->format);
 
     // Eliminate weird cases.
     if (width <= 0 || height <= 0) {
@@ -92,9 +409,12 @@ void pbio_image_init_sub(pbio_image_t *image, const pbio_image_t *source,
     clip_or_return(x, x2, source->width);
     clip_or_return(y, y2, source->height);
 
-    // Select the right part of source image.
-    pbio_image_init(image, source->pixels + y * source->stride + x, x2 - x,
-        y2 - y, source->stride);
+    // Select the right part of source image. For packed formats, the first
+    // pixel may be in the middle of a byte.
+    int bit = (x + source->pixel_offset) << source->format;
+    pbio_image_init_format(image, pbio_image_row(source, y) + (bit >> 3),
+        x2 - x, y2 - y, source->stride, source->format);
+    image->pixel_offset = (bit & 7) >> source->format;
 
     // Reuse the same font and value.
     image->print_font = source->print_font;
@@ -110,8 +430,8 @@ void pbio_image_init_sub(pbio_image_t *image, const pbio_image_t *source,
  */
 void pbio_image_fill(pbio_image_t *image, uint8_t value) {
     uint8_t *p = image->pixels;
-    for (int h = image->height; h; h--) {
-        memset(p, value, image->width);
+    for (int h = image->height; h && image->width; h--) {
+        pbio_image_fill_span(image, p, 0, image->width, value);
         p += image->stride;
     }
     image->print_x_left = 0;
@@ -142,11 +462,11 @@ void pbio_image_draw_image(pbio_image_t *image, const pbio_image_t *source,
     clip_or_return(y, y2, image->height);
 
     // Copy pixels.
-    uint8_t *src = source->pixels + (y - oy) * source->stride + (x - ox);
-    uint8_t *dst = image->pixels + y * image->stride + x;
+    const uint8_t *src = pbio_image_row(source, y - oy);
+    uint8_t *dst = pbio_image_row(image, y);
     int w = x2 - x;
     for (int h = y2 - y; h; h--) {
-        memcpy(dst, src, w);
+        pbio_image_copy_span(image, dst, x, source, src, x - ox, w);
         dst += image->stride;
         src += source->stride;
     }
@@ -179,9 +499,21 @@ void pbio_image_draw_image_transparent(pbio_image_t *image,
     clip_or_return(y, y2, image->height);
 
     // Draw pixels.
+    int w = x2 - x;
+    if (image->format != PBIO_IMAGE_FORMAT_8BPP
+        || source->format != PBIO_IMAGE_FORMAT_8BPP) {
+        const uint8_t *src = pbio_image_row(source, y - oy);
+        uint8_t *dst = pbio_image_row(image, y);
+        for (int h = y2 - y; h; h--) {
+            pbio_image_copy_span_transparent(image, dst, x, source, src,
+                x - ox, w, value);
+            dst += image->stride;
+            src += source->stride;
+        }
+        return;
+    }
     uint8_t *src = source->pixels + (y - oy) * source->stride + (x - ox);
     uint8_t *dst = image->pixels + y * image->stride + x;
-    int w = x2 - x;
     for (int h = y2 - y; h; h--) {
         for (int i = w; i; i--) {
             uint8_t c = *src;
@@ -196,6 +528,49 @@ void pbio_image_draw_image_transparent(pbio_image_t *image,
     }
 }
 
+/**
+ * Draw a run-length encoded monochrome image inside another image with
+ * transparency. Black runs are drawn as horizontal lines, so pixels are not
+ * decoded one by one.
+ *
+ * @param [in] image   Destination image to draw into.
+ * @param [in] source  Source image with run-length encoded data.
+ * @param [in] x       X coordinate of the top-left point in destination
+ *                     image.
+ * @param [in] y       Y coordinate of the top-left point in destination
+ *                     image.
+ * @param [in] value   Pixel value in destination for black.
+ */
+static void pbio_image_draw_image_transparent_from_rle(pbio_image_t *image,
+    const pbio_image_monochrome_t *source, int x, int y, uint8_t value) {
+    int col = 0;
+    int row = 0;
+    bool black = false;
+    for (int i = 0; i < source->rle_size && row < source->height; i++) {
+        int n = source->data[i];
+        while (n && row < source->height) {
+            // Stop at the bottom of the destination, nothing more to draw.
+            if (y + row >= image->height) {
+                return;
+            }
+            int l = source->width - col;
+            if (l > n) {
+                l = n;
+            }
+            if (black && y + row >= 0) {
+                pbio_image_draw_hline(image, x + col, y + row, l, value);
+            }
+            n -= l;
+            col += l;
+            if (col == source->width) {
+                col = 0;
+                row++;
+            }
+        }
+        black = !black;
+    }
+}
+
 /**
  * Draw an image inside another image with transparency. The source is
  * a compressed monochrome image.
@@ -216,6 +591,11 @@ void pbio_image_draw_image_transparent(pbio_image_t *image,
  */
 void pbio_image_draw_image_transparent_from_monochrome(pbio_image_t *image,
     const pbio_image_monochrome_t *source, int x, int y, uint8_t value) {
+    if (source->rle_size) {
+        pbio_image_draw_image_transparent_from_rle(image, source, x, y, value);
+        return;
+    }
+
     // Clipping.
     int ox = x;
     int oy = y;
@@ -228,18 +608,13 @@ void pbio_image_draw_image_transparent_from_monochrome(pbio_image_t *image,
     size_t index = (y - oy) * source->width + (x - ox);
 
     // Draw pixels.
-    uint8_t *dst = image->pixels + y * image->stride + x;
+    uint8_t *dst = pbio_image_row(image, y);
     int w = x2 - x;
     for (int h = y2 - y; h; h--) {
-        for (int i = w; i; i--) {
-            if (source->data[index / 8] & (1 << (7 - index % 8))) {
-                *dst = value;
-            }
-            index++;
-            dst++;
-        }
-        dst += image->stride - w;
-        index += source->width - w;
+        pbio_image_fill_bitmap_span(image, dst, x, w, source->data, index,
+            value);
+        dst += image->stride;
+        index += source->width;
     }
 }
 
@@ -259,8 +634,23 @@ void pbio_image_draw_pixel(pbio_image_t *image, int x, int y, uint8_t value) {
     }
 
     // Draw pixel.
-    uint8_t *p = image->pixels + y * image->stride + x;
-    *p = value;
+    pbio_image_set(image, pbio_image_row(image, y), x, value);
+}
+
+/**
+ * Get the value of a single pixel.
+ * @param [in] image  Image to read from.
+ * @param [in] x      X coordinate of the pixel.
+ * @param [in] y      Y coordinate of the pixel.
+ * @return            Pixel value, or 0 if coordinate is outside of the image.
+ */
+uint8_t pbio_image_get_pixel(const pbio_image_t *image, int x, int y) {
+    // Clipping.
+    if (x < 0 || x >= image->width || y < 0 || y >= image->height) {
+        return 0;
+    }
+
+    return pbio_image_get(image, pbio_image_row(image, y), x);
 }
 
 /**
@@ -288,8 +678,7 @@ void pbio_image_draw_hline(pbio_image_t *image, int x, int y, int l,
     }
 
     // Draw line.
-    uint8_t *p = image->pixels + y * image->stride + x;
-    memset(p, value, x2 - x);
+    pbio_image_fill_span(image, pbio_image_row(image, y), x, x2 - x, value);
 }
 
 /**
@@ -317,9 +706,19 @@ void pbio_image_draw_vline(pbio_image_t *image, int x, int y, int l,
     clip_or_return(y, y2, image->height);
 
     // Draw line.
-    uint8_t *p = image->pixels + y * image->stride + x;
-    for (int h = y2 - y; h; h--) {
-        *p = value;
+    uint8_t *p = pbio_image_row(image, y);
+    if (image->format == PBIO_IMAGE_FORMAT_8BPP) {
+        for (int h = y2 - y; h; h--) {
+            p[x] = value;
+            p += image->stride;
+        }
+        return;
+    }
+    int index;
+    uint8_t mask = pbio_image_packed_mask(image, x, &index);
+    uint8_t packed = pbio_image_packed_byte(image->format, value);
+    for (p += index; y < y2; y++) {
+        pbio_image_write_bits(p, mask, packed);
         p += image->stride;
     }
 }
@@ -608,9 +1007,9 @@ void pbio_image_fill_rect(pbio_image_t *image, int x, int y, int width,
     clip_or_return(y, y2, image->height);
 
     // Draw.
-    uint8_t *p = image->pixels + y * image->stride + x;
+    uint8_t *p = pbio_image_row(image, y);
     for (int h = y2 - y; h; h--) {
-        memset(p, value, x2 - x);
+        pbio_image_fill_span(image, p, x, x2 - x, value);
         p += image->stride;
     }
 }
@@ -824,19 +1223,25 @@ void pbio_image_fill_circle(pbio_image_t *image, int x, int y, int r,
 static void pbio_image_draw_text_glyph(pbio_image_t *image,
     const pbio_font_t *font, const pbio_font_glyph_t *glyph, int x, int y,
     uint8_t value) {
-    const uint8_t *src = &font->data[glyph->data_index];
-    uint8_t bits;
-    for (int dy = 0; dy < glyph->height; dy++) {
-        for (int dx = 0; dx < glyph->width; dx++) {
-            if ((dx & 7) == 0) {
-                bits = *src++;
-            }
-            if (bits & 128) {
-                pbio_image_draw_pixel(image, x + glyph->left + dx,
-                    y - glyph->top + dy, value);
-            }
-            bits <<= 1;
-        }
+    // Clipping, once for the whole glyph.
+    int x1 = x + glyph->left;
+    int y1 = y - glyph->top;
+    int x2 = x1 + glyph->width;
+    int y2 = y1 + glyph->height;
+    int ox = x1;
+    int oy = y1;
+    clip_or_return(x1, x2, image->width);
+    clip_or_return(y1, y2, image->height);
+
+    // Each glyph row starts on a new byte.
+    int row_bytes = (glyph->width + 7) / 8;
+    const uint8_t *src = &font->data[glyph->data_index + (y1 - oy) * row_bytes];
+    uint8_t *dst = pbio_image_row(image, y1);
+    for (int h = y2 - y1; h; h--) {
+        pbio_image_fill_bitmap_span(image, dst, x1, x2 - x1, src, x1 - ox,
+            value);
+        src += row_bytes;
+        dst += image->stride;
     }
 }
 
@@ -970,41 +1375,57 @@ void pbio_image_bbox_text(const pbio_font_t *font, const char *text,
  */
 static void pbio_image_scroll_up(pbio_image_t *image, int n) {
     uint8_t *dst = image->pixels;
-    uint8_t *src = image->pixels + n * image->stride;
+    uint8_t *src;
     int y;
+    if (image->width <= 0) {
+        return;
+    }
+    if (n > image->height) {
+        n = image->height;
+    }
+
+    // Rows without padding or neighbors are moved as a single block.
+    if (image->pixel_offset == 0 && image->stride > 0 &&
+        image->stride == pbio_image_get_min_stride(image->format, image->width)) {
+        int size = (image->height - n) * image->stride;
+        memmove(dst, pbio_image_row(image, n), size);
+        memset(dst + size, 0, n * image->stride);
+        return;
+    }
+
+    src = pbio_image_row(image, n);
     for (y = 0; y < image->height - n; y++) {
-        memcpy(dst, src, image->width);
+        pbio_image_copy_span(image, dst, 0, image, src, 0, image->width);
         src += image->stride;
         dst += image->stride;
     }
     for (; y < image->height; y++) {
-        memset(dst, 0, image->width);
+        pbio_image_fill_span(image, dst, 0, image->width, 0);
         dst += image->stride;
     }
 }
 
 /**
- * Print text inside image, like in a terminal, scroll when bottom is reached.
+ * Lay out text inside image, like in a terminal.
  * @param [in] image     Image to draw into.
  * @param [in] text      Text string.
  * @param [in] text_len  Text length.
+ * @param [in] scroll    Number of pixels the image was already scrolled up
+ *                       for this text, or -1 to only compute it.
+ * @return               Number of pixels to scroll up to fit the text.
  *
- * Clipping: drawing is clipped to image dimensions.
- *
- * Text uses ASCII encoding. Newlines are handled, text is flush left.
+ * Glyphs are drawn where they would end up after all scrolling, so the image
+ * only needs to be scrolled once for the whole text.
  */
-void pbio_image_print(pbio_image_t *image, const char *text, size_t text_len) {
+static int pbio_image_print_layout(pbio_image_t *image, const char *text,
+    size_t text_len, int scroll) {
     const char *p;
-    int x, y_top;
+    int x, y_top, scrolled = 0;
     char c, prev = 0;
-    const pbio_font_t *font;
+    const pbio_font_t *font = image->print_font;
     const pbio_font_glyph_t *g;
     const pbio_font_kerning_t *k;
 
-    font = image->print_font;
-    if (!font) {
-        return;
-    }
     x = image->print_x_left;
     y_top = image->print_y_top;
 
@@ -1036,13 +1457,16 @@ void pbio_image_print(pbio_image_t *image, const char *text, size_t text_len) {
             /* Scroll? */
             if (y_top + font->top_max - g->top + g->height > image->height &&
                 y_top >= font->line_height) {
-                pbio_image_scroll_up(image, font->line_height);
+                scrolled += font->line_height;
                 y_top -= font->line_height;
             }
 
-            /* Draw glyph. */
-            pbio_image_draw_text_glyph(image, font, g, x, y_top + font->top_max,
-                image->print_value);
+            /* Draw glyph, moved up by the scrolling still to come. */
+            if (scroll >= 0) {
+                pbio_image_draw_text_glyph(image, font, g, x,
+                    y_top + font->top_max - (scroll - scrolled),
+                    image->print_value);
+            }
 
             /* Advance pen. */
             x += g->advance;
@@ -1050,8 +1474,34 @@ void pbio_image_print(pbio_image_t *image, const char *text, size_t text_len) {
         prev = c;
     }
 
-    image->print_x_left = x;
-    image->print_y_top = y_top;
+    if (scroll >= 0) {
+        image->print_x_left = x;
+        image->print_y_top = y_top;
+    }
+    return scrolled;
+}
+
+/**
+ * Print text inside image, like in a terminal, scroll when bottom is reached.
+ * @param [in] image     Image to draw into.
+ * @param [in] text      Text string.
+ * @param [in] text_len  Text length.
+ *
+ * Clipping: drawing is clipped to image dimensions.
+ *
+ * Text uses ASCII encoding. Newlines are handled, text is flush left.
+ */
+void pbio_image_print(pbio_image_t *image, const char *text, size_t text_len) {
+    if (!image->print_font) {
+        return;
+    }
+
+    // Scroll once for all lines, instead of once per line.
+    int scroll = pbio_image_print_layout(image, text, text_len, -1);
+    if (scroll) {
+        pbio_image_scroll_up(image, scroll);
+    }
+    pbio_image_print_layout(image, text, text_len, scroll);
 }
 
 /**
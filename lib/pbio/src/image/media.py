@@ -41,12 +41,37 @@ def is_black(r, g, b, a):
     return 1 if (r + g + b) < (128 * 3) else 0
 
 
+# Encode as lengths of alternating transparent and black runs, starting with
+# transparent. Runs longer than 255 are split by a zero length run.
+def encode_rle(mono):
+    data = []
+    color = 0
+    i = 0
+    while i < len(mono):
+        n = 0
+        while i < len(mono) and mono[i] == color:
+            n += 1
+            i += 1
+        while n > 255:
+            data += [255, 0]
+            n -= 255
+        data.append(n)
+        color ^= 1
+    return bytes(data)
+
+
 def image_to_8bit_map(img):
     img = img.convert("RGBA")
     width, height = img.size
     pixels = img.load()
     mono = [is_black(*pixels[x, y]) for y in range(height) for x in range(width)]
 
+    # Use run-length encoding if it is smaller, which is typical for icons
+    # with large uniform areas.
+    rle = encode_rle(mono)
+    if len(rle) < (len(mono) + 7) // 8:
+        return width, height, rle, True
+
     # go in chunks of 8 pixels and pack into a byte
     data = []
     for i in range(0, len(mono), 8):
@@ -56,7 +81,7 @@ def image_to_8bit_map(img):
                 byte |= mono[i + j] << (7 - j)
         data.append(byte)
 
-    return width, height, bytes(data)
+    return width, height, bytes(data), False
 
 
 # Process each image.
@@ -64,8 +89,7 @@ results = {}
 for img_path in media_images:
     with Image.open(img_path) as img:
         name = Path(img_path.name).stem
-        width, height, bin_data = image_to_8bit_map(img)
-        results[name] = (width, height, bin_data)
+        results[name] = image_to_8bit_map(img)
 
 
 externs = ""
@@ -73,7 +97,7 @@ structs = ""
 qstrtab = ""
 
 for name in sorted(results):
-    width, height, bin_data = results[name]
+    width, height, bin_data, rle = results[name]
 
     # Parse bytes for printing.
     bytes_per_line = 12
@@ -91,7 +115,8 @@ for name in sorted(results):
         f"    .width = {width},\n"
         f"    .height = {height},\n"
         f"    .data = {name}_data,\n"
-        f"}};\n"
+        + (f"    .rle_size = sizeof({name}_data),\n" if rle else "")
+        + f"}};\n"
     )
 
     # Printed header and QSTR table entries.
@@ -17,6 +17,7 @@
 #include <pbio/geometry.h>
 #include <pbio/imu.h>
 #include <pbio/int_math.h>
+#include <pbio/trace.h>
 #include <pbio/util.h>
 
 #include <pbsys/storage.h>
@@ -165,16 +166,54 @@ static float heading_projection;
 static int32_t heading_rotations;
 
 
+/**
+ * Which estimates are updated for each frame. Angular velocity and
+ * acceleration are always updated. ::PBIO_IMU_HEADING_TYPE_1D also integrates
+ * the angular velocity along each axis, and ::PBIO_IMU_HEADING_TYPE_3D also
+ * estimates the 3D attitude.
+ */
+static pbio_imu_heading_type_t fusion_mode = PBIO_IMU_HEADING_TYPE_3D;
+
+/**
+ * Output data rate most recently requested from the driver, in Hz.
+ */
+static uint32_t data_rate = PBIO_IMU_DATA_RATE_DEFAULT;
+
 /**
  * Hub calibration settings. Cannot be used until loaded.
  */
 static pbio_imu_persistent_settings_t *persistent_settings = NULL;
 
+// This counter is a measure for calibration accuracy, roughly equivalent
+// to the accumulative number of seconds it has been stationary in total.
+static uint32_t stationary_counter = 0;
+static uint32_t stationary_time_last;
+
 /**
  * Standard gravity in mm/s^2.
  */
 const float standard_gravity = 9806.65f;
 
+/**
+ * Calibration constants derived from the settings. These are computed when
+ * the settings change so that they need not be computed for every sample.
+ */
+static pbio_geometry_xyz_t acceleration_offset;
+static pbio_geometry_xyz_t acceleration_factor;
+static pbio_geometry_xyz_t angular_velocity_factor;
+
+/**
+ * Updates calibration constants from the (newly set) settings.
+ */
+static void pbio_imu_update_calibration(pbio_imu_persistent_settings_t *settings) {
+    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(acceleration_offset.values); i++) {
+        float acceleration_scale = (settings->gravity_pos.values[i] - settings->gravity_neg.values[i]) / 2;
+        acceleration_offset.values[i] = (settings->gravity_pos.values[i] + settings->gravity_neg.values[i]) / 2;
+        acceleration_factor.values[i] = standard_gravity / acceleration_scale;
+        angular_velocity_factor.values[i] = 360.0f / settings->angular_velocity_scale.values[i];
+    }
+}
+
 /**
  * Applies (newly set) settings to the driver.
  */
@@ -224,6 +263,16 @@ void pbio_imu_apply_loaded_settings(pbio_imu_persistent_settings_t *settings) {
     gyro_bias.y = settings->angular_velocity_bias_start.y;
     gyro_bias.z = settings->angular_velocity_bias_start.z;
 
+    // If the saved bias was estimated while stationary on an earlier boot,
+    // it is good enough to start with, so the IMU is ready right away. It
+    // counts as one second of stationary data, so the first new data still
+    // gets a large weight.
+    if (settings->flags & PBIO_IMU_SETTINGS_FLAGS_GYRO_BIAS_INITIAL_SET) {
+        stationary_counter = 1;
+        stationary_time_last = pbdrv_clock_get_ms();
+    }
+
+    pbio_imu_update_calibration(settings);
     pbio_imu_apply_pbdrv_settings(settings);
 }
 
@@ -262,27 +311,8 @@ static void update_heading_projection(void) {
     heading_projection = heading_now;
 }
 
-// Called by driver to process one frame of unfiltered gyro and accelerometer data.
-static void pbio_imu_handle_frame_data_func(int16_t *data) {
-
-    // Initialize quaternion from first gravity sample as a best-effort estimate.
-    // From here, fusion will gradually converge the quaternion to the true value.
-    if (!quaternion_initialized) {
-        pbio_geometry_xyz_t g = { .x = data[3], .y = data[4], .z = data[5]};
-        pbio_error_t err = pbio_geometry_vector_normalize(&g, &g);
-        if (err != PBIO_SUCCESS) {
-            // First sample not suited, try again on next sample.
-            return;
-        }
-        pbio_geometry_quaternion_from_gravity_unit_vector(&g, &quaternion);
-        quaternion_initialized = true;
-    }
-
-    // Compute current orientation matrix to obtain the current heading.
-    pbio_geometry_quaternion_to_rotation_matrix(&quaternion, &pbio_imu_rotation);
-
-    // Projects application x-axis into the inertial frame to compute the heading.
-    update_heading_projection();
+// Processes one frame of unfiltered gyro and accelerometer data.
+static void pbio_imu_process_frame(const int16_t *data, bool update_heading) {
 
     for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(angular_velocity_calibrated.values); i++) {
         // Update angular velocity and acceleration cache so user can read them.
@@ -291,10 +321,8 @@ static void pbio_imu_handle_frame_data_func(int16_t *data) {
 
         // Once settings loaded, maintain calibrated cached values.
         if (persistent_settings) {
-            float acceleration_offset = (persistent_settings->gravity_pos.values[i] + persistent_settings->gravity_neg.values[i]) / 2;
-            float acceleration_scale = (persistent_settings->gravity_pos.values[i] - persistent_settings->gravity_neg.values[i]) / 2;
-            acceleration_calibrated.values[i] = (acceleration_uncalibrated.values[i] - acceleration_offset) * standard_gravity / acceleration_scale;
-            angular_velocity_calibrated.values[i] = (angular_velocity_uncalibrated.values[i] - gyro_bias.values[i]) * 360.0f / persistent_settings->angular_velocity_scale.values[i];
+            acceleration_calibrated.values[i] = (acceleration_uncalibrated.values[i] - acceleration_offset.values[i]) * acceleration_factor.values[i];
+            angular_velocity_calibrated.values[i] = (angular_velocity_uncalibrated.values[i] - gyro_bias.values[i]) * angular_velocity_factor.values[i];
         } else {
             acceleration_calibrated.values[i] = acceleration_uncalibrated.values[i];
             angular_velocity_calibrated.values[i] = angular_velocity_uncalibrated.values[i];
@@ -305,7 +333,38 @@ static void pbio_imu_handle_frame_data_func(int16_t *data) {
         // the hub mounted at an arbitrary orientation. Such a 1D heading
         // is numerically more accurate, which is useful in drive base
         // applications so long as the vehicle drives on a flat surface.
-        single_axis_rotation.values[i] += angular_velocity_calibrated.values[i] * imu_config->sample_time;
+        if (fusion_mode != PBIO_IMU_HEADING_TYPE_NONE) {
+            single_axis_rotation.values[i] += angular_velocity_calibrated.values[i] * imu_config->sample_time;
+        }
+    }
+
+    // The rest is the 3D attitude estimate, which takes most of the time.
+    if (fusion_mode != PBIO_IMU_HEADING_TYPE_3D) {
+        return;
+    }
+
+    // Initialize quaternion from first gravity sample as a best-effort estimate.
+    // From here, fusion will gradually converge the quaternion to the true value.
+    if (!quaternion_initialized) {
+        pbio_geometry_xyz_t g = { .x = data[3], .y = data[4], .z = data[5]};
+        pbio_error_t err = pbio_geometry_vector_normalize(&g, &g);
+        if (err != PBIO_SUCCESS) {
+            // First sample not suited, try again on next sample.
+            return;
+        }
+        pbio_geometry_quaternion_from_gravity_unit_vector(&g, &quaternion);
+        quaternion_initialized = true;
+    }
+
+    // Compute current orientation matrix to obtain the current heading.
+    pbio_geometry_quaternion_to_rotation_matrix(&quaternion, &pbio_imu_rotation);
+
+    // Projects application x-axis into the inertial frame to compute the
+    // heading. Within a batch, the heading can only change by a few degrees
+    // between frames, so the 180/-180 boundary is still detected if this is
+    // done just once per batch.
+    if (update_heading) {
+        update_heading_projection();
     }
 
     // Estimate for gravity vector based on orientation estimate.
@@ -349,24 +408,56 @@ static void pbio_imu_handle_frame_data_func(int16_t *data) {
     adjusted_angular_velocity.y = angular_velocity_calibrated.y + correction.y * fusion;
     adjusted_angular_velocity.z = angular_velocity_calibrated.z + correction.z * fusion;
 
-    // Update 3D attitude, basic forward integration.
+    // Update 3D attitude.
     pbio_geometry_quaternion_t dq;
     pbio_geometry_quaternion_get_rate_of_change(&quaternion, &adjusted_angular_velocity, &dq);
+
+    #if PBIO_CONFIG_IMU_INTEGRATION_RK2
+    // Midpoint method: use the rate of change halfway through the sample.
+    pbio_geometry_quaternion_t q_mid;
+    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(dq.values); i++) {
+        q_mid.values[i] = quaternion.values[i] + dq.values[i] * imu_config->sample_time / 2;
+    }
+    pbio_geometry_quaternion_get_rate_of_change(&q_mid, &adjusted_angular_velocity, &dq);
+    #endif // PBIO_CONFIG_IMU_INTEGRATION_RK2
+
+    // Forward integration.
     for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(dq.values); i++) {
         quaternion.values[i] += dq.values[i] * imu_config->sample_time;
     }
-    pbio_geometry_quaternion_normalize(&quaternion);
+
+    // The quaternion only drifts slightly from unit length in one sample, so
+    // one Newton step for the inverse square root of its squared norm is
+    // enough to normalize it again, without sqrt and division.
+    float norm_squared = 0;
+    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(quaternion.values); i++) {
+        norm_squared += quaternion.values[i] * quaternion.values[i];
+    }
+    float inverse_norm = (3.0f - norm_squared) / 2;
+    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(quaternion.values); i++) {
+        quaternion.values[i] *= inverse_norm;
+    }
 }
 
-// This counter is a measure for calibration accuracy, roughly equivalent
-// to the accumulative number of seconds it has been stationary in total.
-static uint32_t stationary_counter = 0;
-static uint32_t stationary_time_last;
+/**
+ * Time at which the most recent frame was processed (us).
+ */
+static uint32_t frame_time_us;
+
+// Called by driver to process one or more frames of unfiltered gyro and accelerometer data.
+PBIO_HOT static void pbio_imu_handle_frame_data_func(int16_t *data, uint32_t num_frames) {
+    for (uint32_t f = 0; f < num_frames; f++) {
+        pbio_trace_record(PBIO_TRACE_EVENT_IMU_FRAME, 0, &data[f * 6], 6 * sizeof(int16_t));
+        pbio_imu_process_frame(&data[f * 6], f == num_frames - 1);
+    }
+    frame_time_us = pbdrv_clock_get_us();
+}
 
 /*
  * Tests if the imu is ready for use in a user program.
  *
- * @return    True if it has been stationary at least once in the last 10 minutes.
+ * @return    True if it has been stationary at least once in the last 10 minutes,
+ *            or if a gyro bias from an earlier boot was loaded in that time.
 */
 bool pbio_imu_is_ready(void) {
     return stationary_counter > 0 && pbdrv_clock_get_ms() - stationary_time_last < 10 * 60 * 1000;
@@ -401,11 +492,13 @@ static void pbio_imu_handle_stationary_data_func(const int32_t *gyro_data_sum, c
         gyro_bias.values[i] = gyro_bias.values[i] * (1.0f - weight) + weight * average_now;
     }
 
-    // If persistent gyro bias has never been set, do so now and request saving.
-    // This ensures a better starting point for the next boot. We do this only
-    // once to avoid unnecessary writes on every shutdown. It can be further
+    // Save the gyro bias as the starting point for the next boot, so the IMU
+    // is ready right away. This is done the first time when there is a
+    // rough estimate, and then once per boot when the estimate has settled,
+    // to avoid unnecessary writes on every shutdown. It can be further
     // refined with a calibration routine performed by the user.
-    if (persistent_settings && !(persistent_settings->flags & PBIO_IMU_SETTINGS_FLAGS_GYRO_BIAS_INITIAL_SET) && stationary_counter > 2) {
+    if (persistent_settings && ((!(persistent_settings->flags & PBIO_IMU_SETTINGS_FLAGS_GYRO_BIAS_INITIAL_SET) && stationary_counter > 2) ||
+                                stationary_counter == 20)) {
         persistent_settings->angular_velocity_bias_start = gyro_bias;
         persistent_settings->flags |= PBIO_IMU_SETTINGS_FLAGS_GYRO_BIAS_INITIAL_SET;
         pbsys_storage_request_write();
@@ -423,6 +516,66 @@ void pbio_imu_init(void) {
     pbdrv_imu_set_data_handlers(imu_dev, pbio_imu_handle_frame_data_func, pbio_imu_handle_stationary_data_func);
 }
 
+/**
+ * Sets the output data rate and which estimates are updated for each frame.
+ *
+ * Lower rates and less fusion take less processing time. Estimates that are
+ * not updated keep their last value, so reset the heading after enabling
+ * them again. The 3D attitude starts over from the direction of gravity.
+ *
+ * @param [in]  rate        Output data rate in Hz: 104, 208, 416, 833, or 1666.
+ * @param [in]  fusion      Which estimates to update. NONE only updates angular
+ *                          velocity and acceleration, 1D also integrates the angular
+ *                          velocity along each axis, and 3D also estimates the attitude.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_INVALID_ARG if the rate or fusion mode is not supported.
+ *                          ::PBIO_ERROR_NO_DEV if there is no IMU.
+ */
+pbio_error_t pbio_imu_set_mode(uint32_t rate, pbio_imu_heading_type_t fusion) {
+
+    if (!imu_dev) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    if (fusion != PBIO_IMU_HEADING_TYPE_NONE && fusion != PBIO_IMU_HEADING_TYPE_1D && fusion != PBIO_IMU_HEADING_TYPE_3D) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (rate != data_rate) {
+        pbio_error_t err = pbdrv_imu_set_data_rate(imu_dev, rate);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+        data_rate = rate;
+    }
+
+    // The attitude is stale if it was not updated, so start over.
+    if (fusion == PBIO_IMU_HEADING_TYPE_3D && fusion_mode != PBIO_IMU_HEADING_TYPE_3D) {
+        quaternion_initialized = false;
+    }
+    fusion_mode = fusion;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Gets the output data rate and which estimates are updated.
+ *
+ * @param [out] rate        Output data rate in Hz.
+ * @param [out] fusion      Which estimates are updated.
+ */
+void pbio_imu_get_mode(uint32_t *rate, pbio_imu_heading_type_t *fusion) {
+    *rate = data_rate;
+    *fusion = fusion_mode;
+}
+
+/**
+ * Restores the default output data rate and full 3D fusion. Called when the
+ * user program ends.
+ */
+void pbio_imu_reset_mode(void) {
+    pbio_imu_set_mode(PBIO_IMU_DATA_RATE_DEFAULT, PBIO_IMU_HEADING_TYPE_3D);
+}
+
 /**
  * Sets the hub base orientation.
  *
@@ -546,6 +699,7 @@ pbio_error_t pbio_imu_set_settings(pbio_imu_persistent_settings_t *new_settings)
 
     // The persistent settings have now been updated as applicable. Use the
     // complete set of settings and apply them to the driver.
+    pbio_imu_update_calibration(persistent_settings);
     pbio_imu_apply_pbdrv_settings(persistent_settings);
 
     return PBIO_SUCCESS;
@@ -661,6 +815,12 @@ pbio_geometry_side_t pbio_imu_get_up_side(bool calibrated) {
     return pbio_geometry_side_from_vector(vector);
 }
 
+/**
+ * Maximum time over which the heading is extrapolated (us). This spans a few
+ * samples at the default data rate, but not much more.
+ */
+#define PBIO_IMU_HEADING_EXTRAPOLATION_MAX_US (10000)
+
 static float heading_offset_1d = 0;
 static float heading_offset_3d = 0;
 
@@ -725,9 +885,26 @@ void pbio_imu_set_heading(float desired_heading) {
  */
 void pbio_imu_get_heading_scaled(pbio_imu_heading_type_t type, pbio_angle_t *heading, int32_t *heading_rate, int32_t ctl_steps_per_degree) {
 
+    // Heading rate in degrees per second of the robot.
+    pbio_geometry_xyz_t angular_rate;
+    pbio_imu_get_angular_velocity(&angular_rate, true);
+    float heading_rate_degrees = -angular_rate.z;
+
     // Heading in degrees of the robot.
     float heading_degrees = pbio_imu_get_heading(type);
 
+    #if PBIO_CONFIG_IMU_HEADING_EXTRAPOLATION
+    // The heading is from the most recent frame, which may be up to a sample
+    // (or a FIFO batch) older than this control step. Predict the heading at
+    // this instant using the latest rate. This is capped in case frames are
+    // not coming in, so it is never extrapolated indefinitely.
+    uint32_t elapsed_us = pbdrv_clock_get_us() - frame_time_us;
+    if (elapsed_us > PBIO_IMU_HEADING_EXTRAPOLATION_MAX_US) {
+        elapsed_us = PBIO_IMU_HEADING_EXTRAPOLATION_MAX_US;
+    }
+    heading_degrees += heading_rate_degrees * elapsed_us / 1000000.0f;
+    #endif // PBIO_CONFIG_IMU_HEADING_EXTRAPOLATION
+
     // Number of whole rotations in control units (in terms of wheels, not robot).
     heading->rotations = (int32_t)(heading_degrees / (360000.0f / ctl_steps_per_degree));
 
@@ -737,9 +914,18 @@ void pbio_imu_get_heading_scaled(pbio_imu_heading_type_t type, pbio_angle_t *hea
     heading->millidegrees = (int32_t)(truncated * ctl_steps_per_degree);
 
     // The heading rate can be obtained by a simple scale because it always fits.
-    pbio_geometry_xyz_t angular_rate;
-    pbio_imu_get_angular_velocity(&angular_rate, true);
-    *heading_rate = (int32_t)(-angular_rate.z * ctl_steps_per_degree);
+    *heading_rate = (int32_t)(heading_rate_degrees * ctl_steps_per_degree);
+}
+
+/**
+ * Gets the time at which the most recent IMU data was received. This is the
+ * time of the values returned by the other getters, so it can be used to
+ * account for their age.
+ *
+ * @return                  Time of the most recent frame (us).
+ */
+uint32_t pbio_imu_get_data_time(void) {
+    return frame_time_us;
 }
 
 /**
@@ -135,45 +135,43 @@ int32_t pbio_int_math_clamp(int32_t value, int32_t abs_max) {
  *
  * If @p n <= 0, it returns 0.
  *
+ * This uses the digit-by-digit method, which finds one bit of the result per
+ * step without division. This matters on hubs without a divide instruction.
+ *
  * @param [in]  n       The input value
- * @return              The square root.
+ * @return              The square root, rounded down.
  */
 int32_t pbio_int_math_sqrt(int32_t n) {
     if (n <= 0) {
         return 0;
     }
-    int32_t x0 = n;
-    int32_t x1;
 
-    while (true) {
-        x1 = (x0 + n / x0) / 2;
-        if (x1 == x0 || x1 == x0 + 1) {
-            return x0;
+    // Start at the highest power of four that is not greater than n.
+    uint32_t bit = 1u << ((31 - __builtin_clz(n)) & ~1);
+    uint32_t remainder = n;
+    uint32_t root = 0;
+
+    while (bit) {
+        if (remainder >= root + bit) {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
         }
-        x0 = x1;
+        bit >>= 2;
     }
+    return root;
 }
 
 /**
- * Sample points along the curve y = atan(x / 1024) * 8.
- *
- * This is used to get the atan2(b, a) curve in the first quadrant. The
- * intermediate scaling is used to avoid excessive rounding errors.
+ * Values of atan(i / 16) for i = 0 to 16, upscaled by 8 * 180 / pi (eighth of
+ * a degree).
  *
- * x = Ratios b / a, upscaled by 1024.
- * y = Matching atan(b / b) output, upscaled by 8 * 180 / pi (eighth of a degree).
+ * This covers ratios from 0 to 1, which is enough to get atan2 in all
+ * octants. The uniform spacing lets the lookup index the table directly.
  */
-static const pbio_int_math_point_t atan_points[] = {
-    { .x = 0, .y = 0 },
-    { .x = 409, .y = 178 },
-    { .x = 972, .y = 348 },
-    { .x = 1638, .y = 472 },
-    { .x = 2560, .y = 545 },
-    { .x = 3891, .y = 605 },
-    { .x = 5120, .y = 632 },
-    { .x = 7168, .y = 660 },
-    { .x = 15360, .y = 692 },
-    { .x = 25600, .y = 705 },
+static const int16_t atan_table[] = {
+    0, 29, 57, 85, 112, 139, 164, 189, 213, 235, 256, 276, 295, 313, 329, 345, 360,
 };
 
 /**
@@ -228,14 +226,33 @@ int32_t pbio_int_math_atan2(int32_t y, int32_t x) {
         return 90 * pbio_int_math_sign(y);
     }
 
-    // Get absolute ratio of y / x, upscaled to preserve resolution.
-    int32_t ratio = 1024 * y / x;
-    if (ratio < 0) {
-        ratio = -ratio;
+    // Work with the absolute values, ordered such that the ratio is at most 1.
+    uint32_t abs_x = x < 0 ? 0u - x : (uint32_t)x;
+    uint32_t abs_y = y < 0 ? 0u - y : (uint32_t)y;
+    uint32_t big = abs_x > abs_y ? abs_x : abs_y;
+    uint32_t small = abs_x > abs_y ? abs_y : abs_x;
+
+    // Scale down large inputs so the upscaled ratio below does not overflow.
+    while (big >= 1u << 21) {
+        big >>= 1;
+        small >>= 1;
+    }
+
+    // Get the ratio, upscaled by 1024, and interpolate between the two
+    // nearest table entries, which are 64 apart.
+    uint32_t ratio = small * 1024 / big;
+    uint32_t index = ratio >> 6;
+    int32_t atan = atan_table[index];
+    if (index < PBIO_ARRAY_SIZE(atan_table) - 1) {
+        atan += ((atan_table[index + 1] - atan) * (int32_t)(ratio & 63)) >> 6;
     }
 
-    // Interpolate and scale to get corresponding atan value.
-    int32_t atan = pbio_int_math_interpolate(atan_points, PBIO_ARRAY_SIZE(atan_points), ratio) / 8;
+    // Mirror around 45 degrees if the ratio was inverted, then round to
+    // degrees.
+    if (abs_y > abs_x) {
+        atan = 90 * 8 - atan;
+    }
+    atan = (atan + 4) / 8;
 
     // We took the absolute ratio, but must now account for sign.
     // So, negate if x and y had opposite sign.
@@ -300,6 +317,48 @@ int32_t pbio_int_math_mult_then_div(int32_t a, int32_t b, int32_t c) {
     return result;
 }
 
+/**
+ * Shift applied to reciprocals, so that they keep enough resolution.
+ */
+#define RECIPROCAL_SHIFT (37)
+
+/**
+ * Precomputes the reciprocal of a divisor for pbio_int_math_reciprocal_div().
+ *
+ * This costs a long division, so it pays off when dividing by the same value
+ * several times.
+ *
+ * @param [out] reciprocal  The reciprocal.
+ * @param [in]  divisor     The divisor. Its absolute value must be greater
+ *                          than 32, which keeps the multiplier in 32 bits.
+ */
+void pbio_int_math_reciprocal_init(pbio_int_math_reciprocal_t *reciprocal, int32_t divisor) {
+    uint32_t d = divisor < 0 ? 0u - divisor : (uint32_t)divisor;
+    assert(d > 32);
+    reciprocal->divisor = divisor;
+    reciprocal->multiplier = (uint32_t)((((uint64_t)1 << RECIPROCAL_SHIFT) + d - 1) / d);
+}
+
+/**
+ * Divides by multiplying with a precomputed reciprocal.
+ *
+ * Let m = (2^37 + e) / d be the multiplier, where d is the absolute divisor
+ * and 0 <= e < d. For the absolute numerator n < 2^31, the result is
+ * n * m / 2^37 = n / d + n * e / (d * 2^37), rounded down. The second term
+ * is less than n / 2^37 < 1 / 64, so the result is the truncated quotient or
+ * at most one more in absolute value. It is exact if n * e < 2^37, which
+ * holds for all n if d <= 64, and for all d if n * d <= 2^37.
+ *
+ * @param [in]  reciprocal  The reciprocal of the divisor.
+ * @param [in]  n           The numerator.
+ * @return                  Approximately n divided by the divisor, truncated.
+ */
+int32_t pbio_int_math_reciprocal_div(const pbio_int_math_reciprocal_t *reciprocal, int32_t n) {
+    uint32_t abs_n = n < 0 ? 0u - n : (uint32_t)n;
+    int32_t result = (int32_t)(((uint64_t)abs_n * reciprocal->multiplier) >> RECIPROCAL_SHIFT);
+    return (n < 0) != (reciprocal->divisor < 0) ? -result : result;
+}
+
 /**
  * Approximates first 90-degree segment of a sine in degrees, output
  * upscaled by 10000.
@@ -18,6 +18,9 @@
  */
 #define PBIO_LIGHT_ANIMATION_STOPPED ((pbio_light_animation_t *)1)
 
+/**
+ * Active animations, sorted by the time of their next frame.
+ */
 static pbio_light_animation_t *pbio_light_animation_list_head;
 
 /**
@@ -30,12 +33,39 @@ void pbio_light_animation_init(pbio_light_animation_t *animation, pbio_light_ani
     animation->next_animation = PBIO_LIGHT_ANIMATION_STOPPED;
 }
 
+/**
+ * Inserts an animation in the active list, after all animations whose next
+ * frame is due at the same time or earlier.
+ *
+ * @param [in]  animation       The animation instance
+ */
+static void pbio_light_animation_insert(pbio_light_animation_t *animation) {
+    uint32_t deadline = animation->timer.start + animation->timer.duration;
+
+    pbio_light_animation_t **link = &pbio_light_animation_list_head;
+    while (*link && pbio_util_time_has_passed(deadline, (*link)->timer.start + (*link)->timer.duration)) {
+        link = &(*link)->next_animation;
+    }
+    animation->next_animation = *link;
+    *link = animation;
+}
+
 static pbio_error_t pbio_light_animation_poll_handler(pbio_os_state_t *state, void *context) {
-    // For every active animation, go to the next frame if timer expired.
-    for (pbio_light_animation_t *a = pbio_light_animation_list_head; a != NULL; a = a->next_animation) {
-        if (pbio_os_timer_is_expired(&a->timer)) {
-            pbio_os_timer_set(&a->timer, a->next(a));
-        }
+    // Since the list is sorted, the expired animations are at the start and
+    // usually only the first timer needs to be checked.
+    uint32_t expired = 0;
+    for (pbio_light_animation_t *a = pbio_light_animation_list_head; a != NULL && pbio_os_timer_is_expired(&a->timer); a = a->next_animation) {
+        expired++;
+    }
+
+    // Go to the next frame of each expired animation and move it to its new
+    // place in the list. It goes after any other expired animations, so each
+    // one runs only once even if it returns a delay of 0.
+    while (expired--) {
+        pbio_light_animation_t *a = pbio_light_animation_list_head;
+        pbio_light_animation_list_head = a->next_animation;
+        pbio_os_timer_set(&a->timer, a->next(a));
+        pbio_light_animation_insert(a);
     }
     return PBIO_ERROR_AGAIN;
 }
@@ -53,9 +83,9 @@ static pbio_error_t pbio_light_animation_poll_handler(pbio_os_state_t *state, vo
 void pbio_light_animation_start(pbio_light_animation_t *animation) {
     assert(animation->next_animation == PBIO_LIGHT_ANIMATION_STOPPED);
 
-    // Insert at head of active list.
-    animation->next_animation = pbio_light_animation_list_head;
-    pbio_light_animation_list_head = animation;
+    // Fake a timer event to load the first cell.
+    pbio_os_timer_set(&animation->timer, 0);
+    pbio_light_animation_insert(animation);
 
     // Start process if it wasn't running already.
     static pbio_os_process_t animation_process;
@@ -63,8 +93,6 @@ void pbio_light_animation_start(pbio_light_animation_t *animation) {
         pbio_os_process_start(&animation_process, pbio_light_animation_poll_handler, NULL);
     }
 
-    // Fake a timer event to load the first cell.
-    pbio_os_timer_set(&animation->timer, 0);
     pbio_os_request_poll();
 
     assert(animation->next_animation != PBIO_LIGHT_ANIMATION_STOPPED);
@@ -7,6 +7,8 @@
 
 #include <stdbool.h>
 
+#include <pbdrv/pwm.h>
+
 #include <pbio/error.h>
 #include <pbio/light_matrix.h>
 #include <pbio/util.h>
@@ -109,6 +111,8 @@ static pbio_error_t _pbio_light_matrix_set_pixel(pbio_light_matrix_t *light_matr
  */
 void pbio_light_matrix_set_orientation(pbio_light_matrix_t *light_matrix, pbio_geometry_side_t up_side) {
     light_matrix->up_side = up_side;
+    // Pixels move, so the next animation cell must be drawn in full.
+    light_matrix->previous_cell = NULL;
 }
 
 /**
@@ -135,15 +139,15 @@ uint8_t pbio_light_matrix_get_size(pbio_light_matrix_t *light_matrix) {
  */
 pbio_error_t pbio_light_matrix_clear(pbio_light_matrix_t *light_matrix) {
     pbio_light_matrix_stop_animation(light_matrix);
-    for (uint8_t i = 0; i < light_matrix->size; i++) {
-        for (uint8_t j = 0; j < light_matrix->size; j++) {
-            pbio_error_t err = _pbio_light_matrix_set_pixel(light_matrix, i, j, 0);
-            if (err != PBIO_SUCCESS) {
-                return err;
-            }
+    pbio_error_t err = PBIO_SUCCESS;
+    pbdrv_pwm_batch_begin();
+    for (uint8_t i = 0; i < light_matrix->size && err == PBIO_SUCCESS; i++) {
+        for (uint8_t j = 0; j < light_matrix->size && err == PBIO_SUCCESS; j++) {
+            err = _pbio_light_matrix_set_pixel(light_matrix, i, j, 0);
         }
     }
-    return PBIO_SUCCESS;
+    pbdrv_pwm_batch_end();
+    return err;
 }
 
 /**
@@ -165,21 +169,22 @@ pbio_error_t pbio_light_matrix_clear(pbio_light_matrix_t *light_matrix) {
  */
 pbio_error_t pbio_light_matrix_set_rows(pbio_light_matrix_t *light_matrix, const uint8_t *rows) {
     pbio_light_matrix_stop_animation(light_matrix);
+    pbio_error_t err = PBIO_SUCCESS;
+    // Send all pixels to the driver in one update.
+    pbdrv_pwm_batch_begin();
     // Loop through all rows i, starting at row 0 at the top.
     uint8_t size = light_matrix->size;
-    for (uint8_t i = 0; i < size; i++) {
+    for (uint8_t i = 0; i < size && err == PBIO_SUCCESS; i++) {
         // Loop through all columns j, starting at col 0 on the left.
-        for (uint8_t j = 0; j < size; j++) {
+        for (uint8_t j = 0; j < size && err == PBIO_SUCCESS; j++) {
             // The pixel is on if the bit is high.
             bool on = rows[i] & (1 << (size - 1 - j));
             // Set the pixel.
-            pbio_error_t err = _pbio_light_matrix_set_pixel(light_matrix, i, j, on * 100);
-            if (err != PBIO_SUCCESS) {
-                return err;
-            }
+            err = _pbio_light_matrix_set_pixel(light_matrix, i, j, on * 100);
         }
     }
-    return PBIO_SUCCESS;
+    pbdrv_pwm_batch_end();
+    return err;
 }
 
 /**
@@ -227,16 +232,16 @@ pbio_error_t pbio_light_matrix_set_pixel(pbio_light_matrix_t *light_matrix, uint
  */
 pbio_error_t pbio_light_matrix_set_image(pbio_light_matrix_t *light_matrix, const uint8_t *image) {
     pbio_light_matrix_stop_animation(light_matrix);
+    pbio_error_t err = PBIO_SUCCESS;
+    pbdrv_pwm_batch_begin();
     uint8_t size = light_matrix->size;
-    for (uint8_t r = 0; r < size; r++) {
-        for (uint8_t c = 0; c < size; c++) {
-            pbio_error_t err = _pbio_light_matrix_set_pixel(light_matrix, r, c, image[r * size + c]);
-            if (err != PBIO_SUCCESS) {
-                return err;
-            }
+    for (uint8_t r = 0; r < size && err == PBIO_SUCCESS; r++) {
+        for (uint8_t c = 0; c < size && err == PBIO_SUCCESS; c++) {
+            err = _pbio_light_matrix_set_pixel(light_matrix, r, c, image[r * size + c]);
         }
     }
-    return PBIO_SUCCESS;
+    pbdrv_pwm_batch_end();
+    return err;
 }
 
 static uint32_t pbio_light_matrix_animation_next(pbio_light_animation_t *animation) {
@@ -245,12 +250,19 @@ static uint32_t pbio_light_matrix_animation_next(pbio_light_animation_t *animati
     // display the current cell
     uint8_t size = light_matrix->size;
     const uint8_t *cell = light_matrix->animation_cells + size * size * light_matrix->current_cell;
+    const uint8_t *previous = light_matrix->previous_cell;
 
+    // Only update pixels that differ from the previous cell.
+    pbdrv_pwm_batch_begin();
     for (uint8_t r = 0; r < size; r++) {
         for (uint8_t c = 0; c < size; c++) {
-            _pbio_light_matrix_set_pixel(light_matrix, r, c, cell[r * size + c]);
+            if (!previous || previous[r * size + c] != cell[r * size + c]) {
+                _pbio_light_matrix_set_pixel(light_matrix, r, c, cell[r * size + c]);
+            }
         }
     }
+    pbdrv_pwm_batch_end();
+    light_matrix->previous_cell = cell;
 
     // move to the next cell
     if (++light_matrix->current_cell >= light_matrix->num_animation_cells) {
@@ -278,6 +290,61 @@ void pbio_light_matrix_start_animation(pbio_light_matrix_t *light_matrix, const
     light_matrix->num_animation_cells = num_cells;
     light_matrix->interval = interval;
     light_matrix->current_cell = 0;
+    light_matrix->previous_cell = NULL;
+
+    pbio_light_animation_start(&light_matrix->animation);
+}
+
+static uint32_t pbio_light_matrix_scroll_next(pbio_light_animation_t *animation) {
+    pbio_light_matrix_t *light_matrix = PBIO_CONTAINER_OF(animation, pbio_light_matrix_t, animation);
+
+    // Draw the window of columns starting at the current offset, wrapping
+    // around to the start of the buffer so the text scrolls continuously.
+    uint8_t size = light_matrix->size;
+    uint16_t index = light_matrix->scroll_offset;
+    pbdrv_pwm_batch_begin();
+    for (uint8_t c = 0; c < size; c++) {
+        uint8_t column = light_matrix->scroll_columns[index];
+        for (uint8_t r = 0; r < size; r++) {
+            _pbio_light_matrix_set_pixel(light_matrix, r, c, (column & (1 << r)) ? 100 : 0);
+        }
+        if (++index >= light_matrix->num_scroll_columns) {
+            index = 0;
+        }
+    }
+    pbdrv_pwm_batch_end();
+
+    // Shift one column to the left on the next update.
+    if (++light_matrix->scroll_offset >= light_matrix->num_scroll_columns) {
+        light_matrix->scroll_offset = 0;
+    }
+
+    return light_matrix->interval;
+}
+
+/**
+ * Starts scrolling pre-rendered columns across the light matrix in the background.
+ *
+ * Each update shifts the display one column to the left. After the last
+ * column, the display wraps around to the first column.
+ *
+ * If another animation is already running in the background, it will be stopped.
+ *
+ * @param [in]  light_matrix  The light matrix instance
+ * @param [in]  columns     Array of columns. Bit r of each byte is row r, starting at the top.
+ * @param [in]  num_columns Number of @p columns. Must be at least 1.
+ * @param [in]  interval    Time in milliseconds to wait between each shift.
+ */
+void pbio_light_matrix_start_scroll(pbio_light_matrix_t *light_matrix, const uint8_t *columns, uint16_t num_columns, uint16_t interval) {
+    pbio_light_matrix_stop_animation(light_matrix);
+
+    pbio_light_animation_init(&light_matrix->animation, pbio_light_matrix_scroll_next);
+    light_matrix->scroll_columns = columns;
+    light_matrix->num_scroll_columns = num_columns;
+    light_matrix->scroll_offset = 0;
+    light_matrix->interval = interval;
+    // Scrolling draws all pixels, so the next regular animation must too.
+    light_matrix->previous_cell = NULL;
 
     pbio_light_animation_start(&light_matrix->animation);
 }
@@ -22,10 +22,14 @@
  * @param [in]  num_rows    Maximum number of rows that can be logged.
  * @param [in]  num_cols    Number of entries in one row.
  * @param [in]  down_sample For every @p down_sample of update calls, only one row is logged.
+ * @param [in]  mode        What to do when the buffer is full.
  */
-void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t num_rows, uint8_t num_cols, int32_t down_sample) {
+void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t num_rows, uint8_t num_cols, int32_t down_sample, pbio_logger_mode_t mode) {
     // (re-)initialize logger status.
+    log->mode = mode;
     log->num_rows_used = 0;
+    log->first_row = 0;
+    log->num_rows_lost = 0;
     log->skipped_samples = 0;
     log->data = buf;
     log->num_rows = num_rows;
@@ -70,18 +74,29 @@ void pbio_logger_add_row(pbio_log_t *log, const int32_t *row_data) {
     }
     log->skipped_samples = 0;
 
-    // Exit if log is full.
+    // Exit if log is full, or drop the oldest row in circular mode.
     if (log->num_rows_used >= log->num_rows) {
-        log->active = false;
-        return;
+        if (log->mode != PBIO_LOGGER_MODE_CIRCULAR || log->num_rows == 0) {
+            log->active = false;
+            return;
+        }
+        pbio_logger_discard_rows(log, 1);
+        log->num_rows_lost++;
+    }
+
+    // Get the next free row, wrapping around in circular mode.
+    uint32_t index = log->first_row + log->num_rows_used;
+    if (index >= log->num_rows) {
+        index -= log->num_rows;
     }
+    int32_t *row = log->data + index * log->num_cols;
 
     // Write time of logging.
-    log->data[log->num_rows_used * log->num_cols] = pbdrv_clock_get_ms() - log->start_time;
+    row[0] = pbdrv_clock_get_ms() - log->start_time;
 
     // Write the data.
     for (uint8_t i = PBIO_LOGGER_NUM_DEFAULT_COLS; i < log->num_cols; i++) {
-        log->data[log->num_rows_used * log->num_cols + i] = row_data[i - PBIO_LOGGER_NUM_DEFAULT_COLS];
+        row[i] = row_data[i - PBIO_LOGGER_NUM_DEFAULT_COLS];
     }
 
     // Increment used row counter.
@@ -104,10 +119,45 @@ uint32_t pbio_logger_get_num_rows_used(const pbio_log_t *log) {
  * Gets row from the log. Caller must ensure that valid index is used.
  *
  * @param [in]  log         Pointer to log.
+ * @param [in]  index       Index of the row, where 0 is the oldest row.
  * @return                  Pointer to row data.
  */
 int32_t *pbio_logger_get_row_data(const pbio_log_t *log, uint32_t index) {
+    index += log->first_row;
+    if (index >= log->num_rows) {
+        index -= log->num_rows;
+    }
     return log->data + index * log->num_cols;
 }
 
+/**
+ * Discards the oldest rows, such as after they have been streamed out.
+ *
+ * This frees up space for new rows in circular mode, while logging continues.
+ *
+ * @param [in]  log         Pointer to log.
+ * @param [in]  num_rows    Number of rows to discard.
+ */
+void pbio_logger_discard_rows(pbio_log_t *log, uint32_t num_rows) {
+    if (num_rows > log->num_rows_used) {
+        num_rows = log->num_rows_used;
+    }
+    log->num_rows_used -= num_rows;
+    log->first_row += num_rows;
+    if (log->first_row >= log->num_rows) {
+        log->first_row -= log->num_rows;
+    }
+}
+
+/**
+ * Gets the number of rows that were overwritten in circular mode before they
+ * could be consumed.
+ *
+ * @param [in]  log         Pointer to log.
+ * @return                  Number of lost rows.
+ */
+uint32_t pbio_logger_get_num_rows_lost(const pbio_log_t *log) {
+    return log->num_rows_lost;
+}
+
 #endif // PBIO_CONFIG_LOGGER
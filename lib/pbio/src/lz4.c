@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <string.h>
+
+#include <pbio/error.h>
+#include <pbio/lz4.h>
+#include <pbio/util.h>
+
+/**
+ * Length field value that means that more length bytes follow.
+ */
+#define PBIO_LZ4_LENGTH_EXTENDED (15)
+
+/**
+ * Matches are always at least this long, so this is not encoded.
+ */
+#define PBIO_LZ4_MIN_MATCH (4)
+
+/**
+ * The last bytes of a block are always literals.
+ */
+#define PBIO_LZ4_LAST_LITERALS (5)
+
+/**
+ * The last match must start at least this many bytes before the end of a block.
+ */
+#define PBIO_LZ4_MATCH_LIMIT (12)
+
+/**
+ * Encoder hash table entry that does not refer to any data.
+ */
+#define PBIO_LZ4_TABLE_EMPTY (UINT16_MAX)
+
+/**
+ * Initializes a decoder for a new stream.
+ *
+ * @param [in]  decoder     The decoder.
+ * @param [in]  out         Buffer for the decoded data.
+ * @param [in]  out_size    Size of @p out.
+ */
+void pbio_lz4_decoder_init(pbio_lz4_decoder_t *decoder, uint8_t *out, uint32_t out_size) {
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->out = out;
+    decoder->out_size = out_size;
+}
+
+/**
+ * Copies a complete match and starts the next sequence.
+ *
+ * @param [in]  decoder     The decoder.
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if the match does not fit
+ *                          in the output buffer, otherwise ::PBIO_SUCCESS.
+ */
+static pbio_error_t pbio_lz4_copy_match(pbio_lz4_decoder_t *decoder) {
+    uint32_t size = decoder->length + PBIO_LZ4_MIN_MATCH;
+    if (size > decoder->out_size - decoder->out_pos) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // Matches may overlap the data they produce, so copy byte by byte.
+    uint8_t *dst = decoder->out + decoder->out_pos;
+    const uint8_t *src = dst - decoder->offset;
+    for (uint32_t i = 0; i < size; i++) {
+        dst[i] = src[i];
+    }
+
+    decoder->out_pos += size;
+    decoder->state = PBIO_LZ4_STATE_TOKEN;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Decodes the next chunk of a compressed stream.
+ *
+ * Chunks may be split anywhere, including inside a sequence.
+ *
+ * @param [in]  decoder     The decoder.
+ * @param [in]  data        The next compressed data.
+ * @param [in]  size        Size of @p data.
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if the data is invalid or
+ *                          does not fit in the output buffer, otherwise
+ *                          ::PBIO_SUCCESS.
+ */
+pbio_error_t pbio_lz4_decode(pbio_lz4_decoder_t *decoder, const uint8_t *data, uint32_t size) {
+
+    const uint8_t *end = data + size;
+
+    while (data < end) {
+        switch (decoder->state) {
+            case PBIO_LZ4_STATE_TOKEN:
+                decoder->token = *data++;
+                decoder->length = decoder->token >> 4;
+                decoder->state = decoder->length == PBIO_LZ4_LENGTH_EXTENDED ?
+                    PBIO_LZ4_STATE_LITERAL_LENGTH : PBIO_LZ4_STATE_LITERALS;
+                break;
+            case PBIO_LZ4_STATE_LITERAL_LENGTH:
+                decoder->length += *data;
+                if (*data++ != UINT8_MAX) {
+                    decoder->state = PBIO_LZ4_STATE_LITERALS;
+                }
+                break;
+            case PBIO_LZ4_STATE_LITERALS: {
+                uint32_t count = decoder->length;
+                if (count > (uint32_t)(end - data)) {
+                    count = end - data;
+                }
+                if (count > decoder->out_size - decoder->out_pos) {
+                    return PBIO_ERROR_INVALID_ARG;
+                }
+                memcpy(decoder->out + decoder->out_pos, data, count);
+                decoder->out_pos += count;
+                decoder->length -= count;
+                data += count;
+                if (decoder->length == 0) {
+                    decoder->state = PBIO_LZ4_STATE_OFFSET_LOW;
+                }
+                break;
+            }
+            case PBIO_LZ4_STATE_OFFSET_LOW:
+                decoder->offset = *data++;
+                decoder->state = PBIO_LZ4_STATE_OFFSET_HIGH;
+                break;
+            case PBIO_LZ4_STATE_OFFSET_HIGH:
+                decoder->offset |= *data++ << 8;
+                if (decoder->offset == 0 || decoder->offset > decoder->out_pos) {
+                    return PBIO_ERROR_INVALID_ARG;
+                }
+                decoder->length = decoder->token & 0x0f;
+                if (decoder->length == PBIO_LZ4_LENGTH_EXTENDED) {
+                    decoder->state = PBIO_LZ4_STATE_MATCH_LENGTH;
+                    break;
+                }
+                if (pbio_lz4_copy_match(decoder) != PBIO_SUCCESS) {
+                    return PBIO_ERROR_INVALID_ARG;
+                }
+                break;
+            case PBIO_LZ4_STATE_MATCH_LENGTH:
+                decoder->length += *data;
+                if (*data++ == UINT8_MAX) {
+                    break;
+                }
+                if (pbio_lz4_copy_match(decoder) != PBIO_SUCCESS) {
+                    return PBIO_ERROR_INVALID_ARG;
+                }
+                break;
+        }
+    }
+
+    decoder->in_pos += size;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Initializes an encoder for a new stream.
+ *
+ * @param [in]  encoder         The encoder.
+ * @param [in]  history         Buffer for recently encoded data. Larger buffers
+ *                              find more matches.
+ * @param [in]  history_size    Size of @p history. At most 64K.
+ */
+void pbio_lz4_encoder_init(pbio_lz4_encoder_t *encoder, uint8_t *history, uint32_t history_size) {
+    encoder->history = history;
+    encoder->history_size = history_size < UINT16_MAX ? history_size : UINT16_MAX;
+    encoder->history_len = 0;
+    memset(encoder->table, 0xff, sizeof(encoder->table));
+}
+
+/**
+ * Drops the oldest data from the history to make room for new data.
+ *
+ * @param [in]  encoder     The encoder.
+ * @param [in]  size        Minimum number of bytes to drop.
+ */
+static void pbio_lz4_encoder_discard(pbio_lz4_encoder_t *encoder, uint32_t size) {
+    // Drop a good amount at once, so data isn't moved on every call.
+    if (size < encoder->history_size / 4) {
+        size = encoder->history_size / 4;
+    }
+    if (size > encoder->history_len) {
+        size = encoder->history_len;
+    }
+
+    encoder->history_len -= size;
+    memmove(encoder->history, encoder->history + size, encoder->history_len);
+
+    for (uint32_t i = 0; i < PBIO_ARRAY_SIZE(encoder->table); i++) {
+        if (encoder->table[i] == PBIO_LZ4_TABLE_EMPTY || encoder->table[i] < size) {
+            encoder->table[i] = PBIO_LZ4_TABLE_EMPTY;
+        } else {
+            encoder->table[i] -= size;
+        }
+    }
+}
+
+/**
+ * Gets the hash table index for the four bytes at the given position.
+ */
+static uint32_t pbio_lz4_hash(const uint8_t *data) {
+    uint32_t value = data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+    return (value * 2654435761u) >> (32 - PBIO_LZ4_ENCODER_HASH_BITS);
+}
+
+/**
+ * Gets the number of extra bytes needed to encode a literal or match length.
+ */
+static uint32_t pbio_lz4_length_size(uint32_t length) {
+    if (length < PBIO_LZ4_LENGTH_EXTENDED) {
+        return 0;
+    }
+    return 1 + (length - PBIO_LZ4_LENGTH_EXTENDED) / UINT8_MAX;
+}
+
+/**
+ * Writes the extra bytes of a literal or match length, if any.
+ */
+static uint8_t *pbio_lz4_write_length(uint8_t *out, uint32_t length) {
+    if (length < PBIO_LZ4_LENGTH_EXTENDED) {
+        return out;
+    }
+    for (length -= PBIO_LZ4_LENGTH_EXTENDED; length >= UINT8_MAX; length -= UINT8_MAX) {
+        *out++ = UINT8_MAX;
+    }
+    *out++ = length;
+    return out;
+}
+
+/**
+ * Writes one sequence of literals, optionally followed by a match.
+ *
+ * @param [in]  out             Where to write the sequence.
+ * @param [in]  literals        The literals.
+ * @param [in]  literal_length  Number of literals.
+ * @param [in]  offset          Match offset, or 0 for a final sequence without a match.
+ * @param [in]  match_length    Match length, including ::PBIO_LZ4_MIN_MATCH.
+ * @returns                     Where to write the next sequence.
+ */
+static uint8_t *pbio_lz4_write_sequence(uint8_t *out, const uint8_t *literals, uint32_t literal_length, uint32_t offset, uint32_t match_length) {
+    uint32_t match_extra = offset ? match_length - PBIO_LZ4_MIN_MATCH : 0;
+
+    *out++ = (literal_length < PBIO_LZ4_LENGTH_EXTENDED ? literal_length : PBIO_LZ4_LENGTH_EXTENDED) << 4 |
+        (match_extra < PBIO_LZ4_LENGTH_EXTENDED ? match_extra : PBIO_LZ4_LENGTH_EXTENDED);
+    out = pbio_lz4_write_length(out, literal_length);
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+
+    if (!offset) {
+        return out;
+    }
+    *out++ = offset & 0xff;
+    *out++ = offset >> 8;
+    return pbio_lz4_write_length(out, match_extra);
+}
+
+/**
+ * Encodes as much data as fits into one LZ4 block.
+ *
+ * Matches may refer to data encoded in earlier blocks, so blocks must be
+ * decoded in order, each with all previous output as the dictionary.
+ *
+ * @param [in]    encoder   The encoder.
+ * @param [in]    data      The data to encode.
+ * @param [inout] size      Size of @p data. On return, the number of bytes
+ *                          that were encoded. The rest should be passed
+ *                          again on the next call.
+ * @param [in]    out       Buffer for the encoded block.
+ * @param [in]    out_size  Size of @p out.
+ * @returns                 Size of the encoded block, or 0 if nothing fits.
+ */
+uint32_t pbio_lz4_encode(pbio_lz4_encoder_t *encoder, const uint8_t *data, uint32_t *size, uint8_t *out, uint32_t out_size) {
+
+    // Copy the new data after the history, so matches can be found in both.
+    uint32_t in_size = *size < encoder->history_size / 2 ? *size : encoder->history_size / 2;
+    if (encoder->history_len + in_size > encoder->history_size) {
+        pbio_lz4_encoder_discard(encoder, encoder->history_len + in_size - encoder->history_size);
+    }
+    uint8_t *base = encoder->history;
+    uint32_t start = encoder->history_len;
+    uint32_t end = start + in_size;
+    memcpy(base + start, data, in_size);
+
+    uint8_t *dst = out;
+    uint8_t *dst_end = out + out_size;
+    uint32_t anchor = start;
+    uint32_t min_literals = 0;
+
+    for (uint32_t pos = start; pos + PBIO_LZ4_MATCH_LIMIT <= end;) {
+
+        uint32_t hash = pbio_lz4_hash(base + pos);
+        uint32_t candidate = encoder->table[hash];
+        encoder->table[hash] = pos;
+
+        // Entries beyond the current position are left from data that did
+        // not fit in a previous block, so those are not valid.
+        if (candidate >= pos || memcmp(base + candidate, base + pos, PBIO_LZ4_MIN_MATCH)) {
+            pos++;
+            continue;
+        }
+
+        // Extend the match, but keep the last bytes as literals.
+        uint32_t length = PBIO_LZ4_MIN_MATCH;
+        while (pos + length < end - PBIO_LZ4_LAST_LITERALS && base[candidate + length] == base[pos + length]) {
+            length++;
+        }
+
+        // Only add the match if there is still room to end the block with
+        // enough literals after it.
+        uint32_t literals = pos - anchor;
+        uint32_t end_literals = PBIO_LZ4_MATCH_LIMIT > length + PBIO_LZ4_LAST_LITERALS ?
+            PBIO_LZ4_MATCH_LIMIT - length : PBIO_LZ4_LAST_LITERALS;
+        uint32_t cost = 1 + pbio_lz4_length_size(literals) + literals + 2 + pbio_lz4_length_size(length - PBIO_LZ4_MIN_MATCH);
+        if (cost + 1 + end_literals > (uint32_t)(dst_end - dst)) {
+            break;
+        }
+
+        dst = pbio_lz4_write_sequence(dst, base + anchor, literals, pos - candidate, length);
+        pos += length;
+        anchor = pos;
+        min_literals = end_literals;
+    }
+
+    // End the block with as many of the remaining literals as fit.
+    uint32_t room = dst_end - dst;
+    uint32_t literals = end - anchor;
+    while (literals > min_literals && 1 + pbio_lz4_length_size(literals) + literals > room) {
+        literals--;
+    }
+    if (room == 0 || (dst == out && literals == 0)) {
+        *size = 0;
+        return 0;
+    }
+    dst = pbio_lz4_write_sequence(dst, base + anchor, literals, 0, 0);
+
+    // Keep only what was encoded. The rest is passed again next time.
+    encoder->history_len = anchor + literals;
+    *size = encoder->history_len - start;
+    return dst - out;
+}
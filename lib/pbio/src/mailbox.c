@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <string.h>
+
+#include <pbio/error.h>
+#include <pbio/mailbox.h>
+#include <pbio/util.h>
+
+/**
+ * Command type of a system command that expects no reply.
+ */
+#define PBIO_MAILBOX_SYSTEM_COMMAND_NO_REPLY (0x81)
+
+/**
+ * System command to write a mailbox.
+ */
+#define PBIO_MAILBOX_WRITE_MAILBOX (0x9E)
+
+/**
+ * Initializes a writer with an empty buffer.
+ *
+ * @param [in]  writer      The writer.
+ * @param [in]  buf         Buffer for the encoded messages.
+ * @param [in]  size        Size of @p buf.
+ */
+void pbio_mailbox_writer_init(pbio_mailbox_writer_t *writer, uint8_t *buf, uint32_t size) {
+    memset(writer, 0, sizeof(*writer));
+    writer->buf = buf;
+    writer->size = size;
+}
+
+/**
+ * Empties the buffer, typically after its messages have been sent. The message
+ * counter keeps counting.
+ *
+ * @param [in]  writer      The writer.
+ */
+void pbio_mailbox_writer_reset(pbio_mailbox_writer_t *writer) {
+    writer->len = 0;
+    writer->num_messages = 0;
+}
+
+/**
+ * Appends a message to the buffer.
+ *
+ * @param [in]  writer      The writer.
+ * @param [in]  name        Zero terminated name of the mailbox.
+ * @param [in]  value       Value of the message.
+ * @param [in]  value_size  Size of @p value.
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if the name is too long or
+ *                          the message does not fit in an empty buffer,
+ *                          ::PBIO_ERROR_AGAIN if it does not fit in the
+ *                          remaining space so the buffer should be sent
+ *                          first, otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbio_mailbox_write(pbio_mailbox_writer_t *writer, const char *name, const uint8_t *value, uint16_t value_size) {
+
+    size_t name_len = strlen(name);
+    if (name_len > PBIO_MAILBOX_NAME_LEN_MAX) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // The size field counts the bytes that follow it.
+    uint32_t size = PBIO_MAILBOX_MESSAGE_OVERHEAD + name_len + value_size;
+    if (size - 2 > UINT16_MAX || size > writer->size) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    if (size > writer->size - writer->len) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    uint8_t *buf = &writer->buf[writer->len];
+    pbio_set_uint16_le(&buf[0], size - 2);
+    pbio_set_uint16_le(&buf[2], writer->counter);
+    buf[4] = PBIO_MAILBOX_SYSTEM_COMMAND_NO_REPLY;
+    buf[5] = PBIO_MAILBOX_WRITE_MAILBOX;
+    buf[6] = name_len + 1;
+    memcpy(&buf[7], name, name_len + 1);
+    pbio_set_uint16_le(&buf[8 + name_len], value_size);
+    memcpy(&buf[10 + name_len], value, value_size);
+
+    writer->len += size;
+    writer->num_messages++;
+    writer->counter++;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Reads the next message from received data.
+ *
+ * @param [in]  data        The received data.
+ * @param [in]  size        Size of @p data.
+ * @param [in]  offset      Offset of the message in @p data. On success, this
+ *                          is advanced to the next message.
+ * @param [out] message     The message, pointing into @p data.
+ * @returns                 ::PBIO_ERROR_AGAIN if @p data ends before the end
+ *                          of the message, ::PBIO_ERROR_INVALID_ARG if it is
+ *                          not a valid mailbox message, otherwise
+ *                          ::PBIO_SUCCESS.
+ */
+pbio_error_t pbio_mailbox_read(const uint8_t *data, uint32_t size, uint32_t *offset, pbio_mailbox_message_t *message) {
+
+    if (*offset > size || size - *offset < 2) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    const uint8_t *buf = &data[*offset];
+    uint32_t message_size = pbio_get_uint16_le(&buf[0]) + 2;
+    if (message_size > size - *offset) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    // Check the header and that the name and value fit in the message.
+    if (message_size < PBIO_MAILBOX_MESSAGE_OVERHEAD ||
+        buf[4] != PBIO_MAILBOX_SYSTEM_COMMAND_NO_REPLY ||
+        buf[5] != PBIO_MAILBOX_WRITE_MAILBOX) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    uint32_t name_size = buf[6];
+    if (name_size == 0 || PBIO_MAILBOX_MESSAGE_OVERHEAD - 1 + name_size > message_size ||
+        buf[6 + name_size] != '\0') {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    uint16_t value_size = pbio_get_uint16_le(&buf[7 + name_size]);
+    if (PBIO_MAILBOX_MESSAGE_OVERHEAD - 1 + name_size + value_size != message_size) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    message->counter = pbio_get_uint16_le(&buf[2]);
+    message->name = (const char *)&buf[7];
+    message->value = &buf[9 + name_size];
+    message->value_size = value_size;
+
+    *offset += message_size;
+    return PBIO_SUCCESS;
+}
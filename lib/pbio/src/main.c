@@ -4,6 +4,7 @@
 #include <stdbool.h>
 
 #include <pbdrv/bluetooth.h>
+#include <pbdrv/clock.h>
 #include <pbdrv/display.h>
 #include <pbdrv/sound.h>
 
@@ -11,7 +12,9 @@
 #include <pbio/image.h>
 #include <pbio/imu.h>
 #include <pbio/light_animation.h>
+#include <pbio/main.h>
 #include <pbio/motor_process.h>
+#include <pbio/pf_ir.h>
 #include <pbio/port_interface.h>
 
 #define DEBUG 0
@@ -23,6 +26,37 @@
 #define DEBUG_PRINT(...)
 #endif
 
+/**
+ * Time since the clock started at which each boot phase completed, or 0 if
+ * not yet completed.
+ */
+static uint32_t boot_phase_time[PBIO_MAIN_BOOT_PHASE_NUM];
+
+/**
+ * Records the completion time of a boot phase. Only the first completion is
+ * recorded, so this may be called again when a phase is repeated, such as on
+ * a Bluetooth reset.
+ *
+ * @param [in]  phase   The boot phase.
+ */
+void pbio_main_boot_phase_done(pbio_main_boot_phase_t phase) {
+    if (boot_phase_time[phase] == 0) {
+        // Keep 0 reserved for phases that are not done.
+        boot_phase_time[phase] = pbdrv_clock_get_us() | 1;
+    }
+}
+
+/**
+ * Gets the completion time of a boot phase.
+ *
+ * @param [in]  phase   The boot phase.
+ * @return              Time in microseconds since the clock started, or 0 if
+ *                      the phase has not completed yet.
+ */
+uint32_t pbio_main_get_boot_phase_time(pbio_main_boot_phase_t phase) {
+    return boot_phase_time[phase];
+}
+
 /**
  * Initialize the Pybricks I/O Library. This function must be called once,
  * usually at the beginning of a program, before using any other functions in
@@ -68,6 +102,9 @@ void pbio_main_start_application_resources(void) {
     // Reset IMU heading to zero at the start of each application for
     // consistency, so that absolute drive base headings are the same each time.
     pbio_imu_set_heading(0.0f);
+
+    // Count the battery charge used by each application separately.
+    pbio_battery_set_program_running(true);
 }
 
 /**
@@ -81,7 +118,10 @@ void pbio_main_start_application_resources(void) {
  */
 pbio_error_t pbio_main_stop_application_resources(void) {
 
+    pbio_battery_set_program_running(false);
     pbio_port_stop_user_actions(true);
+    pbio_pf_ir_reset();
+    pbio_imu_reset_mode();
     pbio_main_soft_stop();
 
     pbio_error_t err;
@@ -14,148 +14,365 @@
 #include <pbio/servo.h>
 #include <pbio/util.h>
 
-// Model settings auto-generated by pbio/doc/control/motor_data.py
+// Model settings auto-generated by pbio/doc/control/motor_data.py, for each
+// supported control loop time.
+#if PBIO_CONFIG_CONTROL_LOOP_TIME_MS == 5
+
+#if PBIO_CONFIG_SERVO_PUP
+
+static const pbio_observer_model_t model_technic_s_angular = {
+    .d_angle_d_speed = 80321,
+    .d_speed_d_speed = 15054244,
+    .d_current_d_speed = -57753,
+    .d_angle_d_current = 615774,
+    .d_speed_d_current = 156652788,
+    .d_current_d_current = -128361,
+    .d_angle_d_voltage = 530932,
+    .d_speed_d_voltage = 256572664,
+    .d_current_d_voltage = 8600232,
+    .d_angle_d_torque = -84570,
+    .d_speed_d_torque = -33194742,
+    .d_current_d_torque = 93822,
+    .d_voltage_d_torque = 1612802,
+    .d_torque_d_voltage = 174525392,
+    .d_torque_d_speed = 1171997,
+    .d_torque_d_acceleration = 40596,
+    .torque_friction = 9182,
+};
+
+static const pbio_observer_model_t model_technic_m_angular = {
+    .d_angle_d_speed = 81238,
+    .d_speed_d_speed = 15414743,
+    .d_current_d_speed = -87230,
+    .d_angle_d_current = 498866,
+    .d_speed_d_current = 144498356,
+    .d_current_d_current = 1135079,
+    .d_angle_d_voltage = 404006,
+    .d_speed_d_voltage = 207860734,
+    .d_current_d_voltage = 13307854,
+    .d_angle_d_torque = -39188,
+    .d_speed_d_torque = -15447636,
+    .d_current_d_torque = 57265,
+    .d_voltage_d_torque = 756640,
+    .d_torque_d_voltage = 372006358,
+    .d_torque_d_speed = 2438404,
+    .d_torque_d_acceleration = 88230,
+    .torque_friction = 21413,
+};
+
+static const pbio_observer_model_t model_technic_l_angular = {
+    .d_angle_d_speed = 82283,
+    .d_speed_d_speed = 15918785,
+    .d_current_d_speed = -247996,
+    .d_angle_d_current = 143512,
+    .d_speed_d_current = 45304917,
+    .d_current_d_current = 3031437,
+    .d_angle_d_voltage = 223343,
+    .d_speed_d_voltage = 119593309,
+    .d_current_d_voltage = 34549839,
+    .d_angle_d_torque = -9760,
+    .d_speed_d_torque = -3869070,
+    .d_current_d_torque = 36939,
+    .d_voltage_d_torque = 269287,
+    .d_torque_d_voltage = 1045258435,
+    .d_torque_d_speed = 7502783,
+    .d_torque_d_acceleration = 356799,
+    .torque_friction = 23239,
+};
+
+static const pbio_observer_model_t model_interactive = {
+    .d_angle_d_speed = 80369,
+    .d_speed_d_speed = 15300671,
+    .d_current_d_speed = -45530,
+    .d_angle_d_current = 164259,
+    .d_speed_d_current = 33593190,
+    .d_current_d_current = -99957,
+    .d_angle_d_voltage = 652140,
+    .d_speed_d_voltage = 273765366,
+    .d_current_d_voltage = 8441622,
+    .d_angle_d_torque = -49448,
+    .d_speed_d_torque = -19466487,
+    .d_current_d_torque = 53923,
+    .d_voltage_d_torque = 1117786,
+    .d_torque_d_voltage = 251814806,
+    .d_torque_d_speed = 1358156,
+    .d_torque_d_acceleration = 69266,
+    .torque_friction = 11227,
+};
+
+static const pbio_observer_model_t model_technic_l = {
+    .d_angle_d_speed = 81800,
+    .d_speed_d_speed = 15779112,
+    .d_current_d_speed = -90064,
+    .d_angle_d_current = 209662,
+    .d_speed_d_current = 52702759,
+    .d_current_d_current = -27200,
+    .d_angle_d_voltage = 487005,
+    .d_speed_d_voltage = 232957549,
+    .d_current_d_voltage = 21021044,
+    .d_angle_d_torque = -26145,
+    .d_speed_d_torque = -10345974,
+    .d_current_d_torque = 45317,
+    .d_voltage_d_torque = 572770,
+    .d_torque_d_voltage = 491427600,
+    .d_torque_d_speed = 2105517,
+    .d_torque_d_acceleration = 132648,
+    .torque_friction = 26430,
+};
+
+static const pbio_observer_model_t model_technic_xl = {
+    .d_angle_d_speed = 81530,
+    .d_speed_d_speed = 15715887,
+    .d_current_d_speed = -82175,
+    .d_angle_d_current = 148296,
+    .d_speed_d_current = 33605950,
+    .d_current_d_current = -157892,
+    .d_angle_d_voltage = 548734,
+    .d_speed_d_voltage = 247160297,
+    .d_current_d_voltage = 19136722,
+    .d_angle_d_torque = -28084,
+    .d_speed_d_torque = -11105076,
+    .d_current_d_torque = 49392,
+    .d_voltage_d_torque = 647650,
+    .d_torque_d_voltage = 434609461,
+    .d_torque_d_speed = 1866253,
+    .d_torque_d_acceleration = 123173,
+    .torque_friction = 12893,
+};
+
+#if PBIO_CONFIG_SERVO_PUP_MOVE_HUB
+
+static const pbio_observer_model_t model_movehub = {
+    .d_angle_d_speed = 81658,
+    .d_speed_d_speed = 15773845,
+    .d_current_d_speed = -70969,
+    .d_angle_d_current = 161482,
+    .d_speed_d_current = 36606237,
+    .d_current_d_current = -147929,
+    .d_angle_d_voltage = 597736,
+    .d_speed_d_voltage = 269135969,
+    .d_current_d_voltage = 19036189,
+    .d_angle_d_torque = -37286,
+    .d_speed_d_torque = -14753273,
+    .d_current_d_torque = 56563,
+    .d_voltage_d_torque = 791041,
+    .d_torque_d_voltage = 355828523,
+    .d_torque_d_speed = 1326571,
+    .d_torque_d_acceleration = 92860,
+    .torque_friction = 24835,
+};
+
+#endif // PBIO_CONFIG_SERVO_PUP_MOVE_HUB
+
+#endif // PBIO_CONFIG_SERVO_PUP
+
+#if PBIO_CONFIG_SERVO_EV3_NXT
+
+static const pbio_observer_model_t model_ev3_l = {
+    .d_angle_d_speed = 163041,
+    .d_speed_d_speed = 15628581,
+    .d_current_d_speed = -233584,
+    .d_angle_d_current = 208669,
+    .d_speed_d_current = 26942549,
+    .d_current_d_current = 56282,
+    .d_angle_d_voltage = 572970,
+    .d_speed_d_voltage = 139112493,
+    .d_current_d_voltage = 28289677,
+    .d_angle_d_torque = -19084,
+    .d_speed_d_torque = -3769739,
+    .d_current_d_torque = 41829,
+    .d_voltage_d_torque = 336309,
+    .d_torque_d_voltage = 836952281,
+    .d_torque_d_speed = 6910615,
+    .d_torque_d_acceleration = 725615,
+    .torque_friction = 16476,
+};
+
+static const pbio_observer_model_t model_ev3_m = {
+    .d_angle_d_speed = 160900,
+    .d_speed_d_speed = 15155854,
+    .d_current_d_speed = -72907,
+    .d_angle_d_current = 765763,
+    .d_speed_d_current = 93197114,
+    .d_current_d_current = -235702,
+    .d_angle_d_voltage = 1352356,
+    .d_speed_d_voltage = 319067947,
+    .d_current_d_voltage = 14347450,
+    .d_angle_d_torque = -90130,
+    .d_speed_d_torque = -17707957,
+    .d_current_d_torque = 65929,
+    .d_voltage_d_torque = 731852,
+    .d_torque_d_voltage = 384606321,
+    .d_torque_d_speed = 1954398,
+    .d_torque_d_acceleration = 152443,
+    .torque_friction = 24593,
+};
+
+static const pbio_observer_model_t model_nxt = {
+    .d_angle_d_speed = 162900,
+    .d_speed_d_speed = 15594798,
+    .d_current_d_speed = -239634,
+    .d_angle_d_current = 208685,
+    .d_speed_d_current = 26909041,
+    .d_current_d_current = 43065,
+    .d_angle_d_voltage = 573310,
+    .d_speed_d_voltage = 139123175,
+    .d_current_d_voltage = 28195260,
+    .d_angle_d_torque = -15401,
+    .d_speed_d_torque = -3041098,
+    .d_current_d_torque = 34694,
+    .d_voltage_d_torque = 271520,
+    .d_torque_d_voltage = 1036662978,
+    .d_torque_d_speed = 8810676,
+    .d_torque_d_acceleration = 898689,
+    .torque_friction = 20449,
+};
+
+#endif // PBIO_CONFIG_SERVO_EV3_NXT
+
+#elif PBIO_CONFIG_CONTROL_LOOP_TIME_MS == 2
+
 #if PBIO_CONFIG_SERVO_PUP
 
 static const pbio_observer_model_t model_technic_s_angular = {
-    .d_angle_d_speed = 179217,
-    .d_speed_d_speed = 956,
-    .d_current_d_speed = -249247,
-    .d_angle_d_current = 1950303,
-    .d_speed_d_current = 7666,
-    .d_current_d_current = -9356019,
-    .d_angle_d_voltage = 5654927,
-    .d_speed_d_voltage = 11702,
-    .d_current_d_voltage = 349105,
-    .d_angle_d_torque = -425928,
-    .d_speed_d_torque = -1085,
-    .d_current_d_torque = 383927,
-    .d_voltage_d_torque = 22334,
-    .d_torque_d_voltage = 17203,
-    .d_torque_d_speed = 12282,
-    .d_torque_d_acceleration = 35129,
+    .d_angle_d_speed = 33214,
+    .d_speed_d_speed = 16318661,
+    .d_current_d_speed = -48493,
+    .d_angle_d_current = 163883,
+    .d_speed_d_current = 131534364,
+    .d_current_d_current = 3570504,
+    .d_angle_d_voltage = 50643,
+    .d_speed_d_voltage = 68284761,
+    .d_current_d_voltage = 7221231,
+    .d_angle_d_torque = -13792,
+    .d_speed_d_torque = -13726745,
+    .d_current_d_torque = 24970,
+    .d_voltage_d_torque = 1612802,
+    .d_torque_d_voltage = 174525392,
+    .d_torque_d_speed = 1171997,
+    .d_torque_d_acceleration = 40596,
     .torque_friction = 9182,
 };
 
 static const pbio_observer_model_t model_technic_m_angular = {
-    .d_angle_d_speed = 177194,
-    .d_speed_d_speed = 934,
-    .d_current_d_speed = -165023,
-    .d_angle_d_current = 2407354,
-    .d_speed_d_current = 8311,
-    .d_current_d_current = 1058029,
-    .d_angle_d_voltage = 7431528,
-    .d_speed_d_voltage = 14444,
-    .d_current_d_voltage = 225610,
-    .d_angle_d_torque = -919183,
-    .d_speed_d_torque = -2332,
-    .d_current_d_torque = 629020,
-    .d_voltage_d_torque = 47606,
-    .d_torque_d_voltage = 8071,
-    .d_torque_d_speed = 5903,
-    .d_torque_d_acceleration = 16163,
+    .d_angle_d_speed = 33331,
+    .d_speed_d_speed = 16464061,
+    .d_current_d_speed = -60084,
+    .d_angle_d_current = 114661,
+    .d_speed_d_current = 99531431,
+    .d_current_d_current = 6628133,
+    .d_angle_d_voltage = 34127,
+    .d_speed_d_voltage = 47775323,
+    .d_current_d_voltage = 9166538,
+    .d_angle_d_torque = -6358,
+    .d_speed_d_torque = -6337940,
+    .d_current_d_torque = 13162,
+    .d_voltage_d_torque = 756640,
+    .d_torque_d_voltage = 372006358,
+    .d_torque_d_speed = 2438404,
+    .d_torque_d_acceleration = 88230,
     .torque_friction = 21413,
 };
 
 static const pbio_observer_model_t model_technic_l_angular = {
-    .d_angle_d_speed = 174943,
-    .d_speed_d_speed = 904,
-    .d_current_d_speed = -58045,
-    .d_angle_d_current = 8368268,
-    .d_speed_d_current = 26508,
-    .d_current_d_current = 396164,
-    .d_angle_d_voltage = 13442903,
-    .d_speed_d_voltage = 25105,
-    .d_current_d_voltage = 86900,
-    .d_angle_d_torque = -3690545,
-    .d_speed_d_torque = -9310,
-    .d_current_d_torque = 975141,
-    .d_voltage_d_torque = 133763,
-    .d_torque_d_voltage = 2872,
-    .d_torque_d_speed = 1919,
-    .d_torque_d_acceleration = 3997,
+    .d_angle_d_speed = 33429,
+    .d_speed_d_speed = 16597448,
+    .d_current_d_speed = -148820,
+    .d_angle_d_current = 30053,
+    .d_speed_d_current = 27187003,
+    .d_current_d_current = 8863887,
+    .d_angle_d_voltage = 17539,
+    .d_speed_d_voltage = 25044548,
+    .d_current_d_voltage = 20732994,
+    .d_angle_d_torque = -1575,
+    .d_speed_d_torque = -1571861,
+    .d_current_d_torque = 7736,
+    .d_voltage_d_torque = 269287,
+    .d_torque_d_voltage = 1045258435,
+    .d_torque_d_speed = 7502783,
+    .d_torque_d_acceleration = 356799,
     .torque_friction = 23239,
 };
 
 static const pbio_observer_model_t model_interactive = {
-    .d_angle_d_speed = 179110,
-    .d_speed_d_speed = 941,
-    .d_current_d_speed = -316164,
-    .d_angle_d_current = 7311289,
-    .d_speed_d_current = 35750,
-    .d_current_d_current = -12014584,
-    .d_angle_d_voltage = 4603893,
-    .d_speed_d_voltage = 10967,
-    .d_current_d_voltage = 355664,
-    .d_angle_d_torque = -728461,
-    .d_speed_d_torque = -1850,
-    .d_current_d_torque = 668004,
-    .d_voltage_d_torque = 32225,
-    .d_torque_d_voltage = 11923,
-    .d_torque_d_speed = 10599,
-    .d_torque_d_acceleration = 20588,
+    .d_angle_d_speed = 33081,
+    .d_speed_d_speed = 16233684,
+    .d_current_d_speed = -48187,
+    .d_angle_d_current = 60466,
+    .d_speed_d_current = 35554095,
+    .d_current_d_current = -65911,
+    .d_angle_d_voltage = 87824,
+    .d_speed_d_voltage = 100775933,
+    .d_current_d_voltage = 8934377,
+    .d_angle_d_torque = -8059,
+    .d_speed_d_torque = -8012640,
+    .d_current_d_torque = 19850,
+    .d_voltage_d_torque = 1117786,
+    .d_torque_d_voltage = 251814806,
+    .d_torque_d_speed = 1358156,
+    .d_torque_d_acceleration = 69266,
     .torque_friction = 11227,
 };
 
 static const pbio_observer_model_t model_technic_l = {
-    .d_angle_d_speed = 175977,
-    .d_speed_d_speed = 912,
-    .d_current_d_speed = -159828,
-    .d_angle_d_current = 5728019,
-    .d_speed_d_current = 22787,
-    .d_current_d_current = -44152415,
-    .d_angle_d_voltage = 6164994,
-    .d_speed_d_voltage = 12888,
-    .d_current_d_voltage = 142828,
-    .d_angle_d_torque = -1377701,
-    .d_speed_d_torque = -3482,
-    .d_current_d_torque = 794862,
-    .d_voltage_d_torque = 62889,
-    .d_torque_d_voltage = 6110,
-    .d_torque_d_speed = 6837,
-    .d_torque_d_acceleration = 10751,
+    .d_angle_d_speed = 33350,
+    .d_speed_d_speed = 16504469,
+    .d_current_d_speed = -76963,
+    .d_angle_d_current = 57293,
+    .d_speed_d_current = 45036465,
+    .d_current_d_current = 2997388,
+    .d_angle_d_voltage = 47710,
+    .d_speed_d_voltage = 63659237,
+    .d_current_d_voltage = 17963262,
+    .d_angle_d_torque = -4230,
+    .d_speed_d_torque = -4218099,
+    .d_current_d_torque = 12384,
+    .d_voltage_d_torque = 572770,
+    .d_torque_d_voltage = 491427600,
+    .d_torque_d_speed = 2105517,
+    .d_torque_d_acceleration = 132648,
     .torque_friction = 26430,
 };
 
 static const pbio_observer_model_t model_technic_xl = {
-    .d_angle_d_speed = 176559,
-    .d_speed_d_speed = 916,
-    .d_current_d_speed = -175173,
-    .d_angle_d_current = 8098298,
-    .d_speed_d_current = 35736,
-    .d_current_d_current = -7606150,
-    .d_angle_d_voltage = 5471477,
-    .d_speed_d_voltage = 12148,
-    .d_current_d_voltage = 156891,
-    .d_angle_d_torque = -1282598,
-    .d_speed_d_torque = -3244,
-    .d_current_d_torque = 729279,
-    .d_voltage_d_torque = 55617,
-    .d_torque_d_voltage = 6908,
-    .d_torque_d_speed = 7713,
-    .d_torque_d_acceleration = 11578,
+    .d_angle_d_speed = 33290,
+    .d_speed_d_speed = 16442976,
+    .d_current_d_speed = -80372,
+    .d_angle_d_current = 46702,
+    .d_speed_d_current = 32868769,
+    .d_current_d_current = 917405,
+    .d_angle_d_voltage = 61575,
+    .d_speed_d_voltage = 77837226,
+    .d_current_d_voltage = 18716938,
+    .d_angle_d_torque = -4550,
+    .d_speed_d_torque = -4534396,
+    .d_current_d_torque = 15555,
+    .d_voltage_d_torque = 647650,
+    .d_torque_d_voltage = 434609461,
+    .d_torque_d_speed = 1866253,
+    .d_torque_d_acceleration = 123173,
     .torque_friction = 12893,
 };
 
 #if PBIO_CONFIG_SERVO_PUP_MOVE_HUB
 
 static const pbio_observer_model_t model_movehub = {
-    .d_angle_d_speed = 176283,
-    .d_speed_d_speed = 913,
-    .d_current_d_speed = -202833,
-    .d_angle_d_current = 7437051,
-    .d_speed_d_current = 32807,
-    .d_current_d_current = -8118383,
-    .d_angle_d_voltage = 5022928,
-    .d_speed_d_voltage = 11156,
-    .d_current_d_voltage = 157720,
-    .d_angle_d_torque = -966059,
-    .d_speed_d_torque = -2442,
-    .d_current_d_torque = 636829,
-    .d_voltage_d_torque = 45536,
-    .d_torque_d_voltage = 8438,
-    .d_torque_d_speed = 10851,
-    .d_torque_d_acceleration = 15357,
+    .d_angle_d_speed = 33304,
+    .d_speed_d_speed = 16460897,
+    .d_current_d_speed = -69353,
+    .d_angle_d_current = 50908,
+    .d_speed_d_current = 35772665,
+    .d_current_d_current = 901682,
+    .d_angle_d_voltage = 67178,
+    .d_speed_d_voltage = 84846955,
+    .d_current_d_voltage = 18602710,
+    .d_angle_d_torque = -6037,
+    .d_speed_d_torque = -6017107,
+    .d_current_d_torque = 17832,
+    .d_voltage_d_torque = 791041,
+    .d_torque_d_voltage = 355828523,
+    .d_torque_d_speed = 1326571,
+    .d_torque_d_acceleration = 92860,
     .torque_friction = 24835,
 };
 
@@ -165,68 +382,286 @@ static const pbio_observer_model_t model_movehub = {
 
 #if PBIO_CONFIG_SERVO_EV3_NXT
 
+static const pbio_observer_model_t model_nxt = {
+    .d_angle_d_speed = 66646,
+    .d_speed_d_speed = 16465180,
+    .d_current_d_speed = -197285,
+    .d_angle_d_current = 55071,
+    .d_speed_d_current = 22153604,
+    .d_current_d_current = 3661791,
+    .d_angle_d_voltage = 54412,
+    .d_speed_d_voltage = 36714074,
+    .d_current_d_voltage = 23212519,
+    .d_angle_d_torque = -2496,
+    .d_speed_d_torque = -1244192,
+    .d_current_d_torque = 9156,
+    .d_voltage_d_torque = 271520,
+    .d_torque_d_voltage = 1036662978,
+    .d_torque_d_speed = 8810676,
+    .d_torque_d_acceleration = 898689,
+    .torque_friction = 20449,
+};
+
 static const pbio_observer_model_t model_ev3_l = {
-    .d_angle_d_speed = 88290,
-    .d_speed_d_speed = 921,
-    .d_current_d_speed = -61626,
-    .d_angle_d_current = 5755278,
-    .d_speed_d_current = 44574,
-    .d_current_d_current = 21338185,
-    .d_angle_d_voltage = 5240040,
-    .d_speed_d_voltage = 21582,
-    .d_current_d_voltage = 106130,
-    .d_angle_d_torque = -1887437,
-    .d_speed_d_torque = -9555,
-    .d_current_d_torque = 861143,
-    .d_voltage_d_torque = 107106,
-    .d_torque_d_voltage = 3587,
-    .d_torque_d_speed = 2083,
-    .d_torque_d_acceleration = 1965,
+    .d_angle_d_speed = 66660,
+    .d_speed_d_speed = 16474434,
+    .d_current_d_speed = -191935,
+    .d_angle_d_current = 55005,
+    .d_speed_d_current = 22138512,
+    .d_current_d_current = 3678780,
+    .d_angle_d_voltage = 54334,
+    .d_speed_d_voltage = 36670225,
+    .d_current_d_voltage = 23245438,
+    .d_angle_d_torque = -3092,
+    .d_speed_d_torque = -1541277,
+    .d_current_d_torque = 11026,
+    .d_voltage_d_torque = 336309,
+    .d_torque_d_voltage = 836952281,
+    .d_torque_d_speed = 6910615,
+    .d_torque_d_acceleration = 725615,
     .torque_friction = 16476,
 };
 
 static const pbio_observer_model_t model_ev3_m = {
-    .d_angle_d_speed = 89465,
-    .d_speed_d_speed = 950,
-    .d_current_d_speed = -197440,
-    .d_angle_d_current = 1568301,
-    .d_speed_d_current = 12886,
-    .d_current_d_current = -5095199,
-    .d_angle_d_voltage = 2220112,
-    .d_speed_d_voltage = 9410,
-    .d_current_d_voltage = 209263,
-    .d_angle_d_torque = -399652,
-    .d_speed_d_torque = -2034,
-    .d_current_d_torque = 546357,
-    .d_voltage_d_torque = 49219,
-    .d_torque_d_voltage = 7806,
-    .d_torque_d_speed = 7365,
-    .d_torque_d_acceleration = 9355,
+    .d_angle_d_speed = 66419,
+    .d_speed_d_speed = 16320591,
+    .d_current_d_speed = -65218,
+    .d_angle_d_current = 215662,
+    .d_speed_d_current = 83368440,
+    .d_current_d_current = 2552246,
+    .d_angle_d_voltage = 135716,
+    .d_speed_d_voltage = 89859338,
+    .d_current_d_voltage = 12834352,
+    .d_angle_d_torque = -14690,
+    .d_speed_d_torque = -7309807,
+    .d_current_d_torque = 18568,
+    .d_voltage_d_torque = 731852,
+    .d_torque_d_voltage = 384606321,
+    .d_torque_d_speed = 1954398,
+    .d_torque_d_acceleration = 152443,
     .torque_friction = 24593,
 };
 
+#endif // PBIO_CONFIG_SERVO_EV3_NXT
+
+#elif PBIO_CONFIG_CONTROL_LOOP_TIME_MS == 1
+
+#if PBIO_CONFIG_SERVO_PUP
+
+static const pbio_observer_model_t model_technic_s_angular = {
+    .d_angle_d_speed = 16727,
+    .d_speed_d_speed = 16636010,
+    .d_current_d_speed = -33119,
+    .d_angle_d_current = 50466,
+    .d_speed_d_current = 89832181,
+    .d_current_d_current = 7929580,
+    .d_angle_d_voltage = 7422,
+    .d_speed_d_voltage = 21027462,
+    .d_current_d_voltage = 4931783,
+    .d_angle_d_torque = -3461,
+    .d_speed_d_torque = -6913050,
+    .d_current_d_torque = 7689,
+    .d_voltage_d_torque = 1612802,
+    .d_torque_d_voltage = 174525392,
+    .d_torque_d_speed = 1171997,
+    .d_torque_d_acceleration = 40596,
+    .torque_friction = 9182,
+};
+
+static const pbio_observer_model_t model_technic_m_angular = {
+    .d_angle_d_speed = 16746,
+    .d_speed_d_speed = 16687518,
+    .d_current_d_speed = -36872,
+    .d_angle_d_current = 32843,
+    .d_speed_d_current = 61079819,
+    .d_current_d_current = 10651468,
+    .d_angle_d_voltage = 4728,
+    .d_speed_d_voltage = 13684461,
+    .d_current_d_voltage = 5625263,
+    .d_angle_d_torque = -1594,
+    .d_speed_d_torque = -3184345,
+    .d_current_d_torque = 3770,
+    .d_voltage_d_torque = 756640,
+    .d_torque_d_voltage = 372006358,
+    .d_torque_d_speed = 2438404,
+    .d_torque_d_acceleration = 88230,
+    .torque_friction = 21413,
+};
+
+static const pbio_observer_model_t model_technic_l_angular = {
+    .d_angle_d_speed = 16760,
+    .d_speed_d_speed = 16727677,
+    .d_current_d_speed = -86162,
+    .d_angle_d_current = 8282,
+    .d_speed_d_current = 15740356,
+    .d_current_d_current = 12250207,
+    .d_angle_d_voltage = 2359,
+    .d_speed_d_voltage = 6901536,
+    .d_current_d_voltage = 12003703,
+    .d_angle_d_torque = -394,
+    .d_speed_d_torque = -788094,
+    .d_current_d_torque = 2132,
+    .d_voltage_d_torque = 269287,
+    .d_torque_d_voltage = 1045258435,
+    .d_torque_d_speed = 7502783,
+    .d_torque_d_acceleration = 356799,
+    .torque_friction = 23239,
+};
+
+static const pbio_observer_model_t model_interactive = {
+    .d_angle_d_speed = 16687,
+    .d_speed_d_speed = 16552142,
+    .d_current_d_speed = -46819,
+    .d_angle_d_current = 25039,
+    .d_speed_d_current = 34544836,
+    .d_current_d_current = 715236,
+    .d_angle_d_voltage = 16681,
+    .d_speed_d_voltage = 41730901,
+    .d_current_d_voltage = 8680761,
+    .d_angle_d_torque = -2026,
+    .d_speed_d_torque = -4041894,
+    .d_current_d_torque = 8220,
+    .d_voltage_d_torque = 1117786,
+    .d_torque_d_voltage = 251814806,
+    .d_torque_d_speed = 1358156,
+    .d_torque_d_acceleration = 69266,
+    .torque_friction = 11227,
+};
+
+static const pbio_observer_model_t model_technic_l = {
+    .d_angle_d_speed = 16747,
+    .d_speed_d_speed = 16691517,
+    .d_current_d_speed = -54021,
+    .d_angle_d_current = 18002,
+    .d_speed_d_current = 31611444,
+    .d_current_d_current = 7210792,
+    .d_angle_d_voltage = 7107,
+    .d_speed_d_voltage = 20002257,
+    .d_current_d_voltage = 12608553,
+    .d_angle_d_torque = -1060,
+    .d_speed_d_torque = -2118125,
+    .d_current_d_torque = 3891,
+    .d_voltage_d_torque = 572770,
+    .d_torque_d_voltage = 491427600,
+    .d_torque_d_speed = 2105517,
+    .d_torque_d_acceleration = 132648,
+    .torque_friction = 26430,
+};
+
+static const pbio_observer_model_t model_technic_xl = {
+    .d_angle_d_speed = 16734,
+    .d_speed_d_speed = 16660927,
+    .d_current_d_speed = -64836,
+    .d_angle_d_current = 16249,
+    .d_speed_d_current = 26515127,
+    .d_current_d_current = 4136501,
+    .d_angle_d_voltage = 9970,
+    .d_speed_d_voltage = 27081136,
+    .d_current_d_voltage = 15098892,
+    .d_angle_d_torque = -1141,
+    .d_speed_d_torque = -2279374,
+    .d_current_d_torque = 5412,
+    .d_voltage_d_torque = 647650,
+    .d_torque_d_voltage = 434609461,
+    .d_torque_d_speed = 1866253,
+    .d_torque_d_acceleration = 123173,
+    .torque_friction = 12893,
+};
+
+#if PBIO_CONFIG_SERVO_PUP_MOVE_HUB
+
+static const pbio_observer_model_t model_movehub = {
+    .d_angle_d_speed = 16737,
+    .d_speed_d_speed = 16666986,
+    .d_current_d_speed = -56049,
+    .d_angle_d_current = 17740,
+    .d_speed_d_current = 28910507,
+    .d_current_d_current = 4092447,
+    .d_angle_d_voltage = 10892,
+    .d_speed_d_voltage = 29567129,
+    .d_current_d_voltage = 15034211,
+    .d_angle_d_torque = -1514,
+    .d_speed_d_torque = -3023841,
+    .d_current_d_torque = 6214,
+    .d_voltage_d_torque = 791041,
+    .d_torque_d_voltage = 355828523,
+    .d_torque_d_speed = 1326571,
+    .d_torque_d_acceleration = 92860,
+    .torque_friction = 24835,
+};
+
+#endif // PBIO_CONFIG_SERVO_PUP_MOVE_HUB
+
+#endif // PBIO_CONFIG_SERVO_PUP
+
+#if PBIO_CONFIG_SERVO_EV3_NXT
+
 static const pbio_observer_model_t model_nxt = {
-    .d_angle_d_speed = 88366,
-    .d_speed_d_speed = 923,
-    .d_current_d_speed = -60070,
-    .d_angle_d_current = 5754836,
-    .d_speed_d_current = 44630,
-    .d_current_d_current = 27887153,
-    .d_angle_d_voltage = 5236928,
-    .d_speed_d_voltage = 21581,
-    .d_current_d_voltage = 106485,
-    .d_angle_d_torque = -2338784,
-    .d_speed_d_torque = -11845,
-    .d_current_d_torque = 1038248,
-    .d_voltage_d_torque = 132663,
-    .d_torque_d_voltage = 2896,
-    .d_torque_d_speed = 1634,
-    .d_torque_d_acceleration = 1587,
+    .d_angle_d_speed = 33487,
+    .d_speed_d_speed = 16681275,
+    .d_current_d_speed = -134290,
+    .d_angle_d_current = 16933,
+    .d_speed_d_current = 15079695,
+    .d_current_d_current = 7966160,
+    .d_angle_d_voltage = 7967,
+    .d_speed_d_voltage = 11288418,
+    .d_current_d_voltage = 15800486,
+    .d_angle_d_torque = -626,
+    .d_speed_d_torque = -625148,
+    .d_current_d_torque = 2815,
+    .d_voltage_d_torque = 271520,
+    .d_torque_d_voltage = 1036662978,
+    .d_torque_d_speed = 8810676,
+    .d_torque_d_acceleration = 898689,
     .torque_friction = 20449,
 };
 
+static const pbio_observer_model_t model_ev3_l = {
+    .d_angle_d_speed = 33489,
+    .d_speed_d_speed = 16684160,
+    .d_current_d_speed = -130557,
+    .d_angle_d_current = 16905,
+    .d_speed_d_current = 15058998,
+    .d_current_d_current = 7980336,
+    .d_angle_d_voltage = 7953,
+    .d_speed_d_voltage = 11270074,
+    .d_current_d_voltage = 15811948,
+    .d_angle_d_torque = -775,
+    .d_speed_d_torque = -774307,
+    .d_current_d_torque = 3389,
+    .d_voltage_d_torque = 336309,
+    .d_torque_d_voltage = 836952281,
+    .d_torque_d_speed = 6910615,
+    .d_torque_d_acceleration = 725615,
+    .torque_friction = 16476,
+};
+
+static const pbio_observer_model_t model_ev3_m = {
+    .d_angle_d_speed = 33451,
+    .d_speed_d_speed = 16631671,
+    .d_current_d_speed = -46788,
+    .d_angle_d_current = 68741,
+    .d_speed_d_current = 59809441,
+    .d_current_d_current = 6754108,
+    .d_angle_d_voltage = 20442,
+    .d_speed_d_voltage = 28641892,
+    .d_current_d_voltage = 9207506,
+    .d_angle_d_torque = -3687,
+    .d_speed_d_torque = -3681421,
+    .d_current_d_torque = 5918,
+    .d_voltage_d_torque = 731852,
+    .d_torque_d_voltage = 384606321,
+    .d_torque_d_speed = 1954398,
+    .d_torque_d_acceleration = 152443,
+    .torque_friction = 24593,
+};
+
 #endif // PBIO_CONFIG_SERVO_EV3_NXT
 
+#else
+#error "No observer models for this control loop time. Generate them with pbio/doc/control/motor_data.py."
+#endif // PBIO_CONFIG_CONTROL_LOOP_TIME_MS
+
 static const pbio_servo_settings_reduced_t servo_settings_reduced[] = {
     #if PBIO_CONFIG_SERVO_EV3_NXT
     {
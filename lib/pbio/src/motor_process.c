@@ -5,7 +5,10 @@
 
 #include <pbio/control.h>
 #include <pbio/drivebase.h>
+#include <pbio/motor_process.h>
+#include <pbio/port_interface.h>
 #include <pbio/servo.h>
+#include <pbio/tracepoint.h>
 
 #include <pbio/os.h>
 
@@ -13,6 +16,84 @@
 
 static pbio_os_process_t pbio_motor_process;
 
+/**
+ * Timing statistics of the control loop.
+ */
+static struct {
+    /** Time of the most recent update in microseconds. */
+    uint32_t last_update_us;
+    /** Sum of all measured periods in microseconds. */
+    uint64_t period_sum_us;
+    /** Number of measured periods. */
+    uint32_t period_count;
+    /** Shortest measured period in microseconds. */
+    uint32_t period_min_us;
+    /** Longest measured period in microseconds. */
+    uint32_t period_max_us;
+    /** Number of times the loop fell behind by one period or more. */
+    uint32_t missed_deadlines;
+    /** Longest event loop stall that made the loop fall behind. */
+    pbio_os_stall_t stall_max;
+    /** Number of times the motors were coasted after a long delay. */
+    uint32_t starved;
+} stats;
+
+/**
+ * Resets the control loop timing statistics.
+ */
+void pbio_motor_process_reset_stats(void) {
+    stats.period_sum_us = 0;
+    stats.period_count = 0;
+    stats.period_min_us = UINT32_MAX;
+    stats.period_max_us = 0;
+    stats.missed_deadlines = 0;
+    stats.stall_max = (pbio_os_stall_t) {0};
+    stats.starved = 0;
+}
+
+/**
+ * Gets the control loop timing statistics since the last reset.
+ *
+ * @param [out] result  The statistics. Periods are zero if none were measured.
+ */
+void pbio_motor_process_get_stats(pbio_motor_process_stats_t *result) {
+    result->count = stats.period_count;
+    result->missed_deadlines = stats.missed_deadlines;
+    result->stall_max_us = stats.stall_max.time_us;
+    result->stall_process = stats.stall_max.process;
+    result->starved = stats.starved;
+    if (stats.period_count == 0) {
+        result->period_min_us = 0;
+        result->period_max_us = 0;
+        result->period_mean_us = 0;
+        return;
+    }
+    result->period_min_us = stats.period_min_us;
+    result->period_max_us = stats.period_max_us;
+    result->period_mean_us = stats.period_sum_us / stats.period_count;
+}
+
+static uint32_t pbio_motor_process_update_stats(bool is_first) {
+    uint32_t now = pbdrv_clock_get_us();
+    uint32_t period = now - stats.last_update_us;
+    stats.last_update_us = now;
+
+    // There is no meaningful period before the first update.
+    if (is_first) {
+        return 0;
+    }
+
+    stats.period_sum_us += period;
+    stats.period_count++;
+    if (period < stats.period_min_us) {
+        stats.period_min_us = period;
+    }
+    if (period > stats.period_max_us) {
+        stats.period_max_us = period;
+    }
+    return period;
+}
+
 static pbio_error_t pbio_motor_process_thread(pbio_os_state_t *state, void *context) {
 
     static pbio_os_timer_t timer;
@@ -22,13 +103,24 @@ static pbio_error_t pbio_motor_process_thread(pbio_os_state_t *state, void *cont
     timer.start = pbdrv_clock_get_ms() - PBIO_CONFIG_CONTROL_LOOP_TIME_MS;
     timer.duration = PBIO_CONFIG_CONTROL_LOOP_TIME_MS;
 
+    pbio_motor_process_reset_stats();
+    pbio_motor_process_update_stats(true);
+    pbio_os_reset_stall();
+
     for (;;) {
+        pbio_tracepoint_record(PBIO_TRACEPOINT_MOTOR_TICK_START, 0, 0);
+
+        // Sample all motors once, shared by drive bases and servos.
+        pbio_servo_sample_all();
+
         // Update drivebase
         pbio_drivebase_update_all();
 
         // Update servos
         pbio_servo_update_all();
 
+        pbio_tracepoint_record(PBIO_TRACEPOINT_MOTOR_TICK_END, 0, 0);
+
         // Increment start time instead waiting from here, making the
         // loop time closer to the target on average.
         timer.start += PBIO_CONFIG_CONTROL_LOOP_TIME_MS;
@@ -36,11 +128,31 @@ static pbio_error_t pbio_motor_process_thread(pbio_os_state_t *state, void *cont
         // In the rare case that polling was delayed too long, we need to
         // ensure that the next poll is a minimum of 1ms in the future so we
         // don't have 0 time deltas in the control code.
+        if (pbio_os_timer_is_expired(&timer)) {
+            stats.missed_deadlines++;
+
+            // Keep track of what held up the event loop the longest.
+            pbio_os_stall_t stall;
+            pbio_os_get_stall(&stall);
+            if (stall.time_us > stats.stall_max.time_us) {
+                stats.stall_max = stall;
+            }
+        }
+        pbio_os_reset_stall();
         while (pbio_os_timer_is_expired(&timer)) {
             timer.start++;
         }
 
         PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&timer));
+        uint32_t period = pbio_motor_process_update_stats(false);
+
+        // If the event loop was blocked for too long, the motors have been
+        // running unattended with their last actuation. Coast them instead of
+        // resuming control from a stale state.
+        if (PBIO_CONFIG_CONTROL_LOOP_STARVED_MS && period > PBIO_CONFIG_CONTROL_LOOP_STARVED_MS * 1000) {
+            pbio_port_stop_user_actions(false);
+            stats.starved++;
+        }
     }
 
     // Unreachable.
@@ -48,6 +160,9 @@ static pbio_error_t pbio_motor_process_thread(pbio_os_state_t *state, void *cont
 }
 
 void pbio_motor_process_start(void) {
+    // Run the control loop before all other processes so that it gets the
+    // freshest state and least jitter.
+    pbio_os_process_set_priority(&pbio_motor_process, PBIO_OS_PROCESS_PRIORITY_CRITICAL);
     pbio_os_process_start(&pbio_motor_process, pbio_motor_process_thread, NULL);
 }
 
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include <pbio/angle.h>
@@ -14,6 +15,7 @@
 #include <pbio/int_math.h>
 #include <pbio/observer.h>
 #include <pbio/trajectory.h>
+#include <pbio/util.h>
 
 // Values generated by pbio/doc/control/model.py
 #define MAX_NUM_SPEED (2500000)
@@ -21,11 +23,27 @@
 #define MAX_NUM_CURRENT (30000)
 #define MAX_NUM_VOLTAGE (12000)
 #define MAX_NUM_TORQUE (1000000)
-#define PRESCALE_SPEED (858)
-#define PRESCALE_ACCELERATION (85)
-#define PRESCALE_CURRENT (71582)
-#define PRESCALE_VOLTAGE (178956)
-#define PRESCALE_TORQUE (2147)
+#define MODEL_SHIFT (24)
+
+// Below this speed, there is less than one encoder edge per control loop
+// iteration, so the speed from edge timing is used instead of the
+// differentiator, if available.
+#define MAX_EDGE_SPEED (1000 * 1000 / PBIO_CONFIG_CONTROL_LOOP_TIME_MS)
+
+/**
+ * Multiplies a signal by a model coefficient.
+ *
+ * Model coefficients are stored as fixed point values scaled by
+ * 2^::MODEL_SHIFT, so this needs only a long multiplication and a shift
+ * instead of a (software) division on hubs without a hardware divider.
+ *
+ * @param [in]  x              The signal, bounded by its MAX_NUM_* value.
+ * @param [in]  coefficient    The scaled model coefficient.
+ * @return                     The product, rounded to the nearest integer.
+ */
+static inline int32_t mul_model(int32_t x, int32_t coefficient) {
+    return ((int64_t)x * coefficient + (1 << (MODEL_SHIFT - 1))) >> MODEL_SHIFT;
+}
 
 /**
  * Resets the observer to a new angle. Speed and current are reset to zero.
@@ -149,14 +167,21 @@ int32_t pbio_observer_get_feedback_voltage(const pbio_observer_t *obs, const pbi
  * @param [in]  angle          Measured angle used to correct the model.
  * @param [in]  actuation      Actuation type currently applied to the motor.
  * @param [in]  voltage        If actuation type is voltage, this is the payload in mV.
+ * @param [in]  edge_speed     Speed from the time between encoder edges, or NULL if not available.
  */
-void pbio_observer_update(pbio_observer_t *obs, uint32_t time, const pbio_angle_t *angle, pbio_dcmotor_actuation_t actuation, int32_t voltage) {
+PBIO_HOT void pbio_observer_update(pbio_observer_t *obs, uint32_t time, const pbio_angle_t *angle, pbio_dcmotor_actuation_t actuation, int32_t voltage, const int32_t *edge_speed) {
 
     const pbio_observer_model_t *m = obs->model;
 
     // Update numerical derivative as speed sanity check.
     obs->speed_numeric = pbio_differentiator_update_and_get_speed(&obs->differentiator, angle);
 
+    // At low speeds, only a few encoder edges fall within the differentiator
+    // window, so the edge timing gives a smoother and more recent value.
+    if (edge_speed && pbio_int_math_abs(*edge_speed) < MAX_EDGE_SPEED) {
+        obs->speed_numeric = *edge_speed;
+    }
+
     // Apply observer error feedback as voltage.
     int32_t feedback_voltage = pbio_observer_get_feedback_voltage(obs, angle);
 
@@ -182,25 +207,25 @@ void pbio_observer_update(pbio_observer_t *obs, uint32_t time, const pbio_angle_
     // mode is coast, back EMF is slightly overestimated, but an accurate
     // speed value is typically not needed in that use case.
     pbio_angle_add_mdeg(&obs->angle,
-        PRESCALE_SPEED * obs->speed / m->d_angle_d_speed +
-        PRESCALE_CURRENT * obs->current / m->d_angle_d_current +
-        PRESCALE_VOLTAGE * model_voltage / m->d_angle_d_voltage +
-        PRESCALE_TORQUE * torque / m->d_angle_d_torque);
+        mul_model(obs->speed, m->d_angle_d_speed) +
+        mul_model(obs->current, m->d_angle_d_current) +
+        mul_model(model_voltage, m->d_angle_d_voltage) +
+        mul_model(torque, m->d_angle_d_torque));
     int32_t speed_next = pbio_int_math_clamp(0 +
-        PRESCALE_SPEED * obs->speed / m->d_speed_d_speed +
-        PRESCALE_CURRENT * obs->current / m->d_speed_d_current +
-        PRESCALE_VOLTAGE * model_voltage / m->d_speed_d_voltage +
-        PRESCALE_TORQUE * torque / m->d_speed_d_torque, MAX_NUM_SPEED);
+        mul_model(obs->speed, m->d_speed_d_speed) +
+        mul_model(obs->current, m->d_speed_d_current) +
+        mul_model(model_voltage, m->d_speed_d_voltage) +
+        mul_model(torque, m->d_speed_d_torque), MAX_NUM_SPEED);
     int32_t current_next = pbio_int_math_clamp(0 +
-        PRESCALE_SPEED * obs->speed / m->d_current_d_speed +
-        PRESCALE_CURRENT * obs->current / m->d_current_d_current +
-        PRESCALE_VOLTAGE * model_voltage / m->d_current_d_voltage +
-        PRESCALE_TORQUE * torque / m->d_current_d_torque, MAX_NUM_CURRENT);
+        mul_model(obs->speed, m->d_current_d_speed) +
+        mul_model(obs->current, m->d_current_d_current) +
+        mul_model(model_voltage, m->d_current_d_voltage) +
+        mul_model(torque, m->d_current_d_torque), MAX_NUM_CURRENT);
 
     // In case of a speed transition through zero, undo (subtract) the effect
     // of friction, to avoid inducing chatter in the speed signal.
     if ((obs->speed < 0) != (speed_next < 0)) {
-        speed_next -= PRESCALE_TORQUE * coulomb_friction / m->d_speed_d_torque;
+        speed_next -= mul_model(coulomb_friction, m->d_speed_d_torque);
     }
 
     // Save new state.
@@ -250,8 +275,8 @@ int32_t pbio_observer_get_max_torque(void) {
 int32_t pbio_observer_get_feedforward_torque(const pbio_observer_model_t *model, int32_t rate_ref, int32_t acceleration_ref) {
 
     int32_t friction_compensation_torque = model->torque_friction / 2 * pbio_int_math_sign(rate_ref);
-    int32_t back_emf_compensation_torque = PRESCALE_SPEED * pbio_int_math_clamp(rate_ref, MAX_NUM_SPEED) / model->d_torque_d_speed;
-    int32_t acceleration_torque = PRESCALE_ACCELERATION * pbio_int_math_clamp(acceleration_ref, MAX_NUM_ACCELERATION) / model->d_torque_d_acceleration;
+    int32_t back_emf_compensation_torque = mul_model(pbio_int_math_clamp(rate_ref, MAX_NUM_SPEED), model->d_torque_d_speed);
+    int32_t acceleration_torque = mul_model(pbio_int_math_clamp(acceleration_ref, MAX_NUM_ACCELERATION), model->d_torque_d_acceleration);
 
     // Total feedforward torque
     return pbio_int_math_clamp(friction_compensation_torque + back_emf_compensation_torque + acceleration_torque, MAX_NUM_TORQUE);
@@ -265,7 +290,7 @@ int32_t pbio_observer_get_feedforward_torque(const pbio_observer_model_t *model,
  * @returns                         The voltage in mV.
 */
 int32_t pbio_observer_torque_to_voltage(const pbio_observer_model_t *model, int32_t desired_torque) {
-    return PRESCALE_TORQUE * pbio_int_math_clamp(desired_torque, MAX_NUM_TORQUE) / model->d_voltage_d_torque;
+    return mul_model(pbio_int_math_clamp(desired_torque, MAX_NUM_TORQUE), model->d_voltage_d_torque);
 }
 
 /**
@@ -276,5 +301,121 @@ int32_t pbio_observer_torque_to_voltage(const pbio_observer_model_t *model, int3
  * @returns                         The torque in uNm.
 */
 int32_t pbio_observer_voltage_to_torque(const pbio_observer_model_t *model, int32_t voltage) {
-    return PRESCALE_VOLTAGE * pbio_int_math_clamp(voltage, MAX_NUM_VOLTAGE) / model->d_torque_d_voltage;
+    return mul_model(pbio_int_math_clamp(voltage, MAX_NUM_VOLTAGE), model->d_torque_d_voltage);
 }
+
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+/**
+ * Clears all data collected for model identification.
+ *
+ * @param [in]  fit             The identification data.
+ */
+void pbio_observer_identification_reset(pbio_observer_identification_t *fit) {
+    memset(fit, 0, sizeof(*fit));
+}
+
+/**
+ * Adds a sample taken while the speed is constant.
+ *
+ * @param [in]  fit             The identification data.
+ * @param [in]  speed           The measured speed in mdeg/s.
+ * @param [in]  torque          The torque applied by the motor in uNm.
+ */
+void pbio_observer_identification_add_steady(pbio_observer_identification_t *fit, int32_t speed, int32_t torque) {
+    float w = speed / 1000.0f;
+    float s = pbio_int_math_sign(speed);
+    float t = torque / 1000.0f;
+    fit->speed_speed += w * w;
+    fit->speed_sign += w * s;
+    fit->sign_sign += s * s;
+    fit->speed_torque += w * t;
+    fit->sign_torque += s * t;
+}
+
+/**
+ * Adds the response to a constant torque, starting and ending at a constant
+ * speed.
+ *
+ * For a first order response, the angle traveled lags behind the angle that
+ * would be traveled at the final speed by the speed change times the time
+ * constant. Steps that change direction are skipped, because the friction
+ * torque changes along the way.
+ *
+ * @param [in]  fit             The identification data.
+ * @param [in]  speed_start     The speed at the start of the step in mdeg/s.
+ * @param [in]  speed_end       The speed at the end of the step in mdeg/s.
+ * @param [in]  angle_change    The angle traveled during the step in mdeg.
+ * @param [in]  duration        The duration of the step in ms.
+ */
+void pbio_observer_identification_add_step(pbio_observer_identification_t *fit, int32_t speed_start, int32_t speed_end, int32_t angle_change, uint32_t duration) {
+    if (pbio_int_math_sign(speed_start) * pbio_int_math_sign(speed_end) < 0) {
+        return;
+    }
+    float change = (speed_end - speed_start) / 1000.0f;
+    float lag = (speed_end / 1000.0f) * (duration / 1000.0f) - angle_change / 1000.0f;
+    fit->lag_change += lag * change;
+    fit->change_change += change * change;
+}
+
+/**
+ * Converts a model parameter to a scaled model coefficient.
+ *
+ * @param [in]  value           The parameter in mNm per deg/s or per deg/s^2,
+ *                              which is the same as uNm per mdeg/s or mdeg/s^2.
+ * @param [out] coefficient     The coefficient scaled by 2^::MODEL_SHIFT.
+ * @return                      ::PBIO_ERROR_FAILED if the value is not
+ *                              positive or too big, otherwise ::PBIO_SUCCESS.
+ */
+static pbio_error_t pbio_observer_identification_to_coefficient(float value, int32_t *coefficient) {
+    float scaled = value * (1 << MODEL_SHIFT);
+    if (!(scaled > 0.0f) || scaled >= (float)INT32_MAX) {
+        return PBIO_ERROR_FAILED;
+    }
+    *coefficient = (int32_t)scaled;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Fits the feedforward parameters of a motor model to the collected data.
+ *
+ * Only the feedforward torques are identified. All other parameters are
+ * copied from the base model.
+ *
+ * @param [in]  fit             The identification data.
+ * @param [in]  base            The model to start from.
+ * @param [out] model           The identified model. May be the same as @p base.
+ * @return                      ::PBIO_ERROR_FAILED if the data does not give
+ *                              a physically meaningful model, otherwise
+ *                              ::PBIO_SUCCESS.
+ */
+pbio_error_t pbio_observer_identification_solve(const pbio_observer_identification_t *fit, const pbio_observer_model_t *base, pbio_observer_model_t *model) {
+
+    // Least squares fit of torque = speed_gain * speed + friction * sign(speed).
+    float det = fit->speed_speed * fit->sign_sign - fit->speed_sign * fit->speed_sign;
+    if (!(det > 0.0f) || !(fit->change_change > 0.0f)) {
+        return PBIO_ERROR_FAILED;
+    }
+    float speed_gain = (fit->speed_torque * fit->sign_sign - fit->sign_torque * fit->speed_sign) / det;
+    float friction = (fit->speed_speed * fit->sign_torque - fit->speed_sign * fit->speed_torque) / det;
+
+    // Inertia follows from the time constant of the same linear model.
+    float time_constant = fit->lag_change / fit->change_change;
+    float inertia = time_constant * speed_gain;
+
+    int32_t d_torque_d_speed;
+    int32_t d_torque_d_acceleration;
+    if (pbio_observer_identification_to_coefficient(speed_gain, &d_torque_d_speed) != PBIO_SUCCESS ||
+        pbio_observer_identification_to_coefficient(inertia, &d_torque_d_acceleration) != PBIO_SUCCESS ||
+        friction * 1000.0f > MAX_NUM_TORQUE) {
+        return PBIO_ERROR_FAILED;
+    }
+
+    *model = *base;
+    model->d_torque_d_speed = d_torque_d_speed;
+    model->d_torque_d_acceleration = d_torque_d_acceleration;
+    model->torque_friction = friction > 0.0f ? (int32_t)(friction * 1000.0f) : 0;
+    return PBIO_SUCCESS;
+}
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
@@ -7,10 +7,15 @@
 #include <pbio/os.h>
 #include "pbio_os_config.h"
 
+#include <pbio/tracepoint.h>
 #include <pbio/util.h>
 
 #include <pbdrv/clock.h>
 
+#if PBIO_CONFIG_OS_TICKLESS
+static void update_wake_time(uint32_t deadline);
+#endif
+
 /**
  * Sets the timer to expire after the specified duration.
  *
@@ -53,21 +58,77 @@ void pbio_os_timer_extend(pbio_os_timer_t *timer) {
  * @return          Whether the timer has expired.
  */
 bool pbio_os_timer_is_expired(pbio_os_timer_t *timer) {
-    return pbio_util_time_has_passed(pbdrv_clock_get_ms(), timer->start + timer->duration);
+    uint32_t deadline = timer->start + timer->duration;
+    if (pbio_util_time_has_passed(pbdrv_clock_get_ms(), deadline)) {
+        return true;
+    }
+    #if PBIO_CONFIG_OS_TICKLESS
+    update_wake_time(deadline);
+    #endif
+    return false;
 }
 
 /**
- * Whether a poll request is pending.
+ * Whether a poll request is pending. This is set for both targeted and
+ * broadcast poll requests, so the event loop can quickly tell if it has
+ * anything to do at all.
+ *
+ * This is not static so that hot paths can check it inline before calling
+ * ::pbio_os_run_processes_once.
  */
-static volatile bool poll_request_is_pending = false;
+volatile bool pbio_os_poll_request_is_pending = false;
+
+/**
+ * Whether a poll request for all processes is pending.
+ */
+static volatile bool poll_all_request_is_pending = false;
 
 /**
  * Request that the event loop polls all processes.
+ *
+ * This is used by the 1ms clock tick so that timers in all processes are
+ * checked. Drivers that know which process is waiting for them should use
+ * ::pbio_os_process_request_poll instead.
  */
 void pbio_os_request_poll(void) {
-    poll_request_is_pending = true;
+    poll_all_request_is_pending = true;
+    pbio_os_poll_request_is_pending = true;
+}
+
+/**
+ * Request that the event loop polls only the given process.
+ *
+ * Can be called from interrupt handlers.
+ *
+ * @param process   The process to poll. If NULL, all processes are polled.
+ */
+void pbio_os_process_request_poll(pbio_os_process_t *process) {
+    if (!process) {
+        pbio_os_request_poll();
+        return;
+    }
+    process->poll_pending = true;
+    pbio_os_poll_request_is_pending = true;
 }
 
+/**
+ * The process that is currently being run by the event loop, if any.
+ */
+static pbio_os_process_t *current_process = NULL;
+
+/**
+ * Gets the process that is currently being run by the event loop.
+ *
+ * Drivers can use this in their async functions to remember which process is
+ * awaiting them, so that their interrupt handlers can poll just that process.
+ *
+ * @return          The current process, or NULL if the caller is not running
+ *                  as part of a process, such as when an async function is
+ *                  polled directly by the application.
+ */
+pbio_os_process_t *pbio_os_get_current_process(void) {
+    return current_process;
+}
 
 /**
  * Placeholder thread that does nothing and never completes.
@@ -93,9 +154,55 @@ static void add_process(pbio_os_process_t *process) {
         pp = &(*pp)->next;
     }
 
-    // Insert at end.
+    // Insert after the last process with the same or higher priority.
+    pp = &process_list;
+    while (*pp && (*pp)->priority >= process->priority) {
+        pp = &(*pp)->next;
+    }
+    process->next = *pp;
     *pp = process;
-    process->next = NULL;
+}
+
+static void remove_process(pbio_os_process_t *process) {
+    for (pbio_os_process_t **pp = &process_list; *pp; pp = &(*pp)->next) {
+        if (*pp == process) {
+            *pp = process->next;
+            process->next = NULL;
+            return;
+        }
+    }
+}
+
+/**
+ * Sets the scheduling priority of a process.
+ *
+ * This may be called before or after the process is started. The priority is
+ * retained when the process is restarted.
+ *
+ * @param process   The process.
+ * @param priority  The new priority.
+ */
+void pbio_os_process_set_priority(pbio_os_process_t *process, pbio_os_process_priority_t priority) {
+
+    if (process->priority == priority) {
+        return;
+    }
+
+    // If it was already in the list, move it to the new position.
+    bool was_added = false;
+    for (pbio_os_process_t *p = process_list; p; p = p->next) {
+        if (p == process) {
+            was_added = true;
+            break;
+        }
+    }
+
+    remove_process(process);
+    process->priority = priority;
+
+    if (was_added) {
+        add_process(process);
+    }
 }
 
 /**
@@ -117,9 +224,202 @@ void pbio_os_process_start(pbio_os_process_t *process, pbio_os_process_func_t fu
     process->func = func;
 
     // Request a poll to start the process soon, running to its first yield.
-    pbio_os_request_poll();
+    pbio_os_process_request_poll(process);
 }
 
+/**
+ * Gets the next process in the list, in order of priority.
+ *
+ * This can be used to iterate over all processes for diagnostics.
+ *
+ * @param process   The current process, or NULL to get the first process.
+ * @return          The next process, or NULL if there are no more processes.
+ */
+pbio_os_process_t *pbio_os_process_get_next(pbio_os_process_t *process) {
+    return process ? process->next : process_list;
+}
+
+#if PBIO_CONFIG_OS_PROFILE
+
+/**
+ * Total time spent waiting for interrupts in microseconds.
+ */
+static uint32_t idle_time_us;
+
+/**
+ * Gets the total time spent waiting for interrupts with nothing else to do.
+ *
+ * @return          The idle time in microseconds.
+ */
+uint32_t pbio_os_get_idle_time_us(void) {
+    return idle_time_us;
+}
+
+/**
+ * Resets the idle time and the execution time statistics of all processes.
+ */
+void pbio_os_reset_stats(void) {
+    idle_time_us = 0;
+    for (pbio_os_process_t *p = process_list; p; p = p->next) {
+        p->stats = (pbio_os_process_stats_t) {0};
+    }
+}
+
+/**
+ * Runs one iteration of a process and updates its execution time statistics.
+ *
+ * @param process   The process.
+ * @return          The result of the protothread.
+ */
+static pbio_error_t run_process(pbio_os_process_t *process) {
+    uint32_t start = pbdrv_clock_get_us();
+    pbio_error_t err = process->func(&process->state, process->context);
+    uint32_t duration = pbdrv_clock_get_us() - start;
+
+    pbio_os_process_stats_t *stats = &process->stats;
+    stats->num_calls++;
+    stats->time_total_us += duration;
+    if (duration > stats->time_max_us) {
+        stats->time_max_us = duration;
+    }
+    return err;
+}
+
+#else
+
+static inline pbio_error_t run_process(pbio_os_process_t *process) {
+    return process->func(&process->state, process->context);
+}
+
+#endif // PBIO_CONFIG_OS_PROFILE
+
+#if PBIO_CONFIG_OS_STALL_MONITOR
+
+/**
+ * Longest stall of the event loop since the last reset.
+ */
+static pbio_os_stall_t stall;
+
+/**
+ * Time at which the event loop last finished running a process or waiting
+ * for events, in microseconds.
+ */
+static uint32_t stall_mark_us;
+
+/**
+ * Records the time since the previous mark as a possible stall.
+ *
+ * @param process   The process that just ran, or NULL if the time was spent
+ *                  outside of the event loop.
+ */
+static void update_stall(pbio_os_process_t *process) {
+    uint32_t now = pbdrv_clock_get_us();
+    uint32_t duration = now - stall_mark_us;
+    stall_mark_us = now;
+    if (duration > stall.time_us) {
+        stall.time_us = duration;
+        stall.process = process;
+    }
+}
+
+/**
+ * Gets the longest stall of the event loop since the last reset.
+ *
+ * @param [out] result  The stall.
+ */
+void pbio_os_get_stall(pbio_os_stall_t *result) {
+    *result = stall;
+}
+
+/**
+ * Resets the longest stall of the event loop.
+ */
+void pbio_os_reset_stall(void) {
+    stall = (pbio_os_stall_t) {0};
+}
+
+#else
+
+static inline void update_stall(pbio_os_process_t *process) {
+}
+
+#endif // PBIO_CONFIG_OS_STALL_MONITOR
+
+#if PBIO_CONFIG_OS_TICKLESS
+
+/**
+ * Whether the clock tick may be stopped while waiting for events.
+ */
+static bool tickless_idle_enabled;
+
+/**
+ * Allows or disallows stopping the clock tick while waiting for events.
+ *
+ * This should only be enabled while the system is idle. Code outside of
+ * processes, such as a running user program, may wait on the clock without
+ * using timers, so it would not be woken up in time.
+ *
+ * While enabled, processes must either wait for a timer or be woken up by
+ * poll requests from interrupts. Processes that wait for anything else keep
+ * the 1 ms tick running.
+ *
+ * @param enable    Whether to allow stopping the clock tick.
+ */
+void pbio_os_set_tickless_idle(bool enable) {
+    tickless_idle_enabled = enable;
+}
+
+/**
+ * Records the deadline of a timer that has not yet expired, so the event loop
+ * knows when the current process needs to run again.
+ *
+ * @param deadline  The time at which the timer expires.
+ */
+static void update_wake_time(uint32_t deadline) {
+    pbio_os_process_t *process = current_process;
+    if (!process) {
+        return;
+    }
+    if (!process->wake_time_valid || pbio_util_time_has_passed(process->wake_time, deadline)) {
+        process->wake_time = deadline;
+        process->wake_time_valid = true;
+    }
+}
+
+/**
+ * Gets how long the event loop may sleep without missing any timer.
+ *
+ * @return          The sleep time in milliseconds. This is 0 if the clock tick
+ *                  must keep running.
+ */
+static uint32_t get_tickless_duration(void) {
+
+    if (!tickless_idle_enabled) {
+        return 0;
+    }
+
+    uint32_t now = pbdrv_clock_get_ms();
+    uint32_t duration = UINT32_MAX;
+
+    for (pbio_os_process_t *p = process_list; p; p = p->next) {
+        // Completed processes and placeholders don't need to wake up.
+        if (p->err != PBIO_ERROR_AGAIN || p->func == pbio_port_process_none_thread) {
+            continue;
+        }
+        // Processes that wait for something other than a timer, or whose
+        // timer has just expired, need the tick.
+        if (!p->wake_time_valid || pbio_util_time_has_passed(now, p->wake_time)) {
+            return 0;
+        }
+        if (p->wake_time - now < duration) {
+            duration = p->wake_time - now;
+        }
+    }
+    return duration;
+}
+
+#endif // PBIO_CONFIG_OS_TICKLESS
+
 /**
  * Makes a request to a process.
  *
@@ -131,11 +431,12 @@ void pbio_os_process_start(pbio_os_process_t *process, pbio_os_process_func_t fu
  */
 void pbio_os_process_make_request(pbio_os_process_t *process, pbio_os_process_request_type_t request) {
     process->request = request;
-    pbio_os_request_poll();
+    pbio_os_process_request_poll(process);
 }
 
 /**
- * Drives the event loop once: Runs one iteration of all processes.
+ * Drives the event loop once: Runs one iteration of all processes that have
+ * been polled, in order of priority.
  *
  * Can be used in hooks from blocking loops.
  *
@@ -143,23 +444,45 @@ void pbio_os_process_make_request(pbio_os_process_t *process, pbio_os_process_re
  */
 bool pbio_os_run_processes_once(void) {
 
-    if (!poll_request_is_pending) {
+    if (!pbio_os_poll_request_is_pending) {
         return false;
     }
 
-    poll_request_is_pending = false;
+    // Clear flags before running the processes. Requests made while running
+    // them will be handled on the next pass.
+    pbio_os_poll_request_is_pending = false;
+    bool poll_all = poll_all_request_is_pending;
+    poll_all_request_is_pending = false;
+
+    pbio_tracepoint_record(PBIO_TRACEPOINT_OS_RUN_START, 0, 0);
+    uint16_t num_run = 0;
+
+    // Time since the previous pass was spent outside of the event loop.
+    update_stall(NULL);
 
     pbio_os_process_t *process = process_list;
     while (process) {
-        // Run one iteration of the process if not yet completed or errored.
-        if (process->err == PBIO_ERROR_AGAIN) {
-            process->err = process->func(&process->state, process->context);
+        // Run one iteration of the process if not yet completed or errored,
+        // but only if it was signaled to run.
+        if (process->err == PBIO_ERROR_AGAIN && (poll_all || process->poll_pending)) {
+            process->poll_pending = false;
+            pbio_os_process_t *previous_process = current_process;
+            current_process = process;
+            #if PBIO_CONFIG_OS_TICKLESS
+            process->wake_time_valid = false;
+            #endif
+            process->err = run_process(process);
+            update_stall(process);
+            current_process = previous_process;
+            num_run++;
         }
         process = process->next;
     }
 
+    pbio_tracepoint_record(PBIO_TRACEPOINT_OS_RUN_END, num_run, 0);
+
     // Poll requests may have been set while running the processes.
-    return poll_request_is_pending;
+    return pbio_os_poll_request_is_pending;
 }
 
 /**
@@ -167,7 +490,8 @@ bool pbio_os_run_processes_once(void) {
  *
  * Expected to be called in a loop. This will keep running the event loop but
  * enter a low power mode when possible. It will sleep for at most one
- * millisecond.
+ * millisecond, unless tickless idle is enabled with
+ * ::pbio_os_set_tickless_idle and all processes are waiting for timers.
  */
 void pbio_os_run_processes_and_wait_for_event(void) {
 
@@ -177,16 +501,43 @@ void pbio_os_run_processes_and_wait_for_event(void) {
     }
 
     // It is possible that an interrupt occurs *just now* and sets the
-    // poll_request_is_pending flag. If not, we can call wait_for_interrupt(),
-    // which still wakes up the CPU on interrupt even though interrupts are
-    // otherwise disabled.
+    // pbio_os_poll_request_is_pending flag. If not, we can call
+    // wait_for_interrupt(), which still wakes up the CPU on interrupt even
+    // though interrupts are otherwise disabled.
     pbio_os_irq_flags_t irq_flags = pbio_os_hook_disable_irq();
 
-    if (!poll_request_is_pending) {
+    #if PBIO_CONFIG_OS_PROFILE
+    uint32_t idle_start = pbdrv_clock_get_us();
+    bool did_wait = !pbio_os_poll_request_is_pending;
+    #endif
+
+    if (!pbio_os_poll_request_is_pending) {
+        #if PBIO_CONFIG_OS_TICKLESS
+        uint32_t duration = get_tickless_duration();
+        if (duration > 1) {
+            pbio_os_hook_wait_for_interrupt_tickless(irq_flags, duration);
+        } else {
+            pbio_os_hook_wait_for_interrupt(irq_flags);
+        }
+        #else
         pbio_os_hook_wait_for_interrupt(irq_flags);
+        #endif
     }
     pbio_os_hook_enable_irq(irq_flags);
 
+    // Waiting for events is not a stall.
+    #if PBIO_CONFIG_OS_STALL_MONITOR
+    stall_mark_us = pbdrv_clock_get_us();
+    #endif
+
+    // Measured after enabling interrupts, so that the clock interrupt that
+    // woke us up has been handled.
+    #if PBIO_CONFIG_OS_PROFILE
+    if (did_wait) {
+        idle_time_us += pbdrv_clock_get_us() - idle_start;
+    }
+    #endif
+
     // Since this function is expected to be called in a loop, pending events
     // will be handled right away on the next entry. If not, then they will be
     // handled "soon".
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pbio/config.h>
+#include <pbio/os.h>
+#include <pbio/pf_ir.h>
+
+#include <lego/device.h>
+
+/**
+ * Message bit that selects single output mode. The output is in bit 4.
+ */
+#define PF_IR_SINGLE_OUTPUT (1 << 6)
+
+/**
+ * Message bit that selects combo PWM mode. The blue output is in bits 4-7
+ * and the red output in bits 0-3.
+ */
+#define PF_IR_COMBO_PWM (1 << 10)
+
+/**
+ * Empties the queue and marks all outputs as not set and unknown to the
+ * receiver.
+ *
+ * @param [in]  queue   The queue.
+ */
+void pbio_pf_ir_queue_reset(pbio_pf_ir_queue_t *queue) {
+    // Unknown for both, so outputs are sent only once they are set.
+    memset(queue->channels, PBIO_PF_IR_VALUE_UNKNOWN, sizeof(queue->channels));
+    for (uint8_t i = 0; i < PBIO_PF_IR_NUM_CHANNELS; i++) {
+        queue->channels[i].combo = false;
+        queue->channels[i].sent_time = 0;
+    }
+    queue->next_channel = 0;
+}
+
+/**
+ * Sets the value of an output. This replaces any value that was not sent yet.
+ *
+ * @param [in]  queue   The queue.
+ * @param [in]  channel The channel, 0 to 3.
+ * @param [in]  output  The output.
+ * @param [in]  value   PWM value: 0 for float, 1 to 7 forward, 8 for brake,
+ *                      9 to 15 backward.
+ */
+void pbio_pf_ir_queue_set(pbio_pf_ir_queue_t *queue, uint8_t channel, pbio_pf_ir_output_t output, uint8_t value) {
+    queue->channels[channel].desired[output] = value & 0x0F;
+}
+
+/**
+ * Tests if an output was set to a value that the receiver does not have.
+ *
+ * @param [in]  ch      The channel.
+ * @param [in]  output  The output.
+ * @return              True if the output needs to be sent.
+ */
+static bool pbio_pf_ir_output_changed(const pbio_pf_ir_channel_t *ch, pbio_pf_ir_output_t output) {
+    return ch->desired[output] != PBIO_PF_IR_VALUE_UNKNOWN && ch->desired[output] != ch->sent[output];
+}
+
+/**
+ * Tests if a channel needs to be sent.
+ *
+ * @param [in]  ch      The channel.
+ * @param [in]  now     Current time in ms.
+ * @return              True if an output changed or a refresh is due.
+ */
+static bool pbio_pf_ir_channel_is_due(const pbio_pf_ir_channel_t *ch, uint32_t now) {
+    return pbio_pf_ir_output_changed(ch, PBIO_PF_IR_OUTPUT_RED) ||
+           pbio_pf_ir_output_changed(ch, PBIO_PF_IR_OUTPUT_BLUE) ||
+           (ch->combo && now - ch->sent_time >= PBIO_PF_IR_REFRESH_MS);
+}
+
+/**
+ * Gets the next message to send and marks it as sent.
+ *
+ * Channels are visited in turn, starting after the one that was sent last.
+ *
+ * @param [in]  queue   The queue.
+ * @param [in]  now     Current time in ms.
+ * @param [out] message The message for the IR transmit mode of the sensor.
+ * @return              True if there is a message, false if nothing is due.
+ */
+bool pbio_pf_ir_queue_pop(pbio_pf_ir_queue_t *queue, uint32_t now, uint16_t *message) {
+
+    for (uint8_t i = 0; i < PBIO_PF_IR_NUM_CHANNELS; i++) {
+        uint8_t index = (queue->next_channel + i) % PBIO_PF_IR_NUM_CHANNELS;
+        pbio_pf_ir_channel_t *ch = &queue->channels[index];
+        if (!pbio_pf_ir_channel_is_due(ch, now)) {
+            continue;
+        }
+
+        uint8_t red = ch->desired[PBIO_PF_IR_OUTPUT_RED];
+        uint8_t blue = ch->desired[PBIO_PF_IR_OUTPUT_BLUE];
+        bool red_changed = pbio_pf_ir_output_changed(ch, PBIO_PF_IR_OUTPUT_RED);
+        bool blue_changed = pbio_pf_ir_output_changed(ch, PBIO_PF_IR_OUTPUT_BLUE);
+
+        if (ch->combo || (red_changed && blue_changed)) {
+            // Both outputs in one message. This must be repeated while
+            // either output is on.
+            *message = PF_IR_COMBO_PWM | index << 8 | blue << 4 | red;
+            ch->sent[PBIO_PF_IR_OUTPUT_RED] = red;
+            ch->sent[PBIO_PF_IR_OUTPUT_BLUE] = blue;
+            ch->combo = red || blue;
+        } else {
+            pbio_pf_ir_output_t output = red_changed ? PBIO_PF_IR_OUTPUT_RED : PBIO_PF_IR_OUTPUT_BLUE;
+            *message = PF_IR_SINGLE_OUTPUT | index << 8 | output << 4 | ch->desired[output];
+            ch->sent[output] = ch->desired[output];
+        }
+
+        ch->sent_time = now;
+        queue->next_channel = (index + 1) % PBIO_PF_IR_NUM_CHANNELS;
+        return true;
+    }
+    return false;
+}
+
+#if PBIO_CONFIG_PF_IR
+
+#include <pbdrv/clock.h>
+
+/**
+ * Queues of all sensors. Each sensor is on its own port.
+ */
+static pbio_pf_ir_queue_t queues[PBIO_CONFIG_PORT_NUM_DEV];
+
+static pbio_os_process_t pbio_pf_ir_process;
+
+/**
+ * Tests if any sensor has a queue.
+ *
+ * @return  True if at least one queue is in use.
+ */
+static bool pbio_pf_ir_in_use(void) {
+    for (uint8_t i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
+        if (queues[i].lump_dev) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Sends the next message of each sensor when the sensor is ready for it.
+ *
+ * The process ends when no queues are in use and is started again when
+ * an output is set.
+ */
+static pbio_error_t pbio_pf_ir_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    while (pbio_pf_ir_in_use()) {
+        for (uint8_t i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
+            pbio_pf_ir_queue_t *queue = &queues[i];
+            if (!queue->lump_dev) {
+                continue;
+            }
+
+            pbio_error_t err = pbio_port_lump_is_ready(queue->lump_dev);
+            if (err == PBIO_ERROR_NO_DEV) {
+                // Sensor was unplugged, so forget what the receivers have.
+                pbio_pf_ir_queue_reset(queue);
+                queue->lump_dev = NULL;
+                continue;
+            }
+
+            uint16_t message;
+            if (err == PBIO_SUCCESS && pbio_pf_ir_queue_pop(queue, pbdrv_clock_get_ms(), &message)) {
+                pbio_port_lump_set_mode_with_data(queue->lump_dev, LEGO_DEVICE_MODE_PUP_COLOR_DISTANCE_SENSOR__IR_TX, &message, sizeof(message));
+            }
+        }
+
+        // The sensor is ready again about 250 ms after each message, so
+        // checking more often than this does not delay messages noticeably.
+        PBIO_OS_AWAIT_MS(state, &timer, 10);
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Sets the value of a Power Functions output. It is sent in the background.
+ *
+ * @param [in]  lump_dev    The Color and Distance Sensor that sends it.
+ * @param [in]  channel     The channel, 0 to 3.
+ * @param [in]  output      The output.
+ * @param [in]  value       PWM value as in ::pbio_pf_ir_queue_set.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_INVALID_ARG if the channel is not valid.
+ *                          ::PBIO_ERROR_NO_DEV if there is no sensor.
+ */
+pbio_error_t pbio_pf_ir_set(pbio_port_lump_dev_t *lump_dev, uint8_t channel, pbio_pf_ir_output_t output, uint8_t value) {
+
+    if (!lump_dev) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    if (channel >= PBIO_PF_IR_NUM_CHANNELS) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // Use the queue of this sensor or else a free one. There is one for each
+    // port, so there is always room.
+    pbio_pf_ir_queue_t *queue = NULL;
+    for (uint8_t i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
+        if (queues[i].lump_dev == lump_dev) {
+            queue = &queues[i];
+            break;
+        }
+        if (!queue && !queues[i].lump_dev) {
+            queue = &queues[i];
+        }
+    }
+    if (!queue) {
+        return PBIO_ERROR_FAILED;
+    }
+    if (queue->lump_dev != lump_dev) {
+        pbio_pf_ir_queue_reset(queue);
+        queue->lump_dev = lump_dev;
+    }
+
+    pbio_pf_ir_queue_set(queue, channel, output, value);
+
+    if (pbio_pf_ir_process.err != PBIO_ERROR_AGAIN) {
+        pbio_os_process_start(&pbio_pf_ir_process, pbio_pf_ir_process_thread, NULL);
+    }
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Discards all queued messages. Called when the user program ends.
+ */
+void pbio_pf_ir_reset(void) {
+    for (uint8_t i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
+        pbio_pf_ir_queue_reset(&queues[i]);
+        queues[i].lump_dev = NULL;
+    }
+}
+
+#endif // PBIO_CONFIG_PF_IR
@@ -1,6 +1,10 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2018-2025 The Pybricks Authors
 
+#include <string.h>
+
+#include <pbdrv/adc.h>
+#include <pbdrv/clock.h>
 #include <pbdrv/counter.h>
 #include <pbdrv/i2c.h>
 #include <pbdrv/ioport.h>
@@ -35,6 +39,48 @@
 
 #if PBIO_CONFIG_PORT
 
+#if PBDRV_CONFIG_I2C
+
+/**
+ * Maximum number of bytes read by an I2C polling job.
+ */
+#define PBIO_PORT_I2C_POLL_MAX_SIZE (16)
+
+/**
+ * Job that reads an I2C register periodically in the port process.
+ */
+typedef struct {
+    /** Time between reads in ms, or 0 if this job is not active. */
+    uint32_t interval;
+    /** I2C device address (unshifted). */
+    uint8_t address;
+    /** Register to read. */
+    uint8_t reg;
+    /** Number of bytes to read. */
+    uint8_t len;
+    /** Whether to use NXT I2C transaction quirk. */
+    bool nxt_quirk;
+    /** Incremented when the job changes, so stale reads are discarded. */
+    uint8_t id;
+    /** Value of id when the ongoing read started. */
+    uint8_t read_id;
+    /**
+     * Result of the most recent read for the current job, or
+     * ::PBIO_ERROR_AGAIN if there is none yet. Data is valid on success.
+     */
+    pbio_error_t err;
+    /** Time of the most recent successful read. */
+    uint32_t time;
+    /** Data of the most recent successful read. */
+    uint8_t data[PBIO_PORT_I2C_POLL_MAX_SIZE];
+    /** Timer for the next read. */
+    pbio_os_timer_t timer;
+    /** Protothread state of the ongoing read. */
+    pbio_os_state_t child;
+} pbio_port_i2c_poll_t;
+
+#endif // PBDRV_CONFIG_I2C
+
 /**
  * Port instance.
  */
@@ -88,6 +134,12 @@ struct _pbio_port_t {
      * LEGO UART Messaging Protocol device instance.
      */
     pbio_port_lump_dev_t *lump_dev;
+    #if PBDRV_CONFIG_I2C
+    /**
+     * Background I2C polling job.
+     */
+    pbio_port_i2c_poll_t i2c_poll;
+    #endif
 };
 
 static pbio_port_t ports[PBIO_CONFIG_PORT_NUM_DEV];
@@ -96,6 +148,143 @@ static bool pbio_port_dcm_test_type_id(pbio_port_t *port, lego_device_type_id_t
     return pbio_port_dcm_assert_type_id(port->connection_manager, &range) == PBIO_SUCCESS;
 }
 
+#if PBDRV_CONFIG_I2C
+
+/**
+ * Runs the I2C polling job of a port. Never completes.
+ *
+ * In LEGO mode, this runs alongside the device connection manager and only
+ * reads while an I2C device is detected. In I2C mode, this is the process.
+ *
+ * @param [in]  state       The protothread state.
+ * @param [in]  context     The port instance.
+ */
+static pbio_error_t pbio_port_i2c_poll_thread(pbio_os_state_t *state, void *context) {
+
+    pbio_port_t *port = context;
+    pbio_port_i2c_poll_t *poll = &port->i2c_poll;
+    uint8_t *rdata = NULL;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, poll->interval && pbio_os_timer_is_expired(&poll->timer));
+        pbio_os_timer_set(&poll->timer, poll->interval);
+
+        if (port->mode != PBIO_PORT_MODE_I2C && !pbio_port_dcm_test_type_id(port, LEGO_DEVICE_TYPE_ID_NXT_I2C)) {
+            poll->err = PBIO_ERROR_NO_DEV;
+            continue;
+        }
+
+        poll->read_id = poll->id;
+        PBIO_OS_AWAIT(state, &poll->child, err = pbdrv_i2c_write_then_read(&poll->child, port->i2c_dev, poll->address, &poll->reg, 1, &rdata, poll->len, poll->nxt_quirk));
+
+        // Results of a job that was replaced while reading are discarded. If
+        // the user is accessing the bus at the same time, this just tries
+        // again next time.
+        if (poll->read_id != poll->id || err == PBIO_ERROR_BUSY) {
+            continue;
+        }
+        if (err == PBIO_SUCCESS) {
+            memcpy(poll->data, rdata, poll->len);
+            poll->time = pbdrv_clock_get_ms();
+        }
+        poll->err = err;
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_ERROR_FAILED);
+}
+
+/**
+ * Stops the I2C polling job of a port, if any.
+ *
+ * @param [in]  port        The port instance.
+ */
+static void pbio_port_i2c_poll_stop(pbio_port_t *port) {
+    port->i2c_poll.interval = 0;
+    port->i2c_poll.err = PBIO_ERROR_AGAIN;
+    port->i2c_poll.id++;
+}
+
+/**
+ * Starts reading an I2C register periodically in the background. The most
+ * recent result can be read instantly with ::pbio_port_i2c_poll_get.
+ *
+ * There is one job per port. Starting a new one replaces the previous job.
+ * Other operations on the same device may fail with ::PBIO_ERROR_BUSY if
+ * they start while the job is reading.
+ *
+ * @param [in]  port        The port instance.
+ * @param [in]  address     I2C device address (unshifted).
+ * @param [in]  reg         Register to read.
+ * @param [in]  len         Number of bytes to read.
+ * @param [in]  interval    Time between reads in ms, or 0 to stop polling.
+ * @param [in]  nxt_quirk   Whether to use NXT I2C transaction quirk.
+ * @return                  ::PBIO_SUCCESS on success, otherwise
+ *                          ::PBIO_ERROR_NOT_SUPPORTED if this port does not support I2C.
+ *                          ::PBIO_ERROR_INVALID_OP if this port is not in a compatible mode.
+ *                          ::PBIO_ERROR_INVALID_ARG if the length is not supported.
+ */
+pbio_error_t pbio_port_i2c_poll_start(pbio_port_t *port, uint8_t address, uint8_t reg, uint8_t len, uint32_t interval, bool nxt_quirk) {
+    if (!port->i2c_dev) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+    if (port->mode != PBIO_PORT_MODE_I2C && port->mode != PBIO_PORT_MODE_LEGO_DCM) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+    if (len == 0 || len > PBIO_PORT_I2C_POLL_MAX_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbio_port_i2c_poll_stop(port);
+    if (!interval) {
+        return PBIO_SUCCESS;
+    }
+
+    pbio_port_i2c_poll_t *poll = &port->i2c_poll;
+    poll->address = address;
+    poll->reg = reg;
+    poll->len = len;
+    poll->nxt_quirk = nxt_quirk;
+    poll->interval = interval;
+    pbio_os_timer_set(&poll->timer, 0);
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Gets the most recent result of the I2C polling job of a port.
+ *
+ * @param [in]  port        The port instance.
+ * @param [in]  address     I2C device address (unshifted).
+ * @param [in]  reg         Register to read.
+ * @param [in]  len         Number of bytes to read.
+ * @param [out] data        The data. Remains valid until the next read.
+ * @param [out] time        Time of the read in ms. Can be NULL.
+ * @return                  ::PBIO_SUCCESS on success, otherwise
+ *                          ::PBIO_ERROR_INVALID_OP if this register is not being polled.
+ *                          ::PBIO_ERROR_AGAIN if there is no result yet.
+ *                          ::PBIO_ERROR_NO_DEV if no I2C device is detected.
+ *                          Other errors if the most recent read failed.
+ */
+pbio_error_t pbio_port_i2c_poll_get(pbio_port_t *port, uint8_t address, uint8_t reg, uint8_t len, uint8_t **data, uint32_t *time) {
+    pbio_port_i2c_poll_t *poll = &port->i2c_poll;
+    if (!poll->interval || poll->address != address || poll->reg != reg || poll->len != len) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+    if (poll->err != PBIO_SUCCESS) {
+        return poll->err;
+    }
+    *data = poll->data;
+    if (time) {
+        *time = poll->time;
+    }
+    return PBIO_SUCCESS;
+}
+
+#endif // PBDRV_CONFIG_I2C
+
 /**
  * This is the high level process that monitors and drives official LEGO
  * devices that support some form of automatic detection. There is one process
@@ -126,7 +315,16 @@ static pbio_error_t pbio_port_process_lego_dcm_thread(pbio_os_state_t *state, vo
         // Run passive device connection manager until smart device is detected.
         pbdrv_ioport_p5p6_set_mode(port->pdata->pins, PBDRV_IOPORT_P5P6_MODE_GPIO_ADC);
         pbio_port_p1p2_set_power(port, PBIO_PORT_POWER_REQUIREMENTS_NONE);
+        #if PBDRV_CONFIG_I2C
+        // The I2C polling job never completes, so this completes when the
+        // device connection manager does.
+        PBIO_OS_AWAIT_RACE(state, &port->child1, &port->child2,
+            err = pbio_port_dcm_thread(&port->child1, &port->timer, port->connection_manager, port->pdata->pins),
+            pbio_port_i2c_poll_thread(&port->child2, port)
+            );
+        #else
         PBIO_OS_AWAIT(state, &port->child1, err = pbio_port_dcm_thread(&port->child1, &port->timer, port->connection_manager, port->pdata->pins));
+        #endif
 
         // Active device detected. Check type to decide next steps.
         if (pbio_port_dcm_test_type_id(port, LEGO_DEVICE_TYPE_ID_ANY_LUMP_UART)) {
@@ -195,6 +393,29 @@ pbio_error_t pbio_port_get_abs_angle(pbio_port_t *port, pbio_angle_t *angle) {
     return PBIO_ERROR_NO_DEV;
 }
 
+/**
+ * Gets the speed from the time between encoder edges, if supported.
+ *
+ * @param [in]  port      The port instance.
+ * @param [out] speed     The speed in millidegrees per second.
+ * @return                ::PBIO_SUCCESS on success.
+ *                        ::PBIO_ERROR_AGAIN if there is no estimate yet.
+ *                        ::PBIO_ERROR_NO_DEV if no device that reports
+ *                          angles is attached.
+ *                        ::PBIO_ERROR_NOT_SUPPORTED if the device does not
+ *                          support edge timing.
+ */
+pbio_error_t pbio_port_get_edge_speed(pbio_port_t *port, int32_t *speed) {
+    if (port->lump_dev) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+
+    if (port->counter) {
+        return pbdrv_counter_get_edge_speed(port->counter, speed);
+    }
+    return PBIO_ERROR_NO_DEV;
+}
+
 /**
  * Gets the UART interface of the port.
  *
@@ -375,6 +596,89 @@ pbio_error_t pbio_port_set_type(pbio_port_t *port, lego_device_type_id_t type_id
     return pbio_port_dcm_set_type_id(port->connection_manager, type_id);
 }
 
+/**
+ * Gets the latest state of the device on a port in one pass, so that all
+ * ports can be sampled at nearly the same time.
+ *
+ * The device type is detected as for the port view. Motor angle and speed
+ * come from the motor object if it is set up, otherwise the angle comes
+ * directly from the rotation sensor. Passive devices report the raw analog
+ * value.
+ *
+ * @param [in]  port        The port instance.
+ * @param [out] buf         Buffer of ::PBIO_PORT_SNAPSHOT_SIZE bytes, see
+ *                          there for the layout.
+ */
+void pbio_port_get_snapshot(pbio_port_t *port, uint8_t *buf) {
+
+    memset(buf, 0, PBIO_PORT_SNAPSHOT_SIZE);
+
+    lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_ANY_LUMP_UART;
+    pbio_port_lump_dev_t *lump_dev;
+    pbio_dcmotor_t *dcmotor;
+    uint8_t flags = 0;
+
+    if (pbio_port_get_lump_device(port, &type_id, &lump_dev) == PBIO_SUCCESS) {
+        // Data of the current mode of a sensor.
+        uint8_t num_modes;
+        uint8_t mode;
+        pbio_port_lump_mode_info_t *mode_info;
+        void *data;
+        if (pbio_port_lump_get_info(lump_dev, &num_modes, &mode, &mode_info) == PBIO_SUCCESS &&
+            pbio_port_lump_get_data(lump_dev, mode, &data) == PBIO_SUCCESS) {
+            size_t size = mode_info[mode].num_values * pbio_port_lump_data_size(mode_info[mode].data_type);
+            size = size < PBIO_PORT_SNAPSHOT_DATA_SIZE ? size : PBIO_PORT_SNAPSHOT_DATA_SIZE;
+            buf[2] = mode;
+            buf[3] = size;
+            memcpy(&buf[12], data, size);
+            flags |= PBIO_PORT_SNAPSHOT_FLAG_LUMP_DATA;
+        }
+    } else {
+        // Motors with rotation sensors report their exact type.
+        type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+        pbio_servo_t *srv;
+        if (pbio_port_get_servo(port, &type_id, &srv) != PBIO_SUCCESS) {
+            type_id = LEGO_DEVICE_TYPE_ID_ANY_DC_MOTOR;
+            if (pbio_port_get_dcmotor(port, &type_id, &dcmotor) != PBIO_SUCCESS) {
+                type_id = LEGO_DEVICE_TYPE_ID_NONE;
+            }
+        }
+    }
+
+    #if PBIO_CONFIG_SERVO
+    lego_device_type_id_t servo_type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    pbio_servo_t *srv;
+    int32_t angle;
+    int32_t speed;
+    if (pbio_port_get_servo(port, &servo_type_id, &srv) == PBIO_SUCCESS &&
+        pbio_servo_get_state_user(srv, &angle, &speed) == PBIO_SUCCESS) {
+        pbio_set_uint32_le(&buf[4], angle);
+        pbio_set_uint32_le(&buf[8], speed);
+        flags |= PBIO_PORT_SNAPSHOT_FLAG_ANGLE | PBIO_PORT_SNAPSHOT_FLAG_SERVO;
+    }
+    #endif
+
+    pbio_angle_t port_angle;
+    if (!(flags & PBIO_PORT_SNAPSHOT_FLAG_ANGLE) && pbio_port_get_angle(port, &port_angle) == PBIO_SUCCESS) {
+        pbio_set_uint32_le(&buf[4], pbio_angle_to_low_res(&port_angle, 1000));
+        flags |= PBIO_PORT_SNAPSHOT_FLAG_ANGLE;
+    }
+    if (type_id == LEGO_DEVICE_TYPE_ID_ANY_DC_MOTOR && (flags & PBIO_PORT_SNAPSHOT_FLAG_ANGLE)) {
+        type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    }
+
+    // Raw value of passive devices and of ports in ADC mode.
+    if (type_id == LEGO_DEVICE_TYPE_ID_NONE && port->connection_manager &&
+        (port->mode == PBIO_PORT_MODE_LEGO_DCM || port->mode == PBIO_PORT_MODE_GPIO_ADC)) {
+        pbio_set_uint32_le(&buf[12], pbio_port_dcm_get_analog_value(port->connection_manager, port->pdata->pins, false));
+        buf[3] = sizeof(uint32_t);
+        flags |= PBIO_PORT_SNAPSHOT_FLAG_ANALOG;
+    }
+
+    buf[0] = type_id;
+    buf[1] = flags;
+}
+
 /**
  * Gets the analog value of the LEGO device.
  *
@@ -403,6 +707,58 @@ pbio_error_t pbio_port_get_analog_value(pbio_port_t *port, lego_device_type_id_t
     return PBIO_SUCCESS;
 }
 
+/**
+ * Starts capturing the analog value of the LEGO device at a fixed rate.
+ *
+ * Any capture in progress on any port is stopped.
+ *
+ * @param [in]  port        The port instance.
+ * @param [in]  type_id     The expected type identifier.
+ * @param [in]  active      Whether to use the active mode of the sensor.
+ * @param [in]  buf         Buffer for the samples, which must remain valid
+ *                          until the capture completes or is stopped.
+ * @param [in]  len         Number of samples to capture.
+ * @param [in]  period_us   Time between samples in microseconds.
+ * @param [in]  decimation  Number of ADC samples averaged into each sample.
+ * @return                  ::PBIO_SUCCESS on success, ::PBIO_ERROR_NO_DEV if
+ *                          the expected device is not connected,
+ *                          ::PBIO_ERROR_INVALID_ARG if the rate is not
+ *                          supported.
+ */
+pbio_error_t pbio_port_start_analog_capture(pbio_port_t *port, lego_device_type_id_t type_id, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+    if (!port->connection_manager || !(port->mode == PBIO_PORT_MODE_LEGO_DCM || port->mode == PBIO_PORT_MODE_GPIO_ADC)) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    if (port->mode == PBIO_PORT_MODE_LEGO_DCM) {
+        pbio_error_t err = pbio_port_dcm_assert_type_id(port->connection_manager, &type_id);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+    }
+
+    return pbio_port_dcm_start_analog_capture(port->connection_manager, port->pdata->pins, active, buf, len, period_us, decimation);
+}
+
+/**
+ * Awaits until an analog capture completes and converts the samples to
+ * millivolts.
+ *
+ * @param [in]  state       Protothread state.
+ * @param [in]  buf         Buffer given when starting the capture.
+ * @param [in]  len         Number of samples given when starting the capture.
+ * @return                  ::PBIO_SUCCESS when all samples are ready,
+ *                          ::PBIO_ERROR_AGAIN while capturing or
+ *                          ::PBIO_ERROR_CANCELED if the capture was stopped.
+ */
+pbio_error_t pbio_port_await_analog_capture(pbio_os_state_t *state, uint16_t *buf, uint32_t len) {
+    pbio_error_t err = pbdrv_adc_capture_await(state);
+    if (err == PBIO_SUCCESS) {
+        pbio_port_dcm_analog_capture_to_mv(buf, len);
+    }
+    return err;
+}
+
 /**
  * Gets the analog color values of the LEGO device.
  *
@@ -435,7 +791,9 @@ pbio_error_t pbio_port_get_analog_rgba(pbio_port_t *port, lego_device_type_id_t
  */
 static void pbio_port_init_one_port(pbio_port_t *port) {
 
-    // Initialize all ports with the none process.
+    // Initialize all ports with the none process. Port processes run right
+    // after the motor process so device data is handled with low latency.
+    pbio_os_process_set_priority(&port->process, PBIO_OS_PROCESS_PRIORITY_HIGH);
     pbio_os_process_start(&port->process, pbio_port_process_none_thread, port);
 
     // Configure motor instances if this port has them. This assumes that
@@ -538,7 +896,16 @@ void pbio_port_stop_user_actions(bool reset) {
         if (port->dcmotor) {
             pbio_dcmotor_reset(port->dcmotor, reset);
         }
+
+        #if PBDRV_CONFIG_I2C
+        if (reset) {
+            pbio_port_i2c_poll_stop(port);
+        }
+        #endif
     }
+
+    // The capture buffer belongs to the user program.
+    pbdrv_adc_capture_stop();
 }
 
 /**
@@ -593,6 +960,10 @@ pbio_error_t pbio_port_set_mode(pbio_port_t *port, pbio_port_mode_t mode) {
     pbio_os_process_start(&port->process, pbio_port_process_none_thread, port);
     port->mode = mode;
 
+    #if PBDRV_CONFIG_I2C
+    pbio_port_i2c_poll_stop(port);
+    #endif
+
     switch (mode) {
         case PBIO_PORT_MODE_NONE:
         case PBIO_PORT_MODE_GPIO_ADC:
@@ -612,7 +983,11 @@ pbio_error_t pbio_port_set_mode(pbio_port_t *port, pbio_port_mode_t mode) {
             // access UART from their own event loop.
             return pbdrv_ioport_p5p6_set_mode(port->pdata->pins, PBDRV_IOPORT_P5P6_MODE_UART);
         case PBIO_PORT_MODE_I2C:
-            // Enable I2C on the port. User controlled; no process needed here.
+            // Enable I2C on the port. User controlled, so the process only
+            // runs the optional polling job.
+            #if PBDRV_CONFIG_I2C
+            pbio_os_process_start(&port->process, pbio_port_i2c_poll_thread, port);
+            #endif
             return pbdrv_ioport_p5p6_set_mode(port->pdata->pins, PBDRV_IOPORT_P5P6_MODE_I2C);
         case PBIO_PORT_MODE_QUADRATURE:
             return pbdrv_ioport_p5p6_set_mode(port->pdata->pins, PBDRV_IOPORT_P5P6_MODE_QUADRATURE);
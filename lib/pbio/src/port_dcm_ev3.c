@@ -583,6 +583,29 @@ uint32_t pbio_port_dcm_get_analog_value(pbio_port_dcm_t *dcm, const pbdrv_ioport
     return pbio_port_dcm_get_mv(pins, 1);
 }
 
+pbio_error_t pbio_port_dcm_start_analog_capture(pbio_port_dcm_t *dcm, const pbdrv_ioport_pins_t *pins, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+
+    #if PBDRV_CONFIG_IOPORT_HAS_GPIO_P2
+    if (dcm->category == DCM_CATEGORY_EV3_ANALOG) {
+        return pbdrv_adc_capture_start(pins->adc_p6, buf, len, period_us, decimation);
+    }
+    #endif
+
+    if (active) {
+        pbdrv_gpio_out_high(&pins->p5);
+    } else {
+        pbdrv_gpio_out_low(&pins->p5);
+    }
+
+    return pbdrv_adc_capture_start(pins->adc_p1, buf, len, period_us, decimation);
+}
+
+void pbio_port_dcm_analog_capture_to_mv(uint16_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = pbio_port_dcm_adc_to_mv(buf[i]);
+    }
+}
+
 /**
  * Scales an RGB value based on ambient light and calibration data.
  *
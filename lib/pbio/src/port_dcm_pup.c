@@ -356,4 +356,11 @@ pbio_error_t pbio_port_dcm_get_analog_rgba(pbio_port_dcm_t *dcm, pbio_port_dcm_a
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+pbio_error_t pbio_port_dcm_start_analog_capture(pbio_port_dcm_t *dcm, const pbdrv_ioport_pins_t *pins, bool active, uint16_t *buf, uint32_t len, uint32_t period_us, uint32_t decimation) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+void pbio_port_dcm_analog_capture_to_mv(uint16_t *buf, uint32_t len) {
+}
+
 #endif // PBIO_CONFIG_PORT_DCM_PUP
@@ -13,6 +13,7 @@
 
 #include <pbio/port_interface.h>
 #include <pbio/port_lump.h>
+#include <pbio/trace.h>
 
 #include <pbdrv/clock.h>
 #include <pbdrv/ioport.h>
@@ -31,6 +32,10 @@
 
 #define EV3_UART_MAX_MESSAGE_SIZE   (LUMP_MAX_MSG_SIZE + 3)
 
+// Transmit buffer size in data mode: a keep-alive, a mode change and a data
+// message with its extended mode prefix, all sent back-to-back.
+#define EV3_UART_MAX_TX_SIZE        (1 + EV3_UART_MAX_MESSAGE_SIZE + 3 + EV3_UART_MAX_MESSAGE_SIZE)
+
 #define EV3_UART_MAX_DATA_ERR       6
 
 #define EV3_UART_TYPE_MIN           29      // EV3 color sensor
@@ -127,6 +132,8 @@ typedef struct {
     uint8_t size;
     /** The mode at which to set data */
     uint8_t desired_mode;
+    /** Whether the data is part of the messages currently being transmitted. */
+    bool sending;
     /** Time of the data set request (if size != 0) or time of completing transmission (if size == 0). */
     uint32_t time;
 } pbdrv_legodev_lump_data_set_t;
@@ -140,8 +147,12 @@ struct _pbio_port_lump_dev_t {
     pbio_os_state_t write_pt;
     /** Buffer to hold messages received from the device. */
     uint8_t *rx_msg;
-    /** Buffer to hold messages transmitted to the device. */
+    /** Buffer to hold one or more messages transmitted to the device. */
     uint8_t *tx_msg;
+    #if PBDRV_CONFIG_UART_PEEK
+    /** Timer for the receive timeout in data mode. */
+    pbio_os_timer_t rx_timer;
+    #endif
     /** Data set buffer and status. */
     pbdrv_legodev_lump_data_set_t *data_set;
     /**
@@ -151,6 +162,21 @@ struct _pbio_port_lump_dev_t {
      * the values could be foreign-endian.
      */
     uint8_t *bin_data;
+    /**
+     * Number of data messages received for the requested mode. Kept across
+     * resets so that waiting for new data never sees it go back.
+     */
+    uint32_t data_count;
+    /** Number of data messages received with values different from before. */
+    uint32_t data_change_count;
+    /** Time at which the most recent data was received (us). */
+    uint32_t data_time;
+    /**
+     * Incremented each time the device may stop being ready, such as on
+     * disconnect, mode change or data set. While it stays the same, a device
+     * that was found to be ready is still ready. Never 0.
+     */
+    uint32_t generation;
     /**
      * NB: Everything below is reset to 0 when synchronizing with a new device.
      *     type_id field should remain first.
@@ -169,7 +195,7 @@ struct _pbio_port_lump_dev_t {
     uint8_t ext_mode;
     /** New baud rate that will be set with ev3_uart_change_bitrate. */
     uint32_t new_baud_rate;
-    /** Size of the current message being transmitted. */
+    /** Size of the current message(s) being transmitted. */
     uint32_t tx_msg_size;
     /** Size of the current message being received. */
     uint32_t rx_msg_size;
@@ -179,7 +205,19 @@ struct _pbio_port_lump_dev_t {
     bool data_rec;
     /** Angle reported by the device. */
     pbio_angle_t angle;
+    #if PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+    /** Flag that indicates that the info was restored from the cache while syncing. */
+    bool info_cached;
+    #endif
+    /** Datasets to report in combi mode, as ::LUMP_COMBI_VALUE. */
+    uint8_t combi_values[LUMP_MAX_COMBI_VALUES];
+    /** Number of datasets to report in combi mode. */
+    uint8_t combi_num_values;
+    /** Size of the data reported in combi mode. */
+    uint8_t combi_size;
     #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+    /** Modes that can be combined, as a bit mask. */
+    uint16_t mode_combos;
     /** Mode value used to keep track of mode in INFO messages while syncing. */
     uint8_t new_mode;
     /** Flags indicating what information has already been read from the data. */
@@ -193,26 +231,120 @@ struct _pbio_port_lump_dev_t {
 
 pbio_port_lump_dev_t lump_devices[PBIO_CONFIG_PORT_LUMP_NUM_DEV];
 
-enum {
-    BUF_TX_MSG,
-    BUF_RX_MSG,
-    NUM_BUF
-};
+static uint8_t rx_bufs[PBIO_CONFIG_PORT_LUMP_NUM_DEV][EV3_UART_MAX_MESSAGE_SIZE];
+static uint8_t tx_bufs[PBIO_CONFIG_PORT_LUMP_NUM_DEV][EV3_UART_MAX_TX_SIZE];
 
-static uint8_t bufs[PBIO_CONFIG_PORT_LUMP_NUM_DEV][NUM_BUF][EV3_UART_MAX_MESSAGE_SIZE];
+#if PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+
+/**
+ * Device info that is the same each time a device of the same type connects.
+ */
+typedef struct {
+    /**< The type identifier of the device, or 0 if this entry is unused. */
+    lego_device_type_id_t type_id;
+    /**< The capabilities and requirements of the device. */
+    uint8_t capabilities;
+    /** Extra mode adder at the end of the info messages. */
+    uint8_t ext_mode;
+    /** Baud rate used after syncing. */
+    uint32_t new_baud_rate;
+    #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+    /** Mode at the end of the info messages. */
+    uint8_t mode;
+    /** Modes that can be combined, as a bit mask. */
+    uint16_t mode_combos;
+    /**< The number of modes */
+    uint8_t num_modes;
+    /**< Information about each mode. */
+    pbio_port_lump_mode_info_t mode_info[(LUMP_MAX_EXT_MODE + 1)];
+    #endif // PBIO_CONFIG_PORT_LUMP_MODE_INFO
+} pbio_port_lump_info_cache_t;
+
+static pbio_port_lump_info_cache_t info_cache[PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE];
+
+// Index of the entry to be written next.
+static uint8_t info_cache_next;
+
+/**
+ * Restores the device info from the cache if this type was seen before.
+ *
+ * @param [in]  lump_dev    The device, with the type_id already set.
+ * @return                  True if the info was restored, false if not.
+ */
+static bool pbio_port_lump_info_cache_restore(pbio_port_lump_dev_t *lump_dev) {
+    for (uint8_t i = 0; i < PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE; i++) {
+        pbio_port_lump_info_cache_t *entry = &info_cache[i];
+        if (entry->type_id != lump_dev->type_id) {
+            continue;
+        }
+        lump_dev->capabilities = entry->capabilities;
+        lump_dev->ext_mode = entry->ext_mode;
+        lump_dev->new_baud_rate = entry->new_baud_rate;
+        #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+        lump_dev->mode = entry->mode;
+        lump_dev->mode_combos = entry->mode_combos;
+        lump_dev->num_modes = entry->num_modes;
+        memcpy(lump_dev->mode_info, entry->mode_info, sizeof(lump_dev->mode_info));
+        #endif
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Stores the info of a device that has just completed its info messages.
+ *
+ * @param [in]  lump_dev    The device.
+ */
+static void pbio_port_lump_info_cache_store(pbio_port_lump_dev_t *lump_dev) {
+    // Entries are filled in order, so this replaces the oldest one when full.
+    pbio_port_lump_info_cache_t *entry = &info_cache[info_cache_next];
+    info_cache_next = (info_cache_next + 1) % PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE;
+
+    entry->type_id = lump_dev->type_id;
+    entry->capabilities = lump_dev->capabilities;
+    entry->ext_mode = lump_dev->ext_mode;
+    entry->new_baud_rate = lump_dev->new_baud_rate;
+    #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+    entry->mode = lump_dev->mode;
+    entry->mode_combos = lump_dev->mode_combos;
+    entry->num_modes = lump_dev->num_modes;
+    memcpy(entry->mode_info, lump_dev->mode_info, sizeof(entry->mode_info));
+    #endif
+}
+
+#endif // PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
 
 // The following data is really just part of lump_devices, but separate allocation reduces overal code size
 static uint8_t data_read_bufs[PBIO_CONFIG_PORT_LUMP_NUM_DEV][LUMP_MAX_MSG_SIZE] __attribute__((aligned(4)));
 static pbdrv_legodev_lump_data_set_t data_set_bufs[PBIO_CONFIG_PORT_LUMP_NUM_DEV];
 
+/**
+ * Marks that the device may no longer be ready. See ::pbio_port_lump_get_generation.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ */
+static void pbio_port_lump_invalidate(pbio_port_lump_dev_t *lump_dev) {
+    // Skip 0 on wraparound so users can use it to mean never checked.
+    if (++lump_dev->generation == 0) {
+        lump_dev->generation = 1;
+    }
+}
+
+static void pbio_port_lump_set_status(pbio_port_lump_dev_t *lump_dev, pbdrv_legodev_lump_status_t status) {
+    lump_dev->status = status;
+    pbio_port_lump_invalidate(lump_dev);
+}
+
 pbio_port_lump_dev_t *pbio_port_lump_init_instance(uint8_t device_index) {
     if (device_index >= PBIO_CONFIG_PORT_LUMP_NUM_DEV) {
         return NULL;
     }
     pbio_port_lump_dev_t *lump_dev = &lump_devices[device_index];
-    lump_dev->tx_msg = &bufs[device_index][BUF_TX_MSG][0];
-    lump_dev->rx_msg = &bufs[device_index][BUF_RX_MSG][0];
-    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_ERR;
+    lump_dev->tx_msg = &tx_bufs[device_index][0];
+    lump_dev->rx_msg = &rx_bufs[device_index][0];
+    lump_dev->generation = 1;
+    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_ERR);
     lump_dev->err_count = 0;
     lump_dev->data_set = &data_set_bufs[device_index];
     lump_dev->bin_data = data_read_bufs[device_index];
@@ -224,6 +356,7 @@ static void pbio_port_lump_request_mode(pbio_port_lump_dev_t *lump_dev, uint8_t
     lump_dev->mode_switch.desired_mode = mode;
     lump_dev->mode_switch.time = pbdrv_clock_get_ms();
     lump_dev->mode_switch.requested = true;
+    pbio_port_lump_invalidate(lump_dev);
     pbio_os_request_poll();
 }
 
@@ -232,6 +365,7 @@ static void pbio_port_lump_request_data_set(pbio_port_lump_dev_t *lump_dev, uint
     lump_dev->data_set->desired_mode = mode;
     lump_dev->data_set->time = pbdrv_clock_get_ms();
     memcpy(lump_dev->data_set->bin_data, data, size);
+    pbio_port_lump_invalidate(lump_dev);
     pbio_os_request_poll();
 }
 
@@ -353,15 +487,21 @@ pbio_port_power_requirements_t pbio_port_lump_get_power_requirements(pbio_port_l
     return PBIO_PORT_POWER_REQUIREMENTS_NONE;
 }
 
-static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
+/**
+ * Parses a complete message received from the device.
+ *
+ * @param [in] lump_dev The LEGO UART device instance.
+ * @param [in] msg      The message. Only INFO messages are modified.
+ */
+static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev, uint8_t *msg) {
     uint32_t speed;
     uint8_t msg_type, cmd, msg_size, mode, cmd2;
 
-    msg_type = lump_dev->rx_msg[0] & LUMP_MSG_TYPE_MASK;
-    cmd = lump_dev->rx_msg[0] & LUMP_MSG_CMD_MASK;
-    msg_size = ev3_uart_get_msg_size(lump_dev->rx_msg[0]);
+    msg_type = msg[0] & LUMP_MSG_TYPE_MASK;
+    cmd = msg[0] & LUMP_MSG_CMD_MASK;
+    msg_size = ev3_uart_get_msg_size(msg[0]);
     mode = cmd;
-    cmd2 = lump_dev->rx_msg[1];
+    cmd2 = msg[1];
 
     // The original EV3 spec only allowed for up to 8 modes (3-bit number).
     // The Powered UP spec extents this by adding an extra flag to INFO commands.
@@ -377,9 +517,9 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
     if (msg_size > 1) {
         uint8_t checksum = 0xFF;
         for (int i = 0; i < msg_size - 1; i++) {
-            checksum ^= lump_dev->rx_msg[i];
+            checksum ^= msg[i];
         }
-        if (checksum != lump_dev->rx_msg[msg_size - 1]) {
+        if (checksum != msg[msg_size - 1]) {
             debug_pr("Bad checksum\n");
             // if INFO messages are done and we are now receiving data, it is
             // OK to occasionally have a bad checksum
@@ -389,7 +529,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                 // for RGB-RAW data (mode 4). The check here could be
                 // improved if someone can find a pattern.
                 if (lump_dev->type_id != LEGO_DEVICE_TYPE_ID_EV3_COLOR_SENSOR
-                    || lump_dev->rx_msg[0] != (LUMP_MSG_TYPE_DATA | LUMP_MSG_SIZE_8 | 4)) {
+                    || msg[0] != (LUMP_MSG_TYPE_DATA | LUMP_MSG_SIZE_8 | 4)) {
                     return;
                 }
             } else {
@@ -420,7 +560,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                     lump_dev->mode = lump_dev->new_mode;
                     #endif
 
-                    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_ACK;
+                    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_ACK);
 
                     return;
             }
@@ -441,7 +581,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                     if (msg_size > 5) {
                         // Powered Up devices can have an extended mode message that
                         // includes modes > LUMP_MAX_MODE
-                        lump_dev->num_modes = lump_dev->rx_msg[3] + 1;
+                        lump_dev->num_modes = msg[3] + 1;
                     }
 
                     debug_pr("num_modes: %d\n", lump_dev->num_modes);
@@ -454,7 +594,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                         goto err;
                     }
                     #endif
-                    speed = pbio_get_uint32_le(lump_dev->rx_msg + 1);
+                    speed = pbio_get_uint32_le(msg + 1);
                     if (speed < EV3_UART_SPEED_MIN || speed > EV3_UART_SPEED_MAX) {
                         debug_pr("Speed is out of range\n");
                         goto err;
@@ -469,7 +609,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                 case LUMP_CMD_EXT_MODE:
                     // Powered up devices can have modes > LUMP_MAX_MODE. This
                     // command precedes other commands to add the extra 8 to the mode
-                    lump_dev->ext_mode = lump_dev->rx_msg[1];
+                    lump_dev->ext_mode = msg[1];
                     break;
                 case LUMP_CMD_VERSION:
                     #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
@@ -478,8 +618,8 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                         goto err;
                     }
                     // TODO: this might be useful someday
-                    debug_pr("fw version: %08" PRIx32 "\n", pbio_get_uint32_le(lump_dev->rx_msg + 1));
-                    debug_pr("hw version: %08" PRIx32 "\n", pbio_get_uint32_le(lump_dev->rx_msg + 5));
+                    debug_pr("fw version: %08" PRIx32 "\n", pbio_get_uint32_le(msg + 1));
+                    debug_pr("hw version: %08" PRIx32 "\n", pbio_get_uint32_le(msg + 5));
                     #endif // LUMP_CMD_VERSION
                     break;
                 default:
@@ -492,7 +632,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                 case LUMP_INFO_NAME: {
                     size_t name_len = 1;
                     #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
-                    if (lump_dev->rx_msg[2] < 'A' || lump_dev->rx_msg[2] > 'z') {
+                    if (msg[2] < 'A' || msg[2] > 'z') {
                         debug_pr("Invalid name INFO\n");
                         goto err;
                     }
@@ -503,8 +643,8 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                     * ensure a null terminator for the string
                     * functions.
                     */
-                    lump_dev->rx_msg[msg_size - 1] = 0;
-                    const char *name = (char *)(lump_dev->rx_msg + 2);
+                    msg[msg_size - 1] = 0;
+                    const char *name = (char *)(msg + 2);
                     name_len = strlen(name);
                     if (name_len > LUMP_MAX_NAME_SIZE) {
                         debug_pr("Name is too long\n");
@@ -519,14 +659,14 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
 
                     debug_pr("new_mode: %d\n", lump_dev->new_mode);
                     debug_pr("flags: %02X %02X %02X %02X %02X %02X\n",
-                        lump_dev->rx_msg[8 + 0], lump_dev->rx_msg[8 + 1], lump_dev->rx_msg[8 + 2],
-                        lump_dev->rx_msg[8 + 3], lump_dev->rx_msg[8 + 4], lump_dev->rx_msg[8 + 5]);
+                        msg[8 + 0], msg[8 + 1], msg[8 + 2],
+                        msg[8 + 3], msg[8 + 4], msg[8 + 5]);
                     #endif // PBIO_CONFIG_PORT_LUMP_MODE_INFO
 
                     // newer LEGO UART devices send additional 6 mode capability flags
                     if (name_len <= LUMP_MAX_SHORT_NAME_SIZE && msg_size > LUMP_MAX_NAME_SIZE) {
                         // Only the first is used in practice.
-                        lump_dev->capabilities |= lump_dev->rx_msg[8];
+                        lump_dev->capabilities |= msg[8];
                     }
                     break;
                 }
@@ -547,10 +687,10 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                     }
 
                     // Mode supports writing if rx_msg[3] is nonzero.
-                    lump_dev->mode_info[mode].writable = lump_dev->rx_msg[3] != 0;
+                    lump_dev->mode_info[mode].writable = msg[3] != 0;
 
-                    debug_pr("mapping: in %02x out %02x\n", lump_dev->rx_msg[2], lump_dev->rx_msg[3]);
-                    debug_pr("mapping: in %02x out %02x\n", lump_dev->rx_msg[2], lump_dev->rx_msg[3]);
+                    debug_pr("mapping: in %02x out %02x\n", msg[2], msg[3]);
+                    debug_pr("mapping: in %02x out %02x\n", msg[2], msg[3]);
                     debug_pr("Writable: %d\n", lump_dev->mode_info[mode].writable);
 
                     break;
@@ -564,8 +704,10 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                         goto err;
                     }
 
-                    // REVISIT: this is potentially an array of combos
-                    debug_pr("mode combos: %04x\n", lump_dev->rx_msg[3] << 8 | lump_dev->rx_msg[2]);
+                    // REVISIT: this is potentially an array of combos, but
+                    // only the first one is used for now.
+                    lump_dev->mode_combos = pbio_get_uint16_le(msg + 2);
+                    debug_pr("mode combos: %04x\n", lump_dev->mode_combos);
 
                     break;
                 case LUMP_INFO_UNK9:
@@ -580,8 +722,8 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
 
                     // first 3 parameters look like PID constants, 4th is max tacho_rate
                     debug_pr("motor parameters: %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 "\n",
-                        pbio_get_uint32_le(lump_dev->rx_msg + 2), pbio_get_uint32_le(lump_dev->rx_msg + 6),
-                        pbio_get_uint32_le(lump_dev->rx_msg + 10), pbio_get_uint32_le(lump_dev->rx_msg + 14));
+                        pbio_get_uint32_le(msg + 2), pbio_get_uint32_le(msg + 6),
+                        pbio_get_uint32_le(msg + 10), pbio_get_uint32_le(msg + 14));
 
                     break;
                 case LUMP_INFO_UNK11:
@@ -603,7 +745,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                         debug_pr("Received duplicate format INFO\n");
                         goto err;
                     }
-                    lump_dev->mode_info[mode].num_values = lump_dev->rx_msg[2];
+                    lump_dev->mode_info[mode].num_values = msg[2];
                     if (!lump_dev->mode_info[mode].num_values) {
                         debug_pr("Invalid number of data sets\n");
                         goto err;
@@ -616,7 +758,7 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
                         debug_pr("Did not receive all required INFO\n");
                         goto err;
                     }
-                    lump_dev->mode_info[mode].data_type = lump_dev->rx_msg[3];
+                    lump_dev->mode_info[mode].data_type = msg[3];
                     if (lump_dev->new_mode) {
                         lump_dev->new_mode--;
                     }
@@ -641,15 +783,29 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
             }
             #endif
 
+            // Data is for requested mode combination if it has all datasets.
+            if (lump_dev->mode_switch.desired_mode == PBIO_PORT_LUMP_MODE_COMBI && msg_size - 2 >= lump_dev->combi_size) {
+                mode = PBIO_PORT_LUMP_MODE_COMBI;
+            }
+
             // Data is for requested mode.
             if (mode == lump_dev->mode_switch.desired_mode) {
-                memcpy(lump_dev->bin_data, lump_dev->rx_msg + 1, msg_size - 2);
+                if (lump_dev->mode != mode || memcmp(lump_dev->bin_data, msg + 1, msg_size - 2)) {
+                    lump_dev->data_change_count++;
+                }
+                lump_dev->data_count++;
+                lump_dev->data_time = pbdrv_clock_get_us();
+
+                memcpy(lump_dev->bin_data, msg + 1, msg_size - 2);
 
                 if (lump_dev->mode != mode) {
                     // First time getting data in this mode, so register time.
                     lump_dev->mode_switch.time = pbdrv_clock_get_ms();
                 }
             }
+            if (lump_dev->mode != mode) {
+                pbio_port_lump_invalidate(lump_dev);
+            }
             lump_dev->mode = mode;
             pbio_port_lump_handle_known_data(lump_dev);
 
@@ -660,31 +816,45 @@ static void pbio_port_lump_lump_parse_msg(pbio_port_lump_dev_t *lump_dev) {
     return;
 
 err:
-    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_ERR;
+    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_ERR);
 }
 
 static uint8_t ev3_uart_set_msg_hdr(lump_msg_type_t type, lump_msg_size_t size, lump_cmd_t cmd) {
     return (type & LUMP_MSG_TYPE_MASK) | (size & LUMP_MSG_SIZE_MASK) | (cmd & LUMP_MSG_CMD_MASK);
 }
 
-static void ev3_uart_prepare_tx_msg(pbio_port_lump_dev_t *lump_dev, lump_msg_type_t msg_type,
+/**
+ * Appends a message to the transmit buffer.
+ *
+ * The message is added after any messages already in the buffer, so several
+ * messages can be sent back-to-back with a single write. Set tx_msg_size to 0
+ * to start a new buffer.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ * @param [in]  msg_type    The message type.
+ * @param [in]  cmd         The command or mode.
+ * @param [in]  data        The payload.
+ * @param [in]  len         The payload size.
+ */
+static void ev3_uart_append_tx_msg(pbio_port_lump_dev_t *lump_dev, lump_msg_type_t msg_type,
     lump_cmd_t cmd, const uint8_t *data, uint8_t len) {
     uint8_t header, checksum, i;
     uint8_t offset = 0;
+    uint8_t *tx_msg = lump_dev->tx_msg + lump_dev->tx_msg_size;
     lump_msg_size_t size;
 
     if (msg_type == LUMP_MSG_TYPE_DATA) {
         // Only Powered Up devices support setting data, and they expect to have an
         // extra command sent to give the part of the mode > 7
-        lump_dev->tx_msg[0] = ev3_uart_set_msg_hdr(LUMP_MSG_TYPE_CMD, LUMP_MSG_SIZE_1, LUMP_CMD_EXT_MODE);
-        lump_dev->tx_msg[1] = lump_dev->mode > LUMP_MAX_MODE ? 8 : 0;
-        lump_dev->tx_msg[2] = 0xff ^ lump_dev->tx_msg[0] ^ lump_dev->tx_msg[1];
+        tx_msg[0] = ev3_uart_set_msg_hdr(LUMP_MSG_TYPE_CMD, LUMP_MSG_SIZE_1, LUMP_CMD_EXT_MODE);
+        tx_msg[1] = lump_dev->mode > LUMP_MAX_MODE ? 8 : 0;
+        tx_msg[2] = 0xff ^ tx_msg[0] ^ tx_msg[1];
         offset = 3;
     }
 
     checksum = 0xff;
     for (i = 0; i < len; i++) {
-        lump_dev->tx_msg[offset + i + 1] = data[i];
+        tx_msg[offset + i + 1] = data[i];
         checksum ^= data[i];
     }
 
@@ -713,15 +883,15 @@ static void ev3_uart_prepare_tx_msg(pbio_port_lump_dev_t *lump_dev, lump_msg_typ
 
     // pad with zeros
     for (; i < len; i++) {
-        lump_dev->tx_msg[offset + i + 1] = 0;
+        tx_msg[offset + i + 1] = 0;
     }
 
     header = ev3_uart_set_msg_hdr(msg_type, size, cmd);
     checksum ^= header;
 
-    lump_dev->tx_msg[offset] = header;
-    lump_dev->tx_msg[offset + i + 1] = checksum;
-    lump_dev->tx_msg_size = offset + i + 2;
+    tx_msg[offset] = header;
+    tx_msg[offset + i + 1] = checksum;
+    lump_dev->tx_msg_size += offset + i + 2;
 }
 
 /**
@@ -744,14 +914,15 @@ pbio_error_t pbio_port_lump_sync_thread(pbio_os_state_t *state, pbio_port_lump_d
     // Reset whole state except references to static buffers
     memset((uint8_t *)lump_dev + offsetof(pbio_port_lump_dev_t, type_id), 0, sizeof(pbio_port_lump_dev_t) - offsetof(pbio_port_lump_dev_t, type_id));
 
-    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_SYNCING;
+    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_SYNCING);
 
     // Send SPEED command at 115200 baud
     debug_pr("set baud: %d\n", EV3_UART_SPEED_LPF2);
     pbdrv_uart_set_baud_rate(uart_dev, EV3_UART_SPEED_LPF2);
     uint8_t speed_payload[4];
     pbio_set_uint32_le(speed_payload, EV3_UART_SPEED_LPF2);
-    ev3_uart_prepare_tx_msg(lump_dev, LUMP_MSG_TYPE_CMD, LUMP_CMD_SPEED, speed_payload, sizeof(speed_payload));
+    lump_dev->tx_msg_size = 0;
+    ev3_uart_append_tx_msg(lump_dev, LUMP_MSG_TYPE_CMD, LUMP_CMD_SPEED, speed_payload, sizeof(speed_payload));
 
     pbdrv_uart_flush(uart_dev);
 
@@ -819,13 +990,20 @@ sync:
     // if all was good, we are ready to start receiving the mode info
     lump_dev->type_id = lump_dev->rx_msg[1];
     lump_dev->data_rec = false;
-    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_INFO;
+    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_INFO);
     #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
     lump_dev->info_flags = EV3_UART_INFO_FLAG_CMD_TYPE;
     lump_dev->num_modes = 1;
     #endif
     debug_pr("type id: %d\n", lump_dev->type_id);
 
+    #if PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+    // If this type of device was synced before, we already know everything
+    // the info messages will tell us. The device sends them anyway, so they
+    // are still read, but we only need to look for the ACK at the end.
+    lump_dev->info_cached = pbio_port_lump_info_cache_restore(lump_dev);
+    #endif
+
     while (lump_dev->status == PBDRV_LEGODEV_LUMP_STATUS_INFO) {
         // read the message header
         PBIO_OS_AWAIT(state, &lump_dev->read_pt, err = pbdrv_uart_read(&lump_dev->read_pt, uart_dev, lump_dev->rx_msg, 1, EV3_UART_IO_TIMEOUT));
@@ -853,8 +1031,18 @@ sync:
             }
         }
 
+        #if PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+        if (lump_dev->info_cached) {
+            if (lump_dev->rx_msg[0] == LUMP_SYS_ACK) {
+                pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_ACK);
+            }
+            continue;
+        }
+        #endif
+
         // at this point, we have a full lump_dev->msg that can be parsed
-        pbio_port_lump_lump_parse_msg(lump_dev);
+        pbio_trace_record(PBIO_TRACE_EVENT_LUMP_MSG, lump_dev - lump_devices, lump_dev->rx_msg, lump_dev->rx_msg_size);
+        pbio_port_lump_lump_parse_msg(lump_dev, lump_dev->rx_msg);
     }
 
     // at this point we should have read all of the mode info
@@ -862,6 +1050,12 @@ sync:
         return PBIO_ERROR_FAILED;
     }
 
+    #if PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+    if (!lump_dev->info_cached) {
+        pbio_port_lump_info_cache_store(lump_dev);
+    }
+    #endif
+
     // reply with ACK
     lump_dev->tx_msg[0] = LUMP_SYS_ACK;
     lump_dev->tx_msg_size = 1;
@@ -894,8 +1088,9 @@ sync:
     // Reset other timers
     lump_dev->data_set->time = pbdrv_clock_get_ms() - 1000; // i.e. no data set
     lump_dev->data_set->size = 0;
+    lump_dev->data_set->sending = false;
 
-    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_DATA;
+    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_DATA);
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
@@ -928,34 +1123,36 @@ pbio_error_t pbio_port_lump_data_send_thread(pbio_os_state_t *state, pbio_port_l
 
         PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(timer) || lump_dev->mode_switch.requested || lump_dev->data_set->size > 0);
 
+        // All pending messages are collected and sent back-to-back in a
+        // single write. Requests made while the previous write was in
+        // progress replace older ones, so only the latest is sent.
+        lump_dev->tx_msg_size = 0;
+
         // Handle keep alive timeout
         if (pbio_os_timer_is_expired(timer)) {
             // Make sure we are receiving data. The first time around, we allow
             // not having any data yet.
             if (!lump_dev->data_rec && timer->duration == EV3_UART_DATA_KEEP_ALIVE_TIMEOUT) {
                 debug_pr("No data since last keepalive\n");
-                lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_ERR;
+                pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_ERR);
                 return PBIO_ERROR_TIMEDOUT;
             }
             lump_dev->data_rec = false;
-            lump_dev->tx_msg[0] = LUMP_SYS_NACK;
-            lump_dev->tx_msg_size = 1;
-            PBIO_OS_AWAIT(state, &lump_dev->write_pt, err = pbdrv_uart_write(&lump_dev->write_pt, uart_dev, lump_dev->tx_msg, lump_dev->tx_msg_size, EV3_UART_IO_TIMEOUT));
-            if (err != PBIO_SUCCESS) {
-                debug_pr("Error during keepalive.\n");
-                return err;
-            }
+            lump_dev->tx_msg[lump_dev->tx_msg_size++] = LUMP_SYS_NACK;
             pbio_os_timer_set(timer, EV3_UART_DATA_KEEP_ALIVE_TIMEOUT);
         }
 
         // Handle requested mode change
         if (lump_dev->mode_switch.requested) {
             lump_dev->mode_switch.requested = false;
-            ev3_uart_prepare_tx_msg(lump_dev, LUMP_MSG_TYPE_CMD, LUMP_CMD_SELECT, &lump_dev->mode_switch.desired_mode, 1);
-            PBIO_OS_AWAIT(state, &lump_dev->write_pt, err = pbdrv_uart_write(&lump_dev->write_pt, uart_dev, lump_dev->tx_msg, lump_dev->tx_msg_size, EV3_UART_IO_TIMEOUT));
-            if (err != PBIO_SUCCESS) {
-                debug_pr("Setting requested mode failed.\n");
-                return err;
+            if (lump_dev->mode_switch.desired_mode == PBIO_PORT_LUMP_MODE_COMBI) {
+                // Set up combination as combo 0, which selects it as well.
+                uint8_t payload[1 + LUMP_MAX_COMBI_VALUES];
+                payload[0] = LUMP_WRITE_COMBI_SETUP;
+                memcpy(&payload[1], lump_dev->combi_values, lump_dev->combi_num_values);
+                ev3_uart_append_tx_msg(lump_dev, LUMP_MSG_TYPE_CMD, LUMP_CMD_WRITE, payload, 1 + lump_dev->combi_num_values);
+            } else {
+                ev3_uart_append_tx_msg(lump_dev, LUMP_MSG_TYPE_CMD, LUMP_CMD_SELECT, &lump_dev->mode_switch.desired_mode, 1);
             }
         }
 
@@ -963,28 +1160,117 @@ pbio_error_t pbio_port_lump_data_send_thread(pbio_os_state_t *state, pbio_port_l
         if (lump_dev->data_set->size > 0) {
             // Only set data if we are in the correct mode already.
             if (lump_dev->mode == lump_dev->data_set->desired_mode) {
-                ev3_uart_prepare_tx_msg(lump_dev, LUMP_MSG_TYPE_DATA, lump_dev->data_set->desired_mode, lump_dev->data_set->bin_data, lump_dev->data_set->size);
+                ev3_uart_append_tx_msg(lump_dev, LUMP_MSG_TYPE_DATA, lump_dev->data_set->desired_mode, lump_dev->data_set->bin_data, lump_dev->data_set->size);
                 lump_dev->data_set->size = 0;
-                lump_dev->data_set->time = pbdrv_clock_get_ms();
-                PBIO_OS_AWAIT(state, &lump_dev->write_pt, err = pbdrv_uart_write(&lump_dev->write_pt, uart_dev, lump_dev->tx_msg, lump_dev->tx_msg_size, EV3_UART_IO_TIMEOUT));
-                if (err != PBIO_SUCCESS) {
-                    debug_pr("Setting requested data failed.\n");
-                    return err;
-                }
+                lump_dev->data_set->sending = true;
                 lump_dev->data_set->time = pbdrv_clock_get_ms();
             } else if (pbdrv_clock_get_ms() - lump_dev->data_set->time < 500) {
-                // Not in the right mode yet, try again later for a reasonable amount of time.
-                PBIO_OS_AWAIT_MS(state, timer, 1);
+                // Not in the right mode yet, try again later for a reasonable
+                // amount of time. Anything else is still sent now.
             } else {
                 // Give up setting data.
                 lump_dev->data_set->size = 0;
             }
         }
+
+        if (lump_dev->tx_msg_size > 0) {
+            PBIO_OS_AWAIT(state, &lump_dev->write_pt, err = pbdrv_uart_write(&lump_dev->write_pt, uart_dev, lump_dev->tx_msg, lump_dev->tx_msg_size, EV3_UART_IO_TIMEOUT));
+            if (err != PBIO_SUCCESS) {
+                debug_pr("Sending messages failed.\n");
+                return err;
+            }
+            if (lump_dev->data_set->sending) {
+                lump_dev->data_set->sending = false;
+                lump_dev->data_set->time = pbdrv_clock_get_ms();
+            }
+        }
+
+        // Data for a mode that is not active yet is retried shortly.
+        if (lump_dev->data_set->size > 0 && lump_dev->mode != lump_dev->data_set->desired_mode) {
+            PBIO_OS_AWAIT_MS(state, timer, 1);
+        }
     }
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+/**
+ * Gets the size of a message that can be received in data mode.
+ *
+ * @param [in]  header      The message header.
+ * @return                  The message size or 0 if this is not a valid data mode message.
+ */
+static uint8_t pbio_port_lump_get_data_msg_size(uint8_t header) {
+    uint8_t size = ev3_uart_get_msg_size(header);
+    if (size < 3 || size > EV3_UART_MAX_MESSAGE_SIZE) {
+        debug_pr("Bad data message size\n");
+        return 0;
+    }
+
+    uint8_t msg_type = header & LUMP_MSG_TYPE_MASK;
+    uint8_t cmd = header & LUMP_MSG_CMD_MASK;
+    if (msg_type != LUMP_MSG_TYPE_DATA && (msg_type != LUMP_MSG_TYPE_CMD ||
+                                           (cmd != LUMP_CMD_WRITE && cmd != LUMP_CMD_EXT_MODE))) {
+        debug_pr("Bad msg type\n");
+        return 0;
+    }
+    return size;
+}
+
+#if PBDRV_CONFIG_UART_PEEK
+
+/**
+ * Parses all complete data messages in the UART receive buffer.
+ *
+ * Messages are parsed in place. Only messages that wrap around the end of the
+ * receive buffer are copied to the message buffer first.
+ *
+ * Sets lump_dev->rx_msg_size to the number of bytes needed to parse the next
+ * message.
+ *
+ * @param [in]  lump_dev       The LEGO UART device instance.
+ * @param [in]  uart_dev       The UART device instance.
+ */
+static void pbio_port_lump_parse_data_msgs(pbio_port_lump_dev_t *lump_dev, pbdrv_uart_dev_t *uart_dev) {
+
+    const uint8_t *data;
+    uint32_t available;
+
+    while ((available = pbdrv_uart_in_waiting(uart_dev)) > 0) {
+
+        uint32_t contiguous = pbdrv_uart_peek(uart_dev, 0, &data);
+
+        // On bad messages, skip one byte at a time to get back in sync.
+        lump_dev->rx_msg_size = pbio_port_lump_get_data_msg_size(data[0]);
+        if (!lump_dev->rx_msg_size) {
+            pbdrv_uart_discard(uart_dev, 1);
+            continue;
+        }
+
+        // Wait for the rest of the message.
+        if (available < lump_dev->rx_msg_size) {
+            return;
+        }
+
+        uint8_t *msg = (uint8_t *)data;
+        if (contiguous < lump_dev->rx_msg_size) {
+            memcpy(lump_dev->rx_msg, data, contiguous);
+            pbdrv_uart_peek(uart_dev, contiguous, &data);
+            memcpy(lump_dev->rx_msg + contiguous, data, lump_dev->rx_msg_size - contiguous);
+            msg = lump_dev->rx_msg;
+        }
+
+        pbio_trace_record(PBIO_TRACE_EVENT_LUMP_MSG, lump_dev - lump_devices, msg, lump_dev->rx_msg_size);
+        pbio_port_lump_lump_parse_msg(lump_dev, msg);
+        pbdrv_uart_discard(uart_dev, lump_dev->rx_msg_size);
+    }
+
+    // Wait for the next header.
+    lump_dev->rx_msg_size = 1;
+}
+
+#endif // PBDRV_CONFIG_UART_PEEK
+
 /**
  * The receive thread for the LEGO UART device.
  *
@@ -1000,6 +1286,25 @@ pbio_error_t pbio_port_lump_data_recv_thread(pbio_os_state_t *state, pbio_port_l
         return PBIO_ERROR_INVALID_OP;
     }
 
+    #if PBDRV_CONFIG_UART_PEEK
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Handle all messages that have arrived each time we wake up, without
+    // reading them one by one.
+    lump_dev->rx_msg_size = 1;
+    while (true) {
+        pbio_os_timer_set(&lump_dev->rx_timer, EV3_UART_IO_TIMEOUT);
+        PBIO_OS_AWAIT_UNTIL(state, pbdrv_uart_in_waiting(uart_dev) >= lump_dev->rx_msg_size || pbio_os_timer_is_expired(&lump_dev->rx_timer));
+        if (pbdrv_uart_in_waiting(uart_dev) < lump_dev->rx_msg_size) {
+            debug_pr("UART Rx data timeout\n");
+            return PBIO_ERROR_TIMEDOUT;
+        }
+        pbio_port_lump_parse_data_msgs(lump_dev, uart_dev);
+    }
+
+    #else // PBDRV_CONFIG_UART_PEEK
+
     pbio_error_t err;
 
     // REVISIT: This is not the greatest. We can easily get a buffer overrun and
@@ -1015,17 +1320,8 @@ pbio_error_t pbio_port_lump_data_recv_thread(pbio_os_state_t *state, pbio_port_l
             return err;
         }
 
-        lump_dev->rx_msg_size = ev3_uart_get_msg_size(lump_dev->rx_msg[0]);
-        if (lump_dev->rx_msg_size < 3 || lump_dev->rx_msg_size > EV3_UART_MAX_MESSAGE_SIZE) {
-            debug_pr("Bad data message size\n");
-            continue;
-        }
-
-        uint8_t msg_type = lump_dev->rx_msg[0] & LUMP_MSG_TYPE_MASK;
-        uint8_t cmd = lump_dev->rx_msg[0] & LUMP_MSG_CMD_MASK;
-        if (msg_type != LUMP_MSG_TYPE_DATA && (msg_type != LUMP_MSG_TYPE_CMD ||
-                                               (cmd != LUMP_CMD_WRITE && cmd != LUMP_CMD_EXT_MODE))) {
-            debug_pr("Bad msg type\n");
+        lump_dev->rx_msg_size = pbio_port_lump_get_data_msg_size(lump_dev->rx_msg[0]);
+        if (!lump_dev->rx_msg_size) {
             continue;
         }
 
@@ -1036,9 +1332,12 @@ pbio_error_t pbio_port_lump_data_recv_thread(pbio_os_state_t *state, pbio_port_l
         }
 
         // at this point, we have a full lump_dev->msg that can be parsed
-        pbio_port_lump_lump_parse_msg(lump_dev);
+        pbio_trace_record(PBIO_TRACE_EVENT_LUMP_MSG, lump_dev - lump_devices, lump_dev->rx_msg, lump_dev->rx_msg_size);
+        pbio_port_lump_lump_parse_msg(lump_dev, lump_dev->rx_msg);
     }
 
+    #endif // PBDRV_CONFIG_UART_PEEK
+
     // Unreachable.
     PBIO_OS_ASYNC_END(PBIO_ERROR_FAILED);
 }
@@ -1104,6 +1403,38 @@ pbio_error_t pbio_port_lump_is_ready(pbio_port_lump_dev_t *lump_dev) {
     return PBIO_SUCCESS;
 }
 
+#if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+/**
+ * Gets the location of the data of a mode in the data of the current mode
+ * combination, if all datasets of the mode are included in order.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ * @param [in]  mode        The mode to look for.
+ * @return                  Offset of the data in the combi data or -1 if not included.
+ */
+static int32_t pbio_port_lump_get_combi_offset(pbio_port_lump_dev_t *lump_dev, uint8_t mode) {
+    if (mode >= lump_dev->num_modes) {
+        return -1;
+    }
+    const pbio_port_lump_mode_info_t *info = &lump_dev->mode_info[mode];
+    uint32_t offset = 0;
+    for (uint8_t i = 0; i < lump_dev->combi_num_values; i++) {
+        uint8_t value = lump_dev->combi_values[i];
+        if (value == LUMP_COMBI_VALUE(mode, 0) && i + info->num_values <= lump_dev->combi_num_values) {
+            uint8_t j;
+            for (j = 1; j < info->num_values && lump_dev->combi_values[i + j] == LUMP_COMBI_VALUE(mode, j); j++) {
+                ;
+            }
+            if (j == info->num_values) {
+                return offset;
+            }
+        }
+        offset += pbio_port_lump_data_size(lump_dev->mode_info[value >> 4].data_type);
+    }
+    return -1;
+}
+#endif // PBIO_CONFIG_PORT_LUMP_MODE_INFO
+
 /**
  * Starts setting the mode of a LEGO UART device.
  *
@@ -1128,6 +1459,13 @@ pbio_error_t pbio_port_lump_set_mode(pbio_port_lump_dev_t *lump_dev, uint8_t mod
         return PBIO_SUCCESS;
     }
 
+    #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+    // Mode is already included in the mode combination being set.
+    if (lump_dev->mode_switch.desired_mode == PBIO_PORT_LUMP_MODE_COMBI && pbio_port_lump_get_combi_offset(lump_dev, mode) >= 0) {
+        return PBIO_SUCCESS;
+    }
+    #endif
+
     // We can only initiate a mode switch if currently idle (receiving data).
     pbio_error_t err = pbio_port_lump_is_ready(lump_dev);
     if (err != PBIO_SUCCESS) {
@@ -1147,6 +1485,77 @@ pbio_error_t pbio_port_lump_set_mode(pbio_port_lump_dev_t *lump_dev, uint8_t mod
     return PBIO_SUCCESS;
 }
 
+/**
+ * Starts reporting datasets from several modes at once.
+ *
+ * Once set, the data can be read using ::PBIO_PORT_LUMP_MODE_COMBI as the
+ * mode. The datasets are concatenated in the given order. If all datasets of
+ * a mode are included in order, that mode can also be set and read as usual
+ * without leaving combi mode. Setting any other mode ends combi mode.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ * @param [in]  values      Datasets to report, as ::LUMP_COMBI_VALUE.
+ * @param [in]  num_values  Number of datasets.
+ * @return                  ::PBIO_SUCCESS on success or if already set.
+ *                          ::PBIO_ERROR_NO_DEV if the port does not have a device attached.
+ *                          ::PBIO_ERROR_INVALID_ARG if the modes can't be combined or the data does not fit.
+ *                          ::PBIO_ERROR_NOT_SUPPORTED if mode information is not available.
+ *                          ::PBIO_ERROR_AGAIN if the device is not ready for this operation.
+ */
+pbio_error_t pbio_port_lump_set_mode_combi(pbio_port_lump_dev_t *lump_dev, const uint8_t *values, uint8_t num_values) {
+
+    if (!lump_dev) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+
+    if (num_values == 0 || num_values > LUMP_MAX_COMBI_VALUES) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // Combination already set or being set, so return success.
+    if (lump_dev->mode_switch.desired_mode == PBIO_PORT_LUMP_MODE_COMBI &&
+        lump_dev->combi_num_values == num_values && !memcmp(lump_dev->combi_values, values, num_values)) {
+        return PBIO_SUCCESS;
+    }
+
+    // We can only initiate a mode switch if currently idle (receiving data).
+    pbio_error_t err = pbio_port_lump_is_ready(lump_dev);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Each dataset must exist in a mode that can be combined, and all data
+    // must fit in one message.
+    uint32_t size = 0;
+    for (uint8_t i = 0; i < num_values; i++) {
+        uint8_t mode = values[i] >> 4;
+        uint8_t dataset = values[i] & 0x0F;
+        if (mode >= lump_dev->num_modes || !(lump_dev->mode_combos & (1 << mode)) ||
+            dataset >= lump_dev->mode_info[mode].num_values) {
+            return PBIO_ERROR_INVALID_ARG;
+        }
+        size += pbio_port_lump_data_size(lump_dev->mode_info[mode].data_type);
+    }
+    if (size > LUMP_MAX_MSG_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    memcpy(lump_dev->combi_values, values, num_values);
+    lump_dev->combi_num_values = num_values;
+    lump_dev->combi_size = size;
+
+    // Request mode switch.
+    pbio_port_lump_request_mode(lump_dev, PBIO_PORT_LUMP_MODE_COMBI);
+
+    return PBIO_SUCCESS;
+
+    #else
+    return PBIO_ERROR_NOT_SUPPORTED;
+    #endif // PBIO_CONFIG_PORT_LUMP_MODE_INFO
+}
+
 /**
  * Asserts or gets the device id of a LEGO UART device.
  *
@@ -1201,6 +1610,16 @@ pbio_error_t pbio_port_lump_get_data(pbio_port_lump_dev_t *lump_dev, uint8_t mod
         return PBIO_ERROR_NO_DEV;
     }
 
+    #if PBIO_CONFIG_PORT_LUMP_MODE_INFO
+    // Data of a mode included in the active mode combination.
+    int32_t offset;
+    if (mode != lump_dev->mode && lump_dev->mode == PBIO_PORT_LUMP_MODE_COMBI &&
+        (offset = pbio_port_lump_get_combi_offset(lump_dev, mode)) >= 0) {
+        *data = lump_dev->bin_data + offset;
+        return pbio_port_lump_is_ready(lump_dev);
+    }
+    #endif
+
     // Can only request data for mode that is set.
     if (mode != lump_dev->mode) {
         return PBIO_ERROR_INVALID_OP;
@@ -1211,6 +1630,63 @@ pbio_error_t pbio_port_lump_get_data(pbio_port_lump_dev_t *lump_dev, uint8_t mod
     return pbio_port_lump_is_ready(lump_dev);
 }
 
+/**
+ * Gets a counter that changes each time the device may stop being ready,
+ * such as when it is disconnected, changes mode, or when data is set.
+ *
+ * Callers that found the device to be ready with ::pbio_port_lump_is_ready
+ * or got data with ::pbio_port_lump_get_data may keep using the result
+ * without checking again for as long as this value stays the same.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ * @return                  The counter value, or 0 if there is no device.
+ */
+uint32_t pbio_port_lump_get_generation(pbio_port_lump_dev_t *lump_dev) {
+    return lump_dev ? lump_dev->generation : 0;
+}
+
+/**
+ * Gets a counter that increments each time new data arrives for the given
+ * mode. This can be used to wait for new data instead of reading the same
+ * data again.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ * @param [in]  mode        The mode, which must be set.
+ * @param [in]  changed     Whether to count only data that differs from the previous data.
+ * @param [out] count       The counter value.
+ * @return                  Same as ::pbio_port_lump_get_data.
+ */
+pbio_error_t pbio_port_lump_get_data_count(pbio_port_lump_dev_t *lump_dev, uint8_t mode, bool changed, uint32_t *count) {
+    void *data;
+    pbio_error_t err = pbio_port_lump_get_data(lump_dev, mode, &data);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    *count = changed ? lump_dev->data_change_count : lump_dev->data_count;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Gets the time at which the data for the given mode was received.
+ *
+ * Data is sent by the device as soon as it is measured, so this is the time
+ * of measurement plus the time needed to transfer it over UART.
+ *
+ * @param [in]  lump_dev    The LEGO UART device instance.
+ * @param [in]  mode        The mode, which must be set.
+ * @param [out] time        Time at which the data was received (us).
+ * @return                  Same as ::pbio_port_lump_get_data.
+ */
+pbio_error_t pbio_port_lump_get_data_time(pbio_port_lump_dev_t *lump_dev, uint8_t mode, uint32_t *time) {
+    void *data;
+    pbio_error_t err = pbio_port_lump_get_data(lump_dev, mode, &data);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    *time = lump_dev->data_time;
+    return PBIO_SUCCESS;
+}
+
 /**
  * Set data for the current mode.
  *
@@ -1287,7 +1763,7 @@ pbio_error_t pbio_port_lump_request_reset(pbio_port_lump_dev_t *lump_dev) {
 
     // Forces data threads to exit, and therefore port thread will eventually
     // call sync thread again.
-    lump_dev->status = PBDRV_LEGODEV_LUMP_STATUS_ERR;
+    pbio_port_lump_set_status(lump_dev, PBDRV_LEGODEV_LUMP_STATUS_ERR);
     pbio_os_request_poll();
 
     return PBIO_SUCCESS;
@@ -16,12 +16,51 @@
 #include <pbio/observer.h>
 #include <pbio/parent.h>
 #include <pbio/servo.h>
+#include <pbio/trace.h>
+#include <pbio/util.h>
 
 #if PBIO_CONFIG_SERVO
 
 // Servo motor objects
 static pbio_servo_t servos[PBIO_CONFIG_SERVO_NUM_DEV];
 
+/**
+ * State of all servos, sampled once at the start of a control loop iteration.
+ */
+typedef struct {
+    /** Physical and estimated state of each servo. */
+    pbio_control_state_t state[PBIO_CONFIG_SERVO_NUM_DEV];
+    /** Result of sampling each servo. */
+    pbio_error_t err[PBIO_CONFIG_SERVO_NUM_DEV];
+    /** Whether the samples are valid for the current iteration. */
+    bool valid;
+} pbio_servo_samples_t;
+
+static pbio_servo_samples_t samples;
+
+/**
+ * Reads the servo state in units of control from the tacho and observer.
+ *
+ * @param [in]  srv         The servo instance.
+ * @param [out] state       The system state object in units of control.
+ * @return                  Error code.
+ */
+static pbio_error_t pbio_servo_read_state_control(pbio_servo_t *srv, pbio_control_state_t *state) {
+
+    pbio_error_t err;
+
+    // Read physical angle.
+    err = pbio_tacho_get_angle(&srv->tacho, &state->position);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Get estimated state
+    pbio_observer_get_estimated_state(&srv->observer, &state->speed, &state->position_estimate, &state->speed_estimate);
+
+    return PBIO_SUCCESS;
+}
+
 
 /**
  * Initializes servo state structure.
@@ -64,50 +103,175 @@ bool pbio_servo_update_loop_is_running(pbio_servo_t *srv) {
     return srv->run_update_loop;
 }
 
-static pbio_error_t pbio_servo_update(pbio_servo_t *srv) {
+/**
+ * Intermediate results of one servo during the update of all servos.
+ */
+typedef struct {
+    /** Physical and estimated state, sampled at the start of the update. */
+    pbio_control_state_t state;
+    /** Feedback torque calculated by the controller. */
+    int32_t feedback_torque;
+    /** Feedforward torque calculated from the reference. */
+    int32_t feedforward_torque;
+} pbio_servo_update_data_t;
 
-    // Get current time
-    uint32_t time_now = pbio_control_get_time_ticks();
+/**
+ * Runs the controller and actuates the motor based on the sampled state.
+ *
+ * @param [in]  srv         The servo instance.
+ * @param [in]  time_now    The time at which the state was sampled.
+ * @param [in]  data        The sampled state, also holds the resulting control action.
+ * @return                  Error code.
+ */
+static pbio_error_t pbio_servo_update_control(pbio_servo_t *srv, uint32_t time_now, pbio_servo_update_data_t *data) {
 
-    // Read the physical and estimated state
-    pbio_control_state_t state;
-    pbio_error_t err = pbio_servo_get_state_control(srv, &state);
-    if (err != PBIO_SUCCESS) {
-        return err;
+    // Control action to be calculated
+    data->feedback_torque = 0;
+    data->feedforward_torque = 0;
+
+    // Check if a control update is needed
+    if (!pbio_control_is_active(&srv->control)) {
+        return PBIO_SUCCESS;
     }
 
     // Trajectory reference point
     pbio_trajectory_reference_t ref;
 
-    // Control action to be calculated
-    int32_t feedback_torque = 0;
-    int32_t feedforward_torque = 0;
+    // Calculate feedback control signal
+    pbio_dcmotor_actuation_t requested_actuation;
+    bool external_pause = false;
+    pbio_control_update(&srv->control, time_now, &data->state, &ref, &requested_actuation, &data->feedback_torque, &external_pause);
 
-    // Check if a control update is needed
+    // Get required feedforward torque for current reference
+    data->feedforward_torque = pbio_observer_get_feedforward_torque(srv->observer.model, ref.speed, ref.acceleration);
+
+    // HACK: Constrain total torque to respect temporary duty_cycle limit.
+    // See https://github.com/pybricks/support/issues/1069.
+    // The feedback torque is already constrained by the temporary limit,
+    // and this would be enough in a run_until_overload-like scenario. But
+    // for now we must limit the feedforward torque also, or it would never
+    // get into the stall state at high speeds.
+    int32_t total_torque = pbio_int_math_clamp(data->feedback_torque + data->feedforward_torque, srv->control.settings.actuation_max_temporary);
+
+    // Actuate the servo. For torque control, the torque payload is passed along. Otherwise payload is ignored.
+    return pbio_servo_actuate(srv, requested_actuation, total_torque);
+}
+
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+/**
+ * Voltages (mV) applied in turn to identify the motor model. Each step
+ * changes the speed without changing direction, except when going through
+ * zero, which is used only for the steady state data. The voltages stay
+ * below the battery voltage, so the motor gets what is asked.
+ */
+static const int16_t pbio_servo_identification_voltages[] = {
+    2000, 4000, 6000, 4000, 2000, -2000, -4000, -6000, -4000, -2000,
+};
+
+/**
+ * Duration of each identification voltage step in ms. This is long enough
+ * for all motors to reach a constant speed.
+ */
+#define PBIO_SERVO_IDENTIFICATION_STEP_TIME (400)
+
+/**
+ * Percentage of each step after which the speed is considered constant.
+ */
+#define PBIO_SERVO_IDENTIFICATION_STEADY_PCT (60)
+
+/**
+ * Stops identification of the motor model, if it is running.
+ *
+ * @param [in]  srv         The servo instance.
+ * @param [in]  result      Outcome to report.
+ */
+static void pbio_servo_identify_model_stop(pbio_servo_t *srv, pbio_error_t result) {
+    if (srv->identification.result == PBIO_ERROR_AGAIN) {
+        srv->identification.result = result;
+    }
+}
+
+/**
+ * Starts a voltage step of the model identification.
+ *
+ * @param [in]  srv         The servo instance.
+ * @param [in]  time_now    The current time.
+ * @param [in]  state       The current state.
+ * @return                  Error code.
+ */
+static pbio_error_t pbio_servo_identify_model_start_step(pbio_servo_t *srv, uint32_t time_now, const pbio_control_state_t *state) {
+    pbio_servo_identification_t *id = &srv->identification;
+    id->time_start = time_now;
+    id->angle_start = state->position;
+    id->speed_start = state->speed;
+    return pbio_dcmotor_set_voltage(srv->dcmotor, pbio_servo_identification_voltages[id->step]);
+}
+
+/**
+ * Collects model identification data and advances to the next voltage step.
+ *
+ * This runs after the observer update, while identification is active.
+ *
+ * @param [in]  srv         The servo instance.
+ * @param [in]  time_now    The time at which the state was sampled.
+ * @param [in]  state       The sampled state.
+ * @param [in]  voltage     The voltage that was applied.
+ */
+static void pbio_servo_identify_model_update(pbio_servo_t *srv, uint32_t time_now, const pbio_control_state_t *state, int32_t voltage) {
+    pbio_servo_identification_t *id = &srv->identification;
+
+    // Any controlled command takes over the motor.
     if (pbio_control_is_active(&srv->control)) {
+        pbio_servo_identify_model_stop(srv, PBIO_ERROR_CANCELED);
+        return;
+    }
 
-        // Calculate feedback control signal
-        pbio_dcmotor_actuation_t requested_actuation;
-        bool external_pause = false;
-        pbio_control_update(&srv->control, time_now, &state, &ref, &requested_actuation, &feedback_torque, &external_pause);
+    // Once the speed settles, the applied torque only overcomes friction and
+    // the speed dependent losses.
+    uint32_t elapsed = pbio_control_time_ticks_to_ms(time_now - id->time_start);
+    if (elapsed * 100 >= PBIO_SERVO_IDENTIFICATION_STEP_TIME * PBIO_SERVO_IDENTIFICATION_STEADY_PCT) {
+        pbio_observer_identification_add_steady(&id->fit, state->speed, pbio_observer_voltage_to_torque(srv->observer.model, voltage));
+    }
 
-        // Get required feedforward torque for current reference
-        feedforward_torque = pbio_observer_get_feedforward_torque(srv->observer.model, ref.speed, ref.acceleration);
+    if (elapsed < PBIO_SERVO_IDENTIFICATION_STEP_TIME) {
+        return;
+    }
 
-        // HACK: Constrain total torque to respect temporary duty_cycle limit.
-        // See https://github.com/pybricks/support/issues/1069.
-        // The feedback torque is already constrained by the temporary limit,
-        // and this would be enough in a run_until_overload-like scenario. But
-        // for now we must limit the feedforward torque also, or it would never
-        // get into the stall state at high speeds.
-        int32_t total_torque = pbio_int_math_clamp(feedback_torque + feedforward_torque, srv->control.settings.actuation_max_temporary);
+    // The whole step gives the time constant.
+    pbio_observer_identification_add_step(&id->fit, id->speed_start, state->speed,
+        pbio_angle_diff_mdeg(&state->position, &id->angle_start), elapsed);
 
-        // Actuate the servo. For torque control, the torque payload is passed along. Otherwise payload is ignored.
-        err = pbio_servo_actuate(srv, requested_actuation, total_torque);
-        if (err != PBIO_SUCCESS) {
-            return err;
+    // Go to the next step, if any.
+    if (++id->step < PBIO_ARRAY_SIZE(pbio_servo_identification_voltages)) {
+        if (pbio_servo_identify_model_start_step(srv, time_now, state) != PBIO_SUCCESS) {
+            pbio_servo_identify_model_stop(srv, PBIO_ERROR_FAILED);
         }
+        return;
+    }
+
+    // Done, so coast and use the identified model if it makes sense.
+    pbio_dcmotor_coast(srv->dcmotor);
+    pbio_error_t err = pbio_observer_identification_solve(&id->fit, srv->observer.model, &id->model);
+    if (err == PBIO_SUCCESS) {
+        srv->observer.model = &id->model;
     }
+    pbio_servo_identify_model_stop(srv, err);
+}
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+/**
+ * Logs the servo state and updates the observer with the applied actuation.
+ *
+ * @param [in]  srv         The servo instance.
+ * @param [in]  time_now    The time at which the state was sampled.
+ * @param [in]  data        The sampled state and control action.
+ */
+static void pbio_servo_update_observer(pbio_servo_t *srv, uint32_t time_now, const pbio_servo_update_data_t *data) {
+
+    const pbio_control_state_t *state = &data->state;
+
     // Whether or not there is control, get the ongoing actuation state so we can log it and update observer.
     pbio_dcmotor_actuation_t applied_actuation;
     int32_t voltage;
@@ -126,63 +290,132 @@ static pbio_error_t pbio_servo_update(pbio_servo_t *srv) {
             // Column 1: Current time.
             time_now,
             // Column 2: Motor angle in degrees.
-            pbio_control_settings_ctl_to_app_long(&srv->control.settings, &state.position),
+            pbio_control_settings_ctl_to_app_long(&srv->control.settings, &state->position),
             // Column 3: Motor speed in degrees/second.
-            pbio_control_settings_ctl_to_app(&srv->control.settings, state.speed),
+            pbio_control_settings_ctl_to_app(&srv->control.settings, state->speed),
             // Column 4: Actuation type (LSB 0--1), stall state (LSB 2).
             applied_actuation | ((int32_t)stalled << 2),
             // Column 5: Actuation voltage.
             voltage,
             // Column 6: Estimated position in degrees.
-            pbio_control_settings_ctl_to_app_long(&srv->control.settings, &state.position_estimate),
+            pbio_control_settings_ctl_to_app_long(&srv->control.settings, &state->position_estimate),
             // Column 7: Estimated speed in degrees/second.
-            pbio_control_settings_ctl_to_app(&srv->control.settings, state.speed_estimate),
+            pbio_control_settings_ctl_to_app(&srv->control.settings, state->speed_estimate),
             // Column 8: Feedback torque (uNm).
-            feedback_torque,
+            data->feedback_torque,
             // Column 9: Feedforward torque (uNm).
-            feedforward_torque,
+            data->feedforward_torque,
             // Column 10: Observer error feedback voltage torque (mV).
-            pbio_observer_get_feedback_voltage(&srv->observer, &state.position),
+            pbio_observer_get_feedback_voltage(&srv->observer, &state->position),
         };
         pbio_logger_add_row(&srv->log, log_data);
     }
 
+    // Speed from encoder edge timing, if the counter supports it.
+    int32_t edge_speed;
+    bool edge_speed_valid = pbio_tacho_get_edge_speed(&srv->tacho, &edge_speed) == PBIO_SUCCESS;
+
     // Update the state observer
-    pbio_observer_update(&srv->observer, time_now, &state.position, applied_actuation, voltage);
+    pbio_observer_update(&srv->observer, time_now, &state->position, applied_actuation, voltage, edge_speed_valid ? &edge_speed : NULL);
 
-    return PBIO_SUCCESS;
+    #if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+    if (srv->identification.result == PBIO_ERROR_AGAIN) {
+        pbio_servo_identify_model_update(srv, time_now, state, voltage);
+    }
+    #endif
 }
 
 /**
- * Updates the servo state and controller.
+ * Stops a servo after its update failed, so it won't be updated anymore.
  *
- * This gets called once on every control loop.
+ * @param [in]  srv         The servo instance.
  */
-void pbio_servo_update_all(void) {
-    pbio_error_t err;
+static void pbio_servo_update_failed(pbio_servo_t *srv) {
+    // If the update failed, don't update it anymore.
+    pbio_servo_update_loop_set_state(srv, false);
+
+    // Coast the motor, letting errors pass.
+    pbio_dcmotor_coast(srv->dcmotor);
 
-    // Go through all motors.
+    // Stop the control state.
+    pbio_control_reset(&srv->control);
+
+    // Stop higher level controls, such as drive bases.
+    pbio_parent_stop(&srv->parent, false);
+}
+
+/**
+ * Samples the physical and estimated state of all servos.
+ *
+ * This gets called once at the start of every control loop iteration, before
+ * the drive bases and servos are updated. Until the servos are updated,
+ * pbio_servo_get_state_control() returns these samples, so drive bases and
+ * their wheels use the same state without reading the motors again.
+ */
+PBIO_HOT void pbio_servo_sample_all(void) {
     for (uint8_t i = 0; i < PBIO_CONFIG_SERVO_NUM_DEV; i++) {
         pbio_servo_t *srv = &servos[i];
+        if (!srv->run_update_loop) {
+            continue;
+        }
+        samples.err[i] = pbio_servo_read_state_control(srv, &samples.state[i]);
+        if (samples.err[i] == PBIO_SUCCESS) {
+            pbio_trace_record(PBIO_TRACE_EVENT_MOTOR_ANGLE, i, &samples.state[i].position, sizeof(pbio_angle_t));
+        }
+    }
+    samples.valid = true;
+}
 
-        // Run update loop only if registered.
-        if (srv->run_update_loop) {
-            err = pbio_servo_update(srv);
-            if (err != PBIO_SUCCESS) {
-                // If the update failed, don't update it anymore.
-                pbio_servo_update_loop_set_state(srv, false);
+/**
+ * Updates the servo state and controller.
+ *
+ * This gets called once on every control loop. All servos are updated in
+ * phases: first all angles are sampled at the same time, then all
+ * controllers run and actuate the motors, and finally all observers are
+ * updated. This way, motors that move together are controlled based on
+ * samples taken at the same instant.
+ */
+PBIO_HOT void pbio_servo_update_all(void) {
 
-                // Coast the motor, letting errors pass.
-                pbio_dcmotor_coast(srv->dcmotor);
+    pbio_servo_update_data_t data[PBIO_CONFIG_SERVO_NUM_DEV];
+
+    // Get current time, shared by all servos.
+    uint32_t time_now = pbio_control_get_time_ticks();
+
+    // Use the state sampled at the start of this iteration, if any.
+    if (!samples.valid) {
+        pbio_servo_sample_all();
+    }
+    for (uint8_t i = 0; i < PBIO_CONFIG_SERVO_NUM_DEV; i++) {
+        pbio_servo_t *srv = &servos[i];
+        if (!srv->run_update_loop) {
+            continue;
+        }
+        if (samples.err[i] != PBIO_SUCCESS) {
+            pbio_servo_update_failed(srv);
+            continue;
+        }
+        data[i].state = samples.state[i];
+    }
 
-                // Stop the control state.
-                pbio_control_reset(&srv->control);
+    // Run the controllers and actuate the motors.
+    for (uint8_t i = 0; i < PBIO_CONFIG_SERVO_NUM_DEV; i++) {
+        pbio_servo_t *srv = &servos[i];
+        if (srv->run_update_loop && pbio_servo_update_control(srv, time_now, &data[i]) != PBIO_SUCCESS) {
+            pbio_servo_update_failed(srv);
+        }
+    }
 
-                // Stop higher level controls, such as drive bases.
-                pbio_parent_stop(&srv->parent, false);
-            }
+    // Log applied actuation and update the observers.
+    for (uint8_t i = 0; i < PBIO_CONFIG_SERVO_NUM_DEV; i++) {
+        pbio_servo_t *srv = &servos[i];
+        if (srv->run_update_loop) {
+            pbio_servo_update_observer(srv, time_now, &data[i]);
         }
     }
+
+    // The observers have moved on, so read the state again next time.
+    samples.valid = false;
 }
 
 // This function is attached to a dcmotor object, so it is able to
@@ -192,6 +425,10 @@ static pbio_error_t pbio_servo_stop_from_dcmotor(void *servo, bool clear_parent)
     // Specify pointer type.
     pbio_servo_t *srv = servo;
 
+    #if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+    pbio_servo_identify_model_stop(srv, PBIO_ERROR_CANCELED);
+    #endif
+
     // This external stop is triggered by a lower level peripheral,
     // i.e. the dc motor. So it has already has been stopped or changed state
     // electrically. All we have to do here is stop the control loop,
@@ -306,6 +543,7 @@ static pbio_error_t pbio_servo_initialize_settings(pbio_servo_t *srv, lego_devic
     };
 
     pbio_servo_override_settings(&srv->control.settings, type);
+    pbio_control_settings_update_kp_schedule(&srv->control.settings);
 
     return PBIO_SUCCESS;
 }
@@ -327,6 +565,10 @@ pbio_error_t pbio_servo_setup(pbio_servo_t *srv, lego_device_type_id_t type, pbi
     // Unregister this servo from control loop updates.
     pbio_servo_update_loop_set_state(srv, false);
 
+    #if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+    srv->identification.result = PBIO_ERROR_INVALID_OP;
+    #endif
+
     // Configure tacho.
     err = pbio_tacho_setup(&srv->tacho, direction, reset_angle);
     if (err != PBIO_SUCCESS) {
@@ -431,24 +673,22 @@ pbio_error_t pbio_servo_reset_angle(pbio_servo_t *srv, int32_t reset_angle, bool
  * Gets the servo state in units of control. This means millidegrees at the
  * motor output shaft, before any external gearing.
  *
+ * While the control loop runs, this returns the state sampled at the start of
+ * the loop by pbio_servo_sample_all().
+ *
  * @param [in]  srv         The servo instance.
  * @param [out] state       The system state object in units of control.
  * @return                  Error code.
  */
 pbio_error_t pbio_servo_get_state_control(pbio_servo_t *srv, pbio_control_state_t *state) {
 
-    pbio_error_t err;
-
-    // Read physical angle.
-    err = pbio_tacho_get_angle(&srv->tacho, &state->position);
-    if (err != PBIO_SUCCESS) {
-        return err;
+    // During the control loop, use the state sampled at the start of it.
+    if (samples.valid && srv->run_update_loop) {
+        uint8_t i = srv - servos;
+        *state = samples.state[i];
+        return samples.err[i];
     }
-
-    // Get estimated state
-    pbio_observer_get_estimated_state(&srv->observer, &state->speed, &state->position_estimate, &state->speed_estimate);
-
-    return PBIO_SUCCESS;
+    return pbio_servo_read_state_control(srv, state);
 }
 
 /**
@@ -575,6 +815,9 @@ pbio_error_t pbio_servo_stop(pbio_servo_t *srv, pbio_control_on_completion_t on_
 
     // All other stop modes are passive, so stop control and actuate accordingly.
     pbio_control_stop(&srv->control);
+    #if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+    pbio_servo_identify_model_stop(srv, PBIO_ERROR_CANCELED);
+    #endif
     return pbio_servo_actuate(srv, pbio_control_passive_completion_to_actuation_type(on_completion), 0);
 }
 
@@ -721,6 +964,113 @@ pbio_error_t pbio_servo_run_target(pbio_servo_t *srv, int32_t speed, int32_t tar
     return pbio_control_start_position_control(&srv->control, time_now, &state, target, speed, on_completion);
 }
 
+/**
+ * Runs the servo to a given target angle after the current run_target
+ * command completes.
+ *
+ * If the servo keeps going in the same direction, the previous command
+ * does not slow down at its target but keeps going at speed, so several
+ * queued targets make one continuous motion. If no position command is
+ * active, this is the same as pbio_servo_run_target.
+ *
+ * @param [in]  srv            The control instance.
+ * @param [in]  speed          Top angular velocity in degrees per second. If zero, default speed is used.
+ * @param [in]  target         Angle to run to.
+ * @param [in]  on_completion  What to do after becoming stationary at the target angle.
+ * @return                     ::PBIO_ERROR_BUSY if too many commands are queued, otherwise other error code.
+ */
+pbio_error_t pbio_servo_queue_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_control_on_completion_t on_completion) {
+
+    // Don't allow new user command if update loop not registered.
+    if (!pbio_servo_update_loop_is_running(srv)) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    // Nothing to queue behind, so start like any other command.
+    if (!pbio_control_type_is_position(&srv->control)) {
+        return pbio_servo_run_target(srv, speed, target, on_completion);
+    }
+
+    uint32_t time_now = pbio_control_get_time_ticks();
+
+    pbio_control_state_t state;
+    pbio_error_t err = pbio_servo_get_state_control(srv, &state);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    return pbio_control_queue_position_control(&srv->control, time_now, &state, target, speed, on_completion);
+}
+
+/**
+ * Runs several servos to their target angles, such that they all start and
+ * finish at the same time.
+ *
+ * Each servo first gets a trajectory as in pbio_servo_run_target. The other
+ * trajectories are then stretched to take as long as the slowest one. All
+ * servos are updated with the same time in pbio_servo_update_all, so they
+ * also stay in sync along the way.
+ *
+ * @param [in]  srvs           The servo instances.
+ * @param [in]  targets        Angle to run to, for each servo.
+ * @param [in]  num_servos     Number of servos.
+ * @param [in]  speed          Top angular velocity in degrees per second of the slowest servo. If zero, the default speed of each servo is used.
+ * @param [in]  on_completion  What to do after becoming stationary at the target angles.
+ * @return                     Error code.
+ */
+pbio_error_t pbio_servo_run_targets_synced(pbio_servo_t **srvs, const int32_t *targets, uint8_t num_servos, int32_t speed, pbio_control_on_completion_t on_completion) {
+
+    pbio_error_t err;
+
+    // Don't allow new user command if any update loop is not registered.
+    for (uint8_t i = 0; i < num_servos; i++) {
+        if (!pbio_servo_update_loop_is_running(srvs[i])) {
+            return PBIO_ERROR_NO_DEV;
+        }
+    }
+
+    // Get current time, shared by all servos.
+    uint32_t time_now = pbio_control_get_time_ticks();
+
+    // Start each servo on its own trajectory, and find the one that takes the longest.
+    pbio_servo_t *leader = NULL;
+    for (uint8_t i = 0; i < num_servos; i++) {
+        pbio_servo_t *srv = srvs[i];
+
+        // Stop parent object that uses this motor, if any.
+        err = pbio_parent_stop(&srv->parent, false);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        // Read the physical and estimated state
+        pbio_control_state_t state;
+        err = pbio_servo_get_state_control(srv, &state);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        err = pbio_control_start_position_control(&srv->control, time_now, &state, targets[i], speed, on_completion);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        if (!leader || pbio_trajectory_get_duration(&srv->control.trajectory) > pbio_trajectory_get_duration(&leader->control.trajectory)) {
+            leader = srv;
+        }
+    }
+
+    // Revise the other trajectories so they take as long as the leader, by
+    // picking lower speeds and accelerations that make the times match.
+    for (uint8_t i = 0; i < num_servos; i++) {
+        if (srvs[i] != leader) {
+            pbio_trajectory_stretch(&srvs[i]->control.trajectory, &leader->control.trajectory);
+        }
+    }
+
+    return PBIO_SUCCESS;
+}
+
 /**
  * Runs the servo at a given speed by a given angle and stops there.
  *
@@ -775,8 +1125,9 @@ pbio_error_t pbio_servo_run_angle(pbio_servo_t *srv, int32_t speed, int32_t angl
  * Steers the servo to the given target and holds it there.
  *
  * This is similar to pbio_servo_run_target when using hold on completion,
- * but it skips the smooth speed curve and immediately sets the reference
- * angle to the new target.
+ * but it skips the smooth speed curve. The first target is held right away.
+ * When called repeatedly, the reference moves at constant speed towards each
+ * new target, arriving by the time the next one is expected.
  *
  * @param [in]  srv            The control instance.
  * @param [in]  target         Angle to run to and keep tracking.
@@ -795,8 +1146,8 @@ pbio_error_t pbio_servo_track_target(pbio_servo_t *srv, int32_t target) {
         return err;
     }
 
-    // Start hold command.
-    return pbio_control_start_position_control_hold(&srv->control, pbio_control_get_time_ticks(), target);
+    // Start or continue tracking.
+    return pbio_control_start_position_control_track(&srv->control, pbio_control_get_time_ticks(), target);
 }
 
 /**
@@ -890,4 +1241,69 @@ pbio_error_t pbio_servo_get_load(pbio_servo_t *srv, int32_t *load) {
     return PBIO_SUCCESS;
 }
 
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+/**
+ * Starts identifying the feedforward model of the servo.
+ *
+ * The motor is driven with a series of constant voltages in both directions,
+ * so it must be free to spin. When done, the motor coasts and the identified
+ * model replaces the default model for this motor type until the servo is set
+ * up again. Any other command for this motor cancels the identification.
+ *
+ * @param [in]  srv         The servo instance.
+ * @return                  Error code.
+ */
+pbio_error_t pbio_servo_identify_model_start(pbio_servo_t *srv) {
+
+    // Don't allow new user command if update loop not registered.
+    if (!pbio_servo_update_loop_is_running(srv)) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    // Stop parent object that uses this motor, if any.
+    pbio_error_t err = pbio_parent_stop(&srv->parent, false);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Identification runs without the controller.
+    pbio_control_stop(&srv->control);
+
+    pbio_control_state_t state;
+    err = pbio_servo_get_state_control(srv, &state);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    pbio_servo_identification_t *id = &srv->identification;
+    pbio_observer_identification_reset(&id->fit);
+    id->step = 0;
+    err = pbio_servo_identify_model_start_step(srv, pbio_control_get_time_ticks(), &state);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    id->result = PBIO_ERROR_AGAIN;
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Gets the outcome of the model identification.
+ *
+ * @param [in]  srv         The servo instance.
+ * @return                  ::PBIO_ERROR_AGAIN while it runs,
+ *                          ::PBIO_ERROR_CANCELED if another command took over,
+ *                          ::PBIO_ERROR_FAILED if no valid model was found,
+ *                          ::PBIO_ERROR_INVALID_OP if it was never started,
+ *                          otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbio_servo_identify_model_result(pbio_servo_t *srv) {
+    if (!pbio_servo_update_loop_is_running(srv)) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    return srv->identification.result;
+}
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
 #endif // PBIO_CONFIG_SERVO
@@ -43,6 +43,26 @@ pbio_error_t pbio_tacho_get_angle(pbio_tacho_t *tacho, pbio_angle_t *angle) {
     return PBIO_SUCCESS;
 }
 
+/**
+ * Gets the speed from the time between encoder edges, if supported.
+ *
+ * @param [in]  tacho       The tacho instance.
+ * @param [out] speed       Speed in millidegrees per second.
+ * @return                  Error code.
+ */
+pbio_error_t pbio_tacho_get_edge_speed(pbio_tacho_t *tacho, int32_t *speed) {
+    pbio_error_t err = pbio_port_get_edge_speed(tacho->port, speed);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Negate result depending on chosen positive direction.
+    if (tacho->direction == PBIO_DIRECTION_COUNTERCLOCKWISE) {
+        *speed = -*speed;
+    }
+    return PBIO_SUCCESS;
+}
+
 /**
  * Resets the tacho angle to a given value.
  *
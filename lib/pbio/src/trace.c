@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pbdrv/clock.h>
+
+#include <pbio/config.h>
+#include <pbio/trace.h>
+#include <pbio/util.h>
+
+/**
+ * Reads the next event from a recording.
+ *
+ * This does not need tracing to be enabled, so recordings can be replayed
+ * on builds that do not record.
+ *
+ * @param [in]     buf      The recording.
+ * @param [in]     size     Size of the recording in bytes.
+ * @param [in,out] offset   Offset of the event to read, advanced to the next
+ *                          event. Start at 0.
+ * @param [out]    event    The event.
+ * @return                  True if an event was read, false at the end of
+ *                          the recording or if the last event is incomplete.
+ */
+bool pbio_trace_read_event(const uint8_t *buf, uint32_t size, uint32_t *offset, pbio_trace_event_t *event) {
+    if (*offset > size || size - *offset < PBIO_TRACE_EVENT_HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t *header = &buf[*offset];
+    uint8_t data_size = header[6];
+    if (size - *offset - PBIO_TRACE_EVENT_HEADER_SIZE < data_size) {
+        return false;
+    }
+
+    event->time = pbio_get_uint32_le(header);
+    event->type = header[4];
+    event->id = header[5];
+    event->size = data_size;
+    event->data = header + PBIO_TRACE_EVENT_HEADER_SIZE;
+    *offset += PBIO_TRACE_EVENT_HEADER_SIZE + data_size;
+    return true;
+}
+
+#if PBIO_CONFIG_TRACE
+
+static struct {
+    /** Buffer allocated by the application, or NULL if not recording. */
+    uint8_t *buf;
+    /** Size of the buffer. */
+    uint32_t size;
+    /** Number of bytes used so far. */
+    uint32_t used;
+    /** Whether events were dropped because the buffer was full. */
+    bool truncated;
+} trace;
+
+/**
+ * Starts recording events into a buffer, discarding any previous recording.
+ *
+ * @param [in]  buf     Buffer that remains valid until recording stops.
+ * @param [in]  size    Size of the buffer in bytes.
+ */
+void pbio_trace_start(uint8_t *buf, uint32_t size) {
+    trace.buf = buf;
+    trace.size = size;
+    trace.used = 0;
+    trace.truncated = false;
+}
+
+/**
+ * Stops recording.
+ *
+ * @return              Number of bytes recorded.
+ */
+uint32_t pbio_trace_stop(void) {
+    trace.buf = NULL;
+    return trace.used;
+}
+
+/**
+ * Checks if events are being recorded.
+ *
+ * @return              True if recording.
+ */
+bool pbio_trace_is_active(void) {
+    return trace.buf != NULL;
+}
+
+/**
+ * Checks if events were dropped in the most recent recording because the
+ * buffer was full.
+ *
+ * @return              True if events were dropped.
+ */
+bool pbio_trace_is_truncated(void) {
+    return trace.truncated;
+}
+
+/**
+ * Records an event if recording is active.
+ *
+ * Events that do not fit are dropped, but later smaller events may still
+ * be recorded, so replay tools should check ::pbio_trace_is_truncated.
+ *
+ * @param [in]  type    Type of event.
+ * @param [in]  id      Device identifier.
+ * @param [in]  data    Event data.
+ * @param [in]  size    Size of the event data in bytes.
+ */
+void pbio_trace_record(pbio_trace_event_type_t type, uint8_t id, const void *data, uint8_t size) {
+    if (!trace.buf) {
+        return;
+    }
+
+    if (trace.size - trace.used < PBIO_TRACE_EVENT_HEADER_SIZE + (uint32_t)size) {
+        trace.truncated = true;
+        return;
+    }
+
+    uint8_t *header = &trace.buf[trace.used];
+    pbio_set_uint32_le(header, pbdrv_clock_get_us());
+    header[4] = type;
+    header[5] = id;
+    header[6] = size;
+    memcpy(header + PBIO_TRACE_EVENT_HEADER_SIZE, data, size);
+    trace.used += PBIO_TRACE_EVENT_HEADER_SIZE + size;
+}
+
+#endif // PBIO_CONFIG_TRACE
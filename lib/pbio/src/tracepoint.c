@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <pbio/config.h>
+
+#if PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbdrv/clock.h>
+
+#include <pbio/os.h>
+#include "pbio_os_config.h"
+#include <pbio/tracepoint.h>
+
+#if PBIO_CONFIG_TRACEPOINT_NUM_EVENTS & (PBIO_CONFIG_TRACEPOINT_NUM_EVENTS - 1)
+#error "PBIO_CONFIG_TRACEPOINT_NUM_EVENTS must be a power of two"
+#endif
+
+static struct {
+    /** Recent events, oldest overwritten first. */
+    pbio_tracepoint_event_t events[PBIO_CONFIG_TRACEPOINT_NUM_EVENTS];
+    /** Total number of events recorded since enabled. Wraps around. */
+    volatile uint32_t count;
+    /** Whether events are recorded. */
+    volatile bool enabled;
+} tracepoint;
+
+/**
+ * Starts or stops recording events.
+ *
+ * Starting discards previously recorded events.
+ *
+ * @param [in]  enable  True to start recording, false to stop.
+ */
+void pbio_tracepoint_set_enabled(bool enable) {
+    if (enable) {
+        tracepoint.count = 0;
+    }
+    tracepoint.enabled = enable;
+}
+
+/**
+ * Records an event if recording is enabled.
+ *
+ * This may be called from interrupt handlers. Only the slot is claimed with
+ * interrupts disabled. The event itself is written afterwards.
+ *
+ * @param [in]  id      Event identifier.
+ * @param [in]  arg0    First event argument.
+ * @param [in]  arg1    Second event argument.
+ */
+void pbio_tracepoint_record(pbio_tracepoint_id_t id, uint16_t arg0, uint32_t arg1) {
+    if (!tracepoint.enabled) {
+        return;
+    }
+
+    pbio_os_irq_flags_t flags = pbio_os_hook_disable_irq();
+    uint32_t index = tracepoint.count++;
+    pbio_os_hook_enable_irq(flags);
+
+    pbio_tracepoint_event_t *event = &tracepoint.events[index % PBIO_CONFIG_TRACEPOINT_NUM_EVENTS];
+    event->time = pbdrv_clock_get_us();
+    event->id = id;
+    event->arg0 = arg0;
+    event->arg1 = arg1;
+}
+
+/**
+ * Copies the most recent events, oldest first.
+ *
+ * Recording should be stopped first, so that events are not overwritten
+ * while they are copied.
+ *
+ * @param [out] events      Buffer for the events.
+ * @param [in]  max_events  Number of events that fit in the buffer.
+ * @return                  Number of events copied.
+ */
+uint32_t pbio_tracepoint_get_events(pbio_tracepoint_event_t *events, uint32_t max_events) {
+    uint32_t count = tracepoint.count;
+    uint32_t available = count < PBIO_CONFIG_TRACEPOINT_NUM_EVENTS ? count : PBIO_CONFIG_TRACEPOINT_NUM_EVENTS;
+    uint32_t num_events = available < max_events ? available : max_events;
+
+    for (uint32_t i = 0; i < num_events; i++) {
+        events[i] = tracepoint.events[(count - num_events + i) % PBIO_CONFIG_TRACEPOINT_NUM_EVENTS];
+    }
+    return num_events;
+}
+
+#endif // PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
@@ -10,8 +10,10 @@
 #include <stdlib.h>
 
 #include <pbio/angle.h>
+#include <pbio/config.h>
 #include <pbio/int_math.h>
 #include <pbio/trajectory.h>
+#include <pbio/util.h>
 
 /**
  * For a single maneuver, the relative angle in millidegrees is capped at
@@ -214,6 +216,37 @@ void pbio_trajectory_make_constant(pbio_trajectory_t *trj, const pbio_trajectory
     trj->w3 = c->continue_running ? to_trajectory_speed(c->speed_target): 0;
 }
 
+/**
+ * Reciprocals of recently used accelerations. Commands mostly use the same
+ * acceleration and deceleration settings, so the divisions by them can be
+ * done as multiplications. This matters on hubs without a hardware divider.
+ */
+static pbio_int_math_reciprocal_t accel_reciprocals[4];
+
+/**
+ * Index of the reciprocal to replace next.
+ */
+static uint8_t accel_reciprocals_next;
+
+/**
+ * Gets the reciprocal of an acceleration, computing it only if it was not
+ * used recently.
+ *
+ * @param [in]  a       The acceleration in deg/s^2.
+ * @returns             The reciprocal.
+ */
+static const pbio_int_math_reciprocal_t *get_accel_reciprocal(int32_t a) {
+    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(accel_reciprocals); i++) {
+        if (accel_reciprocals[i].divisor == a) {
+            return &accel_reciprocals[i];
+        }
+    }
+    pbio_int_math_reciprocal_t *reciprocal = &accel_reciprocals[accel_reciprocals_next];
+    accel_reciprocals_next = (accel_reciprocals_next + 1) % PBIO_ARRAY_SIZE(accel_reciprocals);
+    pbio_int_math_reciprocal_init(reciprocal, a);
+    return reciprocal;
+}
+
 /**
  * Gets the traversed angle when accelerating from one speed value to another.
  *
@@ -230,7 +263,9 @@ static int32_t div_w2_by_a(int32_t w_end, int32_t w_start, int32_t a) {
     assert_speed(w_end);
     assert_speed(w_start);
 
-    return pbio_int_math_mult_then_div(w_end * w_end - w_start * w_start, (10 / 2), a);
+    // The numerator is below 2^31 for speeds within bounds, so the result
+    // may exceed the truncated quotient by at most 1 mdeg.
+    return pbio_int_math_reciprocal_div(get_accel_reciprocal(a), (w_end * w_end - w_start * w_start) * (10 / 2));
 }
 
 /**
@@ -245,7 +280,7 @@ static int32_t div_w_by_a(int32_t w, int32_t a) {
     assert_accel_numerator(a);
     assert_speed_rel(w);
 
-    return w * 1000 / a;
+    return pbio_int_math_reciprocal_div(get_accel_reciprocal(a), w * 1000);
 }
 
 /**
@@ -343,6 +378,39 @@ static int32_t mul_a_by_t2(int32_t a, int32_t t) {
     return mul_w_by_t(mul_a_by_t(a, t), t) / 2;
 }
 
+/**
+ * Gets the speed and angle along a constant acceleration ramp.
+ *
+ * This is equivalent to mul_a_by_t() for the speed and mul_w_by_t() plus
+ * mul_a_by_t2() for the angle, but the angle is evaluated as
+ * t * (2000 * w + a * t) / 200000 so that both values cost just one long
+ * multiply-divide. This is called for every control sample, so it matters on
+ * hubs without a hardware divider.
+ *
+ * Within a ramp, a * t is bounded by the speed change along the ramp, so it
+ * does not overflow.
+ *
+ * @param [in]  w       The speed at the start of the ramp in ddeg/s.
+ * @param [in]  a       The acceleration in deg/s^2.
+ * @param [in]  t       The time since the start of the ramp in s*10^-4.
+ * @param [out] w_t     The speed at time t in ddeg/s.
+ * @returns             The angle in mdeg.
+ */
+static int32_t eval_ramp(int32_t w, int32_t a, int32_t t, int32_t *w_t) {
+
+    assert_time(t);
+    assert_accel_small(a);
+    assert_accel_time(t);
+    assert_speed(w);
+
+    int32_t dw = a * t;
+    assert_speed_rel(dw / 1000);
+
+    *w_t = w + dw / 1000;
+    // The divisor is split to stay within range of pbio_int_math_mult_then_div.
+    return pbio_int_math_mult_then_div(2000 * w + dw, t, 20000) / 10;
+}
+
 /**
  * Gets starting speed to reach end speed within given angle and acceleration.
  *
@@ -397,6 +465,46 @@ static int32_t intersect_ramp(int32_t th3, int32_t th0, int32_t a0, int32_t a2)
     return th0 + pbio_int_math_mult_then_div(th3 - th0, a2, a2 - a0);
 }
 
+/**
+ * Makes a trajectory that moves at constant speed from the starting position
+ * to the end position within the given duration, and then stands still.
+ *
+ * This is used to interpolate between setpoints that are given at a lower
+ * rate than the control loop. The constant speed serves as feed-forward.
+ *
+ * @param [out] trj     An uninitialized trajectory to hold the result.
+ * @param [in]  c       The command to use. Only the start time, the start and
+ *                      end positions, and the duration are used.
+ * @returns             ::PBIO_ERROR_INVALID_ARG if the duration, angle or
+ *                      resulting speed is out of range, otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbio_trajectory_make_linear(pbio_trajectory_t *trj, const pbio_trajectory_command_t *c) {
+
+    int32_t t = TO_TRAJECTORY_TIME(c->duration);
+    if (t <= 0 || t >= TIME_MAX || !pbio_angle_diff_is_small(&c->position_end, &c->position_start)) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    int32_t th = pbio_angle_diff_mdeg(&c->position_end, &c->position_start);
+    if (pbio_int_math_abs(th) >= ANGLE_MAX) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    int32_t w = div_th_by_t(th, t);
+    if (pbio_int_math_abs(w) > SPEED_MAX) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // The whole maneuver is the constant speed phase, followed by standing
+    // still at the end position.
+    *trj = (pbio_trajectory_t) {0};
+    pbio_trajectory_set_start(&trj->start, c);
+    trj->t2 = trj->t3 = t;
+    trj->th2 = trj->th3 = th;
+    trj->w0 = trj->w1 = trj->wu = w;
+    return PBIO_SUCCESS;
+}
+
 /**
  * Computes a trajectory for a timed command assuming *positive* speed.
  *
@@ -671,6 +779,111 @@ static pbio_error_t pbio_trajectory_new_forward_angle_command(pbio_trajectory_t
     return PBIO_SUCCESS;
 }
 
+#if PBIO_CONFIG_TRAJECTORY_CACHE_SIZE
+
+/**
+ * A previously computed forward angle trajectory and the command parameters
+ * that produced it. Trajectories are relative to their starting point, so
+ * only the parameters that affect the relative result are stored.
+ */
+typedef struct {
+    /** Angle to travel in mdeg. */
+    int32_t distance;
+    /** Speed at the start of the maneuver. */
+    int32_t speed_start;
+    /** Target speed, already bound by the maximum speed. */
+    int32_t speed_target;
+    /** Acceleration magnitude. */
+    int32_t acceleration;
+    /** Deceleration magnitude. */
+    int32_t deceleration;
+    /** Whether the movement continues after the maneuver. */
+    bool continue_running;
+    /** The resulting trajectory. The starting point is not used. */
+    pbio_trajectory_t trj;
+} pbio_trajectory_cache_entry_t;
+
+/**
+ * Recently computed forward angle trajectories.
+ */
+static pbio_trajectory_cache_entry_t trajectory_cache[PBIO_CONFIG_TRAJECTORY_CACHE_SIZE];
+
+/**
+ * Number of valid entries in the trajectory cache.
+ */
+static uint8_t trajectory_cache_size;
+
+/**
+ * Index of the trajectory cache entry to replace next.
+ */
+static uint8_t trajectory_cache_next;
+
+/**
+ * Tests whether a cache entry was made from the same command parameters.
+ *
+ * @param [in]  entry     The cache entry.
+ * @param [in]  c         The forward command.
+ * @param [in]  distance  The angle to travel in mdeg.
+ * @returns               True if the entry can be used for this command.
+ */
+static bool pbio_trajectory_cache_entry_matches(const pbio_trajectory_cache_entry_t *entry, const pbio_trajectory_command_t *c, int32_t distance) {
+    return entry->distance == distance &&
+           entry->speed_start == c->speed_start &&
+           entry->speed_target == c->speed_target &&
+           entry->acceleration == c->acceleration &&
+           entry->deceleration == c->deceleration &&
+           entry->continue_running == c->continue_running;
+}
+
+/**
+ * Computes a trajectory for a forward angle command, reusing a recently
+ * computed trajectory for the same relative command if there is one.
+ *
+ * @param [out] trj     An uninitialized trajectory to hold the result.
+ * @param [in]  c       The command to use.
+ * @returns             Same as pbio_trajectory_new_forward_angle_command().
+ */
+static pbio_error_t pbio_trajectory_new_forward_angle_command_cached(pbio_trajectory_t *trj, const pbio_trajectory_command_t *c) {
+
+    int32_t distance = pbio_angle_diff_mdeg(&c->position_end, &c->position_start);
+
+    for (uint8_t i = 0; i < trajectory_cache_size; i++) {
+        pbio_trajectory_cache_entry_t *entry = &trajectory_cache[i];
+        if (pbio_trajectory_cache_entry_matches(entry, c, distance)) {
+            // Everything except the starting point is relative to it, so
+            // the same result applies at this time and position.
+            *trj = entry->trj;
+            pbio_trajectory_set_start(&trj->start, c);
+            return PBIO_SUCCESS;
+        }
+    }
+
+    pbio_error_t err = pbio_trajectory_new_forward_angle_command(trj, c);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    pbio_trajectory_cache_entry_t *entry = &trajectory_cache[trajectory_cache_next];
+    trajectory_cache_next = (trajectory_cache_next + 1) % PBIO_ARRAY_SIZE(trajectory_cache);
+    if (trajectory_cache_size < PBIO_ARRAY_SIZE(trajectory_cache)) {
+        trajectory_cache_size++;
+    }
+    entry->distance = distance;
+    entry->speed_start = c->speed_start;
+    entry->speed_target = c->speed_target;
+    entry->acceleration = c->acceleration;
+    entry->deceleration = c->deceleration;
+    entry->continue_running = c->continue_running;
+    entry->trj = *trj;
+    return PBIO_SUCCESS;
+}
+
+#else // PBIO_CONFIG_TRAJECTORY_CACHE_SIZE
+
+#define pbio_trajectory_new_forward_angle_command_cached pbio_trajectory_new_forward_angle_command
+
+#endif // PBIO_CONFIG_TRAJECTORY_CACHE_SIZE
+
 /**
  * Stretches a trajectory to end at the same time as @p leader.
  *
@@ -810,7 +1023,7 @@ pbio_error_t pbio_trajectory_new_angle_command(pbio_trajectory_t *trj, const pbi
     }
 
     // Calculate the trajectory, assumed to be forward.
-    pbio_error_t err = pbio_trajectory_new_forward_angle_command(trj, &c);
+    pbio_error_t err = pbio_trajectory_new_forward_angle_command_cached(trj, &c);
     if (err != PBIO_SUCCESS) {
         return err;
     }
@@ -920,7 +1133,7 @@ uint32_t pbio_trajectory_get_duration(const pbio_trajectory_t *trj) {
  * @param [in]  time_ref    The duration of time after the start of the trajectory in s*10^-4.
  * @param [out] ref         An uninitialized trajectory reference point to hold the result.
  */
-void pbio_trajectory_get_reference(pbio_trajectory_t *trj, uint32_t time_ref, pbio_trajectory_reference_t *ref) {
+PBIO_HOT void pbio_trajectory_get_reference(pbio_trajectory_t *trj, uint32_t time_ref, pbio_trajectory_reference_t *ref) {
 
     // Time within maneuver since start.
     int32_t time = TO_TRAJECTORY_TIME(time_ref - trj->start.time);
@@ -935,8 +1148,7 @@ void pbio_trajectory_get_reference(pbio_trajectory_t *trj, uint32_t time_ref, pb
         // If we are here, then we are still in the acceleration phase.
         // Includes conversion from microseconds to seconds, in two steps to
         // avoid overflows and round off errors
-        w = trj->w0 + mul_a_by_t(trj->a0, time);
-        th = mul_w_by_t(trj->w0, time) + mul_a_by_t2(trj->a0, time);
+        th = eval_ramp(trj->w0, trj->a0, time, &w);
         a = trj->a0;
     } else if (time - trj->t2 < 0) {
         // If we are here, then we are in the constant speed phase
@@ -945,8 +1157,7 @@ void pbio_trajectory_get_reference(pbio_trajectory_t *trj, uint32_t time_ref, pb
         a = 0;
     } else if (time - trj->t3 < 0) {
         // If we are here, then we are in the deceleration phase
-        w = trj->w1 + mul_a_by_t(trj->a2, time - trj->t2);
-        th = trj->th2 + mul_w_by_t(trj->w1, time - trj->t2) + mul_a_by_t2(trj->a2, time - trj->t2);
+        th = trj->th2 + eval_ramp(trj->w1, trj->a2, time - trj->t2, &w);
         a = trj->a2;
     } else {
         // If we are here, we are in the constant speed phase after the
@@ -91,3 +91,25 @@ bool pbio_oneshot(bool value, bool *state) {
 bool pbio_util_time_has_passed(uint32_t sample, uint32_t base) {
     return sample - base < UINT32_MAX / 2;
 }
+
+/**
+ * Updates a CRC-32 checksum with more data.
+ *
+ * This is the same CRC as used by zlib and Ethernet (reflected polynomial
+ * 0xEDB88320), so the result can be compared to Python's zlib.crc32().
+ *
+ * @param [in] crc            Checksum of the preceding data, or 0 to start.
+ * @param [in] data           The data.
+ * @param [in] size           Size of @p data in bytes.
+ * @return                    The updated checksum.
+ */
+uint32_t pbio_util_crc32(uint32_t crc, const uint8_t *data, uint32_t size) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
@@ -121,6 +121,19 @@ void pbsys_battery_poll(void) {
     #endif
 }
 
+/**
+ * Estimates how long the battery lasts at the present load, until the hub
+ * shuts down on low voltage.
+ *
+ * @param [out] time        The remaining runtime in s.
+ * @return                  See ::pbio_battery_get_remaining_runtime.
+ */
+pbio_error_t pbsys_battery_get_remaining_runtime(uint32_t *time) {
+    pbdrv_battery_type_t type;
+    bool is_liion = pbdrv_battery_get_type(&type) == PBIO_SUCCESS && type == PBDRV_BATTERY_TYPE_LIION;
+    return pbio_battery_get_remaining_runtime(is_liion ? LIION_CRITICAL_MV : BATTERY_CRITICAL_MV, time);
+}
+
 /**
  * Tests if the battery is "full".
  *
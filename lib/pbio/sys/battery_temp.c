@@ -100,19 +100,12 @@ float pbsys_battery_temp_update(float V_bat, float I_bat) {
 
     bat_temp.index++;
 
-    // Calculate R_1A as a function of V_bat (internal resistance at 1A continuous)
-    R_1A = 0.014071f * (V_bat * V_bat * V_bat * V_bat)
-        - 0.335324f * (V_bat * V_bat * V_bat)
-        + 2.933404f * (V_bat * V_bat)
-        - 11.243047f * V_bat
-        + 16.897461f;
+    // Calculate R_1A as a function of V_bat (internal resistance at 1A continuous).
+    // The polynomials are evaluated in Horner form to save multiplications.
+    R_1A = (((0.014071f * V_bat - 0.335324f) * V_bat + 2.933404f) * V_bat - 11.243047f) * V_bat + 16.897461f;
 
     // Calculate R_2A as a function of V_bat (internal resistance at 2A continuous)
-    R_2A = 0.014420f * (V_bat * V_bat * V_bat * V_bat)
-        - 0.316728f * (V_bat * V_bat * V_bat)
-        + 2.559347f * (V_bat * V_bat)
-        - 9.084076f * V_bat
-        + 12.794176f;
+    R_2A = (((0.014420f * V_bat - 0.316728f) * V_bat + 2.559347f) * V_bat - 9.084076f) * V_bat + 12.794176f;
 
     // Calculate the slope by linear interpolation between R_1A and R_2A
     slope_A = (R_1A - R_2A) / (I_1A - I_2A);
@@ -124,7 +117,7 @@ float pbsys_battery_temp_update(float V_bat, float I_bat) {
     R_bat_model = slope_A * bat_temp.I_bat_mean + intercept_b;
 
     // Calculate batteries' internal resistance: R_bat
-    if (V_bat > 7.5 && !bat_temp.has_passed_7v5_flag) {
+    if (V_bat > 7.5f && !bat_temp.has_passed_7v5_flag) {
         bat_temp.R_bat = R_bat_init; // 7.5 V not passed a first time
     } else {
         // Only update R_bat with positive outcomes: R_bat_model - R_bat_model_old
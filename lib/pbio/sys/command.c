@@ -11,9 +11,12 @@
 #include <pbsys/host.h>
 #include <pbsys/storage.h>
 
+#include "./echo.h"
 #include "./hmi.h"
+#include "./motion.h"
 #include "./storage.h"
 #include "./program_stop.h"
+#include "./telemetry.h"
 
 static pbsys_command_write_app_data_callback_t write_app_data_callback = NULL;
 
@@ -59,29 +62,79 @@ pbio_pybricks_error_t pbsys_command(const uint8_t *data, uint32_t size) {
                 pbsys_main_program_request_start(PBIO_PYBRICKS_USER_PROGRAM_ID_REPL, PBSYS_MAIN_PROGRAM_START_REQUEST_TYPE_REMOTE));
         #endif // PBSYS_CONFIG_FEATURE_BUILTIN_USER_PROGRAM_REPL
 
-        case PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META:
-            return pbio_pybricks_error_from_pbio_error(pbsys_storage_set_program_size(
-                pbio_get_uint32_le(&data[1])));
+        case PBIO_PYBRICKS_COMMAND_WRITE_USER_PROGRAM_META: {
+            if (size != 5 && size != 9) {
+                return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+            }
+            uint32_t program_size = pbio_get_uint32_le(&data[1]);
+            // Optionally verify the received program before completing it.
+            if (size == 9 && program_size) {
+                pbio_error_t err = pbsys_storage_check_program_data(program_size, pbio_get_uint32_le(&data[5]));
+                if (err != PBIO_SUCCESS) {
+                    return pbio_pybricks_error_from_pbio_error(err);
+                }
+            }
+            return pbio_pybricks_error_from_pbio_error(pbsys_storage_set_program_size(program_size));
+        }
 
         case PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM:
             return pbio_pybricks_error_from_pbio_error(pbsys_storage_set_program_data(
                 pbio_get_uint32_le(&data[1]), &data[5], size - 5));
 
+        #if PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+        case PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_WINDOWED:
+            if (size < 7) {
+                return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+            }
+            return pbio_pybricks_error_from_pbio_error(pbsys_storage_set_program_data_windowed(
+                pbio_get_uint16_le(&data[1]), pbio_get_uint32_le(&data[3]), &data[7], size - 7));
+        #endif // PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+
+        #if PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+        case PBIO_PYBRICKS_COMMAND_WRITE_USER_RAM_COMPRESSED:
+            if (size < 5) {
+                return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+            }
+            return pbio_pybricks_error_from_pbio_error(pbsys_storage_set_program_data_compressed(
+                pbio_get_uint32_le(&data[1]), &data[5], size - 5));
+        #endif // PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+
+        #if PBSYS_CONFIG_STORAGE_PROGRAM_PATCH
+        case PBIO_PYBRICKS_COMMAND_BEGIN_USER_PROGRAM_PATCH:
+            if (size != 9) {
+                return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+            }
+            return pbio_pybricks_error_from_pbio_error(pbsys_storage_begin_program_patch(
+                pbio_get_uint32_le(&data[1]), pbio_get_uint32_le(&data[5])));
+
+        case PBIO_PYBRICKS_COMMAND_COPY_USER_RAM:
+            if (size != 13) {
+                return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+            }
+            return pbio_pybricks_error_from_pbio_error(pbsys_storage_copy_program_data(
+                pbio_get_uint32_le(&data[1]), pbio_get_uint32_le(&data[5]), pbio_get_uint32_le(&data[9])));
+        #endif // PBSYS_CONFIG_STORAGE_PROGRAM_PATCH
+
         case PBIO_PYBRICKS_COMMAND_REBOOT_TO_UPDATE_MODE:
             pbdrv_reset(PBDRV_RESET_ACTION_RESET_IN_UPDATE_MODE);
             return PBIO_PYBRICKS_ERROR_OK;
 
         case PBIO_PYBRICKS_COMMAND_WRITE_STDIN:
+            if (pbsys_echo_get_flags() & PBIO_PYBRICKS_ECHO_FLAG_STDIN) {
+                return pbsys_echo_stdin(&data[1], size - 1);
+            }
             #if PBSYS_CONFIG_HOST
-            if (pbsys_host_stdin_get_free() < size - 1) {
+            if (pbsys_host_stdin_write(&data[1], size - 1) != PBIO_SUCCESS) {
                 return PBIO_PYBRICKS_ERROR_BUSY;
             }
-            pbsys_host_stdin_write(&data[1], size - 1);
             #endif
             // If no consumers are configured, goes to "/dev/null" without error
             return PBIO_PYBRICKS_ERROR_OK;
 
         case PBIO_PYBRICKS_COMMAND_WRITE_APP_DATA: {
+            if ((pbsys_echo_get_flags() & PBIO_PYBRICKS_ECHO_FLAG_APP_DATA) && size > 3) {
+                return pbsys_echo_app_data(&data[3], size - 3);
+            }
             if (!write_app_data_callback) {
                 // No errors when no consumer is configured. This avoids errors
                 // when data is sent after the program ends.
@@ -98,6 +151,16 @@ pbio_pybricks_error_t pbsys_command(const uint8_t *data, uint32_t size) {
             const uint8_t *data_to_write = &data[3];
             return pbio_pybricks_error_from_pbio_error(write_app_data_callback(offset, data_size, data_to_write));
         }
+        case PBIO_PYBRICKS_COMMAND_CONFIGURE_TELEMETRY:
+            if (size != 7) {
+                return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+            }
+            pbsys_telemetry_configure(pbio_get_uint16_le(&data[1]), pbio_get_uint32_le(&data[3]));
+            return PBIO_PYBRICKS_ERROR_OK;
+        case PBIO_PYBRICKS_COMMAND_WRITE_MOTION:
+            return pbsys_motion_command(&data[1], size - 1);
+        case PBIO_PYBRICKS_COMMAND_ECHO:
+            return pbsys_echo_command(&data[1], size - 1);
         default:
             return PBIO_PYBRICKS_ERROR_INVALID_COMMAND;
     }
@@ -16,10 +16,13 @@
 #include <pbsys/host.h>
 #include <pbsys/status.h>
 
+#include "echo.h"
 #include "hmi.h"
 #include "light.h"
 #include "storage.h"
+#include "storage_kv.h"
 #include "program_stop.h"
+#include "motion.h"
 #include "telemetry.h"
 
 static pbio_os_process_t pbsys_system_poll_process;
@@ -53,12 +56,15 @@ void pbsys_init(void) {
 
     // Makes user data and settings available to modules below, so must be done first.
     pbsys_storage_init();
+    pbsys_storage_kv_init();
 
     pbsys_battery_init();
     pbsys_hmi_init();
     pbsys_host_init();
     pbsys_status_light_init();
     pbsys_telemetry_init();
+    pbsys_motion_init();
+    pbsys_echo_init();
 
     pbio_os_process_start(&pbsys_system_poll_process, pbsys_system_poll_process_thread, NULL);
 
@@ -73,6 +79,7 @@ void pbsys_deinit(void) {
     pbsys_status_set(PBIO_PYBRICKS_STATUS_SHUTDOWN_REQUEST);
 
     pbsys_storage_deinit();
+    pbsys_storage_kv_deinit();
     pbsys_hmi_deinit();
 
     // Wait for all relevant pbsys processes to end.
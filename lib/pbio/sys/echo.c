@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Sends data from the host straight back, so the latency and throughput of
+// the connection can be measured without the user program in the way.
+
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_HOST_ECHO
+
+#include <string.h>
+
+#include <pbio/os.h>
+#include <pbio/protocol.h>
+
+#include <pbsys/host.h>
+
+#include "echo.h"
+
+/**
+ * Size of data that is waiting to be sent back, including two bytes for the
+ * event type and size of each packet.
+ */
+#define ECHO_BUF_SIZE (512)
+
+static uint8_t echo_buf[ECHO_BUF_SIZE];
+static uint32_t echo_size;
+static pbio_pybricks_echo_flags_t echo_flags;
+
+/**
+ * Queues data to be sent back as one event.
+ *
+ * @param [in]  event   The event type.
+ * @param [in]  data    The data.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              ::PBIO_PYBRICKS_ERROR_OK if queued or
+ *                      ::PBIO_PYBRICKS_ERROR_BUSY if it does not fit.
+ */
+static pbio_pybricks_error_t pbsys_echo_queue(pbio_pybricks_event_t event, const uint8_t *data, uint32_t size) {
+    if (size > UINT8_MAX || echo_size + 2 + size > ECHO_BUF_SIZE) {
+        return PBIO_PYBRICKS_ERROR_BUSY;
+    }
+    echo_buf[echo_size] = event;
+    echo_buf[echo_size + 1] = size;
+    memcpy(&echo_buf[echo_size + 2], data, size);
+    echo_size += 2 + size;
+    pbio_os_request_poll();
+    return PBIO_PYBRICKS_ERROR_OK;
+}
+
+/**
+ * Handles ::PBIO_PYBRICKS_COMMAND_ECHO.
+ *
+ * @param [in]  data    The flags and data, without the command byte.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              Error code.
+ */
+pbio_pybricks_error_t pbsys_echo_command(const uint8_t *data, uint32_t size) {
+    if (!size || data[0] & ~(PBIO_PYBRICKS_ECHO_FLAG_STDIN | PBIO_PYBRICKS_ECHO_FLAG_APP_DATA)) {
+        return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+    }
+    if (size > 1) {
+        pbio_pybricks_error_t err = pbsys_echo_queue(PBIO_PYBRICKS_EVENT_ECHO, &data[1], size - 1);
+        if (err != PBIO_PYBRICKS_ERROR_OK) {
+            return err;
+        }
+    }
+    echo_flags = data[0];
+    return PBIO_PYBRICKS_ERROR_OK;
+}
+
+/**
+ * Gets the flags set by the last echo command.
+ *
+ * @return              The flags.
+ */
+pbio_pybricks_echo_flags_t pbsys_echo_get_flags(void) {
+    return echo_flags;
+}
+
+/**
+ * Sends stdin from the host back as stdout.
+ *
+ * @param [in]  data    The data.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              ::PBIO_PYBRICKS_ERROR_OK if all of it was queued or
+ *                      ::PBIO_PYBRICKS_ERROR_BUSY if it did not fit.
+ */
+pbio_pybricks_error_t pbsys_echo_stdin(const uint8_t *data, uint32_t size) {
+    uint32_t written = size;
+    pbio_error_t err = pbsys_host_stdout_write(data, &written);
+    if (err == PBIO_SUCCESS && written == size) {
+        return PBIO_PYBRICKS_ERROR_OK;
+    }
+    return PBIO_PYBRICKS_ERROR_BUSY;
+}
+
+/**
+ * Sends app data from the host back as an app data event.
+ *
+ * @param [in]  data    The data, without the offset.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              ::PBIO_PYBRICKS_ERROR_OK if queued or
+ *                      ::PBIO_PYBRICKS_ERROR_BUSY if it does not fit.
+ */
+pbio_pybricks_error_t pbsys_echo_app_data(const uint8_t *data, uint32_t size) {
+    return pbsys_echo_queue(PBIO_PYBRICKS_EVENT_WRITE_APP_DATA, data, size);
+}
+
+/**
+ * Sends queued data back to the host, one event per packet.
+ */
+static pbio_error_t pbsys_echo_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_state_t sub;
+    static uint8_t buf[UINT8_MAX];
+    static uint8_t size;
+    static pbio_pybricks_event_t event;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, echo_size);
+
+        // Take the packet out so more can be queued while this one is sent.
+        event = echo_buf[0];
+        size = echo_buf[1];
+        memcpy(buf, &echo_buf[2], size);
+        memmove(echo_buf, &echo_buf[2 + size], echo_size - 2 - size);
+        echo_size -= 2 + size;
+
+        // Data is dropped if the host is gone.
+        PBIO_OS_AWAIT(state, &sub, pbsys_host_send_event(&sub, event, buf, size));
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Starts the process that sends data back to the host.
+ */
+void pbsys_echo_init(void) {
+    static pbio_os_process_t pbsys_echo_process;
+    pbio_os_process_start(&pbsys_echo_process, pbsys_echo_process_thread, NULL);
+}
+
+#endif // PBSYS_CONFIG_HOST_ECHO
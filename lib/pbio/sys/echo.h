@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#ifndef _PBSYS_SYS_ECHO_H_
+#define _PBSYS_SYS_ECHO_H_
+
+#include <stdint.h>
+
+#include <pbio/protocol.h>
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_HOST_ECHO
+
+void pbsys_echo_init(void);
+pbio_pybricks_error_t pbsys_echo_command(const uint8_t *data, uint32_t size);
+pbio_pybricks_echo_flags_t pbsys_echo_get_flags(void);
+pbio_pybricks_error_t pbsys_echo_stdin(const uint8_t *data, uint32_t size);
+pbio_pybricks_error_t pbsys_echo_app_data(const uint8_t *data, uint32_t size);
+
+#else
+
+static inline void pbsys_echo_init(void) {
+}
+
+static inline pbio_pybricks_error_t pbsys_echo_command(const uint8_t *data, uint32_t size) {
+    return PBIO_PYBRICKS_ERROR_INVALID_COMMAND;
+}
+
+static inline pbio_pybricks_echo_flags_t pbsys_echo_get_flags(void) {
+    return 0;
+}
+
+static inline pbio_pybricks_error_t pbsys_echo_stdin(const uint8_t *data, uint32_t size) {
+    return PBIO_PYBRICKS_ERROR_INVALID_COMMAND;
+}
+
+static inline pbio_pybricks_error_t pbsys_echo_app_data(const uint8_t *data, uint32_t size) {
+    return PBIO_PYBRICKS_ERROR_INVALID_COMMAND;
+}
+
+#endif // PBSYS_CONFIG_HOST_ECHO
+
+#endif // _PBSYS_SYS_ECHO_H_
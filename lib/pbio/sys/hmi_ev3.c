@@ -78,6 +78,10 @@ void pbsys_hmi_deinit(void) {
 
 static pbio_error_t run_ui(pbio_os_state_t *state, pbio_os_timer_t *timer) {
 
+    // Whether the UI was drawn before the programs were loaded, so it must be
+    // drawn again to show the program names.
+    static bool drawn_while_loading;
+
     PBIO_OS_ASYNC_BEGIN(state);
 
     pbsys_hmi_ev3_ui_initialize();
@@ -88,7 +92,10 @@ static pbio_error_t run_ui(pbio_os_state_t *state, pbio_os_timer_t *timer) {
 
         pbsys_hmi_host_update_indications();
 
+        // The user program may have left the display double buffered.
+        pbdrv_display_set_double_buffered(false);
         pbsys_hmi_ev3_ui_draw();
+        drawn_while_loading = pbsys_storage_program_data_is_loading();
 
         // Buttons could be pressed at the end of the user program, so wait for
         // a release and then a new press, or until we have to exit early.
@@ -117,8 +124,10 @@ static pbio_error_t run_ui(pbio_os_state_t *state, pbio_os_timer_t *timer) {
                 return PBIO_ERROR_TIMEDOUT;
             }
 
-            // Wait for button press, external program start, or connection change.
-            pbdrv_button_get_pressed() || pbsys_main_program_start_is_requested() || pbsys_hmi_handle_connection_change;
+            // Wait for button press, external program start, connection
+            // change, or programs finished loading.
+            pbdrv_button_get_pressed() || pbsys_main_program_start_is_requested() || pbsys_hmi_handle_connection_change ||
+            (drawn_while_loading && !pbsys_storage_program_data_is_loading());
         }));
 
         // On setting or closing a connection, start from a clean slate.
@@ -127,6 +136,11 @@ static pbio_error_t run_ui(pbio_os_state_t *state, pbio_os_timer_t *timer) {
             continue;
         }
 
+        // Redraw with the program names once they are loaded.
+        if (drawn_while_loading && !pbsys_storage_program_data_is_loading() && !pbdrv_button_get_pressed()) {
+            continue;
+        }
+
         // External progran request takes precedence over buttons.
         if (pbsys_main_program_start_is_requested()) {
             DEBUG_PRINT("Start program from Pybricks Code.\n");
@@ -134,7 +148,7 @@ static pbio_error_t run_ui(pbio_os_state_t *state, pbio_os_timer_t *timer) {
         }
 
         // Update UI state for buttons.
-        uint8_t payload;
+        static uint8_t payload;
         pbsys_hmi_ev3_ui_action_t action = pbsys_hmi_ev3_ui_handle_button(pbdrv_button_get_pressed(), &payload);
 
         if (action == PBSYS_HMI_EV3_UI_ACTION_SET_SLOT) {
@@ -147,6 +161,8 @@ static pbio_error_t run_ui(pbio_os_state_t *state, pbio_os_timer_t *timer) {
         }
 
         if (action == PBSYS_HMI_EV3_UI_ACTION_RUN_PROGRAM) {
+            // Loading is usually done by the time a program is selected.
+            PBIO_OS_AWAIT_WHILE(state, pbsys_storage_program_data_is_loading());
             pbio_error_t err = pbsys_main_program_request_start(payload, PBSYS_MAIN_PROGRAM_START_REQUEST_TYPE_HUB_UI);
             if (err != PBIO_SUCCESS) {
                 DEBUG_PRINT("Requested program not available.\n");
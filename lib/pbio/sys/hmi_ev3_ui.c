@@ -133,15 +133,18 @@ static uint8_t pbsys_hmi_ev3_ui_get_tab_num_entries(pbsys_hmi_ev3_ui_tab_t tab)
  * Gets the string representation of a program at a given slot.
  *
  * @param [in]  slot: Slot index.
- * @return      Name or emptry string if unavailable.
+ * @return      Name, empty string if unavailable, or "..." while loading.
  */
 static const char *pbsys_hmi_ev3_ui_get_program_name_at_slot(uint8_t slot) {
     // Revisit: Get program name from meta data at system level.
     pbsys_main_program_t program;
     program.id = slot;
-    pbsys_storage_get_program_data(&program);
-    pbio_error_t err = pbsys_main_program_validate(&program);
-    const char *result = err == PBIO_SUCCESS ? program.name : "";
+    const char *result = "...";
+    if (!pbsys_storage_program_data_is_loading()) {
+        pbsys_storage_get_program_data(&program);
+        pbio_error_t err = pbsys_main_program_validate(&program);
+        result = err == PBIO_SUCCESS ? program.name : "";
+    }
     static char name[20];
     snprintf(name, sizeof(name), "%c: %s", '1' + slot, result);
     return name;
@@ -372,81 +375,116 @@ static void pbsys_hmi_ev3_ui_draw_overlay(pbsys_hmi_ev3_ui_overlay_type_t overla
     }
 }
 
-void pbsys_hmi_ev3_ui_draw(void) {
-
-    // Start with empty screen.
-    pbio_image_t *display = pbdrv_display_get_image();
-    pbio_image_fill(display, WHITE);
+/**
+ * Pixels of the static parts of the menu, with 2 bits per pixel like the
+ * display.
+ */
+static uint8_t chrome_pixels[128][(178 + 3) / 4];
 
-    // Black box for selection highlight.
-    pbio_image_fill_rect(display, 6, 41 + state.selection[state.tab] * 20, 166, 14, BLACK);
+/**
+ * Draws the parts of the menu that only change with the active tab: the tab
+ * selectors, their icons, the box around the entries and the status bar.
+ *
+ * @param [in] image  Image to draw into.
+ * @param [in] tab    Active tab.
+ */
+static void pbsys_hmi_ev3_ui_draw_chrome(pbio_image_t *image, pbsys_hmi_ev3_ui_tab_t tab) {
 
-    // Draw entries with dotted underlines, inverting color for selection.
-    for (uint32_t s = 0; s < pbsys_hmi_ev3_ui_get_tab_num_entries(state.tab); s++) {
-        for (uint32_t i = 0; i < 56; i++) {
-            pbio_image_draw_pixel(display, 6 + 3 * i, 56 + s * 20, BLACK);
-        }
-        const char *text = pbsys_hmi_ev3_ui_get_tab_entry_text(state.tab, s);
-        uint8_t color = s == state.selection[state.tab] ? WHITE : BLACK;
-        pbio_image_draw_text(display, &pbio_font_liberationsans_regular_14, 8, 52 + s * 20, text, strlen(text), color);
-        pbio_image_fill_rect(display, 172, 41, 6, 20 * 4, WHITE);
-    }
+    // Start with empty screen.
+    pbio_image_fill(image, WHITE);
 
     // Draw box around tab entries.
-    pbio_image_draw_rect(display, 1, 38, 176, 89, BLACK);
-    pbio_image_draw_rounded_rect(display, 0, 37, 178, 91, 1, BLACK);
+    pbio_image_draw_rect(image, 1, 38, 176, 89, BLACK);
+    pbio_image_draw_rounded_rect(image, 0, 37, 178, 91, 1, BLACK);
 
     // Draw the tab selector rounded squares, using thick line for selected.
     for (uint8_t t = 0; t < 4; t++) {
         uint32_t tab_x = t * 42;
-        if (t == state.tab) {
-            pbio_image_draw_rounded_rect(display, tab_x + 9, 13, 34, 26, 2, BLACK);
-            pbio_image_draw_rect(display, tab_x + 10, 14, 32, 24, BLACK);
-            pbio_image_draw_pixel(display, tab_x + 11, 15, BLACK);
-            pbio_image_draw_pixel(display, tab_x + 40, 15, BLACK);
-            pbio_image_draw_hline(display, tab_x + 11, 37, 30, WHITE);
-            pbio_image_draw_hline(display, tab_x + 10, 38, 32, WHITE);
+        if (t == tab) {
+            pbio_image_draw_rounded_rect(image, tab_x + 9, 13, 34, 26, 2, BLACK);
+            pbio_image_draw_rect(image, tab_x + 10, 14, 32, 24, BLACK);
+            pbio_image_draw_pixel(image, tab_x + 11, 15, BLACK);
+            pbio_image_draw_pixel(image, tab_x + 40, 15, BLACK);
+            pbio_image_draw_hline(image, tab_x + 11, 37, 30, WHITE);
+            pbio_image_draw_hline(image, tab_x + 10, 38, 32, WHITE);
         } else {
-            pbio_image_draw_rounded_rect(display, tab_x + 10, 14, 32, 21, 2, BLACK);
+            pbio_image_draw_rounded_rect(image, tab_x + 10, 14, 32, 21, 2, BLACK);
         }
     }
 
     // Play icon.
-    pbio_image_draw_circle(display, 26, 24, 8, BLACK);
-    pbio_image_draw_vline(display, 23 + 1, 20, 9, BLACK);
-    pbio_image_draw_vline(display, 24 + 1, 21, 7, BLACK);
-    pbio_image_draw_vline(display, 25 + 1, 21, 7, BLACK);
-    pbio_image_draw_vline(display, 26 + 1, 22, 5, BLACK);
-    pbio_image_draw_vline(display, 27 + 1, 22, 5, BLACK);
-    pbio_image_draw_vline(display, 28 + 1, 23, 3, BLACK);
-    pbio_image_draw_hline(display, 29 + 1, 24, 2, BLACK);
+    pbio_image_draw_circle(image, 26, 24, 8, BLACK);
+    pbio_image_draw_vline(image, 23 + 1, 20, 9, BLACK);
+    pbio_image_draw_vline(image, 24 + 1, 21, 7, BLACK);
+    pbio_image_draw_vline(image, 25 + 1, 21, 7, BLACK);
+    pbio_image_draw_vline(image, 26 + 1, 22, 5, BLACK);
+    pbio_image_draw_vline(image, 27 + 1, 22, 5, BLACK);
+    pbio_image_draw_vline(image, 28 + 1, 23, 3, BLACK);
+    pbio_image_draw_hline(image, 29 + 1, 24, 2, BLACK);
 
     // Apps icon.
     uint8_t width = 8;
     uint8_t shift = width + 1;
     uint8_t x = 59;
     uint8_t y = 16;
-    pbio_image_draw_rounded_rect(display, x, y, width, width, 1, BLACK);
-    pbio_image_fill_rounded_rect(display, x + shift, y, width, width, 1, 1);
-    pbio_image_draw_rounded_rect(display, x + shift, y, width, width, 1, BLACK);
-    pbio_image_fill_rounded_rect(display, x, y + shift, width, width, 1, 1);
-    pbio_image_draw_rounded_rect(display, x, y + shift, width, width, 1, BLACK);
-    pbio_image_draw_rounded_rect(display, x + shift, y + shift, width, width, 1, BLACK);
+    pbio_image_draw_rounded_rect(image, x, y, width, width, 1, BLACK);
+    pbio_image_fill_rounded_rect(image, x + shift, y, width, width, 1, 1);
+    pbio_image_draw_rounded_rect(image, x + shift, y, width, width, 1, BLACK);
+    pbio_image_fill_rounded_rect(image, x, y + shift, width, width, 1, 1);
+    pbio_image_draw_rounded_rect(image, x, y + shift, width, width, 1, BLACK);
+    pbio_image_draw_rounded_rect(image, x + shift, y + shift, width, width, 1, BLACK);
 
     // Settings icon.
-    pbio_image_draw_image_transparent_from_monochrome(display, &pbio_image_media_wrench17, 101, 16, BLACK);
+    pbio_image_draw_image_transparent_from_monochrome(image, &pbio_image_media_wrench17, 101, 16, BLACK);
 
     // Draw upper status bar.
-    pbio_image_draw_hline(display, 0, 10, 178, BLACK);
+    pbio_image_draw_hline(image, 0, 10, 178, BLACK);
+
+    // Battery outline. The level is drawn with the dynamic content.
+    pbio_image_draw_rect(image, 160, 1, 15, 8, BLACK);
+    pbio_image_draw_vline(image, 174, 4, 2, WHITE);
+    pbio_image_draw_vline(image, 175, 3, 4, BLACK);
+}
+
+void pbsys_hmi_ev3_ui_draw(void) {
+
+    pbio_image_t *display = pbdrv_display_get_image();
+
+    // Start from the static parts, which are only drawn again when the tab
+    // changes. Most redraws only move the selection or update the status.
+    static pbio_image_t chrome;
+    static pbsys_hmi_ev3_ui_tab_t chrome_tab = PBSYS_HMI_EV3_UI_TAB_NUM;
+    if (chrome_tab != state.tab) {
+        pbio_image_init_format(&chrome, &chrome_pixels[0][0], 178, 128,
+            sizeof(chrome_pixels[0]), PBIO_IMAGE_FORMAT_2BPP);
+        pbsys_hmi_ev3_ui_draw_chrome(&chrome, state.tab);
+        chrome_tab = state.tab;
+    }
+    pbio_image_draw_image(display, &chrome, 0, 0);
+
+    // Entries are drawn in a viewport inside the box, which clips long names
+    // without touching the border.
+    pbio_image_t entries;
+    pbio_image_init_sub(&entries, display, 6, 39, 166, 87);
+
+    // Black box for selection highlight.
+    pbio_image_fill_rect(&entries, 0, 2 + state.selection[state.tab] * 20, 166, 14, BLACK);
+
+    // Draw entries with dotted underlines, inverting color for selection.
+    for (uint32_t s = 0; s < pbsys_hmi_ev3_ui_get_tab_num_entries(state.tab); s++) {
+        for (uint32_t i = 0; i < 56; i++) {
+            pbio_image_draw_pixel(&entries, 3 * i, 17 + s * 20, BLACK);
+        }
+        const char *text = pbsys_hmi_ev3_ui_get_tab_entry_text(state.tab, s);
+        uint8_t color = s == state.selection[state.tab] ? WHITE : BLACK;
+        pbio_image_draw_text(&entries, &pbio_font_liberationsans_regular_14, 2, 13 + s * 20, text, strlen(text), color);
+    }
 
     // Battery indicator: REVISIT: better percentage estimation at driver level.
     const int vmin = 5800;
     const int vmax = 8000;
     int voltage = pbio_int_math_bind(pbio_battery_get_average_voltage(), vmin, vmax);
     int bars = (voltage - vmin) * 11 / (vmax - vmin);
-    pbio_image_draw_rect(display, 160, 1, 15, 8, BLACK);
-    pbio_image_draw_vline(display, 174, 4, 2, WHITE);
-    pbio_image_draw_vline(display, 175, 3, 4, BLACK);
     pbio_image_fill_rect(display, 162, 3, bars, 4, BLACK);
 
     // USB if connected.
@@ -476,37 +514,63 @@ static uint32_t sr(uint32_t r) {
 }
 
 /**
- * Draws the Pybricks logo on the screen.
+ * Draws the Pybricks logo.
  *
+ * @param  image [in] Image to draw into.
  * @param  x     [in] Horizontal offset from the left.
  * @param  y     [in] Vertical offset from the top.
  * @param  width [in] Width (natural size is 154 x 84).
  */
-static void pbsys_hmi_ev3_ui_draw_pybricks_logo(uint32_t x, uint32_t y, uint32_t width, bool blink) {
+static void pbsys_hmi_ev3_ui_draw_pybricks_logo(pbio_image_t *image, uint32_t x, uint32_t y, uint32_t width, bool blink) {
     _offset_x = x;
     _offset_y = y;
     _scale_mul = width;
     _scale_div = 154;
 
-    pbio_image_t *display = pbdrv_display_get_image();
-
     // Rounded rectangles making up the left and right side of the head.
-    pbio_image_fill_rounded_rect(display, sx(0), sy(0), sr(42), sr(84), sr(11), BLACK);
-    pbio_image_fill_rounded_rect(display, sx(112), sy(0), sr(42), sr(84), sr(11), BLACK);
+    pbio_image_fill_rounded_rect(image, sx(0), sy(0), sr(42), sr(84), sr(11), BLACK);
+    pbio_image_fill_rounded_rect(image, sx(112), sy(0), sr(42), sr(84), sr(11), BLACK);
 
     // Forehead, main fill, and jaw.
-    pbio_image_fill_rect(display, sx(14), sy(0), sr(126), sr(14), BLACK);
-    pbio_image_fill_rect(display, sx(14), sy(14), sr(126), sr(56), 0);
-    pbio_image_fill_rect(display, sx(28), sy(56), sr(98), sr(14), BLACK);
+    pbio_image_fill_rect(image, sx(14), sy(0), sr(126), sr(14), BLACK);
+    pbio_image_fill_rect(image, sx(14), sy(14), sr(126), sr(56), 0);
+    pbio_image_fill_rect(image, sx(28), sy(56), sr(98), sr(14), BLACK);
 
     // Eyes.
-    pbio_image_fill_circle(display, sx(49), sy(29), sr(10), blink ? WHITE : BLACK);
-    pbio_image_fill_circle(display, sx(106), sy(29), sr(10), blink ? WHITE : BLACK);
+    pbio_image_fill_circle(image, sx(49), sy(29), sr(10), blink ? WHITE : BLACK);
+    pbio_image_fill_circle(image, sx(106), sy(29), sr(10), blink ? WHITE : BLACK);
 
     // Teeth.
     for (uint32_t i = 0; i < 6; i++) {
-        pbio_image_fill_rect(display, sx(40 + 14 * i), sy(51), sr(4), sr(5), BLACK);
+        pbio_image_fill_rect(image, sx(40 + 14 * i), sy(51), sr(4), sr(5), BLACK);
+    }
+}
+
+/**
+ * Pixels of the logo at natural size, with open and closed eyes.
+ */
+static uint8_t logo_pixels[2][84][(154 + 3) / 4];
+
+/**
+ * Draws the Pybricks logo at natural size on the screen.
+ *
+ * The logo is drawn only once for each blink state and then copied, so the
+ * animation does not evaluate the rounded shapes on every frame.
+ *
+ * @param  x     [in] Horizontal offset from the left.
+ * @param  y     [in] Vertical offset from the top.
+ * @param  blink [in] Whether to draw the logo with closed eyes.
+ */
+static void pbsys_hmi_ev3_ui_draw_pybricks_logo_cached(uint32_t x, uint32_t y, bool blink) {
+    static pbio_image_t logo[2];
+    pbio_image_t *image = &logo[blink];
+    if (!image->pixels) {
+        pbio_image_init_format(image, &logo_pixels[blink][0][0], 154, 84,
+            sizeof(logo_pixels[blink][0]), PBIO_IMAGE_FORMAT_2BPP);
+        pbio_image_fill(image, WHITE);
+        pbsys_hmi_ev3_ui_draw_pybricks_logo(image, 0, 0, 154, blink);
     }
+    pbio_image_draw_image(pbdrv_display_get_image(), image, x, y);
 }
 
 #define ANIMATION_REPEAT_MS (4000)
@@ -544,7 +608,7 @@ static uint32_t pbsys_hmi_ev3_ui_run_animation_next(pbio_light_animation_t *anim
 
     // Erase last logo and draw in updated state.
     pbio_image_fill_rect(pbdrv_display_get_image(), 0, 0, 178, 100, WHITE);
-    pbsys_hmi_ev3_ui_draw_pybricks_logo(12, y, 154, blink);
+    pbsys_hmi_ev3_ui_draw_pybricks_logo_cached(12, y, blink);
 
     // Render to screen.
     pbdrv_display_update();
@@ -632,14 +696,14 @@ pbio_error_t pbsys_hmi_ev3_ui_closing_credits(pbio_os_state_t *state, void *cont
     PBIO_OS_AWAIT_MS(state, &timer, 1500);
     PBIO_OS_AWAIT_WHILE(state, pbdrv_button_get_pressed() & PBIO_BUTTON_CENTER);
     pbio_image_fill(display, WHITE);
-    pbsys_hmi_ev3_ui_draw_pybricks_logo(12, 12, 154, false);
+    pbsys_hmi_ev3_ui_draw_pybricks_logo_cached(12, 12, false);
     pbsys_hmi_ev3_ui_draw_centered_text(&pbio_font_terminus_normal_16, "Thanks for your help!", 0, 114);
     pbdrv_display_update();
     PBIO_OS_AWAIT_MS(state, &timer, 500);
-    pbsys_hmi_ev3_ui_draw_pybricks_logo(12, 12, 154, true);
+    pbsys_hmi_ev3_ui_draw_pybricks_logo_cached(12, 12, true);
     pbdrv_display_update();
     PBIO_OS_AWAIT_MS(state, &timer, 400);
-    pbsys_hmi_ev3_ui_draw_pybricks_logo(12, 12, 154, false);
+    pbsys_hmi_ev3_ui_draw_pybricks_logo_cached(12, 12, false);
     pbdrv_display_update();
     PBIO_OS_AWAIT_MS(state, &timer, 600);
 
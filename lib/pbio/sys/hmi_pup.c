@@ -195,6 +195,11 @@ void pbsys_hmi_deinit(void) {
     pbio_os_process_start(&boot_animation_process, boot_animation_process_shutdown_thread, (void *)false);
 }
 
+/**
+ * Whether advertising was requested before the Bluetooth controller was ready.
+ */
+static bool advertising_deferred;
+
 /**
  * Convenience wrapper to start or stop advertising, set status, and await command.
  *
@@ -210,6 +215,15 @@ static pbio_error_t start_advertising(pbio_os_state_t *state, bool advertise) {
 
     PBIO_OS_ASYNC_BEGIN(state);
 
+    // The Bluetooth controller may still be initializing after boot. Don't
+    // wait for it, so that a program can be started right away. Advertising
+    // is started once the controller is ready.
+    advertising_deferred = advertise && !pbdrv_bluetooth_is_ready();
+    if (advertising_deferred) {
+        pbsys_status_clear(PBIO_PYBRICKS_STATUS_BLE_ADVERTISING);
+        return PBIO_SUCCESS;
+    }
+
     pbdrv_bluetooth_start_advertising(advertise);
     PBIO_OS_AWAIT(state, &unused, err = pbdrv_bluetooth_await_advertise_or_scan_command(&unused, NULL));
 
@@ -246,6 +260,11 @@ static pbio_error_t run_ui(pbio_os_state_t *state) {
     // during the async start advertising call.
     static bool should_advertise;
 
+    // Buttons pressed when the wait for input completed. The buttons are read
+    // once per wake up, since reading them means converting ADC values on
+    // some hubs.
+    static pbio_button_flags_t pressed;
+
     PBIO_OS_ASYNC_BEGIN(state);
 
     pbio_os_timer_set(&idle_timer, PBSYS_CONFIG_HMI_IDLE_TIMEOUT_MS);
@@ -294,13 +313,15 @@ static pbio_error_t run_ui(pbio_os_state_t *state) {
             }
 
             // Wait condition: button pressed, program start requested, or connection change.
-            pbdrv_button_get_pressed() || pbsys_main_program_start_is_requested() || pbsys_hmi_handle_connection_change;
+            (pressed = pbdrv_button_get_pressed()) || pbsys_main_program_start_is_requested() || pbsys_hmi_handle_connection_change ||
+            (advertising_deferred && pbdrv_bluetooth_is_ready());
         }));
 
         // On setting or closing a connection, start from a clean slate:
         // Begin advertising if Bluetooth enabled and there is no host
-        // connection, otherwise disable.
-        if (pbsys_hmi_handle_connection_change) {
+        // connection, otherwise disable. This also starts advertising that
+        // was deferred until the Bluetooth controller was ready.
+        if (pbsys_hmi_handle_connection_change || (advertising_deferred && pbdrv_bluetooth_is_ready())) {
             pbsys_hmi_handle_connection_change = false;
             should_advertise = pbsys_storage_settings_bluetooth_enabled_get() && !pbsys_host_is_connected();
             PBIO_OS_AWAIT(state, &sub, start_advertising(&sub, should_advertise));
@@ -315,7 +336,7 @@ static pbio_error_t run_ui(pbio_os_state_t *state) {
 
         #if PBSYS_CONFIG_HMI_PUP_BLUETOOTH_BUTTON
         // Handle Bluetooth button press.
-        if (pbdrv_button_get_pressed() & PBSYS_CONFIG_HMI_PUP_BLUETOOTH_BUTTON) {
+        if (pressed & PBSYS_CONFIG_HMI_PUP_BLUETOOTH_BUTTON) {
 
             should_advertise = false;
 
@@ -348,19 +369,19 @@ static pbio_error_t run_ui(pbio_os_state_t *state) {
 
         #if PBSYS_CONFIG_HMI_PUP_LEFT_RIGHT_ENABLE
         // On right, increment slot when possible, then start waiting on new inputs.
-        if (pbdrv_button_get_pressed() & PBIO_BUTTON_RIGHT) {
+        if (pressed & PBIO_BUTTON_RIGHT) {
             pbsys_status_increment_selected_slot(true);
             continue;
         }
         // On left, decrement slot when possible, then start waiting on new inputs.
-        if (pbdrv_button_get_pressed() & PBIO_BUTTON_LEFT) {
+        if (pressed & PBIO_BUTTON_LEFT) {
             pbsys_status_increment_selected_slot(false);
             continue;
         }
         #endif // PBSYS_CONFIG_HMI_PUP_LEFT_RIGHT_ENABLE
 
         // On center, attempt to start program.
-        if (pbdrv_button_get_pressed() & PBIO_BUTTON_CENTER) {
+        if (pressed & PBIO_BUTTON_CENTER) {
             pbio_error_t err = pbsys_main_program_request_start(pbsys_status_get_selected_slot(), PBSYS_MAIN_PROGRAM_START_REQUEST_TYPE_HUB_UI);
             if (err == PBIO_SUCCESS) {
                 DEBUG_PRINT("Start program with button\n");
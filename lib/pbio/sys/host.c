@@ -5,11 +5,15 @@
 
 #if PBSYS_CONFIG_HOST
 
+#include <string.h>
+
 #include <lwrb/lwrb.h>
 
 #include <pbdrv/bluetooth.h>
 #include <pbdrv/usb.h>
 
+#include <pbio/util.h>
+
 #include <pbsys/command.h>
 #include <pbsys/host.h>
 
@@ -20,12 +24,82 @@
 static pbsys_host_stdin_event_callback_t pbsys_host_stdin_event_callback;
 static lwrb_t pbsys_host_stdin_ring_buf;
 
+/**
+ * Stdin flow control state, counted since stdin was last flushed. This is
+ * reported to the host with ::PBIO_PYBRICKS_EVENT_WRITE_STDIN_ACK.
+ */
+static struct {
+    /** Number of bytes accepted into stdin. */
+    uint32_t received;
+    /** Number of bytes dropped because stdin was full. */
+    uint32_t dropped;
+    /** Number of bytes freed or dropped since the last acknowledgement. */
+    uint32_t unacknowledged;
+} pbsys_host_stdin_flow;
+
+/**
+ * Number of freed bytes after which stdin is acknowledged right away.
+ */
+#define PBSYS_HOST_STDIN_ACK_INTERVAL (PBSYS_CONFIG_HOST_STDIN_BUF_SIZE / 4)
+
+/**
+ * Time in ms to wait for more bytes to be freed before acknowledging fewer
+ * than ::PBSYS_HOST_STDIN_ACK_INTERVAL bytes.
+ */
+#define PBSYS_HOST_STDIN_ACK_DELAY (10)
+
+static pbio_error_t pbsys_host_stdin_ack_process_thread(pbio_os_state_t *state, void *context);
+
+#if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+
+/**
+ * Stdout buffer that is sent to the transports in the background.
+ */
+static struct {
+    /** Buffered data that is not yet queued on the transports. */
+    lwrb_t ring_buf;
+    /** Number of bytes dropped because the buffer was full. */
+    uint32_t dropped;
+    /** Whether to flush the transports once the buffer is empty. */
+    bool flush_requested;
+} pbsys_host_stdout;
+
+static pbio_os_process_t pbsys_host_stdout_process;
+
+static pbio_error_t pbsys_host_stdout_process_thread(pbio_os_state_t *state, void *context);
+
+#endif // PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+
+/**
+ * Handles commands received over Bluetooth. Stdout is configured for each
+ * connection, so that is handled here. Everything else is the same as USB.
+ */
+static pbio_pybricks_error_t pbsys_host_bluetooth_command(const uint8_t *data, uint32_t size) {
+    if (data[0] != PBIO_PYBRICKS_COMMAND_CONFIGURE_STDOUT) {
+        return pbsys_command(data, size);
+    }
+    if (size != 2 || data[1] & ~PBIO_PYBRICKS_STDOUT_FLAG_COMPRESSED) {
+        return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+    }
+    return pbio_pybricks_error_from_pbio_error(
+        pbdrv_bluetooth_tx_set_compression(data[1] & PBIO_PYBRICKS_STDOUT_FLAG_COMPRESSED));
+}
+
 void pbsys_host_init(void) {
     static uint8_t stdin_buf[PBSYS_CONFIG_HOST_STDIN_BUF_SIZE];
     lwrb_init(&pbsys_host_stdin_ring_buf, stdin_buf, PBIO_ARRAY_SIZE(stdin_buf));
 
-    pbdrv_bluetooth_set_receive_handler(pbsys_command);
+    pbdrv_bluetooth_set_receive_handler(pbsys_host_bluetooth_command);
     pbdrv_usb_set_receive_handler(pbsys_command);
+
+    static pbio_os_process_t pbsys_host_stdin_ack_process;
+    pbio_os_process_start(&pbsys_host_stdin_ack_process, pbsys_host_stdin_ack_process_thread, NULL);
+
+    #if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+    static uint8_t stdout_buf[PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE + 1];
+    lwrb_init(&pbsys_host_stdout.ring_buf, stdout_buf, PBIO_ARRAY_SIZE(stdout_buf));
+    pbio_os_process_start(&pbsys_host_stdout_process, pbsys_host_stdout_process_thread, NULL);
+    #endif
 }
 
 /**
@@ -65,24 +139,40 @@ uint32_t pbsys_host_stdin_get_free(void) {
 /**
  * Writes data to the stdin buffer.
  *
- * This does not currently return the number of bytes written, so first call
- * pbdrv_bluetooth_stdin_get_free() to ensure enough free space.
+ * Data is written only if all of it fits. Otherwise it is dropped and
+ * reported to the host, so that it can send it again.
  *
  * @param [in]  data    The data to write to the stdin buffer.
  * @param [in]  size    The size of @p data in bytes.
+ * @return              ::PBIO_SUCCESS if @p data was written or
+ *                      ::PBIO_ERROR_BUSY if it did not fit.
  */
-void pbsys_host_stdin_write(const uint8_t *data, uint32_t size) {
+pbio_error_t pbsys_host_stdin_write(const uint8_t *data, uint32_t size) {
+    if (lwrb_get_free(&pbsys_host_stdin_ring_buf) < size) {
+        pbsys_host_stdin_flow.dropped += size;
+        // Acknowledge right away so the host knows to send it again.
+        pbsys_host_stdin_flow.unacknowledged += PBSYS_HOST_STDIN_ACK_INTERVAL;
+        pbio_os_request_poll();
+        return PBIO_ERROR_BUSY;
+    }
+
+    pbsys_host_stdin_flow.received += size;
+
     if (pbsys_host_stdin_event_callback) {
         // If there is a callback hook, we have to process things one byte at
         // a time. This is needed, e.g. by Micropython to handle Ctrl-C.
         for (uint32_t i = 0; i < size; i++) {
             if (!pbsys_host_stdin_event_callback(data[i])) {
                 lwrb_write(&pbsys_host_stdin_ring_buf, &data[i], 1);
+            } else {
+                // Handled bytes never take up space, so they are freed now.
+                pbsys_host_stdin_flow.unacknowledged++;
             }
         }
     } else {
         lwrb_write(&pbsys_host_stdin_ring_buf, data, size);
     }
+    return PBIO_SUCCESS;
 }
 
 // Consumer APIs. User-facing code calls these to read data from stdin.
@@ -97,9 +187,16 @@ void pbsys_host_stdin_set_callback(pbsys_host_stdin_event_callback_t callback) {
 
 /**
  * Flushes data from the stdin buffer without reading it.
+ *
+ * This also restarts the flow control counters and acknowledges it, so the
+ * host can start sending again from scratch.
  */
 void pbsys_host_stdin_flush(void) {
     lwrb_reset(&pbsys_host_stdin_ring_buf);
+    pbsys_host_stdin_flow.received = 0;
+    pbsys_host_stdin_flow.dropped = 0;
+    pbsys_host_stdin_flow.unacknowledged = PBSYS_HOST_STDIN_ACK_INTERVAL;
+    pbio_os_request_poll();
 }
 
 /**
@@ -110,6 +207,31 @@ uint32_t pbsys_host_stdin_get_available(void) {
     return lwrb_get_full(&pbsys_host_stdin_ring_buf);
 }
 
+/**
+ * Gets the size of the first complete line in the host stdin buffer.
+ *
+ * If the buffer is full without a newline, the whole buffer counts as a line
+ * so that long lines can still be read in parts.
+ *
+ * @return              The number of bytes up to and including the first
+ *                      newline, or 0 if there is no complete line yet.
+ */
+uint32_t pbsys_host_stdin_get_line_size(void) {
+    uint32_t available = lwrb_get_full(&pbsys_host_stdin_ring_buf);
+    uint8_t chunk[32];
+
+    for (uint32_t offset = 0; offset < available;) {
+        uint32_t size = lwrb_peek(&pbsys_host_stdin_ring_buf, offset, chunk, sizeof(chunk));
+        uint8_t *newline = memchr(chunk, '\n', size);
+        if (newline) {
+            return offset + newline - chunk + 1;
+        }
+        offset += size;
+    }
+
+    return lwrb_get_free(&pbsys_host_stdin_ring_buf) ? 0 : available;
+}
+
 /**
  * Reads data from the stdin buffer.
  * @param data  [in]        A buffer to receive a copy of the data.
@@ -127,9 +249,39 @@ pbio_error_t pbsys_host_stdin_read(uint8_t *data, uint32_t *size) {
         return PBIO_ERROR_AGAIN;
     }
 
+    pbsys_host_stdin_flow.unacknowledged += *size;
+    pbio_os_request_poll();
+
     return PBIO_SUCCESS;
 }
 
+#if BLE_AND_USB
+
+/**
+ * Queues stdout data on one transport. Data that does not fit is dropped
+ * according to ::PBSYS_CONFIG_HOST_STDOUT_POLICY.
+ *
+ * @param data      [in]    The data to transmit.
+ * @param size      [in]    The size of the data to transmit.
+ * @param available [in]    Space available on this transport.
+ * @param tx        [in]    Function that queues data on this transport.
+ * @param discard   [in]    Function that discards the oldest queued data.
+ */
+static void pbsys_host_stdout_write_transport(const uint8_t *data, uint32_t size, uint32_t available,
+    pbio_error_t (*tx)(const uint8_t *data, uint32_t *size), void (*discard)(uint32_t size)) {
+
+    #if PBSYS_CONFIG_HOST_STDOUT_POLICY == PBSYS_CONFIG_HOST_STDOUT_POLICY_DROP_OLDEST
+    // Make room for the new data so that the most recent output is kept.
+    if (available != UINT32_MAX && size > available) {
+        discard(size - available);
+    }
+    #endif
+
+    (void)tx(data, &size);
+}
+
+#endif // BLE_AND_USB
+
 /**
  * Transmits data over any connected transport that is subscribed to Pybricks
  * protocol events.
@@ -145,7 +297,7 @@ pbio_error_t pbsys_host_stdin_read(uint8_t *data, uint32_t *size) {
  *                          ::PBIO_ERROR_AGAIN if no @p data could be queued,
  *                          ::PBIO_SUCCESS if at least some data was queued.
  */
-pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size) {
+static pbio_error_t pbsys_host_stdout_write_transports(const uint8_t *data, uint32_t *size) {
     #if BLE_ONLY
     return pbdrv_bluetooth_tx(data, size);
     #elif USB_ONLY
@@ -154,19 +306,33 @@ pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size) {
 
     uint32_t bt_avail = pbdrv_bluetooth_tx_available();
     uint32_t usb_avail = pbdrv_usb_stdout_tx_available();
-    uint32_t available = bt_avail < usb_avail ? bt_avail : usb_avail;
 
-    // If all tx_available() calls returned UINT32_MAX, then there is one listening.
-    if (available == UINT32_MAX) {
+    // If all tx_available() calls returned UINT32_MAX, then there is no one listening.
+    if (bt_avail == UINT32_MAX && usb_avail == UINT32_MAX) {
         return PBIO_ERROR_INVALID_OP;
     }
-    // If one or more tx_available() calls returned 0, then we need to wait.
+
+    #if PBSYS_CONFIG_HOST_STDOUT_POLICY == PBSYS_CONFIG_HOST_STDOUT_POLICY_BLOCK
+    // Limit size to smallest available space from all transports so that we
+    // don't do partial writes to one transport and not the other.
+    uint32_t available = bt_avail < usb_avail ? bt_avail : usb_avail;
+    #else
+    // Each transport drains its own buffer, so only wait for the one with the
+    // most space. Transports that are not listening don't count.
+    uint32_t available = 0;
+    if (bt_avail != UINT32_MAX) {
+        available = bt_avail;
+    }
+    if (usb_avail != UINT32_MAX && usb_avail > available) {
+        available = usb_avail;
+    }
+    #endif
+
+    // If no transport can take data, then we need to wait.
     if (available == 0) {
         return PBIO_ERROR_AGAIN;
     }
 
-    // Limit size to smallest available space from all transports so that we
-    // don't do partial writes to one transport and not the other.
     if (*size > available) {
         *size = available;
     }
@@ -175,8 +341,8 @@ pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size) {
     // functions should always succeed since we already checked tx_available().
     // And if both somehow got disconnected at the same time, it is not a big deal
     // if we return PBIO_SUCCESS without actually sending anything.
-    (void)pbdrv_bluetooth_tx(data, size);
-    (void)pbdrv_usb_stdout_tx(data, size);
+    pbsys_host_stdout_write_transport(data, *size, bt_avail, pbdrv_bluetooth_tx, pbdrv_bluetooth_tx_discard);
+    pbsys_host_stdout_write_transport(data, *size, usb_avail, pbdrv_usb_stdout_tx, pbdrv_usb_stdout_tx_discard);
 
     return PBIO_SUCCESS;
 
@@ -186,6 +352,170 @@ pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size) {
     #endif
 }
 
+#if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+
+/**
+ * Tests if any transport is subscribed to stdout.
+ *
+ * @return              @c true if stdout is sent somewhere, else @c false.
+ */
+static bool pbsys_host_stdout_is_listening(void) {
+    #if BLE_ONLY
+    return pbdrv_bluetooth_tx_available() != UINT32_MAX;
+    #elif USB_ONLY
+    return pbdrv_usb_stdout_tx_available() != UINT32_MAX;
+    #elif BLE_AND_USB
+    return pbdrv_bluetooth_tx_available() != UINT32_MAX || pbdrv_usb_stdout_tx_available() != UINT32_MAX;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * Sends the stdout buffer to the transports in the background.
+ */
+static pbio_error_t pbsys_host_stdout_process_thread(pbio_os_state_t *state, void *context) {
+
+    uint32_t size;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, lwrb_get_full(&pbsys_host_stdout.ring_buf));
+
+        size = lwrb_get_linear_block_read_length(&pbsys_host_stdout.ring_buf);
+        err = pbsys_host_stdout_write_transports(lwrb_get_linear_block_read_address(&pbsys_host_stdout.ring_buf), &size);
+
+        if (err == PBIO_ERROR_AGAIN) {
+            // Transports are full, try again once they have sent some data.
+            PBIO_OS_AWAIT_ONCE(state);
+            continue;
+        }
+
+        if (err == PBIO_SUCCESS) {
+            lwrb_skip(&pbsys_host_stdout.ring_buf, size);
+        } else {
+            // Nobody is listening anymore, so the output is lost.
+            lwrb_reset(&pbsys_host_stdout.ring_buf);
+        }
+
+        if (pbsys_host_stdout.flush_requested && !lwrb_get_full(&pbsys_host_stdout.ring_buf)) {
+            pbsys_host_stdout.flush_requested = false;
+            pbdrv_bluetooth_tx_flush();
+        }
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+#endif // PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+
+/**
+ * Gets the number of stdout bytes that were dropped because the stdout
+ * buffer was full.
+ *
+ * @return              The number of bytes dropped since boot.
+ */
+uint32_t pbsys_host_stdout_get_dropped(void) {
+    #if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+    return pbsys_host_stdout.dropped;
+    #else
+    return 0;
+    #endif
+}
+
+/**
+ * Transmits data over any connected transport that is subscribed to Pybricks
+ * protocol events.
+ *
+ * If ::PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE is set, the data is buffered and sent
+ * in the background. When the buffer is full, data is handled according to
+ * ::PBSYS_CONFIG_HOST_STDOUT_BUF_POLICY.
+ *
+ * This may perform partial writes. Callers should check the number of bytes
+ * actually written and call again with the remaining data until all data is
+ * written.
+ *
+ * @param data  [in]        The data to transmit.
+ * @param size  [inout]     The size of the data to transmit. Upon success, this
+ *                          contains the number of bytes actually processed.
+ * @return                  ::PBIO_ERROR_INVALID_OP if there is no active transport,
+ *                          ::PBIO_ERROR_AGAIN if no @p data could be queued,
+ *                          ::PBIO_SUCCESS if at least some data was queued.
+ */
+pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size) {
+    #if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+
+    if (!pbsys_host_stdout_is_listening()) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    uint32_t available = lwrb_get_free(&pbsys_host_stdout.ring_buf);
+
+    if (*size > available) {
+        #if PBSYS_CONFIG_HOST_STDOUT_BUF_POLICY == PBSYS_CONFIG_HOST_STDOUT_POLICY_BLOCK
+        // Wait for space, writing only what fits.
+        if (available == 0) {
+            return PBIO_ERROR_AGAIN;
+        }
+        *size = available;
+        #elif PBSYS_CONFIG_HOST_STDOUT_BUF_POLICY == PBSYS_CONFIG_HOST_STDOUT_POLICY_DROP
+        // Keep what fits and drop the rest of the new data.
+        pbsys_host_stdout.dropped += *size - available;
+        lwrb_write(&pbsys_host_stdout.ring_buf, data, available);
+        pbio_os_process_request_poll(&pbsys_host_stdout_process);
+        return PBIO_SUCCESS;
+        #else
+        // Drop the oldest buffered data to make room, and keep only the end
+        // of the new data if it is bigger than the whole buffer.
+        uint32_t capacity = PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE;
+        uint32_t keep = *size < capacity ? *size : capacity;
+        uint32_t discard = keep - available;
+        lwrb_skip(&pbsys_host_stdout.ring_buf, discard);
+        pbsys_host_stdout.dropped += discard + *size - keep;
+        lwrb_write(&pbsys_host_stdout.ring_buf, data + *size - keep, keep);
+        pbio_os_process_request_poll(&pbsys_host_stdout_process);
+        return PBIO_SUCCESS;
+        #endif
+    }
+
+    lwrb_write(&pbsys_host_stdout.ring_buf, data, *size);
+    pbio_os_process_request_poll(&pbsys_host_stdout_process);
+    return PBIO_SUCCESS;
+
+    #else
+    return pbsys_host_stdout_write_transports(data, size);
+    #endif
+}
+
+/**
+ * Requests that buffered stdout data is sent as soon as possible.
+ *
+ * Transports may briefly hold back stdout to send it in fewer, fuller
+ * packets. This skips that delay for data written so far.
+ */
+void pbsys_host_stdout_flush(void) {
+    #if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+    // Transports are flushed once the buffer has been handed to them.
+    if (lwrb_get_full(&pbsys_host_stdout.ring_buf)) {
+        pbsys_host_stdout.flush_requested = true;
+        pbio_os_process_request_poll(&pbsys_host_stdout_process);
+        return;
+    }
+    #endif
+    pbdrv_bluetooth_tx_flush();
+}
+
+/**
+ * Chooses whether stdout is sent at the end of each line without delay.
+ *
+ * @param line_buffered [in]    Whether to send at the end of each line.
+ */
+void pbsys_host_stdout_set_line_buffered(bool line_buffered) {
+    pbdrv_bluetooth_tx_set_line_buffered(line_buffered);
+}
+
 /**
  * Checks if all data has been transmitted.
  *
@@ -196,8 +526,12 @@ pbio_error_t pbsys_host_stdout_write(const uint8_t *data, uint32_t *size) {
  *                      listening, false if there is still data queued to be sent.
  */
 bool pbsys_host_tx_is_idle(void) {
-    // The USB part is a bit of a hack since it depends on the USB driver not
-    // buffering more than one packet at a time to actually be accurate.
+    #if PBSYS_CONFIG_HOST_STDOUT_BUF_SIZE
+    if (lwrb_get_full(&pbsys_host_stdout.ring_buf) && pbsys_host_stdout_is_listening()) {
+        return false;
+    }
+    #endif
+
     #if BLE_ONLY
     return pbdrv_bluetooth_tx_is_idle();
     #elif USB_ONLY
@@ -253,4 +587,36 @@ pbio_error_t pbsys_host_send_event(pbio_os_state_t *state, pbio_pybricks_event_t
     PBIO_OS_ASYNC_END(ble_err != PBIO_SUCCESS ? ble_err : usb_err);
 }
 
+/**
+ * Tells the host how much stdin it may send, once stdin has been read or
+ * data was dropped.
+ */
+static pbio_error_t pbsys_host_stdin_ack_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static pbio_os_state_t sub;
+    static uint8_t buf[10];
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, pbsys_host_stdin_flow.unacknowledged);
+
+        // Collect a few reads into one acknowledgement, but don't let the
+        // host wait long when the program reads only a little.
+        pbio_os_timer_set(&timer, PBSYS_HOST_STDIN_ACK_DELAY);
+        PBIO_OS_AWAIT_UNTIL(state, pbsys_host_stdin_flow.unacknowledged >= PBSYS_HOST_STDIN_ACK_INTERVAL || pbio_os_timer_is_expired(&timer));
+
+        pbsys_host_stdin_flow.unacknowledged = 0;
+        pbio_set_uint16_le(&buf[0], lwrb_get_free(&pbsys_host_stdin_ring_buf));
+        pbio_set_uint32_le(&buf[2], pbsys_host_stdin_flow.received);
+        pbio_set_uint32_le(&buf[6], pbsys_host_stdin_flow.dropped);
+
+        // Errors are ignored. If there is no host, nobody is waiting for it.
+        PBIO_OS_AWAIT(state, &sub, pbsys_host_send_event(&sub, PBIO_PYBRICKS_EVENT_WRITE_STDIN_ACK, buf, sizeof(buf)));
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 #endif // PBSYS_CONFIG_HOST
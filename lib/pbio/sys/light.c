@@ -151,6 +151,10 @@ typedef struct {
     pbsys_status_light_pattern_state_t pattern_overlay_state;
     /** Color light struct for PBIO light implementation. */
     pbio_color_light_t color_light;
+    /** The color that was last sent to the LED. */
+    pbio_color_hsv_t led_color;
+    /** Whether ::led_color is valid. */
+    bool led_color_valid;
 } pbsys_status_light_t;
 
 /** The system status light instance. */
@@ -167,6 +171,30 @@ static pbsys_status_light_pattern_state_t *warning_pattern_state = &pbsys_status
 #endif
 
 
+/**
+ * Sets the color of an LED, unless it already has that color.
+ *
+ * Status light patterns are polled, but the color only changes at the edges
+ * of the pattern, so most polls don't need to update the LED.
+ *
+ * @param [in]  led         The LED device.
+ * @param [in]  hsv         The new color.
+ * @param [in]  last        The color that was last sent to the LED.
+ * @param [in]  last_valid  Whether @p last is valid.
+ * @return                  The result of setting the color.
+ */
+static pbio_error_t pbsys_status_light_set_led_hsv(pbdrv_led_dev_t *led, const pbio_color_hsv_t *hsv, pbio_color_hsv_t *last, bool *last_valid) {
+    if (*last_valid && last->h == hsv->h && last->s == hsv->s && last->v == hsv->v) {
+        return PBIO_SUCCESS;
+    }
+    // If the LED could not be set, such as while drivers are still starting,
+    // try again next time.
+    pbio_error_t err = pbdrv_led_set_hsv(led, hsv);
+    *last = *hsv;
+    *last_valid = err == PBIO_SUCCESS;
+    return err;
+}
+
 static pbio_error_t pbsys_status_light_set_hsv(pbio_color_light_t *light, const pbio_color_hsv_t *hsv) {
     pbsys_status_light_t *instance = PBIO_CONTAINER_OF(light, pbsys_status_light_t, color_light);
     instance->user_color = *hsv;
@@ -176,7 +204,7 @@ static pbio_error_t pbsys_status_light_set_hsv(pbio_color_light_t *light, const
     }
 
     if (instance->allow_user_update) {
-        return pbdrv_led_set_hsv(instance->led, hsv);
+        return pbsys_status_light_set_led_hsv(instance->led, hsv, &instance->led_color, &instance->led_color_valid);
     }
 
     return PBIO_SUCCESS;
@@ -308,6 +336,8 @@ typedef enum {
 } pbsys_battery_light_state_t;
 
 static pbsys_status_light_pattern_state_t pbsys_battery_light_pattern_state;
+static pbio_color_hsv_t pbsys_battery_light_led_color;
+static bool pbsys_battery_light_led_color_valid;
 
 static const pbsys_status_light_indication_pattern_element_t *const
 pbsys_battery_light_patterns[] = {
@@ -357,11 +387,11 @@ static void pbsys_status_light_set_pattern_or_user_color(pbsys_status_light_t *i
         return;
     }
     if (instance->allow_user_update) {
-        pbdrv_led_set_hsv(instance->led, &instance->user_color);
+        pbsys_status_light_set_led_hsv(instance->led, &instance->user_color, &instance->led_color, &instance->led_color_valid);
     } else {
         pbio_color_hsv_t hsv;
         pbio_color_to_hsv(pattern_color, &hsv);
-        pbdrv_led_set_hsv(instance->led, &hsv);
+        pbsys_status_light_set_led_hsv(instance->led, &hsv, &instance->led_color, &instance->led_color_valid);
     }
 }
 
@@ -411,7 +441,7 @@ void pbsys_status_light_poll(void) {
     if (pbdrv_led_get_dev(1, &led) == PBIO_SUCCESS) {
         pbio_color_hsv_t hsv;
         pbio_color_to_hsv(new_battery_color, &hsv);
-        pbdrv_led_set_hsv(led, &hsv);
+        pbsys_status_light_set_led_hsv(led, &hsv, &pbsys_battery_light_led_color, &pbsys_battery_light_led_color_valid);
     }
 
     #endif // PBSYS_CONFIG_STATUS_LIGHT_BATTERY
@@ -9,6 +9,7 @@
 
 #include <pbdrv/core.h>
 #include <pbdrv/reset.h>
+#include <pbdrv/stack.h>
 #include <pbdrv/usb.h>
 #include <pbio/main.h>
 #include <pbio/os.h>
@@ -32,6 +33,22 @@ bool pbsys_main_program_start_is_requested() {
     return program.start_request_type != PBSYS_MAIN_PROGRAM_START_REQUEST_TYPE_NONE;
 }
 
+/**
+ * Discards application state kept in user RAM by the previous program, if any.
+ *
+ * This must be called before program data or user RAM is modified. The
+ * application will then start fresh without cleaning up the old state.
+ */
+void pbsys_main_program_discard_state(void) {
+    if (!program.keep_state) {
+        return;
+    }
+    program.keep_state = false;
+
+    // User RAM is no longer in use, so program data can be restored.
+    pbsys_storage_restore_program_data();
+}
+
 /**
  * Gets the type of start request for the main program.
  *
@@ -48,7 +65,8 @@ void pbsys_main_program_get_info(pbio_pybricks_user_program_id_t *id, pbsys_main
  *
  * @param [in]  type    Chooses to start a builtin user program or a user program.
  * @param [in]  id      Selects which builtin or user program will run.
- * @returns     ::PBIO_ERROR_BUSY if a user program is already running.
+ * @returns     ::PBIO_ERROR_BUSY if a user program is already running or the
+ *              programs are still being loaded from storage.
  *              ::PBIO_ERROR_NOT_SUPPORTED if the program is not available.
  *              Otherwise ::PBIO_SUCCESS.
  */
@@ -59,6 +77,11 @@ pbio_error_t pbsys_main_program_request_start(pbio_pybricks_user_program_id_t id
         return PBIO_ERROR_BUSY;
     }
 
+    // Programs may still be loading from storage after boot.
+    if (pbsys_storage_program_data_is_loading()) {
+        return PBIO_ERROR_BUSY;
+    }
+
     program.id = id;
 
     // Load applicable data for this slot.
@@ -79,9 +102,16 @@ pbio_error_t pbsys_main_program_request_start(pbio_pybricks_user_program_id_t id
  */
 void pbsys_main(void) {
 
+    // Mark the unused stack before anything else runs, so the peak use can
+    // be measured later.
+    pbdrv_stack_paint();
+
     pbdrv_init();
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_DRIVERS);
     pbio_init();
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_PBIO);
     pbsys_init();
+    pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_SYSTEM);
 
     // Keep loading and running user programs until shutdown is requested.
     for (;;) {
@@ -89,7 +119,9 @@ void pbsys_main(void) {
         // Drives all processes while waiting for user input. This completes
         // when a user program request is made using the buttons or by a
         // connected host. It is cancelled on shutdown request or idle timeout.
+        pbio_os_set_tickless_idle(true);
         pbio_error_t err = pbsys_hmi_await_program_selection();
+        pbio_os_set_tickless_idle(false);
         if (err != PBIO_SUCCESS) {
             // Shutdown requested or idle for a long time.
             break;
@@ -109,6 +141,7 @@ void pbsys_main(void) {
         pbsys_host_stdin_flush();
 
         // Run the main application.
+        pbio_main_boot_phase_done(PBIO_MAIN_BOOT_PHASE_PROGRAM);
         pbio_main_start_application_resources();
         pbsys_main_run_program(&program);
 
@@ -134,7 +167,14 @@ void pbsys_main(void) {
         }
 
         // Finalize application now that system resources are safely closed.
-        pbsys_main_run_program_cleanup();
+        pbsys_main_run_program_cleanup(&program);
+
+        // User RAM is no longer in use, so program data can be restored if
+        // it was executed in place. If the application keeps its state in
+        // user RAM, this is postponed until the state is discarded.
+        if (!program.keep_state) {
+            pbsys_storage_restore_program_data();
+        }
     }
 
     // Stop system processes and selected drivers in reverse order. This will
@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Motion commands from the host, applied directly to the motors and drive
+// bases of the running program without going through the user program.
+
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_HOST_MOTION
+
+#include <string.h>
+
+#include <pbio/control.h>
+#include <pbio/drivebase.h>
+#include <pbio/os.h>
+#include <pbio/port_interface.h>
+#include <pbio/protocol.h>
+#include <pbio/servo.h>
+#include <pbio/util.h>
+
+#include <pbsys/host.h>
+
+#include "motion.h"
+
+/**
+ * Maximum event payload size. This fits in one notification with the
+ * default BLE MTU.
+ */
+#define MOTION_EVENT_SIZE (19)
+
+/**
+ * Size of replies that are waiting to be sent.
+ */
+#define MOTION_REPLY_BUF_SIZE (64)
+
+static uint8_t reply_buf[MOTION_REPLY_BUF_SIZE];
+static uint32_t reply_size;
+
+/**
+ * Gets the size of the parameters of an action.
+ *
+ * @param [in]  action  The action.
+ * @return              Size in bytes, or -1 if the action is not supported.
+ */
+static int32_t get_param_size(pbio_pybricks_motion_action_t action) {
+    switch (action) {
+        #if PBIO_CONFIG_SERVO
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_STOP:
+            return 1;
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN:
+            return 4;
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN_TARGET:
+            return 9;
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_TRACK_TARGET:
+            return 4;
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_GET_STATE:
+            return 0;
+        #endif // PBIO_CONFIG_SERVO
+        #if PBIO_CONFIG_NUM_DRIVEBASES > 0
+        case PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP:
+            return 1;
+        case PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_DRIVE:
+            return 8;
+        case PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_GET_STATE:
+            return 0;
+        #endif // PBIO_CONFIG_NUM_DRIVEBASES > 0
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Gets the size of the reply to an action, including the action and index.
+ *
+ * @param [in]  action  The action.
+ * @return              Size in bytes, or 0 if there is no reply.
+ */
+static uint32_t get_reply_size(pbio_pybricks_motion_action_t action) {
+    switch (action) {
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_GET_STATE:
+            return 2 + 2 * 4;
+        case PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_GET_STATE:
+            return 2 + 4 * 4;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Checks that all actions are complete and valid, and that their replies fit.
+ *
+ * @param [in]  data    The actions.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              ::PBIO_PYBRICKS_ERROR_OK if all actions can be applied.
+ */
+static pbio_pybricks_error_t check_actions(const uint8_t *data, uint32_t size) {
+
+    uint32_t replies = 0;
+
+    for (uint32_t i = 0; i < size;) {
+        pbio_pybricks_motion_action_t action = data[i];
+        int32_t param_size = get_param_size(action);
+        if (param_size < 0 || i + 2 + param_size > size) {
+            return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+        }
+
+        uint8_t index = data[i + 1];
+        bool is_drivebase = action >= PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP;
+        if (index >= (is_drivebase ? PBIO_CONFIG_NUM_DRIVEBASES : PBIO_CONFIG_PORT_NUM_DEV)) {
+            return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+        }
+
+        // The completion type is always the last parameter.
+        if ((action == PBIO_PYBRICKS_MOTION_ACTION_SERVO_STOP ||
+             action == PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN_TARGET ||
+             action == PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP) &&
+            data[i + 1 + param_size] > PBIO_CONTROL_ON_COMPLETION_BRAKE_SMART) {
+            return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+        }
+
+        replies += get_reply_size(action);
+        i += 2 + param_size;
+    }
+
+    if (reply_size + replies > MOTION_REPLY_BUF_SIZE) {
+        return PBIO_PYBRICKS_ERROR_BUSY;
+    }
+    return PBIO_PYBRICKS_ERROR_OK;
+}
+
+#if PBIO_CONFIG_SERVO
+/**
+ * Applies an action to the servo on the given port.
+ *
+ * @param [in]  action  The action.
+ * @param [in]  index   The port index.
+ * @param [in]  params  The parameters of the action.
+ * @return              Error code.
+ */
+static pbio_error_t apply_servo_action(pbio_pybricks_motion_action_t action, uint8_t index, const uint8_t *params) {
+
+    lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    pbio_servo_t *srv;
+    pbio_error_t err = pbio_port_get_servo(pbio_port_by_index(index), &type_id, &srv);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    switch (action) {
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_STOP:
+            return pbio_servo_stop(srv, params[0]);
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN:
+            return pbio_servo_run_forever(srv, pbio_get_uint32_le(&params[0]));
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN_TARGET:
+            return pbio_servo_run_target(srv, pbio_get_uint32_le(&params[0]), pbio_get_uint32_le(&params[4]), params[8]);
+        case PBIO_PYBRICKS_MOTION_ACTION_SERVO_TRACK_TARGET:
+            return pbio_servo_track_target(srv, pbio_get_uint32_le(&params[0]));
+        default: {
+            int32_t angle, speed;
+            err = pbio_servo_get_state_user(srv, &angle, &speed);
+            if (err != PBIO_SUCCESS) {
+                return err;
+            }
+            uint8_t *reply = &reply_buf[reply_size];
+            reply[0] = action;
+            reply[1] = index;
+            pbio_set_uint32_le(&reply[2], angle);
+            pbio_set_uint32_le(&reply[6], speed);
+            reply_size += get_reply_size(action);
+            return PBIO_SUCCESS;
+        }
+    }
+}
+#endif // PBIO_CONFIG_SERVO
+
+#if PBIO_CONFIG_NUM_DRIVEBASES > 0
+/**
+ * Applies an action to the drive base with the given index.
+ *
+ * @param [in]  action  The action.
+ * @param [in]  index   The drive base index.
+ * @param [in]  params  The parameters of the action.
+ * @return              Error code.
+ */
+static pbio_error_t apply_drivebase_action(pbio_pybricks_motion_action_t action, uint8_t index, const uint8_t *params) {
+
+    pbio_drivebase_t *db = pbio_drivebase_by_index(index);
+
+    switch (action) {
+        case PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP:
+            return pbio_drivebase_stop(db, params[0]);
+        case PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_DRIVE:
+            return pbio_drivebase_drive_forever(db, pbio_get_uint32_le(&params[0]), pbio_get_uint32_le(&params[4]));
+        default: {
+            int32_t distance, drive_speed, angle, turn_rate;
+            if (!pbio_drivebase_update_loop_is_running(db)) {
+                return PBIO_ERROR_NO_DEV;
+            }
+            pbio_error_t err = pbio_drivebase_get_state_user(db, &distance, &drive_speed, &angle, &turn_rate);
+            if (err != PBIO_SUCCESS) {
+                return err;
+            }
+            uint8_t *reply = &reply_buf[reply_size];
+            reply[0] = action;
+            reply[1] = index;
+            pbio_set_uint32_le(&reply[2], distance);
+            pbio_set_uint32_le(&reply[6], drive_speed);
+            pbio_set_uint32_le(&reply[10], angle);
+            pbio_set_uint32_le(&reply[14], turn_rate);
+            reply_size += get_reply_size(action);
+            return PBIO_SUCCESS;
+        }
+    }
+}
+#endif // PBIO_CONFIG_NUM_DRIVEBASES > 0
+
+/**
+ * Applies the actions of a ::PBIO_PYBRICKS_COMMAND_WRITE_MOTION command.
+ *
+ * All actions are checked before any of them are applied, so a malformed
+ * command does not move anything. Then they are applied in order, all before
+ * the next control loop runs.
+ *
+ * @param [in]  data    The actions, without the command byte.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              Error code.
+ */
+pbio_pybricks_error_t pbsys_motion_command(const uint8_t *data, uint32_t size) {
+
+    if (!size) {
+        return PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED;
+    }
+
+    pbio_pybricks_error_t result = check_actions(data, size);
+    if (result != PBIO_PYBRICKS_ERROR_OK) {
+        return result;
+    }
+
+    for (uint32_t i = 0; i < size;) {
+        pbio_pybricks_motion_action_t action = data[i];
+        uint8_t index = data[i + 1];
+        const uint8_t *params = &data[i + 2];
+        i += 2 + get_param_size(action);
+
+        pbio_error_t err = PBIO_ERROR_NOT_SUPPORTED;
+        #if PBIO_CONFIG_SERVO
+        if (action < PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP) {
+            err = apply_servo_action(action, index, params);
+        }
+        #endif
+        #if PBIO_CONFIG_NUM_DRIVEBASES > 0
+        if (action >= PBIO_PYBRICKS_MOTION_ACTION_DRIVEBASE_STOP) {
+            err = apply_drivebase_action(action, index, params);
+        }
+        #endif
+        if (err != PBIO_SUCCESS) {
+            return pbio_pybricks_error_from_pbio_error(err);
+        }
+    }
+
+    if (reply_size) {
+        pbio_os_request_poll();
+    }
+    return PBIO_PYBRICKS_ERROR_OK;
+}
+
+/**
+ * Sends replies to motion commands to the host.
+ *
+ * Whole replies are taken from the reply buffer and combined into events as
+ * large as possible, so new replies can be added while an event is sent.
+ */
+static pbio_error_t pbsys_motion_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_state_t sub;
+    static uint8_t buf[MOTION_EVENT_SIZE];
+    static uint32_t size;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, reply_size);
+
+        size = 0;
+        while (size < reply_size && size + get_reply_size(reply_buf[size]) <= MOTION_EVENT_SIZE) {
+            size += get_reply_size(reply_buf[size]);
+        }
+        memcpy(buf, reply_buf, size);
+        memmove(reply_buf, &reply_buf[size], reply_size - size);
+        reply_size -= size;
+
+        // Replies are dropped if the host is gone.
+        PBIO_OS_AWAIT(state, &sub, pbsys_host_send_event(&sub, PBIO_PYBRICKS_EVENT_WRITE_MOTION_STATE, buf, size));
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Starts the process that sends replies to motion commands.
+ */
+void pbsys_motion_init(void) {
+    static pbio_os_process_t pbsys_motion_process;
+    pbio_os_process_start(&pbsys_motion_process, pbsys_motion_process_thread, NULL);
+}
+
+#endif // PBSYS_CONFIG_HOST_MOTION
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#ifndef _PBSYS_SYS_MOTION_H_
+#define _PBSYS_SYS_MOTION_H_
+
+#include <stdint.h>
+
+#include <pbio/protocol.h>
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_HOST_MOTION
+
+void pbsys_motion_init(void);
+pbio_pybricks_error_t pbsys_motion_command(const uint8_t *data, uint32_t size);
+
+#else
+
+static inline void pbsys_motion_init(void) {
+}
+
+static inline pbio_pybricks_error_t pbsys_motion_command(const uint8_t *data, uint32_t size) {
+    return PBIO_PYBRICKS_ERROR_INVALID_COMMAND;
+}
+
+#endif // PBSYS_CONFIG_HOST_MOTION
+
+#endif // _PBSYS_SYS_MOTION_H_
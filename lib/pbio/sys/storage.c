@@ -7,6 +7,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <pbio/os.h>
@@ -14,9 +15,12 @@
 #include <pbdrv/block_device.h>
 
 #include <pbio/busy_count.h>
+#include <pbio/lz4.h>
 #include <pbio/main.h>
 #include <pbio/protocol.h>
+#include <pbio/util.h>
 #include <pbio/version.h>
+#include <pbsys/host.h>
 #include <pbsys/main.h>
 #include <pbsys/storage.h>
 #include <pbsys/status.h>
@@ -31,6 +35,16 @@ static struct {
     uint8_t slot;
     /** Latest incoming message time. */
     pbio_os_timer_t timer;
+    #if PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+    /** Next expected sequence number of a windowed chunk. */
+    uint16_t sequence;
+    /** Number of chunks received since the last acknowledgement. */
+    uint8_t unacknowledged;
+    #endif
+    #if PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+    /** Decoder of compressed program data. */
+    pbio_lz4_decoder_t decoder;
+    #endif
 } download_state;
 
 /**
@@ -74,6 +88,25 @@ void pbsys_storage_poll(void) {
 static pbsys_storage_data_map_t *map;
 static bool data_map_write_on_shutdown = false;
 
+/**
+ * Range of bytes in the map that changed since boot. Only storage sectors
+ * that overlap this range have to be written on shutdown.
+ */
+static uint32_t data_map_dirty_start = UINT32_MAX;
+static uint32_t data_map_dirty_end = 0;
+
+#if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+/**
+ * Map of the stored data, as mapped by the block device driver. This is set
+ * only while the program data in RAM is identical to the stored program data,
+ * so that programs can be executed in place. Then the RAM copy of the program
+ * data can be used as application heap while a program runs.
+ *
+ * This is cleared as soon as the program data in RAM is changed.
+ */
+static const pbsys_storage_data_map_t *map_stored;
+#endif
+
 /**
  * Gets program size or the total size of the sequentially stored slots.
  *
@@ -87,6 +120,18 @@ static uint32_t pbsys_storage_get_used_program_data_size(void) {
     return size;
 }
 
+/**
+ * Tests if the program data is still being loaded from storage after boot.
+ *
+ * The settings are available right away, but programs can't be started,
+ * changed, or read until this returns false.
+ *
+ * @returns             True if still loading, false otherwise.
+ */
+bool pbsys_storage_program_data_is_loading(void) {
+    return pbdrv_block_device_is_loading();
+}
+
 /**
  * Gets the maximum size of all programs that can be downloaded to the hub.
  *
@@ -109,11 +154,32 @@ pbsys_storage_settings_t *pbsys_storage_settings_get_settings(void) {
     return &map->settings;
 }
 
+/**
+ * Marks part of the map as changed, so that it gets written if saving is
+ * requested. This does not request saving by itself.
+ *
+ * @param [in]  data    Start of the changed data in the map.
+ * @param [in]  size    Size of the changed data.
+ */
+static void pbsys_storage_mark_dirty(const void *data, uint32_t size) {
+    uint32_t start = (const uint8_t *)data - (const uint8_t *)map;
+    if (start < data_map_dirty_start) {
+        data_map_dirty_start = start;
+    }
+    if (start + size > data_map_dirty_end) {
+        data_map_dirty_end = start + size;
+    }
+}
+
 /**
  * Requests that storage (program, user data, settings) will be saved some
  * time before shutdown. Should be called by functions that change data.
+ *
+ * Settings may be changed anywhere, so this always marks the data before the
+ * program data as changed. Changes to the program data are marked separately.
  */
 void pbsys_storage_request_write(void) {
+    pbsys_storage_mark_dirty(map, sizeof(pbsys_storage_data_map_t));
     data_map_write_on_shutdown = true;
 }
 
@@ -136,6 +202,11 @@ void pbsys_storage_reset_storage(void) {
     // may be calling this while a program using this data is running.
     memset(map, 0, sizeof(pbsys_storage_data_map_t));
 
+    #if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+    // Stored program data is no longer in use.
+    map_stored = NULL;
+    #endif
+
     // Apply default settings.
     pbsys_storage_settings_set_defaults(&map->settings);
 
@@ -172,6 +243,8 @@ pbio_error_t pbsys_storage_set_user_data(uint32_t offset, const uint8_t *data, u
  * @param [in]  data    The data reference.
  * @param [in]  size    Data size.
  * @returns             ::PBIO_ERROR_INVALID_ARG if reading out of range.
+ *                      ::PBIO_ERROR_BUSY if reading programs that are still
+ *                      being loaded.
  *                      Otherwise, ::PBIO_SUCCESS.
  */
 pbio_error_t pbsys_storage_get_user_data(uint32_t offset, uint8_t **data, uint32_t size) {
@@ -180,11 +253,76 @@ pbio_error_t pbsys_storage_get_user_data(uint32_t offset, uint8_t **data, uint32
     if (offset + size > (map->program_data - map->user_data) + pbsys_storage_get_used_program_data_size()) {
         return PBIO_ERROR_INVALID_ARG;
     }
+
+    // Programs may not be loaded yet.
+    if (offset + size > (uint32_t)(map->program_data - map->user_data) && pbsys_storage_program_data_is_loading()) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    #if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+    // The program data in RAM may be in use as heap, so read it from storage.
+    if (map_stored && offset + size > (uint32_t)(map->program_data - map->user_data)) {
+        // Stored user data may be outdated, so don't read across.
+        if (offset < (uint32_t)(map->program_data - map->user_data)) {
+            return PBIO_ERROR_INVALID_ARG;
+        }
+        *data = (uint8_t *)map_stored->user_data + offset;
+        return PBIO_SUCCESS;
+    }
+    #endif
+
     *data = map->user_data + offset;
     return PBIO_SUCCESS;
 }
 
-static void pbsys_storage_prepare_receive(void) {
+/**
+ * Copies a chunk of user data, settings, or program into a given buffer.
+ *
+ * This can be used to read large stored data in chunks without having to
+ * allocate memory for all of it at once.
+ *
+ * @param [in]  offset  Offset from the base address.
+ * @param [in]  buffer  Buffer to copy the data into.
+ * @param [in]  size    Number of bytes to copy.
+ * @returns             ::PBIO_ERROR_INVALID_ARG if reading out of range.
+ *                      Otherwise, ::PBIO_SUCCESS.
+ */
+pbio_error_t pbsys_storage_read_user_data(uint32_t offset, uint8_t *buffer, uint32_t size) {
+    uint8_t *data;
+    pbio_error_t err = pbsys_storage_get_user_data(offset, &data, size);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    memcpy(buffer, data, size);
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Reverses the order of bytes in place.
+ *
+ * @param [in]  data    The data.
+ * @param [in]  size    Size of @p data.
+ */
+static void pbsys_storage_reverse(uint8_t *data, uint32_t size) {
+    for (uint32_t i = 0; i < size / 2; i++) {
+        uint8_t byte = data[i];
+        data[i] = data[size - 1 - i];
+        data[size - 1 - i] = byte;
+    }
+}
+
+/**
+ * Makes the incoming slot the last used slot and sets its size to zero.
+ *
+ * @param [in]  keep_data   Whether to keep the current program of the slot
+ *                          at the new location, so it can be patched.
+ */
+static void pbsys_storage_erase_incoming_slot(bool keep_data) {
+
+    #if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+    // Program data in RAM will differ from the stored data from here on.
+    map_stored = NULL;
+    #endif
 
     #if PBSYS_CONFIG_STORAGE_NUM_SLOTS == 1
     map->slot_info[download_state.slot].size = 0;
@@ -233,8 +371,18 @@ static void pbsys_storage_prepare_receive(void) {
         }
     }
 
-    // Now move those remaining programs backwards into the "freed" space.
-    memmove(map->program_data + destination, map->program_data + source, remaining_programs_size);
+    if (keep_data) {
+        // Swap the current program with the remaining programs by rotating
+        // them in place, so the current program ends up last.
+        uint8_t *start = map->program_data + destination;
+        pbsys_storage_reverse(start, gap_to_shift_left);
+        pbsys_storage_reverse(start + gap_to_shift_left, remaining_programs_size);
+        pbsys_storage_reverse(start, gap_to_shift_left + remaining_programs_size);
+    } else {
+        // Now move those remaining programs backwards into the "freed" space.
+        memmove(map->program_data + destination, map->program_data + source, remaining_programs_size);
+    }
+    pbsys_storage_mark_dirty(map->program_data + destination, remaining_programs_size);
 
     // The active slot is now at the end, and ready to receive programs.
     map->slot_info[download_state.slot].size = 0;
@@ -243,6 +391,35 @@ static void pbsys_storage_prepare_receive(void) {
     return;
 }
 
+/**
+ * Starts receiving a program in the incoming slot.
+ *
+ * @param [in]  keep_data   Whether to keep the current program of the slot
+ *                          in place, so it can be patched.
+ */
+static void pbsys_storage_prepare_receive(bool keep_data) {
+
+    // State kept in user RAM by the previous program will be overwritten.
+    pbsys_main_program_discard_state();
+
+    pbsys_storage_erase_incoming_slot(keep_data);
+
+    #if PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+    download_state.sequence = 0;
+    download_state.unacknowledged = 0;
+    #endif
+
+    #if PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+    pbio_lz4_decoder_init(&download_state.decoder,
+        map->program_data + map->slot_info[download_state.slot].offset,
+        pbsys_storage_get_maximum_program_size());
+    #endif
+
+    // Set busy status to disallow some operations while busy.
+    pbsys_status_set(PBIO_PYBRICKS_STATUS_FILE_IO_IN_PROGRESS);
+    pbio_os_timer_set(&download_state.timer, 1000);
+}
+
 /**
  * Writes the user program metadata.
  *
@@ -251,13 +428,14 @@ static void pbsys_storage_prepare_receive(void) {
  *
  * @param [in]  size    The size of the user program in bytes.
  *
- * @returns             ::PBIO_ERROR_BUSY if the user program is running.
+ * @returns             ::PBIO_ERROR_BUSY if the user program is running or
+ *                      the programs are still being loaded.
  *                      ::PBIO_ERROR_INVALID_ARG if the new program is too big.
  *                      Otherwise, ::PBIO_SUCCESS.
  */
 pbio_error_t pbsys_storage_set_program_size(uint32_t new_size) {
     // we can't allow this to be changed while a user program is running
-    if (pbsys_status_test(PBIO_PYBRICKS_STATUS_USER_PROGRAM_RUNNING)) {
+    if (pbsys_status_test(PBIO_PYBRICKS_STATUS_USER_PROGRAM_RUNNING) || pbsys_storage_program_data_is_loading()) {
         return PBIO_ERROR_BUSY;
     }
 
@@ -269,11 +447,7 @@ pbio_error_t pbsys_storage_set_program_size(uint32_t new_size) {
             return PBIO_ERROR_INVALID_OP;
         }
 
-        pbsys_storage_prepare_receive();
-
-        // Set busy status to disallow some operations while busy.
-        pbsys_status_set(PBIO_PYBRICKS_STATUS_FILE_IO_IN_PROGRESS);
-        pbio_os_timer_set(&download_state.timer, 1000);
+        pbsys_storage_prepare_receive(false);
         return PBIO_SUCCESS;
     }
 
@@ -288,6 +462,13 @@ pbio_error_t pbsys_storage_set_program_size(uint32_t new_size) {
         return PBIO_ERROR_FAILED;
     }
 
+    #if PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+    // If the program was compressed, all of it should have been decoded.
+    if (download_state.decoder.in_pos && download_state.decoder.out_pos != new_size) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    #endif
+
     // Word align the data.
     new_size = (new_size + 3) / 4 * 4;
 
@@ -295,6 +476,7 @@ pbio_error_t pbsys_storage_set_program_size(uint32_t new_size) {
     map->slot_info[download_state.slot].size = new_size;
 
     // Program download complete, so request saving on poweroff.
+    pbsys_storage_mark_dirty(map->program_data + map->slot_info[download_state.slot].offset, new_size);
     pbsys_storage_request_write();
 
     // Clear busy status.
@@ -340,6 +522,246 @@ pbio_error_t pbsys_storage_set_program_data(uint32_t offset, const void *data, u
     return PBIO_SUCCESS;
 }
 
+#if PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+
+/**
+ * Decodes compressed program data into user RAM, from the offset of the
+ * incoming slot.
+ *
+ * The data is a continuous stream in the LZ4 block format, which is decoded
+ * as it arrives. Chunks must be given in order, but chunks that were already
+ * received may be given again.
+ *
+ * @param [in]  offset      The offset in bytes from the start of the compressed stream.
+ * @param [in]  data        The compressed data.
+ * @param [in]  size        The size of @p data.
+ *
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if data is missing before
+ *                          @p offset, if the data is invalid, or if the
+ *                          decoded program does not fit.
+ *                          ::PBIO_ERROR_BUSY if the user program is running.
+ *                          ::PBIO_ERROR_INVALID_OP if no download is in progress.
+ *                          Otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbsys_storage_set_program_data_compressed(uint32_t offset, const uint8_t *data, uint32_t size) {
+
+    if (pbsys_status_test(PBIO_PYBRICKS_STATUS_USER_PROGRAM_RUNNING)) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    if (!pbsys_status_test(PBIO_PYBRICKS_STATUS_FILE_IO_IN_PROGRESS)) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    pbio_lz4_decoder_t *decoder = &download_state.decoder;
+
+    if (offset > decoder->in_pos) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    // Skip what was already decoded, such as when the host sends a chunk
+    // again because the response got lost.
+    uint32_t skip = decoder->in_pos - offset;
+    if (skip >= size) {
+        return PBIO_SUCCESS;
+    }
+
+    pbio_os_timer_reset(&download_state.timer);
+
+    return pbio_lz4_decode(decoder, data + skip, size - skip);
+}
+
+#endif // PBSYS_CONFIG_STORAGE_COMPRESSED_DOWNLOAD
+
+#if PBSYS_CONFIG_STORAGE_PROGRAM_PATCH
+
+/**
+ * Starts receiving a program as a patch to the program in the selected slot.
+ *
+ * This is like starting a download with ::pbsys_storage_set_program_size,
+ * except that the current program is kept in place as the starting point.
+ * It can then be changed with ::pbsys_storage_set_program_data and
+ * ::pbsys_storage_copy_program_data, and completed as usual.
+ *
+ * @param [in]  base_size   The size of the program the patch is based on.
+ * @param [in]  base_crc    The CRC-32 of the program the patch is based on.
+ *
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if the current program is
+ *                          not the one the patch is based on.
+ *                          ::PBIO_ERROR_BUSY if the user program is running
+ *                          or the programs are still being loaded.
+ *                          ::PBIO_ERROR_INVALID_OP if a download is already
+ *                          in progress. Otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbsys_storage_begin_program_patch(uint32_t base_size, uint32_t base_crc) {
+    if (pbsys_status_test(PBIO_PYBRICKS_STATUS_USER_PROGRAM_RUNNING) || pbsys_storage_program_data_is_loading()) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    if (pbsys_status_test(PBIO_PYBRICKS_STATUS_FILE_IO_IN_PROGRESS)) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    // Program data in RAM must be intact before we can check it.
+    pbsys_main_program_discard_state();
+
+    uint8_t slot = PBSYS_CONFIG_STORAGE_NUM_SLOTS == 1 ? 0 : pbsys_status_get_selected_slot();
+    const pbsys_storage_slot_info_t *info = &map->slot_info[slot];
+
+    // Stored sizes are word aligned, so the given size has to match that.
+    if (base_size == 0 || (base_size + 3) / 4 * 4 != info->size ||
+        pbio_util_crc32(0, map->program_data + info->offset, base_size) != base_crc) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbsys_storage_prepare_receive(true);
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Copies program data within the incoming slot, such as to move unchanged
+ * parts of the current program while patching it.
+ *
+ * The source and destination may overlap.
+ *
+ * @param [in]  destination The offset to copy to.
+ * @param [in]  source      The offset to copy from.
+ * @param [in]  size        The number of bytes to copy.
+ *
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if the source or
+ *                          destination is outside of the allocated user RAM.
+ *                          ::PBIO_ERROR_BUSY if the user program is running.
+ *                          ::PBIO_ERROR_INVALID_OP if no download is in progress.
+ *                          Otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbsys_storage_copy_program_data(uint32_t destination, uint32_t source, uint32_t size) {
+    uint32_t max_size = pbsys_storage_get_maximum_program_size();
+    if (size > max_size || destination > max_size - size || source > max_size - size) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (pbsys_status_test(PBIO_PYBRICKS_STATUS_USER_PROGRAM_RUNNING)) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    if (!pbsys_status_test(PBIO_PYBRICKS_STATUS_FILE_IO_IN_PROGRESS)) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    pbio_os_timer_reset(&download_state.timer);
+
+    uint8_t *data = map->program_data + map->slot_info[download_state.slot].offset;
+    memmove(data + destination, data + source, size);
+
+    return PBIO_SUCCESS;
+}
+
+#endif // PBSYS_CONFIG_STORAGE_PROGRAM_PATCH
+
+/**
+ * Checks the data received for the incoming slot against a checksum.
+ *
+ * @param [in]  size        The size of the program in bytes.
+ * @param [in]  crc         The expected CRC-32 of the program.
+ *
+ * @returns                 ::PBIO_ERROR_INVALID_ARG if @p size is too big.
+ *                          ::PBIO_ERROR_INVALID_OP if no download is in progress.
+ *                          ::PBIO_ERROR_IO if the data does not match.
+ *                          Otherwise ::PBIO_SUCCESS.
+ */
+pbio_error_t pbsys_storage_check_program_data(uint32_t size, uint32_t crc) {
+    if (size > pbsys_storage_get_maximum_program_size()) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (!pbsys_status_test(PBIO_PYBRICKS_STATUS_FILE_IO_IN_PROGRESS)) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    const uint8_t *data = map->program_data + map->slot_info[download_state.slot].offset;
+    if (pbio_util_crc32(0, data, size) != crc) {
+        return PBIO_ERROR_IO;
+    }
+
+    return PBIO_SUCCESS;
+}
+
+#if PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+
+/**
+ * Number of chunks after which received chunks are acknowledged right away.
+ * This should be well below the number of chunks the host has in flight.
+ */
+#define PBSYS_STORAGE_ACK_INTERVAL (4)
+
+/**
+ * Time in ms to wait for more chunks before acknowledging fewer than
+ * ::PBSYS_STORAGE_ACK_INTERVAL chunks, such as at the end of the program.
+ */
+#define PBSYS_STORAGE_ACK_DELAY (10)
+
+/**
+ * Writes a numbered chunk of program data to user RAM.
+ *
+ * Chunks must arrive in order. Any other chunk is ignored and triggers an
+ * acknowledgement of the last chunk received in order, so that the host can
+ * send the rest again.
+ *
+ * @param [in]  sequence    The sequence number of this chunk.
+ * @param [in]  offset      The offset in bytes from the base user RAM address.
+ * @param [in]  data        The data to write.
+ * @param [in]  size        The size of @p data.
+ *
+ * @returns                 Same as ::pbsys_storage_set_program_data.
+ */
+pbio_error_t pbsys_storage_set_program_data_windowed(uint16_t sequence, uint32_t offset, const void *data, uint32_t size) {
+
+    if (sequence != download_state.sequence) {
+        // Acknowledge right away to make the host go back.
+        download_state.unacknowledged = PBSYS_STORAGE_ACK_INTERVAL;
+        pbio_os_request_poll();
+        return PBIO_SUCCESS;
+    }
+
+    pbio_error_t err = pbsys_storage_set_program_data(offset, data, size);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    download_state.sequence++;
+    download_state.unacknowledged++;
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Sends cumulative acknowledgements of windowed program data chunks.
+ */
+static pbio_error_t pbsys_storage_ack_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static pbio_os_state_t sub;
+    static uint8_t buf[2];
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, download_state.unacknowledged);
+
+        // Collect a few chunks into one acknowledgement, but don't let the
+        // host wait for the final chunks of the program.
+        pbio_os_timer_set(&timer, PBSYS_STORAGE_ACK_DELAY);
+        PBIO_OS_AWAIT_UNTIL(state, download_state.unacknowledged >= PBSYS_STORAGE_ACK_INTERVAL || pbio_os_timer_is_expired(&timer));
+
+        download_state.unacknowledged = 0;
+        pbio_set_uint16_le(buf, download_state.sequence);
+        PBIO_OS_AWAIT(state, &sub, pbsys_host_send_event(&sub, PBIO_PYBRICKS_EVENT_WRITE_USER_RAM_ACK, buf, sizeof(buf)));
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+#endif // PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
 
 /**
  * Populates the program data with references to the loaded program data.
@@ -347,10 +769,24 @@ pbio_error_t pbsys_storage_set_program_data(uint32_t offset, const void *data, u
  * @param [in]  offset      The program data structure.
  */
 void pbsys_storage_get_program_data(pbsys_main_program_t *program) {
+
+    // Program data is normally used from RAM, followed by user RAM.
+    const uint8_t *program_data = map->program_data;
+    uint32_t program_data_ram_size = pbsys_storage_get_used_program_data_size();
+
+    #if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+    // If the program data is unchanged since boot, it can be executed in
+    // place. Then the RAM copy of all slots is available as user RAM too.
+    if (map_stored) {
+        program_data = map_stored->program_data;
+        program_data_ram_size = 0;
+    }
+    #endif
+
     // Only requested slot is available to user.
     if (program->id < PBSYS_CONFIG_STORAGE_NUM_SLOTS) {
-        program->code_start = map->program_data + map->slot_info[program->id].offset;
-        program->code_end = map->program_data + map->slot_info[program->id].offset + map->slot_info[program->id].size;
+        program->code_start = (void *)program_data + map->slot_info[program->id].offset;
+        program->code_end = (void *)program_data + map->slot_info[program->id].offset + map->slot_info[program->id].size;
     } else {
         // Builtin programs have no stored associated with them.
         program->code_start = NULL;
@@ -358,10 +794,24 @@ void pbsys_storage_get_program_data(pbsys_main_program_t *program) {
     }
 
     // User ram starts after the last slot, even if a non-slot program is run.
-    program->user_ram_start = map->program_data + pbsys_storage_get_used_program_data_size();
+    program->user_ram_start = map->program_data + program_data_ram_size;
     program->user_ram_end = ((void *)map) + PBDRV_CONFIG_BLOCK_DEVICE_RAM_SIZE;
 }
 
+/**
+ * Restores the program data in RAM after it was used as user RAM by a program
+ * that was executed in place. This must be called when the user application
+ * is completely done with user RAM, so that the program data can be saved on
+ * shutdown or run again.
+ */
+void pbsys_storage_restore_program_data(void) {
+    #if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+    if (map_stored) {
+        memcpy(map->program_data, map_stored->program_data, pbsys_storage_get_used_program_data_size());
+    }
+    #endif
+}
+
 /**
  * This process saves data on shutdown.
  */
@@ -377,8 +827,8 @@ static pbio_error_t pbsys_storage_deinit_process_thread(pbio_os_state_t *state,
 
     write_size = sizeof(pbsys_storage_data_map_t) + pbsys_storage_get_used_program_data_size();
 
-    // Write the data.
-    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_write_all(&sub, write_size));
+    // Write the data. Sectors with unchanged data may be skipped.
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_write_all(&sub, write_size, data_map_dirty_start, data_map_dirty_end));
 
     // Deinitialization done.
     pbio_busy_count_down();
@@ -398,9 +848,21 @@ void pbsys_storage_init(void) {
     if (err != PBIO_SUCCESS || strncmp(map->stored_firmware_hash, pbsys_main_get_application_version_hash(), sizeof(map->stored_firmware_hash))) {
         pbsys_storage_reset_storage();
     }
+    #if PBSYS_CONFIG_STORAGE_EXECUTE_IN_PLACE
+    // Otherwise, the stored program data can be used in place if the block
+    // device is memory mapped.
+    else if (pbdrv_block_device_get_mapped_data(&map_stored) != PBIO_SUCCESS) {
+        map_stored = NULL;
+    }
+    #endif
 
     // Apply loaded settings as necesary.
     pbsys_storage_settings_apply_loaded_settings(&map->settings);
+
+    #if PBSYS_CONFIG_STORAGE_WINDOWED_DOWNLOAD
+    static pbio_os_process_t pbsys_storage_ack_process;
+    pbio_os_process_start(&pbsys_storage_ack_process, pbsys_storage_ack_process_thread, NULL);
+    #endif
 }
 
 static pbio_os_process_t pbsys_storage_deinit_process;
@@ -415,6 +877,10 @@ void pbsys_storage_deinit(void) {
         return;
     }
 
+    // Program data in RAM may have been in use if the program was interrupted
+    // by shutdown before the normal cleanup.
+    pbsys_storage_restore_program_data();
+
     pbio_busy_count_up();
     pbio_os_process_start(&pbsys_storage_deinit_process, pbsys_storage_deinit_process_thread, NULL);
 }
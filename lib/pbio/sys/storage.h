@@ -4,6 +4,7 @@
 #ifndef _PBSYS_SYS_STORAGE_H_
 #define _PBSYS_SYS_STORAGE_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbio/error.h>
@@ -18,7 +19,14 @@ void pbsys_storage_deinit(void);
 void pbsys_storage_poll(void);
 pbio_error_t pbsys_storage_set_program_size(uint32_t size);
 pbio_error_t pbsys_storage_set_program_data(uint32_t offset, const void *data, uint32_t size);
+pbio_error_t pbsys_storage_set_program_data_windowed(uint16_t sequence, uint32_t offset, const void *data, uint32_t size);
+pbio_error_t pbsys_storage_set_program_data_compressed(uint32_t offset, const uint8_t *data, uint32_t size);
+pbio_error_t pbsys_storage_begin_program_patch(uint32_t base_size, uint32_t base_crc);
+pbio_error_t pbsys_storage_copy_program_data(uint32_t destination, uint32_t source, uint32_t size);
+pbio_error_t pbsys_storage_check_program_data(uint32_t size, uint32_t crc);
 void pbsys_storage_get_program_data(pbsys_main_program_t *program);
+void pbsys_storage_restore_program_data(void);
+bool pbsys_storage_program_data_is_loading(void);
 pbsys_storage_settings_t *pbsys_storage_settings_get_settings(void);
 
 #else
@@ -37,6 +45,21 @@ static inline pbio_error_t pbsys_storage_set_program_size(uint32_t size) {
 static inline pbio_error_t pbsys_storage_set_program_data(uint32_t offset, const void *data, uint32_t size) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
+static inline pbio_error_t pbsys_storage_set_program_data_windowed(uint16_t sequence, uint32_t offset, const void *data, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+static inline pbio_error_t pbsys_storage_set_program_data_compressed(uint32_t offset, const uint8_t *data, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+static inline pbio_error_t pbsys_storage_begin_program_patch(uint32_t base_size, uint32_t base_crc) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+static inline pbio_error_t pbsys_storage_copy_program_data(uint32_t destination, uint32_t source, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+static inline pbio_error_t pbsys_storage_check_program_data(uint32_t size, uint32_t crc) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
 static inline void pbsys_storage_get_program_data(pbsys_main_program_t *program) {
     program->code_start = NULL;
     program->code_end = NULL;
@@ -48,6 +71,11 @@ static inline void pbsys_storage_get_program_data(pbsys_main_program_t *program)
     program->user_ram_start = &pbsys_storage_heap_start;
     program->user_ram_end = &pbsys_storage_heap_end;
 }
+static inline void pbsys_storage_restore_program_data(void) {
+}
+static inline bool pbsys_storage_program_data_is_loading(void) {
+    return false;
+}
 
 #endif // PBSYS_CONFIG_STORAGE
 
@@ -0,0 +1,653 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Journaled key-value store.
+//
+// Changes are appended as small records to a log in the journal area of the
+// block device, so saving a value does not rewrite anything else. The log is
+// a ring of erase sectors. When the newest sector is full, the next one is
+// erased and used instead. The sector after that is then the oldest, so the
+// values that are only stored there are written again before it is erased
+// in turn. This spreads the wear over all sectors.
+//
+// Each record has a checksum. A record that was cut short by a power loss is
+// ignored on the next boot, along with anything after it in that sector. All
+// previously saved values are kept.
+
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_STORAGE_KV
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pbdrv/block_device_journal.h>
+
+#include <pbio/busy_count.h>
+#include <pbio/error.h>
+#include <pbio/os.h>
+#include <pbio/util.h>
+#include <pbsys/storage_kv.h>
+
+#include "storage_kv.h"
+
+#if PBSYS_CONFIG_STORAGE_KV_KEY_SIZE >= UINT8_MAX || PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE >= UINT8_MAX
+#error "Key and value size must fit in one byte."
+#endif
+
+/**
+ * Marks the start of a sector in use, spelling "PBKV".
+ */
+#define PBSYS_STORAGE_KV_MAGIC (0x564B4250)
+
+/**
+ * Record flag indicating that the key was deleted.
+ */
+#define PBSYS_STORAGE_KV_FLAG_DELETED (0x01)
+
+/**
+ * Sector index of values that are not stored yet.
+ */
+#define PBSYS_STORAGE_KV_SECTOR_NONE (UINT8_MAX)
+
+/**
+ * Maximum number of sectors in the journal.
+ */
+#define PBSYS_STORAGE_KV_MAX_SECTORS (32)
+
+/**
+ * Written at the start of each sector when it is taken into use.
+ */
+typedef struct {
+    /** Always ::PBSYS_STORAGE_KV_MAGIC. */
+    uint32_t magic;
+    /** Incremented for each new sector, so the newest one is last. */
+    uint32_t sequence;
+    /** Inverted sequence, to detect a partially written header. */
+    uint32_t sequence_inverted;
+} pbsys_storage_kv_sector_header_t;
+
+/**
+ * Start of each record. It is followed by the key and the value, padded to
+ * a multiple of 4 bytes, and a CRC-32 of everything before it.
+ */
+typedef struct {
+    /** Size of the key, or 0xFF if this is erased space. */
+    uint8_t key_size;
+    /** Size of the value. */
+    uint8_t value_size;
+    /** Record flags. */
+    uint8_t flags;
+    /** Reserved, always 0. */
+    uint8_t reserved;
+} pbsys_storage_kv_record_header_t;
+
+#define PBSYS_STORAGE_KV_RECORD_SIZE(key_size, value_size) \
+    (sizeof(pbsys_storage_kv_record_header_t) + (((key_size) + (value_size) + 3) & ~3) + sizeof(uint32_t))
+
+#define PBSYS_STORAGE_KV_RECORD_SIZE_MAX \
+    PBSYS_STORAGE_KV_RECORD_SIZE(PBSYS_CONFIG_STORAGE_KV_KEY_SIZE, PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE)
+
+/**
+ * A key-value pair kept in RAM.
+ */
+typedef struct {
+    /** Whether this entry is in use. */
+    bool used;
+    /** Whether this entry still needs to be written. */
+    bool pending;
+    /** Whether the key was deleted. Freed when this is written. */
+    bool deleted;
+    /** Sector of the most recent record of this key. */
+    uint8_t sector;
+    /** Size of the key. */
+    uint8_t key_size;
+    /** Size of the value. */
+    uint8_t value_size;
+    /** The key. */
+    char key[PBSYS_CONFIG_STORAGE_KV_KEY_SIZE];
+    /** The value. */
+    uint8_t value[PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE];
+} pbsys_storage_kv_entry_t;
+
+static struct {
+    /** All keys and values. */
+    pbsys_storage_kv_entry_t entries[PBSYS_CONFIG_STORAGE_KV_NUM_KEYS];
+    /** ::PBIO_ERROR_AGAIN while loading, then the result of the last operation. */
+    pbio_error_t err;
+    /** Whether to stop after the pending values are written. */
+    bool shutdown;
+    /** Number of sectors in the journal. */
+    uint8_t num_sectors;
+    /** Size of one sector. */
+    uint32_t sector_size;
+    /** Sector that records are appended to. */
+    uint8_t head;
+    /** Sequence number of the head sector. */
+    uint32_t head_sequence;
+    /** Where the next record goes in the head sector. */
+    uint32_t head_offset;
+    /** Last entry that was considered for writing, to take turns. */
+    uint8_t cursor;
+    /** Record that is being read or written. */
+    uint8_t buffer[PBSYS_STORAGE_KV_RECORD_SIZE_MAX] __attribute__((aligned(4)));
+} kv;
+
+static pbio_os_process_t pbsys_storage_kv_process;
+
+static pbsys_storage_kv_entry_t *pbsys_storage_kv_find(const char *key, uint32_t key_size) {
+    for (uint32_t i = 0; i < PBSYS_CONFIG_STORAGE_KV_NUM_KEYS; i++) {
+        pbsys_storage_kv_entry_t *entry = &kv.entries[i];
+        if (entry->used && entry->key_size == key_size && !memcmp(entry->key, key, key_size)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static pbsys_storage_kv_entry_t *pbsys_storage_kv_add(const char *key, uint32_t key_size) {
+    for (uint32_t i = 0; i < PBSYS_CONFIG_STORAGE_KV_NUM_KEYS; i++) {
+        pbsys_storage_kv_entry_t *entry = &kv.entries[i];
+        if (!entry->used) {
+            memset(entry, 0, sizeof(*entry));
+            entry->used = true;
+            entry->sector = PBSYS_STORAGE_KV_SECTOR_NONE;
+            entry->key_size = key_size;
+            memcpy(entry->key, key, key_size);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static bool pbsys_storage_kv_is_pending(void) {
+    for (uint32_t i = 0; i < PBSYS_CONFIG_STORAGE_KV_NUM_KEYS; i++) {
+        if (kv.entries[i].pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Schedules the values that are only stored in the oldest sector to be
+ * written again, so that the oldest sector can be erased when it is needed.
+ *
+ * Deleted keys don't need this. Older records of the same key are in the
+ * same sector or in older ones, so they are erased first.
+ */
+static void pbsys_storage_kv_relocate_oldest(void) {
+    uint8_t oldest = (kv.head + 1) % kv.num_sectors;
+    for (uint32_t i = 0; i < PBSYS_CONFIG_STORAGE_KV_NUM_KEYS; i++) {
+        pbsys_storage_kv_entry_t *entry = &kv.entries[i];
+        if (entry->used && !entry->deleted && entry->sector == oldest) {
+            entry->pending = true;
+        }
+    }
+}
+
+/**
+ * Checks a record in the buffer. If it is valid, applies it to the entries.
+ *
+ * @param [in]  sector  Sector that holds the record.
+ * @return              Whether the record is valid.
+ */
+static bool pbsys_storage_kv_apply_record(uint8_t sector) {
+    const pbsys_storage_kv_record_header_t *header = (void *)kv.buffer;
+    uint32_t size = PBSYS_STORAGE_KV_RECORD_SIZE(header->key_size, header->value_size);
+
+    uint32_t crc;
+    memcpy(&crc, kv.buffer + size - sizeof(crc), sizeof(crc));
+    if (crc != pbio_util_crc32(0, kv.buffer, size - sizeof(crc))) {
+        return false;
+    }
+
+    const char *key = (const char *)(header + 1);
+    pbsys_storage_kv_entry_t *entry = pbsys_storage_kv_find(key, header->key_size);
+
+    if (header->flags & PBSYS_STORAGE_KV_FLAG_DELETED) {
+        if (entry) {
+            entry->used = false;
+        }
+        return true;
+    }
+
+    if (!entry) {
+        entry = pbsys_storage_kv_add(key, header->key_size);
+    }
+
+    // This only happens if there are more keys than currently configured.
+    if (!entry) {
+        return true;
+    }
+
+    entry->sector = sector;
+    entry->value_size = header->value_size;
+    memcpy(entry->value, key + header->key_size, header->value_size);
+    return true;
+}
+
+/**
+ * Reads all records of a sector, oldest first.
+ *
+ * Sets the head offset to the first free space, or to the end of the sector
+ * if the sector is full or has a damaged record. No further records are
+ * appended in the latter case.
+ *
+ * @param [in]  state   Protothread state.
+ * @param [in]  sector  The sector to read.
+ * @return              ::PBIO_SUCCESS on success, or a driver error.
+ */
+static pbio_error_t pbsys_storage_kv_load_sector(pbio_os_state_t *state, uint8_t sector) {
+
+    static pbio_os_state_t sub;
+    static const pbsys_storage_kv_record_header_t *header;
+    static uint32_t size;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    header = (void *)kv.buffer;
+
+    for (kv.head_offset = sizeof(pbsys_storage_kv_sector_header_t);
+         kv.head_offset + PBSYS_STORAGE_KV_RECORD_SIZE(0, 0) <= kv.sector_size;
+         kv.head_offset += size) {
+
+        PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_read(&sub,
+            sector * kv.sector_size + kv.head_offset, kv.buffer, sizeof(*header)));
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        // Erased space, so this is where the next record goes.
+        static const pbsys_storage_kv_record_header_t erased = { 0xFF, 0xFF, 0xFF, 0xFF };
+        if (!memcmp(header, &erased, sizeof(erased))) {
+            return PBIO_SUCCESS;
+        }
+
+        size = PBSYS_STORAGE_KV_RECORD_SIZE(header->key_size, header->value_size);
+        if (header->key_size == 0 ||
+            header->key_size > PBSYS_CONFIG_STORAGE_KV_KEY_SIZE ||
+            header->value_size > PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE ||
+            kv.head_offset + size > kv.sector_size) {
+            break;
+        }
+
+        PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_read(&sub,
+            sector * kv.sector_size + kv.head_offset + sizeof(*header), kv.buffer + sizeof(*header), size - sizeof(*header)));
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+
+        if (!pbsys_storage_kv_apply_record(sector)) {
+            break;
+        }
+    }
+
+    // Full or damaged, so don't append anything here.
+    kv.head_offset = kv.sector_size;
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Loads all values from the journal, oldest sector first.
+ *
+ * @param [in]  state   Protothread state.
+ * @return              ::PBIO_SUCCESS on success, or a driver error.
+ */
+static pbio_error_t pbsys_storage_kv_load(pbio_os_state_t *state) {
+
+    static pbio_os_state_t sub;
+    static uint32_t sequences[PBSYS_STORAGE_KV_MAX_SECTORS];
+    static pbsys_storage_kv_sector_header_t header;
+    static uint8_t sector;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Read the sequence number of each sector. Zero means not in use.
+    for (sector = 0; sector < kv.num_sectors; sector++) {
+        PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_read(&sub,
+            sector * kv.sector_size, (uint8_t *)&header, sizeof(header)));
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+        bool valid = header.magic == PBSYS_STORAGE_KV_MAGIC && header.sequence == ~header.sequence_inverted;
+        sequences[sector] = valid ? header.sequence : 0;
+    }
+
+    // If nothing is stored yet, the first record causes the first sector to
+    // be taken into use, as if the last sector was full.
+    kv.head = kv.num_sectors - 1;
+    kv.head_sequence = 0;
+    kv.head_offset = kv.sector_size;
+
+    for (;;) {
+        // Find the next sector in order of age.
+        sector = PBSYS_STORAGE_KV_SECTOR_NONE;
+        for (uint8_t i = 0; i < kv.num_sectors; i++) {
+            if (sequences[i] > kv.head_sequence &&
+                (sector == PBSYS_STORAGE_KV_SECTOR_NONE || sequences[i] < sequences[sector])) {
+                sector = i;
+            }
+        }
+        if (sector == PBSYS_STORAGE_KV_SECTOR_NONE) {
+            break;
+        }
+
+        kv.head = sector;
+        kv.head_sequence = sequences[sector];
+        PBIO_OS_AWAIT(state, &sub, err = pbsys_storage_kv_load_sector(&sub, sector));
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Erases the sector after the head and takes it into use as the new head.
+ *
+ * @param [in]  state   Protothread state.
+ * @return              ::PBIO_SUCCESS on success, or a driver error.
+ */
+static pbio_error_t pbsys_storage_kv_advance(pbio_os_state_t *state) {
+
+    static pbio_os_state_t sub;
+    static pbsys_storage_kv_sector_header_t header;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_erase(&sub,
+        (kv.head + 1) % kv.num_sectors * kv.sector_size));
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    header.magic = PBSYS_STORAGE_KV_MAGIC;
+    header.sequence = kv.head_sequence + 1;
+    header.sequence_inverted = ~header.sequence;
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_write(&sub,
+        (kv.head + 1) % kv.num_sectors * kv.sector_size, (const uint8_t *)&header, sizeof(header)));
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    kv.head = (kv.head + 1) % kv.num_sectors;
+    kv.head_sequence = header.sequence;
+    kv.head_offset = sizeof(header);
+
+    pbsys_storage_kv_relocate_oldest();
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+/**
+ * Writes the next pending entry, taking turns between entries.
+ *
+ * @param [in]  state   Protothread state.
+ * @return              ::PBIO_SUCCESS on success, or a driver error.
+ */
+static pbio_error_t pbsys_storage_kv_write_next(pbio_os_state_t *state) {
+
+    static pbio_os_state_t sub;
+    static pbsys_storage_kv_entry_t *entry;
+    static uint32_t size;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    entry = NULL;
+    for (uint32_t i = 0; i < PBSYS_CONFIG_STORAGE_KV_NUM_KEYS && !entry; i++) {
+        kv.cursor = (kv.cursor + 1) % PBSYS_CONFIG_STORAGE_KV_NUM_KEYS;
+        if (kv.entries[kv.cursor].pending) {
+            entry = &kv.entries[kv.cursor];
+        }
+    }
+    if (!entry) {
+        return PBIO_SUCCESS;
+    }
+
+    // Encode the record now, since the entry may change while writing.
+    pbsys_storage_kv_record_header_t *header = (void *)kv.buffer;
+    header->key_size = entry->key_size;
+    header->value_size = entry->deleted ? 0 : entry->value_size;
+    header->flags = entry->deleted ? PBSYS_STORAGE_KV_FLAG_DELETED : 0;
+    header->reserved = 0;
+    size = PBSYS_STORAGE_KV_RECORD_SIZE(header->key_size, header->value_size);
+    memset(header + 1, 0, size - sizeof(*header));
+    memcpy(header + 1, entry->key, header->key_size);
+    memcpy((uint8_t *)(header + 1) + header->key_size, entry->value, header->value_size);
+    uint32_t crc = pbio_util_crc32(0, kv.buffer, size - sizeof(crc));
+    memcpy(kv.buffer + size - sizeof(crc), &crc, sizeof(crc));
+    entry->pending = false;
+
+    if (kv.head_offset + size > kv.sector_size) {
+        PBIO_OS_AWAIT(state, &sub, err = pbsys_storage_kv_advance(&sub));
+        if (err != PBIO_SUCCESS) {
+            entry->pending = true;
+            return err;
+        }
+    }
+
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_write(&sub,
+        kv.head * kv.sector_size + kv.head_offset, kv.buffer, size));
+    if (err != PBIO_SUCCESS) {
+        // Don't append to a partially written record.
+        kv.head_offset = kv.sector_size;
+        entry->pending = true;
+        return err;
+    }
+    kv.head_offset += size;
+    entry->sector = kv.head;
+
+    // The deleted entry is no longer needed, unless it was set again.
+    if (entry->deleted && !entry->pending) {
+        entry->used = false;
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t pbsys_storage_kv_process_thread(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_state_t sub;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    PBIO_OS_AWAIT(state, &sub, err = pbsys_storage_kv_load(&sub));
+    kv.err = err;
+    pbio_busy_count_down();
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Power may have been lost before all values were moved out of the
+    // oldest sector, so schedule them again.
+    pbsys_storage_kv_relocate_oldest();
+
+    for (;;) {
+        PBIO_OS_AWAIT_UNTIL(state, kv.shutdown || pbsys_storage_kv_is_pending());
+        if (!pbsys_storage_kv_is_pending()) {
+            break;
+        }
+
+        PBIO_OS_AWAIT(state, &sub, err = pbsys_storage_kv_write_next(&sub));
+        if (err != PBIO_SUCCESS) {
+            kv.err = err;
+            break;
+        }
+    }
+
+    if (kv.shutdown) {
+        pbio_busy_count_down();
+    }
+
+    PBIO_OS_ASYNC_END(kv.err);
+}
+
+/**
+ * Gets a value from the key-value store.
+ *
+ * @param [in]  key         The key.
+ * @param [in]  key_size    Size of the key.
+ * @param [out] value       The value, or NULL if the key does not exist.
+ * @param [out] value_size  Size of the value.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_AGAIN if the store is still loading.
+ *                          ::PBIO_ERROR_INVALID_ARG if the key size is invalid.
+ *                          ::PBIO_ERROR_IO (or other driver error) if the
+ *                            storage could not be accessed.
+ */
+pbio_error_t pbsys_storage_kv_get(const char *key, uint32_t key_size, const uint8_t **value, uint32_t *value_size) {
+
+    *value = NULL;
+    *value_size = 0;
+
+    if (key_size == 0 || key_size > PBSYS_CONFIG_STORAGE_KV_KEY_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (kv.err != PBIO_SUCCESS) {
+        return kv.err;
+    }
+
+    pbsys_storage_kv_entry_t *entry = pbsys_storage_kv_find(key, key_size);
+    if (entry && !entry->deleted) {
+        *value = entry->value;
+        *value_size = entry->value_size;
+    }
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Sets a value in the key-value store. It is saved in the background.
+ *
+ * Setting the same value again does not write anything.
+ *
+ * @param [in]  key         The key.
+ * @param [in]  key_size    Size of the key.
+ * @param [in]  value       The value.
+ * @param [in]  value_size  Size of the value.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_AGAIN if the store is still loading.
+ *                          ::PBIO_ERROR_INVALID_ARG if the key or value size
+ *                            is invalid.
+ *                          ::PBIO_ERROR_INVALID_OP if there is no room for
+ *                            another key.
+ *                          ::PBIO_ERROR_IO (or other driver error) if the
+ *                            storage could not be accessed.
+ */
+pbio_error_t pbsys_storage_kv_set(const char *key, uint32_t key_size, const uint8_t *value, uint32_t value_size) {
+
+    if (key_size == 0 || key_size > PBSYS_CONFIG_STORAGE_KV_KEY_SIZE || value_size > PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (kv.err != PBIO_SUCCESS) {
+        return kv.err;
+    }
+
+    pbsys_storage_kv_entry_t *entry = pbsys_storage_kv_find(key, key_size);
+
+    if (entry && !entry->deleted && entry->value_size == value_size && !memcmp(entry->value, value, value_size)) {
+        return PBIO_SUCCESS;
+    }
+
+    if (!entry) {
+        entry = pbsys_storage_kv_add(key, key_size);
+    }
+
+    if (!entry) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    entry->deleted = false;
+    entry->value_size = value_size;
+    memcpy(entry->value, value, value_size);
+    entry->pending = true;
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Deletes a key from the key-value store. Does nothing if it does not exist.
+ *
+ * @param [in]  key         The key.
+ * @param [in]  key_size    Size of the key.
+ * @return                  ::PBIO_SUCCESS on success.
+ *                          ::PBIO_ERROR_AGAIN if the store is still loading.
+ *                          ::PBIO_ERROR_INVALID_ARG if the key size is invalid.
+ *                          ::PBIO_ERROR_IO (or other driver error) if the
+ *                            storage could not be accessed.
+ */
+pbio_error_t pbsys_storage_kv_delete(const char *key, uint32_t key_size) {
+
+    if (key_size == 0 || key_size > PBSYS_CONFIG_STORAGE_KV_KEY_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (kv.err != PBIO_SUCCESS) {
+        return kv.err;
+    }
+
+    pbsys_storage_kv_entry_t *entry = pbsys_storage_kv_find(key, key_size);
+    if (!entry || entry->deleted) {
+        return PBIO_SUCCESS;
+    }
+
+    // Stored records of this key are hidden by writing a deleted record.
+    entry->deleted = true;
+    entry->pending = true;
+    pbio_os_request_poll();
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Starts loading the key-value store.
+ */
+void pbsys_storage_kv_init(void) {
+
+    memset(&kv, 0, sizeof(kv));
+
+    kv.sector_size = pbdrv_block_device_journal_get_sector_size();
+    uint32_t num_sectors = pbdrv_block_device_journal_get_size() / kv.sector_size;
+
+    // Values that are moved out of the oldest sector must fit in the new
+    // head, with room to spare for values that change meanwhile.
+    if (num_sectors < 2 || num_sectors > PBSYS_STORAGE_KV_MAX_SECTORS ||
+        PBSYS_STORAGE_KV_RECORD_SIZE_MAX * PBSYS_CONFIG_STORAGE_KV_NUM_KEYS * 2 >
+        kv.sector_size - sizeof(pbsys_storage_kv_sector_header_t)) {
+        kv.err = PBIO_ERROR_NOT_SUPPORTED;
+        return;
+    }
+
+    kv.num_sectors = num_sectors;
+    kv.err = PBIO_ERROR_AGAIN;
+
+    pbio_busy_count_up();
+    pbio_os_process_start(&pbsys_storage_kv_process, pbsys_storage_kv_process_thread, NULL);
+}
+
+/**
+ * Requests that the key-value store writes all pending values and stops.
+ */
+void pbsys_storage_kv_deinit(void) {
+
+    // Nothing to do if not running.
+    if (kv.err != PBIO_SUCCESS) {
+        return;
+    }
+
+    kv.shutdown = true;
+    pbio_busy_count_up();
+    pbio_os_process_request_poll(&pbsys_storage_kv_process);
+}
+
+#endif // PBSYS_CONFIG_STORAGE_KV
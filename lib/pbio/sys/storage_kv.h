@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#ifndef _PBSYS_SYS_STORAGE_KV_H_
+#define _PBSYS_SYS_STORAGE_KV_H_
+
+#include <pbsys/config.h>
+
+#if PBSYS_CONFIG_STORAGE_KV
+
+void pbsys_storage_kv_init(void);
+void pbsys_storage_kv_deinit(void);
+
+#else
+
+static inline void pbsys_storage_kv_init(void) {
+}
+static inline void pbsys_storage_kv_deinit(void) {
+}
+
+#endif // PBSYS_CONFIG_STORAGE_KV
+
+#endif // _PBSYS_SYS_STORAGE_KV_H_
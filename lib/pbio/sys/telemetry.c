@@ -6,48 +6,253 @@
 #if PBSYS_CONFIG_TELEMETRY
 
 #include <stdio.h>
+#include <string.h>
 
+#include <pbdrv/stack.h>
+
+#include <pbio/battery.h>
+#include <pbio/drivebase.h>
+#include <pbio/imu.h>
+#include <pbio/int_math.h>
 #include <pbio/os.h>
 #include <pbio/port_interface.h>
+#include <pbio/port_lump.h>
+#include <pbio/servo.h>
 #include <pbio/util.h>
 
+#include <pbsys/battery.h>
 #include <pbsys/host.h>
 
+#include "telemetry.h"
+
+/**
+ * Maximum event payload size. This fits in one notification with the
+ * default BLE MTU.
+ */
+#define TELEMETRY_BUF_SIZE (19)
+
+/**
+ * Size of the tag and size fields of a record.
+ */
+#define TELEMETRY_RECORD_HEADER_SIZE (2)
+
+// Each port has a type, angle, servo, and sensor data record. Then there is
+// one record per drive base, and a heading, battery, energy and stack record
+// for the hub.
+#define SLOTS_PER_PORT (4)
+#define SLOT_DRIVEBASE (PBIO_CONFIG_PORT_NUM_DEV * SLOTS_PER_PORT)
+#define SLOT_IMU_HEADING (SLOT_DRIVEBASE + PBIO_CONFIG_NUM_DRIVEBASES)
+#define SLOT_BATTERY (SLOT_IMU_HEADING + 1)
+#define SLOT_ENERGY (SLOT_BATTERY + 1)
+#define SLOT_STACK (SLOT_ENERGY + 1)
+#define NUM_SLOTS (SLOT_STACK + 1)
+
+/**
+ * Last record sent for each slot, used to send only changed values.
+ */
 typedef struct {
-    lego_device_type_id_t type_id;
-    int32_t value;
-} pbsys_telemetry_port_data_t;
-
-static pbsys_telemetry_port_data_t last_data[PBIO_CONFIG_PORT_NUM_DEV];
-
-// Revisit: Come up with a data encoding protocol. Right now it just sends
-// six motor positions to drive the existing motor animation.
-static uint8_t update_port_data(uint8_t index, uint8_t *buf) {
-
-    // Get type and angle.
-    int32_t degrees = 0;
-    pbio_angle_t angle;
-    lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_NONE;
-    pbio_port_t *port = pbio_port_by_index(index);
-    pbio_error_t err = pbio_port_get_angle(port, &angle);
-    if (err == PBIO_SUCCESS) {
-        type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
-        degrees = pbio_angle_to_low_res(&angle, 1000);
+    uint8_t size;
+    uint8_t data[TELEMETRY_BUF_SIZE];
+} pbsys_telemetry_record_t;
+
+static pbsys_telemetry_record_t last_records[NUM_SLOTS];
+
+/**
+ * Time between telemetry updates in ms.
+ */
+static uint16_t telemetry_period = 40;
+
+/**
+ * Records to send, as ::PBSYS_TELEMETRY_TAG_FLAG bits.
+ */
+static uint32_t telemetry_mask = UINT32_MAX;
+
+/**
+ * Configures telemetry rate and subscriptions.
+ *
+ * All subscribed records are sent again on the next update, so this can also
+ * be used by a newly connected host to get the complete state.
+ *
+ * @param [in]  period  Time between updates in ms.
+ * @param [in]  mask    Records to send, as ::PBSYS_TELEMETRY_TAG_FLAG bits.
+ */
+void pbsys_telemetry_configure(uint16_t period, uint32_t mask) {
+    telemetry_period = period ? period : 1;
+    telemetry_mask = mask;
+    memset(last_records, 0, sizeof(last_records));
+}
+
+/**
+ * Starts a record in the given buffer.
+ *
+ * @param [in]  rec     Buffer for the record.
+ * @param [in]  tag     The record tag.
+ * @param [in]  size    Size of the record value.
+ * @return              Pointer to the record value.
+ */
+static uint8_t *start_record(uint8_t *rec, pbsys_telemetry_tag_t tag, uint8_t size) {
+    rec[0] = tag;
+    rec[1] = size;
+    return &rec[TELEMETRY_RECORD_HEADER_SIZE];
+}
+
+static uint8_t get_port_record(pbio_port_t *port, uint8_t index, uint8_t kind, uint8_t *rec) {
+
+    switch (kind) {
+        case 0: {
+            // Type of device attached to this port, if any.
+            lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_ANY_LUMP_UART;
+            pbio_port_lump_dev_t *lump_dev;
+            pbio_dcmotor_t *dcmotor;
+            pbio_angle_t angle;
+            if (pbio_port_get_lump_device(port, &type_id, &lump_dev) != PBIO_SUCCESS) {
+                type_id = LEGO_DEVICE_TYPE_ID_ANY_DC_MOTOR;
+                if (pbio_port_get_dcmotor(port, &type_id, &dcmotor) != PBIO_SUCCESS) {
+                    type_id = LEGO_DEVICE_TYPE_ID_NONE;
+                } else if (pbio_port_get_angle(port, &angle) == PBIO_SUCCESS) {
+                    type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+                }
+            }
+            uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_PORT_TYPE, 2);
+            value[0] = index;
+            value[1] = type_id;
+            return TELEMETRY_RECORD_HEADER_SIZE + 2;
+        }
+        case 1: {
+            // Motor angle, even if no motor object is in use.
+            pbio_angle_t angle;
+            if (pbio_port_get_angle(port, &angle) != PBIO_SUCCESS) {
+                return 0;
+            }
+            uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_PORT_ANGLE, 5);
+            value[0] = index;
+            pbio_set_uint32_le(&value[1], pbio_angle_to_low_res(&angle, 1000));
+            return TELEMETRY_RECORD_HEADER_SIZE + 5;
+        }
+        #if PBIO_CONFIG_SERVO
+        case 2: {
+            // Servo state if a motor object is in use.
+            lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+            pbio_servo_t *srv;
+            int32_t angle, speed, load;
+            bool stalled;
+            uint32_t stall_duration;
+            if (pbio_port_get_servo(port, &type_id, &srv) != PBIO_SUCCESS ||
+                pbio_servo_get_state_user(srv, &angle, &speed) != PBIO_SUCCESS ||
+                pbio_servo_get_load(srv, &load) != PBIO_SUCCESS ||
+                pbio_servo_is_stalled(srv, &stalled, &stall_duration) != PBIO_SUCCESS) {
+                return 0;
+            }
+            uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_SERVO, 10);
+            value[0] = index;
+            pbio_set_uint32_le(&value[1], speed);
+            pbio_set_uint32_le(&value[5], load);
+            value[9] = stalled;
+            return TELEMETRY_RECORD_HEADER_SIZE + 10;
+        }
+        #endif // PBIO_CONFIG_SERVO
+        case 3: {
+            // Data of the current mode of a sensor.
+            lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_ANY_LUMP_UART;
+            pbio_port_lump_dev_t *lump_dev;
+            uint8_t num_modes, mode;
+            pbio_port_lump_mode_info_t *mode_info;
+            void *data;
+            if (pbio_port_get_lump_device(port, &type_id, &lump_dev) != PBIO_SUCCESS ||
+                pbio_port_lump_get_info(lump_dev, &num_modes, &mode, &mode_info) != PBIO_SUCCESS ||
+                pbio_port_lump_get_data(lump_dev, mode, &data) != PBIO_SUCCESS) {
+                return 0;
+            }
+            size_t size = mode_info[mode].num_values * pbio_port_lump_data_size(mode_info[mode].data_type);
+            size = pbio_int_math_min(size, TELEMETRY_BUF_SIZE - TELEMETRY_RECORD_HEADER_SIZE - 2);
+            uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_LUMP_DATA, size + 2);
+            value[0] = index;
+            value[1] = mode;
+            memcpy(&value[2], data, size);
+            return TELEMETRY_RECORD_HEADER_SIZE + 2 + size;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Gets the current record for a telemetry slot.
+ *
+ * @param [in]  slot    The slot index.
+ * @param [out] rec     Buffer for the record.
+ * @return              Size of the record, or 0 if there is nothing to send.
+ */
+static uint8_t get_record(uint32_t slot, uint8_t *rec) {
+
+    if (slot < SLOT_DRIVEBASE) {
+        uint8_t index = slot / SLOTS_PER_PORT;
+        return get_port_record(pbio_port_by_index(index), index, slot % SLOTS_PER_PORT, rec);
+    }
+
+    #if PBIO_CONFIG_NUM_DRIVEBASES > 0
+    if (slot < SLOT_IMU_HEADING) {
+        uint8_t index = slot - SLOT_DRIVEBASE;
+        pbio_drivebase_t *db = pbio_drivebase_by_index(index);
+        int32_t distance, drive_speed, angle, turn_rate;
+        if (!pbio_drivebase_update_loop_is_running(db) ||
+            pbio_drivebase_get_state_user(db, &distance, &drive_speed, &angle, &turn_rate) != PBIO_SUCCESS) {
+            return 0;
+        }
+        uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_DRIVEBASE, 17);
+        value[0] = index;
+        pbio_set_uint32_le(&value[1], distance);
+        pbio_set_uint32_le(&value[5], drive_speed);
+        pbio_set_uint32_le(&value[9], angle);
+        pbio_set_uint32_le(&value[13], turn_rate);
+        return TELEMETRY_RECORD_HEADER_SIZE + 17;
     }
+    #endif // PBIO_CONFIG_NUM_DRIVEBASES > 0
 
-    pbsys_telemetry_port_data_t *data = &last_data[index];
+    #if PBIO_CONFIG_IMU
+    if (slot == SLOT_IMU_HEADING) {
+        uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_IMU_HEADING, 4);
+        pbio_set_uint32_le(value, (int32_t)pbio_imu_get_heading(PBIO_IMU_HEADING_TYPE_3D));
+        return TELEMETRY_RECORD_HEADER_SIZE + 4;
+    }
+    #endif // PBIO_CONFIG_IMU
 
-    if (data->type_id == type_id && data->value == degrees) {
-        return 0;
+    #if PBIO_CONFIG_BATTERY
+    if (slot == SLOT_BATTERY) {
+        uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_BATTERY, 2);
+        pbio_set_uint16_le(value, pbio_battery_get_average_voltage());
+        return TELEMETRY_RECORD_HEADER_SIZE + 2;
     }
 
-    data->type_id = type_id;
-    data->value = degrees;
+    if (slot == SLOT_ENERGY) {
+        int32_t charge;
+        if (pbio_battery_get_program_charge(&charge) != PBIO_SUCCESS) {
+            return 0;
+        }
+        uint32_t runtime;
+        if (pbsys_battery_get_remaining_runtime(&runtime) != PBIO_SUCCESS) {
+            runtime = UINT32_MAX;
+        }
+        uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_ENERGY, 8);
+        pbio_set_uint32_le(&value[0], charge / 1000);
+        pbio_set_uint32_le(&value[4], runtime);
+        return TELEMETRY_RECORD_HEADER_SIZE + 8;
+    }
+    #endif // PBIO_CONFIG_BATTERY
 
-    buf[0] = type_id;
-    buf[1] = index;
-    pbio_set_uint32_le(&buf[2], degrees);
-    return 6;
+    #if PBDRV_CONFIG_STACK_EMBEDDED
+    if (slot == SLOT_STACK) {
+        char *stack_start;
+        char *stack_end;
+        pbdrv_stack_get_info(&stack_start, &stack_end);
+        uint8_t *value = start_record(rec, PBSYS_TELEMETRY_TAG_STACK, 8);
+        pbio_set_uint32_le(&value[0], pbdrv_stack_get_max_usage());
+        pbio_set_uint32_le(&value[4], stack_end - stack_start);
+        return TELEMETRY_RECORD_HEADER_SIZE + 8;
+    }
+    #endif // PBDRV_CONFIG_STACK_EMBEDDED
+
+    return 0;
 }
 
 /**
@@ -57,21 +262,42 @@ static pbio_error_t pbsys_telemetry_process_thread(pbio_os_state_t *state, void
 
     static pbio_os_timer_t timer;
     static pbio_os_state_t sub;
-    static uint8_t buf[20];
+    static uint8_t buf[TELEMETRY_BUF_SIZE];
     static uint8_t size;
+    static uint8_t rec[TELEMETRY_BUF_SIZE];
+    static uint8_t rec_size;
     static uint32_t i = 0;
 
     PBIO_OS_ASYNC_BEGIN(state);
 
     for (;;) {
-        PBIO_OS_AWAIT_MS(state, &timer, 40);
+        PBIO_OS_AWAIT_MS(state, &timer, telemetry_period);
 
-        // Revisit, could concatenate packages for more efficient BLE sending.
-        for (i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
-            size = update_port_data(i, buf);
-            if (size) {
+        // Concatenate changed records to send as few events as possible.
+        size = 0;
+        for (i = 0; i < NUM_SLOTS; i++) {
+            rec_size = get_record(i, rec);
+
+            // Skip unsubscribed and unchanged records.
+            pbsys_telemetry_record_t *last = &last_records[i];
+            if (!rec_size || !(telemetry_mask & PBSYS_TELEMETRY_TAG_FLAG(rec[0])) ||
+                (last->size == rec_size && !memcmp(last->data, rec, rec_size))) {
+                continue;
+            }
+            last->size = rec_size;
+            memcpy(last->data, rec, rec_size);
+
+            // Send what we have so far if this record does not fit.
+            if (size + rec_size > TELEMETRY_BUF_SIZE) {
                 PBIO_OS_AWAIT(state, &sub, pbsys_host_send_event(&sub, PBIO_PYBRICKS_EVENT_WRITE_TELEMETRY, buf, size));
+                size = 0;
             }
+            memcpy(&buf[size], rec, rec_size);
+            size += rec_size;
+        }
+
+        if (size) {
+            PBIO_OS_AWAIT(state, &sub, pbsys_host_send_event(&sub, PBIO_PYBRICKS_EVENT_WRITE_TELEMETRY, buf, size));
         }
     }
 
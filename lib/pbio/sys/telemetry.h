@@ -4,18 +4,79 @@
 #ifndef _PBSYS_SYS_TELEMETRY_H_
 #define _PBSYS_SYS_TELEMETRY_H_
 
+#include <stdint.h>
+
 #include <pbsys/config.h>
 
+/**
+ * Telemetry record tags.
+ *
+ * Each telemetry event payload holds one or more records. Each record is the
+ * tag (u8), the size of the value in bytes (u8), and the value. All integers
+ * are little endian. Records are only sent when their value changes. Unknown
+ * tags can be skipped by their size.
+ */
+typedef enum {
+    /**
+     * Port index (u8) and device type identifier (u8).
+     */
+    PBSYS_TELEMETRY_TAG_PORT_TYPE = 1,
+    /**
+     * Port index (u8) and motor angle in degrees (i32).
+     */
+    PBSYS_TELEMETRY_TAG_PORT_ANGLE = 2,
+    /**
+     * Port index (u8), motor speed in deg/s (i32), load in mNm (i32), and
+     * stall flag (u8).
+     */
+    PBSYS_TELEMETRY_TAG_SERVO = 3,
+    /**
+     * Port index (u8), mode (u8), and the raw data of the current mode of a
+     * LEGO UART sensor, truncated to fit in one event.
+     */
+    PBSYS_TELEMETRY_TAG_LUMP_DATA = 4,
+    /**
+     * Drive base index (u8), distance in mm (i32), drive speed in mm/s (i32),
+     * angle in degrees (i32), and turn rate in deg/s (i32).
+     */
+    PBSYS_TELEMETRY_TAG_DRIVEBASE = 5,
+    /**
+     * IMU heading in degrees (i32).
+     */
+    PBSYS_TELEMETRY_TAG_IMU_HEADING = 6,
+    /**
+     * Average battery voltage in mV (u16).
+     */
+    PBSYS_TELEMETRY_TAG_BATTERY = 7,
+    /**
+     * Peak stack use since boot in bytes (u32) and stack size in bytes (u32).
+     */
+    PBSYS_TELEMETRY_TAG_STACK = 8,
+    /**
+     * Battery charge used by the running or most recent program in mAh (u32)
+     * and estimated remaining runtime in s (u32), or UINT32_MAX if not known.
+     */
+    PBSYS_TELEMETRY_TAG_ENERGY = 9,
+} pbsys_telemetry_tag_t;
+
+/**
+ * Converts a telemetry tag to its bit in the subscription mask.
+ */
+#define PBSYS_TELEMETRY_TAG_FLAG(tag) (1 << (tag))
 
 #if PBSYS_CONFIG_TELEMETRY
 
 void pbsys_telemetry_init(void);
+void pbsys_telemetry_configure(uint16_t period, uint32_t mask);
 
 #else
 
 static inline void pbsys_telemetry_init(void) {
 }
 
+static inline void pbsys_telemetry_configure(uint16_t period, uint32_t mask) {
+}
+
 #endif // PBSYS_CONFIG_TELEMETRY
 
 #endif // _PBSYS_SYS_TELEMETRY_H_
@@ -0,0 +1,58 @@
+#!/usr/bin/env python
+
+# This program converts tracepoint events printed by
+# pybricks.experimental.tracepoints_dump() into the Chrome trace event format.
+# Open the result in chrome://tracing or https://ui.perfetto.dev.
+#
+# Usage: python trace_parser.py < output.txt
+
+import json
+import sys
+
+# Names of events in pbio/tracepoint.h. Events ending in _START and _END are
+# shown as durations, all others as instants.
+EVENT_NAMES = (
+    "OS_RUN_START",
+    "OS_RUN_END",
+    "MOTOR_TICK_START",
+    "MOTOR_TICK_END",
+    "UART_RX",
+    "BLE_TX_START",
+    "BLE_TX_END",
+    "GC_START",
+    "GC_END",
+)
+
+# Durations that happen in interrupts or can be interrupted by the others are
+# shown on separate rows.
+THREADS = {"OS_RUN": 0, "MOTOR_TICK": 1, "GC": 2, "BLE_TX": 3, "UART_RX": 4}
+
+trace = []
+
+for line in sys.stdin:
+    fields = line.split()
+    if len(fields) != 5 or fields[0] != "TP":
+        continue
+
+    time, event_id, arg0, arg1 = map(int, fields[1:])
+    name = EVENT_NAMES[event_id] if event_id < len(EVENT_NAMES) else f"EVENT_{event_id}"
+
+    if name.endswith("_START"):
+        name, phase = name[: -len("_START")], "B"
+    elif name.endswith("_END"):
+        name, phase = name[: -len("_END")], "E"
+    else:
+        phase = "i"
+
+    trace.append(
+        {
+            "name": name,
+            "ph": phase,
+            "ts": time,
+            "pid": 0,
+            "tid": THREADS.get(name, len(THREADS)),
+            "args": {"arg0": arg0, "arg1": arg1},
+        }
+    )
+
+json.dump({"traceEvents": trace, "displayTimeUnit": "ms"}, sys.stdout)
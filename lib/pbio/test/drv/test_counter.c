@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/error.h>
+#include <test-pbio.h>
+
+#include "../drv/clock/clock_test.h"
+#include "../drv/counter/counter.h"
+
+static void test_counter_edge_speed(void *env) {
+    static pbdrv_counter_edge_t edge;
+    int32_t speed = 1;
+
+    // No edges yet, so stopped.
+    tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, ==, 0);
+
+    // Two edges are not enough for a full period.
+    pbio_test_clock_tick(10);
+    pbdrv_counter_edge_update(&edge, 1);
+    pbio_test_clock_tick(6);
+    pbdrv_counter_edge_update(&edge, 1);
+    tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_ERROR_AGAIN);
+
+    // One degree every 10 ms with an uneven duty cycle. Each estimate spans
+    // two edges, so it is 100 deg/s throughout.
+    for (int i = 0; i < 10; i++) {
+        pbio_test_clock_tick(i % 2 ? 6 : 14);
+        pbdrv_counter_edge_update(&edge, 1);
+        tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_SUCCESS);
+        tt_want_int_op(speed, ==, 100000);
+    }
+
+    // When the next edge is overdue, the estimate goes down.
+    pbio_test_clock_tick(40);
+    tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, ==, 25000);
+
+    // Without edges for long enough, it is stopped.
+    pbio_test_clock_tick(100);
+    tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, ==, 0);
+
+    // Changing direction starts over.
+    pbdrv_counter_edge_update(&edge, -1);
+    pbio_test_clock_tick(5);
+    pbdrv_counter_edge_update(&edge, -1);
+    tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_ERROR_AGAIN);
+    pbio_test_clock_tick(5);
+    pbdrv_counter_edge_update(&edge, -1);
+    tt_want_int_op(pbdrv_counter_edge_get_speed(&edge, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, ==, -200000);
+}
+
+struct testcase_t pbdrv_counter_tests[] = {
+    PBIO_TEST(test_counter_edge_speed),
+    END_OF_TESTCASES
+};
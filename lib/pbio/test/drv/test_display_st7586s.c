@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <test-pbio.h>
+
+#include "../drv/display/display_st7586s.h"
+
+#define NUM_ROWS (8)
+#define NUM_TRIPLETS (8)
+#define NUM_COLS (NUM_TRIPLETS * 3)
+#define STRIDE (NUM_COLS / 4 + 1)
+
+// Encodes one pixel the straightforward way, as a reference.
+static uint8_t reference_triplet(uint8_t p0, uint8_t p1, uint8_t p2) {
+    p0 = p0 >= PBDRV_DISPLAY_ST7586S_VALUE_MAX ? 0b111 : (p0 << 1);
+    p1 = p1 >= PBDRV_DISPLAY_ST7586S_VALUE_MAX ? 0b111 : (p1 << 1);
+    p2 = p2 >= PBDRV_DISPLAY_ST7586S_VALUE_MAX ? 0b11 : p2;
+    return p0 << 5 | p1 << 2 | p2;
+}
+
+// Packs pixels four per byte, first pixel in the most significant bits.
+static void pack_frame(uint8_t pixels[NUM_ROWS][NUM_COLS], uint8_t frame[NUM_ROWS][STRIDE]) {
+    memset(frame, 0, NUM_ROWS * STRIDE);
+    for (uint32_t row = 0; row < NUM_ROWS; row++) {
+        for (uint32_t col = 0; col < NUM_COLS; col++) {
+            frame[row][col / 4] |= pixels[row][col] << (6 - col % 4 * 2);
+        }
+    }
+}
+
+static void test_display_st7586s_encode(void *env) {
+    uint8_t pixels[NUM_ROWS][NUM_COLS];
+    uint8_t frame[NUM_ROWS][STRIDE];
+    uint8_t encoded[NUM_ROWS * NUM_TRIPLETS];
+    pbdrv_display_st7586s_window_t window;
+
+    // All combinations of pixels.
+    for (uint32_t i = 0; i < NUM_ROWS * NUM_COLS; i++) {
+        pixels[i / NUM_COLS][i % NUM_COLS] = i * 7 % 13 % 4;
+    }
+    pack_frame(pixels, frame);
+    memset(encoded, 0x55, sizeof(encoded));
+    tt_want(pbdrv_display_st7586s_encode(&frame[0][0], STRIDE, encoded, NUM_ROWS, NUM_TRIPLETS, true, &window));
+    tt_want_uint_op(window.row_start, ==, 0);
+    tt_want_uint_op(window.row_end, ==, NUM_ROWS - 1);
+    tt_want_uint_op(window.triplet_start, ==, 0);
+    tt_want_uint_op(window.triplet_end, ==, NUM_TRIPLETS - 1);
+    for (uint32_t row = 0; row < NUM_ROWS; row++) {
+        for (uint32_t t = 0; t < NUM_TRIPLETS; t++) {
+            uint8_t *p = &pixels[row][t * 3];
+            tt_want_uint_op(encoded[row * NUM_TRIPLETS + t], ==, reference_triplet(p[0], p[1], p[2]));
+        }
+    }
+
+    // Nothing changed.
+    tt_want(!pbdrv_display_st7586s_encode(&frame[0][0], STRIDE, encoded, NUM_ROWS, NUM_TRIPLETS, false, &window));
+
+    // Window spans all changed pixels.
+    pixels[3][4] = pixels[3][4] == 1 ? 2 : 1;
+    pixels[5][20] = pixels[5][20] == 0 ? 3 : 0;
+    pack_frame(pixels, frame);
+    tt_want(pbdrv_display_st7586s_encode(&frame[0][0], STRIDE, encoded, NUM_ROWS, NUM_TRIPLETS, false, &window));
+    tt_want_uint_op(window.row_start, ==, 3);
+    tt_want_uint_op(window.row_end, ==, 5);
+    tt_want_uint_op(window.triplet_start, ==, 1);
+    tt_want_uint_op(window.triplet_end, ==, 6);
+    tt_want_uint_op(encoded[3 * NUM_TRIPLETS + 1], ==, reference_triplet(pixels[3][3], pixels[3][4], pixels[3][5]));
+    tt_want_uint_op(encoded[5 * NUM_TRIPLETS + 6], ==, reference_triplet(pixels[5][18], pixels[5][19], pixels[5][20]));
+}
+
+struct testcase_t pbdrv_display_st7586s_tests[] = {
+    PBIO_TEST(test_display_st7586s_encode),
+    END_OF_TESTCASES
+};
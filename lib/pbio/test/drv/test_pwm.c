@@ -34,8 +34,29 @@ static void test_pwm_set_duty(void *env) {
     tt_want(pbdrv_pwm_set_duty(dev, 1, 100) == PBIO_SUCCESS);
 }
 
+static void test_pwm_batch(void *env) {
+    tt_want(!pbdrv_pwm_batch_is_active());
+
+    // Batches can be nested, and only the outermost one ends the batch.
+    pbdrv_pwm_batch_begin();
+    tt_want(pbdrv_pwm_batch_is_active());
+    pbdrv_pwm_batch_begin();
+    pbdrv_pwm_batch_end();
+    tt_want(pbdrv_pwm_batch_is_active());
+    pbdrv_pwm_batch_end();
+    tt_want(!pbdrv_pwm_batch_is_active());
+
+    // Extra calls to end are ignored.
+    pbdrv_pwm_batch_end();
+    pbdrv_pwm_batch_begin();
+    tt_want(pbdrv_pwm_batch_is_active());
+    pbdrv_pwm_batch_end();
+    tt_want(!pbdrv_pwm_batch_is_active());
+}
+
 struct testcase_t pbdrv_pwm_tests[] = {
     PBIO_TEST(test_pwm_get),
     PBIO_TEST(test_pwm_set_duty),
+    PBIO_TEST(test_pwm_batch),
     END_OF_TESTCASES
 };
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pbio/adpcm.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+// Converts a sample at full volume back to a signed value.
+static int32_t to_signed(uint16_t sample) {
+    return (int32_t)sample - INT16_MAX;
+}
+
+static void test_adpcm_raw(void *env) {
+    pbio_adpcm_decoder_t decoder;
+    uint16_t samples[4];
+
+    // Code 7 steps up by 7 + 3 + 1 + 0 = 11 and raises the step to 16, then
+    // code 0 steps up by 16 / 8 = 2, code 8 steps down by 14 / 8 = 1 and
+    // code 0 steps up by 13 / 8 = 1.
+    static const uint8_t data[] = { 0x07, 0x08 };
+    pbio_adpcm_decoder_init(&decoder, data, sizeof(data), 0, INT16_MAX);
+    tt_want_uint_op(pbio_adpcm_decode(&decoder, samples, 4), ==, 4);
+    tt_want_int_op(decoder.predictor, ==, 11 + 2 - 1 + 1);
+    tt_want_int_op(to_signed(samples[0]), ==, 11 * INT16_MAX >> 15);
+    tt_want_int_op(to_signed(samples[1]), ==, 13 * INT16_MAX >> 15);
+
+    // Nothing left.
+    tt_want_uint_op(pbio_adpcm_decode(&decoder, samples, 4), ==, 0);
+
+    // Half volume.
+    pbio_adpcm_decoder_init(&decoder, data, sizeof(data), 0, INT16_MAX / 2);
+    tt_want_uint_op(pbio_adpcm_decode(&decoder, samples, 1), ==, 1);
+    tt_want_int_op(to_signed(samples[0]), ==, 11 * (INT16_MAX / 2) >> 15);
+}
+
+static void test_adpcm_blocks(void *env) {
+    pbio_adpcm_decoder_t decoder;
+    uint16_t samples[16];
+
+    // Two blocks of 6 bytes and a truncated block. Each header gives the
+    // first sample and step index, then 4 codes follow.
+    static const uint8_t data[] = {
+        0xe8, 0x03, 0x00, 0x00, 0x00, 0x00,
+        0x18, 0xfc, 0x58, 0x00, 0xff, 0xff,
+        0x00, 0x00,
+    };
+    pbio_adpcm_decoder_init(&decoder, data, sizeof(data), 6, INT16_MAX);
+    tt_want_uint_op(pbio_adpcm_decode(&decoder, samples, 16), ==, 10);
+
+    // Header sample, then steps too small to change it.
+    tt_want_int_op(to_signed(samples[0]), ==, 1000 * INT16_MAX >> 15);
+    tt_want_int_op(to_signed(samples[1]), ==, 1000 * INT16_MAX >> 15);
+
+    // Second block starts from its own header, then steps down as far as
+    // possible with the largest step.
+    tt_want_int_op(to_signed(samples[5]), ==, -1000 * INT16_MAX >> 15);
+    tt_want_int_op(to_signed(samples[6]), ==, INT16_MIN * INT16_MAX >> 15);
+    tt_want_int_op(to_signed(samples[9]), ==, INT16_MIN * INT16_MAX >> 15);
+}
+
+// Reference encoder with the same state as the decoder.
+static uint8_t encode_sample(int16_t *predictor, uint8_t *step_index, int32_t sample) {
+    static const uint16_t step_table[] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+        45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+        230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+        963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+        3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
+        9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623,
+        27086, 29794, 32767,
+    };
+    static const int8_t index_table[] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+    int32_t step = step_table[*step_index];
+    int32_t diff = sample - *predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    int32_t delta = step >> 3;
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        delta += step;
+    }
+    if (diff >= step >> 1) {
+        code |= 2;
+        diff -= step >> 1;
+        delta += step >> 1;
+    }
+    if (diff >= step >> 2) {
+        code |= 1;
+        delta += step >> 2;
+    }
+
+    int32_t predicted = *predictor + ((code & 8) ? -delta : delta);
+    *predictor = predicted > INT16_MAX ? INT16_MAX : predicted < INT16_MIN ? INT16_MIN : predicted;
+    int32_t index = *step_index + index_table[code & 7];
+    *step_index = index < 0 ? 0 : index > 88 ? 88 : index;
+    return code;
+}
+
+static void test_adpcm_sine(void *env) {
+    enum { NUM_SAMPLES = 1000 };
+    static uint8_t data[NUM_SAMPLES / 2];
+    static uint16_t samples[NUM_SAMPLES];
+    static int16_t original[NUM_SAMPLES];
+    pbio_adpcm_decoder_t decoder;
+
+    int16_t predictor = 0;
+    uint8_t step_index = 0;
+    memset(data, 0, sizeof(data));
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        original[i] = 20000 * sinf(i * 2 * 3.14159f * 440 / 8000);
+        data[i / 2] |= encode_sample(&predictor, &step_index, original[i]) << (i % 2 * 4);
+    }
+
+    // Decode in uneven chunks, as the sound driver refills its buffer.
+    pbio_adpcm_decoder_init(&decoder, data, sizeof(data), 0, INT16_MAX);
+    uint32_t count = 0;
+    for (uint32_t chunk = 1; count < NUM_SAMPLES; chunk = chunk * 3 % 97 + 1) {
+        uint32_t size = chunk < NUM_SAMPLES - count ? chunk : NUM_SAMPLES - count;
+        tt_want_uint_op(pbio_adpcm_decode(&decoder, &samples[count], size), ==, size);
+        count += size;
+    }
+
+    // After the first period, the decoded signal follows the original.
+    int32_t max_error = 0;
+    for (int i = 20; i < NUM_SAMPLES; i++) {
+        int32_t error = abs(to_signed(samples[i]) - original[i]);
+        max_error = error > max_error ? error : max_error;
+    }
+    tt_want_int_op(max_error, <, 1000);
+}
+
+struct testcase_t pbio_adpcm_tests[] = {
+    PBIO_TEST(test_adpcm_raw),
+    PBIO_TEST(test_adpcm_blocks),
+    PBIO_TEST(test_adpcm_sine),
+    END_OF_TESTCASES
+};
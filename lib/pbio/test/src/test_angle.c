@@ -94,8 +94,29 @@ static void test_scaling(void *env) {
     test_scale(2046); // Medium drive base heading control: 2046 mdeg = 1deg
 }
 
+/**
+ * Test that scaling gives the same result when alternating between more
+ * scales than are cached, with and without a whole number of units per rotation.
+ */
+static void test_scaling_cache(void *env) {
+    static const int32_t scales[] = { 1000, 2046, 3000, 1500, 2000, 7, 360000 };
+    for (uint32_t i = 0; i < 100; i++) {
+        for (uint32_t j = 0; j < sizeof(scales) / sizeof(scales[0]); j++) {
+            int32_t scale = scales[j];
+            pbio_angle_t a = {
+                .rotations = get_random() % 1000,
+                .millidegrees = get_random() % 360000,
+            };
+            int64_t expected = a.rotations * (int64_t)360000 / scale +
+                (a.millidegrees + pbio_int_math_sign(a.millidegrees) * scale / 2) / scale;
+            tt_want_int_op(pbio_angle_to_low_res(&a, scale), ==, expected);
+        }
+    }
+}
+
 struct testcase_t pbio_angle_tests[] = {
     PBIO_TEST(test_rounding),
     PBIO_TEST(test_scaling),
+    PBIO_TEST(test_scaling_cache),
     END_OF_TESTCASES
 };
@@ -76,7 +76,70 @@ static pbio_error_t test_light_animation(pbio_os_state_t *state, void *context)
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+static uint32_t test_animation_fast_count;
+static uint32_t test_animation_slow_count;
+static uint32_t test_animation_zero_count;
+
+static uint32_t test_animation_fast_next(pbio_light_animation_t *animation) {
+    test_animation_fast_count++;
+    return 3;
+}
+
+static uint32_t test_animation_slow_next(pbio_light_animation_t *animation) {
+    test_animation_slow_count++;
+    return 10;
+}
+
+static uint32_t test_animation_zero_next(pbio_light_animation_t *animation) {
+    test_animation_zero_count++;
+    return 0;
+}
+
+static pbio_error_t test_light_animation_deadlines(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static pbio_light_animation_t slow;
+    static pbio_light_animation_t fast;
+    static pbio_light_animation_t zero;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Animations with different periods each run at their own pace,
+    // regardless of the order in which they were started.
+    pbio_light_animation_init(&slow, test_animation_slow_next);
+    pbio_light_animation_init(&fast, test_animation_fast_next);
+    pbio_light_animation_start(&slow);
+    pbio_light_animation_start(&fast);
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    tt_want_uint_op(test_animation_slow_count, ==, 1);
+    tt_want_uint_op(test_animation_fast_count, ==, 1);
+
+    PBIO_OS_AWAIT_MS(state, &timer, 30);
+    tt_want_uint_op(test_animation_slow_count, ==, 1 + 3);
+    tt_want_uint_op(test_animation_fast_count, ==, 1 + 10);
+
+    // Stopping the earliest animation leaves the others running.
+    pbio_light_animation_stop(&fast);
+    PBIO_OS_AWAIT_MS(state, &timer, 10);
+    tt_want_uint_op(test_animation_slow_count, ==, 1 + 4);
+    tt_want_uint_op(test_animation_fast_count, ==, 1 + 10);
+
+    // An animation without delay runs once per poll and does not starve the
+    // others.
+    pbio_light_animation_init(&zero, test_animation_zero_next);
+    pbio_light_animation_start(&zero);
+    PBIO_OS_AWAIT_MS(state, &timer, 10);
+    tt_want_uint_op(test_animation_slow_count, ==, 1 + 5);
+    tt_want_uint_op(test_animation_zero_count, >, 0);
+    tt_want_uint_op(test_animation_zero_count, <=, 20);
+
+    pbio_light_animation_stop_all();
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 struct testcase_t pbio_light_animation_tests[] = {
     PBIO_THREAD_TEST(test_light_animation),
+    PBIO_THREAD_TEST(test_light_animation_deadlines),
     END_OF_TESTCASES
 };
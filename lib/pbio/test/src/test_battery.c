@@ -7,8 +7,11 @@
 #include <tinytest_macros.h>
 
 #include <pbio/battery.h>
+#include <pbio/os.h>
 #include <test-pbio.h>
 
+#include "../drv/battery/battery_test.h"
+
 // pbdrv_battery_get_voltage_now() always returns this value
 #define TEST_BATTERY_VOLTAGE 7200
 
@@ -36,9 +39,91 @@ static void test_battery_voltage_from_duty_pct(void *env) {
     tt_want_int_op(pbio_battery_get_voltage_from_duty_pct(-100), ==, -TEST_BATTERY_VOLTAGE);
 }
 
+static pbio_error_t test_battery_sag(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static uint32_t i;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Without load, the supply is the battery voltage.
+    pbio_test_battery_set_voltage(8000);
+    pbio_test_battery_set_current(0);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    tt_want_int_op(pbio_battery_get_supply_voltage(), ==, 8000);
+    tt_want_int_op(pbio_battery_get_internal_resistance(), ==, 0);
+
+    // Varying load reveals a resistance of 200 mOhm.
+    for (i = 0; i < 40; i++) {
+        pbio_test_battery_set_voltage(i % 2 ? 7600 : 8000);
+        pbio_test_battery_set_current(i % 2 ? 2000 : 0);
+        PBIO_OS_AWAIT_MS(state, &timer, 50);
+    }
+    tt_want(pbio_test_int_is_close(pbio_battery_get_internal_resistance(), 200, 10));
+
+    // A new load step is followed within a few samples, while the plain
+    // average is still far behind.
+    pbio_test_battery_set_voltage(8000);
+    pbio_test_battery_set_current(0);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    pbio_test_battery_set_voltage(7600);
+    pbio_test_battery_set_current(2000);
+    PBIO_OS_AWAIT_MS(state, &timer, 30);
+    tt_want(pbio_test_int_is_close(pbio_battery_get_supply_voltage(), 7600, 20));
+    tt_want_int_op(pbio_battery_get_average_voltage(), >, 7900);
+    tt_want(pbio_test_int_is_close(pbio_battery_get_duty_from_voltage(3800), PBIO_BATTERY_MAX_DUTY / 2, 2));
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_battery_energy(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static int32_t charge;
+    static uint32_t i;
+    uint32_t runtime;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // One second at 1 A is 278 uAh.
+    pbio_test_battery_set_voltage(8000);
+    pbio_test_battery_set_current(1000);
+    pbio_battery_set_program_running(true);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    tt_want_int_op(pbio_battery_get_program_charge(&charge), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(charge, 278, 2));
+
+    // Nothing is added after the program ends.
+    pbio_battery_set_program_running(false);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    tt_want_int_op(pbio_battery_get_program_charge(&charge), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(charge, 278, 2));
+
+    // Runtime is not known until the voltage has dropped enough.
+    tt_want_int_op(pbio_battery_get_remaining_runtime(6000, &runtime), ==, PBIO_ERROR_AGAIN);
+
+    // Drop 5 mV per second at 1 A. After 42 s in total, the voltage has
+    // dropped by 195 mV, so the remaining 1805 mV last for another 389 s.
+    for (i = 0; i < 40; i++) {
+        pbio_test_battery_set_voltage(8000 - 5 * i);
+        PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    }
+    tt_want_int_op(pbio_battery_get_remaining_runtime(6000, &runtime), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(runtime, 389, 5));
+
+    // Charging starts over.
+    pbio_test_battery_set_current(0);
+    PBIO_OS_AWAIT_MS(state, &timer, 100);
+    tt_want_int_op(pbio_battery_get_remaining_runtime(6000, &runtime), ==, PBIO_ERROR_AGAIN);
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 struct testcase_t pbio_battery_tests[] = {
     PBIO_TEST(test_battery_voltage_to_duty),
     PBIO_TEST(test_battery_voltage_from_duty),
     PBIO_TEST(test_battery_voltage_from_duty_pct),
+    PBIO_THREAD_TEST(test_battery_sag),
+    PBIO_THREAD_TEST(test_battery_energy),
     END_OF_TESTCASES
 };
@@ -0,0 +1,367 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+// Benchmarks for the control loop, drawing and display encoding. These are
+// off by default. Run them with ./bench-pbio.sh, which prints one JSON object
+// per line for each result.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/angle.h>
+#include <pbio/color.h>
+#include <pbio/control.h>
+#include <pbio/drivebase.h>
+#include <pbio/error.h>
+#include <pbio/image.h>
+#include <pbio/int_math.h>
+#include <pbio/light_matrix.h>
+#include <pbio/observer.h>
+#include <pbio/os.h>
+#include <pbio/port_interface.h>
+#include <pbio/servo.h>
+#include <pbio/trajectory.h>
+#include <test-pbio.h>
+
+#include "../drv/clock/clock_test.h"
+#include "../drv/display/display_st7586s.h"
+#include "../drv/led/led_array.h"
+#include "../drv/motor_driver/motor_driver_virtual_simulation.h"
+#include "../drv/pwm/pwm.h"
+
+// Number of control loop ticks per benchmark.
+#define BENCH_NUM_TICKS (10000)
+
+// Number of trajectories computed in the trajectory benchmark.
+#define BENCH_NUM_TRAJECTORIES (100000)
+
+static uint64_t bench_get_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void bench_print_result(const char *name, uint32_t count, uint64_t duration_ns) {
+    printf("{\"name\": \"%s\", \"count\": %u, \"ns_per_call\": %u}\n",
+        name, count, (uint32_t)(duration_ns / count));
+}
+
+static int bench_compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Number of samples for benchmarks with statistics. Each sample times a
+// batch of calls, so that the clock overhead is negligible.
+#define BENCH_NUM_SAMPLES (200)
+
+/**
+ * Prints the median and 99th percentile time per call over all samples.
+ */
+static void bench_print_stats(const char *name, uint32_t calls_per_sample, uint64_t *samples_ns) {
+    qsort(samples_ns, BENCH_NUM_SAMPLES, sizeof(*samples_ns), bench_compare_u64);
+    printf("{\"name\": \"%s\", \"count\": %u, \"ns_per_call\": %.2f, \"p99_ns_per_call\": %.2f}\n",
+        name, calls_per_sample * BENCH_NUM_SAMPLES,
+        (double)samples_ns[BENCH_NUM_SAMPLES / 2] / calls_per_sample,
+        (double)samples_ns[BENCH_NUM_SAMPLES * 99 / 100] / calls_per_sample);
+}
+
+/**
+ * Times the body in BENCH_NUM_SAMPLES batches of @p calls iterations of the
+ * loop variable i, and prints the statistics. This is a macro so the body is
+ * timed without the overhead of a function call.
+ */
+#define BENCH_STATS(name, calls, ...) do { \
+        static uint64_t samples[BENCH_NUM_SAMPLES]; \
+        for (uint32_t s = 0; s < BENCH_NUM_SAMPLES; s++) { \
+            uint64_t start = bench_get_ns(); \
+            for (uint32_t i = 0; i < (calls); i++) { \
+                __VA_ARGS__; \
+            } \
+            samples[s] = bench_get_ns() - start; \
+        } \
+        bench_print_stats(name, calls, samples); \
+} while (0)
+
+static void bench_print_size(const char *name, uint32_t size) {
+    printf("{\"name\": \"sizeof_%s\", \"bytes\": %u}\n", name, size);
+}
+
+/**
+ * Runs the servo and drive base updates directly, advancing the test clock
+ * by one loop time each tick. Only the updates themselves are timed.
+ *
+ * The motor process and simulation do not run in between, since this does
+ * not yield. This keeps the benchmark free of event loop overhead.
+ */
+static uint64_t bench_run_control_ticks(bool drivebase) {
+    uint64_t duration_ns = 0;
+    for (uint32_t i = 0; i < BENCH_NUM_TICKS; i++) {
+        pbio_test_clock_tick(PBIO_CONFIG_CONTROL_LOOP_TIME_MS);
+        uint64_t start = bench_get_ns();
+        pbio_servo_sample_all();
+        if (drivebase) {
+            pbio_drivebase_update_all();
+        }
+        pbio_servo_update_all();
+        duration_ns += bench_get_ns() - start;
+    }
+    return duration_ns;
+}
+
+static pbio_error_t bench_servo_update(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv;
+    static pbio_port_t *port;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, LEGO_DEVICE_TYPE_ID_SPIKE_M_MOTOR, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+
+    // Long maneuver so that every tick evaluates a trajectory.
+    tt_uint_op(pbio_servo_run_angle(srv, 500, 360 * 100, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    bench_print_result("servo_update_all", BENCH_NUM_TICKS, bench_run_control_ticks(false));
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t bench_drivebase_update(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv_left;
+    static pbio_servo_t *srv_right;
+    static pbio_drivebase_t *db;
+    static pbio_port_t *port;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_left), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_left, id, PBIO_DIRECTION_COUNTERCLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_B, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_right), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_right, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_get_drivebase(&db, srv_left, srv_right, 56000, 112000), ==, PBIO_SUCCESS);
+
+    // Long maneuver so that every tick evaluates both trajectories.
+    tt_uint_op(pbio_drivebase_drive_straight(db, 10000, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    bench_print_result("drivebase_update_all", BENCH_NUM_TICKS, bench_run_control_ticks(true));
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static void bench_trajectory(void *env) {
+
+    pbio_trajectory_command_t command = {
+        .speed_max = 1000000,
+        .acceleration = 2000000,
+        .deceleration = 2000000,
+    };
+
+    pbio_trajectory_t trj;
+    pbio_trajectory_reference_t ref;
+    int32_t checksum = 0;
+
+    // Vary the start speed and end point so that all trajectory cases are
+    // visited, including ramps that are cut short.
+    BENCH_STATS("trajectory_new_angle_command", BENCH_NUM_TRAJECTORIES / BENCH_NUM_SAMPLES, {
+        command.position_end.millidegrees = (int32_t)(i % 720) * 1000 - 360000;
+        command.speed_start = (int32_t)(i % 7) * 150000 - 450000;
+        command.speed_target = (int32_t)(i % 5) * 200000 + 100000;
+        command.continue_running = i % 2;
+        tt_want_uint_op(pbio_trajectory_new_angle_command(&trj, &command), ==, PBIO_SUCCESS);
+        checksum += trj.th3;
+    });
+
+    // Evaluate the last trajectory at all control ticks.
+    uint32_t duration = pbio_int_math_min(pbio_trajectory_get_duration(&trj), 100000);
+    uint64_t start = bench_get_ns();
+    for (uint32_t t = 0; t < duration; t++) {
+        pbio_trajectory_get_reference(&trj, t, &ref);
+        checksum += ref.speed;
+    }
+    bench_print_result("trajectory_get_reference", duration, bench_get_ns() - start);
+
+    // Keeps the compiler from optimizing the loops away.
+    tt_want_int_op(checksum, !=, INT32_MIN);
+}
+
+static void bench_int_math(void *env) {
+    int32_t checksum = 0;
+
+    BENCH_STATS("int_math_sqrt", 1000, checksum += pbio_int_math_sqrt(i * 2147));
+    BENCH_STATS("int_math_atan2", 1000, checksum += pbio_int_math_atan2((int32_t)(i % 64) - 32, (int32_t)(i / 64) - 8));
+    BENCH_STATS("int_math_mult_then_div", 1000, checksum += pbio_int_math_mult_then_div(i * 12345, 1000 - i, i + 1));
+
+    // Keeps the compiler from optimizing the loops away.
+    tt_want_int_op(checksum, !=, INT32_MIN);
+}
+
+static void bench_color(void *env) {
+    pbio_color_rgb_t rgb;
+    pbio_color_hsv_t hsv;
+    int32_t checksum = 0;
+
+    BENCH_STATS("color_rgb_to_hsv", 1000, {
+        rgb.r = i;
+        rgb.g = i * 7;
+        rgb.b = i * 13;
+        pbio_color_rgb_to_hsv(&rgb, &hsv);
+        checksum += hsv.h;
+    });
+
+    tt_want_int_op(checksum, !=, INT32_MIN);
+}
+
+static void bench_light_matrix(void *env) {
+    pbio_light_matrix_t *light_matrix;
+    uint8_t rows[3];
+
+    pbdrv_pwm_init();
+    pbdrv_led_array_init();
+    tt_want_uint_op(pbio_light_matrix_get_dev(0, sizeof(rows), &light_matrix), ==, PBIO_SUCCESS);
+
+    BENCH_STATS("light_matrix_set_rows", 100, {
+        rows[i % sizeof(rows)] = i;
+        pbio_light_matrix_set_rows(light_matrix, rows);
+    });
+}
+
+static void bench_memory(void *env) {
+    bench_print_size("pbio_servo_t", sizeof(pbio_servo_t));
+    bench_print_size("pbio_drivebase_t", sizeof(pbio_drivebase_t));
+    bench_print_size("pbio_control_t", sizeof(pbio_control_t));
+    bench_print_size("pbio_observer_t", sizeof(pbio_observer_t));
+    bench_print_size("pbio_trajectory_t", sizeof(pbio_trajectory_t));
+}
+
+// Frame size of the EV3 display in pixels and column triplets.
+#define BENCH_DISPLAY_ROWS (128)
+#define BENCH_DISPLAY_TRIPLETS (60)
+
+// Number of frames encoded in the display benchmark.
+#define BENCH_NUM_FRAMES (2000)
+
+static void bench_display_encode(void *env) {
+    static uint8_t frame[BENCH_DISPLAY_ROWS][BENCH_DISPLAY_TRIPLETS * 3 / 4];
+    static uint8_t encoded[BENCH_DISPLAY_ROWS * BENCH_DISPLAY_TRIPLETS];
+    pbdrv_display_st7586s_window_t window;
+
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        (&frame[0][0])[i] = i * 37;
+    }
+
+    // Every pixel is encoded and written.
+    uint64_t start = bench_get_ns();
+    for (uint32_t i = 0; i < BENCH_NUM_FRAMES; i++) {
+        pbdrv_display_st7586s_encode(&frame[0][0], sizeof(frame[0]), encoded, BENCH_DISPLAY_ROWS, BENCH_DISPLAY_TRIPLETS, true, &window);
+    }
+    bench_print_result("display_st7586s_encode_full", BENCH_NUM_FRAMES, bench_get_ns() - start);
+
+    // One pixel changes each frame, as for a changing number.
+    start = bench_get_ns();
+    for (uint32_t i = 0; i < BENCH_NUM_FRAMES; i++) {
+        frame[60][22] ^= 1 << 4;
+        pbdrv_display_st7586s_encode(&frame[0][0], sizeof(frame[0]), encoded, BENCH_DISPLAY_ROWS, BENCH_DISPLAY_TRIPLETS, false, &window);
+    }
+    bench_print_result("display_st7586s_encode_changed", BENCH_NUM_FRAMES, bench_get_ns() - start);
+}
+
+static void bench_image_format(const char *name, pbio_image_format_t format) {
+    static uint8_t pixels[2][BENCH_DISPLAY_ROWS][BENCH_DISPLAY_TRIPLETS * 3];
+    pbio_image_t image, source;
+    char result_name[48];
+    int width = BENCH_DISPLAY_TRIPLETS * 3 - 2;
+    int stride = pbio_image_get_min_stride(format, width);
+
+    pbio_image_init_format(&image, &pixels[0][0][0], width, BENCH_DISPLAY_ROWS, stride, format);
+    pbio_image_init_format(&source, &pixels[1][0][0], width, BENCH_DISPLAY_ROWS, stride, format);
+
+    // Clearing the screen.
+    uint64_t start = bench_get_ns();
+    for (uint32_t i = 0; i < BENCH_NUM_FRAMES; i++) {
+        pbio_image_fill(&image, i % 4);
+    }
+    snprintf(result_name, sizeof(result_name), "image_fill_%s", name);
+    bench_print_result(result_name, BENCH_NUM_FRAMES, bench_get_ns() - start);
+
+    // Drawing a full screen image, such as a background.
+    start = bench_get_ns();
+    for (uint32_t i = 0; i < BENCH_NUM_FRAMES; i++) {
+        pbio_image_draw_image(&image, &source, 0, 0);
+    }
+    snprintf(result_name, sizeof(result_name), "image_draw_image_%s", name);
+    bench_print_result(result_name, BENCH_NUM_FRAMES, bench_get_ns() - start);
+
+    // Drawing a full screen sprite.
+    start = bench_get_ns();
+    for (uint32_t i = 0; i < BENCH_NUM_FRAMES; i++) {
+        pbio_image_draw_image_transparent(&image, &source, 0, 0, 0);
+    }
+    snprintf(result_name, sizeof(result_name), "image_draw_image_transparent_%s", name);
+    bench_print_result(result_name, BENCH_NUM_FRAMES, bench_get_ns() - start);
+
+    // Drawing one line of text at a time.
+    snprintf(result_name, sizeof(result_name), "image_draw_text_%s", name);
+    BENCH_STATS(result_name, 10, {
+        pbio_image_draw_text(&image, &pbio_font_terminus_normal_16, 0, 16 + i * 10,
+            "Pybricks 0123456789", 19, 3);
+    });
+
+    bench_print_size(name, stride * BENCH_DISPLAY_ROWS);
+}
+
+static void bench_image(void *env) {
+    bench_image_format("8bpp", PBIO_IMAGE_FORMAT_8BPP);
+    bench_image_format("2bpp", PBIO_IMAGE_FORMAT_2BPP);
+}
+
+// Number of loop iterations per sample in the event loop hook benchmark.
+#define BENCH_NUM_HOOK_CALLS (10000)
+
+/**
+ * Times the check for pending events that MicroPython does on each backward
+ * jump of the bytecode, when there is nothing to do. This is the overhead of
+ * tight Python loops.
+ */
+static void bench_os_hook_loop(void *env) {
+    BENCH_STATS("os_hook_loop_call", BENCH_NUM_HOOK_CALLS, {
+        pbio_os_run_processes_once();
+    });
+    BENCH_STATS("os_hook_loop_inline", BENCH_NUM_HOOK_CALLS, {
+        pbio_os_run_processes_if_pending();
+    });
+}
+
+#define PBIO_BENCHMARK(name) \
+    { #name, name, TT_FORK | TT_OFF_BY_DEFAULT, NULL, NULL }
+
+#define PBIO_THREAD_BENCHMARK(name) \
+    { #name, pbio_test_run_thread, TT_FORK | TT_OFF_BY_DEFAULT, &pbio_test_setup, name }
+
+struct testcase_t pbio_benchmarks[] = {
+    PBIO_THREAD_BENCHMARK(bench_servo_update),
+    PBIO_THREAD_BENCHMARK(bench_drivebase_update),
+    PBIO_BENCHMARK(bench_trajectory),
+    PBIO_BENCHMARK(bench_int_math),
+    PBIO_BENCHMARK(bench_color),
+    PBIO_BENCHMARK(bench_light_matrix),
+    PBIO_BENCHMARK(bench_memory),
+    PBIO_BENCHMARK(bench_display_encode),
+    PBIO_BENCHMARK(bench_image),
+    PBIO_BENCHMARK(bench_os_hook_loop),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pbio/clock_sync.h>
+#include <pbio/int_math.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+// Remote clock that runs 100 ppm faster than the local clock.
+static uint32_t remote_clock(uint32_t local_time) {
+    return 5000 + local_time + local_time / 10000;
+}
+
+static void test_clock_sync_drift(void *env) {
+    pbio_clock_sync_t sync;
+    pbio_clock_sync_reset(&sync);
+
+    // Without timestamps, the local time is used.
+    tt_want(!pbio_clock_sync_is_synced(&sync));
+    tt_want_uint_op(pbio_clock_sync_get_remote_time(&sync, 1234), ==, 1234);
+
+    // Send a timestamp every 50 ms, each arriving 3 to 82 ms later.
+    uint32_t seed = 1;
+    uint32_t local_time;
+    for (local_time = 0; local_time < 120000; local_time += 50) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t delay = 3 + (seed >> 16) % 80;
+        pbio_clock_sync_add_sample(&sync, local_time + delay, remote_clock(local_time));
+
+        // Usable right away, albeit with the delay of the first timestamp.
+        tt_want(pbio_clock_sync_is_synced(&sync));
+    }
+
+    // Estimate is behind by about the shortest delay, also a bit later.
+    int32_t error = remote_clock(local_time) - pbio_clock_sync_get_remote_time(&sync, local_time);
+    tt_want_int_op(error, >=, 0);
+    tt_want_int_op(error, <=, 8);
+    error = remote_clock(local_time + 10000) - pbio_clock_sync_get_remote_time(&sync, local_time + 10000);
+    tt_want_int_op(pbio_int_math_abs(error), <=, 8);
+    tt_want_int_op(pbio_int_math_abs(sync.drift - 100), <=, 50);
+
+    // Start over when the remote restarts.
+    pbio_clock_sync_add_sample(&sync, local_time, 10);
+    tt_want_uint_op(pbio_clock_sync_get_remote_time(&sync, local_time + 100), ==, 110);
+    tt_want_int_op(sync.drift, ==, 0);
+}
+
+struct testcase_t pbio_clock_sync_tests[] = {
+    PBIO_TEST(test_clock_sync_drift),
+    END_OF_TESTCASES
+};
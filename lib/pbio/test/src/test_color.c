@@ -607,6 +607,20 @@ static void test_color_hsv_cost(void *env) {
     dist = pbio_color_get_distance_bicone_squared(&color_a, &color_b);
     tt_want_int_op(dist, >, 390000000);
     tt_want_int_op(dist, <, 410000000);
+
+    // precomputed bicone coordinates should give the same distance
+    color_a.h = 230;
+    color_a.s = 40;
+    color_a.v = 70;
+
+    color_b.h = 23;
+    color_b.s = 99;
+    color_b.v = 30;
+    pbio_color_bicone_t bicone_a, bicone_b;
+    pbio_color_hsv_to_bicone(&color_a, &bicone_a);
+    pbio_color_hsv_to_bicone(&color_b, &bicone_b);
+    tt_want_int_op(pbio_color_bicone_get_distance_squared(&bicone_a, &bicone_b), ==,
+        pbio_color_get_distance_bicone_squared(&color_a, &color_b));
 }
 
 struct testcase_t pbio_color_tests[] = {
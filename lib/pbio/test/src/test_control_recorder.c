@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pbio/control_recorder.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+static void add_samples(uint32_t count, int32_t position_error, uint8_t status) {
+    for (uint32_t i = 0; i < count; i++) {
+        pbio_control_recorder_sample_t sample = {
+            .time = i,
+            .position_error = position_error,
+            .status = status,
+        };
+        pbio_control_recorder_add(&sample);
+    }
+}
+
+static void test_control_recorder(void *env) {
+    pbio_control_recorder_sample_t samples[PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES];
+
+    // Nothing is recorded until started.
+    add_samples(1, 0, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_IDLE);
+    tt_want_uint_op(pbio_control_recorder_get_samples(samples, 1), ==, 0);
+
+    // Keeps recording while armed, overwriting the oldest samples.
+    pbio_control_recorder_start(PBIO_CONTROL_RECORDER_TRIGGER_STALL | PBIO_CONTROL_RECORDER_TRIGGER_ERROR, 10, 3);
+    add_samples(PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES + 5, 10, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_ARMED);
+    tt_want_uint_op(pbio_control_recorder_get_samples(samples, PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES), ==, PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES);
+    tt_want_uint_op(samples[0].time, ==, 5);
+
+    // Error beyond the threshold triggers, then three more samples are kept.
+    add_samples(1, -11, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_TRIGGERED);
+    add_samples(2, 0, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_TRIGGERED);
+    add_samples(5, 0, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_DONE);
+
+    tt_want_uint_op(pbio_control_recorder_get_samples(samples, 4), ==, 4);
+    tt_want_int_op(samples[0].position_error, ==, -11);
+    tt_want_uint_op(samples[2].time, ==, 1);
+    tt_want_uint_op(samples[3].time, ==, 0);
+
+    // Stall triggers if selected, and stops immediately with no samples after.
+    pbio_control_recorder_start(PBIO_CONTROL_RECORDER_TRIGGER_STALL, 0, 0);
+    add_samples(2, 100, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_ARMED);
+    add_samples(1, 0, PBIO_CONTROL_STATUS_STALLED);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_DONE);
+    tt_want_uint_op(pbio_control_recorder_get_samples(samples, PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES), ==, 3);
+
+    // Manual trigger.
+    pbio_control_recorder_start(0, 0, 1);
+    add_samples(1, 0, PBIO_CONTROL_STATUS_STALLED);
+    pbio_control_recorder_trigger();
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_TRIGGERED);
+    add_samples(1, 0, 0);
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_DONE);
+
+    pbio_control_recorder_stop();
+    tt_want_uint_op(pbio_control_recorder_get_state(), ==, PBIO_CONTROL_RECORDER_STATE_IDLE);
+}
+
+struct testcase_t pbio_control_recorder_tests[] = {
+    PBIO_TEST(test_control_recorder),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <pbio/config.h>
+#include <pbio/differentiator.h>
+#include <pbio/util.h>
+
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#define NUM_SAMPLES (500)
+
+static void test_differentiator_speed(void *env) {
+    static pbio_differentiator_t dif;
+    static int32_t increments[NUM_SAMPLES];
+
+    pbio_angle_t angle = { .rotations = 3, .millidegrees = 12345 };
+    pbio_differentiator_reset(&dif, &angle);
+
+    srand(0);
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        // Random speeds with a few jumps, including a full stop halfway.
+        increments[i] = i > NUM_SAMPLES / 2 && i < NUM_SAMPLES / 2 + 30 ? 0 : rand() % 20000 - 10000;
+        pbio_angle_add_mdeg(&angle, increments[i]);
+        int32_t speed = pbio_differentiator_update_and_get_speed(&dif, &angle);
+
+        // Compare to the average across the default window.
+        int32_t total = 0;
+        for (int j = i; j >= 0 && j > i - PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE; j--) {
+            total += increments[j];
+        }
+        tt_want_int_op(speed, ==, total * (1000 / PBIO_CONFIG_CONTROL_LOOP_TIME_MS) / PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE);
+
+        // Compare custom windows, including the longest one.
+        int32_t windows[] = { 1, 7, PBIO_CONFIG_DIFFERENTIATOR_WINDOW_SIZE, PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE - 1 };
+        for (size_t w = 0; w < PBIO_ARRAY_SIZE(windows); w++) {
+            total = 0;
+            for (int j = i; j >= 0 && j > i - windows[w]; j--) {
+                total += increments[j];
+            }
+            tt_want_int_op(pbio_differentiator_get_speed(&dif, windows[w] * PBIO_CONFIG_CONTROL_LOOP_TIME_MS, &speed), ==, PBIO_SUCCESS);
+            tt_want_int_op(speed, ==, total * (1000 / PBIO_CONFIG_CONTROL_LOOP_TIME_MS) / windows[w]);
+        }
+    }
+
+    // Windows that do not fit are rejected.
+    int32_t speed;
+    tt_want_int_op(pbio_differentiator_get_speed(&dif, 0, &speed), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_int_op(pbio_differentiator_get_speed(&dif, PBIO_CONFIG_DIFFERENTIATOR_BUFFER_SIZE * PBIO_CONFIG_CONTROL_LOOP_TIME_MS, &speed), ==, PBIO_ERROR_INVALID_ARG);
+
+    // Speed is zero after reset.
+    pbio_differentiator_reset(&dif, &angle);
+    tt_want_int_op(pbio_differentiator_update_and_get_speed(&dif, &angle), ==, 0);
+}
+
+struct testcase_t pbio_differentiator_tests[] = {
+    PBIO_TEST(test_differentiator_speed),
+    END_OF_TESTCASES
+};
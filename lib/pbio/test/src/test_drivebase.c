@@ -24,6 +24,7 @@
 #include <pbio/motor_process.h>
 #include <pbio/port_interface.h>
 #include <pbio/servo.h>
+#include <pbio/util.h>
 #include <test-pbio.h>
 
 #include "../drv/clock/clock_test.h"
@@ -239,8 +240,209 @@ end:
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+static pbio_error_t test_drivebase_path(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv_left;
+    static pbio_servo_t *srv_right;
+    static pbio_drivebase_t *db;
+    static pbio_port_t *port;
+
+    static int32_t drive_distance_start;
+    static int32_t drive_distance;
+    static int32_t drive_speed;
+    static int32_t turn_angle_start;
+    static int32_t turn_angle;
+    static int32_t turn_rate;
+
+    // Straight, quarter circle to the right, straight, quarter circle to the left.
+    static const pbio_drivebase_path_segment_t segments[] = {
+        { .radius = 0, .distance = 200 },
+        { .radius = 200, .distance = 314 },
+        { .radius = 0, .distance = 200 },
+        { .radius = -200, .distance = 314 },
+    };
+    static const pbio_drivebase_path_segment_t invalid[] = {
+        { .radius = 5, .distance = 100 },
+    };
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_left), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_left, id, PBIO_DIRECTION_COUNTERCLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_B, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_right), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_right, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_get_drivebase(&db, srv_left, srv_right, 56000, 112000), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_get_state_user(db, &drive_distance_start, &drive_speed, &turn_angle_start, &turn_rate), ==, PBIO_SUCCESS);
+
+    tt_uint_op(pbio_drivebase_drive_path(db, invalid, PBIO_ARRAY_SIZE(invalid), PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_ERROR_INVALID_ARG);
+    tt_uint_op(pbio_drivebase_drive_path(db, segments, PBIO_ARRAY_SIZE(segments), PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_want(!pbio_drivebase_is_done(db));
+
+    // Going from the first straight into the first arc should not slow down.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_get_state_user(db, &drive_distance, &drive_speed, &turn_angle, &turn_rate) == PBIO_SUCCESS &&
+        drive_distance - drive_distance_start >= 200);
+    tt_want_int_op(drive_speed, >, 100);
+
+    // Halfway the second straight, it should have turned a quarter circle.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_get_state_user(db, &drive_distance, &drive_speed, &turn_angle, &turn_rate) == PBIO_SUCCESS &&
+        drive_distance - drive_distance_start >= 614);
+    tt_want(pbio_test_int_is_close(turn_angle, turn_angle_start + 90, 5));
+    tt_want(pbio_test_int_is_close(turn_rate, 0, 10));
+    tt_want_int_op(drive_speed, >, 100);
+
+    // The last arc turns back to the original heading.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_is_done(db));
+    tt_uint_op(pbio_drivebase_get_state_user(db, &drive_distance, &drive_speed, &turn_angle, &turn_rate), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(drive_distance, drive_distance_start + 1028, 20));
+    tt_want(pbio_test_int_is_close(turn_angle, turn_angle_start, 5));
+
+    // A new command discards the path.
+    tt_uint_op(pbio_drivebase_drive_path(db, segments, PBIO_ARRAY_SIZE(segments), PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_drive_straight(db, 0, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_uint_op(db->path_size, ==, 0);
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_drivebase_odometry(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv_left;
+    static pbio_servo_t *srv_right;
+    static pbio_drivebase_t *db;
+    static pbio_port_t *port;
+
+    static float x;
+    static float y;
+    static float heading;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_left), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_left, id, PBIO_DIRECTION_COUNTERCLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_B, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_right), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_right, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_get_drivebase(&db, srv_left, srv_right, 56000, 112000), ==, PBIO_SUCCESS);
+
+    // Starts at the origin.
+    tt_uint_op(pbio_drivebase_get_pose(db, &x, &y, &heading), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(x, 0, 1));
+    tt_want(pbio_test_int_is_close(y, 0, 1));
+
+    // Drive forward, turn right and drive forward again.
+    tt_uint_op(pbio_drivebase_drive_straight(db, 500, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_is_done(db));
+    tt_uint_op(pbio_drivebase_drive_turn(db, 90, false, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_is_done(db));
+    tt_uint_op(pbio_drivebase_drive_straight(db, 300, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_is_done(db));
+
+    tt_uint_op(pbio_drivebase_get_pose(db, &x, &y, &heading), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(x, 500, 10));
+    tt_want(pbio_test_int_is_close(y, 300, 10));
+    tt_want(pbio_test_int_is_close(heading, 90, 3));
+
+    // An arc ends up at the radius away along both axes.
+    tt_uint_op(pbio_drivebase_drive_arc_angle(db, -200, 90, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_is_done(db));
+    tt_uint_op(pbio_drivebase_get_pose(db, &x, &y, &heading), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(x, 700, 10));
+    tt_want(pbio_test_int_is_close(y, 500, 10));
+    tt_want(pbio_test_int_is_close(heading, 0, 3));
+
+    // Reset starts a new pose.
+    tt_uint_op(pbio_drivebase_reset(db, 0, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_get_pose(db, &x, &y, &heading), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(x, 0, 1));
+    tt_want(pbio_test_int_is_close(y, 0, 1));
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_drivebase_skid_steer(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv_left[2];
+    static pbio_servo_t *srv_right[2];
+    static pbio_drivebase_t *db;
+    static pbio_port_t *port;
+
+    static int32_t drive_distance_start;
+    static int32_t drive_distance;
+    static int32_t drive_speed;
+    static int32_t turn_angle_start;
+    static int32_t turn_angle;
+    static int32_t turn_rate;
+    static int32_t angle_front;
+    static int32_t angle_rear;
+    static int32_t speed;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_left[0]), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_left[0], id, PBIO_DIRECTION_COUNTERCLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_E, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_left[1]), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_left[1], id, PBIO_DIRECTION_COUNTERCLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_B, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_right[0]), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_right[0], id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_F, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv_right[1]), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv_right[1], id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+
+    // Each motor can be used only once.
+    pbio_servo_t *duplicate[] = { srv_left[0], srv_right[0] };
+    tt_uint_op(pbio_drivebase_get_drivebase_multi(&db, duplicate, srv_right, 2, 56000, 112000), ==, PBIO_ERROR_INVALID_ARG);
+
+    tt_uint_op(pbio_drivebase_get_drivebase_multi(&db, srv_left, srv_right, 2, 56000, 112000), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_drivebase_get_state_user(db, &drive_distance_start, &drive_speed, &turn_angle_start, &turn_rate), ==, PBIO_SUCCESS);
+
+    // All motors are driven together. The simulated motors are not coupled
+    // by the ground and they are of different types, so they are not equally
+    // far along.
+    tt_uint_op(pbio_drivebase_drive_straight(db, 300, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_get_state_user(db, &drive_distance, &drive_speed, &turn_angle, &turn_rate) == PBIO_SUCCESS &&
+        drive_distance - drive_distance_start >= 150);
+    tt_uint_op(pbio_servo_get_state_user(srv_right[0], &angle_front, &speed), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_get_state_user(srv_right[1], &angle_rear, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(angle_front, >, 100);
+    tt_want_int_op(angle_rear, >, 100);
+    tt_want_int_op(speed, >, 100);
+
+    PBIO_OS_AWAIT_UNTIL(state, pbio_drivebase_is_done(db));
+    tt_uint_op(pbio_drivebase_get_state_user(db, &drive_distance, &drive_speed, &turn_angle, &turn_rate), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(drive_distance, drive_distance_start + 300, 5));
+    tt_want(pbio_test_int_is_close(turn_angle, turn_angle_start, 5));
+
+    // A command to one of the motors stops the whole drive base.
+    tt_uint_op(pbio_drivebase_drive_forever(db, 200, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_stop(srv_left[1], PBIO_CONTROL_ON_COMPLETION_COAST), ==, PBIO_SUCCESS);
+    tt_want(!pbio_control_is_active(&db->control_distance));
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 struct testcase_t pbio_drivebase_tests[] = {
     PBIO_THREAD_TEST(test_drivebase_basics),
     PBIO_THREAD_TEST(test_drivebase_stalling),
+    PBIO_THREAD_TEST(test_drivebase_path),
+    PBIO_THREAD_TEST(test_drivebase_odometry),
+    PBIO_THREAD_TEST(test_drivebase_skid_steer),
     END_OF_TESTCASES
 };
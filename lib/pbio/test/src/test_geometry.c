@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <pbio/geometry.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+static bool float_is_close(float a, float b) {
+    return fabsf(a - b) < 1e-5f;
+}
+
+// Arbitrary map with mostly distinct entries.
+static pbio_geometry_matrix_3x3_t test_map = {
+    .m11 = 0.0f, .m12 = -1.0f, .m13 = 0.5f,
+    .m21 = 1.0f, .m22 = 0.0f, .m23 = 0.25f,
+    .m31 = 0.125f, .m32 = 2.0f, .m33 = 1.0f,
+};
+
+static void test_vector_map_array(void *env) {
+
+    pbio_geometry_xyz_t points[] = {
+        { .x = 1.0f, .y = 0.0f, .z = 0.0f },
+        { .x = 0.0f, .y = 1.0f, .z = 0.0f },
+        { .x = 1.0f, .y = 2.0f, .z = 3.0f },
+    };
+    pbio_geometry_xyz_t mapped[3];
+
+    pbio_geometry_vector_map_array(&test_map, points, mapped, 3);
+
+    // Each point is mapped as by the single vector version.
+    for (size_t i = 0; i < 3; i++) {
+        pbio_geometry_xyz_t expected = {
+            .x = points[i].x * test_map.m11 + points[i].y * test_map.m12 + points[i].z * test_map.m13,
+            .y = points[i].x * test_map.m21 + points[i].y * test_map.m22 + points[i].z * test_map.m23,
+            .z = points[i].x * test_map.m31 + points[i].y * test_map.m32 + points[i].z * test_map.m33,
+        };
+        tt_want(float_is_close(mapped[i].x, expected.x));
+        tt_want(float_is_close(mapped[i].y, expected.y));
+        tt_want(float_is_close(mapped[i].z, expected.z));
+    }
+
+    // Mapping in place gives the same result.
+    pbio_geometry_vector_map_array(&test_map, points, points, 3);
+    for (size_t i = 0; i < 3; i++) {
+        tt_want(float_is_close(points[i].x, mapped[i].x));
+        tt_want(float_is_close(points[i].y, mapped[i].y));
+        tt_want(float_is_close(points[i].z, mapped[i].z));
+    }
+}
+
+static void test_matrix_multiply(void *env) {
+
+    pbio_geometry_matrix_3x3_t product;
+    pbio_geometry_matrix_multiply(&test_map, &test_map, &product);
+
+    for (size_t r = 0; r < 3; r++) {
+        for (size_t c = 0; c < 3; c++) {
+            float expected = 0;
+            for (size_t k = 0; k < 3; k++) {
+                expected += test_map.values[r * 3 + k] * test_map.values[k * 3 + c];
+            }
+            tt_want(float_is_close(product.values[r * 3 + c], expected));
+        }
+    }
+
+    // The output may be the same as one of the inputs.
+    pbio_geometry_matrix_3x3_t a = test_map;
+    pbio_geometry_matrix_multiply(&a, &test_map, &a);
+    for (size_t i = 0; i < 9; i++) {
+        tt_want(float_is_close(a.values[i], product.values[i]));
+    }
+}
+
+static void test_quaternion_to_rotation_matrix(void *env) {
+
+    // Rotation of 90 degrees about Z.
+    pbio_geometry_quaternion_t q = { .q1 = 0.0f, .q2 = 0.0f, .q3 = sqrtf(0.5f), .q4 = sqrtf(0.5f) };
+    pbio_geometry_matrix_3x3_t R;
+    pbio_geometry_quaternion_to_rotation_matrix(&q, &R);
+
+    pbio_geometry_matrix_3x3_t expected = {
+        .m11 = 0.0f, .m12 = -1.0f, .m13 = 0.0f,
+        .m21 = 1.0f, .m22 = 0.0f, .m23 = 0.0f,
+        .m31 = 0.0f, .m32 = 0.0f, .m33 = 1.0f,
+    };
+    for (size_t i = 0; i < 9; i++) {
+        tt_want(float_is_close(R.values[i], expected.values[i]));
+    }
+
+    // Normalizing gives unit length.
+    q = (pbio_geometry_quaternion_t) { .q1 = 1.0f, .q2 = 2.0f, .q3 = 2.0f, .q4 = 4.0f };
+    pbio_geometry_quaternion_normalize(&q);
+    tt_want(float_is_close(q.q1, 0.2f));
+    tt_want(float_is_close(q.q4, 0.8f));
+}
+
+struct testcase_t pbio_geometry_tests[] = {
+    PBIO_TEST(test_vector_map_array),
+    PBIO_TEST(test_matrix_multiply),
+    PBIO_TEST(test_quaternion_to_rotation_matrix),
+    END_OF_TESTCASES
+};
@@ -998,6 +998,170 @@ static void test_image_print(void *env) {
         "..*.......*.*****..."
         "......*...*.*......."
         "..*....***...***....");
+
+    // Printing many lines at once scrolls the same as printing one character
+    // at a time, for whole images and for sub-images.
+    static const char text[] = "1\n22\n333\n4444 55555 666666\n7\n88";
+    static uint8_t pixels[3][SMALL_IMAGE_HEIGHT * 3][SMALL_IMAGE_WIDTH];
+    pbio_image_t whole, single, outer, sub;
+    pbio_image_init(&whole, &pixels[0][0][0], SMALL_IMAGE_WIDTH, SMALL_IMAGE_HEIGHT * 3, SMALL_IMAGE_WIDTH);
+    pbio_image_init(&single, &pixels[1][0][0], SMALL_IMAGE_WIDTH, SMALL_IMAGE_HEIGHT * 3, SMALL_IMAGE_WIDTH);
+    pbio_image_init(&outer, &pixels[2][0][0], SMALL_IMAGE_WIDTH, SMALL_IMAGE_HEIGHT * 3, SMALL_IMAGE_WIDTH);
+    pbio_image_init_sub(&sub, &outer, 0, 0, SMALL_IMAGE_WIDTH - 1, SMALL_IMAGE_HEIGHT * 3);
+    pbio_image_t *images[] = { &whole, &single, &sub };
+    for (size_t i = 0; i < 3; i++) {
+        pbio_image_fill(images[i], '.');
+        images[i]->print_font = &pbio_font_mono_8x5_8;
+        images[i]->print_value = '*';
+    }
+    pbio_image_draw_pixel(&outer, SMALL_IMAGE_WIDTH - 1, 0, '.');
+    pbio_image_print0(&whole, text);
+    for (size_t i = 0; i < sizeof(text) - 1; i++) {
+        pbio_image_print(&single, &text[i], 1);
+    }
+    pbio_image_print0(&sub, text);
+    tt_want(!memcmp(pixels[0], pixels[1], sizeof(pixels[0])));
+    tt_want_int_op(whole.print_y_top, ==, single.print_y_top);
+    tt_want_int_op(whole.print_x_left, ==, single.print_x_left);
+    bool equal = true;
+    for (int y = 0; y < SMALL_IMAGE_HEIGHT * 3; y++) {
+        equal &= !memcmp(pixels[0][y], pixels[2][y], SMALL_IMAGE_WIDTH - 1);
+        equal &= pixels[2][y][SMALL_IMAGE_WIDTH - 1] == (y ? 0 : '.');
+    }
+    tt_want_msg(equal, "sub-image print differs");
+}
+
+// Packed images are compared against a one byte per pixel reference image
+// with the same drawing. Drawing is done in sub-images that do not start on a
+// byte boundary, so the outer pixels must be untouched. Stamps are drawn at
+// positions with both the same and a different alignment inside bytes.
+#define PACKED_IMAGE_WIDTH 53
+#define PACKED_IMAGE_HEIGHT 31
+#define PACKED_SUB_X 3
+#define PACKED_SUB_Y 2
+
+static void test_image_packed_draw(pbio_image_t *image, const pbio_image_t *stamp,
+    const pbio_image_t *packed_stamp, uint8_t max) {
+    pbio_image_fill(image, 1 % (max + 1));
+    for (int x = -5; x < PACKED_IMAGE_WIDTH; x += 3) {
+        pbio_image_draw_hline(image, x, x / 2, x % 11 + 1, x % (max + 1));
+    }
+    // Printing scrolls the lines drawn so far.
+    image->print_font = &pbio_font_liberationsans_regular_14;
+    image->print_value = max;
+    pbio_image_print0(image, "Packed\n1\n22\n");
+    pbio_image_fill_rect(image, 7, 9, 20, 5, max);
+    pbio_image_draw_line(image, -3, 28, 45, 2, max);
+    pbio_image_draw_circle(image, 30, 15, 9, 0);
+    pbio_image_draw_image(image, stamp, 38, 3);
+    pbio_image_draw_image(image, packed_stamp, 2, 20);
+    pbio_image_draw_image(image, packed_stamp, 40, 18);
+    pbio_image_draw_image_transparent(image, packed_stamp, 14, 24, 0);
+    pbio_image_draw_image_transparent(image, packed_stamp, 2, 10, 1);
+    pbio_image_draw_vline(image, 5, -2, 20, max);
+    static const uint8_t mono_data[] = { 0xf0, 0x3c, 0x0f, 0xa5, 0x5a, 0xff, 0x00 };
+    static const pbio_image_monochrome_t mono = { 11, 5, mono_data };
+    pbio_image_draw_image_transparent_from_monochrome(image, &mono, -3, 15, max);
+    pbio_image_draw_image_transparent_from_monochrome(image, &mono, 20, 1, 0);
+}
+
+static void test_image_packed(void *env) {
+    static uint8_t reference_pixels[PACKED_IMAGE_HEIGHT][PACKED_IMAGE_WIDTH];
+    static uint8_t packed_pixels[PACKED_IMAGE_HEIGHT][PACKED_IMAGE_WIDTH];
+    static uint8_t stamp_pixels[8][8];
+    pbio_image_t reference, packed, reference_sub, packed_sub, stamp, packed_stamp;
+
+    static const pbio_image_format_t formats[] = {
+        PBIO_IMAGE_FORMAT_1BPP,
+        PBIO_IMAGE_FORMAT_2BPP,
+    };
+
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        pbio_image_format_t format = formats[i];
+        uint8_t max = (1 << (1 << format)) - 1;
+        int stride = pbio_image_get_min_stride(format, PACKED_IMAGE_WIDTH);
+
+        pbio_image_init(&reference, &reference_pixels[0][0],
+            PACKED_IMAGE_WIDTH, PACKED_IMAGE_HEIGHT, PACKED_IMAGE_WIDTH);
+        pbio_image_init_format(&packed, &packed_pixels[0][0],
+            PACKED_IMAGE_WIDTH, PACKED_IMAGE_HEIGHT, stride, format);
+        pbio_image_fill(&reference, max);
+        pbio_image_fill(&packed, max);
+        tt_want_int_op(pbio_image_get_pixel(&packed, PACKED_IMAGE_WIDTH - 1, 0), ==, max);
+
+        // Values that do not fit are clamped.
+        pbio_image_draw_pixel(&packed, 0, 0, 200);
+        tt_want_int_op(pbio_image_get_pixel(&packed, 0, 0), ==, max);
+
+        // Stamps in both formats, drawn from the reference image.
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                stamp_pixels[y][x] = (x * y + x) % (max + 1);
+            }
+        }
+        pbio_image_init(&stamp, &stamp_pixels[0][0], 8, 8, 8);
+        pbio_image_init_sub(&packed_stamp, &packed, 45, 20, 8, 8);
+        pbio_image_draw_image(&packed_stamp, &stamp, 0, 0);
+        pbio_image_init_sub(&reference_sub, &reference, 45, 20, 8, 8);
+        pbio_image_draw_image(&reference_sub, &stamp, 0, 0);
+
+        pbio_image_init_sub(&reference_sub, &reference, PACKED_SUB_X,
+            PACKED_SUB_Y, PACKED_IMAGE_WIDTH - 12, PACKED_IMAGE_HEIGHT - 4);
+        pbio_image_init_sub(&packed_sub, &packed, PACKED_SUB_X,
+            PACKED_SUB_Y, PACKED_IMAGE_WIDTH - 12, PACKED_IMAGE_HEIGHT - 4);
+        test_image_packed_draw(&reference_sub, &stamp, &packed_stamp, max);
+        test_image_packed_draw(&packed_sub, &stamp, &packed_stamp, max);
+
+        bool equal = true;
+        for (int y = 0; y < PACKED_IMAGE_HEIGHT; y++) {
+            for (int x = 0; x < PACKED_IMAGE_WIDTH; x++) {
+                equal &= pbio_image_get_pixel(&packed, x, y) == reference_pixels[y][x];
+            }
+        }
+        tt_want_msg(equal, "packed image differs from reference");
+    }
+}
+
+// Run-length encoded images must draw the same as bit-packed images, also
+// when clipped on any side.
+static void test_image_rle(void *env) {
+    static uint8_t packed_pixels[20][24];
+    static uint8_t rle_pixels[20][24];
+    pbio_image_t packed, rle;
+    pbio_image_init(&packed, &packed_pixels[0][0], 24, 20, 24);
+    pbio_image_init(&rle, &rle_pixels[0][0], 24, 20, 24);
+
+    static const uint8_t mono_data[] = { 0xf0, 0x3c, 0x0f, 0xa5, 0x5a, 0xff, 0x00 };
+    static const pbio_image_monochrome_t mono = { 11, 5, mono_data, 0 };
+    static const uint8_t mono_rle_data[] = {
+        0, 4, 6, 4, 6, 5, 1, 1, 2, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 8, 7,
+    };
+    static const pbio_image_monochrome_t mono_rle = { 11, 5, mono_rle_data, sizeof(mono_rle_data) };
+
+    static const int positions[][2] = {
+        { 0, 0 }, { 3, 7 }, { -4, 2 }, { 18, -3 }, { 20, 17 }, { -20, 0 }, { 0, 30 },
+    };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+        pbio_image_fill(&packed, 1);
+        pbio_image_fill(&rle, 1);
+        pbio_image_draw_image_transparent_from_monochrome(&packed, &mono, positions[i][0], positions[i][1], 2);
+        pbio_image_draw_image_transparent_from_monochrome(&rle, &mono_rle, positions[i][0], positions[i][1], 2);
+        tt_want_int_op(memcmp(packed_pixels, rle_pixels, sizeof(rle_pixels)), ==, 0);
+    }
+
+    // Runs longer than 255 pixels are split by a zero length run. This is
+    // 10 transparent, 355 black and 35 transparent pixels.
+    static const uint8_t long_rle_data[] = { 10, 255, 0, 100, 35 };
+    static const pbio_image_monochrome_t long_rle = { 20, 20, long_rle_data, sizeof(long_rle_data) };
+    pbio_image_fill(&rle, 0);
+    pbio_image_draw_image_transparent_from_monochrome(&rle, &long_rle, 2, 0, 3);
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 24; x++) {
+            int index = y * 20 + x - 2;
+            bool black = x >= 2 && x < 22 && index >= 10 && index < 365;
+            tt_want_int_op(rle_pixels[y][x], ==, black ? 3 : 0);
+        }
+    }
 }
 
 struct testcase_t pbio_image_tests[] = {
@@ -1014,5 +1178,7 @@ struct testcase_t pbio_image_tests[] = {
     PBIO_TEST(test_image_fill_circle),
     PBIO_TEST(test_image_draw_text),
     PBIO_TEST(test_image_print),
+    PBIO_TEST(test_image_packed),
+    PBIO_TEST(test_image_rle),
     END_OF_TESTCASES
 };
@@ -108,6 +108,57 @@ static pbio_error_t test_light_matrix(pbio_os_state_t *state, void *context) {
     PBIO_OS_AWAIT_MS(state, &timer, INTERVAL * 2);
     tt_want_light_matrix_data(0);
 
+    // after the first cell, only pixels that changed should be updated
+    static const uint8_t test_animation_diff[] = {
+        1, 2, 3, 4, 5, 6, 7, 8, 9,
+        1, 2, 3, 4, 50, 6, 7, 8, 9,
+    };
+    pbio_light_matrix_start_animation(test_light_matrix, test_animation_diff, 2, INTERVAL);
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    tt_want_light_matrix_data(1, 2, 3, 4, 5, 6, 7, 8, 9);
+    test_light_matrix_reset();
+    PBIO_OS_AWAIT_MS(state, &timer, INTERVAL);
+    tt_want_light_matrix_data(0, 0, 0, 0, 50, 0, 0, 0, 0);
+
+    // changing the orientation should update all pixels on the next cell
+    test_light_matrix_reset();
+    pbio_light_matrix_set_orientation(test_light_matrix, PBIO_GEOMETRY_SIDE_TOP);
+    PBIO_OS_AWAIT_MS(state, &timer, INTERVAL);
+    tt_want_light_matrix_data(1, 2, 3, 4, 5, 6, 7, 8, 9);
+    pbio_light_matrix_stop_animation(test_light_matrix);
+
+    // scrolling shifts columns to the left by one on each update and wraps
+    // around to the first column after the last one.
+    static const uint8_t test_scroll[] = { 0b001, 0b010, 0b100, 0b111 };
+    test_light_matrix_reset();
+    pbio_light_matrix_start_scroll(test_light_matrix, test_scroll, 4, INTERVAL);
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    tt_want_light_matrix_data(
+        100, 0, 0,
+        0, 100, 0,
+        0, 0, 100);
+    PBIO_OS_AWAIT_MS(state, &timer, INTERVAL);
+    tt_want_light_matrix_data(
+        0, 0, 100,
+        100, 0, 100,
+        0, 100, 100);
+    PBIO_OS_AWAIT_MS(state, &timer, INTERVAL);
+    tt_want_light_matrix_data(
+        0, 100, 100,
+        0, 100, 0,
+        100, 100, 0);
+    PBIO_OS_AWAIT_MS(state, &timer, INTERVAL);
+    tt_want_light_matrix_data(
+        100, 100, 0,
+        100, 0, 100,
+        100, 0, 0);
+    PBIO_OS_AWAIT_MS(state, &timer, INTERVAL);
+    tt_want_light_matrix_data(
+        100, 0, 0,
+        0, 100, 0,
+        0, 0, 100);
+    pbio_light_matrix_stop_animation(test_light_matrix);
+
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
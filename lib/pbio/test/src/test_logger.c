@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pbio/logger.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#define NUM_ROWS (4)
+#define NUM_COLS (1 + PBIO_LOGGER_NUM_DEFAULT_COLS)
+
+static void add_rows(pbio_log_t *log, int32_t first, int32_t count) {
+    for (int32_t i = 0; i < count; i++) {
+        int32_t value = first + i;
+        pbio_logger_add_row(log, &value);
+    }
+}
+
+static void test_logger_linear(void *env) {
+    pbio_log_t log;
+    int32_t buf[NUM_ROWS * NUM_COLS];
+
+    pbio_logger_start(&log, buf, NUM_ROWS, NUM_COLS, 1, PBIO_LOGGER_MODE_LINEAR);
+    add_rows(&log, 0, NUM_ROWS + 2);
+
+    // Logging stops when full, keeping the first rows.
+    tt_want(!pbio_logger_is_active(&log));
+    tt_want_uint_op(pbio_logger_get_num_rows_used(&log), ==, NUM_ROWS);
+    for (uint32_t i = 0; i < NUM_ROWS; i++) {
+        tt_want_int_op(pbio_logger_get_row_data(&log, i)[1], ==, i);
+    }
+}
+
+static void test_logger_circular(void *env) {
+    pbio_log_t log;
+    int32_t buf[NUM_ROWS * NUM_COLS];
+
+    pbio_logger_start(&log, buf, NUM_ROWS, NUM_COLS, 1, PBIO_LOGGER_MODE_CIRCULAR);
+    add_rows(&log, 0, NUM_ROWS + 2);
+
+    // Logging continues when full, keeping the last rows.
+    tt_want(pbio_logger_is_active(&log));
+    tt_want_uint_op(pbio_logger_get_num_rows_used(&log), ==, NUM_ROWS);
+    tt_want_uint_op(pbio_logger_get_num_rows_lost(&log), ==, 2);
+    for (uint32_t i = 0; i < NUM_ROWS; i++) {
+        tt_want_int_op(pbio_logger_get_row_data(&log, i)[1], ==, i + 2);
+    }
+
+    // Consuming rows makes room for new rows without losing any.
+    pbio_logger_discard_rows(&log, 3);
+    tt_want_uint_op(pbio_logger_get_num_rows_used(&log), ==, 1);
+    add_rows(&log, 6, 3);
+    tt_want_uint_op(pbio_logger_get_num_rows_lost(&log), ==, 2);
+    tt_want_uint_op(pbio_logger_get_num_rows_used(&log), ==, NUM_ROWS);
+    for (uint32_t i = 0; i < NUM_ROWS; i++) {
+        tt_want_int_op(pbio_logger_get_row_data(&log, i)[1], ==, i + 5);
+    }
+}
+
+struct testcase_t pbio_logger_tests[] = {
+    PBIO_TEST(test_logger_linear),
+    PBIO_TEST(test_logger_circular),
+    END_OF_TESTCASES
+};
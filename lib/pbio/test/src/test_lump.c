@@ -10,10 +10,12 @@
 
 #include <pbio/port_interface.h>
 #include <pbio/port_lump.h>
+#include <pbio/trace.h>
 
 #include <tinytest.h>
 #include <tinytest_macros.h>
 
+#include <pbdrv/clock.h>
 #include <pbdrv/uart.h>
 #include <pbio/main.h>
 #include <pbio/os.h>
@@ -224,8 +226,13 @@ static pbio_error_t test_boost_color_distance_sensor(pbio_os_state_t *state, voi
     static pbio_port_lump_mode_info_t *mode_info;
     static uint8_t current_mode;
     static uint8_t num_modes;
+    static uint32_t data_count;
+    static uint32_t data_time;
+    static uint8_t trace_buf[32];
 
     pbio_error_t err;
+    uint32_t count;
+    pbio_trace_event_t event;
 
     PBIO_OS_ASYNC_BEGIN(state);
 
@@ -427,6 +434,11 @@ static pbio_error_t test_boost_color_distance_sensor(pbio_os_state_t *state, voi
     tt_uint_op(pbio_port_lump_get_info(lump_dev, &num_modes, &current_mode, &mode_info), ==, PBIO_SUCCESS);
     tt_uint_op(current_mode, ==, 1);
 
+    // data counter is only available for the mode that is set
+    tt_uint_op(pbio_port_lump_get_data_count(lump_dev, 8, false, &count), ==, PBIO_ERROR_INVALID_OP);
+    tt_uint_op(pbio_port_lump_get_data_count(lump_dev, 1, false, &data_count), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_lump_get_data_count(lump_dev, 1, true, &count), ==, PBIO_SUCCESS);
+    tt_uint_op(count, >, 0);
 
     // also do mode 8 since it requires the extended mode flag
     PBIO_OS_AWAIT_WHILE(state, (err = pbio_port_lump_set_mode(lump_dev, 8)) == PBIO_ERROR_AGAIN);
@@ -438,7 +450,9 @@ static pbio_error_t test_boost_color_distance_sensor(pbio_os_state_t *state, voi
     // should be blocked since data with new mode has not been received yet
     tt_uint_op(pbio_port_lump_is_ready(lump_dev), ==, PBIO_ERROR_AGAIN);
 
-    // send data message with new mode
+    // send data message with new mode, recording what is received
+    data_time = pbdrv_clock_get_us();
+    pbio_trace_start(trace_buf, sizeof(trace_buf));
     SIMULATE_RX_MSG(msg90);
     SIMULATE_RX_MSG(msg91);
 
@@ -449,6 +463,24 @@ static pbio_error_t test_boost_color_distance_sensor(pbio_os_state_t *state, voi
     tt_uint_op(pbio_port_lump_get_info(lump_dev, &num_modes, &current_mode, &mode_info), ==, PBIO_SUCCESS);
     tt_uint_op(current_mode, ==, 8);
 
+    // data with the new mode counts as new data
+    tt_uint_op(pbio_port_lump_get_data_count(lump_dev, 8, false, &count), ==, PBIO_SUCCESS);
+    tt_uint_op(count, ==, data_count + 1);
+    tt_uint_op(pbio_port_lump_get_data_time(lump_dev, 8, &count), ==, PBIO_SUCCESS);
+    tt_uint_op(count, >=, data_time);
+    tt_uint_op(count, <=, pbdrv_clock_get_us());
+
+    // received messages are recorded as they are
+    count = 0;
+    tt_uint_op(pbio_trace_stop(), ==, 2 * PBIO_TRACE_EVENT_HEADER_SIZE + sizeof(msg90) + sizeof(msg91));
+    tt_want(pbio_trace_read_event(trace_buf, sizeof(trace_buf), &count, &event));
+    tt_uint_op(event.type, ==, PBIO_TRACE_EVENT_LUMP_MSG);
+    tt_uint_op(event.size, ==, sizeof(msg90));
+    tt_int_op(memcmp(event.data, msg90, sizeof(msg90)), ==, 0);
+    tt_uint_op(event.time, >=, data_time);
+    tt_want(pbio_trace_read_event(trace_buf, sizeof(trace_buf), &count, &event));
+    tt_int_op(memcmp(event.data, msg91, sizeof(msg91)), ==, 0);
+
 
 end:
 
@@ -609,6 +641,35 @@ static pbio_error_t test_boost_interactive_motor(pbio_os_state_t *state, void *c
     tt_want_uint_op(mode_info[3].data_type, ==, LUMP_DATA_TYPE_DATA16);
     tt_want_uint_op(mode_info[3].writable, ==, 0);
 
+    #if PBIO_CONFIG_PORT_LUMP_INFO_CACHE_SIZE
+    // Unplug the motor by no longer sending data, so it times out.
+    PBIO_OS_AWAIT_UNTIL(state, test_uart.tx_msg_result == PBIO_ERROR_AGAIN);
+    tt_uint_op(test_uart.tx_msg_length, ==, PBIO_ARRAY_SIZE(msg_speed_115200));
+
+    // The cancelled data read is not cleaned up by this simulated driver.
+    test_uart.rx_msg = NULL;
+
+    // Plug it back in. Now the info is known, so just the type and the ACK
+    // are enough to complete the sync.
+    SIMULATE_TX_MSG(msg_speed_115200);
+    PBIO_OS_AWAIT_UNTIL(state, test_uart.baud == 2400);
+    SIMULATE_RX_MSG(msg0);
+    SIMULATE_RX_MSG(msg33);
+    SIMULATE_TX_MSG(msg34);
+    PBIO_OS_AWAIT_UNTIL(state, test_uart.baud == 115200);
+    SIMULATE_TX_MSG(msg35);
+    SIMULATE_RX_MSG(msg36);
+    SIMULATE_TX_MSG(msg37);
+
+    PBIO_OS_AWAIT_WHILE(state, (err = pbio_port_get_lump_device(port, &expected_id, &lump_dev)) == PBIO_ERROR_AGAIN);
+    tt_uint_op(err, ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_lump_get_info(lump_dev, &num_modes, &current_mode, &mode_info), ==, PBIO_SUCCESS);
+    tt_want_uint_op(num_modes, ==, 4);
+    tt_want_uint_op(current_mode, ==, LEGO_DEVICE_MODE_PUP_REL_MOTOR__POS);
+    tt_want_uint_op(mode_info[3].num_values, ==, 5);
+    tt_want_uint_op(mode_info[3].data_type, ==, LUMP_DATA_TYPE_DATA16);
+    #endif
+
 
 end:
 
@@ -815,7 +876,28 @@ static pbio_error_t test_technic_large_motor(pbio_os_state_t *state, void *conte
     tt_want_uint_op(mode_info[5].data_type, ==, LUMP_DATA_TYPE_DATA16);
     tt_want_uint_op(mode_info[5].writable, ==, 0);
 
+    // Only speed, position and absolute position can be combined.
+    static const uint8_t bad_combi[] = { LUMP_COMBI_VALUE(0, 0), LUMP_COMBI_VALUE(1, 0) };
+    static const uint8_t good_combi[] = { LUMP_COMBI_VALUE(1, 0), LUMP_COMBI_VALUE(2, 0), LUMP_COMBI_VALUE(3, 0) };
+    tt_want_uint_op(pbio_port_lump_set_mode_combi(lump_dev, bad_combi, sizeof(bad_combi)), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_uint_op(pbio_port_lump_set_mode_combi(lump_dev, good_combi, sizeof(good_combi)), ==, PBIO_SUCCESS);
+
+    // Combi setup command, followed by combined speed, position and absolute position data.
+    static const uint8_t msg_combi_setup[] = { 0x54, 0x20, 0x10, 0x20, 0x30, 0x8B };
+    static const uint8_t msg_combi_data[] = { 0xC0 | 0x18 | 0x01, 0x05, 0x10, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x13 };
+    SIMULATE_TX_MSG(msg_combi_setup);
+    SIMULATE_RX_MSG(msg_combi_data);
+    PBIO_OS_AWAIT_WHILE(state, (err = pbio_port_lump_is_ready(lump_dev)) == PBIO_ERROR_AGAIN);
+    tt_uint_op(err, ==, PBIO_SUCCESS);
 
+    // Complete modes in the combination can be read without switching modes.
+    void *data;
+    tt_want_uint_op(pbio_port_lump_set_mode(lump_dev, LEGO_DEVICE_MODE_PUP_ABS_MOTOR__POS), ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbio_port_lump_get_data(lump_dev, LEGO_DEVICE_MODE_PUP_ABS_MOTOR__POS, &data), ==, PBIO_SUCCESS);
+    tt_want_int_op(pbio_get_uint32_le(data), ==, 16);
+    tt_want_uint_op(pbio_port_lump_get_data(lump_dev, PBIO_PORT_LUMP_MODE_COMBI, &data), ==, PBIO_SUCCESS);
+    tt_want_int_op(((int8_t *)data)[0], ==, 5);
+    tt_want_uint_op(pbio_port_lump_get_data(lump_dev, LEGO_DEVICE_MODE_PUP_ABS_MOTOR__CALIB, &data), ==, PBIO_ERROR_INVALID_OP);
 
 end:
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
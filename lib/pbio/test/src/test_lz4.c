@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <pbio/lz4.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+// "abc" followed by an overlapping match of 18 bytes and a final literal.
+static const uint8_t short_stream[] = {
+    0x3e, 'a', 'b', 'c', 0x03, 0x00,
+    0x10, '!',
+};
+
+static const char short_expected[] = "abcabcabcabcabcabcabc!";
+
+// 20 literals and a match of 275 bytes, both with extended lengths.
+static const uint8_t long_stream[] = {
+    0xff, 0x05,
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J',
+    0x14, 0x00, 0xff, 0x01,
+    0x10, 'x',
+};
+
+#define LONG_EXPECTED_SIZE (20 + 275 + 1)
+
+static void test_lz4_short(void *env) {
+    pbio_lz4_decoder_t decoder;
+    uint8_t out[32];
+
+    pbio_lz4_decoder_init(&decoder, out, sizeof(out));
+    tt_want_uint_op(pbio_lz4_decode(&decoder, short_stream, sizeof(short_stream)), ==, PBIO_SUCCESS);
+    tt_want_uint_op(decoder.out_pos, ==, strlen(short_expected));
+    tt_want_uint_op(decoder.in_pos, ==, sizeof(short_stream));
+    tt_want_int_op(memcmp(out, short_expected, strlen(short_expected)), ==, 0);
+}
+
+static void test_lz4_chunked(void *env) {
+    pbio_lz4_decoder_t decoder;
+    uint8_t whole[LONG_EXPECTED_SIZE];
+    uint8_t chunked[LONG_EXPECTED_SIZE];
+
+    pbio_lz4_decoder_init(&decoder, whole, sizeof(whole));
+    tt_want_uint_op(pbio_lz4_decode(&decoder, long_stream, sizeof(long_stream)), ==, PBIO_SUCCESS);
+    tt_want_uint_op(decoder.out_pos, ==, LONG_EXPECTED_SIZE);
+
+    // The match repeats the literals.
+    for (uint32_t i = 20; i < LONG_EXPECTED_SIZE - 1; i++) {
+        tt_want_uint_op(whole[i], ==, whole[i % 20]);
+    }
+    tt_want_uint_op(whole[LONG_EXPECTED_SIZE - 1], ==, 'x');
+
+    // Split into chunks of every size, including inside lengths and offsets.
+    for (uint32_t chunk = 1; chunk < sizeof(long_stream); chunk++) {
+        memset(chunked, 0, sizeof(chunked));
+        pbio_lz4_decoder_init(&decoder, chunked, sizeof(chunked));
+        for (uint32_t i = 0; i < sizeof(long_stream); i += chunk) {
+            uint32_t size = sizeof(long_stream) - i < chunk ? sizeof(long_stream) - i : chunk;
+            tt_want_uint_op(pbio_lz4_decode(&decoder, &long_stream[i], size), ==, PBIO_SUCCESS);
+        }
+        tt_want_uint_op(decoder.out_pos, ==, LONG_EXPECTED_SIZE);
+        tt_want_int_op(memcmp(whole, chunked, sizeof(whole)), ==, 0);
+    }
+}
+
+static void test_lz4_invalid(void *env) {
+    pbio_lz4_decoder_t decoder;
+    uint8_t out[32];
+
+    // Match refers to data before the start of the output.
+    static const uint8_t bad_offset[] = { 0x10, 'a', 0x02, 0x00 };
+    pbio_lz4_decoder_init(&decoder, out, sizeof(out));
+    tt_want_uint_op(pbio_lz4_decode(&decoder, bad_offset, sizeof(bad_offset)), ==, PBIO_ERROR_INVALID_ARG);
+
+    // Output does not fit.
+    pbio_lz4_decoder_init(&decoder, out, 10);
+    tt_want_uint_op(pbio_lz4_decode(&decoder, short_stream, sizeof(short_stream)), ==, PBIO_ERROR_INVALID_ARG);
+}
+
+// Encodes the data in blocks of at most block_size and decodes them again.
+static uint32_t encode_and_decode(const uint8_t *data, uint32_t size, uint32_t block_size) {
+    static uint8_t history[256];
+    static uint8_t decoded[2048];
+    pbio_lz4_encoder_t encoder;
+    pbio_lz4_decoder_t decoder;
+    uint8_t block[64];
+    uint32_t encoded_size = 0;
+
+    pbio_lz4_encoder_init(&encoder, history, sizeof(history));
+    pbio_lz4_decoder_init(&decoder, decoded, sizeof(decoded));
+
+    for (uint32_t done = 0; done < size;) {
+        uint32_t consumed = size - done;
+        uint32_t block_len = pbio_lz4_encode(&encoder, data + done, &consumed, block, block_size);
+        tt_want_uint_op(block_len, >, 0);
+        tt_want_uint_op(block_len, <=, block_size);
+        tt_want_uint_op(consumed, >, 0);
+        if (!block_len || !consumed) {
+            return 0;
+        }
+
+        // Each block is complete, so the next one starts with a token.
+        decoder.state = PBIO_LZ4_STATE_TOKEN;
+        tt_want_uint_op(pbio_lz4_decode(&decoder, block, block_len), ==, PBIO_SUCCESS);
+        done += consumed;
+        encoded_size += block_len;
+        tt_want_uint_op(decoder.out_pos, ==, done);
+    }
+
+    tt_want_uint_op(decoder.out_pos, ==, size);
+    tt_want_int_op(memcmp(decoded, data, size), ==, 0);
+    return encoded_size;
+}
+
+static void test_lz4_encode(void *env) {
+    static uint8_t text[1500];
+    static uint8_t noise[600];
+    uint32_t len = 0;
+
+    // Typical debug output, which repeats a lot.
+    for (uint32_t i = 0; len + 40 < sizeof(text); i++) {
+        len += snprintf((char *)text + len, sizeof(text) - len, "angle: %4u speed: %3u load: 0\n", (unsigned)(i * 7 % 360), (unsigned)(i % 50));
+    }
+
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < sizeof(noise); i++) {
+        seed = seed * 1103515245 + 12345;
+        noise[i] = seed >> 16;
+    }
+
+    // Small blocks like Bluetooth notifications, larger blocks, and blocks
+    // that barely fit a sequence. Each block ends with a few literals, so
+    // small blocks compress less.
+    tt_want_uint_op(encode_and_decode(text, len, 19), <, len * 3 / 4);
+    tt_want_uint_op(encode_and_decode(text, len, 64), <, len / 2);
+    tt_want_uint_op(encode_and_decode(text, len, 2), >, 0);
+
+    // Data that does not compress still gets through.
+    tt_want_uint_op(encode_and_decode(noise, sizeof(noise), 19), >, 0);
+    tt_want_uint_op(encode_and_decode(noise, sizeof(noise), 64), >, 0);
+
+    // Long runs.
+    memset(text, 'x', sizeof(text));
+    tt_want_uint_op(encode_and_decode(text, sizeof(text), 19), <, sizeof(text) / 8);
+    tt_want_uint_op(encode_and_decode(text, 1, 19), ==, 2);
+}
+
+struct testcase_t pbio_lz4_tests[] = {
+    PBIO_TEST(test_lz4_short),
+    PBIO_TEST(test_lz4_chunked),
+    PBIO_TEST(test_lz4_invalid),
+    PBIO_TEST(test_lz4_encode),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <pbio/mailbox.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+// Message "hi" to mailbox "abc" with counter 0, as sent by an EV3 brick.
+static const uint8_t hi_message[] = {
+    0x0e, 0x00, 0x00, 0x00, 0x81, 0x9e, 0x04, 'a', 'b', 'c', 0x00, 0x03, 0x00, 'h', 'i', 0x00,
+};
+
+static void test_mailbox_write(void *env) {
+    pbio_mailbox_writer_t writer;
+    uint8_t buf[40];
+
+    pbio_mailbox_writer_init(&writer, buf, sizeof(buf));
+    tt_want_uint_op(pbio_mailbox_write(&writer, "abc", (const uint8_t *)"hi", 3), ==, PBIO_SUCCESS);
+    tt_want_uint_op(writer.len, ==, sizeof(hi_message));
+    tt_want(memcmp(buf, hi_message, sizeof(hi_message)) == 0);
+
+    // A second message is batched after the first, with the next counter.
+    tt_want_uint_op(pbio_mailbox_write(&writer, "abc", (const uint8_t *)"hi", 3), ==, PBIO_SUCCESS);
+    tt_want_uint_op(writer.len, ==, 2 * sizeof(hi_message));
+    tt_want_uint_op(writer.num_messages, ==, 2);
+    tt_want_uint_op(buf[sizeof(hi_message) + 2], ==, 1);
+
+    // A third does not fit until the buffer is sent and reset.
+    tt_want_uint_op(pbio_mailbox_write(&writer, "abc", (const uint8_t *)"hi", 3), ==, PBIO_ERROR_AGAIN);
+    tt_want_uint_op(writer.len, ==, 2 * sizeof(hi_message));
+    pbio_mailbox_writer_reset(&writer);
+    tt_want_uint_op(pbio_mailbox_write(&writer, "abc", (const uint8_t *)"hi", 3), ==, PBIO_SUCCESS);
+    tt_want_uint_op(writer.num_messages, ==, 1);
+    tt_want_uint_op(buf[2], ==, 2);
+
+    // Messages that never fit are rejected.
+    uint8_t large[sizeof(buf)] = { 0 };
+    tt_want_uint_op(pbio_mailbox_write(&writer, "abc", large, sizeof(large)), ==, PBIO_ERROR_INVALID_ARG);
+}
+
+static void test_mailbox_read(void *env) {
+    uint8_t data[2 * sizeof(hi_message)];
+    memcpy(data, hi_message, sizeof(hi_message));
+    memcpy(data + sizeof(hi_message), hi_message, sizeof(hi_message));
+
+    pbio_mailbox_message_t message;
+    uint32_t offset = 0;
+
+    // Messages are read one after the other, in place.
+    for (int i = 0; i < 2; i++) {
+        tt_want_uint_op(pbio_mailbox_read(data, sizeof(data), &offset, &message), ==, PBIO_SUCCESS);
+        tt_want_str_op(message.name, ==, "abc");
+        tt_want_uint_op(message.value_size, ==, 3);
+        tt_want_str_op((const char *)message.value, ==, "hi");
+        tt_want(message.value >= data && message.value < data + sizeof(data));
+    }
+    tt_want_uint_op(offset, ==, sizeof(data));
+    tt_want_uint_op(pbio_mailbox_read(data, sizeof(data), &offset, &message), ==, PBIO_ERROR_AGAIN);
+
+    // Incomplete messages need more data.
+    offset = 0;
+    tt_want_uint_op(pbio_mailbox_read(data, sizeof(hi_message) - 1, &offset, &message), ==, PBIO_ERROR_AGAIN);
+    tt_want_uint_op(offset, ==, 0);
+
+    // Sizes that do not add up are rejected.
+    data[11] = 0x04;
+    tt_want_uint_op(pbio_mailbox_read(data, sizeof(data), &offset, &message), ==, PBIO_ERROR_INVALID_ARG);
+    data[11] = 0x03;
+    data[6] = 0x20;
+    tt_want_uint_op(pbio_mailbox_read(data, sizeof(data), &offset, &message), ==, PBIO_ERROR_INVALID_ARG);
+}
+
+struct testcase_t pbio_mailbox_tests[] = {
+    PBIO_TEST(test_mailbox_write),
+    PBIO_TEST(test_mailbox_read),
+    END_OF_TESTCASES
+};
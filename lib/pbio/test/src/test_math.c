@@ -25,6 +25,7 @@ static void test_sqrt(void *env) {
     tt_want_int_op(pbio_int_math_sqrt(400), ==, 20);
     tt_want_int_op(pbio_int_math_sqrt(40000), ==, 200);
     tt_want_int_op(pbio_int_math_sqrt(400000000), ==, 20000);
+    tt_want_int_op(pbio_int_math_sqrt(INT32_MAX), ==, 46340);
 
     // Negative square roots do not exist but are expected to return 0.
     tt_want_int_op(pbio_int_math_sqrt(-36), ==, 0);
@@ -51,7 +52,7 @@ static void test_atan2(void *env) {
             }
 
             // Assert that error remains small.
-            tt_want_int_op(error, <=, 3);
+            tt_want_int_op(error, <=, 1);
         }
     }
 
@@ -77,9 +78,13 @@ static void test_atan2(void *env) {
             }
 
             // Assert that error remains small.
-            tt_want_int_op(error, <=, 2);
+            tt_want_int_op(error, <=, 1);
         }
     }
+
+    // Large inputs must not overflow.
+    tt_want_int_op(pbio_int_math_atan2(INT32_MAX, 1), ==, 90);
+    tt_want_int_op(pbio_int_math_atan2(-INT32_MAX, -INT32_MAX), ==, -135);
 }
 
 static void test_mult_and_scale(void *env) {
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pbdrv/clock.h>
+#include <pbio/os.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+static uint32_t run_order[4];
+static uint32_t run_count;
+
+static pbio_error_t test_os_thread(pbio_os_state_t *state, void *context) {
+    run_order[run_count++ % 4] = (uintptr_t)context;
+    return PBIO_ERROR_AGAIN;
+}
+
+static void test_os_priority(void *env) {
+    static pbio_os_process_t normal, high, critical;
+
+    pbio_os_process_start(&normal, test_os_thread, (void *)1);
+    pbio_os_process_set_priority(&high, PBIO_OS_PROCESS_PRIORITY_HIGH);
+    pbio_os_process_start(&high, test_os_thread, (void *)2);
+    pbio_os_process_start(&critical, test_os_thread, (void *)3);
+
+    // Priority can also be changed after starting.
+    pbio_os_process_set_priority(&critical, PBIO_OS_PROCESS_PRIORITY_CRITICAL);
+
+    run_count = 0;
+    pbio_os_request_poll();
+    tt_want(!pbio_os_run_processes_once());
+    tt_want_uint_op(run_count, ==, 3);
+    tt_want_uint_op(run_order[0], ==, 3);
+    tt_want_uint_op(run_order[1], ==, 2);
+    tt_want_uint_op(run_order[2], ==, 1);
+}
+
+static void test_os_process_request_poll(void *env) {
+    static pbio_os_process_t first, second;
+
+    pbio_os_process_start(&first, test_os_thread, (void *)1);
+    pbio_os_process_start(&second, test_os_thread, (void *)2);
+
+    // Starting processes runs each of them once.
+    run_count = 0;
+    tt_want(!pbio_os_run_processes_once());
+    tt_want_uint_op(run_count, ==, 2);
+
+    // Nothing runs without a poll request.
+    run_count = 0;
+    tt_want(!pbio_os_run_processes_once());
+    tt_want_uint_op(run_count, ==, 0);
+
+    // Targeted poll runs only the given process.
+    pbio_os_process_request_poll(&second);
+    tt_want(!pbio_os_run_processes_once());
+    tt_want_uint_op(run_count, ==, 1);
+    tt_want_uint_op(run_order[0], ==, 2);
+
+    // Polling without a process runs all of them.
+    run_count = 0;
+    pbio_os_process_request_poll(NULL);
+    tt_want(!pbio_os_run_processes_once());
+    tt_want_uint_op(run_count, ==, 2);
+}
+
+static uint32_t busy_calls_remaining;
+
+static pbio_error_t test_os_busy_thread(pbio_os_state_t *state, void *context) {
+    // Simulate work that takes 1 ms per call.
+    extern void pbio_test_clock_tick(uint32_t ticks);
+    pbio_test_clock_tick(1);
+    return --busy_calls_remaining ? PBIO_ERROR_AGAIN : PBIO_SUCCESS;
+}
+
+static void test_os_profile(void *env) {
+    static pbio_os_process_t busy;
+
+    busy_calls_remaining = 3;
+    pbio_os_process_start(&busy, test_os_busy_thread, NULL);
+    pbio_os_reset_stats();
+
+    // The process keeps polling itself until done, then the loop idles for
+    // one clock tick.
+    pbio_os_run_processes_and_wait_for_event();
+
+    tt_want_uint_op(busy.stats.num_calls, ==, 3);
+    tt_want_uint_op(busy.stats.time_total_us, ==, 3000);
+    tt_want_uint_op(busy.stats.time_max_us, ==, 1000);
+    tt_want_uint_op(pbio_os_get_idle_time_us(), ==, 1000);
+
+    // The process can be found by iterating the process list.
+    pbio_os_process_t *p = NULL;
+    while ((p = pbio_os_process_get_next(p)) && p != &busy) {
+        ;
+    }
+    tt_want(p == &busy);
+
+    pbio_os_reset_stats();
+    tt_want_uint_op(busy.stats.num_calls, ==, 0);
+    tt_want_uint_op(pbio_os_get_idle_time_us(), ==, 0);
+}
+
+static void test_os_stall(void *env) {
+    static pbio_os_process_t busy;
+    pbio_os_stall_t stall;
+
+    // Waiting for events is not counted as a stall.
+    pbio_os_run_processes_and_wait_for_event();
+
+    // Time spent in a process is attributed to that process.
+    busy_calls_remaining = 2;
+    pbio_os_process_start(&busy, test_os_busy_thread, NULL);
+    pbio_os_reset_stall();
+    pbio_os_run_processes_once();
+    pbio_os_get_stall(&stall);
+    tt_want_uint_op(stall.time_us, ==, 1000);
+    tt_want(stall.process == &busy);
+
+    // Time between passes is spent outside of the event loop, such as in a
+    // user program that does not call the event loop.
+    extern void pbio_test_clock_tick(uint32_t ticks);
+    pbio_test_clock_tick(5);
+    pbio_os_request_poll();
+    pbio_os_run_processes_once();
+    pbio_os_get_stall(&stall);
+    tt_want_uint_op(stall.time_us, ==, 5000);
+    tt_want(stall.process == NULL);
+
+    pbio_os_reset_stall();
+    pbio_os_get_stall(&stall);
+    tt_want_uint_op(stall.time_us, ==, 0);
+}
+
+static pbio_error_t test_os_timer_thread(pbio_os_state_t *state, void *context) {
+    static pbio_os_timer_t timer;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (;;) {
+        PBIO_OS_AWAIT_MS(state, &timer, 10);
+        run_count++;
+    }
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static void test_os_tickless(void *env) {
+    static pbio_os_process_t waiting;
+
+    pbio_os_process_start(&waiting, test_os_timer_thread, NULL);
+    run_count = 0;
+
+    // Without tickless idle, each wait lasts one tick.
+    uint32_t start = pbdrv_clock_get_ms();
+    pbio_os_run_processes_and_wait_for_event();
+    tt_want_uint_op(pbdrv_clock_get_ms() - start, ==, 1);
+
+    // With tickless idle, the wait lasts until the timer expires.
+    pbio_os_set_tickless_idle(true);
+    start = pbdrv_clock_get_ms();
+    pbio_os_run_processes_and_wait_for_event();
+    tt_want_uint_op(pbdrv_clock_get_ms() - start, ==, 9);
+    pbio_os_run_processes_and_wait_for_event();
+    tt_want_uint_op(run_count, ==, 1);
+
+    // Processes that don't wait for a timer keep the tick running.
+    static pbio_os_process_t other;
+    pbio_os_process_start(&other, test_os_thread, NULL);
+    pbio_os_run_processes_once();
+    start = pbdrv_clock_get_ms();
+    pbio_os_run_processes_and_wait_for_event();
+    tt_want_uint_op(pbdrv_clock_get_ms() - start, ==, 1);
+
+    pbio_os_set_tickless_idle(false);
+}
+
+struct testcase_t pbio_os_tests[] = {
+    PBIO_TEST(test_os_priority),
+    PBIO_TEST(test_os_process_request_poll),
+    PBIO_TEST(test_os_profile),
+    PBIO_TEST(test_os_tickless),
+    PBIO_TEST(test_os_stall),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pbio/pf_ir.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+static void test_pf_ir_queue(void *env) {
+    pbio_pf_ir_queue_t queue;
+    pbio_pf_ir_queue_reset(&queue);
+    uint16_t message;
+    uint32_t now = 0;
+
+    // Nothing to send yet.
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now, &message));
+
+    // One output uses single output mode. Only the latest value is sent.
+    pbio_pf_ir_queue_set(&queue, 1, PBIO_PF_IR_OUTPUT_BLUE, 3);
+    pbio_pf_ir_queue_set(&queue, 1, PBIO_PF_IR_OUTPUT_BLUE, 5);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message, ==, 1 << 8 | 1 << 6 | 1 << 4 | 5);
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now, &message));
+
+    // Values that were already sent are not sent again.
+    pbio_pf_ir_queue_set(&queue, 1, PBIO_PF_IR_OUTPUT_BLUE, 5);
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now += 1000, &message));
+
+    // Channels take turns, starting after the one that was sent last.
+    pbio_pf_ir_queue_set(&queue, 0, PBIO_PF_IR_OUTPUT_RED, 0);
+    pbio_pf_ir_queue_set(&queue, 1, PBIO_PF_IR_OUTPUT_RED, 0);
+    pbio_pf_ir_queue_set(&queue, 3, PBIO_PF_IR_OUTPUT_RED, 0);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message >> 8, ==, 3);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message >> 8, ==, 0);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message, ==, 1 << 8 | 1 << 6 | 0);
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now, &message));
+
+    // Both outputs changing use one combo PWM message.
+    pbio_pf_ir_queue_set(&queue, 2, PBIO_PF_IR_OUTPUT_RED, 7);
+    pbio_pf_ir_queue_set(&queue, 2, PBIO_PF_IR_OUTPUT_BLUE, 9);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message, ==, 1 << 10 | 2 << 8 | 9 << 4 | 7);
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now, &message));
+
+    // Combo messages are repeated so the receiver does not time out, also
+    // when only one output changes.
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now + PBIO_PF_IR_REFRESH_MS - 1, &message));
+    tt_want(pbio_pf_ir_queue_pop(&queue, now += PBIO_PF_IR_REFRESH_MS, &message));
+    tt_want_uint_op(message, ==, 1 << 10 | 2 << 8 | 9 << 4 | 7);
+    pbio_pf_ir_queue_set(&queue, 2, PBIO_PF_IR_OUTPUT_BLUE, 0);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message, ==, 1 << 10 | 2 << 8 | 0 << 4 | 7);
+
+    // Once both outputs are off, there is no need to repeat.
+    pbio_pf_ir_queue_set(&queue, 2, PBIO_PF_IR_OUTPUT_RED, 0);
+    tt_want(pbio_pf_ir_queue_pop(&queue, now, &message));
+    tt_want_uint_op(message, ==, 1 << 10 | 2 << 8);
+    tt_want(!pbio_pf_ir_queue_pop(&queue, now += 10000, &message));
+}
+
+struct testcase_t pbio_pf_ir_tests[] = {
+    PBIO_TEST(test_pf_ir_queue),
+    END_OF_TESTCASES
+};
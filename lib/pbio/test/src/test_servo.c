@@ -24,6 +24,7 @@
 #include <pbio/os.h>
 #include <pbio/port_interface.h>
 #include <pbio/servo.h>
+#include <pbio/util.h>
 #include <test-pbio.h>
 
 #include "../drv/clock/clock_test.h"
@@ -74,6 +75,15 @@ static pbio_error_t test_servo_basics(pbio_os_state_t *state, void *context) {
     PBIO_OS_AWAIT_UNTIL(state, pbio_control_is_done(&srv->control));
     tt_want(pbio_test_int_is_close(speed, 0, 50));
 
+    // The control loop should have kept its period without missing deadlines.
+    pbio_motor_process_stats_t stats;
+    pbio_motor_process_get_stats(&stats);
+    tt_want_uint_op(stats.count, >, 0);
+    tt_want_uint_op(stats.period_min_us, ==, PBIO_CONFIG_CONTROL_LOOP_TIME_MS * 1000);
+    tt_want_uint_op(stats.period_max_us, ==, PBIO_CONFIG_CONTROL_LOOP_TIME_MS * 1000);
+    tt_want_uint_op(stats.period_mean_us, ==, PBIO_CONFIG_CONTROL_LOOP_TIME_MS * 1000);
+    tt_want_uint_op(stats.missed_deadlines, ==, 0);
+
 end:;
 
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
@@ -178,9 +188,305 @@ end:
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+static pbio_error_t test_servo_synced(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srvs[3];
+    static const int32_t targets[] = { 360, 90, -180 };
+    static const pbio_port_id_t ports[] = { PBIO_PORT_ID_A, PBIO_PORT_ID_B, PBIO_PORT_ID_E };
+    static uint32_t duration;
+    static int32_t angle;
+    static int32_t speed;
+    static uint8_t i;
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    for (i = 0; i < PBIO_ARRAY_SIZE(srvs); i++) {
+        pbio_port_t *port;
+        lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+        tt_uint_op(pbio_port_get_port(ports[i], &port), ==, PBIO_SUCCESS);
+        tt_uint_op(pbio_port_get_servo(port, &id, &srvs[i]), ==, PBIO_SUCCESS);
+        tt_uint_op(pbio_servo_setup(srvs[i], id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+        tt_uint_op(pbio_servo_reset_angle(srvs[i], 0, false), ==, PBIO_SUCCESS);
+    }
+
+    // All trajectories should take as long as the longest one.
+    tt_uint_op(pbio_servo_run_targets_synced(srvs, targets, PBIO_ARRAY_SIZE(srvs), 500, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    duration = pbio_trajectory_get_duration(&srvs[0]->control.trajectory);
+    tt_want_uint_op(duration, >, 0);
+    for (i = 1; i < PBIO_ARRAY_SIZE(srvs); i++) {
+        tt_want_uint_op(pbio_trajectory_get_duration(&srvs[i]->control.trajectory), ==, duration);
+    }
+
+    // Halfway, each servo should be about halfway, by symmetry.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_control_get_time_ticks() - srvs[0]->control.trajectory.start.time >= duration / 2);
+    for (i = 0; i < PBIO_ARRAY_SIZE(srvs); i++) {
+        tt_uint_op(pbio_servo_get_state_user(srvs[i], &angle, &speed), ==, PBIO_SUCCESS);
+        tt_want(pbio_test_int_is_close(angle, targets[i] / 2, pbio_int_math_abs(targets[i]) / 10));
+    }
+
+    // All should reach their targets.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_control_is_done(&srvs[0]->control) && pbio_control_is_done(&srvs[1]->control) && pbio_control_is_done(&srvs[2]->control));
+    for (i = 0; i < PBIO_ARRAY_SIZE(srvs); i++) {
+        tt_uint_op(pbio_servo_get_state_user(srvs[i], &angle, &speed), ==, PBIO_SUCCESS);
+        tt_want(pbio_test_int_is_close(angle, targets[i], 5));
+    }
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_servo_queue(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv;
+    static int32_t angle;
+    static int32_t speed;
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    pbio_port_t *port;
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_reset_angle(srv, 0, false), ==, PBIO_SUCCESS);
+
+    // Without an active command, the first one starts right away.
+    tt_uint_op(pbio_servo_queue_target(srv, 500, 360, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_want(pbio_control_type_is_position(&srv->control));
+    tt_want_uint_op(srv->control.queue_size, ==, 0);
+
+    // Same direction, then back again.
+    tt_uint_op(pbio_servo_queue_target(srv, 500, 720, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_queue_target(srv, 500, 360, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_uint_op(srv->control.queue_size, ==, 2);
+    tt_want(!pbio_control_is_done(&srv->control));
+
+    // The first target is passed at speed instead of stopping there.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_servo_get_state_user(srv, &angle, &speed) == PBIO_SUCCESS && angle >= 360);
+    tt_want_int_op(speed, >, 300);
+
+    // It turns around at the second target and ends at the last one.
+    PBIO_OS_AWAIT_UNTIL(state, pbio_servo_get_state_user(srv, &angle, &speed) == PBIO_SUCCESS && angle >= 700);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_control_is_done(&srv->control));
+    tt_uint_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(angle, 360, 5));
+    tt_want_uint_op(srv->control.queue_size, ==, 0);
+
+    // A new regular command discards the queue.
+    tt_uint_op(pbio_servo_queue_target(srv, 500, 0, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_queue_target(srv, 500, 360, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_run_target(srv, 500, 180, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_uint_op(srv->control.queue_size, ==, 0);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_control_is_done(&srv->control));
+    tt_uint_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(angle, 180, 5));
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_servo_track(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv;
+    static pbio_os_timer_t timer;
+    static int32_t angle;
+    static int32_t speed;
+    static int32_t i;
+
+    pbio_trajectory_reference_t before;
+    pbio_trajectory_reference_t after;
+    uint32_t time_now;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    pbio_port_t *port;
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_reset_angle(srv, 0, false), ==, PBIO_SUCCESS);
+
+    // The first target is held right away.
+    tt_uint_op(pbio_servo_track_target(srv, 0), ==, PBIO_SUCCESS);
+    tt_want(srv->control.track_active);
+
+    // Stream targets at 50 Hz, moving 4 degrees each time.
+    for (i = 1; i <= 25; i++) {
+        PBIO_OS_AWAIT_MS(state, &timer, 20);
+
+        // The reference continues from where it was, at the speed that
+        // reaches the new target when the next one is expected.
+        time_now = pbio_control_get_time_ticks();
+        pbio_trajectory_get_reference(&srv->control.trajectory, time_now, &before);
+        tt_uint_op(pbio_servo_track_target(srv, i * 4), ==, PBIO_SUCCESS);
+        pbio_trajectory_get_reference(&srv->control.trajectory, time_now, &after);
+        tt_want_int_op(pbio_angle_diff_mdeg(&after.position, &before.position), ==, 0);
+        tt_want(pbio_test_int_is_close(after.speed, 200000, 1000));
+    }
+
+    // The motor follows the reference and holds the last target.
+    PBIO_OS_AWAIT_MS(state, &timer, 10);
+    tt_uint_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(speed, 200, 30));
+    tt_want(pbio_test_int_is_close(angle, 98, 5));
+    PBIO_OS_AWAIT_UNTIL(state, pbio_control_is_done(&srv->control));
+    PBIO_OS_AWAIT_MS(state, &timer, 200);
+    tt_uint_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want(pbio_test_int_is_close(angle, 100, 5));
+
+    // After a long pause, the next target is held right away again.
+    tt_uint_op(pbio_servo_track_target(srv, 120), ==, PBIO_SUCCESS);
+    time_now = pbio_control_get_time_ticks();
+    pbio_trajectory_get_reference(&srv->control.trajectory, time_now, &after);
+    tt_want_int_op(after.speed, ==, 0);
+
+    // A target that is too far away for the interval is approached at the
+    // maximum speed.
+    PBIO_OS_AWAIT_MS(state, &timer, 20);
+    tt_uint_op(pbio_servo_track_target(srv, 1200), ==, PBIO_SUCCESS);
+    time_now = pbio_control_get_time_ticks();
+    pbio_trajectory_get_reference(&srv->control.trajectory, time_now, &after);
+    tt_want(pbio_test_int_is_close(after.speed, srv->control.settings.speed_max, 100));
+
+    // Other commands end tracking.
+    tt_uint_op(pbio_servo_run_target(srv, 500, 0, PBIO_CONTROL_ON_COMPLETION_HOLD), ==, PBIO_SUCCESS);
+    tt_want(!srv->control.track_active);
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_servo_identify_model(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv;
+    static const pbio_observer_model_t *base;
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    pbio_port_t *port;
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbio_servo_identify_model_result(srv), ==, PBIO_ERROR_INVALID_OP);
+    base = srv->observer.model;
+
+    // Another command cancels it.
+    tt_uint_op(pbio_servo_identify_model_start(srv), ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbio_servo_identify_model_result(srv), ==, PBIO_ERROR_AGAIN);
+    tt_uint_op(pbio_servo_run_forever(srv, 500), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_servo_identify_model_result(srv) != PBIO_ERROR_AGAIN);
+    tt_want_uint_op(pbio_servo_identify_model_result(srv), ==, PBIO_ERROR_CANCELED);
+    tt_uint_op(pbio_servo_stop(srv, PBIO_CONTROL_ON_COMPLETION_COAST), ==, PBIO_SUCCESS);
+
+    // Run it to completion.
+    tt_uint_op(pbio_servo_identify_model_start(srv), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_UNTIL(state, pbio_servo_identify_model_result(srv) != PBIO_ERROR_AGAIN);
+    tt_uint_op(pbio_servo_identify_model_result(srv), ==, PBIO_SUCCESS);
+    tt_want(srv->observer.model == &srv->identification.model);
+    tt_want(!pbio_control_is_active(&srv->control));
+
+    // The simulated motor follows the default model, so the result is close.
+    tt_want(pbio_test_int_is_close(srv->observer.model->d_torque_d_speed, base->d_torque_d_speed, base->d_torque_d_speed / 20));
+    tt_want(pbio_test_int_is_close(srv->observer.model->d_torque_d_acceleration, base->d_torque_d_acceleration, base->d_torque_d_acceleration / 10));
+    tt_want(pbio_test_int_is_close(srv->observer.model->torque_friction, base->torque_friction, base->torque_friction / 10));
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_servo_kp_schedule(pbio_os_state_t *state, void *context) {
+
+    static pbio_servo_t *srv;
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    pbio_port_t *port;
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_B, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+
+    // Generated schedules start low for small errors, and use the full gain
+    // right where proportional control saturates near the target.
+    pbio_control_settings_t *s = &srv->control.settings;
+    int32_t kp_low = s->pid_kp * s->pid_kp_low_pct / 100;
+    tt_want_int_op(s->kp_schedule_error.kp[0], ==, kp_low);
+    tt_want_int_op(s->kp_schedule_error.kp[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE - 1], >, kp_low);
+    tt_want_int_op(s->kp_schedule_error.kp[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE - 1], <, s->pid_kp);
+    tt_want_int_op(s->kp_schedule_target.kp[0], ==, s->pid_kp);
+    tt_want_int_op(s->kp_schedule_target.kp[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE - 1], ==, kp_low);
+
+    // Custom schedule.
+    int32_t kp[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE];
+    int32_t band;
+    for (int i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+        kp[i] = i * 100;
+    }
+    tt_want_uint_op(pbio_control_settings_set_kp_schedule(s, 0, kp), ==, PBIO_ERROR_INVALID_ARG);
+    tt_uint_op(pbio_control_settings_set_kp_schedule(s, 2, kp), ==, PBIO_SUCCESS);
+    kp[1] = 0;
+    pbio_control_settings_get_kp_schedule(s, &band, kp);
+    tt_want_int_op(band, ==, 2);
+    tt_want_int_op(kp[1], ==, 100);
+    tt_want_int_op(s->kp_schedule_error.band, ==, 2000);
+
+    // Changing the gains generates a new schedule.
+    int32_t pid_kp, pid_ki, pid_kd, integral_deadzone, integral_change_max;
+    pbio_control_settings_get_pid(s, &pid_kp, &pid_ki, &pid_kd, &integral_deadzone, &integral_change_max);
+    tt_uint_op(pbio_control_settings_set_pid(s, pid_kp, pid_ki, pid_kd, integral_deadzone, integral_change_max), ==, PBIO_SUCCESS);
+    tt_want_int_op(s->kp_schedule_error.kp[0], ==, kp_low);
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_servo_snapshot(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static pbio_servo_t *srv;
+    static pbio_port_t *port;
+    static uint8_t buf[PBIO_PORT_SNAPSHOT_SIZE];
+    static lego_device_type_id_t id;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Without a motor object, only the angle of the rotation sensor is known.
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    pbio_port_get_snapshot(port, buf);
+    tt_want_uint_op(buf[1], ==, PBIO_PORT_SNAPSHOT_FLAG_ANGLE);
+
+    id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_run_forever(srv, 500), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+
+    // With a motor object, angle and speed are those of the motor.
+    int32_t angle, speed;
+    tt_uint_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    pbio_port_get_snapshot(port, buf);
+    tt_want_uint_op(buf[0], ==, id);
+    tt_want_uint_op(buf[1], ==, PBIO_PORT_SNAPSHOT_FLAG_ANGLE | PBIO_PORT_SNAPSHOT_FLAG_SERVO);
+    tt_want_int_op((int32_t)pbio_get_uint32_le(&buf[4]), ==, angle);
+    tt_want_int_op((int32_t)pbio_get_uint32_le(&buf[8]), ==, speed);
+    tt_want_int_op(pbio_int_math_abs(speed - 500), <, 50);
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
 struct testcase_t pbio_servo_tests[] = {
     PBIO_THREAD_TEST(test_servo_basics),
     PBIO_THREAD_TEST(test_servo_stall),
     PBIO_THREAD_TEST(test_servo_gearing),
+    PBIO_THREAD_TEST(test_servo_synced),
+    PBIO_THREAD_TEST(test_servo_queue),
+    PBIO_THREAD_TEST(test_servo_track),
+    PBIO_THREAD_TEST(test_servo_identify_model),
+    PBIO_THREAD_TEST(test_servo_snapshot),
+    PBIO_THREAD_TEST(test_servo_kp_schedule),
     END_OF_TESTCASES
 };
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <pbio/trace.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include "../drv/clock/clock_test.h"
+
+static void test_trace_record(void *env) {
+    uint8_t buf[2 * PBIO_TRACE_EVENT_HEADER_SIZE + 6];
+    pbio_trace_event_t event;
+    uint32_t offset = 0;
+
+    static const uint8_t data1[] = { 1, 2, 3, 4 };
+    static const uint8_t data2[] = { 5, 6 };
+
+    // Nothing is recorded until started.
+    pbio_trace_record(PBIO_TRACE_EVENT_LUMP_MSG, 0, data1, sizeof(data1));
+    tt_want(!pbio_trace_is_active());
+
+    pbio_trace_start(buf, sizeof(buf));
+    tt_want(pbio_trace_is_active());
+    pbio_test_clock_tick(3);
+    pbio_trace_record(PBIO_TRACE_EVENT_LUMP_MSG, 1, data1, sizeof(data1));
+    pbio_test_clock_tick(2);
+    pbio_trace_record(PBIO_TRACE_EVENT_MOTOR_ANGLE, 2, data2, sizeof(data2));
+
+    // Buffer is full, so this is dropped.
+    pbio_trace_record(PBIO_TRACE_EVENT_IMU_FRAME, 0, data2, 1);
+    tt_want(pbio_trace_is_truncated());
+    tt_want_uint_op(pbio_trace_stop(), ==, sizeof(buf));
+    tt_want(!pbio_trace_is_active());
+
+    tt_want(pbio_trace_read_event(buf, sizeof(buf), &offset, &event));
+    tt_want_uint_op(event.type, ==, PBIO_TRACE_EVENT_LUMP_MSG);
+    tt_want_uint_op(event.id, ==, 1);
+    tt_want_uint_op(event.size, ==, sizeof(data1));
+    tt_want_int_op(memcmp(event.data, data1, sizeof(data1)), ==, 0);
+    uint32_t time = event.time;
+
+    tt_want(pbio_trace_read_event(buf, sizeof(buf), &offset, &event));
+    tt_want_uint_op(event.type, ==, PBIO_TRACE_EVENT_MOTOR_ANGLE);
+    tt_want_uint_op(event.id, ==, 2);
+    tt_want_uint_op(event.size, ==, sizeof(data2));
+    tt_want_uint_op(event.time - time, ==, 2000);
+
+    // End of recording.
+    tt_want(!pbio_trace_read_event(buf, sizeof(buf), &offset, &event));
+
+    // Incomplete events are not read.
+    offset = 0;
+    tt_want(!pbio_trace_read_event(buf, PBIO_TRACE_EVENT_HEADER_SIZE + 1, &offset, &event));
+    tt_want_uint_op(offset, ==, 0);
+}
+
+struct testcase_t pbio_trace_tests[] = {
+    PBIO_TEST(test_trace_record),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pbio/tracepoint.h>
+#include <test-pbio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include "../drv/clock/clock_test.h"
+
+static void test_tracepoint_record(void *env) {
+    pbio_tracepoint_event_t events[4];
+
+    // Nothing is recorded until enabled.
+    pbio_tracepoint_record(PBIO_TRACEPOINT_GC_START, 0, 0);
+    tt_want_uint_op(pbio_tracepoint_get_events(events, 4), ==, 0);
+
+    pbio_tracepoint_set_enabled(true);
+    pbio_tracepoint_record(PBIO_TRACEPOINT_GC_START, 1, 2);
+    pbio_test_clock_tick(3);
+    pbio_tracepoint_record(PBIO_TRACEPOINT_GC_END, 3, 4);
+    pbio_tracepoint_set_enabled(false);
+
+    // Stopped, so this is not recorded.
+    pbio_tracepoint_record(PBIO_TRACEPOINT_UART_RX, 0, 0);
+
+    tt_want_uint_op(pbio_tracepoint_get_events(events, 4), ==, 2);
+    tt_want_uint_op(events[0].id, ==, PBIO_TRACEPOINT_GC_START);
+    tt_want_uint_op(events[0].arg0, ==, 1);
+    tt_want_uint_op(events[0].arg1, ==, 2);
+    tt_want_uint_op(events[1].id, ==, PBIO_TRACEPOINT_GC_END);
+    tt_want_uint_op(events[1].arg0, ==, 3);
+    tt_want_uint_op(events[1].arg1, ==, 4);
+    tt_want_uint_op(events[1].time - events[0].time, ==, 3000);
+
+    // Only the most recent events are kept and returned, oldest first.
+    pbio_tracepoint_set_enabled(true);
+    for (uint32_t i = 0; i < PBIO_CONFIG_TRACEPOINT_NUM_EVENTS + 10; i++) {
+        pbio_tracepoint_record(PBIO_TRACEPOINT_UART_RX, 0, i);
+    }
+    pbio_tracepoint_set_enabled(false);
+
+    tt_want_uint_op(pbio_tracepoint_get_events(events, 4), ==, 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        tt_want_uint_op(events[i].arg1, ==, PBIO_CONFIG_TRACEPOINT_NUM_EVENTS + 6 + i);
+    }
+}
+
+struct testcase_t pbio_tracepoint_tests[] = {
+    PBIO_TEST(test_tracepoint_record),
+    END_OF_TESTCASES
+};
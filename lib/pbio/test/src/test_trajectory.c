@@ -65,6 +65,42 @@ static void test_simple_trajectory(void *env) {
     tt_want_int_op(trj.a2, ==, -command.deceleration / MDEG_PER_DEG);
 }
 
+/**
+ * Checks the error bound of dividing by accelerations with a reciprocal, as
+ * derived in pbio_int_math_reciprocal_div(). The trajectory divides
+ * numerators up to 5 * 20001^2 by accelerations, or sums of two of them,
+ * between 50 and 40000 deg/s^2. The result must never be less than the
+ * truncated quotient, and at most one more.
+ */
+static void test_trajectory_reciprocal(void *env) {
+
+    const int32_t n_max = 5 * 20001 * 20001;
+
+    for (int32_t d = 50; d <= 40000; d++) {
+        pbio_int_math_reciprocal_t reciprocal;
+        pbio_int_math_reciprocal_init(&reciprocal, d);
+
+        // The error is largest just below multiples of the divisor near the
+        // top of the range, where the remainder is d - 1.
+        int32_t top = n_max / d * d;
+        int32_t numerators[] = { 0, 1, d - 1, d, top - 1, top, n_max, top - d - 1, top - 1000 * d - 1 };
+
+        for (uint32_t i = 0; i < PBIO_ARRAY_SIZE(numerators); i++) {
+            int32_t n = numerators[i];
+            int32_t error = pbio_int_math_reciprocal_div(&reciprocal, n) - n / d;
+            tt_want(error == 0 || error == 1);
+
+            // Exact if the product of numerator and divisor is small.
+            if ((int64_t)n * d <= (int64_t)1 << 37) {
+                tt_want_int_op(error, ==, 0);
+            }
+
+            // Negative numerators are rounded toward zero too.
+            tt_want_int_op(pbio_int_math_reciprocal_div(&reciprocal, -n), ==, -(n / d + error));
+        }
+    }
+}
+
 static void walk_trajectory(pbio_trajectory_t *trj) {
 
     // Get the starting reference.
@@ -370,9 +406,72 @@ static void test_position_trajectory(void *env) {
     }
 }
 
+/**
+ * Checks that repeating a relative angle command gives the same trajectory
+ * as the first one, just shifted to the new start time and position.
+ */
+static void test_repeated_trajectory(void *env) {
+
+    pbio_trajectory_command_t command = {
+        .time_start = 1234,
+        .position_start = {
+            .rotations = 3,
+            .millidegrees = 45 * MDEG_PER_DEG,
+        },
+        .speed_start = 0,
+        .speed_target = 500 * MDEG_PER_DEG,
+        .speed_max = 1000 * MDEG_PER_DEG,
+        .acceleration = 2000 * MDEG_PER_DEG,
+        .deceleration = 1500 * MDEG_PER_DEG,
+        .continue_running = false,
+    };
+    command.position_end = command.position_start;
+    pbio_angle_add_mdeg(&command.position_end, 90 * MDEG_PER_DEG);
+
+    pbio_trajectory_t first;
+    tt_want_int_op(pbio_trajectory_new_angle_command(&first, &command), ==, PBIO_SUCCESS);
+
+    // Repeat the same move forward and backward from where the previous one
+    // ended, a few times.
+    for (int32_t i = 0; i < 10; i++) {
+        int32_t sign = i % 2 ? -1 : 1;
+        command.time_start += 100000;
+        command.position_start = command.position_end;
+        pbio_angle_add_mdeg(&command.position_end, sign * 90 * MDEG_PER_DEG);
+
+        pbio_trajectory_t trj;
+        tt_want_int_op(pbio_trajectory_new_angle_command(&trj, &command), ==, PBIO_SUCCESS);
+
+        tt_want_int_op(trj.start.time, ==, command.time_start);
+        tt_want(pbio_angle_diff_mdeg(&trj.start.position, &command.position_start) == 0);
+        tt_want_int_op(trj.t1, ==, first.t1);
+        tt_want_int_op(trj.t2, ==, first.t2);
+        tt_want_int_op(trj.t3, ==, first.t3);
+        tt_want_int_op(trj.th1, ==, sign * first.th1);
+        tt_want_int_op(trj.th2, ==, sign * first.th2);
+        tt_want_int_op(trj.th3, ==, sign * first.th3);
+        tt_want_int_op(trj.w0, ==, sign * first.w0);
+        tt_want_int_op(trj.w1, ==, sign * first.w1);
+        tt_want_int_op(trj.a0, ==, sign * first.a0);
+        tt_want_int_op(trj.a2, ==, sign * first.a2);
+
+        pbio_trajectory_reference_t end;
+        pbio_trajectory_get_endpoint(&trj, &end);
+        tt_want(pbio_angle_diff_mdeg(&end.position, &command.position_end) == 0);
+    }
+
+    // A different start speed must not reuse the earlier result.
+    command.speed_start = 200 * MDEG_PER_DEG;
+    pbio_trajectory_t faster;
+    tt_want_int_op(pbio_trajectory_new_angle_command(&faster, &command), ==, PBIO_SUCCESS);
+    tt_want_int_op(faster.w0, !=, first.w0);
+}
+
 struct testcase_t pbio_trajectory_tests[] = {
     PBIO_TEST(test_simple_trajectory),
+    PBIO_TEST(test_trajectory_reciprocal),
     PBIO_TEST(test_position_trajectory),
     PBIO_TEST(test_infinite_trajectory),
+    PBIO_TEST(test_repeated_trajectory),
     END_OF_TESTCASES
 };
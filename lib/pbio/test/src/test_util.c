@@ -63,9 +63,21 @@ static void test_oneshot(void *env) {
     tt_want(pbio_oneshot(true, &test_oneshot));
 }
 
+static void test_crc32(void *env) {
+    static const uint8_t data[] = "123456789";
+
+    // Standard check value of CRC-32.
+    tt_want_uint_op(pbio_util_crc32(0, data, 9), ==, 0xCBF43926);
+    tt_want_uint_op(pbio_util_crc32(0, data, 0), ==, 0);
+
+    // Same result when computed in chunks.
+    tt_want_uint_op(pbio_util_crc32(pbio_util_crc32(0, data, 4), &data[4], 5), ==, 0xCBF43926);
+}
+
 struct testcase_t pbio_util_tests[] = {
     PBIO_TEST(test_uuid128_reverse_compare),
     PBIO_TEST(test_uuid128_reverse_copy),
     PBIO_TEST(test_oneshot),
+    PBIO_TEST(test_crc32),
     END_OF_TESTCASES
 };
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/protocol.h>
+#include <pbsys/command.h>
+#include <pbsys/host.h>
+#include <test-pbio.h>
+
+static pbio_error_t test_echo_command(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static uint8_t echo[1 + 1 + 200];
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    echo[0] = PBIO_PYBRICKS_COMMAND_ECHO;
+
+    // Flags are required and must be known.
+    tt_want_int_op(pbsys_command(echo, 1), ==, PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED);
+    echo[1] = 0x80;
+    tt_want_int_op(pbsys_command(echo, 2), ==, PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED);
+
+    // Data is queued until it is sent back, refusing what does not fit.
+    echo[1] = 0;
+    tt_want_int_op(pbsys_command(echo, sizeof(echo)), ==, PBIO_PYBRICKS_ERROR_OK);
+    tt_want_int_op(pbsys_command(echo, sizeof(echo)), ==, PBIO_PYBRICKS_ERROR_OK);
+    tt_want_int_op(pbsys_command(echo, sizeof(echo)), ==, PBIO_PYBRICKS_ERROR_BUSY);
+
+    // Without a host, it is dropped, so there is room again.
+    PBIO_OS_AWAIT_MS(state, &timer, 10);
+    tt_want_int_op(pbsys_command(echo, sizeof(echo)), ==, PBIO_PYBRICKS_ERROR_OK);
+
+    // Stdin does not go to the program while it is echoed, and app data
+    // is sent back too.
+    pbsys_host_stdin_flush();
+    echo[1] = PBIO_PYBRICKS_ECHO_FLAG_STDIN | PBIO_PYBRICKS_ECHO_FLAG_APP_DATA;
+    tt_want_int_op(pbsys_command(echo, 2), ==, PBIO_PYBRICKS_ERROR_OK);
+    uint8_t write_stdin[] = { PBIO_PYBRICKS_COMMAND_WRITE_STDIN, 'h', 'i' };
+    pbsys_command(write_stdin, sizeof(write_stdin));
+    tt_want_uint_op(pbsys_host_stdin_get_available(), ==, 0);
+    uint8_t app_data[] = { PBIO_PYBRICKS_COMMAND_WRITE_APP_DATA, 0, 0, 1, 2, 3 };
+    tt_want_int_op(pbsys_command(app_data, sizeof(app_data)), ==, PBIO_PYBRICKS_ERROR_OK);
+
+    // Back to normal.
+    echo[1] = 0;
+    tt_want_int_op(pbsys_command(echo, 2), ==, PBIO_PYBRICKS_ERROR_OK);
+    tt_want_int_op(pbsys_command(write_stdin, sizeof(write_stdin)), ==, PBIO_PYBRICKS_ERROR_OK);
+    tt_want_uint_op(pbsys_host_stdin_get_available(), ==, 2);
+    pbsys_host_stdin_flush();
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+struct testcase_t pbsys_echo_tests[] = {
+    PBIO_THREAD_TEST(test_echo_command),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbsys/config.h>
+#include <pbsys/host.h>
+#include <test-pbio.h>
+
+static void write_str(const char *str) {
+    pbsys_host_stdin_write((const uint8_t *)str, strlen(str));
+}
+
+static pbio_error_t test_host_stdin_line(pbio_os_state_t *state, void *context) {
+    uint8_t data[PBSYS_CONFIG_HOST_STDIN_BUF_SIZE];
+    uint32_t size;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    pbsys_host_stdin_flush();
+
+    // No complete line yet.
+    tt_want_uint_op(pbsys_host_stdin_get_line_size(), ==, 0);
+    write_str("abc");
+    tt_want_uint_op(pbsys_host_stdin_get_line_size(), ==, 0);
+
+    // Line includes the newline, and only the first line counts.
+    write_str("\nde\nf");
+    tt_want_uint_op(pbsys_host_stdin_get_line_size(), ==, 4);
+    size = pbsys_host_stdin_get_line_size();
+    tt_want_int_op(pbsys_host_stdin_read(data, &size), ==, PBIO_SUCCESS);
+    tt_want_int_op(memcmp(data, "abc\n", 4), ==, 0);
+    tt_want_uint_op(pbsys_host_stdin_get_line_size(), ==, 3);
+
+    // Bulk read gets everything that is available.
+    size = sizeof(data);
+    tt_want_int_op(pbsys_host_stdin_read(data, &size), ==, PBIO_SUCCESS);
+    tt_want_uint_op(size, ==, 4);
+    tt_want_int_op(memcmp(data, "de\nf", 4), ==, 0);
+    size = sizeof(data);
+    tt_want_int_op(pbsys_host_stdin_read(data, &size), ==, PBIO_ERROR_AGAIN);
+
+    // A full buffer without newline counts as a line, so it can be read.
+    memset(data, 'x', sizeof(data));
+    tt_want_int_op(pbsys_host_stdin_write(data, pbsys_host_stdin_get_free()), ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbsys_host_stdin_get_free(), ==, 0);
+    tt_want_uint_op(pbsys_host_stdin_get_line_size(), ==, pbsys_host_stdin_get_available());
+
+    // Data that does not fit is dropped as a whole.
+    size = 2;
+    tt_want_int_op(pbsys_host_stdin_read(data, &size), ==, PBIO_SUCCESS);
+    tt_want_int_op(pbsys_host_stdin_write(data, 3), ==, PBIO_ERROR_BUSY);
+    tt_want_uint_op(pbsys_host_stdin_get_free(), ==, 2);
+    tt_want_int_op(pbsys_host_stdin_write(data, 2), ==, PBIO_SUCCESS);
+
+    // Newline found beyond the first chunk that is searched.
+    pbsys_host_stdin_flush();
+    pbsys_host_stdin_write(data, 40);
+    write_str("\n");
+    tt_want_uint_op(pbsys_host_stdin_get_line_size(), ==, 41);
+
+    pbsys_host_stdin_flush();
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_host_stdout_not_listening(pbio_os_state_t *state, void *context) {
+    uint32_t size;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Without a host, stdout is not buffered, so nothing waits to be sent.
+    size = 5;
+    tt_want_int_op(pbsys_host_stdout_write((const uint8_t *)"hello", &size), ==, PBIO_ERROR_INVALID_OP);
+    tt_want(pbsys_host_tx_is_idle());
+    tt_want_uint_op(pbsys_host_stdout_get_dropped(), ==, 0);
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+struct testcase_t pbsys_host_tests[] = {
+    PBIO_THREAD_TEST(test_host_stdin_line),
+    PBIO_THREAD_TEST(test_host_stdout_not_listening),
+    END_OF_TESTCASES
+};
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/port_interface.h>
+#include <pbio/protocol.h>
+#include <pbio/servo.h>
+#include <pbio/util.h>
+#include <pbsys/command.h>
+#include <test-pbio.h>
+
+static pbio_error_t test_motion_servo(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static pbio_servo_t *srv;
+    static pbio_port_t *port;
+    static int32_t angle;
+    static int32_t speed;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Motor on port A is not set up yet.
+    uint8_t get_state[] = { PBIO_PYBRICKS_COMMAND_WRITE_MOTION, PBIO_PYBRICKS_MOTION_ACTION_SERVO_GET_STATE, 0 };
+    tt_want_int_op(pbsys_command(get_state, sizeof(get_state)), !=, PBIO_PYBRICKS_ERROR_OK);
+
+    lego_device_type_id_t id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+    tt_uint_op(pbio_port_get_port(PBIO_PORT_ID_A, &port), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_port_get_servo(port, &id, &srv), ==, PBIO_SUCCESS);
+    tt_uint_op(pbio_servo_setup(srv, id, PBIO_DIRECTION_CLOCKWISE, 1000, true, 0), ==, PBIO_SUCCESS);
+    tt_want_int_op(pbsys_command(get_state, sizeof(get_state)), ==, PBIO_PYBRICKS_ERROR_OK);
+
+    // Incomplete, unknown or out of range actions are rejected as a whole.
+    uint8_t run[] = { PBIO_PYBRICKS_COMMAND_WRITE_MOTION, PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN, 0, 0, 0, 0, 0 };
+    pbio_set_uint32_le(&run[3], 500);
+    tt_want_int_op(pbsys_command(run, sizeof(run) - 1), ==, PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED);
+    run[2] = PBIO_CONFIG_PORT_NUM_DEV;
+    tt_want_int_op(pbsys_command(run, sizeof(run)), ==, PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED);
+    run[1] = 0xff;
+    tt_want_int_op(pbsys_command(run, sizeof(run)), ==, PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED);
+    PBIO_OS_AWAIT_MS(state, &timer, 100);
+    tt_want_int_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, ==, 0);
+
+    // Run and request the state in one command.
+    uint8_t run_and_get_state[] = {
+        PBIO_PYBRICKS_COMMAND_WRITE_MOTION,
+        PBIO_PYBRICKS_MOTION_ACTION_SERVO_RUN, 0, 0, 0, 0, 0,
+        PBIO_PYBRICKS_MOTION_ACTION_SERVO_GET_STATE, 0,
+    };
+    pbio_set_uint32_le(&run_and_get_state[3], 500);
+    tt_want_int_op(pbsys_command(run_and_get_state, sizeof(run_and_get_state)), ==, PBIO_PYBRICKS_ERROR_OK);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    tt_want_int_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, >, 400);
+
+    // Replies that do not fit are refused before anything is applied.
+    uint8_t too_many_replies[1 + 2 * 8] = { PBIO_PYBRICKS_COMMAND_WRITE_MOTION };
+    for (uint32_t i = 1; i < sizeof(too_many_replies); i += 2) {
+        too_many_replies[i] = PBIO_PYBRICKS_MOTION_ACTION_SERVO_GET_STATE;
+    }
+    tt_want_int_op(pbsys_command(too_many_replies, sizeof(too_many_replies)), ==, PBIO_PYBRICKS_ERROR_BUSY);
+
+    uint8_t stop[] = { PBIO_PYBRICKS_COMMAND_WRITE_MOTION, PBIO_PYBRICKS_MOTION_ACTION_SERVO_STOP, 0, PBIO_CONTROL_ON_COMPLETION_BRAKE_SMART + 1 };
+    tt_want_int_op(pbsys_command(stop, sizeof(stop)), ==, PBIO_PYBRICKS_ERROR_VALUE_NOT_ALLOWED);
+    stop[3] = PBIO_CONTROL_ON_COMPLETION_HOLD;
+    tt_want_int_op(pbsys_command(stop, sizeof(stop)), ==, PBIO_PYBRICKS_ERROR_OK);
+    PBIO_OS_AWAIT_MS(state, &timer, 1000);
+    tt_want_int_op(pbio_servo_get_state_user(srv, &angle, &speed), ==, PBIO_SUCCESS);
+    tt_want_int_op(speed, ==, 0);
+
+end:
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+struct testcase_t pbsys_motion_tests[] = {
+    PBIO_THREAD_TEST(test_motion_servo),
+    END_OF_TESTCASES
+};
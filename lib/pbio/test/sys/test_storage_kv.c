@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbdrv/block_device_journal.h>
+#include <pbio/error.h>
+#include <pbsys/config.h>
+#include <pbsys/storage_kv.h>
+#include <test-pbio.h>
+
+#include "../../sys/storage_kv.h"
+
+#if PBSYS_CONFIG_STORAGE_KV
+
+// Reloads the store from the journal, as if the power was cut.
+#define RELOAD(state) do { \
+        pbsys_storage_kv_init(); \
+        PBIO_OS_AWAIT_UNTIL(state, pbsys_storage_kv_get("x", 1, &value, &size) != PBIO_ERROR_AGAIN); \
+} while (0)
+
+static bool value_is(const char *key, const char *expected) {
+    const uint8_t *value;
+    uint32_t size;
+    if (pbsys_storage_kv_get(key, strlen(key), &value, &size) != PBIO_SUCCESS) {
+        return false;
+    }
+    if (!expected) {
+        return value == NULL;
+    }
+    return value && size == strlen(expected) && !memcmp(value, expected, size);
+}
+
+static pbio_error_t set(const char *key, const char *value) {
+    return pbsys_storage_kv_set(key, strlen(key), (const uint8_t *)value, strlen(value));
+}
+
+static pbio_error_t test_storage_kv_basic(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static const uint8_t *value;
+    static uint32_t size;
+    static uint8_t long_value[PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE + 1];
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Nothing is stored yet.
+    tt_want(value_is("a", NULL));
+
+    tt_want_int_op(set("a", "hello"), ==, PBIO_SUCCESS);
+    tt_want_int_op(set("b", ""), ==, PBIO_SUCCESS);
+    tt_want(value_is("a", "hello"));
+    tt_want(value_is("b", ""));
+
+    // Invalid sizes.
+    tt_want_int_op(set("", "x"), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_int_op(set("a key that is much too long", "x"), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_int_op(pbsys_storage_kv_set("a", 1, long_value, sizeof(long_value)), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_int_op(pbsys_storage_kv_set("a", 1, long_value, sizeof(long_value) - 1), ==, PBIO_SUCCESS);
+    tt_want_int_op(set("a", "hello"), ==, PBIO_SUCCESS);
+
+    // Deleting hides the value, also for missing keys.
+    tt_want_int_op(pbsys_storage_kv_delete("b", 1), ==, PBIO_SUCCESS);
+    tt_want_int_op(pbsys_storage_kv_delete("c", 1), ==, PBIO_SUCCESS);
+    tt_want(value_is("b", NULL));
+
+    // Values survive a reload once written.
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    RELOAD(state);
+    tt_want(value_is("a", "hello"));
+    tt_want(value_is("b", NULL));
+
+    // Fill all keys.
+    for (int i = 1; i < PBSYS_CONFIG_STORAGE_KV_NUM_KEYS; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "k%d", i);
+        tt_want_int_op(set(key, key), ==, PBIO_SUCCESS);
+    }
+    tt_want_int_op(set("full", "x"), ==, PBIO_ERROR_INVALID_OP);
+
+    // Deleted keys make room once written.
+    tt_want_int_op(pbsys_storage_kv_delete("k1", 2), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    tt_want_int_op(set("full", "x"), ==, PBIO_SUCCESS);
+
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    RELOAD(state);
+    tt_want(value_is("k1", NULL));
+    tt_want(value_is("k2", "k2"));
+    tt_want(value_is("full", "x"));
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_storage_kv_wear(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static const uint8_t *value;
+    static uint32_t size;
+    static uint32_t i;
+    static char counter[PBSYS_CONFIG_STORAGE_KV_VALUE_SIZE];
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    tt_want_int_op(set("static", "unchanged"), ==, PBIO_SUCCESS);
+
+    // Each update is written, so this wraps around the journal many times.
+    for (i = 0; i < 2000; i++) {
+        memset(counter, 'a' + i % 26, sizeof(counter));
+        snprintf(counter, sizeof(counter), "%u", (unsigned)i);
+        tt_want_int_op(pbsys_storage_kv_set("counter", 7, (const uint8_t *)counter, sizeof(counter)), ==, PBIO_SUCCESS);
+        PBIO_OS_AWAIT_MS(state, &timer, 1);
+
+        if (i % 97 == 0) {
+            RELOAD(state);
+            tt_want(value_is("static", "unchanged"));
+            tt_want(pbsys_storage_kv_get("counter", 7, &value, &size) == PBIO_SUCCESS &&
+                size == sizeof(counter) && !memcmp(value, counter, size));
+        }
+    }
+
+    RELOAD(state);
+    tt_want(value_is("static", "unchanged"));
+    tt_want(pbsys_storage_kv_get("counter", 7, &value, &size) == PBIO_SUCCESS &&
+        size == sizeof(counter) && !memcmp(value, counter, size));
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static pbio_error_t test_storage_kv_power_cut(pbio_os_state_t *state, void *context) {
+
+    static pbio_os_timer_t timer;
+    static pbio_os_state_t sub;
+    static const uint8_t *value;
+    static uint32_t size;
+    static uint32_t offset;
+    static uint32_t word;
+    pbio_error_t err;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    tt_want_int_op(set("a", "one"), ==, PBIO_SUCCESS);
+    tt_want_int_op(set("b", "two"), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+
+    // Find the end of the records in the first sector.
+    for (offset = 0; offset < pbdrv_block_device_journal_get_sector_size(); offset += sizeof(word)) {
+        PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_read(&sub, offset, (uint8_t *)&word, sizeof(word)));
+        tt_want_int_op(err, ==, PBIO_SUCCESS);
+        if (word == UINT32_MAX) {
+            break;
+        }
+    }
+
+    // Write the start of a record, as if the power was cut while writing.
+    static const uint8_t partial[] = { 1, 4, 0, 0, 'c', 'x', 'y' };
+    PBIO_OS_AWAIT(state, &sub, err = pbdrv_block_device_journal_write(&sub, offset, partial, sizeof(partial)));
+    tt_want_int_op(err, ==, PBIO_SUCCESS);
+
+    // The partial record is ignored.
+    RELOAD(state);
+    tt_want(value_is("a", "one"));
+    tt_want(value_is("b", "two"));
+    tt_want(value_is("c", NULL));
+
+    // Further changes are written elsewhere and survive.
+    tt_want_int_op(set("a", "three"), ==, PBIO_SUCCESS);
+    PBIO_OS_AWAIT_MS(state, &timer, 1);
+    RELOAD(state);
+    tt_want(value_is("a", "three"));
+    tt_want(value_is("b", "two"));
+
+    // Changes that were not written yet are lost, but the rest is kept.
+    tt_want_int_op(set("b", "four"), ==, PBIO_SUCCESS);
+    RELOAD(state);
+    tt_want(value_is("a", "three"));
+    tt_want(value_is("b", "two"));
+
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+struct testcase_t pbsys_storage_kv_tests[] = {
+    PBIO_THREAD_TEST(test_storage_kv_basic),
+    PBIO_THREAD_TEST(test_storage_kv_wear),
+    PBIO_THREAD_TEST(test_storage_kv_power_cut),
+    END_OF_TESTCASES
+};
+
+#endif // PBSYS_CONFIG_STORAGE_KV
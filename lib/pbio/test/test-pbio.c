@@ -91,40 +91,78 @@ struct testcase_setup_t pbio_test_setup = {
 };
 
 extern struct testcase_t pbdrv_bluetooth_btstack_tests[];
+extern struct testcase_t pbdrv_counter_tests[];
+extern struct testcase_t pbdrv_display_st7586s_tests[];
 extern struct testcase_t pbdrv_pwm_tests[];
+extern struct testcase_t pbio_adpcm_tests[];
 extern struct testcase_t pbio_angle_tests[];
 extern struct testcase_t pbio_battery_tests[];
+extern struct testcase_t pbio_benchmarks[];
+extern struct testcase_t pbio_clock_sync_tests[];
 extern struct testcase_t pbio_color_tests[];
+extern struct testcase_t pbio_differentiator_tests[];
 extern struct testcase_t pbio_drivebase_tests[];
+extern struct testcase_t pbio_geometry_tests[];
 extern struct testcase_t pbio_image_tests[];
 extern struct testcase_t pbio_light_animation_tests[];
 extern struct testcase_t pbio_color_light_tests[];
+extern struct testcase_t pbio_control_recorder_tests[];
 extern struct testcase_t pbio_light_matrix_tests[];
 extern struct testcase_t pbio_int_math_tests[];
+extern struct testcase_t pbio_logger_tests[];
+extern struct testcase_t pbio_lz4_tests[];
+extern struct testcase_t pbio_mailbox_tests[];
+extern struct testcase_t pbio_os_tests[];
+extern struct testcase_t pbio_pf_ir_tests[];
 extern struct testcase_t pbio_port_lump_tests[];
 extern struct testcase_t pbio_servo_tests[];
+extern struct testcase_t pbio_trace_tests[];
+extern struct testcase_t pbio_tracepoint_tests[];
 extern struct testcase_t pbio_trajectory_tests[];
 extern struct testcase_t pbio_util_tests[];
 extern struct testcase_t pbdrv_bluetooth_tests[];
+extern struct testcase_t pbsys_echo_tests[];
+extern struct testcase_t pbsys_host_tests[];
+extern struct testcase_t pbsys_motion_tests[];
 extern struct testcase_t pbsys_status_tests[];
+extern struct testcase_t pbsys_storage_kv_tests[];
 static struct testgroup_t test_groups[] = {
     { "drv/bluetooth/", pbdrv_bluetooth_btstack_tests },
+    { "drv/counter/", pbdrv_counter_tests },
+    { "drv/display/", pbdrv_display_st7586s_tests },
     { "drv/pwm/", pbdrv_pwm_tests },
+    { "src/adpcm/", pbio_adpcm_tests },
     { "src/angle/", pbio_angle_tests },
     { "src/battery/", pbio_battery_tests },
+    { "src/bench/", pbio_benchmarks },
+    { "src/clock_sync/", pbio_clock_sync_tests },
     { "src/color/", pbio_color_tests },
+    { "src/control_recorder/", pbio_control_recorder_tests },
+    { "src/differentiator/", pbio_differentiator_tests },
     { "src/drivebase/", pbio_drivebase_tests },
+    { "src/geometry/", pbio_geometry_tests },
     { "src/image/", pbio_image_tests },
     { "src/light/", pbio_light_animation_tests },
     { "src/light/", pbio_color_light_tests },
     { "src/light/", pbio_light_matrix_tests },
+    { "src/logger/", pbio_logger_tests },
+    { "src/lz4/", pbio_lz4_tests },
+    { "src/mailbox/", pbio_mailbox_tests },
     { "src/math/", pbio_int_math_tests },
+    { "src/os/", pbio_os_tests },
+    { "src/pf_ir/", pbio_pf_ir_tests },
     { "src/port_lump/", pbio_port_lump_tests },
     { "src/servo/", pbio_servo_tests },
+    { "src/trace/", pbio_trace_tests },
+    { "src/tracepoint/", pbio_tracepoint_tests },
     { "src/trajectory/", pbio_trajectory_tests },
     { "src/util/", pbio_util_tests, },
     { "sys/bluetooth/", pbdrv_bluetooth_tests, },
+    { "sys/echo/", pbsys_echo_tests, },
+    { "sys/host/", pbsys_host_tests, },
+    { "sys/motion/", pbsys_motion_tests, },
     { "sys/status/", pbsys_status_tests, },
+    { "sys/storage_kv/", pbsys_storage_kv_tests, },
     END_OF_GROUPS
 };
 
@@ -30,6 +30,7 @@ void pb_package_pybricks_init(bool import_all);
 #if PYBRICKS_PY_COMMON_BLE
 mp_obj_t pb_type_BLE_new(mp_obj_t broadcast_channel_in, mp_obj_t observe_channels_in);
 void pb_type_ble_start_cleanup(void);
+uint32_t pb_type_ble_get_sync_time(void);
 #endif
 
 #if PYBRICKS_PY_COMMON_CHARGER
@@ -68,7 +69,7 @@ void pb_type_LightMatrix_display_char(pbio_light_matrix_t *light_matrix, mp_obj_
 
 #if PYBRICKS_PY_COMMON_KEYPAD
 // pybricks._common.KeyPad()
-mp_obj_t pb_type_Keypad_obj_new(mp_obj_t parent_obj, pb_type_button_get_pressed_t get_pressed);
+mp_obj_t pb_type_Keypad_obj_new(mp_obj_t parent_obj, pb_type_button_get_pressed_t get_pressed, pb_type_button_get_flags_t get_flags);
 #endif
 
 // pybricks._common.Battery()
@@ -93,7 +94,7 @@ mp_obj_t pb_type_Control_obj_make_new(pbio_control_t *control);
 #if PYBRICKS_PY_COMMON_MOTOR_MODEL
 // pybricks._common.MotorModel()
 extern const mp_obj_type_t pb_type_MotorModel;
-mp_obj_t pb_type_MotorModel_obj_make_new(pbio_observer_t *observer);
+mp_obj_t pb_type_MotorModel_obj_make_new(pbio_servo_t *srv);
 #endif
 
 #if PYBRICKS_PY_COMMON_LOGGER
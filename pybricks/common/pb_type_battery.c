@@ -10,6 +10,8 @@
 #include <pbio/battery.h>
 #include <pbio/button.h>
 
+#include <pbsys/battery.h>
+
 #include "py/obj.h"
 
 #include <pybricks/common.h>
@@ -32,6 +34,25 @@ static mp_obj_t battery_current(void) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_0(battery_current_obj, battery_current);
 
+static mp_obj_t battery_consumed(void) {
+    int32_t charge;
+    pb_assert(pbio_battery_get_program_charge(&charge));
+    return mp_obj_new_int(charge / 1000);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(battery_consumed_obj, battery_consumed);
+
+static mp_obj_t battery_runtime(void) {
+    uint32_t runtime;
+    pbio_error_t err = pbsys_battery_get_remaining_runtime(&runtime);
+    if (err == PBIO_ERROR_AGAIN) {
+        // Not enough data yet, or charging.
+        return mp_const_none;
+    }
+    pb_assert(err);
+    return mp_obj_new_int_from_uint(runtime);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(battery_runtime_obj, battery_runtime);
+
 #if !PYBRICKS_HUB_MOVEHUB
 
 static mp_obj_t battery_type(void) {
@@ -63,6 +84,8 @@ static const mp_rom_map_elem_t battery_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),    MP_ROM_QSTR(MP_QSTR_battery)        },
     { MP_ROM_QSTR(MP_QSTR_voltage),     MP_ROM_PTR(&battery_voltage_obj)    },
     { MP_ROM_QSTR(MP_QSTR_current),     MP_ROM_PTR(&battery_current_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_consumed),    MP_ROM_PTR(&battery_consumed_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_runtime),     MP_ROM_PTR(&battery_runtime_obj)    },
     #if !PYBRICKS_HUB_MOVEHUB
     { MP_ROM_QSTR(MP_QSTR_type),        MP_ROM_PTR(&battery_type_obj)       },
     { MP_ROM_QSTR(MP_QSTR_temperature), MP_ROM_PTR(&battery_temperature_obj) },
@@ -11,6 +11,8 @@
 
 #include <pbdrv/bluetooth.h>
 
+#include <pbio/clock_sync.h>
+
 #include <pbsys/config.h>
 #include <pbsys/status.h>
 #include <pbsys/storage_settings.h>
@@ -36,7 +38,8 @@
 #define RSSI_FILTER_WINDOW_MS (512)
 
 #define OBSERVED_DATA_TIMEOUT_MS (1000)
-#define OBSERVED_DATA_MAX_SIZE (31 /* max adv data size */ - 5 /* overhead */)
+#define OBSERVED_DATA_OVERHEAD (5)
+#define OBSERVED_DATA_MAX_SIZE (PBDRV_BLUETOOTH_MAX_BROADCAST_SIZE - OBSERVED_DATA_OVERHEAD)
 
 typedef struct {
     uint32_t timestamp;
@@ -44,6 +47,14 @@ typedef struct {
     int8_t rssi;
     uint8_t size;
     uint8_t data[OBSERVED_DATA_MAX_SIZE];
+    /** Number of times the data changed. */
+    uint32_t count;
+    /** Value of count when the cached objects were made. */
+    uint32_t cache_count;
+    /** Cached decoded data or MP_OBJ_NULL. */
+    mp_obj_t decoded;
+    /** Cached raw data or MP_OBJ_NULL. */
+    mp_obj_t raw;
 } observed_data_t;
 
 // pointer to dynamically allocated memory - needed for driver callback
@@ -78,11 +89,58 @@ typedef enum {
     PB_BLE_BROADCAST_DATA_TYPE_STR = 5,
     /** The Python @c bytes type. */
     PB_BLE_BROADCAST_DATA_TYPE_BYTES = 6,
+    /** Shared clock time of the sender, used only to sync clocks. */
+    PB_BLE_BROADCAST_DATA_TYPE_TIMESTAMP = 7,
 } pb_ble_broadcast_data_type_t;
 
 #define MFG_SPECIFIC 0xFF
 #define LEGO_CID 0x0397
 
+/**
+ * Estimate of the clock of the hub that is followed with BLE.sync().
+ */
+static pbio_clock_sync_t clock_sync;
+
+/**
+ * Channel of the hub whose clock is followed, or -1 if none.
+ */
+static int16_t clock_sync_channel = -1;
+
+/**
+ * Gets the shared clock time. This is the clock of the hub that is followed
+ * with BLE.sync(), or the local clock if there is none.
+ *
+ * @returns                 The time in ms.
+ */
+uint32_t pb_type_ble_get_sync_time(void) {
+    uint32_t now = mp_hal_ticks_ms();
+    if (clock_sync_channel < 0) {
+        return now;
+    }
+    return pbio_clock_sync_get_remote_time(&clock_sync, now);
+}
+
+/**
+ * Finds the timestamp in received advertising data.
+ *
+ * @param [in]  data        The user broadcast data.
+ * @param [in]  size        The size of @p data in bytes.
+ * @param [out] timestamp   The timestamp, if found.
+ * @returns                 Whether a timestamp was found.
+ */
+static bool find_timestamp(const uint8_t *data, uint8_t size, uint32_t *timestamp) {
+    // The single object indicator has no value, so it is skipped like any
+    // other value.
+    for (size_t index = 0; index < size; index += 1 + (data[index] & 0x1F)) {
+        if (data[index] >> 5 == PB_BLE_BROADCAST_DATA_TYPE_TIMESTAMP &&
+            (data[index] & 0x1F) == sizeof(*timestamp) && index + 1 + sizeof(*timestamp) <= size) {
+            *timestamp = pbio_get_uint32_le(&data[index + 1]);
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Looks up a channel in the observed data table.
  *
@@ -143,9 +201,24 @@ static void handle_observe_event(pbdrv_bluetooth_ad_type_t event_type, const uin
         // Update moving RSSI average based on time difference.
         ch_data->rssi = (ch_data->rssi * (RSSI_FILTER_WINDOW_MS - diff) + rssi * diff) / RSSI_FILTER_WINDOW_MS;
 
-        // Extract user broadcast data from signal.
-        ch_data->size = data[0] - 4;
-        memcpy(ch_data->data, &data[5], OBSERVED_DATA_MAX_SIZE);
+        // Extract user broadcast data from signal. Broadcasters repeat the
+        // same data many times, so only count actual changes.
+        if (data[0] < 4 || data[0] + 1 > length || data[0] - 4 > OBSERVED_DATA_MAX_SIZE) {
+            return;
+        }
+        uint8_t size = data[0] - 4;
+        if (size != ch_data->size || memcmp(ch_data->data, &data[5], size)) {
+            ch_data->count++;
+
+            // A changed timestamp was just taken by the sender, so it has
+            // not been delayed by repeated advertising.
+            uint32_t timestamp;
+            if (channel == clock_sync_channel && find_timestamp(&data[5], size, &timestamp)) {
+                pbio_clock_sync_add_sample(&clock_sync, ch_data->timestamp, timestamp);
+            }
+        }
+        ch_data->size = size;
+        memcpy(ch_data->data, &data[5], size);
     }
 }
 
@@ -163,8 +236,11 @@ static void handle_observe_event(pbdrv_bluetooth_ad_type_t event_type, const uin
 static size_t pb_module_ble_append(uint8_t *dst, size_t index, const void *src, size_t size, pb_ble_broadcast_data_type_t type) {
     size_t next_index = index + size + 1;
 
-    if (next_index > OBSERVED_DATA_MAX_SIZE) {
-        mp_raise_ValueError(MP_ERROR_TEXT("payload limited to 26 bytes"));
+    // Larger payloads are possible if the controller supports extended
+    // advertising, but only hubs that support it too can receive them.
+    size_t max_size = pbdrv_bluetooth_get_max_broadcast_size() - OBSERVED_DATA_OVERHEAD;
+    if (next_index > max_size) {
+        mp_raise_msg_varg(&mp_type_ValueError, MP_ERROR_TEXT("payload limited to %d bytes"), (int)max_size);
     }
 
     dst[index] = type << 5 | size;
@@ -272,7 +348,8 @@ static mp_obj_t wait_or_await_operation(mp_obj_t self_in) {
 static mp_obj_t pb_module_ble_broadcast(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         pb_obj_BLE_t, self,
-        PB_ARG_REQUIRED(data));
+        PB_ARG_REQUIRED(data),
+        PB_ARG_DEFAULT_FALSE(timestamp));
     // On Move Hub, nothing is broadcast if it is called while the
     // move hub is connected to Pybricks Code. Also, broadcasting interferes
     // with observing even when not connected to Pybricks Code.
@@ -289,7 +366,7 @@ static mp_obj_t pb_module_ble_broadcast(size_t n_args, const mp_obj_t *pos_args,
         return wait_or_await_operation(self_in);
     }
 
-    uint8_t data[5 + OBSERVED_DATA_MAX_SIZE];
+    uint8_t data[OBSERVED_DATA_OVERHEAD + OBSERVED_DATA_MAX_SIZE];
 
     // Get either one or several data objects ready for transmission.
     mp_obj_t *objs;
@@ -312,6 +389,12 @@ static mp_obj_t pb_module_ble_broadcast(size_t n_args, const mp_obj_t *pos_args,
         index = pb_module_ble_encode(&data[5], index, objs[i]);
     }
 
+    // Add the shared clock time so observers can sync to it.
+    if (mp_obj_is_true(timestamp_in)) {
+        uint32_t time = pb_type_ble_get_sync_time();
+        index = pb_module_ble_append(&data[5], index, &time, sizeof(time), PB_BLE_BROADCAST_DATA_TYPE_TIMESTAMP);
+    }
+
     data[0] = index + 4; // length
     data[1] = MFG_SPECIFIC;
     pbio_set_uint16_le(&data[2], LEGO_CID);
@@ -328,7 +411,8 @@ static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_ble_broadcast_obj, 1, pb_module_ble_
  * @param [in]      data    Pointer to the start of the advertising data.
  * @param [in,out]  index   When calling, set to the index in @p data to read.
  *                          On return, the value is updated to the next index.
- * @returns                 The decoded value as a Python object.
+ * @returns                 The decoded value as a Python object, or
+ *                          MP_OBJ_NULL for a timestamp.
  * @throws RuntimeError     If the data was invalid and could not be decoded.
  */
 static mp_obj_t pb_module_ble_decode(const observed_data_t *data, size_t *index) {
@@ -391,6 +475,11 @@ static mp_obj_t pb_module_ble_decode(const observed_data_t *data, size_t *index)
             (*index) += size;
             return mp_obj_new_bytes(bytes_data, size);
         }
+        case PB_BLE_BROADCAST_DATA_TYPE_TIMESTAMP:
+            // Only used to sync clocks, so not a value for the user.
+            (*index) += size;
+            return MP_OBJ_NULL;
+
         case PB_BLE_BROADCAST_DATA_TYPE_SINGLE_OBJECT:
             // Does not contain data by itself, is only used as indicator
             // that the next data is the one and only object.
@@ -411,7 +500,7 @@ static mp_obj_t pb_module_ble_decode(const observed_data_t *data, size_t *index)
  * @throws ValueError       If the channel is out of range.
  * @throws RuntimeError     If the last received data was invalid.
  */
-static const observed_data_t *pb_module_ble_get_channel_data(mp_obj_t channel_in) {
+static observed_data_t *pb_module_ble_get_channel_data(mp_obj_t channel_in) {
     mp_int_t channel = mp_obj_get_int(channel_in);
 
     observed_data_t *ch_data = lookup_observed_data(channel);
@@ -426,9 +515,48 @@ static const observed_data_t *pb_module_ble_get_channel_data(mp_obj_t channel_in
         ch_data->rssi = INT8_MIN;
     }
 
+    // Drop cached objects if the data changed since they were made.
+    if (ch_data->cache_count != ch_data->count) {
+        ch_data->cache_count = ch_data->count;
+        ch_data->decoded = MP_OBJ_NULL;
+        ch_data->raw = MP_OBJ_NULL;
+    }
+
     return ch_data;
 }
 
+/**
+ * Decodes all values in the advertising data.
+ *
+ * @param [in]  data        The channel data.
+ * @returns                 The single decoded value or a tuple of values.
+ * @throws RuntimeError     If the data was invalid.
+ */
+static mp_obj_t pb_module_ble_decode_all(const observed_data_t *data) {
+
+    // Handle single object.
+    if (data->size != 0 && data->data[0] >> 5 == PB_BLE_BROADCAST_DATA_TYPE_SINGLE_OBJECT) {
+        size_t value_index = 1;
+        mp_obj_t value = pb_module_ble_decode(data, &value_index);
+        return value == MP_OBJ_NULL ? mp_const_none : value;
+    }
+
+    // Objects can be encoded in as little as one byte so we could have up to
+    // this many objects received.
+    mp_obj_t items[OBSERVED_DATA_MAX_SIZE];
+
+    size_t index = 0;
+    size_t i = 0;
+    while (i < OBSERVED_DATA_MAX_SIZE && index < data->size) {
+        mp_obj_t item = pb_module_ble_decode(data, &index);
+        if (item != MP_OBJ_NULL) {
+            items[i++] = item;
+        }
+    }
+
+    return mp_obj_new_tuple(i, items);
+}
+
 /**
  * Retrieves the last received advertising data.
  *
@@ -442,44 +570,107 @@ static const observed_data_t *pb_module_ble_get_channel_data(mp_obj_t channel_in
  */
 static mp_obj_t pb_module_ble_observe(mp_obj_t self_in, mp_obj_t channel_in) {
 
+    observed_data_t *ch = pb_module_ble_get_channel_data(channel_in);
+
+    // Have not received data yet or timed out.
+    if (ch->rssi == INT8_MIN) {
+
+        pbdrv_bluetooth_restart_observing_request();
+
+        return mp_const_none;
+    }
+
+    // Data did not change since it was last decoded, so return the same
+    // object without allocating.
+    if (ch->decoded != MP_OBJ_NULL) {
+        return ch->decoded;
+    }
+
     // BEWARE OF DRAGONS: The data returned by pb_module_ble_get_channel_data()
     // is only valid until the next PBIO event is processed, which can happen
     // during any MicroPython function call that allocates memory. So, we have
     // to make a copy of it since we are potentially allocating multiple times
     // in a loop below.
-    const observed_data_t ch_data = *pb_module_ble_get_channel_data(channel_in);
+    const observed_data_t ch_data = *ch;
+    mp_obj_t decoded = pb_module_ble_decode_all(&ch_data);
 
-    // Have not received data yet or timed out.
-    if (ch_data.rssi == INT8_MIN) {
+    // Cache the result only if no new data arrived while decoding.
+    if (ch->count == ch_data.count) {
+        ch->decoded = decoded;
+    }
+    return decoded;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(pb_module_ble_observe_obj, pb_module_ble_observe);
 
-        pbdrv_bluetooth_restart_observing_request();
+/**
+ * Retrieves the last received advertising data without decoding it.
+ *
+ * @param [in]  self_in     The BLE object.
+ * @param [in]  channel_in  Python object containing the channel number.
+ * @returns                 Python bytes object with the encoded data or None
+ *                          if no data has been received within
+ *                          ::OBSERVED_DATA_TIMEOUT_MS.
+ * @throws ValueError       If the channel is out of range.
+ */
+static mp_obj_t pb_module_ble_observe_raw(mp_obj_t self_in, mp_obj_t channel_in) {
+
+    observed_data_t *ch = pb_module_ble_get_channel_data(channel_in);
 
+    if (ch->rssi == INT8_MIN) {
+        pbdrv_bluetooth_restart_observing_request();
         return mp_const_none;
     }
 
-    // Handle single object.
-    if (ch_data.size != 0 && ch_data.data[0] >> 5 == PB_BLE_BROADCAST_DATA_TYPE_SINGLE_OBJECT) {
-        size_t value_index = 1;
-        return pb_module_ble_decode(&ch_data, &value_index);
+    // The data is copied by mp_obj_new_bytes before anything else can
+    // change it, and the cache is not used if it changed meanwhile.
+    if (ch->raw == MP_OBJ_NULL) {
+        uint32_t count = ch->count;
+        mp_obj_t raw = mp_obj_new_bytes(ch->data, ch->size);
+        if (ch->count == count) {
+            ch->raw = raw;
+        }
+        return raw;
     }
+    return ch->raw;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(pb_module_ble_observe_raw_obj, pb_module_ble_observe_raw);
 
-    // Objects can be encoded in as little as one byte so we could have up to
-    // this many objects received.
-    mp_obj_t items[OBSERVED_DATA_MAX_SIZE];
+static pbio_error_t pb_module_ble_wait_observe_iterate_once(pbio_os_state_t *state, mp_obj_t channel_in) {
+    observed_data_t *ch_data = lookup_observed_data(MP_OBJ_SMALL_INT_VALUE(channel_in));
+    if (!ch_data) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+    // The state holds the change count when waiting started.
+    return ch_data->count != *state ? PBIO_SUCCESS : PBIO_ERROR_AGAIN;
+}
 
-    size_t index = 0;
-    size_t i;
-    for (i = 0; i < OBSERVED_DATA_MAX_SIZE; i++) {
-        if (index >= ch_data.size) {
-            break;
-        }
+static mp_obj_t pb_module_ble_wait_observe_return_map(mp_obj_t channel_in) {
+    return pb_module_ble_observe(MP_OBJ_NULL, channel_in);
+}
 
-        items[i] = pb_module_ble_decode(&ch_data, &index);
-    }
+/**
+ * Waits until the advertising data of the given channel changes.
+ *
+ * @param [in]  self_in     The BLE object.
+ * @param [in]  channel_in  Python object containing the channel number.
+ * @returns                 Awaitable that returns the new decoded data, like
+ *                          pb_module_ble_observe().
+ * @throws ValueError       If the channel is out of range.
+ */
+static mp_obj_t pb_module_ble_wait_observe(mp_obj_t self_in, mp_obj_t channel_in) {
+    observed_data_t *ch = pb_module_ble_get_channel_data(channel_in);
 
-    return mp_obj_new_tuple(i, items);
+    pb_type_async_t config = {
+        .parent_obj = MP_OBJ_NEW_SMALL_INT(ch->channel),
+        .iter_once = pb_module_ble_wait_observe_iterate_once,
+        .return_map = pb_module_ble_wait_observe_return_map,
+        .state = ch->count,
+    };
+    // Not attached to the BLE object so that several channels can be awaited
+    // at the same time.
+    return pb_type_async_wait_or_await(&config, NULL, false);
 }
-static MP_DEFINE_CONST_FUN_OBJ_2(pb_module_ble_observe_obj, pb_module_ble_observe);
+static MP_DEFINE_CONST_FUN_OBJ_2(pb_module_ble_wait_observe_obj, pb_module_ble_wait_observe);
 
 /**
  * Retrieves the filtered RSSI signal strength of the given channel.
@@ -495,6 +686,27 @@ static mp_obj_t pb_module_ble_signal_strength(mp_obj_t self_in, mp_obj_t channel
 }
 static MP_DEFINE_CONST_FUN_OBJ_2(pb_module_ble_signal_strength_obj, pb_module_ble_signal_strength);
 
+/**
+ * Follows the clock of the hub that broadcasts with timestamps on the given
+ * channel, so that pybricks.tools.sync_time() gives its time.
+ *
+ * @param [in]  self_in     The BLE object.
+ * @param [in]  channel_in  Python object containing the channel number, or
+ *                          None to use the local clock again.
+ * @returns                 None.
+ * @throws ValueError       If the channel is not observed.
+ */
+static mp_obj_t pb_module_ble_sync(mp_obj_t self_in, mp_obj_t channel_in) {
+    pbio_clock_sync_reset(&clock_sync);
+    if (channel_in == mp_const_none) {
+        clock_sync_channel = -1;
+        return mp_const_none;
+    }
+    clock_sync_channel = pb_module_ble_get_channel_data(channel_in)->channel;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(pb_module_ble_sync_obj, pb_module_ble_sync);
+
 /**
  * Gets the Bluetooth chip frimware version.
  * @param [in]  self_in     The BLE MicroPython object instance.
@@ -510,6 +722,7 @@ static MP_DEFINE_CONST_FUN_OBJ_1(pb_module_ble_version_obj, pb_module_ble_versio
 mp_obj_t pb_module_ble_data_close(mp_obj_t self_in) {
     observed_data = NULL;
     num_observed_data = 0;
+    clock_sync_channel = -1;
     return mp_const_none;
 }
 MP_DEFINE_CONST_FUN_OBJ_1(pb_module_ble_data_close_obj, pb_module_ble_data_close);
@@ -518,8 +731,11 @@ static const mp_rom_map_elem_t common_BLE_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_broadcast), MP_ROM_PTR(&pb_module_ble_broadcast_obj) },
     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&pb_module_ble_data_close_obj) },
     { MP_ROM_QSTR(MP_QSTR_observe), MP_ROM_PTR(&pb_module_ble_observe_obj) },
+    { MP_ROM_QSTR(MP_QSTR_observe_raw), MP_ROM_PTR(&pb_module_ble_observe_raw_obj) },
     { MP_ROM_QSTR(MP_QSTR_signal_strength), MP_ROM_PTR(&pb_module_ble_signal_strength_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sync), MP_ROM_PTR(&pb_module_ble_sync_obj) },
     { MP_ROM_QSTR(MP_QSTR_version), MP_ROM_PTR(&pb_module_ble_version_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait_observe), MP_ROM_PTR(&pb_module_ble_wait_observe_obj) },
 };
 static MP_DEFINE_CONST_DICT(common_BLE_locals_dict, common_BLE_locals_dict_table);
 
@@ -562,6 +778,10 @@ mp_obj_t pb_type_BLE_new(mp_obj_t broadcast_channel_in, mp_obj_t observe_channel
 
         self->observed_data[i].channel = channel;
         self->observed_data[i].rssi = INT8_MIN;
+        self->observed_data[i].count = 0;
+        self->observed_data[i].cache_count = 0;
+        self->observed_data[i].decoded = MP_OBJ_NULL;
+        self->observed_data[i].raw = MP_OBJ_NULL;
 
         // Suppress stale data by making everything outdated.
         self->observed_data[i].timestamp = mp_hal_ticks_ms() - RSSI_FILTER_WINDOW_MS - OBSERVED_DATA_TIMEOUT_MS;
@@ -570,6 +790,7 @@ mp_obj_t pb_type_BLE_new(mp_obj_t broadcast_channel_in, mp_obj_t observe_channel
     // globals for driver callback
     observed_data = self->observed_data;
     num_observed_data = num_observe_channels;
+    clock_sync_channel = -1;
 
     // Start observing right away by default.
     if (num_observe_channels > 0) {
@@ -157,6 +157,51 @@ static mp_obj_t pb_type_Control_pid(size_t n_args, const mp_obj_t *pos_args, mp_
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Control_pid_obj, 1, pb_type_Control_pid);
 
+// pybricks._common.Control.kp_schedule
+static mp_obj_t pb_type_Control_kp_schedule(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_Control_obj_t, self,
+        PB_ARG_DEFAULT_NONE(band),
+        PB_ARG_DEFAULT_NONE(gains));
+
+    // Read current values
+    int32_t band;
+    int32_t kp[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE];
+    pbio_control_settings_get_kp_schedule(&self->control->settings, &band, kp);
+
+    // If all given values are none, return current values
+    if (PB_PARSE_ARGS_METHOD_ALL_NONE()) {
+        mp_obj_t gains[PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE];
+        for (size_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+            gains[i] = mp_obj_new_int(kp[i]);
+        }
+        mp_obj_t ret[2];
+        ret[0] = mp_obj_new_int(band);
+        ret[1] = mp_obj_new_tuple(PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE, gains);
+        return mp_obj_new_tuple(2, ret);
+    }
+
+    // Set user settings
+    band = pb_obj_get_default_abs_int(band_in, band);
+    if (gains_in != mp_const_none) {
+        size_t size;
+        mp_obj_t *gains;
+        mp_obj_get_array(gains_in, &size, &gains);
+        if (size != PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE) {
+            pb_assert(PBIO_ERROR_INVALID_ARG);
+        }
+        for (size_t i = 0; i < PBIO_CONFIG_CONTROL_KP_SCHEDULE_SIZE; i++) {
+            kp[i] = mp_obj_get_int(gains[i]);
+        }
+    }
+
+    pb_assert(pbio_control_settings_set_kp_schedule(&self->control->settings, band, kp));
+
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Control_kp_schedule_obj, 1, pb_type_Control_kp_schedule);
+
 // pybricks._common.Control.target_tolerances
 static mp_obj_t pb_type_Control_target_tolerances(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
 
@@ -291,6 +336,7 @@ static const pb_attr_dict_entry_t pb_type_Control_attr_dict[] = {
 static const mp_rom_map_elem_t pb_type_Control_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_limits), MP_ROM_PTR(&pb_type_Control_limits_obj) },
     { MP_ROM_QSTR(MP_QSTR_pid), MP_ROM_PTR(&pb_type_Control_pid_obj) },
+    { MP_ROM_QSTR(MP_QSTR_kp_schedule), MP_ROM_PTR(&pb_type_Control_kp_schedule_obj) },
     { MP_ROM_QSTR(MP_QSTR_target_tolerances), MP_ROM_PTR(&pb_type_Control_target_tolerances_obj) },
     { MP_ROM_QSTR(MP_QSTR_stall_tolerances), MP_ROM_PTR(&pb_type_Control_stall_tolerances_obj) },
     { MP_ROM_QSTR(MP_QSTR_trajectory), MP_ROM_PTR(&pb_type_Control_trajectory_obj) },
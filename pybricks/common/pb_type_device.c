@@ -30,8 +30,18 @@
  */
 void *pb_type_device_get_data(mp_obj_t self_in, uint8_t mode) {
     pb_type_device_obj_base_t *sensor = MP_OBJ_TO_PTR(self_in);
+
+    // Nothing changed since the previous read of this mode, so skip checks.
+    uint32_t generation = pbio_port_lump_get_generation(sensor->lump_dev);
+    if (generation && sensor->ready_generation == generation && sensor->ready_mode == mode) {
+        return sensor->ready_data;
+    }
+
     void *data = NULL;
     pb_assert(pbio_port_lump_get_data(sensor->lump_dev, mode, &data));
+    sensor->ready_generation = generation;
+    sensor->ready_mode = mode;
+    sensor->ready_data = data;
     return data;
 }
 
@@ -47,15 +57,20 @@ void *pb_type_device_get_data(mp_obj_t self_in, uint8_t mode) {
  */
 void *pb_type_device_get_data_blocking(mp_obj_t self_in, uint8_t mode) {
     pb_type_device_obj_base_t *sensor = MP_OBJ_TO_PTR(self_in);
+
+    // Nothing changed since the previous read of this mode, so skip checks.
+    uint32_t generation = pbio_port_lump_get_generation(sensor->lump_dev);
+    if (generation && sensor->ready_generation == generation && sensor->ready_mode == mode) {
+        return sensor->ready_data;
+    }
+
     pb_assert(pbio_port_lump_set_mode(sensor->lump_dev, mode));
     pbio_error_t err;
     while ((err = pbio_port_lump_is_ready(sensor->lump_dev)) == PBIO_ERROR_AGAIN) {
         mp_event_wait_indefinite();
     }
     pb_assert(err);
-    void *data = NULL;
-    pb_assert(pbio_port_lump_get_data(sensor->lump_dev, mode, &data));
-    return data;
+    return pb_type_device_get_data(self_in, mode);
 }
 
 /**
@@ -69,6 +84,11 @@ void *pb_type_device_get_data_blocking(mp_obj_t self_in, uint8_t mode) {
  */
 static pbio_error_t pb_pup_device_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
     pb_type_device_obj_base_t *sensor = MP_OBJ_TO_PTR(self_in);
+
+    // Still ready if nothing changed since it was last found to be ready.
+    if (sensor->ready_generation && sensor->ready_generation == pbio_port_lump_get_generation(sensor->lump_dev)) {
+        return PBIO_SUCCESS;
+    }
     return pbio_port_lump_is_ready(sensor->lump_dev);
 }
 
@@ -109,6 +129,61 @@ MP_DEFINE_CONST_OBJ_TYPE(
     pb_type_device_method, MP_QSTR_function, MP_TYPE_FLAG_BINDS_SELF | MP_TYPE_FLAG_BUILTIN_FUN,
     call, pb_type_device_method_call);
 
+/**
+ * Waits for the next data of a Powered Up device, instead of returning the
+ * most recent data again. Sets the mode first if needed.
+ *
+ * Object @p self_in must be of pb_type_device_obj_base_t type or equivalent.
+ */
+static pbio_error_t pb_pup_device_wait_data_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
+    pb_type_device_obj_base_t *sensor = MP_OBJ_TO_PTR(self_in);
+    pbio_error_t err;
+    uint32_t count;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Wait for the mode to be set, then start counting from its latest data.
+    PBIO_OS_AWAIT_WHILE(state, (err = pbio_port_lump_is_ready(sensor->lump_dev)) == PBIO_ERROR_AGAIN);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    err = pbio_port_lump_get_data_count(sensor->lump_dev, sensor->wait_mode, sensor->wait_changed, &sensor->wait_count);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    PBIO_OS_AWAIT_UNTIL(state, (err = pbio_port_lump_get_data_count(sensor->lump_dev, sensor->wait_mode, sensor->wait_changed, &count)) != PBIO_SUCCESS || count != sensor->wait_count);
+
+    PBIO_OS_ASYNC_END(err);
+}
+
+/**
+ * Waits until a Powered Up device reports new data, so programs can sleep
+ * until data arrives instead of reading the same values over and over.
+ *
+ * Object @p self_in must be of pb_type_device_obj_base_t type or equivalent.
+ *
+ * @param [in]  self_in     The powered up device.
+ * @param [in]  mode        Desired mode.
+ * @param [in]  changed     Whether to wait until the values are different,
+ *                          rather than for any new data.
+ * @param [in]  get_values  Mapping function that creates the return object.
+ * @return                  Awaitable object.
+ */
+mp_obj_t pb_type_device_wait_data(mp_obj_t self_in, uint8_t mode, bool changed, pb_type_async_return_map_t get_values) {
+    pb_type_device_obj_base_t *sensor = MP_OBJ_TO_PTR(self_in);
+    pb_assert(pbio_port_lump_set_mode(sensor->lump_dev, mode));
+    sensor->wait_mode = mode;
+    sensor->wait_changed = changed;
+
+    pb_type_async_t config = {
+        .iter_once = pb_pup_device_wait_data_iter_once,
+        .parent_obj = self_in,
+        .return_map = get_values,
+    };
+    return pb_type_async_wait_or_await(&config, &sensor->last_awaitable, false);
+}
+
 /**
  * Set data for a Powered Up device, such as the brightness of multiple external
  * lights on a sensor. Automatically sets the mode if not already set. Returns
@@ -166,6 +241,7 @@ lego_device_type_id_t pb_type_device_init_class(pb_type_device_obj_base_t *self,
     }
     pb_assert(err);
     self->last_awaitable = NULL;
+    self->ready_generation = 0;
     return actual_id;
 }
 
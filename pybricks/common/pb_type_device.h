@@ -20,6 +20,19 @@ typedef struct _pb_type_device_obj_base_t {
     mp_obj_base_t base;
     pbio_port_lump_dev_t *lump_dev;
     pb_type_async_t *last_awaitable;
+    /**
+     * Generation of the device at which it was last found to be ready, with
+     * the data of ready_mode at ready_data. While the generation of the device
+     * stays the same, these can be used without checking the device again.
+     * Zero if not checked yet.
+     */
+    uint32_t ready_generation;
+    void *ready_data;
+    uint8_t ready_mode;
+    // Mode and data counter used when waiting for new data.
+    uint32_t wait_count;
+    uint8_t wait_mode;
+    bool wait_changed;
 } pb_type_device_obj_base_t;
 
 #if PYBRICKS_PY_DEVICES
@@ -58,6 +71,7 @@ extern const mp_obj_type_t pb_type_device_method;
 mp_obj_t pb_type_device_method_call(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args);
 mp_obj_t pb_type_pupdevices_method(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args);
 lego_device_type_id_t pb_type_device_init_class(pb_type_device_obj_base_t *self, mp_obj_t port_in, lego_device_type_id_t valid_id);
+mp_obj_t pb_type_device_wait_data(mp_obj_t self_in, uint8_t mode, bool changed, pb_type_async_return_map_t get_values);
 mp_obj_t pb_type_device_set_data(pb_type_device_obj_base_t *sensor, uint8_t mode, const void *data, uint8_t size);
 void *pb_type_device_get_data(mp_obj_t self_in, uint8_t mode);
 void *pb_type_device_get_data_blocking(mp_obj_t self_in, uint8_t mode);
@@ -97,12 +97,25 @@ static void pb_type_imu_extract_axis(mp_obj_t obj_in, pbio_geometry_xyz_t *vecto
     }
 }
 
+// Optionally pairs a value with the time at which the IMU measured it, in us.
+static mp_obj_t pb_type_imu_with_timestamp(mp_obj_t value, mp_obj_t timestamp_in) {
+    if (!mp_obj_is_true(timestamp_in)) {
+        return value;
+    }
+    mp_obj_t ret[] = {
+        value,
+        mp_obj_new_int_from_uint(pbio_imu_get_data_time()),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(ret), ret);
+}
+
 // pybricks._common.IMU.acceleration
 static mp_obj_t pb_type_imu_acceleration(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         pb_type_imu_obj_t, self,
         PB_ARG_DEFAULT_NONE(axis),
-        PB_ARG_DEFAULT_TRUE(calibrated));
+        PB_ARG_DEFAULT_TRUE(calibrated),
+        PB_ARG_DEFAULT_FALSE(timestamp));
 
     (void)self;
     pbio_geometry_xyz_t acceleration;
@@ -110,7 +123,7 @@ static mp_obj_t pb_type_imu_acceleration(size_t n_args, const mp_obj_t *pos_args
 
     // If no axis is specified, return a vector of values.
     if (axis_in == mp_const_none) {
-        return pb_type_Matrix_make_vector(3, acceleration.values, false);
+        return pb_type_imu_with_timestamp(pb_type_Matrix_make_vector(3, acceleration.values, false), timestamp_in);
     }
 
     // Otherwise convert user axis to pbio object and project vector onto it.
@@ -119,7 +132,7 @@ static mp_obj_t pb_type_imu_acceleration(size_t n_args, const mp_obj_t *pos_args
 
     float projection;
     pb_assert(pbio_geometry_vector_project(&axis, &acceleration, &projection));
-    return mp_obj_new_float_from_f(projection);
+    return pb_type_imu_with_timestamp(mp_obj_new_float_from_f(projection), timestamp_in);
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_imu_acceleration_obj, 1, pb_type_imu_acceleration);
 
@@ -128,7 +141,8 @@ static mp_obj_t pb_type_imu_angular_velocity(size_t n_args, const mp_obj_t *pos_
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         pb_type_imu_obj_t, self,
         PB_ARG_DEFAULT_NONE(axis),
-        PB_ARG_DEFAULT_TRUE(calibrated));
+        PB_ARG_DEFAULT_TRUE(calibrated),
+        PB_ARG_DEFAULT_FALSE(timestamp));
 
     (void)self;
     pbio_geometry_xyz_t angular_velocity;
@@ -136,7 +150,7 @@ static mp_obj_t pb_type_imu_angular_velocity(size_t n_args, const mp_obj_t *pos_
 
     // If no axis is specified, return a vector of values.
     if (axis_in == mp_const_none) {
-        return pb_type_Matrix_make_vector(3, angular_velocity.values, false);
+        return pb_type_imu_with_timestamp(pb_type_Matrix_make_vector(3, angular_velocity.values, false), timestamp_in);
     }
 
     // Otherwise convert user axis to pbio object and project vector onto it.
@@ -145,7 +159,7 @@ static mp_obj_t pb_type_imu_angular_velocity(size_t n_args, const mp_obj_t *pos_
 
     float projection;
     pb_assert(pbio_geometry_vector_project(&axis, &angular_velocity, &projection));
-    return mp_obj_new_float_from_f(projection);
+    return pb_type_imu_with_timestamp(mp_obj_new_float_from_f(projection), timestamp_in);
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_imu_angular_velocity_obj, 1, pb_type_imu_angular_velocity);
 
@@ -296,9 +310,73 @@ static mp_obj_t pb_type_imu_settings(size_t n_args, const mp_obj_t *pos_args, mp
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_imu_settings_obj, 1, pb_type_imu_settings);
 
+// pybricks._common.IMU.mode
+static mp_obj_t pb_type_imu_mode(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_imu_obj_t, self,
+        PB_ARG_DEFAULT_NONE(data_rate),
+        PB_ARG_DEFAULT_NONE(fusion));
+
+    (void)self;
+
+    uint32_t data_rate;
+    pbio_imu_heading_type_t fusion;
+    pbio_imu_get_mode(&data_rate, &fusion);
+
+    // Fusion is given as the number of dimensions that are estimated.
+    static const uint8_t dimensions[] = {
+        [PBIO_IMU_HEADING_TYPE_NONE] = 0,
+        [PBIO_IMU_HEADING_TYPE_1D] = 1,
+        [PBIO_IMU_HEADING_TYPE_3D] = 3,
+    };
+
+    // Return current values if no arguments are given.
+    if (PB_PARSE_ARGS_METHOD_ALL_NONE()) {
+        mp_obj_t ret[] = {
+            mp_obj_new_int_from_uint(data_rate),
+            MP_OBJ_NEW_SMALL_INT(dimensions[fusion]),
+        };
+        return mp_obj_new_tuple(MP_ARRAY_SIZE(ret), ret);
+    }
+
+    if (data_rate_in != mp_const_none) {
+        data_rate = mp_obj_get_int(data_rate_in);
+    }
+
+    if (fusion_in != mp_const_none) {
+        switch (mp_obj_get_int(fusion_in)) {
+            case 0:
+                fusion = PBIO_IMU_HEADING_TYPE_NONE;
+                break;
+            case 1:
+                fusion = PBIO_IMU_HEADING_TYPE_1D;
+                break;
+            case 3:
+                fusion = PBIO_IMU_HEADING_TYPE_3D;
+                break;
+            default:
+                mp_raise_ValueError(MP_ERROR_TEXT("Fusion must be 0, 1, or 3."));
+        }
+    }
+
+    // Drive bases use the 3D heading.
+    if (fusion != PBIO_IMU_HEADING_TYPE_3D && pbio_drivebase_any_uses_gyro()) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Can't change fusion while gyro in use. Stop driving first."));
+    }
+
+    pb_assert(pbio_imu_set_mode(data_rate, fusion));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_imu_mode_obj, 1, pb_type_imu_mode);
+
 // pybricks._common.IMU.heading
 static mp_obj_t pb_type_imu_heading(mp_obj_t self_in) {
-    return mp_obj_new_float(pbio_imu_get_heading(PBIO_IMU_HEADING_TYPE_3D));
+    uint32_t data_rate;
+    pbio_imu_heading_type_t fusion;
+    pbio_imu_get_mode(&data_rate, &fusion);
+
+    // The 3D heading is not updated if only 1D integration is enabled.
+    return mp_obj_new_float(pbio_imu_get_heading(fusion == PBIO_IMU_HEADING_TYPE_1D ? PBIO_IMU_HEADING_TYPE_1D : PBIO_IMU_HEADING_TYPE_3D));
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_imu_heading_obj, pb_type_imu_heading);
 
@@ -339,6 +417,7 @@ static const mp_rom_map_elem_t pb_type_imu_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_acceleration),     MP_ROM_PTR(&pb_type_imu_acceleration_obj)    },
     { MP_ROM_QSTR(MP_QSTR_angular_velocity), MP_ROM_PTR(&pb_type_imu_angular_velocity_obj)},
     { MP_ROM_QSTR(MP_QSTR_heading),          MP_ROM_PTR(&pb_type_imu_heading_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_mode),             MP_ROM_PTR(&pb_type_imu_mode_obj)            },
     { MP_ROM_QSTR(MP_QSTR_ready),            MP_ROM_PTR(&pb_type_imu_ready_obj)           },
     { MP_ROM_QSTR(MP_QSTR_reset_heading),    MP_ROM_PTR(&pb_type_imu_reset_heading_obj)   },
     { MP_ROM_QSTR(MP_QSTR_rotation),         MP_ROM_PTR(&pb_type_imu_rotation_obj)        },
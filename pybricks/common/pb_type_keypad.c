@@ -19,6 +19,7 @@ typedef struct _common_Keypad_obj_t {
     mp_obj_base_t base;
     mp_obj_t parent_obj;
     pb_type_button_get_pressed_t get_pressed;
+    pb_type_button_get_flags_t get_flags;
 } common_Keypad_obj_t;
 
 // pybricks._common.Keypad.pressed
@@ -28,9 +29,33 @@ static mp_obj_t common_Keypad_pressed(mp_obj_t self_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(common_Keypad_pressed_obj, common_Keypad_pressed);
 
+// pybricks._common.Keypad.pressed_mask
+static mp_obj_t common_Keypad_pressed_mask(mp_obj_t self_in) {
+    common_Keypad_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->get_flags) {
+        pb_assert(PBIO_ERROR_NOT_SUPPORTED);
+    }
+    // Small int, so polling this does not allocate.
+    return MP_OBJ_NEW_SMALL_INT(self->get_flags(self->parent_obj));
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(common_Keypad_pressed_mask_obj, common_Keypad_pressed_mask);
+
+// pybricks._common.Keypad.mask
+static mp_obj_t common_Keypad_mask(size_t n_args, const mp_obj_t *args) {
+    // Bits of the given buttons, to compare with pressed_mask().
+    pbio_button_flags_t flags = 0;
+    for (size_t i = 1; i < n_args; i++) {
+        flags |= pb_type_button_get_button_flag(args[i]);
+    }
+    return MP_OBJ_NEW_SMALL_INT(flags);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR(common_Keypad_mask_obj, 1, common_Keypad_mask);
+
 // dir(pybricks.common.Keypad)
 static const mp_rom_map_elem_t common_Keypad_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_pressed),     MP_ROM_PTR(&common_Keypad_pressed_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_pressed_mask), MP_ROM_PTR(&common_Keypad_pressed_mask_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mask),        MP_ROM_PTR(&common_Keypad_mask_obj)        },
 };
 static MP_DEFINE_CONST_DICT(common_Keypad_locals_dict, common_Keypad_locals_dict_table);
 
@@ -41,9 +66,10 @@ static MP_DEFINE_CONST_OBJ_TYPE(pb_type_Keypad,
     locals_dict, &common_Keypad_locals_dict);
 
 // pybricks._common.Keypad.__init__
-mp_obj_t pb_type_Keypad_obj_new(mp_obj_t parent_obj, pb_type_button_get_pressed_t get_pressed) {
+mp_obj_t pb_type_Keypad_obj_new(mp_obj_t parent_obj, pb_type_button_get_pressed_t get_pressed, pb_type_button_get_flags_t get_flags) {
     common_Keypad_obj_t *self = mp_obj_malloc(common_Keypad_obj_t, &pb_type_Keypad);
     self->get_pressed = get_pressed;
+    self->get_flags = get_flags;
     self->parent_obj = parent_obj;
     return MP_OBJ_FROM_PTR(self);
 }
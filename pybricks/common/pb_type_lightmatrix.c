@@ -5,6 +5,8 @@
 
 #if PYBRICKS_PY_COMMON && PYBRICKS_PY_COMMON_LIGHT_MATRIX
 
+#include <string.h>
+
 #include <pbio/light_matrix.h>
 
 #include "py/mphal.h"
@@ -36,6 +38,8 @@ typedef struct _common_LightMatrix_obj_t {
     pbio_light_matrix_t *light_matrix;
     uint8_t *data;
     uint8_t frames;
+    uint8_t *scroll_columns;
+    size_t num_scroll_columns;
     pb_type_async_t *text_iter;
     text_animation_state_t text;
 } common_LightMatrix_obj_t;
@@ -341,6 +345,60 @@ static mp_obj_t common_LightMatrix_text(size_t n_args, const mp_obj_t *pos_args,
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(common_LightMatrix_text_obj, 1, common_LightMatrix_text);
 
+// pybricks._common.LightMatrix.scroll
+static mp_obj_t common_LightMatrix_scroll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        common_LightMatrix_obj_t, self,
+        PB_ARG_REQUIRED(text),
+        PB_ARG_DEFAULT_INT(interval, 100));
+
+    mp_int_t interval = pb_obj_get_int(interval_in);
+    if (interval < 0 || interval > UINT16_MAX) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    size_t len;
+    const char *data = mp_obj_str_get_data(text_in, &len);
+
+    // Each character is 5 columns wide followed by one blank column. The
+    // text starts with a blank screen so that it scrolls in from the right.
+    size_t size = pbio_light_matrix_get_size(self->light_matrix);
+    size_t num_columns = size + len * 6;
+    if (len == 0 || num_columns > UINT16_MAX) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] < 32 || data[i] > 126) {
+            pb_assert(PBIO_ERROR_INVALID_ARG);
+        }
+    }
+
+    // Stop ongoing text and animations before the buffer is renewed.
+    pb_type_async_schedule_stop_iteration(self->text_iter);
+    pbio_light_matrix_stop_animation(self->light_matrix);
+    self->scroll_columns = m_renew(uint8_t, self->scroll_columns, self->num_scroll_columns, num_columns);
+    self->num_scroll_columns = num_columns;
+
+    // Render the text once, converting font rows into columns.
+    memset(self->scroll_columns, 0, num_columns);
+    for (size_t i = 0; i < len; i++) {
+        const uint8_t *glyph = pb_font_5x5[data[i] - 32];
+        uint8_t *columns = self->scroll_columns + size + i * 6;
+        for (uint8_t r = 0; r < 5; r++) {
+            for (uint8_t c = 0; c < 5; c++) {
+                if (glyph[r] & (1 << (4 - c))) {
+                    columns[c] |= 1 << r;
+                }
+            }
+        }
+    }
+
+    // Scroll in the background until the display is changed.
+    pbio_light_matrix_start_scroll(self->light_matrix, self->scroll_columns, num_columns, interval);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(common_LightMatrix_scroll_obj, 1, common_LightMatrix_scroll);
+
 // dir(pybricks.builtins.LightMatrix)
 static const mp_rom_map_elem_t common_LightMatrix_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_char),            MP_ROM_PTR(&common_LightMatrix_char_obj)            },
@@ -349,6 +407,7 @@ static const mp_rom_map_elem_t common_LightMatrix_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_off),             MP_ROM_PTR(&common_LightMatrix_off_obj)             },
     { MP_ROM_QSTR(MP_QSTR_on),              MP_ROM_PTR(&common_LightMatrix_on_obj)              },
     { MP_ROM_QSTR(MP_QSTR_animate),         MP_ROM_PTR(&common_LightMatrix_animate_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_scroll),          MP_ROM_PTR(&common_LightMatrix_scroll_obj)          },
     { MP_ROM_QSTR(MP_QSTR_pixel),           MP_ROM_PTR(&common_LightMatrix_pixel_obj)           },
     { MP_ROM_QSTR(MP_QSTR_orientation),     MP_ROM_PTR(&common_LightMatrix_orientation_obj)     },
     { MP_ROM_QSTR(MP_QSTR_text),            MP_ROM_PTR(&common_LightMatrix_text_obj)            },
@@ -367,6 +426,8 @@ mp_obj_t pb_type_LightMatrix_obj_new(pbio_light_matrix_t *light_matrix) {
     self->light_matrix = light_matrix;
     pbio_light_matrix_set_orientation(light_matrix, PBIO_GEOMETRY_SIDE_TOP);
     self->text_iter = NULL;
+    self->scroll_columns = NULL;
+    self->num_scroll_columns = 0;
     return MP_OBJ_FROM_PTR(self);
 }
 
@@ -50,7 +50,8 @@ static mp_obj_t tools_Logger_start(size_t n_args, const mp_obj_t *pos_args, mp_m
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         tools_Logger_obj_t, self,
         PB_ARG_REQUIRED(duration),
-        PB_ARG_DEFAULT_INT(down_sample, 1));
+        PB_ARG_DEFAULT_INT(down_sample, 1),
+        PB_ARG_DEFAULT_FALSE(circular));
 
     // Log only one row per divisor samples.
     mp_uint_t down_sample = pbio_int_math_max(pb_obj_get_int(down_sample_in), 1);
@@ -61,8 +62,11 @@ static mp_obj_t tools_Logger_start(size_t n_args, const mp_obj_t *pos_args, mp_m
     self->buf = m_renew(int32_t, self->buf, self->last_size, size);
     self->last_size = size;
 
+    // In circular mode, logging continues and keeps only the most recent rows.
+    pbio_logger_mode_t mode = mp_obj_is_true(circular_in) ? PBIO_LOGGER_MODE_CIRCULAR : PBIO_LOGGER_MODE_LINEAR;
+
     // Indicates that background control loops may enter data in log.
-    pbio_logger_start(self->log, self->buf, num_rows, self->num_cols, down_sample);
+    pbio_logger_start(self->log, self->buf, num_rows, self->num_cols, down_sample, mode);
 
     return mp_const_none;
 }
@@ -78,21 +82,146 @@ static mp_obj_t tools_Logger_stop(mp_obj_t self_in) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(tools_Logger_stop_obj, tools_Logger_stop);
 
+/**
+ * Size of one chunk of binary log data. When sending to the host, each chunk
+ * is sent as one line of base64 text, which fits in a typical BLE MTU.
+ */
+#define LOGGER_BINARY_CHUNK_SIZE (57)
+
+/**
+ * Binary log format version, written in the header.
+ */
+#define LOGGER_BINARY_VERSION (1)
+
+/**
+ * Encoder state for writing a log in binary format.
+ */
+typedef struct {
+    #if PYBRICKS_PY_COMMON_LOGGER_REAL_FILE
+    FILE *file;
+    #endif
+    uint8_t chunk[LOGGER_BINARY_CHUNK_SIZE];
+    size_t size;
+    pbio_error_t err;
+} tools_Logger_encoder_t;
+
+static void tools_Logger_encoder_flush(tools_Logger_encoder_t *enc) {
+    if (enc->size == 0) {
+        return;
+    }
+
+    #if PYBRICKS_PY_COMMON_LOGGER_REAL_FILE
+    if (fwrite(enc->chunk, 1, enc->size, enc->file) != enc->size) {
+        enc->err = PBIO_ERROR_IO;
+    }
+    #else
+    // Encode chunk as one base64 line, so it works with text based file transfer.
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char line[(LOGGER_BINARY_CHUNK_SIZE + 2) / 3 * 4 + 1];
+    size_t len = 0;
+    for (size_t i = 0; i < enc->size; i += 3) {
+        uint32_t triple = enc->chunk[i] << 16;
+        if (i + 1 < enc->size) {
+            triple |= enc->chunk[i + 1] << 8;
+        }
+        if (i + 2 < enc->size) {
+            triple |= enc->chunk[i + 2];
+        }
+        line[len++] = alphabet[(triple >> 18) & 0x3f];
+        line[len++] = alphabet[(triple >> 12) & 0x3f];
+        line[len++] = i + 1 < enc->size ? alphabet[(triple >> 6) & 0x3f] : '=';
+        line[len++] = i + 2 < enc->size ? alphabet[triple & 0x3f] : '=';
+    }
+    line[len++] = '\n';
+    mp_print_strn(&mp_plat_print, line, len, 0, 0, 0);
+    #endif // PYBRICKS_PY_COMMON_LOGGER_REAL_FILE
+
+    enc->size = 0;
+}
+
+static void tools_Logger_encoder_write_byte(tools_Logger_encoder_t *enc, uint8_t byte) {
+    enc->chunk[enc->size++] = byte;
+    if (enc->size == LOGGER_BINARY_CHUNK_SIZE) {
+        tools_Logger_encoder_flush(enc);
+    }
+}
+
+static void tools_Logger_encoder_write_u32(tools_Logger_encoder_t *enc, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        tools_Logger_encoder_write_byte(enc, value >> (i * 8));
+    }
+}
+
+static void tools_Logger_encoder_write_varint(tools_Logger_encoder_t *enc, int32_t value) {
+    // Zigzag encoding, so small negative values are also short.
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+
+    // Write 7 bits at a time, setting the high bit if more follow.
+    while (zigzag >= 0x80) {
+        tools_Logger_encoder_write_byte(enc, (zigzag & 0x7f) | 0x80);
+        zigzag >>= 7;
+    }
+    tools_Logger_encoder_write_byte(enc, zigzag);
+}
+
+/**
+ * Writes the log in a compact binary format.
+ *
+ * The header is "PBLG", the format version (u8), the number of columns (u8),
+ * and the number of rows (u32, little endian). Then each value follows row by
+ * row as a zigzag varint of the difference with the value in the same column
+ * of the previous row. Decode with tools/logger_decode.py.
+ */
+static pbio_error_t tools_Logger_save_binary(tools_Logger_obj_t *self, tools_Logger_encoder_t *enc) {
+
+    uint32_t num_rows = pbio_logger_get_num_rows_used(self->log);
+    uint8_t num_cols = self->log->num_cols;
+
+    tools_Logger_encoder_write_byte(enc, 'P');
+    tools_Logger_encoder_write_byte(enc, 'B');
+    tools_Logger_encoder_write_byte(enc, 'L');
+    tools_Logger_encoder_write_byte(enc, 'G');
+    tools_Logger_encoder_write_byte(enc, LOGGER_BINARY_VERSION);
+    tools_Logger_encoder_write_byte(enc, num_cols);
+    tools_Logger_encoder_write_u32(enc, num_rows);
+
+    for (uint32_t row = 0; row < num_rows && enc->err == PBIO_SUCCESS; row++) {
+
+        int32_t *row_data = pbio_logger_get_row_data(self->log, row);
+        int32_t *prev_data = row == 0 ? NULL : pbio_logger_get_row_data(self->log, row - 1);
+
+        for (uint32_t col = 0; col < num_cols; col++) {
+            int32_t prev = prev_data ? prev_data[col] : 0;
+            tools_Logger_encoder_write_varint(enc, (int32_t)((uint32_t)row_data[col] - (uint32_t)prev));
+        }
+
+        // Writing data can take a while, so give system some time too.
+        MICROPY_VM_HOOK_LOOP
+        mp_handle_pending(true);
+    }
+
+    tools_Logger_encoder_flush(enc);
+    return enc->err;
+}
+
 static mp_obj_t tools_Logger_save(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
 
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         tools_Logger_obj_t, self,
-        PB_ARG_DEFAULT_NONE(path));
+        PB_ARG_DEFAULT_NONE(path),
+        PB_ARG_DEFAULT_FALSE(binary));
 
     // Don't allow any more data to be added to logs.
     pbio_logger_stop(self->log);
 
+    bool binary = mp_obj_is_true(binary_in);
+
     // Get log file path.
-    const char *path = path_in == mp_const_none ? "log.txt" : mp_obj_str_get_str(path_in);
+    const char *path = path_in != mp_const_none ? mp_obj_str_get_str(path_in) : (binary ? "log.bin" : "log.txt");
 
     #if PYBRICKS_PY_COMMON_LOGGER_REAL_FILE
     // Create an empty log file locally.
-    FILE *log_file = fopen(path, "w");
+    FILE *log_file = fopen(path, binary ? "wb" : "w");
     if (log_file == NULL) {
         pb_assert(PBIO_ERROR_IO);
     }
@@ -104,8 +233,18 @@ static mp_obj_t tools_Logger_save(size_t n_args, const mp_obj_t *pos_args, mp_ma
 
     pbio_error_t err = PBIO_SUCCESS;
 
+    if (binary) {
+        tools_Logger_encoder_t enc = {
+            #if PYBRICKS_PY_COMMON_LOGGER_REAL_FILE
+            .file = log_file,
+            #endif
+            .err = PBIO_SUCCESS,
+        };
+        err = tools_Logger_save_binary(self, &enc);
+    }
+
     // Write data to file line by line
-    for (uint32_t row = 0; row < pbio_logger_get_num_rows_used(self->log); row++) {
+    for (uint32_t row = 0; !binary && row < pbio_logger_get_num_rows_used(self->log); row++) {
 
         int32_t *row_data = pbio_logger_get_row_data(self->log, row);
 
@@ -131,7 +270,7 @@ static mp_obj_t tools_Logger_save(size_t n_args, const mp_obj_t *pos_args, mp_ma
 
     #if PYBRICKS_PY_COMMON_LOGGER_REAL_FILE
     // Close the file
-    if (fclose(log_file) != 0) {
+    if (fclose(log_file) != 0 && err == PBIO_SUCCESS) {
         err = PBIO_ERROR_IO;
     }
     #else
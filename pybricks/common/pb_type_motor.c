@@ -140,7 +140,7 @@ static mp_obj_t pb_type_Motor_make_new(const mp_obj_type_t *type, size_t n_args,
 
     #if PYBRICKS_PY_COMMON_MOTOR_MODEL
     // Create an instance of the MotorModel class
-    self->model = pb_type_MotorModel_obj_make_new(&self->srv->observer);
+    self->model = pb_type_MotorModel_obj_make_new(self->srv);
     #endif
 
     #if PYBRICKS_PY_COMMON_LOGGER
@@ -433,6 +433,22 @@ static mp_obj_t pb_type_Motor_track_target(size_t n_args, const mp_obj_t *pos_ar
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Motor_track_target_obj, 1, pb_type_Motor_track_target);
 
+// pybricks.common.Motor.state_into
+static mp_obj_t pb_type_Motor_state_into(mp_obj_t self_in, mp_obj_t buf_in) {
+    pb_type_Motor_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Same values as angle(), speed() and load(), without allocating objects.
+    int32_t state[3];
+    int32_t _;
+    pb_assert(pbio_servo_get_state_user(self->srv, &state[0], &_));
+    pb_assert(pbio_servo_get_speed_user(self->srv, 100, &state[1]));
+    pb_assert(pbio_servo_get_load(self->srv, &state[2]));
+
+    pb_obj_set_int_buffer(buf_in, MP_ARRAY_SIZE(state), state);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(pb_type_Motor_state_into_obj, pb_type_Motor_state_into);
+
 // pybricks.common.Motor.stalled
 static mp_obj_t pb_type_Motor_stalled(mp_obj_t self_in) {
     pb_type_Motor_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -485,21 +501,23 @@ static const mp_rom_map_elem_t pb_type_Motor_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_settings), MP_ROM_PTR(&pb_type_Motor_settings_obj) },
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&pb_type_Motor_close_obj) },
     //
-    // Methods specific to encoded motors
+    // Methods specific to encoded motors. The table is searched in order, so
+    // methods that are typically called in control loops come first.
     //
-    { MP_ROM_QSTR(MP_QSTR_hold), MP_ROM_PTR(&pb_type_Motor_hold_obj) },
     { MP_ROM_QSTR(MP_QSTR_angle), MP_ROM_PTR(&pb_type_Motor_angle_obj) },
     { MP_ROM_QSTR(MP_QSTR_speed), MP_ROM_PTR(&pb_type_Motor_speed_obj) },
-    { MP_ROM_QSTR(MP_QSTR_reset_angle), MP_ROM_PTR(&pb_type_Motor_reset_angle_obj) },
     { MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&pb_type_Motor_run_obj) },
+    { MP_ROM_QSTR(MP_QSTR_track_target), MP_ROM_PTR(&pb_type_Motor_track_target_obj) },
+    { MP_ROM_QSTR(MP_QSTR_hold), MP_ROM_PTR(&pb_type_Motor_hold_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset_angle), MP_ROM_PTR(&pb_type_Motor_reset_angle_obj) },
     { MP_ROM_QSTR(MP_QSTR_run_time), MP_ROM_PTR(&pb_type_Motor_run_time_obj) },
     { MP_ROM_QSTR(MP_QSTR_run_until_stalled), MP_ROM_PTR(&pb_type_Motor_run_until_stalled_obj) },
     { MP_ROM_QSTR(MP_QSTR_run_angle), MP_ROM_PTR(&pb_type_Motor_run_angle_obj) },
     { MP_ROM_QSTR(MP_QSTR_run_target), MP_ROM_PTR(&pb_type_Motor_run_target_obj) },
     { MP_ROM_QSTR(MP_QSTR_stalled), MP_ROM_PTR(&pb_type_Motor_stalled_obj) },
     { MP_ROM_QSTR(MP_QSTR_done), MP_ROM_PTR(&pb_type_Motor_done_obj) },
-    { MP_ROM_QSTR(MP_QSTR_track_target), MP_ROM_PTR(&pb_type_Motor_track_target_obj) },
     { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&pb_type_Motor_load_obj) },
+    { MP_ROM_QSTR(MP_QSTR_state_into), MP_ROM_PTR(&pb_type_Motor_state_into_obj) },
 };
 static MP_DEFINE_CONST_DICT(pb_type_Motor_locals_dict, pb_type_Motor_locals_dict_table);
 
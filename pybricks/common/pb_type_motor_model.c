@@ -6,6 +6,7 @@
 #if PYBRICKS_PY_COMMON_MOTOR_MODEL && MICROPY_PY_BUILTINS_FLOAT
 
 #include <pbio/observer.h>
+#include <pbio/servo.h>
 
 #include "py/obj.h"
 
@@ -18,13 +19,13 @@
 // pybricks._common.MotorModel class object structure
 typedef struct _pb_type_MotorModel_obj_t {
     mp_obj_base_t base;
-    pbio_observer_t *observer;
+    pbio_servo_t *srv;
 } pb_type_MotorModel_obj_t;
 
 // pybricks._common.MotorModel.__init__/__new__
-mp_obj_t pb_type_MotorModel_obj_make_new(pbio_observer_t *observer) {
+mp_obj_t pb_type_MotorModel_obj_make_new(pbio_servo_t *srv) {
     pb_type_MotorModel_obj_t *self = mp_obj_malloc(pb_type_MotorModel_obj_t, &pb_type_MotorModel);
-    self->observer = observer;
+    self->srv = srv;
     return MP_OBJ_FROM_PTR(self);
 }
 
@@ -38,14 +39,14 @@ static mp_obj_t pb_type_MotorModel_settings(size_t n_args, const mp_obj_t *pos_a
     // If all given values are none, return current values.
     if (values_in == mp_const_none) {
         mp_obj_t get_values[] = {
-            mp_obj_new_int(self->observer->settings.stall_speed_limit),
-            mp_obj_new_int(self->observer->settings.stall_time),
-            mp_obj_new_int(self->observer->settings.feedback_voltage_negligible),
-            mp_obj_new_int(self->observer->settings.feedback_voltage_stall_ratio),
-            mp_obj_new_int(self->observer->settings.feedback_gain_low),
-            mp_obj_new_int(self->observer->settings.feedback_gain_high),
-            mp_obj_new_int(self->observer->settings.feedback_gain_threshold),
-            mp_obj_new_int(self->observer->settings.coulomb_friction_speed_cutoff),
+            mp_obj_new_int(self->srv->observer.settings.stall_speed_limit),
+            mp_obj_new_int(self->srv->observer.settings.stall_time),
+            mp_obj_new_int(self->srv->observer.settings.feedback_voltage_negligible),
+            mp_obj_new_int(self->srv->observer.settings.feedback_voltage_stall_ratio),
+            mp_obj_new_int(self->srv->observer.settings.feedback_gain_low),
+            mp_obj_new_int(self->srv->observer.settings.feedback_gain_high),
+            mp_obj_new_int(self->srv->observer.settings.feedback_gain_threshold),
+            mp_obj_new_int(self->srv->observer.settings.coulomb_friction_speed_cutoff),
         };
         return mp_obj_new_tuple(MP_ARRAY_SIZE(get_values), get_values);
     }
@@ -57,14 +58,14 @@ static mp_obj_t pb_type_MotorModel_settings(size_t n_args, const mp_obj_t *pos_a
     if (size != 8) {
         pb_assert(PBIO_ERROR_INVALID_ARG);
     }
-    self->observer->settings.stall_speed_limit = mp_obj_get_int(set_values[0]);
-    self->observer->settings.stall_time = mp_obj_get_int(set_values[1]);
-    self->observer->settings.feedback_voltage_negligible = mp_obj_get_int(set_values[2]);
-    self->observer->settings.feedback_voltage_stall_ratio = mp_obj_get_int(set_values[3]);
-    self->observer->settings.feedback_gain_low = mp_obj_get_int(set_values[4]);
-    self->observer->settings.feedback_gain_high = mp_obj_get_int(set_values[5]);
-    self->observer->settings.feedback_gain_threshold = mp_obj_get_int(set_values[6]);
-    self->observer->settings.coulomb_friction_speed_cutoff = mp_obj_get_int(set_values[7]);
+    self->srv->observer.settings.stall_speed_limit = mp_obj_get_int(set_values[0]);
+    self->srv->observer.settings.stall_time = mp_obj_get_int(set_values[1]);
+    self->srv->observer.settings.feedback_voltage_negligible = mp_obj_get_int(set_values[2]);
+    self->srv->observer.settings.feedback_voltage_stall_ratio = mp_obj_get_int(set_values[3]);
+    self->srv->observer.settings.feedback_gain_low = mp_obj_get_int(set_values[4]);
+    self->srv->observer.settings.feedback_gain_high = mp_obj_get_int(set_values[5]);
+    self->srv->observer.settings.feedback_gain_threshold = mp_obj_get_int(set_values[6]);
+    self->srv->observer.settings.coulomb_friction_speed_cutoff = mp_obj_get_int(set_values[7]);
     return mp_const_none;
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_MotorModel_settings_obj, 1, pb_type_MotorModel_settings);
@@ -77,19 +78,52 @@ static mp_obj_t pb_type_MotorModel_state(mp_obj_t self_in) {
 
     // return mp_obj_new_int(angle);
     mp_obj_t state[] = {
-        mp_obj_new_float_from_f(pbio_angle_diff_mdeg(&self->observer->angle, &zero) / 1000.0f),
-        mp_obj_new_float(self->observer->speed / 1000.0f),
-        mp_obj_new_float(self->observer->current / 10.0f),
-        mp_obj_new_bool(self->observer->stalled),
+        mp_obj_new_float_from_f(pbio_angle_diff_mdeg(&self->srv->observer.angle, &zero) / 1000.0f),
+        mp_obj_new_float(self->srv->observer.speed / 1000.0f),
+        mp_obj_new_float(self->srv->observer.current / 10.0f),
+        mp_obj_new_bool(self->srv->observer.stalled),
     };
     return mp_obj_new_tuple(MP_ARRAY_SIZE(state), state);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(pb_type_MotorModel_state_obj, pb_type_MotorModel_state);
 
+#if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
+static pbio_error_t pb_type_MotorModel_identify_iterate_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    pb_type_MotorModel_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
+    return pbio_servo_identify_model_result(self->srv);
+}
+
+static mp_obj_t pb_type_MotorModel_identify_close(mp_obj_t self_in) {
+    pb_type_MotorModel_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    pb_assert(pbio_servo_stop(self->srv, PBIO_CONTROL_ON_COMPLETION_COAST));
+    return mp_const_none;
+}
+
+// pybricks._common.MotorModel.identify
+static mp_obj_t pb_type_MotorModel_identify(mp_obj_t self_in) {
+    pb_type_MotorModel_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    pb_assert(pbio_servo_identify_model_start(self->srv));
+
+    pb_type_async_t config = {
+        .parent_obj = self_in,
+        .iter_once = pb_type_MotorModel_identify_iterate_once,
+        .close = pb_type_MotorModel_identify_close,
+    };
+    return pb_type_async_wait_or_await(&config, NULL, false);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_MotorModel_identify_obj, pb_type_MotorModel_identify);
+
+#endif // PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+
 // dir(pybricks.common.MotorModel)
 static const mp_rom_map_elem_t pb_type_MotorModel_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_state),    MP_ROM_PTR(&pb_type_MotorModel_state_obj) },
     { MP_ROM_QSTR(MP_QSTR_settings), MP_ROM_PTR(&pb_type_MotorModel_settings_obj) },
+    #if PBIO_CONFIG_SERVO_MODEL_IDENTIFICATION
+    { MP_ROM_QSTR(MP_QSTR_identify), MP_ROM_PTR(&pb_type_MotorModel_identify_obj) },
+    #endif
 };
 static MP_DEFINE_CONST_DICT(pb_type_MotorModel_locals_dict, pb_type_MotorModel_locals_dict_table);
 
@@ -13,7 +13,10 @@
 #if PYBRICKS_PY_COMMON_SPEAKER && MICROPY_PY_BUILTINS_FLOAT
 
 #include <math.h>
+#include <string.h>
+
 #include <pbdrv/sound.h>
+#include <pbio/adpcm.h>
 
 #include "py/mphal.h"
 #include "py/obj.h"
@@ -25,6 +28,13 @@
 #include <pybricks/util_mp/pb_obj_helper.h>
 #include <pybricks/util_pb/pb_error.h>
 
+// Note as stored by Speaker.compile_notes.
+typedef struct {
+    uint32_t frequency;
+    uint32_t on_ms;
+    uint32_t total_ms;
+} pb_type_Speaker_note_t;
+
 typedef struct {
     mp_obj_base_t base;
 
@@ -32,8 +42,16 @@ typedef struct {
     pb_type_async_t *iter;
     pbio_os_timer_t timer;
     mp_obj_t notes_generator;
+    // Next compiled note and number of notes left, if playing compiled notes.
+    const uint8_t *compiled_next;
+    size_t compiled_left;
     uint32_t note_duration;
     uint32_t scaled_duration;
+    #if PBDRV_CONFIG_SOUND_STREAM
+    pbio_adpcm_decoder_t adpcm;
+    // Keeps the data being played from being garbage collected.
+    mp_obj_t adpcm_data;
+    #endif
 
     // volume in 0..100 range
     uint8_t volume;
@@ -71,6 +89,9 @@ static mp_obj_t pb_type_Speaker_make_new(const mp_obj_type_t *type, size_t n_arg
     self->sample_attenuator = INT16_MAX;
 
     self->iter = NULL;
+    #if PBDRV_CONFIG_SOUND_STREAM
+    self->adpcm_data = MP_OBJ_NULL;
+    #endif
 
     return MP_OBJ_FROM_PTR(self);
 }
@@ -90,16 +111,31 @@ static pbio_error_t pb_type_Speaker_beep_iterate_once(pbio_os_state_t *state, mp
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+static pbdrv_beep_waveform_t pb_type_Speaker_get_waveform(mp_obj_t waveform_in) {
+    switch (mp_obj_str_get_qstr(waveform_in)) {
+        case MP_QSTR_square:
+            return PBDRV_BEEP_WAVEFORM_SQUARE;
+        case MP_QSTR_sine:
+            return PBDRV_BEEP_WAVEFORM_SINE;
+        case MP_QSTR_triangle:
+            return PBDRV_BEEP_WAVEFORM_TRIANGLE;
+        default:
+            mp_raise_ValueError(MP_ERROR_TEXT("waveform must be 'square', 'sine' or 'triangle'"));
+    }
+}
+
 static mp_obj_t pb_type_Speaker_beep(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         pb_type_Speaker_obj_t, self,
         PB_ARG_DEFAULT_INT(frequency, 500),
-        PB_ARG_DEFAULT_INT(duration, 100));
+        PB_ARG_DEFAULT_INT(duration, 100),
+        PB_ARG_DEFAULT_QSTR(waveform, square));
 
     mp_int_t frequency = pb_obj_get_int(frequency_in);
     mp_int_t duration = pb_obj_get_int(duration_in);
+    pbdrv_beep_waveform_t waveform = pb_type_Speaker_get_waveform(waveform_in);
 
-    pbdrv_beep_start(frequency, self->sample_attenuator);
+    pbdrv_beep_start_waveform(frequency, self->sample_attenuator, waveform);
 
     if (duration < 0) {
         return mp_const_none;
@@ -118,7 +154,7 @@ static mp_obj_t pb_type_Speaker_beep(size_t n_args, const mp_obj_t *pos_args, mp
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Speaker_beep_obj, 1, pb_type_Speaker_beep);
 
-static void pb_type_Speaker_get_note(mp_obj_t obj, uint32_t note_ms, uint32_t *frequency, uint32_t *total_ms, uint32_t *on_ms) {
+static void pb_type_Speaker_get_note(mp_obj_t obj, uint32_t note_ms, pb_type_Speaker_note_t *result) {
     const char *note = mp_obj_str_get_str(obj);
     int pos = 0;
     mp_float_t freq;
@@ -260,13 +296,13 @@ static void pb_type_Speaker_get_note(mp_obj_t obj, uint32_t note_ms, uint32_t *f
         fraction = fraction * 10 + fraction2;
     }
 
-    *total_ms = note_ms / fraction;
+    uint32_t total_ms = note_ms / fraction;
 
     // optional decorations
 
     if (note[pos++] == '.') {
         // dotted note has length extended by 1/2
-        *total_ms = 3 * *total_ms / 2;
+        total_ms = 3 * total_ms / 2;
     } else {
         pos--;
     }
@@ -278,26 +314,50 @@ static void pb_type_Speaker_get_note(mp_obj_t obj, uint32_t note_ms, uint32_t *f
         pos--;
     }
 
-    *frequency = (uint32_t)freq;
-    *on_ms = release ? 7 * (*total_ms) / 8 : *total_ms;
+    result->frequency = (uint32_t)freq;
+    result->total_ms = total_ms;
+    result->on_ms = release ? 7 * total_ms / 8 : total_ms;
+}
+
+// Gets the duration of a whole note in milliseconds.
+static uint32_t pb_type_Speaker_get_note_duration(mp_obj_t tempo_in) {
+    return 4 * 60 * 1000 / pb_obj_get_int(tempo_in);
+}
+
+// Gets the next note to play, or returns false if there are no more notes.
+static bool pb_type_Speaker_next_note(pb_type_Speaker_obj_t *self, pb_type_Speaker_note_t *note) {
+    // Compiled notes are already parsed. They are copied since the data
+    // need not be aligned.
+    if (self->compiled_next) {
+        if (!self->compiled_left) {
+            return false;
+        }
+        memcpy(note, self->compiled_next, sizeof(*note));
+        self->compiled_next += sizeof(*note);
+        self->compiled_left--;
+        return true;
+    }
+
+    mp_obj_t item = mp_iternext(self->notes_generator);
+    if (item == MP_OBJ_STOP_ITERATION) {
+        return false;
+    }
+    pb_type_Speaker_get_note(item, self->note_duration, note);
+    return true;
 }
 
 static pbio_error_t pb_type_Speaker_play_notes_iterate_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
     pb_type_Speaker_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
-    mp_obj_t item;
+    pb_type_Speaker_note_t note;
 
     PBIO_OS_ASYNC_BEGIN(state);
 
-    while ((item = mp_iternext(self->notes_generator)) != MP_OBJ_STOP_ITERATION) {
-
-        // Parse next note.
-        uint32_t frequency;
-        uint32_t beep_time;
-        pb_type_Speaker_get_note(item, self->note_duration, &frequency, &self->scaled_duration, &beep_time);
+    while (pb_type_Speaker_next_note(self, &note)) {
 
         // On portion of the note.
-        pbdrv_beep_start(frequency, self->sample_attenuator);
-        pbio_os_timer_set(&self->timer, beep_time);
+        self->scaled_duration = note.total_ms;
+        pbdrv_beep_start(note.frequency, self->sample_attenuator);
+        pbio_os_timer_set(&self->timer, note.on_ms);
         PBIO_OS_AWAIT_UNTIL(state, pbio_os_timer_is_expired(&self->timer));
 
         // Off portion of the note.
@@ -315,8 +375,22 @@ static mp_obj_t pb_type_Speaker_play_notes(size_t n_args, const mp_obj_t *pos_ar
         PB_ARG_REQUIRED(notes),
         PB_ARG_DEFAULT_INT(tempo, 120));
 
-    self->notes_generator = mp_getiter(notes_in, NULL);
-    self->note_duration = 4 * 60 * 1000 / pb_obj_get_int(tempo_in);
+    if (mp_obj_is_type(notes_in, &mp_type_bytes)) {
+        // Notes from compile_notes, which already include the tempo.
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(notes_in, &bufinfo, MP_BUFFER_READ);
+        if (bufinfo.len % sizeof(pb_type_Speaker_note_t)) {
+            pb_assert(PBIO_ERROR_INVALID_ARG);
+        }
+        // Keeps the data from being garbage collected while playing.
+        self->notes_generator = notes_in;
+        self->compiled_next = bufinfo.buf;
+        self->compiled_left = bufinfo.len / sizeof(pb_type_Speaker_note_t);
+    } else {
+        self->notes_generator = mp_getiter(notes_in, NULL);
+        self->compiled_next = NULL;
+        self->note_duration = pb_type_Speaker_get_note_duration(tempo_in);
+    }
 
     pb_type_async_t config = {
         .parent_obj = MP_OBJ_FROM_PTR(self),
@@ -328,10 +402,86 @@ static mp_obj_t pb_type_Speaker_play_notes(size_t n_args, const mp_obj_t *pos_ar
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Speaker_play_notes_obj, 1, pb_type_Speaker_play_notes);
 
+static mp_obj_t pb_type_Speaker_compile_notes(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_Speaker_obj_t, self,
+        PB_ARG_REQUIRED(notes),
+        PB_ARG_DEFAULT_INT(tempo, 120));
+    (void)self;
+
+    uint32_t note_duration = pb_type_Speaker_get_note_duration(tempo_in);
+
+    // Parse all notes now, so that play_notes only has to step through them.
+    vstr_t vstr;
+    vstr_init(&vstr, 16 * sizeof(pb_type_Speaker_note_t));
+    mp_obj_t iter = mp_getiter(notes_in, NULL);
+    mp_obj_t item;
+    while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+        pb_type_Speaker_note_t note;
+        pb_type_Speaker_get_note(item, note_duration, &note);
+        vstr_add_strn(&vstr, (const char *)&note, sizeof(note));
+    }
+    return mp_obj_new_bytes_from_vstr(&vstr);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Speaker_compile_notes_obj, 1, pb_type_Speaker_compile_notes);
+
+#if PBDRV_CONFIG_SOUND_STREAM
+
+static uint32_t pb_type_Speaker_adpcm_fill(void *context, uint16_t *samples, uint32_t length) {
+    return pbio_adpcm_decode(context, samples, length);
+}
+
+static pbio_error_t pb_type_Speaker_play_adpcm_iterate_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    pb_type_Speaker_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
+    // The stream has already been started. We just need to await the end.
+    PBIO_OS_ASYNC_BEGIN(state);
+    PBIO_OS_AWAIT_UNTIL(state, pbdrv_sound_stream_is_done());
+    pbdrv_sound_stop();
+    self->adpcm_data = MP_OBJ_NULL;
+    PBIO_OS_ASYNC_END(PBIO_SUCCESS);
+}
+
+static mp_obj_t pb_type_Speaker_play_adpcm(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_Speaker_obj_t, self,
+        PB_ARG_REQUIRED(data),
+        PB_ARG_DEFAULT_INT(sample_rate, 8000),
+        PB_ARG_DEFAULT_INT(block_size, 0));
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data_in, &bufinfo, MP_BUFFER_READ);
+    mp_int_t sample_rate = pb_obj_get_int(sample_rate_in);
+    mp_int_t block_size = pb_obj_get_int(block_size_in);
+    if (sample_rate < 1000 || sample_rate > 48000 || block_size < 0) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Stop the previous sound before changing the decoder it may be using.
+    pbdrv_sound_stop();
+    self->adpcm_data = data_in;
+    pbio_adpcm_decoder_init(&self->adpcm, bufinfo.buf, bufinfo.len, block_size, self->sample_attenuator);
+    pbdrv_sound_stream_start(pb_type_Speaker_adpcm_fill, &self->adpcm, sample_rate);
+
+    pb_type_async_t config = {
+        .parent_obj = MP_OBJ_FROM_PTR(self),
+        .iter_once = pb_type_Speaker_play_adpcm_iterate_once,
+        .close = pb_type_Speaker_close,
+    };
+    // New operation always wins; ongoing sound awaitable is cancelled.
+    return pb_type_async_wait_or_await(&config, &self->iter, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Speaker_play_adpcm_obj, 1, pb_type_Speaker_play_adpcm);
+
+#endif // PBDRV_CONFIG_SOUND_STREAM
+
 static const mp_rom_map_elem_t pb_type_Speaker_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_volume), MP_ROM_PTR(&pb_type_Speaker_volume_obj) },
     { MP_ROM_QSTR(MP_QSTR_beep), MP_ROM_PTR(&pb_type_Speaker_beep_obj) },
     { MP_ROM_QSTR(MP_QSTR_play_notes), MP_ROM_PTR(&pb_type_Speaker_play_notes_obj) },
+    { MP_ROM_QSTR(MP_QSTR_compile_notes), MP_ROM_PTR(&pb_type_Speaker_compile_notes_obj) },
+    #if PBDRV_CONFIG_SOUND_STREAM
+    { MP_ROM_QSTR(MP_QSTR_play_adpcm), MP_ROM_PTR(&pb_type_Speaker_play_adpcm_obj) },
+    #endif
 };
 static MP_DEFINE_CONST_DICT(pb_type_Speaker_locals_dict, pb_type_Speaker_locals_dict_table);
 
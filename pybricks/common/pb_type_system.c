@@ -8,11 +8,16 @@
 #include <string.h>
 
 #include <pbdrv/bluetooth.h>
+#include <pbdrv/clock.h>
 #include <pbdrv/reset.h>
+#include <pbio/imu.h>
+#include <pbio/port_interface.h>
+#include <pbio/util.h>
 #include <pbsys/main.h>
 #include <pbsys/program_stop.h>
 #include <pbsys/status.h>
 #include <pbsys/storage.h>
+#include <pbsys/storage_kv.h>
 
 #include "py/obj.h"
 #include "py/objstr.h"
@@ -128,13 +133,23 @@ static mp_obj_t pb_type_System_storage(size_t n_args, const mp_obj_t *pos_args,
     PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
         PB_ARG_REQUIRED(offset),
         PB_ARG_DEFAULT_NONE(read),
-        PB_ARG_DEFAULT_NONE(write));
+        PB_ARG_DEFAULT_NONE(write),
+        PB_ARG_DEFAULT_NONE(readinto));
 
     // Get offset and confirm integer type.
     mp_int_t offset = mp_obj_get_int(offset_in);
 
+    // Handle read into existing buffer, so large data can be read in chunks
+    // without allocating new objects.
+    if (readinto_in != mp_const_none && read_in == mp_const_none && write_in == mp_const_none) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(readinto_in, &bufinfo, MP_BUFFER_WRITE);
+        pb_assert(pbsys_storage_read_user_data(offset, bufinfo.buf, bufinfo.len));
+        return MP_OBJ_NEW_SMALL_INT(bufinfo.len);
+    }
+
     // Handle read.
-    if (read_in != mp_const_none && write_in == mp_const_none) {
+    if (read_in != mp_const_none && write_in == mp_const_none && readinto_in == mp_const_none) {
         byte *data;
         mp_uint_t size = mp_obj_get_int(read_in);
         pb_assert(pbsys_storage_get_user_data(offset, &data, size));
@@ -142,7 +157,7 @@ static mp_obj_t pb_type_System_storage(size_t n_args, const mp_obj_t *pos_args,
     }
 
     // Handle write.
-    if (write_in != mp_const_none && read_in == mp_const_none) {
+    if (write_in != mp_const_none && read_in == mp_const_none && readinto_in == mp_const_none) {
         mp_buffer_info_t bufinfo;
         mp_get_buffer_raise(write_in, &bufinfo, MP_BUFFER_READ);
 
@@ -151,7 +166,7 @@ static mp_obj_t pb_type_System_storage(size_t n_args, const mp_obj_t *pos_args,
         return mp_const_none;
     }
 
-    mp_raise_TypeError(MP_ERROR_TEXT("Must set either read (int) or write (bytes)."));
+    mp_raise_TypeError(MP_ERROR_TEXT("Must set either read (int), readinto (bytearray), or write (bytes)."));
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_System_storage_obj, 0, pb_type_System_storage);
 
@@ -161,8 +176,103 @@ static mp_obj_t pb_type_System_reset_storage(void) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_0(pb_type_System_reset_storage_obj, pb_type_System_reset_storage);
 
+#if PBSYS_CONFIG_STORAGE_KV
+
+static mp_obj_t pb_type_System_store(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_REQUIRED(key),
+        PB_ARG_DEFAULT_NONE(value));
+
+    size_t key_size;
+    const char *key = mp_obj_str_get_data(key_in, &key_size);
+
+    // Setting None deletes the key.
+    if (value_in == mp_const_none) {
+        pb_assert(pbsys_storage_kv_delete(key, key_size));
+        return mp_const_none;
+    }
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(value_in, &bufinfo, MP_BUFFER_READ);
+    pb_assert(pbsys_storage_kv_set(key, key_size, bufinfo.buf, bufinfo.len));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_System_store_obj, 0, pb_type_System_store);
+
+static mp_obj_t pb_type_System_load(mp_obj_t key_in) {
+    size_t key_size;
+    const char *key = mp_obj_str_get_data(key_in, &key_size);
+
+    const uint8_t *value;
+    uint32_t value_size;
+    pb_assert(pbsys_storage_kv_get(key, key_size, &value, &value_size));
+
+    if (!value) {
+        return mp_const_none;
+    }
+    return mp_obj_new_bytes(value, value_size);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_System_load_obj, pb_type_System_load);
+
+#endif // PBSYS_CONFIG_STORAGE_KV
+
 #endif // PBIO_CONFIG_ENABLE_SYS
 
+/** Size of the snapshot header. */
+#define SNAPSHOT_HEADER_SIZE (12)
+
+/** Size of the IMU data in the snapshot. */
+#if PBIO_CONFIG_IMU
+#define SNAPSHOT_IMU_SIZE (7 * sizeof(float))
+#else
+#define SNAPSHOT_IMU_SIZE (0)
+#endif
+
+#define SNAPSHOT_SIZE (SNAPSHOT_HEADER_SIZE + PBIO_CONFIG_PORT_NUM_DEV * PBIO_PORT_SNAPSHOT_SIZE + SNAPSHOT_IMU_SIZE)
+
+// Writes the state of all ports and the IMU into a buffer in one go, so
+// that control loops can read everything without allocating objects.
+//
+// Layout, little endian: time in ms (u32), time in us (u32), number of ports
+// (u8), size per port (u8), size of IMU data (u8), reserved (u8), then the
+// data of each port as given by pbio_port_get_snapshot(), then heading,
+// angular velocity x, y, z and acceleration x, y, z as floats.
+static mp_obj_t pb_type_System_snapshot(mp_obj_t buf_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.len < SNAPSHOT_SIZE) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer too small"));
+    }
+
+    uint8_t *buf = bufinfo.buf;
+    pbio_set_uint32_le(&buf[0], pbdrv_clock_get_ms());
+    pbio_set_uint32_le(&buf[4], pbdrv_clock_get_us());
+    buf[8] = PBIO_CONFIG_PORT_NUM_DEV;
+    buf[9] = PBIO_PORT_SNAPSHOT_SIZE;
+    buf[10] = SNAPSHOT_IMU_SIZE;
+    buf[11] = 0;
+    buf += SNAPSHOT_HEADER_SIZE;
+
+    for (uint8_t i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
+        pbio_port_get_snapshot(pbio_port_by_index(i), buf);
+        buf += PBIO_PORT_SNAPSHOT_SIZE;
+    }
+
+    #if PBIO_CONFIG_IMU
+    float imu[7];
+    pbio_geometry_xyz_t values;
+    imu[0] = pbio_imu_get_heading(PBIO_IMU_HEADING_TYPE_3D);
+    pbio_imu_get_angular_velocity(&values, true);
+    memcpy(&imu[1], values.values, sizeof(values.values));
+    pbio_imu_get_acceleration(&values, true);
+    memcpy(&imu[4], values.values, sizeof(values.values));
+    memcpy(buf, imu, sizeof(imu));
+    #endif
+
+    return MP_OBJ_NEW_SMALL_INT(SNAPSHOT_SIZE);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_System_snapshot_obj, pb_type_System_snapshot);
+
 #if PYBRICKS_PY_COMMON_SYSTEM_UMM_INFO
 
 // Not in library header for some reason.
@@ -184,12 +294,17 @@ static const mp_rom_map_elem_t common_System_locals_dict_table[] = {
     #if PBDRV_CONFIG_RESET
     { MP_ROM_QSTR(MP_QSTR_reset_reason), MP_ROM_PTR(&pb_type_System_reset_reason_obj) },
     #endif // PBDRV_CONFIG_RESET
+    { MP_ROM_QSTR(MP_QSTR_snapshot), MP_ROM_PTR(&pb_type_System_snapshot_obj) },
     #if PBIO_CONFIG_ENABLE_SYS
     { MP_ROM_QSTR(MP_QSTR_set_stop_button), MP_ROM_PTR(&pb_type_System_set_stop_button_obj) },
     { MP_ROM_QSTR(MP_QSTR_reset_storage), MP_ROM_PTR(&pb_type_System_reset_storage_obj) },
     { MP_ROM_QSTR(MP_QSTR_shutdown), MP_ROM_PTR(&pb_type_System_shutdown_obj) },
     { MP_ROM_QSTR(MP_QSTR_storage), MP_ROM_PTR(&pb_type_System_storage_obj) },
     #endif
+    #if PBSYS_CONFIG_STORAGE_KV
+    { MP_ROM_QSTR(MP_QSTR_store), MP_ROM_PTR(&pb_type_System_store_obj) },
+    { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&pb_type_System_load_obj) },
+    #endif
     #if PYBRICKS_PY_COMMON_SYSTEM_UMM_INFO
     { MP_ROM_QSTR(MP_QSTR_umm_info), MP_ROM_PTR(&pb_type_System_umm_info_obj) },
     #endif
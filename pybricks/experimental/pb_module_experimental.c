@@ -5,12 +5,25 @@
 
 #if PYBRICKS_PY_EXPERIMENTAL
 
+#include "py/gc.h"
 #include "py/mphal.h"
 #include "py/obj.h"
 #include "py/objstr.h"
 #include "py/runtime.h"
 #include "py/mperrno.h"
 
+#include <pbdrv/clock.h>
+
+#include <pbio/color.h>
+#include <pbio/control_recorder.h>
+#include <pbio/drivebase.h>
+#include <pbio/image.h>
+#include <pbio/int_math.h>
+#include <pbio/observer.h>
+#include <pbio/port_interface.h>
+#include <pbio/servo.h>
+#include <pbio/tracepoint.h>
+#include <pbio/trajectory.h>
 #include <pbio/util.h>
 
 #include <pybricks/util_mp/pb_obj_helper.h>
@@ -58,9 +71,359 @@ static mp_obj_t experimental_hello_world(size_t n_args, const mp_obj_t *pos_args
 // See also experimental_globals_table below. This function object is added there to make it importable.
 static MP_DEFINE_CONST_FUN_OBJ_KW(experimental_hello_world_obj, 0, experimental_hello_world);
 
+// Keeps the compiler from optimizing away the benchmarked calls.
+static volatile int32_t benchmark_sink;
+
+static void benchmark_int_math_atan2(uint32_t i) {
+    benchmark_sink = pbio_int_math_atan2(i * 7 - 5000, 3000 - i * 3);
+}
+
+static void benchmark_int_math_sqrt(uint32_t i) {
+    benchmark_sink = pbio_int_math_sqrt(i * 100003);
+}
+
+static void benchmark_int_math_mult_then_div(uint32_t i) {
+    benchmark_sink = pbio_int_math_mult_then_div(i * 12345, 678901, 234567);
+}
+
+static void benchmark_int_math_sin_deg(uint32_t i) {
+    benchmark_sink = pbio_int_math_sin_deg(i);
+}
+
+static void benchmark_trajectory_new_angle_command(uint32_t i) {
+    pbio_trajectory_command_t command = {
+        .position_end.millidegrees = (int32_t)(i % 720) * 1000 - 360000,
+        .speed_start = (int32_t)(i % 7) * 150000 - 450000,
+        .speed_target = 500000,
+        .speed_max = 1000000,
+        .acceleration = 2000000,
+        .deceleration = 2000000,
+    };
+    pbio_trajectory_t trj;
+    pbio_trajectory_new_angle_command(&trj, &command);
+    benchmark_sink = trj.th3;
+}
+
+#if PBIO_CONFIG_SERVO
+static pbio_observer_t benchmark_observer;
+
+static void benchmark_observer_update(uint32_t i) {
+    pbio_angle_t angle = { .millidegrees = i * 1000 };
+    pbio_observer_update(&benchmark_observer, i * PBIO_CONFIG_CONTROL_LOOP_TIME_MS * 10, &angle, PBIO_DCMOTOR_ACTUATION_VOLTAGE, 6000, NULL);
+    benchmark_sink = benchmark_observer.speed;
+}
+#endif // PBIO_CONFIG_SERVO
+
+static void benchmark_color_rgb_to_hsv(uint32_t i) {
+    pbio_color_rgb_t rgb = { .r = i, .g = i * 3, .b = i * 7 };
+    pbio_color_hsv_t hsv;
+    pbio_color_rgb_to_hsv(&rgb, &hsv);
+    benchmark_sink = hsv.h;
+}
+
+#if PBIO_CONFIG_IMAGE
+static uint8_t benchmark_pixels[64 * 64];
+static pbio_image_t benchmark_image;
+
+static void benchmark_image_draw_line(uint32_t i) {
+    pbio_image_draw_line(&benchmark_image, 0, i % 64, 63, 63 - i % 64, 1);
+}
+
+static void benchmark_image_fill_circle(uint32_t i) {
+    pbio_image_fill_circle(&benchmark_image, 32, 32, i % 32, 1);
+}
+
+static void benchmark_image_draw_text(uint32_t i) {
+    pbio_image_draw_text(&benchmark_image, &pbio_font_terminus_normal_16, 0, 20, "Pybricks", 8, 1);
+}
+#endif // PBIO_CONFIG_IMAGE
+
+static void benchmark_gc_collect(uint32_t i) {
+    gc_collect();
+}
+
+typedef struct {
+    const char *name;
+    void (*func)(uint32_t i);
+    uint32_t iterations;
+} benchmark_t;
+
+static const benchmark_t benchmarks[] = {
+    { "int_math_atan2", benchmark_int_math_atan2, 1000 },
+    { "int_math_sqrt", benchmark_int_math_sqrt, 1000 },
+    { "int_math_mult_then_div", benchmark_int_math_mult_then_div, 1000 },
+    { "int_math_sin_deg", benchmark_int_math_sin_deg, 1000 },
+    { "trajectory_new_angle_command", benchmark_trajectory_new_angle_command, 1000 },
+    #if PBIO_CONFIG_SERVO
+    { "observer_update", benchmark_observer_update, 1000 },
+    #endif
+    { "color_rgb_to_hsv", benchmark_color_rgb_to_hsv, 1000 },
+    #if PBIO_CONFIG_IMAGE
+    { "image_draw_line", benchmark_image_draw_line, 100 },
+    { "image_fill_circle", benchmark_image_fill_circle, 100 },
+    { "image_draw_text", benchmark_image_draw_text, 100 },
+    #endif
+    { "gc_collect", benchmark_gc_collect, 10 },
+};
+
+// pybricks.experimental.benchmark
+static mp_obj_t experimental_benchmark(void) {
+
+    #if PBIO_CONFIG_SERVO
+    // Any motor model will do, since the cost does not depend on the values.
+    const pbio_servo_settings_reduced_t *settings = pbio_servo_get_reduced_settings(LEGO_DEVICE_TYPE_ID_SPIKE_M_MOTOR);
+    if (!settings) {
+        settings = pbio_servo_get_reduced_settings(LEGO_DEVICE_TYPE_ID_EV3_LARGE_MOTOR);
+    }
+    benchmark_observer.model = settings ? settings->model : NULL;
+    benchmark_observer.settings = (pbio_observer_settings_t) {
+        .feedback_gain_low = 45,
+        .feedback_gain_high = 45 * 7,
+        .feedback_gain_threshold = 20000,
+        .coulomb_friction_speed_cutoff = 500,
+    };
+    pbio_observer_reset(&benchmark_observer, &(pbio_angle_t) {0});
+    #endif
+
+    #if PBIO_CONFIG_IMAGE
+    pbio_image_init(&benchmark_image, benchmark_pixels, 64, 64, 64);
+    #endif
+
+    uint32_t cycles_per_us = pbdrv_clock_get_cycles_per_us();
+    mp_printf(&mp_plat_print, "%-30s %10s %10s\n", "benchmark", "cycles", "ns");
+
+    for (size_t b = 0; b < MP_ARRAY_SIZE(benchmarks); b++) {
+        const benchmark_t *benchmark = &benchmarks[b];
+
+        #if PBIO_CONFIG_SERVO
+        if (benchmark->func == benchmark_observer_update && !benchmark_observer.model) {
+            continue;
+        }
+        #endif
+
+        uint32_t start = pbdrv_clock_get_cycles();
+        for (uint32_t i = 0; i < benchmark->iterations; i++) {
+            benchmark->func(i);
+        }
+        uint32_t cycles = (pbdrv_clock_get_cycles() - start) / benchmark->iterations;
+
+        mp_printf(&mp_plat_print, "%-30s %10u %10u\n", benchmark->name, cycles, (uint32_t)((uint64_t)cycles * 1000 / cycles_per_us));
+        MICROPY_VM_HOOK_LOOP
+        mp_handle_pending(true);
+    }
+
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(experimental_benchmark_obj, experimental_benchmark);
+
+// Number of size classes in the heap statistics. Class n counts runs of up to
+// 2^n blocks, and the last class also counts all longer runs.
+#define HEAP_STATS_NUM_CLASSES (8)
+
+// Allocation table entry kinds, as in py/gc.c.
+#define HEAP_STATS_AT_FREE (0)
+#define HEAP_STATS_AT_HEAD (1)
+
+typedef struct {
+    size_t alloc_counts[HEAP_STATS_NUM_CLASSES];
+    size_t free_counts[HEAP_STATS_NUM_CLASSES];
+    size_t total_blocks;
+    size_t free_blocks;
+    size_t largest_free_blocks;
+} heap_stats_t;
+
+static uint8_t heap_stats_get_kind(const mp_state_mem_area_t *area, size_t block) {
+    return (area->gc_alloc_table_start[block / 4] >> (2 * (block % 4))) & 3;
+}
+
+static void heap_stats_add_run(heap_stats_t *stats, size_t blocks, bool is_free) {
+    size_t size_class = 0;
+    while (size_class < HEAP_STATS_NUM_CLASSES - 1 && blocks > (1u << size_class)) {
+        size_class++;
+    }
+    if (is_free) {
+        stats->free_counts[size_class]++;
+        stats->free_blocks += blocks;
+        if (blocks > stats->largest_free_blocks) {
+            stats->largest_free_blocks = blocks;
+        }
+    } else {
+        stats->alloc_counts[size_class]++;
+    }
+}
+
+// Walks the allocation table of each heap area. Every allocation starts with
+// a head block, so runs of blocks are split at each head and wherever free
+// and used blocks meet.
+static void heap_stats_collect(heap_stats_t *stats) {
+    const mp_state_mem_area_t *area = &MP_STATE_MEM(area);
+    do {
+        size_t num_blocks = area->gc_alloc_table_byte_len * 4;
+        size_t run = 0;
+        bool run_is_free = false;
+
+        for (size_t block = 0; block < num_blocks; block++) {
+            uint8_t kind = heap_stats_get_kind(area, block);
+            bool is_free = kind == HEAP_STATS_AT_FREE;
+            if (run && (kind == HEAP_STATS_AT_HEAD || is_free != run_is_free)) {
+                heap_stats_add_run(stats, run, run_is_free);
+                run = 0;
+            }
+            run_is_free = is_free;
+            run++;
+        }
+        if (run) {
+            heap_stats_add_run(stats, run, run_is_free);
+        }
+        stats->total_blocks += num_blocks;
+
+        #if MICROPY_GC_SPLIT_HEAP
+        area = area->next;
+        #else
+        area = NULL;
+        #endif
+    } while (area);
+}
+
+static mp_obj_t heap_stats_new_histogram(const size_t *counts) {
+    mp_obj_t items[HEAP_STATS_NUM_CLASSES];
+    for (size_t i = 0; i < HEAP_STATS_NUM_CLASSES; i++) {
+        items[i] = mp_obj_new_int(counts[i]);
+    }
+    return mp_obj_new_tuple(HEAP_STATS_NUM_CLASSES, items);
+}
+
+// pybricks.experimental.heap_stats
+static mp_obj_t experimental_heap_stats(void) {
+    // Collect everything before allocating the result, which changes the heap.
+    heap_stats_t stats = { 0 };
+    heap_stats_collect(&stats);
+
+    mp_obj_t ret[] = {
+        mp_obj_new_int(stats.total_blocks * MICROPY_BYTES_PER_GC_BLOCK),
+        mp_obj_new_int(stats.free_blocks * MICROPY_BYTES_PER_GC_BLOCK),
+        mp_obj_new_int(stats.largest_free_blocks * MICROPY_BYTES_PER_GC_BLOCK),
+        mp_obj_new_int(MICROPY_BYTES_PER_GC_BLOCK),
+        heap_stats_new_histogram(stats.alloc_counts),
+        heap_stats_new_histogram(stats.free_counts),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(ret), ret);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(experimental_heap_stats_obj, experimental_heap_stats);
+
+#if PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+
+// pybricks.experimental.tracepoints_start
+static mp_obj_t experimental_tracepoints_start(void) {
+    pbio_tracepoint_set_enabled(true);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(experimental_tracepoints_start_obj, experimental_tracepoints_start);
+
+// pybricks.experimental.tracepoints_dump
+static mp_obj_t experimental_tracepoints_dump(void) {
+    pbio_tracepoint_set_enabled(false);
+
+    pbio_tracepoint_event_t *events = m_new(pbio_tracepoint_event_t, PBIO_CONFIG_TRACEPOINT_NUM_EVENTS);
+    uint32_t num_events = pbio_tracepoint_get_events(events, PBIO_CONFIG_TRACEPOINT_NUM_EVENTS);
+
+    // One line per event, for lib/pbio/test/animator/trace_parser.py.
+    for (uint32_t i = 0; i < num_events; i++) {
+        mp_printf(&mp_plat_print, "TP %u %u %u %u\n", events[i].time, events[i].id, events[i].arg0, events[i].arg1);
+    }
+
+    m_del(pbio_tracepoint_event_t, events, PBIO_CONFIG_TRACEPOINT_NUM_EVENTS);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(experimental_tracepoints_dump_obj, experimental_tracepoints_dump);
+
+#endif // PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+
+#if PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+
+// pybricks.experimental.control_recorder_start
+static mp_obj_t experimental_control_recorder_start(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_TRUE(stall),
+        PB_ARG_DEFAULT_NONE(error),
+        PB_ARG_DEFAULT_INT(after, 50));
+
+    uint32_t triggers = 0;
+    if (mp_obj_is_true(stall_in)) {
+        triggers |= PBIO_CONTROL_RECORDER_TRIGGER_STALL;
+    }
+    int32_t error = 0;
+    if (error_in != mp_const_none) {
+        triggers |= PBIO_CONTROL_RECORDER_TRIGGER_ERROR;
+        error = pb_obj_get_positive_int(error_in);
+    }
+    pbio_control_recorder_start(triggers, error, pb_obj_get_positive_int(after_in));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(experimental_control_recorder_start_obj, 0, experimental_control_recorder_start);
+
+// Prints which motor or drive base a controller belongs to.
+static void control_recorder_print_controller(const pbio_control_t *ctl) {
+    #if PBIO_CONFIG_SERVO
+    for (uint8_t i = 0; i < PBIO_CONFIG_PORT_NUM_DEV; i++) {
+        lego_device_type_id_t type_id = LEGO_DEVICE_TYPE_ID_ANY_ENCODED_MOTOR;
+        pbio_servo_t *srv;
+        if (pbio_port_get_servo(pbio_port_by_index(i), &type_id, &srv) == PBIO_SUCCESS && ctl == &srv->control) {
+            mp_printf(&mp_plat_print, "motor%u", i);
+            return;
+        }
+    }
+    #endif
+    #if PBIO_CONFIG_NUM_DRIVEBASES > 0
+    for (uint8_t i = 0; i < PBIO_CONFIG_NUM_DRIVEBASES; i++) {
+        pbio_drivebase_t *db = pbio_drivebase_by_index(i);
+        if (ctl == &db->control_distance || ctl == &db->control_heading) {
+            mp_printf(&mp_plat_print, "%s%u", ctl == &db->control_distance ? "distance" : "heading", i);
+            return;
+        }
+    }
+    #endif
+    mp_printf(&mp_plat_print, "unknown");
+}
+
+// pybricks.experimental.control_recorder_dump
+static mp_obj_t experimental_control_recorder_dump(void) {
+    bool done = pbio_control_recorder_get_state() == PBIO_CONTROL_RECORDER_STATE_DONE;
+    pbio_control_recorder_stop();
+
+    pbio_control_recorder_sample_t *samples = m_new(pbio_control_recorder_sample_t, PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES);
+    uint32_t num_samples = pbio_control_recorder_get_samples(samples, PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES);
+
+    mp_printf(&mp_plat_print, "time controller position_ref position_estimate position_error speed_ref speed_estimate actuation actuation_value status\n");
+    for (uint32_t i = 0; i < num_samples; i++) {
+        const pbio_control_recorder_sample_t *sample = &samples[i];
+        mp_printf(&mp_plat_print, "%u ", pbio_control_time_ticks_to_ms(sample->time));
+        control_recorder_print_controller(sample->ctl);
+        mp_printf(&mp_plat_print, " %d %d %d %d %d %u %d %u\n",
+            sample->position_ref, sample->position_estimate, sample->position_error,
+            sample->speed_ref, sample->speed_estimate, sample->actuation, sample->actuation_value, sample->status);
+    }
+
+    m_del(pbio_control_recorder_sample_t, samples, PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES);
+    return mp_obj_new_bool(done);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(experimental_control_recorder_dump_obj, experimental_control_recorder_dump);
+
+#endif // PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+
 static const mp_rom_map_elem_t experimental_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_experimental) },
+    { MP_ROM_QSTR(MP_QSTR_benchmark), MP_ROM_PTR(&experimental_benchmark_obj) },
+    #if PBIO_CONFIG_CONTROL_RECORDER_NUM_SAMPLES
+    { MP_ROM_QSTR(MP_QSTR_control_recorder_dump), MP_ROM_PTR(&experimental_control_recorder_dump_obj) },
+    { MP_ROM_QSTR(MP_QSTR_control_recorder_start), MP_ROM_PTR(&experimental_control_recorder_start_obj) },
+    #endif
+    { MP_ROM_QSTR(MP_QSTR_heap_stats), MP_ROM_PTR(&experimental_heap_stats_obj) },
     { MP_ROM_QSTR(MP_QSTR_hello_world), MP_ROM_PTR(&experimental_hello_world_obj) },
+    #if PBIO_CONFIG_TRACEPOINT_NUM_EVENTS
+    { MP_ROM_QSTR(MP_QSTR_tracepoints_dump), MP_ROM_PTR(&experimental_tracepoints_dump_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tracepoints_start), MP_ROM_PTR(&experimental_tracepoints_start_obj) },
+    #endif
 };
 static MP_DEFINE_CONST_DICT(pb_module_experimental_globals, experimental_globals_table);
 
@@ -48,11 +48,25 @@ typedef struct {
      * immediately copied to the driver on the first call to the protothread.
      */
     pbdrv_i2c_dev_t *i2c_dev;
+    pbio_port_t *port;
     uint8_t address;
     bool nxt_quirk;
     size_t write_len;
     size_t read_len;
     uint8_t *read_buf;
+    /**
+     * Operations of an ongoing list of I2C operations, or NULL if the ongoing
+     * operation is a single one. The read data of all operations is stored
+     * consecutively at read_buf.
+     */
+    pbdrv_i2c_op_t *ops;
+    size_t num_ops;
+    /**
+     * Register of an ongoing read that is served by the polling job of the
+     * port, as set up by I2CDevice.poll. Only used if polled is true.
+     */
+    uint8_t poll_reg;
+    bool polled;
     /**
      * Maps bytes read to the user return object.
      */
@@ -85,10 +99,14 @@ mp_obj_t pb_type_i2c_device_make_new(mp_obj_t sensor_obj, mp_obj_t port_in, uint
 
     device_obj_t *device = mp_obj_malloc(device_obj_t, &pb_type_i2c_device);
     device->i2c_dev = i2c_dev;
+    device->port = port;
     device->address = address;
     device->nxt_quirk = nxt_quirk;
     device->sensor_obj = sensor_obj;
     device->iter = NULL;
+    device->ops = NULL;
+    device->num_ops = 0;
+    device->polled = false;
     if (powered) {
         pbio_port_p1p2_set_power(port, PBIO_PORT_POWER_REQUIREMENTS_BATTERY_VOLTAGE_P1_POS);
     }
@@ -123,6 +141,14 @@ static pbio_error_t pb_type_i2c_device_iterate_once(pbio_os_state_t *state, mp_o
 
     device_obj_t *device = MP_OBJ_TO_PTR(i2c_device_obj);
 
+    if (device->polled) {
+        return pbio_port_i2c_poll_get(device->port, device->address, device->poll_reg, device->read_len, &device->read_buf, NULL);
+    }
+
+    if (device->ops) {
+        return pbdrv_i2c_write_then_read_list(state, device->i2c_dev, device->address, device->ops, device->num_ops, device->nxt_quirk);
+    }
+
     return pbdrv_i2c_write_then_read(
         state, device->i2c_dev,
         device->address,
@@ -151,6 +177,20 @@ static mp_obj_t pb_type_i2c_device_return_generic(mp_obj_t i2c_device_obj) {
     return device->return_map(device->sensor_obj, device->read_buf, device->read_len);
 }
 
+/**
+ * Returns the awaitable for an operation that was just started.
+ */
+static mp_obj_t pb_type_i2c_device_await(device_obj_t *device, pbio_os_state_t state) {
+    pb_type_async_t config = {
+        .parent_obj = MP_OBJ_FROM_PTR(device),
+        .iter_once = pb_type_i2c_device_iterate_once,
+        .state = state,
+        .return_map = device->return_map ? pb_type_i2c_device_return_generic : NULL,
+    };
+    // New operation always wins; ongoing sound awaitable is cancelled.
+    return pb_type_async_wait_or_await(&config, &device->iter, true);
+}
+
 mp_obj_t pb_type_i2c_device_start_operation(mp_obj_t i2c_device_obj, const uint8_t *write_data, size_t write_len, size_t read_len, pb_type_i2c_device_return_map_t return_map) {
 
     pb_assert_type(i2c_device_obj, &pb_type_i2c_device);
@@ -179,16 +219,60 @@ mp_obj_t pb_type_i2c_device_start_operation(mp_obj_t i2c_device_obj, const uint8
     device->read_len = read_len;
     device->write_len = write_len;
     device->read_buf = NULL;
+    device->ops = NULL;
+    device->num_ops = 0;
+    device->polled = false;
     device->return_map = return_map;
 
-    pb_type_async_t config = {
-        .parent_obj = i2c_device_obj,
-        .iter_once = pb_type_i2c_device_iterate_once,
-        .state = state,
-        .return_map = return_map ? pb_type_i2c_device_return_generic : NULL,
-    };
-    // New operation always wins; ongoing sound awaitable is cancelled.
-    return pb_type_async_wait_or_await(&config, &device->iter, true);
+    return pb_type_i2c_device_await(device, state);
+}
+
+/**
+ * Starts reading several registers, with one write-then-read operation for
+ * each register. The results are joined together in the order given.
+ */
+static mp_obj_t pb_type_i2c_device_start_read_registers(device_obj_t *device, mp_obj_t regs_in, size_t length, pb_type_i2c_device_return_map_t return_map) {
+
+    size_t num_ops;
+    mp_obj_t *regs;
+    mp_obj_get_array(regs_in, &num_ops, &regs);
+    if (num_ops == 0) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Operations, followed by one register byte per operation and then the
+    // read data, all in one allocation.
+    pbdrv_i2c_op_t *ops = m_malloc(num_ops * (sizeof(pbdrv_i2c_op_t) + 1 + length));
+    uint8_t *reg_data = (uint8_t *)&ops[num_ops];
+    uint8_t *read_data = &reg_data[num_ops];
+    for (size_t i = 0; i < num_ops; i++) {
+        reg_data[i] = mp_obj_get_int(regs[i]);
+        ops[i] = (pbdrv_i2c_op_t) {
+            .wdata = &reg_data[i],
+            .wlen = 1,
+            .rdata = &read_data[i * length],
+            .rlen = length,
+        };
+    }
+
+    // Kick off the operation, as in pb_type_i2c_device_start_operation.
+    pbio_os_state_t state = 0;
+    pbio_error_t err = pbdrv_i2c_write_then_read_list(&state, device->i2c_dev, device->address, ops, num_ops, device->nxt_quirk);
+    if (err == PBIO_SUCCESS) {
+        pb_assert(PBIO_ERROR_FAILED);
+    } else if (err != PBIO_ERROR_AGAIN) {
+        pb_assert(err);
+    }
+
+    device->read_len = num_ops * length;
+    device->write_len = 0;
+    device->read_buf = read_data;
+    device->ops = ops;
+    device->num_ops = num_ops;
+    device->polled = false;
+    device->return_map = return_map;
+
+    return pb_type_i2c_device_await(device, state);
 }
 
 /**
@@ -236,6 +320,38 @@ static mp_obj_t read(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
         PB_ARG_DEFAULT_NONE(map)
         );
 
+    // Optional user provided callback method of the form def my_method(self, data)
+    // We can use sensor_obj for this since it isn't used by I2CDevice instances,
+    // and we are already passing this to the mapping anyway, so we can conviently
+    // use it to pass the callable object in this case.
+    device->sensor_obj = mp_obj_is_callable(map_in) ? map_in : MP_OBJ_NULL;
+    pb_type_i2c_device_return_map_t return_map = mp_obj_is_callable(map_in) ?
+        pb_type_i2c_device_return_user_map : pb_type_i2c_device_return_bytes;
+
+    // Several registers are read in one go.
+    if (mp_obj_is_type(reg_in, &mp_type_tuple) || mp_obj_is_type(reg_in, &mp_type_list)) {
+        return pb_type_i2c_device_start_read_registers(device, reg_in, pb_obj_get_positive_int(length_in), return_map);
+    }
+
+    // A register that is polled in the background is not read here. Instead,
+    // this awaits the first result and then returns the most recent one.
+    size_t read_len = pb_obj_get_positive_int(length_in);
+    if (reg_in != mp_const_none && read_len <= UINT8_MAX) {
+        uint8_t reg = mp_obj_get_int(reg_in);
+        uint8_t *data;
+        if (pbio_port_i2c_poll_get(device->port, device->address, reg, read_len, &data, NULL) != PBIO_ERROR_INVALID_OP) {
+            device->read_len = read_len;
+            device->write_len = 0;
+            device->read_buf = NULL;
+            device->ops = NULL;
+            device->num_ops = 0;
+            device->poll_reg = reg;
+            device->polled = true;
+            device->return_map = return_map;
+            return pb_type_i2c_device_await(device, 0);
+        }
+    }
+
     // Write payload is one byte representing the register we want to read,
     // or no write for reg=None.
     uint8_t *write_data = reg_in == mp_const_none ?
@@ -243,18 +359,12 @@ static mp_obj_t read(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
         &(uint8_t) { mp_obj_get_int(reg_in) };
     size_t write_len = reg_in == mp_const_none ? 0 : 1;
 
-    // Optional user provided callback method of the form def my_method(self, data)
-    // We can use sensor_obj for this since it isn't used by I2CDevice instances,
-    // and we are already passing this to the mapping anyway, so we can conviently
-    // use it to pass the callable object in this case.
-    device->sensor_obj = mp_obj_is_callable(map_in) ? map_in : MP_OBJ_NULL;
-
     return pb_type_i2c_device_start_operation(
         MP_OBJ_FROM_PTR(device),
         write_data,
         write_len,
-        pb_obj_get_positive_int(length_in),
-        mp_obj_is_callable(map_in) ? pb_type_i2c_device_return_user_map : pb_type_i2c_device_return_bytes
+        read_len,
+        return_map
         );
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(read_obj, 0, read);
@@ -295,8 +405,32 @@ static mp_obj_t write(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(write_obj, 0, write);
 
+// pybricks.iodevices.I2CDevice.poll
+static mp_obj_t poll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        device_obj_t, device,
+        PB_ARG_REQUIRED(reg),
+        PB_ARG_DEFAULT_INT(length, 1),
+        PB_ARG_DEFAULT_INT(interval, 10)
+        );
+
+    // Reads of this register will return the most recent result from now on.
+    // An interval of 0 stops polling.
+    pb_assert(pbio_port_i2c_poll_start(
+        device->port,
+        device->address,
+        pb_obj_get_positive_int(reg_in),
+        pb_obj_get_positive_int(length_in),
+        pb_obj_get_positive_int(interval_in),
+        device->nxt_quirk
+        ));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(poll_obj, 0, poll);
+
 // dir(pybricks.iodevices.I2CDevice)
 static const mp_rom_map_elem_t locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_poll), MP_ROM_PTR(&poll_obj) },
     { MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&read_obj) },
     { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&write_obj) },
 };
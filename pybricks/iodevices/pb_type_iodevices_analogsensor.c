@@ -14,6 +14,7 @@
 
 #include <pybricks/common.h>
 #include <pybricks/parameters.h>
+#include <pybricks/tools/pb_type_async.h>
 
 #include <pybricks/util_mp/pb_kwarg_helper.h>
 #include <pybricks/util_mp/pb_obj_helper.h>
@@ -24,6 +25,10 @@ typedef struct _iodevices_AnalogSensor_obj_t {
     mp_obj_base_t base;
     pbio_port_t *port;
     bool active;
+    pb_type_async_t *capture_iter;
+    mp_obj_t capture_obj;
+    uint16_t *capture_buf;
+    size_t capture_len;
 } iodevices_AnalogSensor_obj_t;
 
 // pybricks.iodevices.AnalogSensor.__init__
@@ -50,6 +55,9 @@ static mp_obj_t iodevices_AnalogSensor_make_new(const mp_obj_type_t *type, size_
     }
     pb_assert(err);
 
+    self->capture_iter = NULL;
+    self->capture_obj = MP_OBJ_NULL;
+
     // Start as passive by default.
     uint32_t analog;
     self->active = false;
@@ -103,12 +111,63 @@ static mp_obj_t iodevices_AnalogSensor_passive(mp_obj_t self_in) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(iodevices_AnalogSensor_passive_obj, iodevices_AnalogSensor_passive);
 
+static pbio_error_t iodevices_AnalogSensor_capture_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
+    iodevices_AnalogSensor_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return pbio_port_await_analog_capture(state, self->capture_buf, self->capture_len);
+}
+
+static mp_obj_t iodevices_AnalogSensor_capture_return_map(mp_obj_t self_in) {
+    iodevices_AnalogSensor_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    // Disconnect the buffer so it can be garbage collected.
+    self->capture_obj = MP_OBJ_NULL;
+    return mp_const_none;
+}
+
+// pybricks.iodevices.AnalogSensor.capture
+static mp_obj_t iodevices_AnalogSensor_capture(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        iodevices_AnalogSensor_obj_t, self,
+        PB_ARG_REQUIRED(buf),
+        PB_ARG_DEFAULT_INT(rate, 500),
+        PB_ARG_DEFAULT_INT(decimation, 1));
+
+    // Samples are written as voltages in mV into an array('H').
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.typecode != 'H' || bufinfo.len < sizeof(uint16_t)) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    mp_int_t rate = pb_obj_get_positive_int(rate_in);
+    if (rate == 0 || 1000000 % rate) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Samples are taken by the driver, so the buffer must stay alive until
+    // the capture completes.
+    self->capture_obj = buf_in;
+    self->capture_buf = bufinfo.buf;
+    self->capture_len = bufinfo.len / sizeof(uint16_t);
+    pb_assert(pbio_port_start_analog_capture(self->port, LEGO_DEVICE_TYPE_ID_NXT_ANALOG, self->active,
+        self->capture_buf, self->capture_len, 1000000 / rate, pb_obj_get_positive_int(decimation_in)));
+
+    pb_type_async_t config = {
+        .iter_once = iodevices_AnalogSensor_capture_iter_once,
+        .parent_obj = MP_OBJ_FROM_PTR(self),
+        .return_map = iodevices_AnalogSensor_capture_return_map,
+    };
+    return pb_type_async_wait_or_await(&config, &self->capture_iter, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(iodevices_AnalogSensor_capture_obj, 1, iodevices_AnalogSensor_capture);
+
 // dir(pybricks.iodevices.AnalogSensor)
 static const mp_rom_map_elem_t iodevices_AnalogSensor_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_voltage),    MP_ROM_PTR(&iodevices_AnalogSensor_voltage_obj)    },
     { MP_ROM_QSTR(MP_QSTR_resistance), MP_ROM_PTR(&iodevices_AnalogSensor_resistance_obj) },
     { MP_ROM_QSTR(MP_QSTR_active),     MP_ROM_PTR(&iodevices_AnalogSensor_active_obj)    },
     { MP_ROM_QSTR(MP_QSTR_passive),    MP_ROM_PTR(&iodevices_AnalogSensor_passive_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_capture),    MP_ROM_PTR(&iodevices_AnalogSensor_capture_obj)    },
 };
 static MP_DEFINE_CONST_DICT(iodevices_AnalogSensor_locals_dict, iodevices_AnalogSensor_locals_dict_table);
 
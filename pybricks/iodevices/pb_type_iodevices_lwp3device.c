@@ -111,6 +111,14 @@ typedef struct {
      * Application specific data, like cached button state, populated by notifications.
      */
     uint8_t data[8];
+    /**
+     * Whether a report was received for @p data.
+     */
+    bool report_received;
+    /**
+     * Time (ms) at which the last report was received for @p data.
+     */
+    uint32_t report_time;
     /**
      * Routine to run after establishing a connection (e.g. subscribing to ports).
      */
@@ -193,6 +201,31 @@ static mp_obj_t wait_or_await_operation(mp_obj_t self_in) {
     return pb_type_async_wait_or_await(&config, &self->iter, true);
 }
 
+/**
+ * Sends a command without waiting for the hub to acknowledge it, so several
+ * commands can go out in one connection event. A command for the same port
+ * that was not sent yet is replaced, so only the latest one is sent.
+ *
+ * Falls back to a regular write if the driver does not support this or if
+ * too many commands are waiting.
+ *
+ * @param [in]  self      The device.
+ * @param [in]  port      Port that the command is for.
+ * @param [in]  data      The command.
+ * @param [in]  size      Size of @p data.
+ * @return                Awaitable that completes when the command is sent
+ *                        or queued.
+ */
+static mp_obj_t write_command(pb_type_lwp3device_obj_t *self, uint8_t port, const uint8_t *data, size_t size) {
+    pbio_error_t err = pbdrv_bluetooth_peripheral_write_characteristic_queued(self->peripheral, self->lwp3_char_handle, port, data, size);
+    if (err == PBIO_ERROR_NOT_SUPPORTED || err == PBIO_ERROR_BUSY) {
+        pb_assert(pbdrv_bluetooth_peripheral_write_characteristic(self->peripheral, self->lwp3_char_handle, data, size));
+        return wait_or_await_operation(MP_OBJ_FROM_PTR(self));
+    }
+    pb_assert(err);
+    return pb_type_async_return_result(mp_const_none, &self->iter);
+}
+
 static mp_obj_t pb_type_lwp3device_close(mp_obj_t self_in) {
     pb_type_lwp3device_obj_t *self = MP_OBJ_TO_PTR(self_in);
     // Disables notification handler from accessing allocated memory.
@@ -395,8 +428,14 @@ static void pb_type_remote_handle_notification(void *user, const uint8_t *value,
             memcpy(&self->data[0], &value[4], 3);
         } else if (value[3] == REMOTE_PORT_RIGHT_BUTTONS) {
             memcpy(&self->data[3], &value[4], 3);
+        } else {
+            return;
         }
+    } else {
+        return;
     }
+    self->report_time = mp_hal_ticks_ms();
+    self->report_received = true;
 }
 
 mp_obj_t pb_type_remote_button_pressed(mp_obj_t self_in) {
@@ -438,19 +477,43 @@ mp_obj_t pb_type_remote_button_pressed(mp_obj_t self_in) {
     #endif
 }
 
-static pbio_error_t pb_type_remote_write_light_msg(mp_obj_t self_in, const pbio_color_hsv_t *hsv) {
+static pbio_button_flags_t pb_type_remote_button_get_flags(mp_obj_t self_in) {
+    pb_type_lwp3device_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
-    struct {
-        uint8_t length;
-        uint8_t hub;
-        uint8_t type;
-        uint8_t port;
-        uint8_t startup : 4;
-        uint8_t completion : 4;
-        uint8_t cmd;
-        uint8_t mode;
-        uint8_t payload[3];
-    } __attribute__((packed)) msg = {
+    if (!pbdrv_bluetooth_peripheral_is_connected(self->peripheral)) {
+        pb_assert(PBIO_ERROR_NO_DEV);
+    }
+
+    // Same order as the buttons in pb_type_remote_button_pressed.
+    static const pbio_button_flags_t flags[] = {
+        PBIO_BUTTON_LEFT_UP, PBIO_BUTTON_LEFT, PBIO_BUTTON_LEFT_DOWN,
+        PBIO_BUTTON_RIGHT_UP, PBIO_BUTTON_RIGHT, PBIO_BUTTON_RIGHT_DOWN,
+        PBIO_BUTTON_CENTER,
+    };
+    pbio_button_flags_t pressed = 0;
+    for (size_t i = 0; i < MP_ARRAY_SIZE(flags); i++) {
+        if (self->data[i]) {
+            pressed |= flags[i];
+        }
+    }
+    return pressed;
+}
+
+typedef struct {
+    uint8_t length;
+    uint8_t hub;
+    uint8_t type;
+    uint8_t port;
+    uint8_t startup : 4;
+    uint8_t completion : 4;
+    uint8_t cmd;
+    uint8_t mode;
+    uint8_t payload[3];
+} __attribute__((packed)) pb_type_remote_light_msg_t;
+
+static void pb_type_remote_make_light_msg(const pbio_color_hsv_t *hsv, pb_type_remote_light_msg_t *msg) {
+
+    *msg = (pb_type_remote_light_msg_t) {
         .length = 10,
         .type = LWP3_MSG_TYPE_OUT_PORT_CMD,
         .port = REMOTE_PORT_STATUS_LIGHT,
@@ -465,18 +528,23 @@ static pbio_error_t pb_type_remote_write_light_msg(mp_obj_t self_in, const pbio_
 
     // The red LED on the handset is weak, so we have to reduce green and blue
     // to get the colors right.
-    msg.payload[0] = rgb.r;
-    msg.payload[1] = rgb.g * 3 / 8;
-    msg.payload[2] = rgb.b * 3 / 8;
+    msg->payload[0] = rgb.r;
+    msg->payload[1] = rgb.g * 3 / 8;
+    msg->payload[2] = rgb.b * 3 / 8;
+}
 
+static pbio_error_t pb_type_remote_write_light_msg(mp_obj_t self_in, const pbio_color_hsv_t *hsv) {
     pb_type_lwp3device_obj_t *self = MP_OBJ_TO_PTR(self_in);
-
+    pb_type_remote_light_msg_t msg;
+    pb_type_remote_make_light_msg(hsv, &msg);
     return pbdrv_bluetooth_peripheral_write_characteristic(self->peripheral, self->lwp3_char_handle, (const uint8_t *)&msg, sizeof(msg));
 }
 
 static mp_obj_t pb_type_remote_light_on(mp_obj_t self_in, const pbio_color_hsv_t *hsv) {
-    pb_assert(pb_type_remote_write_light_msg(self_in, hsv));
-    return wait_or_await_operation(self_in);
+    pb_type_lwp3device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    pb_type_remote_light_msg_t msg;
+    pb_type_remote_make_light_msg(hsv, &msg);
+    return write_command(self, msg.port, (const uint8_t *)&msg, sizeof(msg));
 }
 
 static pbio_error_t pb_type_remote_post_connect(pbio_os_state_t *state, mp_obj_t parent_obj) {
@@ -558,11 +626,26 @@ static pbio_error_t pb_type_remote_post_connect(pbio_os_state_t *state, mp_obj_t
     PBIO_OS_ASYNC_END(PBIO_SUCCESS);
 }
 
+static mp_obj_t pb_type_remote_report_age(mp_obj_t self_in) {
+    pb_type_lwp3device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (!pbdrv_bluetooth_peripheral_is_connected(self->peripheral)) {
+        pb_assert(PBIO_ERROR_NO_DEV);
+    }
+
+    if (!self->report_received) {
+        return mp_const_none;
+    }
+    return mp_obj_new_int(mp_hal_ticks_ms() - self->report_time);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_remote_report_age_obj, pb_type_remote_report_age);
+
 static mp_obj_t pb_type_remote_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     PB_PARSE_ARGS_CLASS(n_args, n_kw, args,
         PB_ARG_DEFAULT_NONE(name),
         PB_ARG_DEFAULT_INT(timeout, 10000),
-        PB_ARG_DEFAULT_TRUE(connect)
+        PB_ARG_DEFAULT_TRUE(connect),
+        PB_ARG_DEFAULT_FALSE(low_latency)
         );
 
     pb_module_tools_assert_blocking();
@@ -570,6 +653,7 @@ static mp_obj_t pb_type_remote_make_new(const mp_obj_type_t *type, size_t n_args
     pb_type_lwp3device_obj_t *self = mp_obj_malloc_with_finaliser(pb_type_lwp3device_obj_t, type);
     self->iter = NULL;
     self->noti_num = 0;
+    self->report_received = false;
 
     self->hub_kind = LWP3_HUB_KIND_HANDSET;
 
@@ -579,11 +663,12 @@ static mp_obj_t pb_type_remote_make_new(const mp_obj_type_t *type, size_t n_args
         .match_adv = pb_type_lwp3device_advertisement_matches,
         .match_adv_rsp = pb_type_lwp3device_advertisement_response_matches,
         .notification_handler = pb_type_remote_handle_notification,
-        .options = PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_NONE,
+        .options = mp_obj_is_true(low_latency_in) ?
+            PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY : PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_NONE,
     };
     pb_type_lwp3device_set_name_filter_and_timeout(self, name_in, timeout_in);
 
-    self->buttons = pb_type_Keypad_obj_new(MP_OBJ_FROM_PTR(self), pb_type_remote_button_pressed);
+    self->buttons = pb_type_Keypad_obj_new(MP_OBJ_FROM_PTR(self), pb_type_remote_button_pressed, pb_type_remote_button_get_flags);
     self->light = pb_type_ColorLight_external_obj_new(MP_OBJ_FROM_PTR(self), pb_type_remote_light_on);
 
     pb_type_lwp3device_intialize_connection(MP_OBJ_FROM_PTR(self), connect_in);
@@ -601,6 +686,7 @@ static const mp_rom_map_elem_t pb_type_remote_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_connect), MP_ROM_PTR(&pb_type_lwp3device_connect_obj) },
     { MP_ROM_QSTR(MP_QSTR_disconnect), MP_ROM_PTR(&pb_type_lwp3device_disconnect_obj) },
     { MP_ROM_QSTR(MP_QSTR_name), MP_ROM_PTR(&pb_type_lwp3device_name_obj) },
+    { MP_ROM_QSTR(MP_QSTR_report_age), MP_ROM_PTR(&pb_type_remote_report_age_obj) },
 };
 static MP_DEFINE_CONST_DICT(pb_type_remote_locals_dict, pb_type_remote_locals_dict_table);
 
@@ -704,8 +790,7 @@ static mp_obj_t pb_type_technic_move_hub_drive(size_t n_args, const mp_obj_t *po
     const uint8_t cmd[] = {
         0x0d, 0x00, 0x81, 0x36, 0x11, 0x51, 0x00, 0x03, 0x00, speed_byte, steering_byte, light_mode, 0,
     };
-    pb_assert(pbdrv_bluetooth_peripheral_write_characteristic(self->peripheral, self->lwp3_char_handle, cmd, sizeof(cmd)));
-    return wait_or_await_operation(MP_OBJ_FROM_PTR(self));
+    return write_command(self, cmd[3], cmd, sizeof(cmd));
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_technic_move_hub_drive_obj, 1, pb_type_technic_move_hub_drive);
 
@@ -863,8 +948,7 @@ static mp_obj_t pb_type_duplo_train_drive(size_t n_args, const mp_obj_t *pos_arg
     const uint8_t message[] = {
         0x08, 0x00, 0x81, port_byte, 0x01, 0x51, mode_byte, power_byte
     };
-    pb_assert(pbdrv_bluetooth_peripheral_write_characteristic(self->peripheral, self->lwp3_char_handle, message, sizeof(message)));
-    return wait_or_await_operation(MP_OBJ_FROM_PTR(self));
+    return write_command(self, port_byte, message, sizeof(message));
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_duplo_train_drive_obj, 1, pb_type_duplo_train_drive);
 
@@ -902,7 +986,7 @@ static mp_obj_t pb_type_duplo_train_headlights(size_t n_args, const mp_obj_t *po
         const uint8_t message_old[] = {
             0x08, 0x00, 0x81, 0x11, 0x11, 0x51, 0x00, id
         };
-        pb_assert(pbdrv_bluetooth_peripheral_write_characteristic(self->peripheral, self->lwp3_char_handle, message_old, sizeof(message_old)));
+        return write_command(self, message_old[3], message_old, sizeof(message_old));
     } else {
         uint8_t id;
         if (hsv->s < 10) {
@@ -924,9 +1008,8 @@ static mp_obj_t pb_type_duplo_train_headlights(size_t n_args, const mp_obj_t *po
         const uint8_t message_new[] = {
             10, 0, 129, 52, 17, 0x51, 0x01, 0x04, 0x01, id
         };
-        pb_assert(pbdrv_bluetooth_peripheral_write_characteristic(self->peripheral, self->lwp3_char_handle, message_new, sizeof(message_new)));
+        return write_command(self, message_new[3], message_new, sizeof(message_new));
     }
-    return wait_or_await_operation(MP_OBJ_FROM_PTR(self));
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_duplo_train_headlights_obj, 1, pb_type_duplo_train_headlights);
 
@@ -30,6 +30,8 @@ typedef struct _iodevices_PUPDevice_obj_t {
     // on the awaitable instead, as extra context. For now, it is safe since
     // concurrent reads with the same sensor are not permitted.
     uint8_t last_mode;
+    // Whether the last read should include the time the data was received.
+    bool last_timestamp;
     // ID of a passive device, if any.
     lego_device_type_id_t passive_id;
     // Device port.
@@ -162,14 +164,27 @@ static mp_obj_t get_pup_data_tuple(mp_obj_t self_in) {
         }
     }
 
-    return mp_obj_new_tuple(mode_info[current_mode].num_values, values);
+    mp_obj_t result = mp_obj_new_tuple(mode_info[current_mode].num_values, values);
+    if (!self->last_timestamp) {
+        return result;
+    }
+
+    // Pair the values with the time at which they were received, in us.
+    uint32_t time;
+    pb_assert(pbio_port_lump_get_data_time(self->device_base.lump_dev, self->last_mode, &time));
+    mp_obj_t ret[] = {
+        result,
+        mp_obj_new_int_from_uint(time),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(ret), ret);
 }
 
 // pybricks.iodevices.PUPDevice.read
 static mp_obj_t iodevices_PUPDevice_read(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         iodevices_PUPDevice_obj_t, self,
-        PB_ARG_REQUIRED(mode));
+        PB_ARG_REQUIRED(mode),
+        PB_ARG_DEFAULT_FALSE(timestamp));
 
     // Allow reading from passive touch sensors as per the Powered Up spec.
     // These do not have modes. For this special case, alwyas return a bool,
@@ -186,6 +201,7 @@ static mp_obj_t iodevices_PUPDevice_read(size_t n_args, const mp_obj_t *pos_args
     }
 
     self->last_mode = mp_obj_get_int(mode_in);
+    self->last_timestamp = mp_obj_is_true(timestamp_in);
 
     // We can re-use the same code as for specific sensor types, only the mode
     // is not hardcoded per call, so we create that object here.
@@ -201,6 +217,24 @@ static mp_obj_t iodevices_PUPDevice_read(size_t n_args, const mp_obj_t *pos_args
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(iodevices_PUPDevice_read_obj, 1, iodevices_PUPDevice_read);
 
+// pybricks.iodevices.PUPDevice.wait_read
+static mp_obj_t iodevices_PUPDevice_wait_read(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        iodevices_PUPDevice_obj_t, self,
+        PB_ARG_REQUIRED(mode),
+        PB_ARG_DEFAULT_FALSE(changed));
+
+    // Passive devices don't report data.
+    if (self->passive_id != LEGO_DEVICE_TYPE_ID_LPF2_UNKNOWN_UART) {
+        pb_assert(PBIO_ERROR_INVALID_OP);
+    }
+
+    self->last_mode = mp_obj_get_int(mode_in);
+    self->last_timestamp = false;
+    return pb_type_device_wait_data(MP_OBJ_FROM_PTR(self), self->last_mode, mp_obj_is_true(changed_in), get_pup_data_tuple);
+}
+MP_DEFINE_CONST_FUN_OBJ_KW(iodevices_PUPDevice_wait_read_obj, 1, iodevices_PUPDevice_wait_read);
+
 // pybricks.iodevices.PUPDevice.write
 static mp_obj_t iodevices_PUPDevice_write(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
@@ -304,6 +338,7 @@ MP_DEFINE_CONST_FUN_OBJ_1(iodevices_PUPDevice_reset_obj, iodevices_PUPDevice_res
 // dir(pybricks.iodevices.PUPDevice)
 static const mp_rom_map_elem_t iodevices_PUPDevice_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_read),       MP_ROM_PTR(&iodevices_PUPDevice_read_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait_read),  MP_ROM_PTR(&iodevices_PUPDevice_wait_read_obj) },
     { MP_ROM_QSTR(MP_QSTR_write),      MP_ROM_PTR(&iodevices_PUPDevice_write_obj)},
     { MP_ROM_QSTR(MP_QSTR_info),       MP_ROM_PTR(&iodevices_PUPDevice_info_obj)},
     { MP_ROM_QSTR(MP_QSTR_reset),      MP_ROM_PTR(&iodevices_PUPDevice_reset_obj)},
@@ -70,6 +70,18 @@ typedef struct _pb_type_xbox_obj_t {
      * Whether to disconnect from host before connecting to controller.
      **/
     bool disconnect_host;
+    /**
+     * Whether to request a short connection interval for lower input latency.
+     **/
+    bool low_latency;
+    /**
+     * Whether a report was received since connecting.
+     */
+    bool report_received;
+    /**
+     * Time (ms) at which the last report was received.
+     */
+    uint32_t report_time;
     /**
      * Timer used to delay between connection attempts.
      */
@@ -110,6 +122,8 @@ static void pb_type_xbox_handle_notification(void *user, const uint8_t *value, u
 
     if (size <= sizeof(xbox_input_map_t)) {
         memcpy(&self->input_map, &value[0], size);
+        self->report_time = mp_hal_ticks_ms();
+        self->report_received = true;
     }
 }
 
@@ -296,6 +310,10 @@ retry:
     if (self->disconnect_host) {
         scan_config.options |= PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_DISCONNECT_HOST;
     }
+    if (self->low_latency) {
+        scan_config.options |= PBDRV_BLUETOOTH_PERIPHERAL_OPTIONS_LOW_LATENCY;
+    }
+    self->report_received = false;
 
     pb_assert(pbdrv_bluetooth_peripheral_scan_and_connect(self->peripheral, &scan_config));
     PBIO_OS_AWAIT(state, &unused, err = pbdrv_bluetooth_await_peripheral_command(&unused, self->peripheral));
@@ -426,7 +444,8 @@ static mp_obj_t pb_type_xbox_make_new(const mp_obj_type_t *type, size_t n_args,
         PB_ARG_DEFAULT_INT(joystick_deadzone, 10),
         PB_ARG_DEFAULT_NONE(name),
         PB_ARG_DEFAULT_INT(timeout, 10000),
-        PB_ARG_DEFAULT_TRUE(connect)
+        PB_ARG_DEFAULT_TRUE(connect),
+        PB_ARG_DEFAULT_FALSE(low_latency)
         // Debug parameter to stay connected to the host on Technic Hub.
         // Works only on some hosts for the moment, so False by default.
         #if PYBRICKS_HUB_TECHNICHUB
@@ -439,8 +458,10 @@ static mp_obj_t pb_type_xbox_make_new(const mp_obj_type_t *type, size_t n_args,
     pb_type_xbox_obj_t *self = mp_obj_malloc_with_finaliser(pb_type_xbox_obj_t, type);
     self->joystick_deadzone = pb_obj_get_pct(joystick_deadzone_in);
     self->iter = NULL;
+    self->low_latency = mp_obj_is_true(low_latency_in);
+    self->report_received = false;
 
-    self->buttons = pb_type_Keypad_obj_new(MP_OBJ_FROM_PTR(self), pb_type_xbox_button_pressed);
+    self->buttons = pb_type_Keypad_obj_new(MP_OBJ_FROM_PTR(self), pb_type_xbox_button_pressed, NULL);
 
     // needed to ensure that no buttons are "pressed" since we are using
     // allocated memory
@@ -524,6 +545,17 @@ static mp_obj_t pb_type_xbox_state(mp_obj_t self_in) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_xbox_state_obj, pb_type_xbox_state);
 
+static mp_obj_t pb_type_xbox_report_age(mp_obj_t self_in) {
+    // Asserts connection.
+    pb_type_xbox_get_input(self_in);
+    pb_type_xbox_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->report_received) {
+        return mp_const_none;
+    }
+    return mp_obj_new_int(mp_hal_ticks_ms() - self->report_time);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_xbox_report_age_obj, pb_type_xbox_report_age);
+
 static mp_obj_t pb_type_xbox_dpad(mp_obj_t self_in) {
     xbox_input_map_t *buttons = pb_type_xbox_get_input(self_in);
     return mp_obj_new_int(buttons->dpad);
@@ -668,6 +700,7 @@ static const mp_rom_map_elem_t pb_type_xbox_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_joystick_right), MP_ROM_PTR(&pb_type_xbox_joystick_right_obj) },
     { MP_ROM_QSTR(MP_QSTR_triggers), MP_ROM_PTR(&pb_type_xbox_triggers_obj) },
     { MP_ROM_QSTR(MP_QSTR_rumble), MP_ROM_PTR(&pb_type_xbox_rumble_obj) },
+    { MP_ROM_QSTR(MP_QSTR_report_age), MP_ROM_PTR(&pb_type_xbox_report_age_obj) },
 };
 static MP_DEFINE_CONST_DICT(pb_type_xbox_locals_dict, pb_type_xbox_locals_dict_table);
 
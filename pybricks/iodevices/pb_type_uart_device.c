@@ -9,6 +9,8 @@
 #include "py/objstr.h"
 #include "py/runtime.h"
 
+#include <string.h>
+
 #include <pbdrv/uart.h>
 #include <pbio/port_interface.h>
 
@@ -28,8 +30,15 @@ typedef struct _pb_type_uart_device_obj_t {
     uint32_t timeout;
     pb_type_async_t *write_iter;
     mp_obj_t write_obj;
+    const uint8_t *write_data;
+    size_t write_len;
     pb_type_async_t *read_iter;
     mp_obj_str_t *read_obj;
+    size_t read_count;
+    mp_obj_t readinto_obj;
+    uint8_t *readinto_data;
+    size_t readinto_len;
+    pbio_os_state_t readinto_state;
     const byte *wait_data;
     size_t wait_len;
 } pb_type_uart_device_obj_t;
@@ -81,6 +90,7 @@ static mp_obj_t pb_type_uart_device_make_new(const mp_obj_type_t *type, size_t n
     // Awaitables associated with reading and writing.
     self->write_iter = NULL;
     self->read_iter = NULL;
+    self->readinto_obj = MP_OBJ_NULL;
     self->wait_len = 0;
 
     return MP_OBJ_FROM_PTR(self);
@@ -88,8 +98,7 @@ static mp_obj_t pb_type_uart_device_make_new(const mp_obj_type_t *type, size_t n
 
 static pbio_error_t pb_type_uart_device_write_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
     pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    GET_STR_DATA_LEN(self->write_obj, data, data_len);
-    return pbdrv_uart_write(state, self->uart_dev, (uint8_t *)data, data_len, self->timeout);
+    return pbdrv_uart_write(state, self->uart_dev, self->write_data, self->write_len, self->timeout);
 }
 
 static mp_obj_t pb_type_uart_device_write_return_map(mp_obj_t self_in) {
@@ -107,13 +116,15 @@ static mp_obj_t pb_type_uart_device_write(size_t n_args, const mp_obj_t *pos_arg
         pb_type_uart_device_obj_t, self,
         PB_ARG_REQUIRED(data));
 
-    // Assert that data argument are bytes
-    if (!(mp_obj_is_str_or_bytes(data_in) || mp_obj_is_type(data_in, &mp_type_bytearray))) {
-        pb_assert(PBIO_ERROR_INVALID_ARG);
-    }
+    // Accept any object with a buffer, such as bytes, bytearray, array or
+    // memoryview. The driver transmits directly from it without copying.
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data_in, &bufinfo, MP_BUFFER_READ);
 
     // Prevents this object from being garbage collected while the write is in progress.
     self->write_obj = data_in;
+    self->write_data = bufinfo.buf;
+    self->write_len = bufinfo.len;
 
     pb_type_async_t config = {
         .iter_once = pb_type_uart_device_write_iter_once,
@@ -191,31 +202,43 @@ static mp_obj_t pb_type_uart_device_clear(mp_obj_t self_in) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_uart_device_clear_obj, pb_type_uart_device_clear);
 
-static pbio_error_t pb_type_uart_device_wait_until_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
-
-    pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+/**
+ * Consumes received bytes until the given pattern has been received.
+ *
+ * @param [in]  self        The UART device object.
+ * @param [in]  pattern     The pattern to look for.
+ * @param [in]  len         Length of the pattern.
+ * @return                  True if the pattern was received, false if more
+ *                          data is needed.
+ */
+static bool pb_type_uart_device_find_pattern(pb_type_uart_device_obj_t *self, const uint8_t *pattern, size_t len) {
 
 retry:
 
     // Yield if not enough to read yet.
-    if (pbdrv_uart_in_waiting(self->uart_dev) < self->wait_len) {
-        return PBIO_ERROR_AGAIN;
+    if (pbdrv_uart_in_waiting(self->uart_dev) < len) {
+        return false;
     }
 
     // We can read the full amount of bytes without blocking now.
-    for (size_t i = 0; i < self->wait_len; i++) {
+    for (size_t i = 0; i < len; i++) {
         // Read at most one byte since the viewing window may not overlap pattern.
         pbio_os_state_t sub = 0;
         uint8_t rx;
         pb_assert(pbdrv_uart_read(&sub, self->uart_dev, &rx, 1, 0));
 
-        if (rx != self->wait_data[i]) {
+        if (rx != pattern[i]) {
             // Not the character we expected, so start over, yielding if there
             // is not enough to read.
             goto retry;
         }
     }
-    return PBIO_SUCCESS;
+    return true;
+}
+
+static pbio_error_t pb_type_uart_device_wait_until_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
+    pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return pb_type_uart_device_find_pattern(self, self->wait_data, self->wait_len) ? PBIO_SUCCESS : PBIO_ERROR_AGAIN;
 }
 
 static mp_obj_t pb_type_uart_device_wait_until_return_map(mp_obj_t self_in) {
@@ -247,10 +270,154 @@ static mp_obj_t pb_type_uart_device_wait_until(mp_obj_t self_in, mp_obj_t patter
 }
 static MP_DEFINE_CONST_FUN_OBJ_2(pb_type_uart_device_wait_until_obj, pb_type_uart_device_wait_until);
 
+static pbio_error_t pb_type_uart_device_readinto_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
+    pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    pbio_error_t err = PBIO_SUCCESS;
+
+    PBIO_OS_ASYNC_BEGIN(state);
+
+    // Synchronize to the start of the frame, if given. The start pattern is
+    // kept at the start of the buffer so the caller gets the whole frame.
+    if (self->wait_len) {
+        PBIO_OS_AWAIT_UNTIL(state, pb_type_uart_device_find_pattern(self, self->wait_data, self->wait_len));
+        memcpy(self->readinto_data, self->wait_data, self->wait_len);
+    }
+
+    // Read the remainder straight into the buffer.
+    if (self->readinto_len > self->wait_len) {
+        PBIO_OS_AWAIT(state, &self->readinto_state, err = pbdrv_uart_read(&self->readinto_state, self->uart_dev,
+            self->readinto_data + self->wait_len, self->readinto_len - self->wait_len, self->timeout));
+    }
+
+    PBIO_OS_ASYNC_END(err);
+}
+
+static mp_obj_t pb_type_uart_device_readinto_return_map(mp_obj_t self_in) {
+    pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    // Disconnect the buffer so it can be garbage collected.
+    self->readinto_obj = MP_OBJ_NULL;
+    self->wait_len = 0;
+    self->wait_data = NULL;
+    return mp_obj_new_int(self->readinto_len);
+}
+
+// pybricks.iodevices.UARTDevice.readinto
+static mp_obj_t pb_type_uart_device_readinto(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_uart_device_obj_t, self,
+        PB_ARG_REQUIRED(buf),
+        PB_ARG_DEFAULT_NONE(start));
+
+    if (self->wait_len) {
+        pb_assert(PBIO_ERROR_BUSY);
+    }
+
+    // Read into the caller's buffer, so nothing is allocated per read.
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.len == 0) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Optional pattern that each frame starts with.
+    if (start_in != mp_const_none) {
+        self->wait_data = (const uint8_t *)mp_obj_str_get_data(start_in, &self->wait_len);
+        if (self->wait_len > bufinfo.len) {
+            self->wait_len = 0;
+            pb_assert(PBIO_ERROR_INVALID_ARG);
+        }
+    }
+
+    // Prevents the buffer from being garbage collected while reading.
+    self->readinto_obj = buf_in;
+    self->readinto_data = bufinfo.buf;
+    self->readinto_len = bufinfo.len;
+
+    pb_type_async_t config = {
+        .iter_once = pb_type_uart_device_readinto_iter_once,
+        .parent_obj = MP_OBJ_FROM_PTR(self),
+        .return_map = pb_type_uart_device_readinto_return_map,
+    };
+    return pb_type_async_wait_or_await(&config, &self->read_iter, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_uart_device_readinto_obj, 1, pb_type_uart_device_readinto);
+
+static pbio_error_t pb_type_uart_device_read_until_iter_once(pbio_os_state_t *state, mp_obj_t self_in) {
+    pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    uint8_t *data = (uint8_t *)self->read_obj->data;
+
+    // Read one byte at a time so nothing past the delimiter is consumed.
+    while (self->read_count < self->read_obj->len) {
+        if (pbdrv_uart_in_waiting(self->uart_dev) == 0) {
+            return PBIO_ERROR_AGAIN;
+        }
+        pbio_os_state_t sub = 0;
+        pb_assert(pbdrv_uart_read(&sub, self->uart_dev, &data[self->read_count++], 1, 0));
+
+        if (self->read_count >= self->wait_len &&
+            memcmp(&data[self->read_count - self->wait_len], self->wait_data, self->wait_len) == 0) {
+            return PBIO_SUCCESS;
+        }
+    }
+
+    // Maximum length reached without finding the delimiter.
+    return PBIO_SUCCESS;
+}
+
+static mp_obj_t pb_type_uart_device_read_until_return_map(mp_obj_t self_in) {
+    pb_type_uart_device_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_str_t *result = self->read_obj;
+    self->read_obj = NULL;
+    self->wait_len = 0;
+    self->wait_data = NULL;
+
+    // Shrink to what was actually received.
+    result->data = m_renew(byte, (byte *)result->data, result->len + 1, self->read_count + 1);
+    result->len = self->read_count;
+    ((byte *)result->data)[result->len] = '\0';
+    return pb_obj_new_bytes_finish(result);
+}
+
+// pybricks.iodevices.UARTDevice.read_until
+static mp_obj_t pb_type_uart_device_read_until(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_uart_device_obj_t, self,
+        PB_ARG_REQUIRED(end),
+        PB_ARG_DEFAULT_INT(max_length, 256));
+
+    if (self->wait_len) {
+        pb_assert(PBIO_ERROR_BUSY);
+    }
+
+    size_t max_length = pb_obj_get_positive_int(max_length_in);
+    const uint8_t *end = (const uint8_t *)mp_obj_str_get_data(end_in, &self->wait_len);
+    if (self->wait_len == 0 || max_length == 0) {
+        self->wait_len = 0;
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    self->wait_data = end;
+
+    // Allocate once for the largest packet, shrunk to size when done.
+    self->read_obj = pb_obj_new_bytes_prepare(max_length);
+    self->read_count = 0;
+
+    pb_type_async_t config = {
+        .iter_once = pb_type_uart_device_read_until_iter_once,
+        .parent_obj = MP_OBJ_FROM_PTR(self),
+        .return_map = pb_type_uart_device_read_until_return_map,
+    };
+    return pb_type_async_wait_or_await(&config, &self->read_iter, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_uart_device_read_until_obj, 1, pb_type_uart_device_read_until);
+
 // dir(pybricks.iodevices.uart_device)
 static const mp_rom_map_elem_t pb_type_uart_device_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_read),         MP_ROM_PTR(&pb_type_uart_device_read_obj)         },
     { MP_ROM_QSTR(MP_QSTR_read_all),     MP_ROM_PTR(&pb_type_uart_device_read_all_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_readinto),     MP_ROM_PTR(&pb_type_uart_device_readinto_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_read_until),   MP_ROM_PTR(&pb_type_uart_device_read_until_obj)   },
     { MP_ROM_QSTR(MP_QSTR_write),        MP_ROM_PTR(&pb_type_uart_device_write_obj)        },
     { MP_ROM_QSTR(MP_QSTR_waiting),      MP_ROM_PTR(&pb_type_uart_device_waiting_obj)      },
     { MP_ROM_QSTR(MP_QSTR_wait_until),   MP_ROM_PTR(&pb_type_uart_device_wait_until_obj)   },
@@ -40,6 +40,12 @@ typedef struct {
     mp_obj_base_t base;
     uint32_t num_results;
     uint32_t num_results_max;
+    /** Number of results already compared to the filters. */
+    uint32_t num_checked;
+    /** Name to stop at, or MP_OBJ_NULL to not filter on name. */
+    mp_obj_t name_filter;
+    /** Address to stop at, or MP_OBJ_NULL to not filter on address. */
+    mp_obj_t address_filter;
     pbdrv_bluetooth_inquiry_result_t results[];
 } pb_messaging_bluetooth_scan_result_obj_t;
 
@@ -73,6 +79,58 @@ static char *format_bluetooth_address(uint8_t *address) {
     return bdaddr_str;
 }
 
+/**
+ * Checks if a result matches the filters given by the user.
+ *
+ * @param [in]  scanner  The scan with the filters.
+ * @param [in]  result   The result to check.
+ * @return               True if all given filters match.
+ */
+static bool pb_messaging_bluetooth_scan_result_matches(pb_messaging_bluetooth_scan_result_obj_t *scanner, pbdrv_bluetooth_inquiry_result_t *result) {
+
+    if (scanner->name_filter != MP_OBJ_NULL && strcmp(result->name, mp_obj_str_get_str(scanner->name_filter))) {
+        return false;
+    }
+
+    if (scanner->address_filter != MP_OBJ_NULL) {
+        // Compare case-insensitive, since our addresses are upper case.
+        const char *filter = mp_obj_str_get_str(scanner->address_filter);
+        const char *address = format_bluetooth_address(result->bdaddr);
+        for (size_t i = 0; i < 18; i++) {
+            char c = filter[i] >= 'a' && filter[i] <= 'f' ? filter[i] - 'a' + 'A' : filter[i];
+            if (c != address[i]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Awaits the inquiry scan, stopping it early when a result matches the
+ * filters, if any.
+ */
+static pbio_error_t pb_messaging_bluetooth_scan_iterate_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+
+    pb_messaging_bluetooth_scan_result_obj_t *scanner = MP_OBJ_TO_PTR(parent_obj);
+
+    // Check the results that came in since the last time.
+    if (scanner->name_filter != MP_OBJ_NULL || scanner->address_filter != MP_OBJ_NULL) {
+        while (scanner->num_checked < scanner->num_results) {
+            if (pb_messaging_bluetooth_scan_result_matches(scanner, &scanner->results[scanner->num_checked++])) {
+                // Lowering the maximum to the current count makes the scan
+                // end as if it was full.
+                scanner->num_results_max = scanner->num_results;
+                pbio_os_request_poll();
+                break;
+            }
+        }
+    }
+
+    return pbdrv_bluetooth_await_classic_task(state, NULL);
+}
+
 /**
  * Maps the inquiry results to a list of dictionary, to be returned to the user.
  */
@@ -98,7 +156,9 @@ static mp_obj_t pb_messaging_bluetooth_scan_return_map(mp_obj_t parent_obj) {
 static mp_obj_t pb_messaging_bluetooth_scan(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
         PB_ARG_DEFAULT_INT(timeout, 10000),
-        PB_ARG_DEFAULT_INT(num_results, 5));
+        PB_ARG_DEFAULT_INT(num_results, 5),
+        PB_ARG_DEFAULT_NONE(name),
+        PB_ARG_DEFAULT_NONE(address));
 
     // Allocate the maximum number of expected results.
     uint32_t num_results_max = mp_obj_get_int(num_results_in);
@@ -112,17 +172,24 @@ static mp_obj_t pb_messaging_bluetooth_scan(size_t n_args, const mp_obj_t *pos_a
     // Initialize at zero results.
     scanner->num_results = 0;
     scanner->num_results_max = mp_obj_get_int(num_results_in);
+    scanner->num_checked = 0;
+
+    // Optionally stop as soon as a matching device is found.
+    scanner->name_filter = name_in == mp_const_none ? MP_OBJ_NULL : name_in;
+    scanner->address_filter = address_in == mp_const_none ? MP_OBJ_NULL : address_in;
+    if (scanner->address_filter != MP_OBJ_NULL && strlen(mp_obj_str_get_str(address_in)) != 17) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
     pb_assert(pbdrv_bluetooth_start_inquiry_scan(scanner->results, &scanner->num_results, &scanner->num_results_max, mp_obj_get_int(timeout_in)));
 
     // Create an awaitable with a reference to our result to keep it from being
     // garbage collected.
-    pb_type_async_t *iter = NULL;
     pb_type_async_t config = {
-        .iter_once = pbdrv_bluetooth_await_classic_task,
+        .iter_once = pb_messaging_bluetooth_scan_iterate_once,
         .parent_obj = MP_OBJ_FROM_PTR(scanner),
         .return_map = pb_messaging_bluetooth_scan_return_map,
     };
-    return pb_type_async_wait_or_await(&config, &iter, false);
+    return pb_type_async_wait_or_await(&config, NULL, false);
 }
 // See also messaging_globals_table below. This function object is added there to make it importable.
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_messaging_bluetooth_scan_obj, 0, pb_messaging_bluetooth_scan);
@@ -26,7 +26,7 @@
 typedef struct _pb_type_nxtdevices_colorsensor_obj_t {
     mp_obj_base_t base;
     pbio_port_t *port;
-    mp_obj_t color_map;
+    pb_color_map_t color_map;
 } pb_type_nxtdevices_colorsensor_obj_t;
 
 // pybricks.nxtdevices.ColorSensor.ambient
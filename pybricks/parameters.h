@@ -71,6 +71,8 @@ extern const mp_obj_base_t pb_Icon_obj;
 extern const mp_obj_type_t pb_type_Image;
 extern const mp_obj_base_t pb_image_file_obj;
 mp_obj_t pb_type_Image_display_obj_new(void);
+size_t pb_type_Image_get_heap_used_max(void);
+void pb_type_Image_reset_heap_used_max(void);
 extern const mp_rom_map_elem_t pb_type_image_attributes_dict_table[];
 
 extern const mp_obj_dict_t pb_type_image_attributes_dict;
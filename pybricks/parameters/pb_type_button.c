@@ -150,6 +150,13 @@ pbio_button_flags_t pb_type_button_get_button_flag(mp_obj_t obj) {
 }
 #endif
 
+/**
+ * Common function to get the pressed buttons of a hub as flags.
+ */
+pbio_button_flags_t pb_type_button_get_flags_hub(mp_obj_t parent_obj) {
+    return pbdrv_button_get_pressed();
+}
+
 /**
  * Common button pressed function for single button hubs.
  */
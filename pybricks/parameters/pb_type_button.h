@@ -25,6 +25,9 @@ pbio_button_flags_t pb_type_button_get_button_flag(mp_obj_t obj);
 typedef mp_obj_t (*pb_type_button_get_pressed_t)(mp_obj_t parent_obj);
 mp_obj_t pb_type_button_pressed_hub_single_button(mp_obj_t parent_obj);
 
+typedef pbio_button_flags_t (*pb_type_button_get_flags_t)(mp_obj_t parent_obj);
+pbio_button_flags_t pb_type_button_get_flags_hub(mp_obj_t parent_obj);
+
 #endif // PYBRICKS_PY_PARAMETERS_BUTTON
 
 #endif // PYBRICKS_PY_PARAMETERS
@@ -47,8 +47,50 @@ typedef struct _pb_type_Image_obj_t {
     mp_obj_t owner;
     pbio_image_t image;
     pb_type_Image_display_t display_type;
+    // Pixels are on the MicroPython heap instead of the image heap, so they
+    // are freed by the garbage collector.
+    bool pixels_in_gc_heap;
 } pb_type_Image_obj_t;
 
+// Bytes of the image heap in use by image buffers, and the most since reset.
+static size_t pb_type_Image_heap_used;
+static size_t pb_type_Image_heap_used_max;
+
+size_t pb_type_Image_get_heap_used_max(void) {
+    return pb_type_Image_heap_used_max;
+}
+
+void pb_type_Image_reset_heap_used_max(void) {
+    pb_type_Image_heap_used_max = pb_type_Image_heap_used;
+}
+
+// Allocates a buffer on the image heap, or returns NULL if it is full.
+static void *pb_type_Image_heap_alloc(size_t size) {
+    void *buf = umm_malloc(size);
+    if (buf) {
+        pb_type_Image_heap_used += size;
+        if (pb_type_Image_heap_used > pb_type_Image_heap_used_max) {
+            pb_type_Image_heap_used_max = pb_type_Image_heap_used;
+        }
+    }
+    return buf;
+}
+
+// Allocates pixels for a standalone image. The image heap is tried first. If
+// it is full, the MicroPython heap is used, so programs with many images can
+// also use the RAM that is not needed for objects.
+static void *pb_type_Image_alloc_pixels(pb_type_Image_obj_t *self, size_t size) {
+    void *buf = pb_type_Image_heap_alloc(size);
+    self->pixels_in_gc_heap = !buf;
+    if (!buf) {
+        buf = m_malloc_maybe(size);
+    }
+    if (!buf) {
+        mp_raise_type(&mp_type_MemoryError);
+    }
+    return buf;
+}
+
 static int get_color(mp_obj_t obj) {
     uint8_t max = pbdrv_display_get_max_value();
     if (obj == mp_const_none) {
@@ -65,6 +107,7 @@ mp_obj_t pb_type_Image_display_obj_new(void) {
     pb_type_Image_obj_t *self = mp_obj_malloc(pb_type_Image_obj_t, &pb_type_Image);
     self->owner = MP_OBJ_NULL;
     self->display_type = PB_TYPE_IMAGE_DISPLAY_UNUSED;
+    self->pixels_in_gc_heap = false;
     self->image = *pbdrv_display_get_image();
 
     return MP_OBJ_FROM_PTR(self);
@@ -88,16 +131,15 @@ static mp_obj_t pb_type_Image_make_new(const mp_obj_type_t *type,
         // Copy.
         int width = source->image.width;
         int height = source->image.height;
-
-        void *buf = umm_malloc(width * height * sizeof(uint8_t));
-        if (!buf) {
-            mp_raise_type(&mp_type_MemoryError);
-        }
+        pbio_image_format_t format = source->image.format;
+        int stride = pbio_image_get_min_stride(format, width);
 
         self = mp_obj_malloc_with_finaliser(pb_type_Image_obj_t, &pb_type_Image);
         self->owner = MP_OBJ_NULL;
         self->display_type = PB_TYPE_IMAGE_DISPLAY_NONE;
-        pbio_image_init(&self->image, buf, width, height, width);
+        self->image.pixels = NULL;
+        void *buf = pb_type_Image_alloc_pixels(self, stride * height);
+        pbio_image_init_format(&self->image, buf, width, height, stride, format);
         self->image.print_font = source->image.print_font;
         self->image.print_value = source->image.print_value;
         pbio_image_draw_image(&self->image, &source->image, 0, 0);
@@ -110,6 +152,7 @@ static mp_obj_t pb_type_Image_make_new(const mp_obj_type_t *type,
         self = mp_obj_malloc(pb_type_Image_obj_t, &pb_type_Image);
         self->owner = source_in;
         self->display_type = PB_TYPE_IMAGE_DISPLAY_NONE;
+        self->pixels_in_gc_heap = false;
         int width = x2 - x1 + 1;
         int height = y2 - y1 + 1;
         pbio_image_init_sub(&self->image, &source->image, x1, y1, width, height);
@@ -118,11 +161,71 @@ static mp_obj_t pb_type_Image_make_new(const mp_obj_type_t *type,
     return MP_OBJ_FROM_PTR(self);
 }
 
+// Number of pooled buffers the size of a small icon.
+#define PB_TYPE_IMAGE_POOL_NUM_ICON (8)
+// Number of pooled buffers the size of the display.
+#define PB_TYPE_IMAGE_POOL_NUM_SCREEN (2)
+// Width and height of icons in the pool.
+#define PB_TYPE_IMAGE_POOL_ICON_SIZE (32)
+
+// Buffers for images created with pool=True. Each buffer is allocated the
+// first time it is needed and then kept, so programs that keep creating and
+// closing off-screen images reuse the same memory instead of fragmenting the
+// heap. Icon buffers come first, so the smallest buffer that fits is used.
+static struct {
+    void *buf;
+    bool in_use;
+} pb_type_Image_pool[PB_TYPE_IMAGE_POOL_NUM_ICON + PB_TYPE_IMAGE_POOL_NUM_SCREEN];
+
+static size_t pb_type_Image_pool_get_slab_size(size_t index) {
+    pbio_image_t *display = pbdrv_display_get_image();
+    if (index < PB_TYPE_IMAGE_POOL_NUM_ICON) {
+        return pbio_image_get_min_stride(display->format, PB_TYPE_IMAGE_POOL_ICON_SIZE) * PB_TYPE_IMAGE_POOL_ICON_SIZE;
+    }
+    return pbio_image_get_min_stride(display->format, display->width) * display->height;
+}
+
+// Gets a pooled buffer of at least the given size, or NULL if none is free.
+static void *pb_type_Image_pool_alloc(size_t size) {
+    for (size_t i = 0; i < MP_ARRAY_SIZE(pb_type_Image_pool); i++) {
+        if (pb_type_Image_pool[i].in_use || size > pb_type_Image_pool_get_slab_size(i)) {
+            continue;
+        }
+        if (!pb_type_Image_pool[i].buf) {
+            // Pooled buffers are kept between programs, so they must
+            // always be on the image heap.
+            pb_type_Image_pool[i].buf = pb_type_Image_heap_alloc(pb_type_Image_pool_get_slab_size(i));
+            if (!pb_type_Image_pool[i].buf) {
+                return NULL;
+            }
+        }
+        pb_type_Image_pool[i].in_use = true;
+        return pb_type_Image_pool[i].buf;
+    }
+    return NULL;
+}
+
+// Returns a buffer to the pool. Returns false if it is not a pooled buffer.
+static bool pb_type_Image_pool_free(void *buf) {
+    for (size_t i = 0; i < MP_ARRAY_SIZE(pb_type_Image_pool); i++) {
+        if (pb_type_Image_pool[i].buf == buf) {
+            pb_type_Image_pool[i].in_use = false;
+            return true;
+        }
+    }
+    return false;
+}
+
 static mp_obj_t pb_type_Image_close(mp_obj_t self_in) {
     pb_type_Image_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    // If we own the memory, free it.
+    // If we own the memory, free it or return it to the pool. Pixels on the
+    // MicroPython heap are left to the garbage collector, since this may run
+    // as a finaliser during a collection.
     if (self->owner == MP_OBJ_NULL && self->display_type == PB_TYPE_IMAGE_DISPLAY_NONE && self->image.pixels) {
-        umm_free(self->image.pixels);
+        if (!self->pixels_in_gc_heap && !pb_type_Image_pool_free(self->image.pixels)) {
+            umm_free(self->image.pixels);
+            pb_type_Image_heap_used -= self->image.stride * self->image.height;
+        }
         self->image.pixels = NULL;
     }
     return mp_const_none;
@@ -132,7 +235,8 @@ MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Image_close_obj, pb_type_Image_close);
 static mp_obj_t pb_type_Image_empty(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
         PB_ARG_DEFAULT_NONE(width),
-        PB_ARG_DEFAULT_NONE(height));
+        PB_ARG_DEFAULT_NONE(height),
+        PB_ARG_DEFAULT_FALSE(pool));
 
     pbio_image_t *display = pbdrv_display_get_image();
 
@@ -143,15 +247,24 @@ static mp_obj_t pb_type_Image_empty(size_t n_args, const mp_obj_t *pos_args, mp_
         mp_raise_ValueError(MP_ERROR_TEXT("Image width or height is less than 1"));
     }
 
-    void *buf = umm_malloc(width * height * sizeof(uint8_t));
-    if (!buf) {
-        mp_raise_type(&mp_type_MemoryError);
-    }
-
     pb_type_Image_obj_t *self = mp_obj_malloc_with_finaliser(pb_type_Image_obj_t, &pb_type_Image);
     self->owner = MP_OBJ_NULL;
     self->display_type = PB_TYPE_IMAGE_DISPLAY_NONE;
-    pbio_image_init(&self->image, buf, width, height, width);
+    self->image.pixels = NULL;
+    self->pixels_in_gc_heap = false;
+
+    // Use the display format, so drawing onto the display is a plain copy.
+    int stride = pbio_image_get_min_stride(display->format, width);
+    void *buf = NULL;
+    if (mp_obj_is_true(pool_in)) {
+        buf = pb_type_Image_pool_alloc(stride * height);
+    }
+    // Allocate separately if not pooled, too big, or the pool is used up.
+    if (!buf) {
+        buf = pb_type_Image_alloc_pixels(self, stride * height);
+    }
+
+    pbio_image_init_format(&self->image, buf, width, height, stride, display->format);
     self->image.print_font = display->print_font;
     self->image.print_value = display->print_value;
     pbio_image_fill(&self->image, 0);
@@ -257,6 +370,69 @@ static mp_obj_t pb_type_Image_draw_image(size_t n_args, const mp_obj_t *pos_args
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Image_draw_image_obj, 1, pb_type_Image_draw_image);
 
+static mp_obj_t pb_type_Image_draw_images(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_Image_obj_t, self,
+        PB_ARG_REQUIRED(sources),
+        PB_ARG_REQUIRED(positions),
+        PB_ARG_DEFAULT_NONE(transparent));
+
+    // Check all sources once, so drawing can just index them.
+    size_t num_sources;
+    mp_obj_t *sources;
+    mp_obj_get_array(sources_in, &num_sources, &sources);
+    for (size_t i = 0; i < num_sources; i++) {
+        pb_assert_type(sources[i], &pb_type_Image);
+    }
+
+    int transparent_value = transparent_in == mp_const_none ? -1 : get_color(transparent_in);
+
+    // Positions are given as an array('h') of index, x, y values, or as a
+    // sequence of (index, x, y) tuples.
+    mp_buffer_info_t bufinfo;
+    bool packed = mp_get_buffer(positions_in, &bufinfo, MP_BUFFER_READ) && bufinfo.typecode == 'h';
+    size_t num_positions;
+    mp_obj_t *positions = NULL;
+    if (packed) {
+        num_positions = bufinfo.len / (3 * sizeof(int16_t));
+    } else {
+        mp_obj_get_array(positions_in, &num_positions, &positions);
+    }
+
+    for (size_t i = 0; i < num_positions; i++) {
+        mp_int_t index, x, y;
+        if (packed) {
+            const int16_t *values = (const int16_t *)bufinfo.buf + i * 3;
+            index = values[0];
+            x = values[1];
+            y = values[2];
+        } else {
+            mp_obj_t *values;
+            mp_obj_get_array_fixed_n(positions[i], 3, &values);
+            index = mp_obj_get_int(values[0]);
+            x = mp_obj_get_int(values[1]);
+            y = mp_obj_get_int(values[2]);
+        }
+
+        if (index < 0 || (size_t)index >= num_sources) {
+            mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("Image index out of range"));
+        }
+        pb_type_Image_obj_t *source = MP_OBJ_TO_PTR(sources[index]);
+
+        if (transparent_value < 0) {
+            pbio_image_draw_image(&self->image, &source->image, x, y);
+        } else {
+            pbio_image_draw_image_transparent(&self->image, &source->image, x, y, transparent_value);
+        }
+    }
+
+    // Update the display once for all images.
+    pb_type_Image_handle_display_update(self);
+
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_Image_draw_images_obj, 1, pb_type_Image_draw_images);
+
 static mp_obj_t pb_type_Image_draw_pixel(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         pb_type_Image_obj_t, self,
@@ -441,6 +617,23 @@ static mp_obj_t pb_type_Image_set_font(mp_obj_t self_in, mp_obj_t font_in) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_2(pb_type_Image_set_font_obj, pb_type_Image_set_font);
 
+static mp_obj_t pb_type_Image_swap(mp_obj_t self_in) {
+    pb_type_Image_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Other images are not shown, so there is nothing to do.
+    if (self->display_type != PB_TYPE_IMAGE_DISPLAY_READY) {
+        return mp_const_none;
+    }
+
+    // From now on, drawing shows up only when swapping, so the display never
+    // shows a partially drawn frame.
+    pbdrv_display_set_double_buffered(true);
+    pbdrv_display_swap();
+
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Image_swap_obj, pb_type_Image_swap);
+
 // dir(pybricks.parameters.Image)
 static const mp_rom_map_elem_t pb_type_Image_locals_dict_table[] = {
     // REVISIT: consider close() method and __enter__/__exit__ for context manager
@@ -450,6 +643,7 @@ static const mp_rom_map_elem_t pb_type_Image_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_clear), MP_ROM_PTR(&pb_type_Image_clear_obj) },
     { MP_ROM_QSTR(MP_QSTR_load_image), MP_ROM_PTR(&pb_type_Image_load_image_obj) },
     { MP_ROM_QSTR(MP_QSTR_draw_image), MP_ROM_PTR(&pb_type_Image_draw_image_obj) },
+    { MP_ROM_QSTR(MP_QSTR_draw_images), MP_ROM_PTR(&pb_type_Image_draw_images_obj) },
     { MP_ROM_QSTR(MP_QSTR_draw_pixel), MP_ROM_PTR(&pb_type_Image_draw_pixel_obj) },
     { MP_ROM_QSTR(MP_QSTR_draw_line), MP_ROM_PTR(&pb_type_Image_draw_line_obj) },
     { MP_ROM_QSTR(MP_QSTR_draw_box), MP_ROM_PTR(&pb_type_Image_draw_box_obj) },
@@ -457,6 +651,7 @@ static const mp_rom_map_elem_t pb_type_Image_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_draw_text), MP_ROM_PTR(&pb_type_Image_draw_text_obj) },
     { MP_ROM_QSTR(MP_QSTR_print), MP_ROM_PTR(&pb_type_Image_print_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_font), MP_ROM_PTR(&pb_type_Image_set_font_obj) },
+    { MP_ROM_QSTR(MP_QSTR_swap), MP_ROM_PTR(&pb_type_Image_swap_obj) },
 };
 static MP_DEFINE_CONST_DICT(pb_type_Image_locals_dict, pb_type_Image_locals_dict_table);
 
@@ -488,19 +683,15 @@ static void pb_type_image_file_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest)
     // This is a standalone image.
     self->owner = MP_OBJ_NULL;
     self->display_type = PB_TYPE_IMAGE_DISPLAY_NONE;
+    self->pixels_in_gc_heap = true;
 
-    // Default to same colors as display.
+    // Size is given by source, format and colors are the same as display.
     pbio_image_t *display = pbdrv_display_get_image();
+    int stride = pbio_image_get_min_stride(display->format, compressed->width);
+    pbio_image_init_format(&self->image, m_malloc0(stride * compressed->height),
+        compressed->width, compressed->height, stride, display->format);
     self->image.print_font = display->print_font;
     self->image.print_value = display->print_value;
-    self->image.print_x_left = 0;
-    self->image.print_y_top = 0;
-
-    // Size is given by source.
-    self->image.height = compressed->height;
-    self->image.width = compressed->width;
-    self->image.stride = compressed->width;
-    self->image.pixels = m_malloc0(compressed->width * compressed->height);
 
     pbio_image_draw_image_transparent_from_monochrome(&self->image, compressed, 0, 0, self->image.print_value);
 
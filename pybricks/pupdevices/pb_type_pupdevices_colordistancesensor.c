@@ -20,7 +20,7 @@
 // Class structure for ColorDistanceSensor. Note: first two members must match pb_ColorSensor_obj_t
 typedef struct _pupdevices_ColorDistanceSensor_obj_t {
     pb_type_device_obj_base_t device_base;
-    mp_obj_t color_map;
+    pb_color_map_t color_map;
     mp_obj_t light;
 } pupdevices_ColorDistanceSensor_obj_t;
 
@@ -22,14 +22,15 @@
 // Class structure for ColorSensor. Note: first two members must match pb_ColorSensor_obj_t
 typedef struct _pupdevices_ColorSensor_obj_t {
     pb_type_device_obj_base_t device_base;
-    mp_obj_t color_map;
+    pb_color_map_t color_map;
     mp_obj_t lights;
 } pupdevices_ColorSensor_obj_t;
 
 // pybricks.pupdevices.ColorSensor.__init__
 static mp_obj_t pupdevices_ColorSensor_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     PB_PARSE_ARGS_CLASS(n_args, n_kw, args,
-        PB_ARG_REQUIRED(port));
+        PB_ARG_REQUIRED(port),
+        PB_ARG_DEFAULT_FALSE(background));
 
     pupdevices_ColorSensor_obj_t *self = mp_obj_malloc(pupdevices_ColorSensor_obj_t, type);
     pb_type_device_init_class(&self->device_base, port_in, LEGO_DEVICE_TYPE_ID_SPIKE_COLOR_SENSOR);
@@ -40,6 +41,23 @@ static mp_obj_t pupdevices_ColorSensor_make_new(const mp_obj_type_t *type, size_
     // Do one reading to make sure everything is working and to set default mode
     pb_type_device_get_data_blocking(MP_OBJ_FROM_PTR(self), LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I);
 
+    // Optionally let the sensor report reflected and ambient data together,
+    // so all methods read the latest data without switching modes.
+    if (mp_obj_is_true(background_in)) {
+        static const uint8_t values[] = {
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I, 0),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I, 1),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I, 2),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I, 3),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__SHSV, 0),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__SHSV, 1),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__SHSV, 2),
+            LUMP_COMBI_VALUE(LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__SHSV, 3),
+        };
+        pb_assert(pbio_port_lump_set_mode_combi(self->device_base.lump_dev, values, MP_ARRAY_SIZE(values)));
+        pb_type_device_get_data_blocking(MP_OBJ_FROM_PTR(self), LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I);
+    }
+
     // Save default settings
     pb_color_map_save_default(&self->color_map);
 
@@ -138,6 +156,30 @@ static mp_obj_t get_hsv(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_ar
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(get_hsv_obj, 1, get_hsv);
 
+// pybricks.pupdevices.ColorSensor.hsv_into
+static mp_obj_t get_hsv_into(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pupdevices_ColorSensor_obj_t, self,
+        PB_ARG_REQUIRED(buffer),
+        PB_ARG_DEFAULT_TRUE(surface));
+
+    // Same values as hsv(), without allocating a Color. This waits only if
+    // the sensor has to change modes first.
+    pbio_color_hsv_t hsv;
+    if (mp_obj_is_true(surface_in)) {
+        pb_type_device_get_data_blocking(MP_OBJ_FROM_PTR(self), LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__RGB_I);
+        get_hsv_reflected(MP_OBJ_FROM_PTR(self), &hsv);
+    } else {
+        pb_type_device_get_data_blocking(MP_OBJ_FROM_PTR(self), LEGO_DEVICE_MODE_PUP_COLOR_SENSOR__SHSV);
+        get_hsv_ambient(MP_OBJ_FROM_PTR(self), &hsv);
+    }
+
+    int32_t values[] = { hsv.h, hsv.s, hsv.v };
+    pb_obj_set_int_buffer(buffer_in, MP_ARRAY_SIZE(values), values);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(get_hsv_into_obj, 1, get_hsv_into);
+
 // pybricks.pupdevices.ColorSensor.color
 static mp_obj_t get_color(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
@@ -169,6 +211,7 @@ static const pb_attr_dict_entry_t pupdevices_ColorSensor_attr_dict[] = {
 // dir(pybricks.pupdevices.ColorSensor)
 static const mp_rom_map_elem_t pupdevices_ColorSensor_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_hsv),         MP_ROM_PTR(&get_hsv_obj)                  },
+    { MP_ROM_QSTR(MP_QSTR_hsv_into),    MP_ROM_PTR(&get_hsv_into_obj)             },
     { MP_ROM_QSTR(MP_QSTR_color),       MP_ROM_PTR(&get_color_obj)                },
     { MP_ROM_QSTR(MP_QSTR_reflection),  MP_ROM_PTR(&get_reflection_obj)           },
     { MP_ROM_QSTR(MP_QSTR_ambient),     MP_ROM_PTR(&get_ambient_obj)              },
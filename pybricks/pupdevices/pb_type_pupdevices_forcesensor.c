@@ -82,11 +82,16 @@ static mp_obj_t get_force(mp_obj_t self_in) {
 }
 static PB_DEFINE_CONST_TYPE_DEVICE_METHOD_OBJ(get_force_obj, LEGO_DEVICE_MODE_PUP_FORCE_SENSOR__FRAW, get_force);
 
+// pybricks.pupdevices.ForceSensor._distance
+static int32_t get_distance_um(mp_obj_t self_in) {
+    // Get distance in micrometers
+    pupdevices_ForceSensor_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return (6670 * (get_raw(self_in) - self->raw_released)) / (self->raw_end - self->raw_released);
+}
+
 // pybricks.pupdevices.ForceSensor.distance
 static mp_obj_t get_distance(mp_obj_t self_in) {
-    pupdevices_ForceSensor_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    int32_t distance_um = (6670 * (get_raw(self_in) - self->raw_released)) / (self->raw_end - self->raw_released);
-    return pb_obj_new_fraction(distance_um, 1000);
+    return pb_obj_new_fraction(get_distance_um(self_in), 1000);
 }
 static PB_DEFINE_CONST_TYPE_DEVICE_METHOD_OBJ(get_distance_obj, LEGO_DEVICE_MODE_PUP_FORCE_SENSOR__FRAW, get_distance);
 
@@ -113,12 +118,24 @@ static mp_obj_t get_pressed(size_t n_args, const mp_obj_t *pos_args, mp_map_t *k
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(get_pressed_obj, 1, get_pressed);
 
+// pybricks.pupdevices.ForceSensor.state_into
+static mp_obj_t get_state_into(mp_obj_t self_in, mp_obj_t buf_in) {
+    // Force in mN and distance in um, without allocating floats. This waits
+    // only if the sensor has to change modes first.
+    pb_type_device_get_data_blocking(self_in, LEGO_DEVICE_MODE_PUP_FORCE_SENSOR__FRAW);
+    int32_t state[] = { get_force_mN(self_in), get_distance_um(self_in) };
+    pb_obj_set_int_buffer(buf_in, MP_ARRAY_SIZE(state), state);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(get_state_into_obj, get_state_into);
+
 // dir(pybricks.pupdevices.ForceSensor)
 static const mp_rom_map_elem_t pupdevices_ForceSensor_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_touched),     MP_ROM_PTR(&get_touched_obj)              },
     { MP_ROM_QSTR(MP_QSTR_force),       MP_ROM_PTR(&get_force_obj)                },
     { MP_ROM_QSTR(MP_QSTR_pressed),     MP_ROM_PTR(&get_pressed_obj)              },
     { MP_ROM_QSTR(MP_QSTR_distance),    MP_ROM_PTR(&get_distance_obj)             },
+    { MP_ROM_QSTR(MP_QSTR_state_into),  MP_ROM_PTR(&get_state_into_obj)           },
 };
 static MP_DEFINE_CONST_DICT(pupdevices_ForceSensor_locals_dict, pupdevices_ForceSensor_locals_dict_table);
 
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: MIT
-// Copyright (c) 2018-2023 The Pybricks Authors
+// Copyright (c) 2018-2026 The Pybricks Authors
 
 #include "py/mpconfig.h"
 
@@ -7,6 +7,7 @@
 
 #include <pbio/button.h>
 #include <pbio/dcmotor.h>
+#include <pbio/pf_ir.h>
 
 #include "py/mphal.h"
 
@@ -14,6 +15,7 @@
 #include <pybricks/parameters.h>
 #include <pybricks/pupdevices.h>
 #include <pybricks/common/pb_type_device.h>
+#include <pybricks/tools/pb_type_async.h>
 
 #include <pybricks/util_mp/pb_kwarg_helper.h>
 #include <pybricks/util_mp/pb_obj_helper.h>
@@ -65,6 +67,13 @@ static mp_obj_t pupdevices_PFMotor_make_new(const mp_obj_type_t *type, size_t n_
 }
 
 static mp_obj_t pupdevices_PFMotor__send(pupdevices_PFMotor_obj_t *self, int16_t message) {
+    #if PBIO_CONFIG_PF_IR
+    // Queue the value. The sensor sends it in the background, along with
+    // the values of other motors on the same sensor, so this returns right away.
+    pbio_pf_ir_output_t output = self->use_blue_port ? PBIO_PF_IR_OUTPUT_BLUE : PBIO_PF_IR_OUTPUT_RED;
+    pb_assert(pbio_pf_ir_set(self->device_base->lump_dev, self->channel - 1, output, message));
+    return pb_type_async_return_result(mp_const_none, &self->device_base->last_awaitable);
+    #else
     // Choose blue or red output
     message |= (self->use_blue_port) << 4;
 
@@ -78,6 +87,7 @@ static mp_obj_t pupdevices_PFMotor__send(pupdevices_PFMotor_obj_t *self, int16_t
     // to ensure the data is properly sent and received. This also ensures that
     // the message will still work if two identical values are sent in a row.
     return pb_type_device_set_data(self->device_base, LEGO_DEVICE_MODE_PUP_COLOR_DISTANCE_SENSOR__IR_TX, &message, sizeof(message));
+    #endif // PBIO_CONFIG_PF_IR
 }
 
 // pybricks.pupdevices.PFMotor.dc
@@ -57,6 +57,24 @@ static mp_obj_t pb_type_DriveBase_reset(size_t n_args, const mp_obj_t *pos_args,
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_DriveBase_reset_obj, 1, pb_type_DriveBase_reset);
 
+// Gets the servos of one side, given as one motor or a tuple of motors.
+static size_t pb_type_DriveBase_get_servos(mp_obj_t motors_in, pbio_servo_t **servos) {
+    if (!mp_obj_is_type(motors_in, &mp_type_tuple) && !mp_obj_is_type(motors_in, &mp_type_list)) {
+        servos[0] = pb_type_motor_get_servo(motors_in);
+        return 1;
+    }
+    size_t num_motors;
+    mp_obj_t *motors;
+    mp_obj_get_array(motors_in, &num_motors, &motors);
+    if (num_motors < 1 || num_motors > PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    for (size_t i = 0; i < num_motors; i++) {
+        servos[i] = pb_type_motor_get_servo(motors[i]);
+    }
+    return num_motors;
+}
+
 // pybricks.robotics.DriveBase.__init__
 static mp_obj_t pb_type_DriveBase_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
 
@@ -68,14 +86,19 @@ static mp_obj_t pb_type_DriveBase_make_new(const mp_obj_type_t *type, size_t n_a
 
     pb_type_DriveBase_obj_t *self = mp_obj_malloc(pb_type_DriveBase_obj_t, type);
 
-    // Pointers to servos
-    pbio_servo_t *srv_left = pb_type_motor_get_servo(left_motor_in);
-    pbio_servo_t *srv_right = pb_type_motor_get_servo(right_motor_in);
+    // Pointers to servos. Each side may have several motors.
+    pbio_servo_t *srv_left[PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE];
+    pbio_servo_t *srv_right[PBIO_CONFIG_DRIVEBASE_MOTORS_PER_SIDE];
+    size_t motors_per_side = pb_type_DriveBase_get_servos(left_motor_in, srv_left);
+    if (pb_type_DriveBase_get_servos(right_motor_in, srv_right) != motors_per_side) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
 
     // Create drivebase. Initialized to use motor encoders (not gyro) for heading.
-    pb_assert(pbio_drivebase_get_drivebase(&self->db,
+    pb_assert(pbio_drivebase_get_drivebase_multi(&self->db,
         srv_left,
         srv_right,
+        motors_per_side,
         pb_obj_get_scaled_int(wheel_diameter_in, 1000),
         pb_obj_get_scaled_int(axle_track_in, 1000)));
 
@@ -292,6 +315,41 @@ static mp_obj_t pb_type_DriveBase_arc(size_t n_args, const mp_obj_t *pos_args, m
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_DriveBase_arc_obj, 1, pb_type_DriveBase_arc);
 
+// pybricks.robotics.DriveBase.path
+static mp_obj_t pb_type_DriveBase_path(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        pb_type_DriveBase_obj_t, self,
+        PB_ARG_REQUIRED(segments),
+        PB_ARG_DEFAULT_OBJ(then, pb_Stop_HOLD_obj),
+        PB_ARG_DEFAULT_TRUE(wait));
+
+    // Parse the (radius, distance) pairs.
+    size_t num_segments;
+    mp_obj_t *segment_objs;
+    mp_obj_get_array(segments_in, &num_segments, &segment_objs);
+    if (num_segments == 0 || num_segments > PBIO_CONFIG_DRIVEBASE_PATH_SIZE) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    pbio_drivebase_path_segment_t segments[PBIO_CONFIG_DRIVEBASE_PATH_SIZE];
+    for (size_t i = 0; i < num_segments; i++) {
+        mp_obj_t *pair;
+        mp_obj_get_array_fixed_n(segment_objs[i], 2, &pair);
+        segments[i].radius = pb_obj_get_int(pair[0]);
+        segments[i].distance = pb_obj_get_int(pair[1]);
+    }
+
+    pbio_control_on_completion_t then = pb_type_enum_get_value(then_in, &pb_enum_type_Stop);
+
+    pb_assert(pbio_drivebase_drive_path(self->db, segments, num_segments, then));
+
+    if (!mp_obj_is_true(wait_in)) {
+        return mp_const_none;
+    }
+    // Handle completion by awaiting or blocking.
+    return await_or_wait(self);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_DriveBase_path_obj, 1, pb_type_DriveBase_path);
+
 // pybricks.robotics.DriveBase.drive
 static mp_obj_t pb_type_DriveBase_drive(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
@@ -352,6 +410,25 @@ static mp_obj_t pb_type_DriveBase_angle(mp_obj_t self_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(pb_type_DriveBase_angle_obj, pb_type_DriveBase_angle);
 
+#if MICROPY_PY_BUILTINS_FLOAT && PBIO_CONFIG_DRIVEBASE_ODOMETRY
+// pybricks.robotics.DriveBase.pose
+static mp_obj_t pb_type_DriveBase_pose(mp_obj_t self_in) {
+    pb_type_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Pose is integrated in the motor process, so this just reads it.
+    float x, y, heading;
+    pb_assert(pbio_drivebase_get_pose(self->db, &x, &y, &heading));
+
+    mp_obj_t ret[3];
+    ret[0] = mp_obj_new_float_from_f(x);
+    ret[1] = mp_obj_new_float_from_f(y);
+    ret[2] = mp_obj_new_float_from_f(heading);
+
+    return mp_obj_new_tuple(3, ret);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(pb_type_DriveBase_pose_obj, pb_type_DriveBase_pose);
+#endif // MICROPY_PY_BUILTINS_FLOAT && PBIO_CONFIG_DRIVEBASE_ODOMETRY
+
 // pybricks.robotics.DriveBase.state
 static mp_obj_t pb_type_DriveBase_state(mp_obj_t self_in) {
     pb_type_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -369,6 +446,19 @@ static mp_obj_t pb_type_DriveBase_state(mp_obj_t self_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(pb_type_DriveBase_state_obj, pb_type_DriveBase_state);
 
+// pybricks.robotics.DriveBase.state_into
+static mp_obj_t pb_type_DriveBase_state_into(mp_obj_t self_in, mp_obj_t buf_in) {
+    pb_type_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Same values as state(), without allocating objects.
+    int32_t state[4];
+    pb_assert(pbio_drivebase_get_state_user(self->db, &state[0], &state[1], &state[2], &state[3]));
+
+    pb_obj_set_int_buffer(buf_in, MP_ARRAY_SIZE(state), state);
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(pb_type_DriveBase_state_into_obj, pb_type_DriveBase_state_into);
+
 // pybricks.robotics.DriveBase.done
 static mp_obj_t pb_type_DriveBase_done(mp_obj_t self_in) {
     pb_type_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -462,6 +552,7 @@ static const pb_attr_dict_entry_t pb_type_DriveBase_attr_dict[] = {
 static const mp_rom_map_elem_t pb_type_DriveBase_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_arc),              MP_ROM_PTR(&pb_type_DriveBase_arc_obj)      },
     { MP_ROM_QSTR(MP_QSTR_curve),            MP_ROM_PTR(&pb_type_DriveBase_curve_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_path),             MP_ROM_PTR(&pb_type_DriveBase_path_obj)     },
     { MP_ROM_QSTR(MP_QSTR_straight),         MP_ROM_PTR(&pb_type_DriveBase_straight_obj) },
     { MP_ROM_QSTR(MP_QSTR_turn),             MP_ROM_PTR(&pb_type_DriveBase_turn_obj)     },
     { MP_ROM_QSTR(MP_QSTR_drive),            MP_ROM_PTR(&pb_type_DriveBase_drive_obj)    },
@@ -471,6 +562,7 @@ static const mp_rom_map_elem_t pb_type_DriveBase_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_angle),            MP_ROM_PTR(&pb_type_DriveBase_angle_obj)    },
     { MP_ROM_QSTR(MP_QSTR_done),             MP_ROM_PTR(&pb_type_DriveBase_done_obj)     },
     { MP_ROM_QSTR(MP_QSTR_state),            MP_ROM_PTR(&pb_type_DriveBase_state_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_state_into),       MP_ROM_PTR(&pb_type_DriveBase_state_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_reset),            MP_ROM_PTR(&pb_type_DriveBase_reset_obj)    },
     { MP_ROM_QSTR(MP_QSTR_settings),         MP_ROM_PTR(&pb_type_DriveBase_settings_obj) },
     { MP_ROM_QSTR(MP_QSTR_stalled),          MP_ROM_PTR(&pb_type_DriveBase_stalled_obj)  },
@@ -480,6 +572,9 @@ static const mp_rom_map_elem_t pb_type_DriveBase_locals_dict_table[] = {
     #if MICROPY_PY_BUILTINS_FLOAT
     { MP_ROM_QSTR(MP_QSTR_move_by),          MP_ROM_PTR(&pb_type_DriveBase_move_by_obj)  },
     #endif
+    #if MICROPY_PY_BUILTINS_FLOAT && PBIO_CONFIG_DRIVEBASE_ODOMETRY
+    { MP_ROM_QSTR(MP_QSTR_pose),             MP_ROM_PTR(&pb_type_DriveBase_pose_obj)     },
+    #endif
 };
 // First N entries are common to both drive base classes.
 static MP_DEFINE_CONST_DICT(pb_type_DriveBase_locals_dict, pb_type_DriveBase_locals_dict_table);
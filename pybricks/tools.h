@@ -16,12 +16,83 @@ bool pb_module_tools_run_loop_is_active(void);
 
 void pb_module_tools_assert_blocking(void);
 
+void pb_module_tools_set_wake_time(uint32_t time);
+
+void pb_module_tools_clear_wake_time(void);
+
+bool pb_module_tools_get_wake_time(uint32_t *time);
+
+/**
+ * Startup statistics of the user program, kept by the MicroPython runtime.
+ */
+typedef struct {
+    /** Number of downloaded modules, including the main module. */
+    uint32_t num_modules;
+    /** Time to index the downloaded modules. */
+    uint32_t index_time_us;
+    /** Time to initialize MicroPython and the pybricks package. */
+    uint32_t init_time_us;
+    /** Number of downloaded modules imported so far. */
+    uint32_t num_imports;
+    /** Time spent importing downloaded modules, including nested imports once. */
+    uint32_t import_time_us;
+} pb_startup_stats_t;
+
+const pb_startup_stats_t *pb_startup_stats_get(void);
+
+void pb_warm_restart_request(bool enable);
+
+#if PYBRICKS_OPT_GC_STATS
+
+/** Number of buckets in the garbage collection pause histogram. */
+#define PB_GC_STATS_NUM_BUCKETS (6)
+
+/**
+ * Garbage collection statistics of the user program.
+ *
+ * A pause is the time that the collector runs without giving the event loop a
+ * chance to run, so this is what delays motor control.
+ */
+typedef struct {
+    /** Number of collections. */
+    uint32_t num_collections;
+    /** Longest collection, including time spent in the event loop. */
+    uint32_t collection_time_max_us;
+    /** Longest pause. */
+    uint32_t pause_time_max_us;
+    /** Most heap in use right after a collection, in bytes. */
+    uint32_t heap_used_max;
+    /**
+     * Number of collections by longest pause: under 250 us, 500 us, 1 ms,
+     * 2 ms, 5 ms, and longer.
+     */
+    uint32_t pause_histogram[PB_GC_STATS_NUM_BUCKETS];
+} pb_gc_stats_t;
+
+const pb_gc_stats_t *pb_gc_stats_get(void);
+
+void pb_gc_stats_reset(void);
+
+#endif // PYBRICKS_OPT_GC_STATS
+
+#if PYBRICKS_OPT_PROFILER
+
+void pb_profiler_start(uint32_t interval);
+
+void pb_profiler_stop(void);
+
+void pb_profiler_print(const mp_print_t *print);
+
+#endif // PYBRICKS_OPT_PROFILER
+
 extern const mp_obj_type_t pb_type_StopWatch;
 
 extern const mp_obj_type_t pb_type_app_data;
 
 extern const mp_obj_type_t pb_type_Task;
 
+extern const mp_obj_type_t pb_type_Ticker;
+
 #endif // PYBRICKS_PY_TOOLS
 
 #endif // PYBRICKS_INCLUDED_PYBRICKS_TOOLS_H
@@ -14,10 +14,16 @@
 #include "py/runtime.h"
 #include "py/stream.h"
 
+#include <pbdrv/bluetooth.h>
 #include <pbdrv/clock.h>
+#include <pbdrv/motor_driver.h>
 
 #include <pbio/int_math.h>
+#include <pbio/main.h>
+#include <pbio/motor_process.h>
+#include <pbio/os.h>
 #include <pbio/util.h>
+#include <pbsys/host.h>
 #include <pbsys/light.h>
 #include <pbsys/program_stop.h>
 #include <pbsys/status.h>
@@ -51,24 +57,65 @@ void pb_module_tools_assert_blocking(void) {
  * Statically allocated wait objects that can be re-used without allocation
  * once exhausted. Should be sufficient for trivial applications.
  *
- * More are allocated as needed. If a user has more than this many parallel
- * waits, the user can probably afford to allocate anyway.
+ * If a user has more than this many parallel waits, the rest come from the
+ * shared pool of awaitables, which only allocates when it has to grow.
  *
  * This is set to zero each time MicroPython starts.
  */
 static pb_type_async_t waits[6];
 
-static pbio_error_t pb_module_tools_wait_iter_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
-    // Not a protothread, but using the state variable to store final time.
-    return pbio_util_time_has_passed(pbdrv_clock_get_ms(), (uint32_t)*state) ? PBIO_SUCCESS: PBIO_ERROR_AGAIN;
+/**
+ * Time at which the most recently iterated wait ends, if wake_time_is_set.
+ */
+static uint32_t wake_time;
+static bool wake_time_is_set;
+
+/**
+ * Sets the time at which the task that is being iterated is worth running
+ * again. Tasks that don't set this run again on the next round.
+ *
+ * @param [in]  time    Clock time in ms.
+ */
+void pb_module_tools_set_wake_time(uint32_t time) {
+    wake_time = time;
+    wake_time_is_set = true;
 }
 
-static mp_obj_t pb_module_tools_wait(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
-        PB_ARG_REQUIRED(time));
+/**
+ * Clears the wake time before iterating a task.
+ */
+void pb_module_tools_clear_wake_time(void) {
+    wake_time_is_set = false;
+}
 
-    mp_int_t time = pb_obj_get_int(time_in);
+/**
+ * Gets the wake time set while iterating a task.
+ *
+ * @param [out] time    Clock time in ms.
+ * @returns             Whether a wake time was set.
+ */
+bool pb_module_tools_get_wake_time(uint32_t *time) {
+    *time = wake_time;
+    return wake_time_is_set;
+}
 
+static pbio_error_t pb_module_tools_wait_iter_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    // Not a protothread, but using the state variable to store final time.
+    if (pbio_util_time_has_passed(pbdrv_clock_get_ms(), (uint32_t)*state)) {
+        return PBIO_SUCCESS;
+    }
+    // Let the scheduler skip this task until then.
+    pb_module_tools_set_wake_time((uint32_t)*state);
+    return PBIO_ERROR_AGAIN;
+}
+
+/**
+ * Waits for the given time, or makes an awaitable that does so.
+ *
+ * @param [in]  time    Time in ms.
+ * @returns             None or awaitable.
+ */
+static mp_obj_t pb_module_tools_wait_ms(mp_int_t time) {
     // Outside run loop, do blocking wait to avoid async overhead.
     if (!pb_module_tools_run_loop_is_active()) {
         if (time > 0) {
@@ -78,8 +125,8 @@ static mp_obj_t pb_module_tools_wait(size_t n_args, const mp_obj_t *pos_args, mp
     }
 
     // Find statically allocated candidate that can be re-used again because
-    // it was never used or used and exhausted. If it stays at NULL then a new
-    // awaitable is allocated.
+    // it was never used or used and exhausted. If it stays at NULL then an
+    // awaitable from the shared pool is used.
     pb_type_async_t *reuse = NULL;
     for (uint32_t i = 0; i < MP_ARRAY_SIZE(waits); i++) {
         if (waits[i].parent_obj == MP_OBJ_NULL) {
@@ -97,10 +144,123 @@ static mp_obj_t pb_module_tools_wait(size_t n_args, const mp_obj_t *pos_args, mp
         .state = pbdrv_clock_get_ms() + (uint32_t)time,
     };
 
-    return pb_type_async_wait_or_await(&config, &reuse, false);
+    return pb_type_async_wait_or_await(&config, reuse ? &reuse : NULL, false);
+}
+
+static mp_obj_t pb_module_tools_wait(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_REQUIRED(time));
+
+    return pb_module_tools_wait_ms(pb_obj_get_int(time_in));
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_wait_obj, 0, pb_module_tools_wait);
 
+/**
+ * Gets the shared clock time, which hubs can sync with BLE.sync().
+ *
+ * @returns             The time in ms.
+ */
+static uint32_t pb_module_tools_get_sync_time(void) {
+    #if PYBRICKS_PY_COMMON_BLE
+    return pb_type_ble_get_sync_time();
+    #else
+    return pbdrv_clock_get_ms();
+    #endif
+}
+
+static mp_obj_t pb_module_tools_sync_time(void) {
+    return mp_obj_new_int_from_uint(pb_module_tools_get_sync_time());
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_sync_time_obj, pb_module_tools_sync_time);
+
+/**
+ * Waits until the shared clock reaches the given time, so that several hubs
+ * can start something together.
+ */
+static mp_obj_t pb_module_tools_wait_until(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_REQUIRED(time));
+
+    // The wait itself uses the local clock, which runs at nearly the same
+    // rate, so it is not affected by later updates of the estimate.
+    int32_t remaining = (uint32_t)mp_obj_get_int_truncated(time_in) - pb_module_tools_get_sync_time();
+    return pb_module_tools_wait_ms(remaining > 0 ? remaining : 0);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_wait_until_obj, 0, pb_module_tools_wait_until);
+
+/**
+ * Waits of wait_us() sleep through the event loop until less than this many
+ * microseconds remain. The rest is spent spinning on the clock, since sleeping
+ * only wakes up on the next 1 ms clock tick.
+ */
+#define WAIT_US_SPIN_THRESHOLD (1000)
+
+/**
+ * Gets the time until the end of a wait_us().
+ *
+ * @param [in]  end     Clock time in µs.
+ * @returns             Remaining time in µs, or 0 if already passed.
+ */
+static uint32_t pb_module_tools_wait_us_remaining(uint32_t end) {
+    uint32_t now = pbdrv_clock_get_us();
+    return pbio_util_time_has_passed(now, end) ? 0 : end - now;
+}
+
+/**
+ * Spins until the end of a wait_us(), still running the pbio processes.
+ *
+ * @param [in]  end     Clock time in µs.
+ */
+static void pb_module_tools_wait_us_spin(uint32_t end) {
+    while (pb_module_tools_wait_us_remaining(end)) {
+        pbio_os_run_processes_once();
+    }
+}
+
+static pbio_error_t pb_module_tools_wait_us_iter_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    // Not a protothread, but using the state variable to store final time.
+    uint32_t remaining = pb_module_tools_wait_us_remaining((uint32_t)*state);
+
+    // Let other tasks run while there is enough time left.
+    if (remaining > WAIT_US_SPIN_THRESHOLD) {
+        pb_module_tools_set_wake_time(pbdrv_clock_get_ms() + (remaining - WAIT_US_SPIN_THRESHOLD) / 1000);
+        return PBIO_ERROR_AGAIN;
+    }
+
+    // The short final part is spun here to get the exact time.
+    pb_module_tools_wait_us_spin((uint32_t)*state);
+    return PBIO_SUCCESS;
+}
+
+static mp_obj_t pb_module_tools_wait_us(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_REQUIRED(time));
+
+    mp_int_t time = pb_obj_get_int(time_in);
+    uint32_t end = pbdrv_clock_get_us() + (time > 0 ? (uint32_t)time : 0);
+
+    // Outside run loop, do blocking wait to avoid async overhead.
+    if (!pb_module_tools_run_loop_is_active()) {
+        while (pb_module_tools_wait_us_remaining(end) > WAIT_US_SPIN_THRESHOLD) {
+            mp_event_wait_indefinite();
+        }
+        pb_module_tools_wait_us_spin(end);
+        return mp_const_none;
+    }
+
+    pb_type_async_t config = {
+        // Not associated with any parent object.
+        .parent_obj = mp_const_none,
+        // Yield once for duration 0 to avoid blocking loops.
+        .iter_once = time <= 0 ? NULL : pb_module_tools_wait_us_iter_once,
+        // No protothread here; use it to encode end time.
+        .state = end,
+    };
+
+    return pb_type_async_wait_or_await(&config, NULL, false);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_wait_us_obj, 0, pb_module_tools_wait_us);
+
 /**
  * Reads one byte from stdin without blocking if a byte is available, and
  * optionally converts it to character representation.
@@ -155,6 +315,54 @@ static mp_obj_t pb_module_tools_read_input_byte(size_t n_args, const mp_obj_t *p
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_read_input_byte_obj, 0, pb_module_tools_read_input_byte);
 
+/**
+ * Reads as many bytes from stdin as are available and fit in the buffer,
+ * without blocking.
+ *
+ * @param [in]  buf     Writable buffer such as a bytearray.
+ *
+ * @returns The number of bytes read, which is 0 if no data was available.
+ */
+static mp_obj_t pb_module_tools_read_input_into(mp_obj_t buf_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+
+    uint32_t size = bufinfo.len;
+    if (size && pbsys_host_stdin_read(bufinfo.buf, &size) != PBIO_SUCCESS) {
+        size = 0;
+    }
+    return mp_obj_new_int_from_uint(size);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_module_tools_read_input_into_obj, pb_module_tools_read_input_into);
+
+static pbio_error_t pb_module_tools_read_input_line_iter_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    return pbsys_host_stdin_get_line_size() ? PBIO_SUCCESS : PBIO_ERROR_AGAIN;
+}
+
+static mp_obj_t pb_module_tools_read_input_line_return_map(mp_obj_t parent_obj) {
+    uint32_t size = pbsys_host_stdin_get_line_size();
+    vstr_t vstr;
+    vstr_init_len(&vstr, size);
+    pbsys_host_stdin_read((uint8_t *)vstr.buf, &size);
+    vstr.len = size;
+    return mp_obj_new_bytes_from_vstr(&vstr);
+}
+
+/**
+ * Waits until a complete line is available on stdin and reads it.
+ *
+ * @returns Awaitable that gives the line as bytes, including the newline.
+ */
+static mp_obj_t pb_module_tools_read_input_line(void) {
+    pb_type_async_t config = {
+        .parent_obj = mp_const_none,
+        .iter_once = pb_module_tools_read_input_line_iter_once,
+        .return_map = pb_module_tools_read_input_line_return_map,
+    };
+    return pb_type_async_wait_or_await(&config, NULL, false);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_read_input_line_obj, pb_module_tools_read_input_line);
+
 static mp_obj_t pb_module_tools_run_task(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
         PB_ARG_DEFAULT_NONE(task));
@@ -191,9 +399,288 @@ static mp_obj_t pb_module_tools_run_task(size_t n_args, const mp_obj_t *pos_args
 }
 static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_run_task_obj, 0, pb_module_tools_run_task);
 
+#if PBIO_CONFIG_MOTOR_PROCESS && PYBRICKS_OPT_EXTRA_LEVEL1
+
+/**
+ * Gets the timing statistics of the motor control loop.
+ *
+ * @param [in]  reset   Choose @c True to reset the statistics after reading.
+ *
+ * @returns Tuple of the minimum, mean, and maximum loop period in
+ *          microseconds, the number of missed deadlines, the longest
+ *          event loop stall that caused a missed deadline in microseconds,
+ *          the address of the process function that stalled, or 0 if it
+ *          was the user program, and the number of times the motors were
+ *          coasted because the loop did not run for too long.
+ */
+static mp_obj_t pb_module_tools_control_loop_stats(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_FALSE(reset));
+
+    pbio_motor_process_stats_t stats;
+    pbio_motor_process_get_stats(&stats);
+
+    if (mp_obj_is_true(reset_in)) {
+        pbio_motor_process_reset_stats();
+    }
+
+    mp_obj_t values[] = {
+        mp_obj_new_int_from_uint(stats.period_min_us),
+        mp_obj_new_int_from_uint(stats.period_mean_us),
+        mp_obj_new_int_from_uint(stats.period_max_us),
+        mp_obj_new_int_from_uint(stats.missed_deadlines),
+        mp_obj_new_int_from_uint(stats.stall_max_us),
+        mp_obj_new_int_from_uint(stats.stall_process ? (uintptr_t)stats.stall_process->func : 0),
+        mp_obj_new_int_from_uint(stats.starved),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_control_loop_stats_obj, 0, pb_module_tools_control_loop_stats);
+
+#endif // PBIO_CONFIG_MOTOR_PROCESS && PYBRICKS_OPT_EXTRA_LEVEL1
+
+#if PYBRICKS_OPT_EXTRA_LEVEL1
+
+/**
+ * Gets the startup statistics of the user program.
+ *
+ * @returns Tuple of the number of downloaded modules, the time to index them,
+ *          the time to initialize MicroPython, the number of downloaded
+ *          modules imported so far and the total time spent importing them.
+ *          Times are in microseconds.
+ */
+static mp_obj_t pb_module_tools_startup_stats(void) {
+    const pb_startup_stats_t *stats = pb_startup_stats_get();
+    mp_obj_t values[] = {
+        mp_obj_new_int_from_uint(stats->num_modules),
+        mp_obj_new_int_from_uint(stats->index_time_us),
+        mp_obj_new_int_from_uint(stats->init_time_us),
+        mp_obj_new_int_from_uint(stats->num_imports),
+        mp_obj_new_int_from_uint(stats->import_time_us),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_startup_stats_obj, pb_module_tools_startup_stats);
+
+/**
+ * Gets the times at which the hub completed each phase of booting.
+ *
+ * @returns Tuple of the times at which storage was loaded, drivers were
+ *          initialized, pbio was initialized, the system was initialized,
+ *          Bluetooth was ready and the first program started. Times are in
+ *          microseconds since the clock started, or None if not reached.
+ */
+static mp_obj_t pb_module_tools_boot_stats(void) {
+    mp_obj_t values[PBIO_MAIN_BOOT_PHASE_NUM];
+    for (size_t i = 0; i < PBIO_MAIN_BOOT_PHASE_NUM; i++) {
+        uint32_t time = pbio_main_get_boot_phase_time(i);
+        values[i] = time ? mp_obj_new_int_from_uint(time) : mp_const_none;
+    }
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_boot_stats_obj, pb_module_tools_boot_stats);
+
+/**
+ * Gets the rate at which events such as stdout and app data are sent to the
+ * host over Bluetooth.
+ *
+ * @returns Tuple of the bytes sent in the last second and the highest number
+ *          of bytes sent in one second since boot.
+ */
+static mp_obj_t pb_module_tools_ble_stats(void) {
+    uint32_t rate;
+    uint32_t rate_max;
+    pbdrv_bluetooth_get_tx_rate(&rate, &rate_max);
+    mp_obj_t values[] = {
+        mp_obj_new_int_from_uint(rate),
+        mp_obj_new_int_from_uint(rate_max),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_ble_stats_obj, pb_module_tools_ble_stats);
+
+#if PBDRV_CONFIG_MOTOR_DRIVER_NXT
+/**
+ * Gets the time from setting a new motor duty cycle until it was sent to the
+ * AVR coprocessor that drives the motors.
+ *
+ * @returns Tuple of the latency of the most recent change and the highest
+ *          latency since boot, in microseconds.
+ */
+static mp_obj_t pb_module_tools_motor_latency_stats(void) {
+    uint32_t latency;
+    uint32_t latency_max;
+    pbdrv_motor_driver_nxt_get_latency(&latency, &latency_max);
+    mp_obj_t values[] = {
+        mp_obj_new_int_from_uint(latency),
+        mp_obj_new_int_from_uint(latency_max),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_motor_latency_stats_obj, pb_module_tools_motor_latency_stats);
+#endif // PBDRV_CONFIG_MOTOR_DRIVER_NXT
+
+/**
+ * Chooses whether to keep imported modules when this program ends.
+ *
+ * If enabled, the next run of the same program skips reinitialization and
+ * reuses the imported modules. The main script still runs from the start.
+ * The state is discarded when a new program is downloaded.
+ *
+ * @param [in]  enable  Choose @c True to keep the state after this run.
+ */
+static mp_obj_t pb_module_tools_warm_restart(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_TRUE(enable));
+
+    pb_warm_restart_request(mp_obj_is_true(enable_in));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_warm_restart_obj, 0, pb_module_tools_warm_restart);
+
+#endif // PYBRICKS_OPT_EXTRA_LEVEL1
+
+#if PYBRICKS_OPT_GC_STATS
+
+/**
+ * Gets the garbage collection statistics of the user program.
+ *
+ * @param [in]  reset   Choose @c True to reset the statistics after reading.
+ *
+ * @returns Tuple of the number of collections, the longest collection and the
+ *          longest pause in microseconds, a tuple with the number of
+ *          collections by longest pause: under 250 us, 500 us, 1 ms, 2 ms,
+ *          5 ms, and longer, the most heap in use right after a
+ *          collection in bytes, and the most image heap in use in bytes.
+ */
+static mp_obj_t pb_module_tools_gc_stats(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_FALSE(reset));
+
+    const pb_gc_stats_t *stats = pb_gc_stats_get();
+
+    mp_obj_t histogram[PB_GC_STATS_NUM_BUCKETS];
+    for (size_t i = 0; i < PB_GC_STATS_NUM_BUCKETS; i++) {
+        histogram[i] = mp_obj_new_int_from_uint(stats->pause_histogram[i]);
+    }
+
+    mp_obj_t values[] = {
+        mp_obj_new_int_from_uint(stats->num_collections),
+        mp_obj_new_int_from_uint(stats->collection_time_max_us),
+        mp_obj_new_int_from_uint(stats->pause_time_max_us),
+        mp_obj_new_tuple(MP_ARRAY_SIZE(histogram), histogram),
+        mp_obj_new_int_from_uint(stats->heap_used_max),
+        #if PYBRICKS_PY_PARAMETERS_IMAGE
+        mp_obj_new_int_from_uint(pb_type_Image_get_heap_used_max()),
+        #else
+        MP_OBJ_NEW_SMALL_INT(0),
+        #endif
+    };
+
+    if (mp_obj_is_true(reset_in)) {
+        pb_gc_stats_reset();
+        #if PYBRICKS_PY_PARAMETERS_IMAGE
+        pb_type_Image_reset_heap_used_max();
+        #endif
+    }
+
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_gc_stats_obj, 0, pb_module_tools_gc_stats);
+
+#endif // PYBRICKS_OPT_GC_STATS
+
+#if PBIO_CONFIG_OS_PROFILE
+
+/**
+ * Gets the execution time statistics of the event loop.
+ *
+ * Processes are identified by the address of their thread function, which
+ * can be looked up in the firmware map file.
+ *
+ * @param [in]  reset   Choose @c True to reset the statistics after reading.
+ *
+ * @returns Tuple of the idle time in microseconds and a tuple with the thread
+ *          address, number of calls, total time and maximum time in
+ *          microseconds of each process.
+ */
+static mp_obj_t pb_module_tools_process_stats(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_FALSE(reset));
+
+    size_t num_processes = 0;
+    for (pbio_os_process_t *p = pbio_os_process_get_next(NULL); p; p = pbio_os_process_get_next(p)) {
+        num_processes++;
+    }
+
+    mp_obj_tuple_t *processes = MP_OBJ_TO_PTR(mp_obj_new_tuple(num_processes, NULL));
+    pbio_os_process_t *p = pbio_os_process_get_next(NULL);
+    for (size_t i = 0; i < num_processes; i++, p = pbio_os_process_get_next(p)) {
+        mp_obj_t values[] = {
+            mp_obj_new_int_from_uint((uintptr_t)p->func),
+            mp_obj_new_int_from_uint(p->stats.num_calls),
+            mp_obj_new_int_from_uint(p->stats.time_total_us),
+            mp_obj_new_int_from_uint(p->stats.time_max_us),
+        };
+        processes->items[i] = mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+    }
+
+    mp_obj_t result[] = {
+        mp_obj_new_int_from_uint(pbio_os_get_idle_time_us()),
+        MP_OBJ_FROM_PTR(processes),
+    };
+
+    if (mp_obj_is_true(reset_in)) {
+        pbio_os_reset_stats();
+    }
+
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(result), result);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_process_stats_obj, 0, pb_module_tools_process_stats);
+
+#endif // PBIO_CONFIG_OS_PROFILE
+
+#if PYBRICKS_OPT_PROFILER
+
+/**
+ * Starts sampling which functions the user program is running.
+ *
+ * @param [in]  interval    Time between samples in milliseconds.
+ */
+static mp_obj_t pb_module_tools_profile_start(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_INT(interval, 1));
+
+    mp_int_t interval = mp_obj_get_int(interval_in);
+    if (interval < 1) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    pb_profiler_start(interval);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(pb_module_tools_profile_start_obj, 0, pb_module_tools_profile_start);
+
+/**
+ * Stops sampling and prints the samples to stdout as folded stacks, which
+ * can be turned into a flame graph on the computer.
+ */
+static mp_obj_t pb_module_tools_profile_stop(void) {
+    pb_profiler_stop();
+    pb_profiler_print(&mp_plat_print);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_0(pb_module_tools_profile_stop_obj, pb_module_tools_profile_stop);
+
+#endif // PYBRICKS_OPT_PROFILER
+
 // Reset global awaitable state when user program starts.
 void pb_module_tools_init(void) {
+    #if PYBRICKS_OPT_PROFILER
+    pb_profiler_stop();
+    #endif
     memset(waits, 0, sizeof(waits));
+    pb_type_async_reset_pool();
+    wake_time_is_set = false;
     run_loop_is_active = false;
 }
 
@@ -298,7 +785,34 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR(pb_module_tools_hub_menu_obj, 2, pb_module_to
 static const mp_rom_map_elem_t tools_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),    MP_ROM_QSTR(MP_QSTR_tools)                    },
     { MP_ROM_QSTR(MP_QSTR_wait),        MP_ROM_PTR(&pb_module_tools_wait_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_wait_us),     MP_ROM_PTR(&pb_module_tools_wait_us_obj)      },
+    { MP_ROM_QSTR(MP_QSTR_wait_until),  MP_ROM_PTR(&pb_module_tools_wait_until_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_sync_time),   MP_ROM_PTR(&pb_module_tools_sync_time_obj)    },
+    #if PBIO_CONFIG_MOTOR_PROCESS && PYBRICKS_OPT_EXTRA_LEVEL1
+    { MP_ROM_QSTR(MP_QSTR_control_loop_stats), MP_ROM_PTR(&pb_module_tools_control_loop_stats_obj) },
+    #endif // PBIO_CONFIG_MOTOR_PROCESS && PYBRICKS_OPT_EXTRA_LEVEL1
+    #if PBIO_CONFIG_OS_PROFILE
+    { MP_ROM_QSTR(MP_QSTR_process_stats), MP_ROM_PTR(&pb_module_tools_process_stats_obj) },
+    #endif // PBIO_CONFIG_OS_PROFILE
+    #if PYBRICKS_OPT_GC_STATS
+    { MP_ROM_QSTR(MP_QSTR_gc_stats), MP_ROM_PTR(&pb_module_tools_gc_stats_obj) },
+    #endif // PYBRICKS_OPT_GC_STATS
+    #if PYBRICKS_OPT_PROFILER
+    { MP_ROM_QSTR(MP_QSTR_profile_start), MP_ROM_PTR(&pb_module_tools_profile_start_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profile_stop), MP_ROM_PTR(&pb_module_tools_profile_stop_obj) },
+    #endif // PYBRICKS_OPT_PROFILER
+    #if PYBRICKS_OPT_EXTRA_LEVEL1
+    { MP_ROM_QSTR(MP_QSTR_startup_stats), MP_ROM_PTR(&pb_module_tools_startup_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_boot_stats), MP_ROM_PTR(&pb_module_tools_boot_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ble_stats), MP_ROM_PTR(&pb_module_tools_ble_stats_obj) },
+    #if PBDRV_CONFIG_MOTOR_DRIVER_NXT
+    { MP_ROM_QSTR(MP_QSTR_motor_latency_stats), MP_ROM_PTR(&pb_module_tools_motor_latency_stats_obj) },
+    #endif // PBDRV_CONFIG_MOTOR_DRIVER_NXT
+    { MP_ROM_QSTR(MP_QSTR_warm_restart), MP_ROM_PTR(&pb_module_tools_warm_restart_obj) },
+    #endif // PYBRICKS_OPT_EXTRA_LEVEL1
     { MP_ROM_QSTR(MP_QSTR_read_input_byte), MP_ROM_PTR(&pb_module_tools_read_input_byte_obj) },
+    { MP_ROM_QSTR(MP_QSTR_read_input_into), MP_ROM_PTR(&pb_module_tools_read_input_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_read_input_line), MP_ROM_PTR(&pb_module_tools_read_input_line_obj) },
     #if PYBRICKS_PY_TOOLS_APP_DATA
     { MP_ROM_QSTR(MP_QSTR_AppData),  MP_ROM_PTR(&pb_type_app_data)               },
     #endif // PYBRICKS_PY_TOOLS_APP_DATA
@@ -307,10 +821,12 @@ static const mp_rom_map_elem_t tools_globals_table[] = {
     #endif // PYBRICKS_PY_TOOLS_HUB_MENU
     { MP_ROM_QSTR(MP_QSTR_run_task),    MP_ROM_PTR(&pb_module_tools_run_task_obj)     },
     { MP_ROM_QSTR(MP_QSTR_StopWatch),   MP_ROM_PTR(&pb_type_StopWatch)                },
+    { MP_ROM_QSTR(MP_QSTR_Ticker),      MP_ROM_PTR(&pb_type_Ticker)                   },
     { MP_ROM_QSTR(MP_QSTR_multitask),   MP_ROM_PTR(&pb_type_Task)                     },
     #if MICROPY_PY_BUILTINS_FLOAT
     { MP_ROM_QSTR(MP_QSTR_Matrix),      MP_ROM_PTR(&pb_type_Matrix)           },
     { MP_ROM_QSTR(MP_QSTR_vector),      MP_ROM_PTR(&pb_geometry_vector_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_matmul),      MP_ROM_PTR(&pb_type_matrix_matmul_obj) },
     { MP_ROM_QSTR(MP_QSTR_cross),       MP_ROM_PTR(&pb_type_matrix_cross_obj) },
     // backwards compatibility for pybricks.geometry.Axis
     { MP_ROM_QSTR(MP_QSTR_Axis),        MP_ROM_PTR(&pb_enum_type_Axis) },
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 The Pybricks Authors
+
+#include "py/mpconfig.h"
+
+#if PYBRICKS_PY_TOOLS && PYBRICKS_OPT_PROFILER
+
+#include <string.h>
+
+#include "py/bc.h"
+#include "py/mpprint.h"
+#include "py/objfun.h"
+#include "py/profile.h"
+#include "py/runtime.h"
+
+#include <pbdrv/clock.h>
+
+#include <pybricks/tools.h>
+
+/** Maximum number of different call stacks that are counted. */
+#define PB_PROFILER_NUM_STACKS (64)
+
+/** Maximum number of functions per call stack, starting at the innermost. */
+#define PB_PROFILER_MAX_DEPTH (8)
+
+/**
+ * Number of samples of one call stack.
+ */
+typedef struct {
+    /** Function names, starting at the innermost function. */
+    qstr_short_t names[PB_PROFILER_MAX_DEPTH];
+    /** Line in the innermost function. */
+    uint16_t line;
+    /** Number of functions in @p names. */
+    uint8_t depth;
+    /** Number of samples. */
+    uint32_t count;
+} pb_profiler_stack_t;
+
+static pb_profiler_stack_t stacks[PB_PROFILER_NUM_STACKS];
+static uint32_t num_stacks;
+static uint32_t num_dropped;
+static uint32_t interval_ms;
+static uint32_t last_sample_ms;
+
+/** Whether the profiler is running, checked on every VM loop hook. */
+bool pb_profiler_is_active;
+
+/**
+ * Starts sampling the user program.
+ *
+ * Previous samples are discarded.
+ *
+ * @param [in]  interval    Time between samples in milliseconds.
+ */
+void pb_profiler_start(uint32_t interval) {
+    num_stacks = 0;
+    num_dropped = 0;
+    interval_ms = interval;
+    last_sample_ms = pbdrv_clock_get_ms();
+    pb_profiler_is_active = true;
+}
+
+/**
+ * Stops sampling the user program. Samples are kept until the next start.
+ */
+void pb_profiler_stop(void) {
+    pb_profiler_is_active = false;
+}
+
+/**
+ * Records the call stack that is currently executing, if the sample interval
+ * has passed.
+ *
+ * This is called from the MicroPython VM loop hook, which also runs while the
+ * program waits, so time spent waiting counts for the waiting function.
+ */
+void pb_profiler_hook_loop(void) {
+    uint32_t now = pbdrv_clock_get_ms();
+    if (now - last_sample_ms < interval_ms) {
+        return;
+    }
+    last_sample_ms = now;
+
+    const mp_code_state_t *code_state = MP_STATE_THREAD(current_code_state);
+    if (!code_state) {
+        return;
+    }
+
+    // Collect the function names, starting at the innermost function. The
+    // line is where the innermost function last branched or made a call.
+    pb_profiler_stack_t sample = { 0 };
+    const mp_raw_code_t *rc = code_state->fun_bc->rc;
+    sample.line = mp_prof_bytecode_lineno(rc, code_state->ip - rc->prelude.opcodes);
+    for (; code_state && sample.depth < PB_PROFILER_MAX_DEPTH; code_state = code_state->prev_state) {
+        sample.names[sample.depth++] = mp_obj_fun_get_name(MP_OBJ_FROM_PTR(code_state->fun_bc));
+    }
+
+    // Count the sample for a known stack or add it as a new one.
+    for (uint32_t i = 0; i < num_stacks; i++) {
+        pb_profiler_stack_t *stack = &stacks[i];
+        if (stack->line == sample.line && stack->depth == sample.depth &&
+            !memcmp(stack->names, sample.names, sample.depth * sizeof(sample.names[0]))) {
+            stack->count++;
+            return;
+        }
+    }
+    if (num_stacks == PB_PROFILER_NUM_STACKS) {
+        num_dropped++;
+        return;
+    }
+    sample.count = 1;
+    stacks[num_stacks++] = sample;
+}
+
+/**
+ * Prints the samples in the folded stack format used by flame graph tools.
+ *
+ * Each line has the functions from outermost to innermost separated by
+ * semicolons, the line number in the innermost function, and the number of
+ * samples. Samples that did not fit in the buffer are counted as "[dropped]".
+ *
+ * @param [in]  print   Where to print to.
+ */
+void pb_profiler_print(const mp_print_t *print) {
+    for (uint32_t i = 0; i < num_stacks; i++) {
+        const pb_profiler_stack_t *stack = &stacks[i];
+        for (uint8_t d = stack->depth; d > 0; d--) {
+            mp_printf(print, d == stack->depth ? "%q" : ";%q", stack->names[d - 1]);
+        }
+        mp_printf(print, ":%u %u\n", stack->line, (unsigned)stack->count);
+    }
+    if (num_dropped) {
+        mp_printf(print, "[dropped] %u\n", (unsigned)num_dropped);
+    }
+}
+
+#endif // PYBRICKS_PY_TOOLS && PYBRICKS_OPT_PROFILER
@@ -23,8 +23,18 @@
 typedef struct _pb_type_app_data_obj_t {
     mp_obj_base_t base;
     pb_type_async_t *tx_iter;
+    pb_type_async_t *rx_iter;
     mp_obj_t rx_format;
+    // Bytes object of the most recent complete data. Its data points to one
+    // half of rx_buffer, while incoming data is written to the other half.
     mp_obj_str_t rx_bytes_obj;
+    uint8_t *rx_back;
+    // Whether rx_back is older than the data in rx_bytes_obj.
+    bool rx_back_stale;
+    // Number of times complete data was received, and the number at the
+    // time of the last call to wait_new.
+    uint32_t rx_count;
+    uint32_t rx_count_seen;
     uint8_t rx_buffer[] __attribute__((aligned(4)));
 } pb_type_app_data_obj_t;
 
@@ -36,7 +46,28 @@ static pbio_error_t handle_incoming_app_data(uint16_t offset, uint32_t size, con
     if (!app_data_instance || offset + size > app_data_instance->rx_bytes_obj.len) {
         return PBIO_ERROR_INVALID_ARG;
     }
-    memcpy(app_data_instance->rx_buffer + offset, data, size);
+
+    pb_type_app_data_obj_t *self = app_data_instance;
+    size_t len = self->rx_bytes_obj.len;
+
+    // Partial writes update only some values, so the others must be taken
+    // from the most recent data. Not needed if everything is overwritten.
+    if (self->rx_back_stale && (offset != 0 || size != len)) {
+        memcpy(self->rx_back, self->rx_bytes_obj.data, len);
+    }
+    self->rx_back_stale = false;
+
+    memcpy(self->rx_back + offset, data, size);
+
+    // Data is complete when the end of the buffer is written, so swap the
+    // buffers. The user reads the data while the next one is received.
+    if (offset + size == len) {
+        uint8_t *front = (uint8_t *)self->rx_bytes_obj.data;
+        self->rx_bytes_obj.data = self->rx_back;
+        self->rx_back = front;
+        self->rx_back_stale = true;
+        self->rx_count++;
+    }
     return PBIO_SUCCESS;
 }
 
@@ -54,14 +85,37 @@ static mp_obj_t pb_type_app_data_get_values(mp_obj_t self_in) {
     // Implementation in MicroPython is static, so import from ustruct.unpack.
     mp_obj_t ustruct_unpack = pb_function_import_helper(MP_QSTR_ustruct, MP_QSTR_unpack);
 
-    // Host (sender) is responsible for making sure that each individual
-    // value remains valid, i.e. is written in a single chunk, since the
-    // following may allocate, and thus be updated between unpacking values.
+    // Incoming data is written to the other buffer, so this is consistent
+    // unless two more complete updates arrive while unpacking.
     pb_type_app_data_obj_t *self = MP_OBJ_TO_PTR(self_in);
     return mp_call_function_2(ustruct_unpack, self->rx_format, MP_OBJ_FROM_PTR(&self->rx_bytes_obj));
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_app_data_get_values_obj, pb_type_app_data_get_values);
 
+static pbio_error_t app_data_wait_new_iterate_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    pb_type_app_data_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
+    return self->rx_count != self->rx_count_seen ? PBIO_SUCCESS : PBIO_ERROR_AGAIN;
+}
+
+static mp_obj_t app_data_wait_new_return_map(mp_obj_t parent_obj) {
+    pb_type_app_data_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
+    // More than one means that some data was replaced before it was seen.
+    uint32_t count = self->rx_count - self->rx_count_seen;
+    self->rx_count_seen = self->rx_count;
+    return mp_obj_new_int_from_uint(count);
+}
+
+static mp_obj_t pb_type_app_data_wait_new(mp_obj_t self_in) {
+    pb_type_async_t config = {
+        .parent_obj = self_in,
+        .iter_once = app_data_wait_new_iterate_once,
+        .return_map = app_data_wait_new_return_map,
+    };
+    pb_type_app_data_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return pb_type_async_wait_or_await(&config, &self->rx_iter, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_app_data_wait_new_obj, pb_type_app_data_wait_new);
+
 static pbio_error_t app_data_write_bytes_iterate_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
     // No need to pass in buffered arguments since they were copied on the
     // inital run. We can just keep calling this until completion.
@@ -111,14 +165,23 @@ static mp_obj_t pb_type_app_data_make_new(const mp_obj_type_t *type, size_t n_ar
         mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("host rx_buffer already allocated"));
     }
 
-    // Use finalizer so we can deactivate the data callback when rx_buffer is garbage collected.
-    app_data_instance = mp_obj_malloc_var_with_finaliser(pb_type_app_data_obj_t, uint8_t, size, type);
+    // Use finalizer so we can deactivate the data callback when rx_buffer is
+    // garbage collected. Allocate two buffers so that incoming data does not
+    // change the data that the user is reading.
+    size_t size_aligned = (size + 3) / 4 * 4;
+    app_data_instance = mp_obj_malloc_var_with_finaliser(pb_type_app_data_obj_t, uint8_t, size_aligned * 2, type);
+    memset(app_data_instance->rx_buffer, 0, size_aligned * 2);
     app_data_instance->rx_format = rx_format_in;
 
     // Keep rx_buffer in bytes object rx_format for compatibility with unpack.
     app_data_instance->rx_bytes_obj.base.type = &mp_type_bytes;
     app_data_instance->rx_bytes_obj.len = size;
     app_data_instance->rx_bytes_obj.data = app_data_instance->rx_buffer;
+    app_data_instance->rx_back = app_data_instance->rx_buffer + size_aligned;
+    app_data_instance->rx_back_stale = false;
+    app_data_instance->rx_count = 0;
+    app_data_instance->rx_count_seen = 0;
+    app_data_instance->rx_iter = NULL;
 
     // Activate callback now that we have allocated the rx_buffer.
     pbsys_command_set_write_app_data_callback(handle_incoming_app_data);
@@ -143,6 +206,7 @@ static const mp_rom_map_elem_t pb_type_app_data_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_get_bytes),    MP_ROM_PTR(&pb_type_app_data_get_bytes_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_values),   MP_ROM_PTR(&pb_type_app_data_get_values_obj) },
     { MP_ROM_QSTR(MP_QSTR_write_bytes),    MP_ROM_PTR(&pb_type_app_data_write_bytes_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait_new),     MP_ROM_PTR(&pb_type_app_data_wait_new_obj) },
 };
 static MP_DEFINE_CONST_DICT(pb_type_app_data_locals_dict, pb_type_app_data_locals_dict_table);
 
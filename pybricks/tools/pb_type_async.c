@@ -99,12 +99,58 @@ MP_DEFINE_CONST_OBJ_TYPE(pb_type_async,
     iter, pb_type_async_iternext,
     locals_dict, &pb_type_async_locals_dict);
 
+/**
+ * Maximum number of awaitables in the shared pool. Awaitables that are created
+ * but never awaited stay busy forever, so the pool must not grow without bound.
+ */
+#define PB_TYPE_ASYNC_POOL_SIZE_MAX (16)
+
+/** Number of awaitables in the shared pool. */
+static uint32_t pool_size;
+
+/**
+ * Resets the pool of awaitables without an owner. Must be called when
+ * MicroPython starts, before any awaitables are created.
+ */
+void pb_type_async_reset_pool(void) {
+    MP_STATE_VM(pb_type_async_pool) = NULL;
+    pool_size = 0;
+}
+
+/**
+ * Gets an exhausted awaitable from the pool of awaitables without an owner,
+ * or adds a newly allocated one to the pool if they are all busy.
+ *
+ * The pool grows to the largest number of such awaitables that were active at
+ * the same time. After that, operations that are awaited over and over again
+ * no longer allocate. Once the pool is full, awaitables are allocated without
+ * being added to it.
+ *
+ * @returns An awaitable that is free to be used.
+ */
+static pb_type_async_t *pb_type_async_get_from_pool(void) {
+    for (pb_type_async_t *iter = MP_STATE_VM(pb_type_async_pool); iter; iter = iter->pool_next) {
+        if (iter->parent_obj == MP_OBJ_NULL) {
+            return iter;
+        }
+    }
+    pb_type_async_t *iter = m_new_obj(pb_type_async_t);
+    iter->pool_next = NULL;
+    if (pool_size < PB_TYPE_ASYNC_POOL_SIZE_MAX) {
+        iter->pool_next = MP_STATE_VM(pb_type_async_pool);
+        MP_STATE_VM(pb_type_async_pool) = iter;
+        pool_size++;
+    }
+    return iter;
+}
+
 /**
  * Returns an awaitable operation if the runloop is active, or awaits the
  * operation here and now.
  *
  * @param  [in]       config     Configuration of the operation. NB: State will not be reset.
  * @param  [in, out]  prev       Candidate iterable object that might be re-used, otherwise assigned newly allocated object.
+ *                               If NULL, the awaitable is taken from the shared pool instead.
  * @param  [in]       stop_prev  Whether to stop ongoing awaitable if it is active.
  * @returns An awaitable if the runloop is active, otherwise the mapped return value.
  */
@@ -123,11 +169,23 @@ mp_obj_t pb_type_async_wait_or_await(pb_type_async_t *config, pb_type_async_t **
         // Re-use existing awaitable if exists and is free, otherwise allocate
         // another one. This allows many resources with one concurrent physical
         // operation like a motor to operate without re-allocation.
-        pb_type_async_t *iter = (prev && *prev && (*prev)->parent_obj == MP_OBJ_NULL) ?
-            *prev : (pb_type_async_t *)m_malloc(sizeof(pb_type_async_t));
+        // Operations without an owner use the shared pool instead. These are
+        // never attached to an owner, so the pool can hand them out again.
+        pb_type_async_t *iter;
+        if (!prev) {
+            iter = pb_type_async_get_from_pool();
+        } else if (*prev && (*prev)->parent_obj == MP_OBJ_NULL) {
+            iter = *prev;
+        } else {
+            iter = (pb_type_async_t *)m_malloc(sizeof(pb_type_async_t));
+            iter->pool_next = NULL;
+        }
 
-        // Copy the confuration to the object on heap so it lives on.
+        // Copy the confuration to the object on heap so it lives on, but keep
+        // its place in the pool.
+        pb_type_async_t *pool_next = iter->pool_next;
         *iter = *config;
+        iter->pool_next = pool_next;
 
         // Attaches newly defined awaitable (or no-op if reused) to the parent
         // object. The object that was here before is detached, so we no longer
@@ -201,3 +259,5 @@ mp_obj_t pb_type_async_return_result(mp_obj_t result_obj, pb_type_async_t **prev
     };
     return pb_type_async_wait_or_await(&config, prev, false);
 }
+
+MP_REGISTER_ROOT_POINTER(struct _pb_type_async_t *pb_type_async_pool);
@@ -41,7 +41,7 @@ typedef mp_obj_t (*pb_type_async_return_map_t)(mp_obj_t parent_obj);
 typedef pbio_error_t (*pb_type_async_iterate_once_t)(pbio_os_state_t *state, mp_obj_t parent_obj);
 
 /** Object representing the iterable that is returned by an awaitable operation. */
-typedef struct {
+typedef struct _pb_type_async_t {
     mp_obj_base_t base;
     /**
      * The object instance whose method made us. Usually a class instance whose
@@ -71,6 +71,11 @@ typedef struct {
      * State of the protothread used by the iterable.
      */
     pbio_os_state_t state;
+    /**
+     * Next awaitable in the pool of awaitables without an owner. Only used
+     * for awaitables allocated from the pool.
+     */
+    struct _pb_type_async_t *pool_next;
 } pb_type_async_t;
 
 mp_obj_t pb_type_async_wait_or_await(pb_type_async_t *config, pb_type_async_t **prev, bool stop_prev);
@@ -79,4 +84,6 @@ mp_obj_t pb_type_async_return_result(mp_obj_t result_obj, pb_type_async_t **prev
 
 void pb_type_async_schedule_stop_iteration(pb_type_async_t *iter);
 
+void pb_type_async_reset_pool(void);
+
 #endif // PYBRICKS_INCLUDED_ASYNC_H
@@ -8,6 +8,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <pbio/geometry.h>
+
 #include <pybricks/tools/pb_type_matrix.h>
 
 #include <pybricks/util_mp/pb_kwarg_helper.h>
@@ -74,10 +76,22 @@ static mp_obj_t pb_type_Matrix_make_new(const mp_obj_type_t *type, size_t n_args
     // Modifiers that allow basic modifications without moving data around
     self->scale = 1;
     self->transposed = false;
+    self->shared = false;
 
     return MP_OBJ_FROM_PTR(self);
 }
 
+// Gets the data index of the scalar at (r, c), allowing for transposed data.
+static inline size_t pb_type_Matrix_get_index(pb_type_Matrix_obj_t *self, size_t r, size_t c) {
+    return self->transposed ? c * self->m + r : r * self->n + c;
+}
+
+static void pb_type_Matrix_assert_matrix(mp_obj_t obj) {
+    if (!mp_obj_is_type(obj, &pb_type_Matrix)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("arguments must be Matrix objects"));
+    }
+}
+
 // Get string representation of the form -123.456
 static void print_float(char *buf, float x) {
 
@@ -198,6 +212,7 @@ static mp_obj_t pb_type_Matrix__add(mp_obj_t lhs_obj, mp_obj_t rhs_obj, bool add
     // Scale must be reset; it has been and multiplied out above
     ret->scale = 1;
     ret->transposed = false;
+    ret->shared = false;
 
     // Add the matrices by looping over rows and columns
     for (size_t r = 0; r < ret->m; r++) {
@@ -221,31 +236,73 @@ static mp_obj_t pb_type_Matrix__add(mp_obj_t lhs_obj, mp_obj_t rhs_obj, bool add
     return MP_OBJ_FROM_PTR(ret);
 }
 
-// pybricks.tools.Matrix._mul
-static mp_obj_t pb_type_Matrix__mul(mp_obj_t lhs_in, mp_obj_t rhs_in) {
+// pybricks.tools.Matrix._iadd
+static mp_obj_t pb_type_Matrix__iadd(mp_obj_t lhs_in, mp_obj_t rhs_in, bool add) {
 
     // Get left and right matrices
     pb_type_Matrix_obj_t *lhs = MP_OBJ_TO_PTR(lhs_in);
     pb_type_Matrix_obj_t *rhs = MP_OBJ_TO_PTR(rhs_in);
 
+    // Shared data can't be modified, so make a new matrix instead.
+    if (lhs->shared) {
+        return pb_type_Matrix__add(lhs_in, rhs_in, add);
+    }
+
     // Verify matching dimensions else raise error
-    if (lhs->n != rhs->m) {
+    if (lhs->n != rhs->n || lhs->m != rhs->m) {
         pb_assert(PBIO_ERROR_INVALID_ARG);
     }
 
-    // Result has as many rows as left hand side and as many columns as right hand side.
-    pb_type_Matrix_obj_t *ret = mp_obj_malloc(pb_type_Matrix_obj_t, &pb_type_Matrix);
-    ret->m = lhs->m;
-    ret->n = rhs->n;
-    ret->data = m_new(float, ret->m * ret->n);
+    // Each scalar is read just before it is written, so this also works if
+    // both sides are the same matrix. Data stays in the same order.
+    float rhs_scale = add ? rhs->scale : -rhs->scale;
+    for (size_t r = 0; r < lhs->m; r++) {
+        for (size_t c = 0; c < lhs->n; c++) {
+            size_t lhs_idx = pb_type_Matrix_get_index(lhs, r, c);
+            size_t rhs_idx = pb_type_Matrix_get_index(rhs, r, c);
+            lhs->data[lhs_idx] = lhs->data[lhs_idx] * lhs->scale + rhs->data[rhs_idx] * rhs_scale;
+        }
+    }
 
-    // Scale is commutative, so we can do it separately
-    ret->scale = lhs->scale * rhs->scale;
-    ret->transposed = false;
+    // Scale has been multiplied out above.
+    lhs->scale = 1;
+
+    return lhs_in;
+}
+
+/**
+ * Multiplies two matrices without applying their scale.
+ *
+ * @param [in]  lhs     The left hand side.
+ * @param [in]  rhs     The right hand side.
+ * @param [out] out     Row-major result of lhs->m by rhs->n scalars. Must not
+ *                      overlap with the data of @p lhs or @p rhs.
+ */
+static void pb_type_Matrix_multiply_data(pb_type_Matrix_obj_t *lhs, pb_type_Matrix_obj_t *rhs, float *out) {
+
+    // Use the unrolled versions for the 3x3 maps and 3x1 vectors that are
+    // common in robotics. Vectors have the same layout when transposed.
+    if (lhs->m == 3 && lhs->n == 3 && !lhs->transposed) {
+        if (rhs->m == 3 && rhs->n == 1) {
+            pbio_geometry_vector_map((pbio_geometry_matrix_3x3_t *)lhs->data, (pbio_geometry_xyz_t *)rhs->data, (pbio_geometry_xyz_t *)out);
+            return;
+        }
+        if (rhs->m == 3 && rhs->n == 3 && !rhs->transposed) {
+            pbio_geometry_matrix_multiply((pbio_geometry_matrix_3x3_t *)lhs->data, (pbio_geometry_matrix_3x3_t *)rhs->data, (pbio_geometry_matrix_3x3_t *)out);
+            return;
+        }
+    }
+
+    // A list of points as rows times a transposed 3x3 map, such as points *
+    // R.T, maps each point (row) by the map. This is done in one batch.
+    if (lhs->n == 3 && !lhs->transposed && rhs->m == 3 && rhs->n == 3 && rhs->transposed) {
+        pbio_geometry_vector_map_array((pbio_geometry_matrix_3x3_t *)rhs->data, (pbio_geometry_xyz_t *)lhs->data, (pbio_geometry_xyz_t *)out, lhs->m);
+        return;
+    }
 
     // Multiply the matrices by looping over rows and columns
-    for (size_t r = 0; r < ret->m; r++) {
-        for (size_t c = 0; c < ret->n; c++) {
+    for (size_t r = 0; r < lhs->m; r++) {
+        for (size_t c = 0; c < rhs->n; c++) {
             // This entry is obtained as the sum of the products of the entries
             // of the r'th row of lhs and the c'th column of rhs, so size lhs->n.
             float sum = 0;
@@ -256,9 +313,63 @@ static mp_obj_t pb_type_Matrix__mul(mp_obj_t lhs_in, mp_obj_t rhs_in) {
                 size_t rhs_idx = rhs->transposed ? c * rhs->m + k : k * rhs->n + c;
                 sum += lhs->data[lhs_idx] * rhs->data[rhs_idx];
             }
-            ret->data[ret->n * r + c] = sum;
+            out[rhs->n * r + c] = sum;
+        }
+    }
+}
+
+/**
+ * Multiplies two matrices into an existing matrix of matching size, which may
+ * be the same as one of the inputs.
+ */
+static void pb_type_Matrix_multiply_into(pb_type_Matrix_obj_t *lhs, pb_type_Matrix_obj_t *rhs, pb_type_Matrix_obj_t *out) {
+
+    size_t len = out->m * out->n;
+
+    // Results that overlap with the inputs go to a temporary buffer first.
+    // This is on the stack for the common small sizes.
+    float stack_buf[9];
+    bool overlaps = out->data == lhs->data || out->data == rhs->data;
+    float *result = !overlaps ? out->data : len <= MP_ARRAY_SIZE(stack_buf) ? stack_buf : m_new(float, len);
+
+    pb_type_Matrix_multiply_data(lhs, rhs, result);
+
+    // Scale is commutative, so we can do it separately
+    out->scale = lhs->scale * rhs->scale;
+    out->transposed = false;
+
+    if (overlaps) {
+        memcpy(out->data, result, len * sizeof(float));
+        if (result != stack_buf) {
+            m_del(float, result, len);
         }
     }
+}
+
+// pybricks.tools.Matrix._mul
+static mp_obj_t pb_type_Matrix__mul(mp_obj_t lhs_in, mp_obj_t rhs_in) {
+
+    // Get left and right matrices
+    pb_type_Matrix_obj_t *lhs = MP_OBJ_TO_PTR(lhs_in);
+    pb_type_Matrix_obj_t *rhs = MP_OBJ_TO_PTR(rhs_in);
+
+    // Verify matching dimensions else raise error
+    if (lhs->n != rhs->m) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Result has as many rows as left hand side and as many columns as right hand side.
+    pb_type_Matrix_obj_t *ret = mp_obj_malloc(pb_type_Matrix_obj_t, &pb_type_Matrix);
+    ret->m = lhs->m;
+    ret->n = rhs->n;
+    ret->data = m_new(float, ret->m * ret->n);
+
+    // Scale is commutative, so we can do it separately
+    ret->scale = lhs->scale * rhs->scale;
+    ret->transposed = false;
+    ret->shared = false;
+
+    pb_type_Matrix_multiply_data(lhs, rhs, ret->data);
 
     // If the result is a 1x1, return as scalar. This solves all the
     // usual matrix library problems where you have to type things like
@@ -271,6 +382,23 @@ static mp_obj_t pb_type_Matrix__mul(mp_obj_t lhs_in, mp_obj_t rhs_in) {
     return MP_OBJ_FROM_PTR(ret);
 }
 
+// pybricks.tools.Matrix._imul
+static mp_obj_t pb_type_Matrix__imul(mp_obj_t lhs_in, mp_obj_t rhs_in) {
+
+    // Get left and right matrices
+    pb_type_Matrix_obj_t *lhs = MP_OBJ_TO_PTR(lhs_in);
+    pb_type_Matrix_obj_t *rhs = MP_OBJ_TO_PTR(rhs_in);
+
+    // Can only be done in place if the result has the same shape and the
+    // data is not shared, otherwise make a new matrix.
+    if (lhs->shared || lhs->n != rhs->m || rhs->m != rhs->n) {
+        return pb_type_Matrix__mul(lhs_in, rhs_in);
+    }
+
+    pb_type_Matrix_multiply_into(lhs, rhs, lhs);
+    return lhs_in;
+}
+
 // pybricks.tools.Matrix._scale
 static mp_obj_t pb_type_Matrix__scale(mp_obj_t self_in, float scale) {
     pb_type_Matrix_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -283,10 +411,25 @@ static mp_obj_t pb_type_Matrix__scale(mp_obj_t self_in, float scale) {
     copy->m = self->m;
     copy->scale = self->scale * scale;
     copy->transposed = self->transposed;
+    copy->shared = self->shared = true;
 
     return MP_OBJ_FROM_PTR(copy);
 }
 
+// pybricks.tools.Matrix._iscale
+static mp_obj_t pb_type_Matrix__iscale(mp_obj_t self_in, float scale) {
+    pb_type_Matrix_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Shared data is not modified, but the scale of another matrix with the
+    // same data must not change either.
+    if (self->shared) {
+        return pb_type_Matrix__scale(self_in, scale);
+    }
+
+    self->scale *= scale;
+    return self_in;
+}
+
 // pybricks.tools.Matrix._get_scalar
 float pb_type_Matrix_get_scalar(mp_obj_t self_in, size_t r, size_t c) {
     pb_type_Matrix_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -311,6 +454,7 @@ static mp_obj_t pb_type_Matrix__T(mp_obj_t self_in) {
     copy->m = self->n;
     copy->scale = self->scale;
     copy->transposed = !self->transposed;
+    copy->shared = self->shared = true;
 
     return MP_OBJ_FROM_PTR(copy);
 }
@@ -376,26 +520,39 @@ static mp_obj_t pb_type_Matrix_binary_op(mp_binary_op_t op, mp_obj_t lhs_in, mp_
 
     switch (op) {
         case MP_BINARY_OP_ADD:
-        case MP_BINARY_OP_INPLACE_ADD:
             return pb_type_Matrix__add(lhs_in, rhs_in, true);
+        case MP_BINARY_OP_INPLACE_ADD:
+            pb_type_Matrix_assert_matrix(rhs_in);
+            return pb_type_Matrix__iadd(lhs_in, rhs_in, true);
         case MP_BINARY_OP_SUBTRACT:
-        case MP_BINARY_OP_INPLACE_SUBTRACT:
             return pb_type_Matrix__add(lhs_in, rhs_in, false);
+        case MP_BINARY_OP_INPLACE_SUBTRACT:
+            pb_type_Matrix_assert_matrix(rhs_in);
+            return pb_type_Matrix__iadd(lhs_in, rhs_in, false);
         case MP_BINARY_OP_MULTIPLY:
-        case MP_BINARY_OP_INPLACE_MULTIPLY:
+        case MP_BINARY_OP_MAT_MULTIPLY:
             // If right of operand is a number, just scale to be faster
             if (mp_obj_is_float(rhs_in) || mp_obj_is_int(rhs_in)) {
                 return pb_type_Matrix__scale(lhs_in, mp_obj_get_float_to_f(rhs_in));
             }
             // Otherwise we have to do full multiplication.
             return pb_type_Matrix__mul(lhs_in, rhs_in);
+        case MP_BINARY_OP_INPLACE_MULTIPLY:
+        case MP_BINARY_OP_INPLACE_MAT_MULTIPLY:
+            // Same as above, but modify the left hand side where possible.
+            if (mp_obj_is_float(rhs_in) || mp_obj_is_int(rhs_in)) {
+                return pb_type_Matrix__iscale(lhs_in, mp_obj_get_float_to_f(rhs_in));
+            }
+            pb_type_Matrix_assert_matrix(rhs_in);
+            return pb_type_Matrix__imul(lhs_in, rhs_in);
         case MP_BINARY_OP_REVERSE_MULTIPLY:
             // This gets called for c*A, so scale A by c (rhs/lhs is meaningless here)
             return pb_type_Matrix__scale(lhs_in, mp_obj_get_float_to_f(rhs_in));
         case MP_BINARY_OP_TRUE_DIVIDE:
-        case MP_BINARY_OP_INPLACE_TRUE_DIVIDE:
             // Scalar division by c is scalar multiplication by 1/c
             return pb_type_Matrix__scale(lhs_in, 1 / mp_obj_get_float_to_f(rhs_in));
+        case MP_BINARY_OP_INPLACE_TRUE_DIVIDE:
+            return pb_type_Matrix__iscale(lhs_in, 1 / mp_obj_get_float_to_f(rhs_in));
         default:
             // Other operations not supported
             return MP_OBJ_NULL;
@@ -607,4 +764,35 @@ static mp_obj_t pb_type_matrix_cross(mp_obj_t a_in, mp_obj_t b_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_2(pb_type_matrix_cross_obj, pb_type_matrix_cross);
 
+// pybricks.tools.matmul
+static mp_obj_t pb_type_matrix_matmul(size_t n_args, const mp_obj_t *args) {
+    pb_type_Matrix_assert_matrix(args[0]);
+    pb_type_Matrix_assert_matrix(args[1]);
+
+    // Without output argument, this is the same as a * b.
+    if (n_args < 3 || args[2] == mp_const_none) {
+        return pb_type_Matrix__mul(args[0], args[1]);
+    }
+    pb_type_Matrix_assert_matrix(args[2]);
+
+    pb_type_Matrix_obj_t *a = MP_OBJ_TO_PTR(args[0]);
+    pb_type_Matrix_obj_t *b = MP_OBJ_TO_PTR(args[1]);
+    pb_type_Matrix_obj_t *out = MP_OBJ_TO_PTR(args[2]);
+
+    // Verify matching dimensions else raise error
+    if (a->n != b->m || out->m != a->m || out->n != b->n) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Other matrices made from the output, such as with out.T, would no
+    // longer be valid, so don't allow this.
+    if (out->shared) {
+        mp_raise_ValueError(MP_ERROR_TEXT("out shares data with another Matrix"));
+    }
+
+    pb_type_Matrix_multiply_into(a, b, out);
+    return args[2];
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(pb_type_matrix_matmul_obj, 2, 3, pb_type_matrix_matmul);
+
 #endif // MICROPY_PY_BUILTINS_FLOAT
@@ -19,6 +19,8 @@ typedef struct _pb_type_Matrix_obj_t {
     size_t m;
     size_t n;
     bool transposed;
+    // Whether data is shared with another matrix, so it can't be modified.
+    bool shared;
 } pb_type_Matrix_obj_t;
 
 mp_obj_t pb_type_Matrix_make_vector(size_t m, float *data, bool normalize);
@@ -31,6 +33,8 @@ MP_DECLARE_CONST_FUN_OBJ_VAR_BETWEEN(pb_geometry_vector_obj);
 
 MP_DECLARE_CONST_FUN_OBJ_2(pb_type_matrix_cross_obj);
 
+MP_DECLARE_CONST_FUN_OBJ_VAR_BETWEEN(pb_type_matrix_matmul_obj);
+
 #endif // MICROPY_PY_BUILTINS_FLOAT
 
 #endif // PYBRICKS_INCLUDED_PYBRICKS_TOOLS_MATRIX_H
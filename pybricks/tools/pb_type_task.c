@@ -9,6 +9,10 @@
 #include "py/objmodule.h"
 #include "py/runtime.h"
 
+#include <pbdrv/clock.h>
+
+#include <pbio/util.h>
+
 #include <pybricks/parameters.h>
 #include <pybricks/common.h>
 #include <pybricks/tools.h>
@@ -25,6 +29,32 @@ typedef struct {
     mp_obj_iter_buf_t iter_buf;
     mp_obj_t iterable;
     bool done;
+    #if PYBRICKS_OPT_EXTRA_LEVEL1
+    /**
+     * Whether the task is waiting until wake_time. Only used with fair=True.
+     */
+    bool sleeping;
+    /**
+     * Whether the task still has to run in this round.
+     */
+    bool pending;
+    /**
+     * Clock time in ms at which the task is done waiting.
+     */
+    uint32_t wake_time;
+    /**
+     * Number of times the task was resumed.
+     */
+    uint32_t num_runs;
+    /**
+     * Total time spent running this task.
+     */
+    uint32_t run_time_us;
+    /**
+     * Longest delay between the end of a wait and resuming the task.
+     */
+    uint32_t latency_max_ms;
+    #endif
 } pb_type_Task_progress_t;
 
 typedef struct {
@@ -41,6 +71,17 @@ typedef struct {
      * The tasks managed by this all or race awaitable.
      */
     pb_type_Task_progress_t *tasks;
+    #if PYBRICKS_OPT_EXTRA_LEVEL1
+    /**
+     * Whether to skip sleeping tasks, resume tasks by deadline, and keep
+     * statistics for each task.
+     */
+    bool fair;
+    /**
+     * The task that goes first among tasks without deadline in the next round.
+     */
+    size_t first;
+    #endif
 } pb_type_Task_obj_t;
 
 // Cancel all tasks by calling their close methods.
@@ -65,49 +106,176 @@ static mp_obj_t pb_type_Task_close(mp_obj_t self_in) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Task_close_obj, pb_type_Task_close);
 
-static mp_obj_t pb_type_Task_iternext(mp_obj_t self_in) {
+/**
+ * Does one iteration of a task.
+ *
+ * @param [in]      self_in     The collection of tasks.
+ * @param [in]      task        The task to iterate.
+ * @param [in, out] done_total  Number of completed tasks, bumped if this one completes.
+ * @returns                     Whether enough tasks are done, so the round should end.
+ */
+static bool pb_type_Task_run_one(mp_obj_t self_in, pb_type_Task_progress_t *task, size_t *done_total) {
     pb_type_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
-    // Do one iteration of each task.
-    nlr_buf_t nlr;
-    if (nlr_push(&nlr) == 0) {
+    // Do one task iteration.
+    mp_obj_t result = mp_iternext(task->iterable);
 
-        size_t done_total = 0;
+    // Not done yet, try next time.
+    if (result == mp_const_none) {
+        return false;
+    }
 
-        for (size_t i = 0; i < self->num_tasks; i++) {
+    // Task is done, save return value.
+    if (result == MP_OBJ_STOP_ITERATION) {
+        if (MP_STATE_THREAD(stop_iteration_arg) != MP_OBJ_NULL) {
+            task->return_val = MP_STATE_THREAD(stop_iteration_arg);
+        }
+        task->done = true;
+        (*done_total)++;
+
+        // If enough tasks are done, don't finish this round. This way,
+        // in race(), there is only one winner.
+        if (*done_total >= self->num_tasks_required) {
+            // Cancel everything else.
+            pb_type_Task_close(self_in);
+            return true;
+        }
+    }
+    return false;
+}
 
-            pb_type_Task_progress_t *task = &self->tasks[i];
+#if PYBRICKS_OPT_EXTRA_LEVEL1
 
-            // This task already complete, skip.
-            if (task->done) {
-                done_total++;
+/**
+ * Does one round of all tasks that are not sleeping.
+ *
+ * Tasks whose wait has ended go first, earliest deadline first. The other
+ * tasks follow in turn, starting one further each round so that no task is
+ * always last.
+ *
+ * @param [in]  self_in     The collection of tasks.
+ * @returns                 Number of completed tasks.
+ */
+static size_t pb_type_Task_run_fair(mp_obj_t self_in) {
+    pb_type_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    uint32_t now = pbdrv_clock_get_ms();
+    size_t done_total = 0;
+
+    // Select the tasks that should run in this round.
+    for (size_t i = 0; i < self->num_tasks; i++) {
+        pb_type_Task_progress_t *task = &self->tasks[i];
+        task->pending = !task->done && (!task->sleeping || pbio_util_time_has_passed(now, task->wake_time));
+        if (task->done) {
+            done_total++;
+        }
+    }
+
+    for (;;) {
+        // Find the next task: the earliest expired deadline, or else the
+        // first one in turn.
+        pb_type_Task_progress_t *next = NULL;
+        for (size_t n = 0; n < self->num_tasks; n++) {
+            pb_type_Task_progress_t *task = &self->tasks[(self->first + n) % self->num_tasks];
+            if (!task->pending) {
                 continue;
             }
+            if (!next || (task->sleeping && (!next->sleeping || pbio_util_time_has_passed(next->wake_time, task->wake_time + 1)))) {
+                next = task;
+            }
+        }
 
-            // Do one task iteration.
-            mp_obj_t result = mp_iternext(task->iterable);
+        // All tasks had their turn.
+        if (!next) {
+            break;
+        }
+        next->pending = false;
 
-            // Not done yet, try next time.
-            if (result == mp_const_none) {
-                continue;
+        // Keep track of how late the task is resumed after waiting.
+        if (next->sleeping) {
+            uint32_t latency = pbdrv_clock_get_ms() - next->wake_time;
+            if (latency > next->latency_max_ms) {
+                next->latency_max_ms = latency;
             }
+        }
+
+        // Run the task. If it is still waiting after this, the wait sets the
+        // time at which it is worth running again.
+        pb_module_tools_clear_wake_time();
+        uint32_t start = pbdrv_clock_get_us();
+        bool finished = pb_type_Task_run_one(self_in, next, &done_total);
+        next->run_time_us += pbdrv_clock_get_us() - start;
+        next->num_runs++;
+        next->sleeping = pb_module_tools_get_wake_time(&next->wake_time);
+
+        if (finished) {
+            break;
+        }
+    }
+
+    if (++self->first >= self->num_tasks) {
+        self->first = 0;
+    }
+
+    // If all remaining tasks are sleeping, let the caller know when this
+    // collection is worth running again, so nested collections can sleep too.
+    pb_module_tools_clear_wake_time();
+    pb_type_Task_progress_t *earliest = NULL;
+    for (size_t i = 0; i < self->num_tasks; i++) {
+        pb_type_Task_progress_t *task = &self->tasks[i];
+        if (task->done) {
+            continue;
+        }
+        if (!task->sleeping) {
+            earliest = NULL;
+            break;
+        }
+        if (!earliest || pbio_util_time_has_passed(earliest->wake_time, task->wake_time)) {
+            earliest = task;
+        }
+    }
+    if (earliest && done_total < self->num_tasks_required) {
+        pb_module_tools_set_wake_time(earliest->wake_time);
+    }
+
+    return done_total;
+}
+
+#endif // PYBRICKS_OPT_EXTRA_LEVEL1
+
+static mp_obj_t pb_type_Task_iternext(mp_obj_t self_in) {
+    pb_type_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Do one iteration of each task.
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+
+        size_t done_total = 0;
+
+        #if PYBRICKS_OPT_EXTRA_LEVEL1
+        if (self->fair) {
+            done_total = pb_type_Task_run_fair(self_in);
+        } else
+        #endif
+        {
+            for (size_t i = 0; i < self->num_tasks; i++) {
+
+                pb_type_Task_progress_t *task = &self->tasks[i];
 
-            // Task is done, save return value.
-            if (result == MP_OBJ_STOP_ITERATION) {
-                if (MP_STATE_THREAD(stop_iteration_arg) != MP_OBJ_NULL) {
-                    task->return_val = MP_STATE_THREAD(stop_iteration_arg);
+                // This task already complete, skip.
+                if (task->done) {
+                    done_total++;
+                    continue;
                 }
-                task->done = true;
-                done_total++;
-
-                // If enough tasks are done, don't finish this round. This way,
-                // in race(), there is only one winner.
-                if (done_total >= self->num_tasks_required) {
-                    // Cancel everything else.
-                    pb_type_Task_close(self_in);
+
+                if (pb_type_Task_run_one(self_in, task, &done_total)) {
                     break;
                 }
             }
+
+            // Tasks may have left a wake time, but this collection does not
+            // sleep as a whole.
+            pb_module_tools_clear_wake_time();
         }
         // Successfully did one iteration of all tasks.
         nlr_pop();
@@ -130,20 +298,54 @@ static mp_obj_t pb_type_Task_iternext(mp_obj_t self_in) {
     }
 }
 
+#if PYBRICKS_OPT_EXTRA_LEVEL1
+
+/**
+ * Gets the statistics of each task. These are only kept with fair=True.
+ *
+ * @returns Tuple with a tuple for each task: the number of times it was
+ *          resumed, the total run time in microseconds, and the longest
+ *          delay in milliseconds between the end of a wait and resuming it.
+ */
+static mp_obj_t pb_type_Task_stats(mp_obj_t self_in) {
+    pb_type_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_tuple_t *result = MP_OBJ_TO_PTR(mp_obj_new_tuple(self->num_tasks, NULL));
+    for (size_t i = 0; i < self->num_tasks; i++) {
+        pb_type_Task_progress_t *task = &self->tasks[i];
+        mp_obj_t values[] = {
+            mp_obj_new_int_from_uint(task->num_runs),
+            mp_obj_new_int_from_uint(task->run_time_us),
+            mp_obj_new_int_from_uint(task->latency_max_ms),
+        };
+        result->items[i] = mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+    }
+    return MP_OBJ_FROM_PTR(result);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Task_stats_obj, pb_type_Task_stats);
+
+#endif // PYBRICKS_OPT_EXTRA_LEVEL1
+
 static const mp_rom_map_elem_t pb_type_Task_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&pb_type_Task_close_obj) },
+    #if PYBRICKS_OPT_EXTRA_LEVEL1
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&pb_type_Task_stats_obj) },
+    #endif
 };
 MP_DEFINE_CONST_DICT(pb_type_Task_locals_dict, pb_type_Task_locals_dict_table);
 
 static mp_obj_t pb_type_Task_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
 
+    mp_map_t kw_args;
+    mp_map_init_fixed_table(&kw_args, n_kw, args + n_args);
+
     // Whether to race until one task is done (True) or wait for all tasks (False).
-    bool race = n_kw == 1 && mp_obj_is_true(args[n_args + 1]);
+    mp_map_elem_t *race = mp_map_lookup(&kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_race), MP_MAP_LOOKUP);
 
     pb_type_Task_obj_t *self = mp_obj_malloc(pb_type_Task_obj_t, type);
     self->num_tasks = n_args;
-    self->num_tasks_required = race ? 1 : n_args;
-    self->tasks = m_new(pb_type_Task_progress_t, n_args);
+    self->num_tasks_required = race && mp_obj_is_true(race->value) ? 1 : n_args;
+    // Zeroed so that statistics start at zero.
+    self->tasks = m_new0(pb_type_Task_progress_t, n_args);
     for (size_t i = 0; i < n_args; i++) {
         pb_type_Task_progress_t *task = &self->tasks[i];
         task->arg = args[i];
@@ -151,6 +353,13 @@ static mp_obj_t pb_type_Task_new(const mp_obj_type_t *type, size_t n_args, size_
         task->iterable = mp_getiter(args[i], &task->iter_buf);
         task->done = false;
     }
+
+    #if PYBRICKS_OPT_EXTRA_LEVEL1
+    // Whether to skip sleeping tasks and resume tasks by deadline.
+    mp_map_elem_t *fair = mp_map_lookup(&kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_fair), MP_MAP_LOOKUP);
+    self->fair = fair && mp_obj_is_true(fair->value);
+    self->first = 0;
+    #endif
     return MP_OBJ_FROM_PTR(self);
 }
 
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 The Pybricks Authors
+
+#include "py/mpconfig.h"
+
+#if PYBRICKS_PY_TOOLS
+
+#include "py/mphal.h"
+#include "py/runtime.h"
+
+#include <pbio/util.h>
+
+#include <pybricks/tools.h>
+#include <pybricks/tools/pb_type_async.h>
+
+#include <pybricks/util_mp/pb_kwarg_helper.h>
+#include <pybricks/util_mp/pb_obj_helper.h>
+#include <pybricks/util_pb/pb_error.h>
+
+/**
+ * Periodic timer for loops that must run at a fixed rate.
+ *
+ * Each deadline is the previous deadline plus the period, not the time at
+ * which the wait started, so the time spent in the loop body does not add up
+ * over many iterations. This is the same as the motor process does with its
+ * timer.
+ */
+typedef struct _pb_type_Ticker_obj_t {
+    mp_obj_base_t base;
+    /** Period in ms. */
+    uint32_t period;
+    /** Clock time in ms at which the current wait ends. */
+    uint32_t deadline;
+    /** Number of deadlines missed by the most recent wait. */
+    uint32_t missed;
+    /** Number of deadlines missed since the ticker was started or reset. */
+    uint32_t overruns;
+    /** Awaitable that can be reused for the next wait. */
+    pb_type_async_t *iter;
+} pb_type_Ticker_obj_t;
+
+static pbio_error_t pb_type_Ticker_iter_once(pbio_os_state_t *state, mp_obj_t parent_obj) {
+    pb_type_Ticker_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
+
+    uint32_t now = mp_hal_ticks_ms();
+    if (!pbio_util_time_has_passed(now, self->deadline)) {
+        // Let the scheduler skip this task until then.
+        pb_module_tools_set_wake_time(self->deadline);
+        return PBIO_ERROR_AGAIN;
+    }
+
+    // If the loop body took longer than a period, skip to the next deadline
+    // in the future. This keeps the phase of the ticks instead of running
+    // late iterations back to back.
+    self->missed = (now - self->deadline) / self->period;
+    self->overruns += self->missed;
+    self->deadline += (self->missed + 1) * self->period;
+    return PBIO_SUCCESS;
+}
+
+static mp_obj_t pb_type_Ticker_return_map(mp_obj_t parent_obj) {
+    pb_type_Ticker_obj_t *self = MP_OBJ_TO_PTR(parent_obj);
+    return mp_obj_new_int_from_uint(self->missed);
+}
+
+static mp_obj_t pb_type_Ticker_wait(mp_obj_t self_in) {
+    pb_type_Ticker_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    pb_type_async_t config = {
+        .parent_obj = self_in,
+        .iter_once = pb_type_Ticker_iter_once,
+        .return_map = pb_type_Ticker_return_map,
+    };
+    return pb_type_async_wait_or_await(&config, &self->iter, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Ticker_wait_obj, pb_type_Ticker_wait);
+
+static mp_obj_t pb_type_Ticker_reset(mp_obj_t self_in) {
+    pb_type_Ticker_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    self->deadline = mp_hal_ticks_ms() + self->period;
+    self->missed = 0;
+    self->overruns = 0;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Ticker_reset_obj, pb_type_Ticker_reset);
+
+static mp_obj_t pb_type_Ticker_overruns(mp_obj_t self_in) {
+    pb_type_Ticker_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int_from_uint(self->overruns);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(pb_type_Ticker_overruns_obj, pb_type_Ticker_overruns);
+
+// Iterating blocks until each deadline, so this is only for blocking loops.
+static mp_obj_t pb_type_Ticker_iternext(mp_obj_t self_in) {
+    pb_module_tools_assert_blocking();
+    return pb_type_Ticker_wait(self_in);
+}
+
+static mp_obj_t pb_type_Ticker_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    PB_PARSE_ARGS_CLASS(n_args, n_kw, args,
+        PB_ARG_REQUIRED(period));
+
+    mp_int_t period = pb_obj_get_int(period_in);
+    if (period <= 0) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    pb_type_Ticker_obj_t *self = mp_obj_malloc(pb_type_Ticker_obj_t, type);
+    self->period = period;
+    self->iter = NULL;
+    pb_type_Ticker_reset(MP_OBJ_FROM_PTR(self));
+    return MP_OBJ_FROM_PTR(self);
+}
+
+static const mp_rom_map_elem_t pb_type_Ticker_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&pb_type_Ticker_wait_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&pb_type_Ticker_reset_obj) },
+    { MP_ROM_QSTR(MP_QSTR_overruns), MP_ROM_PTR(&pb_type_Ticker_overruns_obj) },
+};
+static MP_DEFINE_CONST_DICT(pb_type_Ticker_locals_dict, pb_type_Ticker_locals_dict_table);
+
+MP_DEFINE_CONST_OBJ_TYPE(pb_type_Ticker,
+    MP_QSTR_Ticker,
+    MP_TYPE_FLAG_ITER_IS_ITERNEXT,
+    make_new, pb_type_Ticker_make_new,
+    iter, pb_type_Ticker_iternext,
+    locals_dict, &pb_type_Ticker_locals_dict);
+
+#endif // PYBRICKS_PY_TOOLS
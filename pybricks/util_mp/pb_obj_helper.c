@@ -5,6 +5,7 @@
 #include <pbio/error.h>
 #include <pbio/int_math.h>
 
+#include "py/binary.h"
 #include "py/builtin.h"
 #include "py/mpconfig.h"
 #include "py/obj.h"
@@ -162,6 +163,29 @@ void pb_obj_get_pct_or_array(mp_obj_t obj_in, size_t num, int8_t *values) {
     }
 }
 
+/**
+ * Writes integer values into a writable buffer, such as array('i') or a
+ * memoryview of one. Values are converted to the type of the buffer items.
+ *
+ * This does not allocate, so it can be used in fast control loops.
+ *
+ * @param buf_in [in]  A MicroPython object that supports the buffer protocol
+ * @param num    [in]  The number of values to write
+ * @param values [in]  The values to write
+ *
+ * Raises exception if @p buf_in is not writable or has fewer than @p num items.
+ */
+void pb_obj_set_int_buffer(mp_obj_t buf_in, size_t num, const int32_t *values) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.len < num * mp_binary_get_size('@', bufinfo.typecode, NULL)) {
+        mp_raise_msg_varg(&mp_type_ValueError, MP_ERROR_TEXT("expected buffer of at least %d items"), num);
+    }
+    for (size_t i = 0; i < num; i++) {
+        mp_binary_set_val_array_from_int(bufinfo.typecode, bufinfo.buf, i, values[i]);
+    }
+}
+
 mp_obj_t pb_obj_get_base_class_obj(mp_obj_t obj, const mp_obj_type_t *type) {
 
     // If it equals the base type then return as is
@@ -38,6 +38,9 @@ bool pb_obj_is_array(mp_obj_t obj_in);
 // Get array of percentages from single value or tuple
 void pb_obj_get_pct_or_array(mp_obj_t obj_in, size_t num, int8_t *values);
 
+// Write integers into a writable buffer such as array('i'), without allocating
+void pb_obj_set_int_buffer(mp_obj_t buf_in, size_t num, const int32_t *values);
+
 // Get base instance if object is instance of subclass of type
 mp_obj_t pb_obj_get_base_class_obj(mp_obj_t obj, const mp_obj_type_t *type);
 
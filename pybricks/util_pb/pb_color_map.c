@@ -55,61 +55,82 @@ static const mp_rom_obj_tuple_t pb_color_map_default = {
     }
 };
 
-// Set initial default map
-void pb_color_map_save_default(mp_obj_t *color_map) {
-    *color_map = MP_OBJ_FROM_PTR(&pb_color_map_default);
-}
-
-// Get a discrete color that matches the given hsv values most closely
-mp_obj_t pb_color_map_get_color(mp_obj_t *color_map, pbio_color_hsv_t *hsv) {
+// Unpacks the colors into a table that can be matched without accessing the
+// color objects.
+static void pb_color_map_set(pb_color_map_t *color_map, mp_obj_t colors_in) {
 
-    // Unpack the main list
     mp_obj_t *colors;
     size_t n;
-    mp_obj_get_array(*color_map, &n, &colors);
-
-    // Initialize minimal cost to maximum
-    mp_obj_t match = mp_const_none;
-    int32_t cost_now = INT32_MAX;
-    int32_t cost_min = INT32_MAX;
+    mp_obj_get_array(colors_in, &n, &colors);
 
-    pbio_color_distance_func_t distance_func = pbio_color_get_distance_saturation_heuristic;
+    pb_color_map_entry_t *entries = m_new(pb_color_map_entry_t, n);
 
     // If user only provides fully saturated colors (hue, 100, 100) and/or fully
     // desaturated colors (0, 0, value), use a simplified heuristic matcher for
     // better default results that are distance independent. Otherwise use a
     // bicone color distance measure.
+    bool use_bicone = false;
     for (size_t i = 0; i < n; i++) {
-        const pbio_color_hsv_t *candidate = pb_type_Color_get_hsv(colors[i]);
+        entries[i].color = colors[i];
+        entries[i].hsv = *pb_type_Color_get_hsv(colors[i]);
+        pbio_color_hsv_to_bicone(&entries[i].hsv, &entries[i].bicone);
 
         // Use bicone mapping if custom (realistic) colors provided.
+        const pbio_color_hsv_t *candidate = &entries[i].hsv;
         bool idealized_grayscale = candidate->s == 0 && candidate->h == 0;
         bool idealized_color = candidate->s == 100 && candidate->v == 100;
         if (!idealized_grayscale && !idealized_color) {
-            distance_func = pbio_color_get_distance_bicone_squared;
-            break;
+            use_bicone = true;
         }
     }
 
+    color_map->colors = colors_in;
+    color_map->entries = entries;
+    color_map->num_entries = n;
+    color_map->use_bicone = use_bicone;
+}
+
+// Set initial default map
+void pb_color_map_save_default(pb_color_map_t *color_map) {
+    pb_color_map_set(color_map, MP_OBJ_FROM_PTR(&pb_color_map_default));
+}
+
+// Get a discrete color that matches the given hsv values most closely
+mp_obj_t pb_color_map_get_color(pb_color_map_t *color_map, pbio_color_hsv_t *hsv) {
+
+    // Initialize minimal cost to maximum
+    mp_obj_t match = mp_const_none;
+    int32_t cost_now = INT32_MAX;
+    int32_t cost_min = INT32_MAX;
+
+    // The measurement is mapped into the bicone only once.
+    pbio_color_bicone_t bicone;
+    if (color_map->use_bicone) {
+        pbio_color_hsv_to_bicone(hsv, &bicone);
+    }
+
     // Compute cost for each candidate
-    for (size_t i = 0; i < n; i++) {
+    for (size_t i = 0; i < color_map->num_entries; i++) {
+        const pb_color_map_entry_t *entry = &color_map->entries[i];
 
         // Evaluate the cost function
-        cost_now = distance_func(hsv, pb_type_Color_get_hsv(colors[i]));
+        cost_now = color_map->use_bicone ?
+            pbio_color_bicone_get_distance_squared(&bicone, &entry->bicone) :
+            pbio_color_get_distance_saturation_heuristic(hsv, &entry->hsv);
 
         // If cost is less than before, update the minimum and the match
         if (cost_now < cost_min) {
             cost_min = cost_now;
-            match = colors[i];
+            match = entry->color;
         }
     }
     return match;
 }
 
-mp_obj_t pb_color_map_detectable_colors_method(mp_obj_t *self_color_map, mp_obj_t colors_in) {
+mp_obj_t pb_color_map_detectable_colors_method(pb_color_map_t *self_color_map, mp_obj_t colors_in) {
     // If no arguments are given, return current map
     if (colors_in == mp_const_none) {
-        return *self_color_map;
+        return self_color_map->colors;
     }
 
     // If arguments given, ensure all tuple elements have the right type
@@ -121,7 +142,7 @@ mp_obj_t pb_color_map_detectable_colors_method(mp_obj_t *self_color_map, mp_obj_
     }
 
     // Save the given map
-    *self_color_map = colors_in;
+    pb_color_map_set(self_color_map, colors_in);
     return mp_const_none;
 }
 
@@ -8,12 +8,38 @@
 
 #include "py/obj.h"
 
+/**
+ * Detectable colors entry, with the color data unpacked for fast matching.
+ */
+typedef struct _pb_color_map_entry_t {
+    /** The Color object returned when this entry matches. */
+    mp_obj_t color;
+    /** The HSV value of the color. */
+    pbio_color_hsv_t hsv;
+    /** The color in the bicone, if the bicone distance is used. */
+    pbio_color_bicone_t bicone;
+} pb_color_map_entry_t;
+
+/**
+ * Detectable colors of a color sensor.
+ */
+typedef struct _pb_color_map_t {
+    /** The detectable colors as given by the user. */
+    mp_obj_t colors;
+    /** The unpacked colors. */
+    pb_color_map_entry_t *entries;
+    /** The number of entries. */
+    size_t num_entries;
+    /** Whether the bicone distance is used instead of the heuristic. */
+    bool use_bicone;
+} pb_color_map_t;
+
 void pb_color_map_rgb_to_hsv(const pbio_color_rgb_t *rgb, pbio_color_hsv_t *hsv);
 
-void pb_color_map_save_default(mp_obj_t *color_map);
+void pb_color_map_save_default(pb_color_map_t *color_map);
 
-mp_obj_t pb_color_map_get_color(mp_obj_t *color_map, pbio_color_hsv_t *hsv);
+mp_obj_t pb_color_map_get_color(pb_color_map_t *color_map, pbio_color_hsv_t *hsv);
 
-mp_obj_t pb_color_map_detectable_colors_method(mp_obj_t *self_color_map, mp_obj_t colors_in);
+mp_obj_t pb_color_map_detectable_colors_method(pb_color_map_t *self_color_map, mp_obj_t colors_in);
 
 #endif // _PBHSV_H_
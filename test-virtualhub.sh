@@ -4,6 +4,9 @@
 #
 # Use `--list-test` to list tests or `--include <regex>` to run single tests.
 #
+# Set BUDGET=1 to also measure the resource use of each test and check it
+# against the `.py.budget` file next to it, if any.
+#
 
 set -e
 
@@ -33,6 +36,10 @@ cd "$MP_TEST_DIR"
 ./run-tests.py --test-dirs $(find "$PB_TEST_DIR/virtualhub" -type d -and ! -wholename "*/build/*"  -and ! -wholename "*/run_test.py") "$@" || \
     (code=$?; ./run-tests.py --print-failures; exit $code)
 
+if [[ $BUDGET ]]; then
+    "$SCRIPT_DIR/tools/virtualhub_budget.py" --output "$BUILD_DIR/budget.json"
+fi
+
 if [[ $COVERAGE ]]; then
     lcov --capture --output-file "$BUILD_DIR/lcov.info" \
             --directory "$BUILD_DIR" \
@@ -6,6 +6,11 @@ from pybricks.tools import StopWatch
 from pybricks.parameters import Port
 from pybricks import version
 
+try:
+    from pybricks.tools import gc_stats
+except ImportError:
+    gc_stats = None
+
 from umath import sin, pi
 
 print(version)
@@ -28,6 +33,11 @@ while watch.time() < DURATION:
 # Stop the motor.
 motor.stop()
 
+# Show how long the garbage collector blocked the control loop.
+if gc_stats:
+    print("Collections, longest collection, longest pause:", gc_stats()[:3])
+    print("Collections by longest pause:", gc_stats()[3])
+
 # Transfer data logs.
 print("Transferring data...")
 motor.log.save("servo.txt")
@@ -1,5 +1,5 @@
 """
-Hardware Module: Technic Hub, Prime Hub, or Inventor Hub.
+Hardware Module: Technic Hub, Prime Hub, Inventor Hub, or EV3 Brick.
 
 Description: MicroPython performance benchmark for LEGO Powered Up hubs.
 
@@ -15,6 +15,9 @@ Adapted by the Pybricks Authors for LEGO Powered Up compatibility:
     - Cross platform clock definition for comparison with other firmwares.
     - Dropped command-line options, with LOOPS just hardcoded.
 
+Compare the pystones/second of two firmware builds to measure the effect of
+changes to the interpreter, compiler options or cache settings.
+
 """
 
 LOOPS = 50000
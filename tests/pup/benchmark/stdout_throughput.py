@@ -0,0 +1,32 @@
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2026 The Pybricks Authors
+
+"""
+Hardware Module: Any hub.
+
+Description: Measures how fast printed output reaches the host. Run it over
+USB and over Bluetooth to compare. Print blocks once the output buffer is full,
+so after the first few kilobytes, this measures the transport, not the buffer.
+"""
+
+from pybricks.tools import StopWatch
+from pybricks import version
+
+# Printing a line adds a newline, so this is 64 bytes per line.
+LINE = "0123456789ABCDEF" * 4
+LINE = LINE[: len(LINE) - 1]
+TOTAL_BYTES = 256 * 1024
+
+print(version)
+
+# Fill the output buffer first so that it does not affect the result.
+for i in range(64):
+    print(LINE)
+
+watch = StopWatch()
+for i in range(TOTAL_BYTES // (len(LINE) + 1)):
+    print(LINE)
+time = watch.time()
+
+print("Sent", TOTAL_BYTES, "bytes in", time, "ms")
+print("Throughput:", TOTAL_BYTES / time, "kB/s,", TOTAL_BYTES / time / 1000, "MB/s")
@@ -0,0 +1,36 @@
+from pybricks.tools import Matrix, vector, matmul
+
+A = Matrix([[1, 2, 3], [4, 5, 6], [7, 8, 10]])
+x = vector(1, 0, -1)
+
+# In-place operations keep the same object.
+y = vector(1, 2, 3)
+y_id = id(y)
+y += x
+y *= 2
+y -= x
+print(id(y) == y_id, list(y))
+
+# Square matrix products can be done in place too.
+B = Matrix([[1, 0, 0], [0, 2, 0], [0, 0, 3]])
+B_id = id(B)
+B @= A
+print(id(B) == B_id, B[2, 2])
+
+# Matrices that share data with others are not modified in place.
+C = Matrix([[1, 2], [3, 4]])
+C_T = C.T
+C += C
+print(C_T[0, 1], list(C))
+
+# Write products into existing matrices, including one of the inputs.
+out = vector(0, 0, 0)
+print(matmul(A, x, out) is out, list(out))
+matmul(A, out, out)
+print(list(out), list(A * (A * x)))
+
+# Results must match the shape of the output.
+try:
+    matmul(A, x, Matrix([[0, 0, 0]]))
+except ValueError:
+    print("ValueError")
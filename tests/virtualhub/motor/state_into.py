@@ -0,0 +1,39 @@
+from pybricks.pupdevices import Motor
+from pybricks.parameters import Port, Direction
+from pybricks.robotics import DriveBase
+from pybricks.tools import wait
+from array import array
+
+left_motor = Motor(Port.A, Direction.COUNTERCLOCKWISE)
+right_motor = Motor(Port.B)
+drive_base = DriveBase(left_motor, right_motor, wheel_diameter=56, axle_track=112)
+
+# Motor state is angle, speed and load, as with the individual methods.
+motor_state = array("i", [0, 0, 0])
+right_motor.run_angle(500, 90)
+wait(500)
+right_motor.state_into(motor_state)
+print(motor_state[0] == right_motor.angle(), motor_state[1] == right_motor.speed())
+
+# Drive base state is the same as state().
+drive_base_state = array("i", [0, 0, 0, 0])
+drive_base.straight(100)
+wait(500)
+drive_base.state_into(drive_base_state)
+print(tuple(drive_base_state) == drive_base.state())
+
+# Writing into a memoryview works too.
+drive_base.state_into(memoryview(drive_base_state))
+print(tuple(drive_base_state) == drive_base.state())
+
+# Buffers that are too small are rejected.
+try:
+    drive_base.state_into(array("i", [0, 0, 0]))
+except ValueError:
+    print("ValueError")
+
+# Read-only buffers are rejected.
+try:
+    right_motor.state_into(b"\x00" * 12)
+except TypeError:
+    print("TypeError")
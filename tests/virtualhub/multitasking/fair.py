@@ -0,0 +1,37 @@
+from pybricks.tools import multitask, run_task, wait, StopWatch
+
+watch = StopWatch()
+DELAY = 100
+
+
+async def busy():
+    while True:
+        await wait(0)
+
+
+async def sleeper(n):
+    await wait(DELAY * n)
+    return watch.time()
+
+
+async def main():
+    # Same results as without fair scheduling.
+    watch.reset()
+    print(await multitask(sleeper(1), sleeper(2), fair=True))
+
+    # The sleeping task only runs when it starts waiting and when it is done.
+    watch.reset()
+    tasks = multitask(busy(), sleeper(1), race=True, fair=True)
+    result = await tasks
+    runs, run_time, latency = tasks.stats()[1]
+    print(result[1], runs, latency < 10)
+    print(tasks.stats()[0][0] > runs)
+
+    # A nested collection of sleeping tasks sleeps as a whole.
+    watch.reset()
+    tasks = multitask(multitask(sleeper(1), sleeper(2), fair=True), busy(), race=True, fair=True)
+    result = await tasks
+    print(result[0], tasks.stats()[0][0])
+
+
+run_task(main())
@@ -0,0 +1,39 @@
+from pybricks.tools import multitask, run_task, wait, Ticker, StopWatch
+
+watch = StopWatch()
+PERIOD = 10
+
+# Time spent in the loop body does not add up.
+ticker = Ticker(PERIOD)
+watch.reset()
+for i in range(5):
+    wait(3)
+    assert ticker.wait() == 0
+assert watch.time() == PERIOD * 5
+
+# Iterating gives the number of missed deadlines.
+ticker.reset()
+for missed in ticker:
+    wait(PERIOD * 2 + 5)
+    break
+assert next(ticker) == 1
+assert ticker.overruns() == 1
+
+
+async def main1():
+    ticker = Ticker(PERIOD)
+    for i in range(3):
+        await ticker.wait()
+    print("completed main1")
+
+
+async def main2():
+    ticker = Ticker(PERIOD * 2)
+    for i in range(3):
+        await ticker.wait()
+    print("completed main2")
+
+
+watch.reset()
+run_task(multitask(main1(), main2()))
+assert watch.time() == PERIOD * 6
@@ -0,0 +1,27 @@
+from pybricks.tools import multitask, run_task, wait, StopWatch
+
+watch = StopWatch()
+DELAY = 100
+
+
+async def waiter(n):
+    await wait(DELAY * n)
+    return n
+
+
+async def main():
+    # More parallel waits than there are statically allocated ones, repeated
+    # so that awaitables from the pool are re-used.
+    for i in range(3):
+        watch.reset()
+        result = await multitask(*[waiter(n) for n in range(1, 11)])
+        print(result, watch.time() == DELAY * 10)
+
+    # A race cancels the other waits, which frees them for the next round.
+    for i in range(3):
+        watch.reset()
+        result = await multitask(*[waiter(n) for n in range(1, 11)], race=True)
+        print(result[0], result[1], watch.time() == DELAY)
+
+
+run_task(main())
@@ -0,0 +1,33 @@
+from pybricks.tools import multitask, run_task, wait_us, StopWatch
+
+watch = StopWatch()
+DELAY = 2500
+
+# Should block, sleeping most of the time and spinning for the rest.
+watch.reset()
+wait_us(DELAY)
+assert watch.time() >= DELAY // 1000
+
+# Zero and negative times return right away.
+watch.reset()
+wait_us(0)
+wait_us(-10)
+assert watch.time() == 0
+
+
+async def main1():
+    print("started main1")
+    await wait_us(DELAY)
+    print("completed main1")
+
+
+async def main2():
+    print("started main2")
+    await wait_us(DELAY * 2)
+    print("completed main2")
+
+
+# Waits run side by side.
+watch.reset()
+run_task(multitask(main1(), main2()))
+assert DELAY * 2 // 1000 <= watch.time() < DELAY * 3 // 1000
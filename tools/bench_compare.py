@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+
+"""Compare pbio benchmark results against a saved baseline.
+
+Both files contain one JSON object per line, as printed by ``bench-pbio.sh``.
+Times are compared by their median time per call, and sizes by their number
+of bytes. Exits with an error if any result got worse by more than the given
+threshold.
+"""
+
+import argparse
+import json
+import pathlib
+import sys
+
+
+def read_results(path: pathlib.Path) -> dict[str, dict]:
+    """Reads benchmark results, indexed by name."""
+    results = {}
+    for line in path.read_text().splitlines():
+        if line.startswith("{"):
+            result = json.loads(line)
+            results[result["name"]] = result
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline", type=pathlib.Path, help="baseline results")
+    parser.add_argument("results", type=pathlib.Path, help="new results")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=10,
+        help="allowed increase in percent (default: %(default)s)",
+    )
+    args = parser.parse_args()
+
+    baseline = read_results(args.baseline)
+    results = read_results(args.results)
+    worse = []
+
+    for name, result in results.items():
+        key = "ns_per_call" if "ns_per_call" in result else "bytes"
+        if name not in baseline or key not in baseline[name]:
+            print(f"{name:40} {result[key]:>12} (new)")
+            continue
+
+        old = baseline[name][key]
+        new = result[key]
+        change = (new - old) / old * 100 if old else 0
+        print(f"{name:40} {old:>12} -> {new:>12} {change:+7.1f}%")
+        if change > args.threshold:
+            worse.append(name)
+
+    if worse:
+        print(f"\nWorse by more than {args.threshold}%:", *worse, sep="\n")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+
+"""Measure the latency and throughput of the connection to a hub.
+
+Uses the echo command of the Pybricks protocol, so the hub sends data straight
+back without running a program. Three paths can be measured:
+
+- ``command``: echo command to echo event.
+- ``stdin``: stdin to stdout.
+- ``app-data``: app data to app data event.
+
+For each path, this sends one packet at a time to get round-trip time
+percentiles, and then keeps several packets in flight to get sustained
+throughput. Requires ``bleak`` for Bluetooth and ``pyusb`` for USB.
+"""
+
+import argparse
+import asyncio
+import statistics
+import struct
+import threading
+import time
+
+COMMAND_WRITE_STDIN = 6
+COMMAND_WRITE_APP_DATA = 7
+COMMAND_ECHO = 15
+
+EVENT_WRITE_STDOUT = 1
+EVENT_WRITE_APP_DATA = 2
+EVENT_ECHO = 8
+
+ECHO_FLAG_STDIN = 1 << 0
+ECHO_FLAG_APP_DATA = 1 << 1
+
+ERROR_BUSY = 0x81
+
+PYBRICKS_COMMAND_EVENT_UUID = "c5f50002-8280-46da-89f4-6d8051e4aeef"
+PYBRICKS_SERVICE_UUID = "c5f50001-8280-46da-89f4-6d8051e4aeef"
+
+USB_VID = 0x0694
+USB_OUT_MSG_SUBSCRIBE = 1
+USB_OUT_MSG_COMMAND = 2
+USB_IN_MSG_RESPONSE = 1
+USB_IN_MSG_EVENT = 2
+
+# Path name: (echo flags, command header, event that comes back).
+PATHS = {
+    "command": (0, bytes([COMMAND_ECHO, 0]), EVENT_ECHO),
+    "stdin": (ECHO_FLAG_STDIN, bytes([COMMAND_WRITE_STDIN]), EVENT_WRITE_STDOUT),
+    "app-data": (
+        ECHO_FLAG_APP_DATA,
+        bytes([COMMAND_WRITE_APP_DATA, 0, 0]),
+        EVENT_WRITE_APP_DATA,
+    ),
+}
+
+
+class BusyError(Exception):
+    """The hub has no room for the packet yet."""
+
+
+class BleTransport:
+    """Pybricks protocol over Bluetooth Low Energy."""
+
+    name = "ble"
+
+    async def connect(self, device_name, on_event):
+        from bleak import BleakClient, BleakScanner
+
+        device = await BleakScanner.find_device_by_filter(
+            lambda d, ad: PYBRICKS_SERVICE_UUID in ad.service_uuids
+            and (device_name is None or d.name == device_name)
+        )
+        if device is None:
+            raise RuntimeError("hub not found")
+        self.client = BleakClient(device)
+        await self.client.connect()
+        await self.client.start_notify(
+            PYBRICKS_COMMAND_EVENT_UUID, lambda _, data: on_event(bytes(data))
+        )
+        # Commands and events must fit in one write or notification.
+        self.max_size = self.client.mtu_size - 3
+
+    async def write(self, data):
+        try:
+            await self.client.write_gatt_char(
+                PYBRICKS_COMMAND_EVENT_UUID, data, response=True
+            )
+        except Exception as e:
+            if "0x81" in str(e).lower() or "busy" in str(e).lower():
+                raise BusyError from e
+            raise
+
+    async def disconnect(self):
+        await self.client.disconnect()
+
+
+class UsbTransport:
+    """Pybricks protocol over USB."""
+
+    name = "usb"
+
+    async def connect(self, device_name, on_event):
+        import usb.core
+
+        self.dev = usb.core.find(idVendor=USB_VID, bDeviceClass=0xFF)
+        if self.dev is None:
+            raise RuntimeError("hub not found")
+        self.dev.set_configuration()
+        intf = self.dev.get_active_configuration()[(0, 0)]
+        self.ep_out = next(e for e in intf if not e.bEndpointAddress & 0x80)
+        self.ep_in = next(e for e in intf if e.bEndpointAddress & 0x80)
+        self.max_size = self.ep_out.wMaxPacketSize - 1
+
+        loop = asyncio.get_running_loop()
+        self.responses = asyncio.Queue()
+        self.running = True
+
+        def read_loop():
+            while self.running:
+                try:
+                    msg = bytes(self.ep_in.read(self.ep_in.wMaxPacketSize, 100))
+                except usb.core.USBTimeoutError:
+                    continue
+                if msg[0] == USB_IN_MSG_RESPONSE:
+                    result = struct.unpack_from("<I", msg, 1)[0]
+                    loop.call_soon_threadsafe(self.responses.put_nowait, result)
+                elif msg[0] == USB_IN_MSG_EVENT:
+                    loop.call_soon_threadsafe(on_event, msg[1:])
+
+        self.thread = threading.Thread(target=read_loop, daemon=True)
+        self.thread.start()
+        self.ep_out.write(bytes([USB_OUT_MSG_SUBSCRIBE, 1]))
+        await self.responses.get()
+
+    async def write(self, data):
+        self.ep_out.write(bytes([USB_OUT_MSG_COMMAND]) + data)
+        result = await self.responses.get()
+        if result == ERROR_BUSY:
+            raise BusyError
+        if result:
+            raise RuntimeError(f"command failed with error {result}")
+
+    async def disconnect(self):
+        self.running = False
+        self.thread.join()
+
+
+class Echo:
+    """Sends numbered packets along one path and matches them with replies."""
+
+    def __init__(self, transport, path, size):
+        self.transport = transport
+        self.flags, self.header, self.event = PATHS[path]
+        self.size = max(size, 4)
+        self.waiting = {}
+        self.received = b""
+
+    def on_event(self, data):
+        if data[0] != self.event:
+            return
+        # Stdout may be split or merged, so reassemble the packets.
+        self.received += data[1:]
+        while len(self.received) >= self.size:
+            packet, self.received = (
+                self.received[: self.size],
+                self.received[self.size :],
+            )
+            (seq,) = struct.unpack_from("<I", packet)
+            future = self.waiting.pop(seq, None)
+            if future and not future.done():
+                future.set_result(time.perf_counter())
+
+    async def send(self, seq):
+        payload = struct.pack("<I", seq).ljust(self.size, b"\xaa")
+        future = asyncio.get_running_loop().create_future()
+        self.waiting[seq] = future
+        while True:
+            try:
+                await self.transport.write(self.header + payload)
+                break
+            except BusyError:
+                await asyncio.sleep(0.001)
+        return future
+
+    async def round_trip_times(self, count):
+        times = []
+        for seq in range(count):
+            start = time.perf_counter()
+            future = await self.send(seq)
+            end = await asyncio.wait_for(future, 2)
+            times.append((end - start) * 1000)
+        return times
+
+    async def throughput(self, duration, window):
+        seq = 1 << 31
+        in_flight = set()
+        start = time.perf_counter()
+        done = 0
+        while time.perf_counter() - start < duration:
+            while len(in_flight) < window:
+                in_flight.add(await self.send(seq))
+                seq += 1
+            finished, in_flight = await asyncio.wait(
+                in_flight, timeout=2, return_when=asyncio.FIRST_COMPLETED
+            )
+            if not finished:
+                raise TimeoutError("no reply from hub")
+            done += len(finished)
+        elapsed = time.perf_counter() - start
+        return done * self.size / elapsed
+
+
+def percentile(values, p):
+    return statistics.quantiles(values, n=100, method="inclusive")[p - 1]
+
+
+async def run(args):
+    transport = BleTransport() if args.transport == "ble" else UsbTransport()
+    echo = None
+    await transport.connect(args.name, lambda data: echo and echo.on_event(data))
+
+    try:
+        for path in args.paths:
+            flags, header, _ = PATHS[path]
+            size = min(args.size, transport.max_size - len(header))
+            echo = Echo(transport, path, size)
+            await transport.write(bytes([COMMAND_ECHO, flags]))
+
+            times = await echo.round_trip_times(args.count)
+            rate = await echo.throughput(args.duration, args.window)
+
+            print(
+                f"{transport.name} {path:9} {echo.size:4} B: "
+                f"RTT p50 {percentile(times, 50):6.2f} ms, "
+                f"p90 {percentile(times, 90):6.2f} ms, "
+                f"p99 {percentile(times, 99):6.2f} ms, "
+                f"max {max(times):6.2f} ms, "
+                f"throughput {rate / 1000:7.2f} kB/s"
+            )
+    finally:
+        await transport.write(bytes([COMMAND_ECHO, 0]))
+        await transport.disconnect()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("transport", choices=["ble", "usb"])
+    parser.add_argument(
+        "paths",
+        nargs="*",
+        choices=list(PATHS),
+        default=list(PATHS),
+        help="paths to measure (default: all)",
+    )
+    parser.add_argument("--name", help="Bluetooth name of the hub")
+    parser.add_argument(
+        "--size",
+        type=int,
+        default=512,
+        help="packet size, limited to what fits (default: %(default)s)",
+    )
+    parser.add_argument(
+        "--count",
+        type=int,
+        default=200,
+        help="round trips to measure (default: %(default)s)",
+    )
+    parser.add_argument(
+        "--duration",
+        type=float,
+        default=5,
+        help="seconds to measure throughput (default: %(default)s)",
+    )
+    parser.add_argument(
+        "--window",
+        type=int,
+        default=4,
+        help="packets in flight for throughput (default: %(default)s)",
+    )
+    asyncio.run(run(parser.parse_args()))
+
+
+if __name__ == "__main__":
+    main()
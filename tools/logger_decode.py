@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+"""Decode a log saved with ``Logger.save(binary=True)`` into CSV text.
+
+The log may be the raw binary file as saved on the hub's file system, or the
+base64 text lines as received by the host.
+"""
+
+import argparse
+import base64
+import pathlib
+import struct
+import sys
+
+MAGIC = b"PBLG"
+VERSION = 1
+
+
+def read_log_bytes(path: pathlib.Path) -> bytes:
+    """Reads the binary log, base64-decoding it first if needed."""
+    data = path.read_bytes()
+    if data.startswith(MAGIC):
+        return data
+    return b"".join(base64.b64decode(line) for line in data.split() if line)
+
+
+def decode(data: bytes) -> list[list[int]]:
+    """Decodes binary log data into rows of values.
+
+    Arguments:
+        data: The binary log data.
+
+    Returns:
+        The list of rows.
+    """
+    if data[0:4] != MAGIC:
+        raise ValueError("not a Pybricks binary log")
+
+    version, num_cols, num_rows = struct.unpack_from("<BBI", data, 4)
+    if version != VERSION:
+        raise ValueError(f"unsupported log version {version}")
+
+    pos = 10
+    previous = [0] * num_cols
+    rows = []
+
+    for _ in range(num_rows):
+        row = []
+        for col in range(num_cols):
+            # Read little-endian base 128 varint.
+            zigzag = 0
+            shift = 0
+            while True:
+                byte = data[pos]
+                pos += 1
+                zigzag |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+
+            # Undo zigzag and delta encoding, wrapping like int32 in C.
+            delta = (zigzag >> 1) ^ -(zigzag & 1)
+            value = (previous[col] + delta + 2**31) % 2**32 - 2**31
+            row.append(value)
+
+        previous = row
+        rows.append(row)
+
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("log", type=pathlib.Path, help="binary or base64 log file")
+    args = parser.parse_args()
+
+    for row in decode(read_log_bytes(args.log)):
+        sys.stdout.write(", ".join(str(v) for v in row) + "\n")
+
+
+if __name__ == "__main__":
+    main()
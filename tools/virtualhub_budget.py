@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+
+"""Measure resource use of virtualhub tests and compare it to budgets.
+
+Each test is run on the virtual hub with a footer that reports statistics of
+the program. Together with the CPU time of the process, these are written as
+JSON. If a ``<test>.py.budget`` file exists next to the test, the measured
+values are compared to the limits in it and the script fails if any value
+exceeds its limit.
+
+Budget files are JSON objects with the same keys as the results, and need
+only contain the values that should be checked. Use ``--update`` to write
+budgets based on the measured values.
+"""
+
+import argparse
+import json
+import os
+import pathlib
+import resource
+import subprocess
+import sys
+import tempfile
+
+TOP_DIR = pathlib.Path(__file__).parent.parent
+
+# Extra margin given to each measured value when writing budgets.
+UPDATE_MARGIN = {
+    "cpu_time_s": 2.0,
+    "heap_used_max": 1.25,
+    "gc_collections": 1.25,
+    "loop_period_max_us": 1.25,
+    "event_loop_calls": 1.25,
+}
+
+# Names of the values reported by the test program, in order.
+REPORT_KEYS = ["heap_used_max", "gc_collections", "loop_period_max_us", "event_loop_calls"]
+
+REPORT_PREFIX = "BUDGET_REPORT:"
+
+# Runs at the end of the test program to print its statistics in the order of
+# REPORT_KEYS. Values that the build does not provide are reported as None.
+FOOTER = f"""
+
+def _budget_report():
+    import gc
+    from pybricks import tools
+
+    values = [gc.mem_alloc(), None, None, None]
+    if hasattr(tools, "gc_stats"):
+        stats = tools.gc_stats()
+        values[0] = max(values[0], stats[4])
+        values[1] = stats[0]
+    if hasattr(tools, "control_loop_stats"):
+        values[2] = tools.control_loop_stats()[2]
+    if hasattr(tools, "process_stats"):
+        values[3] = sum(p[1] for p in tools.process_stats()[1])
+    print("{REPORT_PREFIX}", *values)
+
+
+_budget_report()
+"""
+
+
+def measure(hub: pathlib.Path, test: pathlib.Path) -> dict:
+    """Runs one test and measures its resource use.
+
+    Arguments:
+        hub: The virtual hub executable.
+        test: The test script.
+
+    Returns:
+        The measured values.
+    """
+    source = test.read_text() + FOOTER
+
+    with tempfile.TemporaryDirectory(prefix="pybricks-budget-") as d:
+        script = pathlib.Path(d, test.name)
+        script.write_text(source)
+
+        usage_start = resource.getrusage(resource.RUSAGE_CHILDREN)
+        result = subprocess.run(
+            [hub, script], cwd=test.parent, capture_output=True, text=True
+        )
+        usage_end = resource.getrusage(resource.RUSAGE_CHILDREN)
+
+    values = None
+    for line in result.stdout.splitlines():
+        if line.startswith(REPORT_PREFIX):
+            reported = line[len(REPORT_PREFIX) :].split()
+            values = {
+                key: None if value == "None" else int(value)
+                for key, value in zip(REPORT_KEYS, reported)
+            }
+
+    if values is None:
+        raise RuntimeError(f"{test}: no report, the test did not finish:\n{result.stdout}")
+
+    values["cpu_time_s"] = round(
+        usage_end.ru_utime
+        - usage_start.ru_utime
+        + usage_end.ru_stime
+        - usage_start.ru_stime,
+        3,
+    )
+    return values
+
+
+def check(values: dict, budget: dict) -> list[str]:
+    """Compares measured values to a budget.
+
+    Returns:
+        Descriptions of the values that exceed their limit.
+    """
+    return [
+        f"{key} is {values[key]}, limit is {limit}"
+        for key, limit in budget.items()
+        if values.get(key) is not None and values[key] > limit
+    ]
+
+
+def make_budget(values: dict) -> dict:
+    """Makes a budget from measured values, with some margin."""
+    budget = {}
+    for key, margin in UPDATE_MARGIN.items():
+        if values.get(key) is None:
+            continue
+        limit = values[key] * margin
+        budget[key] = round(limit, 3) if isinstance(values[key], float) else int(limit) + 1
+    return budget
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        "tests",
+        nargs="*",
+        type=pathlib.Path,
+        default=sorted(TOP_DIR.joinpath("tests", "virtualhub").rglob("*.py")),
+        help="test scripts (default: all virtualhub tests)",
+    )
+    parser.add_argument(
+        "--hub",
+        type=pathlib.Path,
+        default=os.environ.get("MICROPY_MICROPYTHON"),
+        required="MICROPY_MICROPYTHON" not in os.environ,
+        help="virtual hub executable (default: $MICROPY_MICROPYTHON)",
+    )
+    parser.add_argument("--output", type=pathlib.Path, help="write results to this JSON file")
+    parser.add_argument("--update", action="store_true", help="write budgets from the results")
+    args = parser.parse_args()
+
+    results = {}
+    failures = []
+
+    for test in args.tests:
+        test = test.resolve()
+        values = measure(args.hub, test)
+        name = str(test.relative_to(TOP_DIR)) if test.is_relative_to(TOP_DIR) else str(test)
+        results[name] = values
+
+        budget_path = test.with_name(test.name + ".budget")
+        if args.update:
+            budget_path.write_text(json.dumps(make_budget(values), indent=4) + "\n")
+        elif budget_path.exists():
+            for problem in check(values, json.loads(budget_path.read_text())):
+                failures.append(f"{name}: {problem}")
+
+        print(f"{name}: {json.dumps(values)}")
+
+    if args.output:
+        args.output.write_text(json.dumps(results, indent=4) + "\n")
+
+    if failures:
+        print("\nOver budget:", *failures, sep="\n")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()